@@ -0,0 +1,89 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+
+#include "aggregate_view.hpp"
+
+#include "impl/materialized_aggregate.hpp"
+#include "results.hpp"
+
+#include <stdexcept>
+
+using namespace realm;
+using namespace realm::_impl;
+
+AggregateView::AggregateView(Results const& results, size_t column, Operation op)
+: m_realm(results.m_realm)
+, m_op(op)
+{
+    results.validate_read();
+    if (results.is_limited() || results.is_paged() || results.has_distinct()) {
+        throw std::logic_error("Aggregate views can not be created for limited, paged or distinct Results");
+    }
+    if (results.m_link_view) {
+        throw std::logic_error("Aggregate views can not be created for Results restricted to a LinkView");
+    }
+    if (!results.m_table) {
+        return;
+    }
+    if (!m_realm) {
+        throw std::logic_error("Aggregate views can only be created for Results backed by a Realm");
+    }
+
+    auto& table = *results.m_table;
+    if (op != Operation::Count) {
+        if (column >= table.get_column_count())
+            throw Results::OutOfBoundsIndexException{column, table.get_column_count()};
+        auto type = table.get_column_type(column);
+        if (type != type_Int && type != type_Float && type != type_Double)
+            throw Results::UnsupportedColumnTypeException{column, &table};
+    }
+
+    m_aggregate = std::make_shared<MaterializedAggregate>(table, results.get_query(), column, op);
+    m_aggregate->update(*m_realm);
+}
+
+util::Optional<Mixed> AggregateView::get()
+{
+    if (m_realm)
+        m_realm->verify_thread();
+    if (!m_aggregate) {
+        if (m_op == Operation::Average)
+            return none;
+        return util::Optional<Mixed>(int64_t(0));
+    }
+    m_aggregate->update(*m_realm);
+    return m_aggregate->value();
+}
+
+size_t AggregateView::add_notification_callback(NotificationCallback callback)
+{
+    // Views of missing tables never change
+    if (!m_aggregate) {
+        return npos;
+    }
+    m_aggregate->update(*m_realm);
+    return m_realm->add_aggregate_notifier(std::make_shared<AggregateNotifier>(m_aggregate, std::move(callback)));
+}
+
+void AggregateView::remove_notification_callback(size_t token)
+{
+    if (m_aggregate) {
+        m_realm->remove_aggregate_notifier(token);
+    }
+}
@@ -0,0 +1,88 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef REALM_AGGREGATE_VIEW_HPP
+#define REALM_AGGREGATE_VIEW_HPP
+
+#include "shared_realm.hpp"
+
+#include <realm/util/optional.hpp>
+
+#include <functional>
+#include <memory>
+
+namespace realm {
+class Mixed;
+class Results;
+
+namespace _impl {
+class MaterializedAggregate;
+}
+
+// The count, sum or average of a column over the rows matched by a Results,
+// which is computed once and then kept up to date by applying the row-level
+// changes made by each transaction to the table, rather than by re-reading
+// every matching row each time it's asked for.
+//
+// Each matching row's contribution is remembered so that it can be removed
+// when the row is erased, modified or stops matching, so only the rows which
+// were changed are re-evaluated against the query. Changes to rows of other
+// tables, changes made by write transactions on this Realm and inserting rows
+// anywhere other than at the end of the table can't be applied, and result in
+// the aggregate being recomputed in full the next time it's read.
+class AggregateView {
+public:
+    enum class Operation {
+        Count,
+        Sum,
+        Average
+    };
+
+    // `column` is ignored for Count.
+    // Throws std::logic_error for Results which are limited, paged, have
+    // duplicates removed, or are restricted to a LinkView or TableView
+    // Throws Results::UnsupportedColumnTypeException for Sum and Average on a
+    // column which isn't Int, Float or Double
+    // Throws Results::OutOfBoundsIndexException for an out-of-bounds column
+    AggregateView(Results const& results, size_t column, Operation op);
+
+    // Get the current value, bringing it up to date with the Realm's read
+    // transaction first. Count and Sum always return a value, while Average
+    // returns none if no matching row has a non-null value. Sums of Int
+    // columns are Int, and all other values are Double.
+    util::Optional<Mixed> get();
+
+    // Call the callback on this thread each time the Realm advances to a
+    // version in which the value differs from the value it had when the
+    // callback was last called, or was added.
+    // Returns a token to pass to remove_notification_callback().
+    using NotificationCallback = std::function<void (util::Optional<Mixed>)>;
+    size_t add_notification_callback(NotificationCallback callback);
+    void remove_notification_callback(size_t token);
+
+private:
+    SharedRealm m_realm;
+    const Operation m_op;
+    // Null for Results which are not backed by a table and so never match
+    // anything
+    std::shared_ptr<_impl::MaterializedAggregate> m_aggregate;
+};
+} // namespace realm
+
+#endif /* REALM_AGGREGATE_VIEW_HPP */
@@ -0,0 +1,87 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef REALM_BENCHMARK_HPP
+#define REALM_BENCHMARK_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace realm {
+namespace benchmark {
+// Passed to each benchmark function. The function does any setup which
+// shouldn't be timed and then calls measure() once with the operation to time.
+class State {
+public:
+    State(std::string path, size_t min_samples, std::chrono::nanoseconds min_sample_time)
+    : m_path(std::move(path)), m_min_samples(min_samples), m_min_sample_time(min_sample_time) { }
+
+    // A path for a Realm file which is deleted before and after the benchmark
+    std::string const& path() const { return m_path; }
+
+    // Run the operation repeatedly to collect timing samples. `operation` is
+    // run `batch` times per sample, where the batch size is picked so that
+    // each sample takes at least the minimum sample time. If `reset` is given
+    // it is run untimed before every run of the operation, and each sample is
+    // a single run.
+    void measure(std::function<void ()> operation, std::function<void ()> reset = nullptr);
+
+    // Append a value to a named series of measurements of something other
+    // than time, such as the file size after each batch of commits. Series
+    // are reported after the timings, and a benchmark which only records
+    // series doesn't need to call measure().
+    void record(std::string const& series, double value);
+
+    struct Series {
+        std::string name;
+        std::vector<double> values;
+    };
+
+    // The time per operation of each sample, once measure() has been called
+    std::vector<double> const& samples_ns() const { return m_samples; }
+    size_t batch_size() const { return m_batch; }
+    std::vector<Series> const& series() const { return m_series; }
+
+private:
+    std::string m_path;
+    size_t m_min_samples;
+    std::chrono::nanoseconds m_min_sample_time;
+    std::vector<double> m_samples;
+    size_t m_batch = 1;
+    std::vector<Series> m_series;
+};
+
+using Function = void (*)(State&);
+
+struct Registration {
+    Registration(const char* name, Function function);
+};
+} // namespace benchmark
+} // namespace realm
+
+// Define a benchmark named `name`, which is run with
+// `benchmark-object-store` if its name matches the filter given
+#define REALM_BENCHMARK(name) \
+    static void realm_benchmark_##name(::realm::benchmark::State&); \
+    static ::realm::benchmark::Registration realm_benchmark_registration_##name(#name, realm_benchmark_##name); \
+    static void realm_benchmark_##name(::realm::benchmark::State& state)
+
+#endif /* REALM_BENCHMARK_HPP */
@@ -0,0 +1,84 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef REALM_BENCHMARK_REALM_HPP
+#define REALM_BENCHMARK_REALM_HPP
+
+#include "object_schema.hpp"
+#include "object_store.hpp"
+#include "property.hpp"
+#include "schema.hpp"
+#include "shared_realm.hpp"
+
+#include <realm/table.hpp>
+
+#include <memory>
+#include <string>
+
+namespace realm {
+namespace benchmark {
+// The columns of the single table used by the benchmarks
+enum Column : size_t {
+    ColumnInt,
+    ColumnDouble,
+    ColumnString,
+};
+
+// A config for an uncached Realm at the path with a single object type, so
+// that each call to Realm::get_shared_realm() opens a separate instance
+inline Realm::Config make_config(std::string const& path)
+{
+    Realm::Config config;
+    config.path = path;
+    config.cache = false;
+    config.schema_version = 0;
+    config.schema = std::make_unique<Schema>(Schema{
+        {"object", "", {
+            {"int", PropertyTypeInt},
+            {"double", PropertyTypeDouble},
+            {"string", PropertyTypeString},
+        }},
+    });
+    return config;
+}
+
+inline TableRef object_table(SharedRealm const& realm)
+{
+    return ObjectStore::table_for_object_type(realm->read_group(), "object");
+}
+
+// Add `count` rows with pseudo-random values, so that sorting and queries
+// do a representative amount of work
+inline void add_objects(SharedRealm const& realm, size_t count)
+{
+    realm->begin_transaction();
+    auto table = object_table(realm);
+    size_t start = table->add_empty_row(count);
+    uint32_t value = 12345;
+    for (size_t i = start; i < start + count; ++i) {
+        value = value * 1103515245 + 12345;
+        table->set_int(ColumnInt, i, value % 1000);
+        table->set_double(ColumnDouble, i, value / 7.0);
+        table->set_string(ColumnString, i, std::to_string(value % 5000));
+    }
+    realm->commit_transaction();
+}
+} // namespace benchmark
+} // namespace realm
+
+#endif /* REALM_BENCHMARK_REALM_HPP */
@@ -0,0 +1,258 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+// File size, free space and resident memory over a run of commits, for a
+// number of patterns of writing and of reading from another thread. A reader
+// which holds on to an old version keeps all of the data which has changed
+// since then alive, so the file grows with every commit it doesn't see.
+
+#include "benchmark.hpp"
+#include "benchmark_realm.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <sys/stat.h>
+#include <thread>
+
+#ifdef __APPLE__
+#include <mach/mach.h>
+#else
+#include <cstdio>
+#include <unistd.h>
+#endif
+
+using namespace realm;
+using namespace realm::benchmark;
+
+namespace {
+size_t resident_size()
+{
+#ifdef __APPLE__
+    mach_task_basic_info_data_t info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count) != KERN_SUCCESS) {
+        return 0;
+    }
+    return info.resident_size;
+#else
+    size_t pages = 0, resident = 0;
+    if (FILE* file = fopen("/proc/self/statm", "r")) {
+        if (fscanf(file, "%zu %zu", &pages, &resident) != 2) {
+            resident = 0;
+        }
+        fclose(file);
+    }
+    return resident * sysconf(_SC_PAGESIZE);
+#endif
+}
+
+size_t file_size(std::string const& path)
+{
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 ? size_t(st.st_size) : 0;
+}
+
+// A Realm which is opened and used on its own thread, and which only does
+// anything when told to, so that it holds its read transaction in between
+class ReaderThread {
+public:
+    ReaderThread(Realm::Config config)
+    {
+        m_thread = std::thread([this, config] { run(config); });
+        perform([](Realm& realm) { realm.read_group(); });
+    }
+
+    ~ReaderThread()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_cv.notify_all();
+        m_thread.join();
+    }
+
+    // Run the task on the reader's thread and wait for it to complete
+    void perform(std::function<void (Realm&)> task)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_task = std::move(task);
+        m_cv.notify_all();
+        m_cv.wait(lock, [&] { return !m_task; });
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::function<void (Realm&)> m_task;
+    bool m_stop = false;
+    std::thread m_thread;
+
+    void run(Realm::Config config)
+    {
+        auto realm = Realm::get_shared_realm(config);
+        realm->set_auto_refresh(false);
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true) {
+            m_cv.wait(lock, [&] { return m_task || m_stop; });
+            if (m_stop) {
+                break;
+            }
+            m_task(*realm);
+            m_task = nullptr;
+            m_cv.notify_all();
+        }
+        realm->close();
+    }
+};
+
+enum class ReaderPattern {
+    // No other Realm is open, so only the writer's own version is kept
+    None,
+    // A reader begins reading before the first commit and never advances
+    Pinned,
+    // A reader refreshes to the latest version every `reader_interval` commits
+    Refreshing,
+    // A reader begins reading every `reader_interval` commits and
+    // invalidates its Realm as soon as it's done with the data
+    Invalidating,
+};
+
+struct FootprintPattern {
+    size_t commits = 2000;
+    // Rows added and existing rows modified by each commit
+    size_t inserts_per_commit = 5;
+    size_t updates_per_commit = 50;
+    ReaderPattern reader = ReaderPattern::None;
+    size_t reader_interval = 100;
+    // Compact the file once the commits are done and the reader is closed
+    bool compact = false;
+};
+
+void record_footprint(State& state, SharedRealm const& realm, size_t commits)
+{
+    auto stats = realm->file_statistics();
+    state.record("commits", commits);
+    state.record("file_size_kb", file_size(state.path()) / 1024.0);
+    state.record("free_space_kb", stats.free_space / 1024.0);
+    state.record("used_space_kb", stats.used_space / 1024.0);
+    state.record("versions", stats.version_count);
+    state.record("rss_kb", resident_size() / 1024.0);
+}
+
+void measure_footprint(State& state, FootprintPattern const& pattern)
+{
+    auto config = make_config(state.path());
+    auto realm = Realm::get_shared_realm(config);
+    add_objects(realm, 1000);
+
+    std::unique_ptr<ReaderThread> reader;
+    if (pattern.reader != ReaderPattern::None) {
+        reader = std::make_unique<ReaderThread>(config);
+    }
+    if (pattern.reader == ReaderPattern::Invalidating) {
+        reader->perform([](Realm& realm) { realm.invalidate(); });
+    }
+
+    const size_t sample_interval = std::max<size_t>(1, pattern.commits / 20);
+    record_footprint(state, realm, 0);
+
+    uint32_t value = 54321;
+    for (size_t commit = 1; commit <= pattern.commits; ++commit) {
+        realm->begin_transaction();
+        auto table = object_table(realm);
+        table->add_empty_row(pattern.inserts_per_commit);
+        for (size_t i = 0; i < pattern.updates_per_commit; ++i) {
+            value = value * 1103515245 + 12345;
+            size_t row = value % table->size();
+            table->set_int(ColumnInt, row, value % 1000);
+            table->set_string(ColumnString, row, std::to_string(value % 5000));
+        }
+        realm->commit_transaction();
+
+        if (reader && commit % pattern.reader_interval == 0) {
+            if (pattern.reader == ReaderPattern::Refreshing) {
+                reader->perform([](Realm& realm) { realm.refresh(); });
+            }
+            else if (pattern.reader == ReaderPattern::Invalidating) {
+                reader->perform([](Realm& realm) {
+                    ObjectStore::table_for_object_type(realm.read_group(), "object")->size();
+                    realm.invalidate();
+                });
+            }
+        }
+        if (commit % sample_interval == 0) {
+            record_footprint(state, realm, commit);
+        }
+    }
+
+    // Space freed by versions which are no longer pinned can only be reused
+    // once a later commit has been made
+    reader.reset();
+    realm->begin_transaction();
+    realm->commit_transaction();
+    state.record("released_file_size_kb", file_size(state.path()) / 1024.0);
+    state.record("released_free_space_kb", realm->file_statistics().free_space / 1024.0);
+
+    if (pattern.compact) {
+        realm->compact();
+        state.record("compacted_file_size_kb", file_size(state.path()) / 1024.0);
+    }
+}
+} // anonymous namespace
+
+REALM_BENCHMARK(footprint_writer_only) {
+    measure_footprint(state, {});
+}
+
+REALM_BENCHMARK(footprint_pinned_reader) {
+    FootprintPattern pattern;
+    pattern.reader = ReaderPattern::Pinned;
+    measure_footprint(state, pattern);
+}
+
+REALM_BENCHMARK(footprint_pinned_reader_compacted) {
+    FootprintPattern pattern;
+    pattern.reader = ReaderPattern::Pinned;
+    pattern.compact = true;
+    measure_footprint(state, pattern);
+}
+
+REALM_BENCHMARK(footprint_refreshing_reader) {
+    FootprintPattern pattern;
+    pattern.reader = ReaderPattern::Refreshing;
+    measure_footprint(state, pattern);
+}
+
+REALM_BENCHMARK(footprint_invalidating_reader) {
+    FootprintPattern pattern;
+    pattern.reader = ReaderPattern::Invalidating;
+    measure_footprint(state, pattern);
+}
+
+REALM_BENCHMARK(footprint_append_only_pinned_reader) {
+    FootprintPattern pattern;
+    pattern.inserts_per_commit = 50;
+    pattern.updates_per_commit = 0;
+    pattern.reader = ReaderPattern::Pinned;
+    measure_footprint(state, pattern);
+}
@@ -0,0 +1,113 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "benchmark.hpp"
+
+#include "index_set.hpp"
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+using namespace realm;
+using namespace realm::benchmark;
+
+namespace {
+// The same pseudo-random sequence of indexes below `limit` for every run
+std::vector<size_t> random_indexes(size_t count, size_t limit)
+{
+    std::vector<size_t> indexes(count);
+    uint32_t value = 12345;
+    for (auto& index : indexes) {
+        value = value * 1103515245 + 12345;
+        index = (value >> 8) % limit;
+    }
+    return indexes;
+}
+}
+
+REALM_BENCHMARK(index_set_add_sequential) {
+    state.measure([&] {
+        IndexSet set;
+        for (size_t i = 0; i < 10000; ++i) {
+            set.add(i);
+        }
+    });
+}
+
+REALM_BENCHMARK(index_set_add_random) {
+    auto indexes = random_indexes(10000, 100000);
+    state.measure([&] {
+        IndexSet set;
+        for (size_t index : indexes) {
+            set.add(index);
+        }
+    });
+}
+
+REALM_BENCHMARK(index_set_add_shifted) {
+    auto indexes = random_indexes(1000, 100000);
+    state.measure([&] {
+        IndexSet set;
+        for (size_t index : indexes) {
+            set.add_shifted(index);
+        }
+    });
+}
+
+REALM_BENCHMARK(index_set_insert_at) {
+    auto indexes = random_indexes(1000, 10000);
+    IndexSet base;
+    for (size_t i = 0; i < 10000; i += 3) {
+        base.add(i);
+    }
+    state.measure([&] {
+        IndexSet set = base;
+        for (size_t index : indexes) {
+            set.insert_at(index);
+        }
+    });
+}
+
+REALM_BENCHMARK(index_set_erase_at) {
+    auto indexes = random_indexes(1000, 10000);
+    IndexSet base;
+    base.set(20000);
+    state.measure([&] {
+        IndexSet set = base;
+        for (size_t index : indexes) {
+            set.erase_at(index);
+        }
+    });
+}
+
+REALM_BENCHMARK(index_set_iterate_sparse) {
+    IndexSet set;
+    for (size_t index : random_indexes(10000, 1000000)) {
+        set.add(index);
+    }
+    state.measure([&] {
+        size_t total = 0;
+        for (auto range : set) {
+            total += range.second - range.first;
+        }
+        if (total != set.count()) {
+            throw std::logic_error("incorrect count");
+        }
+    });
+}
@@ -0,0 +1,262 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+// A small benchmark runner for the ObjectStore, built and run by
+// `sh build.sh benchmark-object-store`. Each benchmark collects a number of
+// timing samples and reports the spread of the time per operation, along with
+// any other series of measurements it records, either as a table or as JSON
+// for comparing runs.
+
+#include "benchmark.hpp"
+
+#include <realm/disable_sync_to_disk.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+#include <unistd.h>
+
+using namespace realm::benchmark;
+
+namespace {
+struct Benchmark {
+    const char* name;
+    Function function;
+};
+
+std::vector<Benchmark>& benchmarks()
+{
+    static std::vector<Benchmark> benchmarks;
+    return benchmarks;
+}
+
+void delete_realm_files(std::string const& path)
+{
+    for (const char* suffix : {"", ".lock", ".note", ".log", ".log_a", ".log_b"}) {
+        unlink((path + suffix).c_str());
+    }
+}
+
+struct Statistics {
+    double min, max, mean, median, p90, stddev;
+
+    Statistics(std::vector<double> samples)
+    {
+        std::sort(samples.begin(), samples.end());
+        auto percentile = [&](double p) {
+            return samples[std::min(samples.size() - 1, size_t(p * (samples.size() - 1) + 0.5))];
+        };
+        min = samples.front();
+        max = samples.back();
+        median = percentile(0.5);
+        p90 = percentile(0.9);
+        mean = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+        double variance = 0;
+        for (double sample : samples) {
+            variance += (sample - mean) * (sample - mean);
+        }
+        stddev = std::sqrt(variance / samples.size());
+    }
+};
+
+void usage(const char* argv0)
+{
+    fprintf(stderr, "Usage: %s [--filter substring] [--samples count] [--min-time ms] [--json] [--dir path]\n", argv0);
+}
+} // anonymous namespace
+
+Registration::Registration(const char* name, Function function)
+{
+    benchmarks().push_back({name, function});
+}
+
+void State::measure(std::function<void ()> operation, std::function<void ()> reset)
+{
+    using clock = std::chrono::steady_clock;
+
+    // warm up caches and anything lazily initialized
+    if (reset) {
+        reset();
+    }
+    operation();
+
+    auto run_batch = [&] {
+        if (reset) {
+            reset();
+        }
+        auto start = clock::now();
+        for (size_t i = 0; i < m_batch; ++i) {
+            operation();
+        }
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start);
+    };
+
+    if (!reset) {
+        while (m_batch < (size_t(1) << 30)) {
+            auto elapsed = run_batch();
+            if (elapsed >= m_min_sample_time) {
+                break;
+            }
+            // aim a little over the minimum so that noise doesn't leave
+            // samples just short of it
+            size_t estimate = elapsed.count() ? size_t(m_batch * 1.2 * m_min_sample_time.count() / elapsed.count()) : 0;
+            m_batch = std::max(m_batch * 2, std::min(estimate, m_batch * 100));
+        }
+    }
+
+    // single runs are far noisier, so take more samples of them
+    size_t samples = reset ? m_min_samples * 5 : m_min_samples;
+    m_samples.clear();
+    m_samples.reserve(samples);
+    for (size_t i = 0; i < samples; ++i) {
+        m_samples.push_back(double(run_batch().count()) / m_batch);
+    }
+}
+
+void State::record(std::string const& series, double value)
+{
+    auto it = std::find_if(m_series.begin(), m_series.end(), [&](auto const& s) { return s.name == series; });
+    if (it == m_series.end()) {
+        m_series.push_back({series, {}});
+        it = m_series.end() - 1;
+    }
+    it->values.push_back(value);
+}
+
+int main(int argc, char** argv)
+{
+    std::string filter;
+    size_t min_samples = 20;
+    long min_time_ms = 10;
+    bool json = false;
+    const char* tmpdir = getenv("TMPDIR");
+    std::string dir = tmpdir && *tmpdir ? tmpdir : "/tmp";
+
+    for (int i = 1; i < argc; ++i) {
+        bool has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--filter") == 0 && has_value) {
+            filter = argv[++i];
+        }
+        else if (strcmp(argv[i], "--samples") == 0 && has_value) {
+            min_samples = std::max(1L, strtol(argv[++i], nullptr, 10));
+        }
+        else if (strcmp(argv[i], "--min-time") == 0 && has_value) {
+            min_time_ms = std::max(1L, strtol(argv[++i], nullptr, 10));
+        }
+        else if (strcmp(argv[i], "--dir") == 0 && has_value) {
+            dir = argv[++i];
+        }
+        else if (strcmp(argv[i], "--json") == 0) {
+            json = true;
+        }
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    // The benchmarks measure the ObjectStore rather than the disk, and run
+    // in a process of their own, so nothing needs commits synced to disk
+    realm::disable_sync_to_disk();
+
+    auto& all = benchmarks();
+    std::sort(all.begin(), all.end(), [](auto const& a, auto const& b) { return strcmp(a.name, b.name) < 0; });
+
+    if (json) {
+        printf("{\"benchmarks\": [");
+    }
+    else {
+        printf("%-44s %8s %8s %12s %12s %12s %12s %8s\n",
+               "benchmark", "samples", "batch", "min (ns)", "median (ns)", "mean (ns)", "p90 (ns)", "stddev");
+    }
+
+    bool first = true;
+    int failures = 0;
+    for (auto& benchmark : all) {
+        if (!filter.empty() && !strstr(benchmark.name, filter.c_str())) {
+            continue;
+        }
+
+        std::string path = dir + "/benchmark-" + benchmark.name + ".realm";
+        delete_realm_files(path);
+        State state(path, min_samples, std::chrono::milliseconds(min_time_ms));
+        try {
+            benchmark.function(state);
+        }
+        catch (std::exception const& e) {
+            fprintf(stderr, "%s failed: %s\n", benchmark.name, e.what());
+            ++failures;
+        }
+        delete_realm_files(path);
+        if (state.samples_ns().empty() && state.series().empty()) {
+            continue;
+        }
+
+        if (json) {
+            printf("%s\n  {\"name\": \"%s\"", first ? "" : ",", benchmark.name);
+            if (!state.samples_ns().empty()) {
+                Statistics stats(state.samples_ns());
+                printf(", \"samples\": %zu, \"batch\": %zu, \"min_ns\": %.1f, \"max_ns\": %.1f, "
+                       "\"median_ns\": %.1f, \"mean_ns\": %.1f, \"p90_ns\": %.1f, \"stddev_ns\": %.1f",
+                       state.samples_ns().size(), state.batch_size(),
+                       stats.min, stats.max, stats.median, stats.mean, stats.p90, stats.stddev);
+            }
+            if (!state.series().empty()) {
+                printf(", \"series\": {");
+                for (auto& series : state.series()) {
+                    printf("%s\"%s\": [", &series == &state.series().front() ? "" : ", ", series.name.c_str());
+                    for (size_t i = 0; i < series.values.size(); ++i) {
+                        printf("%s%.0f", i ? ", " : "", series.values[i]);
+                    }
+                    printf("]");
+                }
+                printf("}");
+            }
+            printf("}");
+        }
+        else {
+            if (!state.samples_ns().empty()) {
+                Statistics stats(state.samples_ns());
+                printf("%-44s %8zu %8zu %12.1f %12.1f %12.1f %12.1f %7.1f%%\n",
+                       benchmark.name, state.samples_ns().size(), state.batch_size(),
+                       stats.min, stats.median, stats.mean, stats.p90, 100 * stats.stddev / stats.mean);
+            }
+            else {
+                printf("%s\n", benchmark.name);
+            }
+            for (auto& series : state.series()) {
+                printf("  %-42s", series.name.c_str());
+                for (double value : series.values) {
+                    printf(" %.0f", value);
+                }
+                printf("\n");
+            }
+        }
+        fflush(stdout);
+        first = false;
+    }
+
+    if (json) {
+        printf("\n]}\n");
+    }
+    return failures ? 1 : 0;
+}
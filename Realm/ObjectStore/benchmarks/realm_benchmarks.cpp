@@ -0,0 +1,58 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "benchmark.hpp"
+#include "benchmark_realm.hpp"
+
+using namespace realm;
+using namespace realm::benchmark;
+
+REALM_BENCHMARK(realm_open_close_uncached) {
+    auto config = make_config(state.path());
+    // keep one instance open so that only opening a new instance of an
+    // already open file is measured, not creating the file
+    auto realm = Realm::get_shared_realm(config);
+    state.measure([&] {
+        Realm::get_shared_realm(config)->close();
+    });
+}
+
+REALM_BENCHMARK(realm_open_cached) {
+    auto config = make_config(state.path());
+    config.cache = true;
+    auto realm = Realm::get_shared_realm(config);
+    state.measure([&] {
+        Realm::get_shared_realm(config);
+    });
+}
+
+REALM_BENCHMARK(realm_open_first_instance) {
+    auto config = make_config(state.path());
+    Realm::get_shared_realm(config)->close();
+    state.measure([&] {
+        Realm::get_shared_realm(config)->close();
+    });
+}
+
+REALM_BENCHMARK(realm_empty_write_transaction) {
+    auto realm = Realm::get_shared_realm(make_config(state.path()));
+    state.measure([&] {
+        realm->begin_transaction();
+        realm->commit_transaction();
+    });
+}
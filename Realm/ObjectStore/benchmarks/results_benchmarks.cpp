@@ -0,0 +1,128 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "benchmark.hpp"
+#include "benchmark_realm.hpp"
+
+#include "results.hpp"
+
+using namespace realm;
+using namespace realm::benchmark;
+
+namespace {
+const size_t object_count = 100000;
+}
+
+REALM_BENCHMARK(results_refresh_after_modification) {
+    auto config = make_config(state.path());
+    auto writer = Realm::get_shared_realm(config);
+    add_objects(writer, object_count);
+    auto reader = Realm::get_shared_realm(config);
+    Results results(reader, object_table(reader)->where().greater(ColumnInt, 500));
+    results.size();
+
+    size_t row = 0;
+    state.measure([&] {
+        reader->refresh();
+        results.size();
+    }, [&] {
+        writer->begin_transaction();
+        object_table(writer)->set_int(ColumnInt, row % object_count, row % 1000);
+        ++row;
+        writer->commit_transaction();
+    });
+}
+
+REALM_BENCHMARK(results_refresh_after_insertion) {
+    auto config = make_config(state.path());
+    auto writer = Realm::get_shared_realm(config);
+    add_objects(writer, object_count);
+    auto reader = Realm::get_shared_realm(config);
+    Results results(reader, object_table(reader)->where().greater(ColumnInt, 500));
+    results.size();
+
+    state.measure([&] {
+        reader->refresh();
+        results.size();
+    }, [&] {
+        add_objects(writer, 10);
+    });
+}
+
+REALM_BENCHMARK(results_sum_int) {
+    auto realm = Realm::get_shared_realm(make_config(state.path()));
+    add_objects(realm, object_count);
+    Results results(realm, *object_table(realm));
+    state.measure([&] { results.sum(ColumnInt); });
+}
+
+REALM_BENCHMARK(results_average_double) {
+    auto realm = Realm::get_shared_realm(make_config(state.path()));
+    add_objects(realm, object_count);
+    Results results(realm, *object_table(realm));
+    state.measure([&] { results.average(ColumnDouble); });
+}
+
+REALM_BENCHMARK(results_min_max_int_query) {
+    auto realm = Realm::get_shared_realm(make_config(state.path()));
+    add_objects(realm, object_count);
+    Results results(realm, object_table(realm)->where().greater(ColumnInt, 500));
+    state.measure([&] {
+        results.min(ColumnInt);
+        results.max(ColumnInt);
+    });
+}
+
+REALM_BENCHMARK(results_aggregate_many) {
+    auto realm = Realm::get_shared_realm(make_config(state.path()));
+    add_objects(realm, object_count);
+    Results results(realm, *object_table(realm));
+    std::vector<std::pair<size_t, Results::AggregateOperation>> aggregates = {
+        {ColumnInt, Results::AggregateOperation::Sum},
+        {ColumnInt, Results::AggregateOperation::Max},
+        {ColumnDouble, Results::AggregateOperation::Average},
+    };
+    state.measure([&] { results.aggregate_many(aggregates); });
+}
+
+REALM_BENCHMARK(results_sort_int) {
+    auto realm = Realm::get_shared_realm(make_config(state.path()));
+    add_objects(realm, object_count);
+    Results results(realm, *object_table(realm));
+    state.measure([&] {
+        results.sort({{ColumnInt}, {true}}).size();
+    });
+}
+
+REALM_BENCHMARK(results_sort_string) {
+    auto realm = Realm::get_shared_realm(make_config(state.path()));
+    add_objects(realm, object_count);
+    Results results(realm, *object_table(realm));
+    state.measure([&] {
+        results.sort({{ColumnString}, {true}}).size();
+    });
+}
+
+REALM_BENCHMARK(results_sort_limited) {
+    auto realm = Realm::get_shared_realm(make_config(state.path()));
+    add_objects(realm, object_count);
+    Results results(realm, *object_table(realm));
+    state.measure([&] {
+        results.sort({{ColumnDouble}, {false}}).limit(10).size();
+    });
+}
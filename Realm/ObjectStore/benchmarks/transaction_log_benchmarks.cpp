@@ -0,0 +1,94 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "benchmark.hpp"
+#include "benchmark_realm.hpp"
+
+#include "binding_context.hpp"
+
+using namespace realm;
+using namespace realm::benchmark;
+
+namespace {
+const size_t object_count = 10000;
+
+// Observes the first `count` rows of the table, as KVO on that many objects
+// would
+class ObservingContext : public BindingContext {
+public:
+    ObservingContext(size_t table_ndx, size_t count) : m_table_ndx(table_ndx), m_count(count) { }
+
+    std::vector<ObserverState> get_observed_rows() override
+    {
+        std::vector<ObserverState> observers(m_count);
+        for (size_t i = 0; i < m_count; ++i) {
+            observers[i].table_ndx = m_table_ndx;
+            observers[i].row_ndx = i;
+            observers[i].info = nullptr;
+        }
+        return observers;
+    }
+
+    void will_change(std::vector<ObserverState> const&, std::vector<void*> const&) override { }
+    void did_change(std::vector<ObserverState> const&, std::vector<void*> const&) override { }
+
+private:
+    size_t m_table_ndx;
+    size_t m_count;
+};
+
+// Time advancing a read transaction over a commit which modifies
+// `modified_rows` rows spread through the table, with `observers` rows observed
+void advance_with_observers(State& state, size_t observers, size_t modified_rows)
+{
+    auto config = make_config(state.path());
+    auto writer = Realm::get_shared_realm(config);
+    add_objects(writer, object_count);
+    auto reader = Realm::get_shared_realm(config);
+    reader->m_binding_context.reset(new ObservingContext(object_table(reader)->get_index_in_group(), observers));
+
+    int64_t value = 0;
+    state.measure([&] {
+        reader->refresh();
+    }, [&] {
+        writer->begin_transaction();
+        auto table = object_table(writer);
+        ++value;
+        for (size_t i = 0; i < modified_rows; ++i) {
+            table->set_int(ColumnInt, i * (object_count / modified_rows), value);
+        }
+        writer->commit_transaction();
+    });
+}
+}
+
+REALM_BENCHMARK(transaction_log_no_observers) {
+    advance_with_observers(state, 0, 100);
+}
+
+REALM_BENCHMARK(transaction_log_10_observers) {
+    advance_with_observers(state, 10, 100);
+}
+
+REALM_BENCHMARK(transaction_log_1000_observers) {
+    advance_with_observers(state, 1000, 100);
+}
+
+REALM_BENCHMARK(transaction_log_1000_observers_large_commit) {
+    advance_with_observers(state, 1000, 10000);
+}
@@ -21,7 +21,10 @@
 
 #include "index_set.hpp"
 
+#include <algorithm>
+#include <cstdint>
 #include <tuple>
+#include <utility>
 #include <vector>
 
 namespace realm {
@@ -74,6 +77,18 @@ public:
     // a different Realm instance (possibly in a different process)
     virtual void changes_available() { }
 
+    // Called when the Realm is about to end its read transaction because it
+    // has not been refreshed for longer than its config's idle_read_timeout,
+    // before changes_available(). The binding can call Realm::invalidate()
+    // itself if it needs to do work around it; otherwise the Realm
+    // invalidates itself after this returns.
+    virtual void idle_read_expired() { }
+
+    // Called when Realm::trim_memory() is about to release the Realm's
+    // caches, so that the binding can release any of its own which can be
+    // rebuilt when next needed
+    virtual void will_trim_memory() { }
+
     struct ObserverState;
 
     // Override this function if you want to recieve detailed information about
@@ -100,6 +115,15 @@ public:
     virtual void did_change(std::vector<ObserverState> const& observers,
                             std::vector<void*> const& invalidated);
 
+    struct VersionChange;
+
+    // The same as above, but also with the versions the read transaction moved
+    // between and which tables were modified. This is the function the Realm
+    // calls; the default implementation just calls the two-argument version.
+    virtual void did_change(std::vector<ObserverState> const& observers,
+                            std::vector<void*> const& invalidated,
+                            VersionChange const& change);
+
     // Change information for a single field of a row
     struct ColumnInfo {
         // Did this column change?
@@ -123,8 +147,9 @@ public:
     // Each object which needs detailed change information should have an
     // ObserverState entry in the vector returned from get_observed_rows(), with
     // the initial table and row indexes set (and optionally the info field).
-    // The Realm parses the transaction log, and populates the `changes` vector
-    // in each ObserverState with information about what changes were made.
+    // The Realm parses the transaction log, and records in each ObserverState
+    // which columns were changed, which can then be read with
+    // for_each_change().
     struct ObserverState {
         // Initial table and row which is observed
         // May be updated by row insertions and removals
@@ -134,10 +159,82 @@ public:
         // Opaque userdata for the delegate's use
         void* info;
 
-        // Populated with information about which columns were changed
-        // May be shorter than the actual number of columns if the later columns
-        // are not modified
-        std::vector<ColumnInfo> changes;
+        // Bitmask of the columns which were changed. The first 64 columns are
+        // stored inline so that most objects need no allocations, and
+        // more_changed_columns is only as long as the highest changed column
+        // requires.
+        uint64_t changed_columns = 0;
+        std::vector<uint64_t> more_changed_columns;
+
+        // Details of the changes to LinkList columns, sorted by column. Only
+        // LinkList columns which were changed have an entry.
+        std::vector<std::pair<size_t, ColumnInfo>> linklist_changes;
+
+        bool column_changed(size_t col) const noexcept
+        {
+            if (col < 64) {
+                return changed_columns & (uint64_t(1) << col);
+            }
+            size_t word = col / 64 - 1;
+            return word < more_changed_columns.size() && (more_changed_columns[word] & (uint64_t(1) << (col % 64)));
+        }
+
+        void mark_changed(size_t col)
+        {
+            if (col < 64) {
+                changed_columns |= uint64_t(1) << col;
+                return;
+            }
+            size_t word = col / 64 - 1;
+            if (more_changed_columns.size() <= word) {
+                more_changed_columns.resize(word + 1);
+            }
+            more_changed_columns[word] |= uint64_t(1) << (col % 64);
+        }
+
+        // Get the change information for the given LinkList column, creating
+        // it if needed
+        ColumnInfo& linklist_change(size_t col)
+        {
+            auto it = std::lower_bound(linklist_changes.begin(), linklist_changes.end(), col,
+                                       [](auto const& change, size_t col) { return change.first < col; });
+            if (it == linklist_changes.end() || it->first != col) {
+                it = linklist_changes.insert(it, {col, ColumnInfo()});
+            }
+            return it->second;
+        }
+
+        // Call `fn(col, ColumnInfo const&)` for each changed column in order.
+        // Columns other than LinkLists are reported with a ColumnInfo with
+        // just `changed` set.
+        template<typename Func>
+        void for_each_change(Func&& fn) const
+        {
+            static const ColumnInfo modified = [] {
+                ColumnInfo info;
+                info.changed = true;
+                return info;
+            }();
+
+            auto linklist = linklist_changes.begin();
+            for (size_t word = 0; word <= more_changed_columns.size(); ++word) {
+                uint64_t bits = word == 0 ? changed_columns : more_changed_columns[word - 1];
+                for (size_t col = word * 64; bits; ++col, bits >>= 1) {
+                    if (!(bits & 1)) {
+                        continue;
+                    }
+                    while (linklist != linklist_changes.end() && linklist->first < col) {
+                        ++linklist;
+                    }
+                    if (linklist != linklist_changes.end() && linklist->first == col) {
+                        fn(col, linklist->second);
+                    }
+                    else {
+                        fn(col, modified);
+                    }
+                }
+            }
+        }
 
         // Simple lexographic ordering
         friend bool operator<(ObserverState const& lft, ObserverState const& rgt)
@@ -145,10 +242,42 @@ public:
             return std::tie(lft.table_ndx, lft.row_ndx) < std::tie(rgt.table_ndx, rgt.row_ndx);
         }
     };
+
+    // The read transaction versions before and after a change, and the tables
+    // which the commits in between modified. Both versions are zero if the
+    // Realm wasn't in a read transaction.
+    struct VersionChange {
+        uint_fast64_t old_version = 0;
+        uint_fast64_t new_version = 0;
+
+        // Is modified_tables populated? It isn't if the Realm doesn't track
+        // changes, after a local commit, or if tables were inserted (which
+        // shifts the indexes of the existing tables)
+        bool modified_tables_known = false;
+        // The indexes in the new version of the tables with rows which were
+        // inserted, erased or modified, in ascending order
+        std::vector<size_t> modified_tables;
+
+        // The number of commits the read transaction advanced over
+        uint_fast64_t commit_count() const noexcept { return new_version - old_version; }
+
+        // Can the given table have been modified? True if it isn't known
+        bool may_have_modified(size_t table_ndx) const noexcept
+        {
+            return !modified_tables_known
+                || std::binary_search(modified_tables.begin(), modified_tables.end(), table_ndx);
+        }
+    };
 };
 
 inline void BindingContext::will_change(std::vector<ObserverState> const&, std::vector<void*> const&) { }
 inline void BindingContext::did_change(std::vector<ObserverState> const&, std::vector<void*> const&) { }
+inline void BindingContext::did_change(std::vector<ObserverState> const& observers,
+                                       std::vector<void*> const& invalidated,
+                                       VersionChange const&)
+{
+    did_change(observers, invalidated);
+}
 } // namespace realm
 
 #endif /* BINDING_CONTEXT_HPP */
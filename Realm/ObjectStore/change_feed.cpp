@@ -0,0 +1,102 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "change_feed.hpp"
+
+#include "object_store.hpp"
+#include "transact_log_handler.hpp"
+
+#include <realm/commit_log.hpp>
+#include <realm/group.hpp>
+#include <realm/group_shared.hpp>
+
+#include <algorithm>
+
+using namespace realm;
+
+ChangeFeed::ChangeFeed(Realm& realm)
+: m_config(realm.config())
+{
+    realm.verify_thread();
+    if (!realm.m_shared_group) {
+        throw InvalidTransactionException("Can't create a change feed for a read-only Realm.");
+    }
+    if (realm.is_in_transaction()) {
+        throw InvalidTransactionException("Can't create a change feed within a write transaction.");
+    }
+
+    realm.read_group();
+    m_history = realm::make_client_history(m_config.path, m_config.encryption_key.data());
+    m_shared_group = std::make_unique<SharedGroup>(*m_history, m_config.in_memory ? SharedGroup::durability_MemOnly
+                                                                                  : SharedGroup::durability_Full,
+                                                   m_config.encryption_key.data());
+    // The Realm is reading this version, so it can't have been released yet
+    m_group = &m_shared_group->begin_read(realm.m_shared_group->get_version_of_current_transaction());
+}
+
+ChangeFeed::~ChangeFeed()
+{
+    m_shared_group->end_read();
+}
+
+uint_fast64_t ChangeFeed::version() const
+{
+    return m_shared_group->get_version_of_current_transaction().version;
+}
+
+ChangeSet ChangeFeed::next()
+{
+    ChangeSet changes;
+    changes.from_version = version();
+    _impl::transaction::advance_recording_changes(*m_shared_group, *m_history, changes.records);
+    changes.to_version = version();
+    if (changes.records.empty()) {
+        return changes;
+    }
+
+    // Resolve names from the schema at the final version, which is where the
+    // recorded table indexes refer to. Tables and columns are never removed
+    // while a Realm is open, so every one changed still exists.
+    size_t table_count = m_group->size();
+    changes.object_types.resize(table_count);
+    changes.properties.resize(table_count);
+    std::vector<bool> changed(table_count);
+    for (auto const& record : changes.records) {
+        changed[record.table] = true;
+    }
+    for (size_t i = 0; i < table_count; ++i) {
+        if (!changed[i]) {
+            continue;
+        }
+        changes.object_types[i] = ObjectStore::object_type_for_table_name(m_group->get_table_name(i));
+        if (changes.object_types[i].empty()) {
+            continue;
+        }
+        ConstTableRef table = m_group->get_table(i);
+        for (size_t col = 0, count = table->get_column_count(); col < count; ++col) {
+            changes.properties[i].push_back(table->get_column_name(col));
+        }
+    }
+
+    // Drop the changes to tables which don't store objects
+    auto& records = changes.records;
+    records.erase(std::remove_if(begin(records), end(records), [&](auto const& record) {
+        return changes.object_types[record.table].empty();
+    }), end(records));
+    return changes;
+}
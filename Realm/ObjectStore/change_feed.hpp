@@ -0,0 +1,145 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef REALM_CHANGE_FEED_HPP
+#define REALM_CHANGE_FEED_HPP
+
+#include "shared_realm.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace realm {
+class ClientHistory;
+class Group;
+class SharedGroup;
+
+// A value written by a change, decoded from the transaction log
+struct ChangeValue {
+    enum class Type {
+        Null,
+        Int,
+        Bool,
+        Float,
+        Double,
+        String,
+        Binary,
+        Date,   // seconds since 1970 in int_value
+        Link,   // the target row's index in int_value
+    };
+    Type type = Type::Null;
+    union {
+        int64_t int_value = 0;
+        bool bool_value;
+        float float_value;
+        double double_value;
+    };
+    // The contents of String and Binary values, copied out of the log
+    std::string data;
+};
+
+// A single change made by a commit. Row indexes are as of the point in the
+// sequence of changes at which the change was made, so applying the records
+// in order to a copy of the data at the starting version gives the data at
+// the final version.
+struct ChangeRecord {
+    enum class Kind {
+        Insert,       // `other` empty rows inserted before `row`
+        Erase,        // `other` rows erased starting at `row`
+        MoveLastOver, // `row` erased and the row at `other` moved into its place
+        Swap,         // `row` and `other` swapped
+        Clear,        // every row erased
+        Set,          // `column` of `row` set to `value`
+
+        // Changes to the link list in `column` of `row`. `value` is the
+        // linked row for ListSet and ListInsert.
+        ListSet,      // the link at `index` replaced
+        ListInsert,   // a link inserted at `index`
+        ListErase,    // the link at `index` removed
+        ListMove,     // the link at `index` moved to `other`
+        ListSwap,     // the links at `index` and `other` swapped
+        ListClear,    // every link removed
+    };
+    Kind kind;
+    // The table's index in the group at the final version
+    size_t table;
+    size_t row;
+    size_t column = npos;
+    size_t index = npos;
+    size_t other = npos;
+    ChangeValue value;
+};
+
+// The changes made by the commits in a range of versions
+struct ChangeSet {
+    uint_fast64_t from_version = 0;
+    uint_fast64_t to_version = 0;
+    // The object type and property names for each table and column, indexed
+    // as in the records
+    std::vector<std::string> object_types;
+    std::vector<std::vector<std::string>> properties;
+    std::vector<ChangeRecord> records;
+
+    std::string const& object_type(ChangeRecord const& record) const { return object_types[record.table]; }
+    std::string const& property(ChangeRecord const& record) const { return properties[record.table][record.column]; }
+};
+
+// Decodes the transaction logs kept by a Realm file's history into typed
+// change records, so that changes can be streamed elsewhere without having
+// to compare versions of the data. Each call to next() returns the changes
+// made by the commits since the previous call (or since the version the
+// feed was created at), with tables and columns resolved to the object types
+// and properties they store. Changes to tables which aren't object types,
+// such as the metadata and primary key tables, are left out, as are changes
+// to subtables, which the object store doesn't use.
+//
+// The feed holds a read transaction of its own at the last version it
+// returned changes up to, which pins that version: the file can't reuse the
+// space freed by later commits until the feed is advanced or destroyed.
+class ChangeFeed {
+public:
+    // Start the feed at the version the Realm is currently reading, so that
+    // the first changes returned are those made by the next commit. Must be
+    // called on the Realm's thread, outside of a write transaction. Throws
+    // InvalidTransactionException for read-only Realms, whose files have no
+    // history.
+    explicit ChangeFeed(Realm& realm);
+    ~ChangeFeed();
+
+    // The version which the next set of changes will start from
+    uint_fast64_t version() const;
+
+    // Decode the commits from version() to the newest version and advance
+    // the feed past them. The change set is empty if there were no commits.
+    // Can be called from any thread, but not from more than one at a time.
+    // Throws the same exception as refreshing a Realm would if another
+    // process made incompatible schema changes.
+    ChangeSet next();
+
+private:
+    Realm::Config m_config;
+    std::unique_ptr<ClientHistory> m_history;
+    std::unique_ptr<SharedGroup> m_shared_group;
+    // The group read by m_shared_group's read transaction
+    Group const* m_group;
+};
+} // namespace realm
+
+#endif /* REALM_CHANGE_FEED_HPP */
@@ -0,0 +1,267 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "column_statistics.hpp"
+
+#include <realm/table.hpp>
+#include <realm/table_view.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+using namespace realm;
+
+namespace {
+uint64_t mix(uint64_t value)
+{
+    value ^= value >> 30;
+    value *= 0xbf58476d1ce4e5b9ULL;
+    value ^= value >> 27;
+    value *= 0x94d049bb133111ebULL;
+    value ^= value >> 31;
+    return value;
+}
+
+uint64_t hash_bytes(const char* data, size_t size)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ static_cast<unsigned char>(data[i])) * 0x100000001b3ULL;
+    }
+    return mix(hash);
+}
+
+uint64_t hash_double(double value)
+{
+    if (value == 0) {
+        value = 0; // -0.0 and 0.0 are the same value
+    }
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof bits);
+    return mix(bits);
+}
+
+bool string_less(StringData a, StringData b)
+{
+    int cmp = std::memcmp(a.data(), b.data(), std::min(a.size(), b.size()));
+    return cmp < 0 || (cmp == 0 && a.size() < b.size());
+}
+
+// A HyperLogLog sketch, which estimates the number of distinct hashes added
+// to it to within about 3% using a fixed 1KB of memory
+class DistinctEstimator {
+public:
+    void add(uint64_t hash)
+    {
+        size_t index = hash >> (64 - precision);
+        // The bit below the ones remaining after the index caps the rank
+        uint64_t remaining = (hash << precision) | (uint64_t(1) << (precision - 1));
+        uint8_t rank = __builtin_clzll(remaining) + 1;
+        m_registers[index] = std::max(m_registers[index], rank);
+    }
+
+    size_t estimate() const
+    {
+        const double m = register_count;
+        double sum = 0;
+        size_t empty_registers = 0;
+        for (uint8_t rank : m_registers) {
+            sum += std::ldexp(1.0, -rank);
+            empty_registers += rank == 0;
+        }
+        double estimate = 0.7213 / (1 + 1.079 / m) * m * m / sum;
+        // Small cardinalities are estimated much better from how many
+        // registers are still empty
+        if (estimate <= 2.5 * m && empty_registers) {
+            estimate = m * std::log(m / empty_registers);
+        }
+        return static_cast<size_t>(estimate + 0.5);
+    }
+
+private:
+    static const size_t precision = 10;
+    static const size_t register_count = size_t(1) << precision;
+    std::array<uint8_t, register_count> m_registers{};
+};
+
+// The smallest and largest values seen, using the given ordering
+template<typename T>
+class ValueRange {
+public:
+    template<typename Less>
+    void add(T value, Less less)
+    {
+        if (m_empty) {
+            m_min = m_max = value;
+            m_empty = false;
+        }
+        else if (less(value, m_min)) {
+            m_min = value;
+        }
+        else if (less(m_max, value)) {
+            m_max = value;
+        }
+    }
+
+    void store(ColumnStatistics& stats) const
+    {
+        if (!m_empty) {
+            stats.min = Mixed(m_min);
+            stats.max = Mixed(m_max);
+        }
+    }
+
+private:
+    bool m_empty = true;
+    T m_min{};
+    T m_max{};
+};
+
+template<typename RowForIndex>
+ColumnStatistics compute_statistics(Table const& table, size_t column, size_t count, RowForIndex row_for_index)
+{
+    REALM_ASSERT(ColumnStatistics::is_supported(table.get_column_type(column)));
+
+    ColumnStatistics stats;
+    stats.count = count;
+    DistinctEstimator distinct;
+
+    auto type = table.get_column_type(column);
+    bool nullable = type != type_Link && table.is_nullable(column);
+    auto less = [](auto a, auto b) { return a < b; };
+
+    // Calls the function with each non-null row, counting the null ones
+    auto for_each_value = [&](auto&& fn) {
+        for (size_t i = 0; i < count; ++i) {
+            size_t row = row_for_index(i);
+            if (type == type_Link ? table.is_null_link(column, row) : nullable && table.is_null(column, row)) {
+                ++stats.null_count;
+                continue;
+            }
+            fn(row);
+        }
+    };
+
+    switch (type) {
+        case type_Int: {
+            ValueRange<int64_t> range;
+            for_each_value([&](size_t row) {
+                int64_t value = table.get_int(column, row);
+                distinct.add(mix(value));
+                range.add(value, less);
+            });
+            range.store(stats);
+            break;
+        }
+        case type_Bool: {
+            ValueRange<bool> range;
+            for_each_value([&](size_t row) {
+                bool value = table.get_bool(column, row);
+                distinct.add(mix(value));
+                range.add(value, less);
+            });
+            range.store(stats);
+            break;
+        }
+        case type_Float: {
+            ValueRange<float> range;
+            for_each_value([&](size_t row) {
+                float value = table.get_float(column, row);
+                distinct.add(hash_double(value));
+                if (!std::isnan(value)) {
+                    range.add(value, less);
+                }
+            });
+            range.store(stats);
+            break;
+        }
+        case type_Double: {
+            ValueRange<double> range;
+            for_each_value([&](size_t row) {
+                double value = table.get_double(column, row);
+                distinct.add(hash_double(value));
+                if (!std::isnan(value)) {
+                    range.add(value, less);
+                }
+            });
+            range.store(stats);
+            break;
+        }
+        case type_String: {
+            ValueRange<StringData> range;
+            for_each_value([&](size_t row) {
+                StringData value = table.get_string(column, row);
+                distinct.add(hash_bytes(value.data(), value.size()));
+                range.add(value, string_less);
+            });
+            range.store(stats);
+            break;
+        }
+        case type_DateTime: {
+            ValueRange<DateTime> range;
+            for_each_value([&](size_t row) {
+                DateTime value = table.get_datetime(column, row);
+                distinct.add(mix(value.get_datetime()));
+                range.add(value, [](DateTime a, DateTime b) { return a.get_datetime() < b.get_datetime(); });
+            });
+            range.store(stats);
+            break;
+        }
+        case type_Binary:
+            for_each_value([&](size_t row) {
+                BinaryData value = table.get_binary(column, row);
+                distinct.add(hash_bytes(value.data(), value.size()));
+            });
+            break;
+        case type_Link:
+            for_each_value([&](size_t row) {
+                distinct.add(mix(table.get_link(column, row)));
+            });
+            break;
+        default:
+            REALM_UNREACHABLE();
+    }
+
+    stats.distinct_count = std::min(distinct.estimate(), count - stats.null_count);
+    return stats;
+}
+} // anonymous namespace
+
+bool ColumnStatistics::is_supported(DataType type)
+{
+    switch (type) {
+        case type_Int: case type_Bool: case type_Float: case type_Double:
+        case type_String: case type_DateTime: case type_Binary: case type_Link:
+            return true;
+        default:
+            return false;
+    }
+}
+
+ColumnStatistics ColumnStatistics::compute(Table const& table, size_t column)
+{
+    return compute_statistics(table, column, table.size(), [](size_t i) { return i; });
+}
+
+ColumnStatistics ColumnStatistics::compute(TableView const& rows, size_t column)
+{
+    return compute_statistics(rows.get_parent(), column, rows.size(),
+                              [&](size_t i) { return rows.get_source_ndx(i); });
+}
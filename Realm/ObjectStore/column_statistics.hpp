@@ -0,0 +1,58 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef REALM_COLUMN_STATISTICS_HPP
+#define REALM_COLUMN_STATISTICS_HPP
+
+#include <realm/mixed.hpp>
+#include <realm/util/optional.hpp>
+
+#include <cstddef>
+
+namespace realm {
+class Table;
+class TableView;
+
+// Summary statistics of the values in a column, for estimating how selective
+// conditions on it are and for reporting on the data
+struct ColumnStatistics {
+    // The number of rows, and how many of them are null (or null links)
+    size_t count = 0;
+    size_t null_count = 0;
+    // An estimate of the number of distinct non-null values, which is
+    // usually within a few percent of the actual number and exact for small
+    // numbers of values. Links are distinct if they link to different rows.
+    size_t distinct_count = 0;
+    // The smallest and largest non-null values, for Int, Bool, Float,
+    // Double, String and DateTime columns. Strings are compared by their
+    // UTF-8 bytes and NaNs are skipped. String values point into the Realm
+    // and so are only valid until it changes.
+    util::Optional<Mixed> min;
+    util::Optional<Mixed> max;
+
+    // Whether statistics can be computed for a column of the given type
+    static bool is_supported(DataType type);
+
+    // Compute the statistics of a column over every row of the table, or
+    // over the rows of a view of it, in a single pass over the rows
+    static ColumnStatistics compute(Table const& table, size_t column);
+    static ColumnStatistics compute(TableView const& rows, size_t column);
+};
+} // namespace realm
+
+#endif /* REALM_COLUMN_STATISTICS_HPP */
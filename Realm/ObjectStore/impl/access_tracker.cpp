@@ -0,0 +1,116 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+
+#include "access_tracker.hpp"
+
+#include "transact_log_handler.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+using namespace realm;
+using namespace realm::_impl;
+
+void AccessTracker::touch(size_t table_ndx, size_t row)
+{
+    if (table_ndx >= m_tables.size()) {
+        m_tables.resize(table_ndx + 1);
+    }
+    auto& rows = m_tables[table_ndx];
+    if (row >= rows.size()) {
+        // Rows past the end were added since the table was last touched
+        rows.resize(row + 1, m_clock);
+    }
+    rows[row] = ++m_clock;
+}
+
+void AccessTracker::apply(TransactionChangeInfo const& info)
+{
+    if (info.schema_changed) {
+        // Table indexes may have shifted
+        clear();
+        return;
+    }
+
+    using Kind = TransactionChangeInfo::TableChanges::RowIndexChange::Kind;
+    for (size_t i = 0; i < info.tables.size() && i < m_tables.size(); ++i) {
+        auto const& changes = info.tables[i];
+        auto& rows = m_tables[i];
+        if (changes.row_indexes_lost) {
+            rows.clear();
+            continue;
+        }
+
+        for (auto const& change : changes.row_index_changes) {
+            switch (change.kind) {
+                case Kind::Insert:
+                    if (change.row < rows.size()) {
+                        rows.insert(rows.begin() + change.row, change.other_or_count, ++m_clock);
+                    }
+                    break;
+                case Kind::Erase:
+                    if (change.row < rows.size()) {
+                        size_t end = std::min(rows.size(), change.row + change.other_or_count);
+                        rows.erase(rows.begin() + change.row, rows.begin() + end);
+                    }
+                    break;
+                case Kind::MoveLastOver:
+                    if (change.row < rows.size()) {
+                        rows[change.row] = change.other_or_count < rows.size() ? rows[change.other_or_count] : m_clock;
+                    }
+                    if (change.other_or_count < rows.size()) {
+                        rows.resize(change.other_or_count);
+                    }
+                    break;
+                case Kind::Swap:
+                    if (change.row < rows.size() && change.other_or_count < rows.size()) {
+                        std::swap(rows[change.row], rows[change.other_or_count]);
+                    }
+                    break;
+                case Kind::Clear:
+                    rows.clear();
+                    break;
+            }
+        }
+    }
+}
+
+void AccessTracker::clear()
+{
+    m_tables.clear();
+}
+
+std::vector<size_t> AccessTracker::least_recently_used(size_t table_ndx, size_t size, size_t count) const
+{
+    static const std::vector<uint64_t> untracked;
+    auto const& rows = table_ndx < m_tables.size() ? m_tables[table_ndx] : untracked;
+    auto last_access = [&](size_t row) {
+        return row < rows.size() ? rows[row] : std::numeric_limits<uint64_t>::max();
+    };
+
+    std::vector<size_t> indexes(size);
+    std::iota(indexes.begin(), indexes.end(), 0);
+    count = std::min(count, size);
+    std::nth_element(indexes.begin(), indexes.begin() + count, indexes.end(), [&](size_t a, size_t b) {
+        return last_access(a) < last_access(b);
+    });
+    indexes.resize(count);
+    return indexes;
+}
@@ -0,0 +1,62 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef REALM_ACCESS_TRACKER_HPP
+#define REALM_ACCESS_TRACKER_HPP
+
+#include <cstdint>
+#include <vector>
+
+namespace realm {
+namespace _impl {
+struct TransactionChangeInfo;
+
+// The order in which the rows of each table were last accessed through a
+// Realm, for picking the least recently used objects to evict from a Realm
+// used as a size-limited cache. Each Realm instance has its own, so accesses
+// made on other threads aren't included.
+//
+// Rows are tracked by index, and those indexes are kept up to date with the
+// changes made by other Realms. Rows which the Realm itself moves or removes
+// are not, so the order is approximate after local deletions, and rows which
+// have never been tracked, such as ones inserted by other Realms, count as
+// the most recently used.
+class AccessTracker {
+public:
+    // Mark the row as the most recently accessed in its table
+    void touch(size_t table_ndx, size_t row);
+
+    // Update the tracked row indexes for changes made by other Realms
+    void apply(TransactionChangeInfo const& info);
+    void clear();
+
+    // The indexes of the `count` least recently accessed rows of the table,
+    // which has `size` rows, in no particular order
+    std::vector<size_t> least_recently_used(size_t table_ndx, size_t size, size_t count) const;
+
+private:
+    uint64_t m_clock = 0;
+    // The value of m_clock when each row was last accessed, indexed by table
+    // and then row
+    std::vector<std::vector<uint64_t>> m_tables;
+};
+} // namespace _impl
+} // namespace realm
+
+#endif /* REALM_ACCESS_TRACKER_HPP */
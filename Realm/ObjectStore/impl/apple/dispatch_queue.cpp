@@ -0,0 +1,120 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "dispatch_queue.hpp"
+
+#include <dispatch/dispatch.h>
+#include <memory>
+#include <pthread.h>
+#include <utility>
+
+using namespace realm;
+using namespace realm::_impl;
+
+namespace {
+// Each queue a Realm is confined to has this key set to the queue itself so
+// that code can check which queue it is running on. dispatch_get_current_queue()
+// is deprecated and does not work for queues which target other queues.
+char s_queue_key;
+
+dispatch_queue_t as_queue(void* queue)
+{
+    return static_cast<dispatch_queue_t>(queue);
+}
+} // anonymous namespace
+
+DispatchQueue::DispatchQueue(void* queue)
+: m_queue(queue)
+{
+    if (m_queue) {
+        dispatch_retain(as_queue(m_queue));
+        dispatch_queue_set_specific(as_queue(m_queue), &s_queue_key, m_queue, nullptr);
+    }
+}
+
+DispatchQueue::DispatchQueue(DispatchQueue const& other)
+: m_queue(other.m_queue)
+{
+    if (m_queue) {
+        dispatch_retain(as_queue(m_queue));
+    }
+}
+
+DispatchQueue::DispatchQueue(DispatchQueue&& other)
+: m_queue(other.m_queue)
+{
+    other.m_queue = nullptr;
+}
+
+DispatchQueue& DispatchQueue::operator=(DispatchQueue const& other)
+{
+    DispatchQueue copy(other);
+    std::swap(m_queue, copy.m_queue);
+    return *this;
+}
+
+DispatchQueue& DispatchQueue::operator=(DispatchQueue&& other)
+{
+    std::swap(m_queue, other.m_queue);
+    return *this;
+}
+
+DispatchQueue::~DispatchQueue()
+{
+    if (m_queue) {
+        dispatch_release(as_queue(m_queue));
+    }
+}
+
+bool DispatchQueue::is_current() const
+{
+    return m_queue && dispatch_get_specific(&s_queue_key) == m_queue;
+}
+
+void DispatchQueue::async(std::function<void ()> fn) const
+{
+    async_after(std::chrono::nanoseconds::zero(), std::move(fn));
+}
+
+void DispatchQueue::async_after(std::chrono::nanoseconds delay, std::function<void ()> fn) const
+{
+    auto context = new std::function<void ()>(std::move(fn));
+    auto run = [](void* context) {
+        std::unique_ptr<std::function<void ()>> fn(static_cast<std::function<void ()>*>(context));
+        (*fn)();
+    };
+    if (delay <= std::chrono::nanoseconds::zero()) {
+        dispatch_async_f(as_queue(m_queue), context, run);
+    }
+    else {
+        dispatch_after_f(dispatch_time(DISPATCH_TIME_NOW, delay.count()), as_queue(m_queue), context, run);
+    }
+}
+
+void DispatchQueue::apply(size_t count, std::function<void (size_t)> const& fn)
+{
+    auto context = const_cast<std::function<void (size_t)>*>(&fn);
+    dispatch_apply_f(count, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), context, [](void* context, size_t i) {
+        (*static_cast<std::function<void (size_t)>*>(context))(i);
+    });
+}
+
+void realm::_impl::set_current_thread_name(const char* name)
+{
+    pthread_setname_np(name);
+}
@@ -0,0 +1,70 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef REALM_DISPATCH_QUEUE_HPP
+#define REALM_DISPATCH_QUEUE_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+
+namespace realm {
+namespace _impl {
+// A retained reference to a serial dispatch queue which a Realm can be
+// confined to instead of a thread. dispatch_queue_t is an Objective-C object
+// type when compiled as Objective-C and a C struct pointer otherwise, so the
+// queue is held as an opaque pointer to keep this usable from both.
+class DispatchQueue {
+public:
+    DispatchQueue() = default;
+    // Retains the queue, which must be a serial queue
+    explicit DispatchQueue(void* queue);
+    DispatchQueue(DispatchQueue const&);
+    DispatchQueue(DispatchQueue&&);
+    DispatchQueue& operator=(DispatchQueue const&);
+    DispatchQueue& operator=(DispatchQueue&&);
+    ~DispatchQueue();
+
+    explicit operator bool() const noexcept { return m_queue != nullptr; }
+    void* get() const noexcept { return m_queue; }
+
+    // Is the calling code running on this queue (or on a queue targeting it)?
+    bool is_current() const;
+
+    // Asynchronously run the function on the queue, optionally after a delay
+    void async(std::function<void ()> fn) const;
+    void async_after(std::chrono::nanoseconds delay, std::function<void ()> fn) const;
+
+    // Call the function with each index in [0, count) concurrently on the
+    // global concurrent queue, returning once all of the calls have completed
+    static void apply(size_t count, std::function<void (size_t)> const& fn);
+
+    bool operator==(DispatchQueue const& other) const noexcept { return m_queue == other.m_queue; }
+    bool operator!=(DispatchQueue const& other) const noexcept { return m_queue != other.m_queue; }
+
+private:
+    void* m_queue = nullptr;
+};
+
+// Name the calling thread for debuggers and profilers
+void set_current_thread_name(const char* name);
+
+} // namespace _impl
+} // namespace realm
+
+#endif /* REALM_DISPATCH_QUEUE_HPP */
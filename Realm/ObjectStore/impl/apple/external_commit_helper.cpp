@@ -18,30 +18,107 @@
 
 #include "external_commit_helper.hpp"
 
+#include "change_calculator.hpp"
 #include "shared_realm.hpp"
+#include "trace.hpp"
 
+#include <algorithm>
 #include <assert.h>
+#include <cstdio>
+#include <pthread/qos.h>
 #include <sys/event.h>
 #include <sys/stat.h>
 #include <sys/time.h>
 #include <system_error>
 #include <fcntl.h>
+#include <notify.h>
 #include <unistd.h>
 #include <sstream>
 
 using namespace realm;
 using namespace realm::_impl;
 
+namespace {
+// Call the function with each of the runloop modes which the Realm's
+// notification sources and timers should be added to
+template<typename Fn>
+void for_each_runloop_mode(Realm::Config const& config, Fn&& fn)
+{
+    if (config.notification_runloop_modes.empty()) {
+        fn(kCFRunLoopDefaultMode);
+        return;
+    }
+    for (auto const& mode : config.notification_runloop_modes) {
+        CFStringRef cf_mode = CFStringCreateWithCString(kCFAllocatorDefault, mode.c_str(), kCFStringEncodingUTF8);
+        fn(cf_mode);
+        CFRelease(cf_mode);
+    }
+}
+} // anonymous namespace
+
 #if TARGET_OS_TV
+namespace {
+// tvOS apps can't create named pipes, so commits are announced with a Darwin
+// notification named after a hash of the Realm file's path, which is the same
+// in every process sharing the file through an app group container
+std::string notification_name_for_path(std::string const& path)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (char c : path) {
+        hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001b3ULL;
+    }
+    char name[64];
+    snprintf(name, sizeof name, "io.realm.commit.%016llx", static_cast<unsigned long long>(hash));
+    return name;
+}
+} // anonymous namespace
+
+// Each helper receives the Darwin notifications for its file through a file
+// descriptor from notify_register_file_descriptor(), which has a token
+// written to it each time the notification is posted by any process,
+// including this one. The helper's listener thread waits for the descriptor
+// to become readable with kqueue(), along with a user event which tells it
+// to exit, so no thread polls for changes.
 ExternalCommitHelper::ExternalCommitHelper(Realm* realm)
+: m_notification_name(notification_name_for_path(realm->config().path))
 {
+    m_kq = kqueue();
+    if (m_kq == -1) {
+        throw std::system_error(errno, std::system_category());
+    }
+
+    if (notify_register_file_descriptor(m_notification_name.c_str(), &m_notify_fd, 0, &m_notify_token) != NOTIFY_STATUS_OK) {
+        ::close(m_kq);
+        throw std::runtime_error("Failed to register for commit notifications for '" + realm->config().path + "'");
+    }
+    // The tokens are drained after each wakeup without blocking
+    fcntl(m_notify_fd, F_SETFL, fcntl(m_notify_fd, F_GETFL) | O_NONBLOCK);
+
+    struct kevent ke[2];
+    EV_SET(&ke[0], m_notify_fd, EVFILT_READ, EV_ADD, 0, 0, nullptr);
+    EV_SET(&ke[1], c_shutdown_event, EVFILT_USER, EV_ADD | EV_CLEAR, 0, 0, nullptr);
+    if (kevent(m_kq, ke, 2, nullptr, 0, nullptr) == -1) {
+        int err = errno;
+        notify_cancel(m_notify_token);
+        ::close(m_kq);
+        throw std::system_error(err, std::system_category());
+    }
+
     add_realm(realm);
 
+    auto const& config = realm->config();
+    if (config.compute_changes_in_background && !config.read_only) {
+        m_change_calculator = std::make_unique<ChangeCalculator>(config, [this] { signal_commits(); });
+    }
+
     // Use the minimum allowed stack size, as we need very little in our listener
     // https://developer.apple.com/library/ios/documentation/Cocoa/Conceptual/Multithreading/CreatingThreads/CreatingThreads.html#//apple_ref/doc/uid/10000057i-CH15-SW7
     pthread_attr_t attr;
     pthread_attr_init(&attr);
     pthread_attr_setstacksize(&attr, 16 * 1024);
+    if (config.notification_thread_qos) {
+        pthread_attr_set_qos_class_np(&attr, qos_class_t(config.notification_thread_qos), 0);
+    }
 
     auto fn = [](void *self) -> void * {
         static_cast<ExternalCommitHelper *>(self)->listen();
@@ -50,18 +127,33 @@ ExternalCommitHelper::ExternalCommitHelper(Realm* realm)
     int ret = pthread_create(&m_thread, &attr, fn, this);
     pthread_attr_destroy(&attr);
     if (ret != 0) {
-        throw std::system_error(errno, std::system_category());
+        notify_cancel(m_notify_token);
+        ::close(m_kq);
+        throw std::system_error(ret, std::system_category());
     }
 }
 
 ExternalCommitHelper::~ExternalCommitHelper()
 {
     REALM_ASSERT_DEBUG(m_realms.empty());
+
+    struct kevent ke;
+    EV_SET(&ke, c_shutdown_event, EVFILT_USER, 0, NOTE_TRIGGER, 0, nullptr);
+    kevent(m_kq, &ke, 1, nullptr, 0, nullptr);
     pthread_join(m_thread, nullptr); // Wait for the thread to exit
+
+    // Cancelling the registration also closes the descriptor
+    notify_cancel(m_notify_token);
+    ::close(m_kq);
 }
 
 void ExternalCommitHelper::add_realm(realm::Realm* realm)
 {
+    if (realm->config().dispatch_queue) {
+        add_queue_realm(realm);
+        return;
+    }
+
     std::lock_guard<std::mutex> lock(m_realms_mutex);
 
     // Create the runloop source
@@ -74,9 +166,12 @@ void ExternalCommitHelper::add_realm(realm::Realm* realm)
     CFRunLoopRef runloop = CFRunLoopGetCurrent();
     CFRetain(runloop);
     CFRunLoopSourceRef signal = CFRunLoopSourceCreate(kCFAllocatorDefault, 0, &ctx);
-    CFRunLoopAddSource(runloop, signal, kCFRunLoopDefaultMode);
+    for_each_runloop_mode(realm->config(), [&](CFStringRef mode) {
+        CFRunLoopAddSource(runloop, signal, mode);
+    });
 
     m_realms.push_back({realm, runloop, signal});
+    add_coalescing_timer(m_realms.back());
 }
 
 void ExternalCommitHelper::remove_realm(realm::Realm* realm)
@@ -84,9 +179,15 @@ void ExternalCommitHelper::remove_realm(realm::Realm* realm)
     std::lock_guard<std::mutex> lock(m_realms_mutex);
     for (auto it = m_realms.begin(); it != m_realms.end(); ++it) {
         if (it->realm == realm) {
-            CFRunLoopSourceInvalidate(it->signal);
-            CFRelease(it->signal);
-            CFRelease(it->runloop);
+            if (it->coalescing_timer) {
+                CFRunLoopTimerInvalidate(it->coalescing_timer);
+                CFRelease(it->coalescing_timer);
+            }
+            if (it->signal) {
+                CFRunLoopSourceInvalidate(it->signal);
+                CFRelease(it->signal);
+                CFRelease(it->runloop);
+            }
             m_realms.erase(it);
             return;
         }
@@ -97,18 +198,38 @@ void ExternalCommitHelper::remove_realm(realm::Realm* realm)
 void ExternalCommitHelper::listen()
 {
     pthread_setname_np("RLMRealm notification listener");
+
+    while (true) {
+        struct kevent events[2];
+        int count = kevent(m_kq, nullptr, 0, events, 2, nullptr);
+        if (count == -1 && errno == EINTR) {
+            continue;
+        }
+        assert(count >= 0);
+
+        bool commit = false;
+        for (int i = 0; i < count; ++i) {
+            if (events[i].filter == EVFILT_USER) {
+                return;
+            }
+            commit = true;
+        }
+        if (!commit) {
+            continue;
+        }
+
+        // Several commits posted before the thread woke up are handled as one
+        int token;
+        while (read(m_notify_fd, &token, sizeof token) == sizeof token) {
+        }
+        REALM_TRACE_POINT(ExternalCommit, nullptr, 0, count);
+        commit_available();
+    }
 }
 
 void ExternalCommitHelper::notify_others()
 {
-    std::lock_guard<std::mutex> lock(m_realms_mutex);
-    for (auto const& realm : m_realms) {
-        CFRunLoopSourceSignal(realm.signal);
-        // Signalling the source makes it run the next time the runloop gets
-        // to it, but doesn't make the runloop start if it's currently idle
-        // waiting for events
-        CFRunLoopWakeUp(realm.runloop);
-    }
+    notify_post(m_notification_name.c_str());
 }
 
 #else
@@ -162,18 +283,144 @@ void ExternalCommitHelper::FdHolder::close()
 // Listening for external changes is done using kqueue() on a background thread.
 // kqueue() lets us efficiently wait until the amount of data which can be read
 // from one or more file descriptors has changed, and tells us which of the file
-// descriptors it was that changed. We use this to wait on both the shared named
-// pipe, and a local anonymous pipe. When data is written to the named pipe, we
-// signal the runloop source and wake up the target runloop, and when data is
-// written to the anonymous pipe the background thread removes the runloop
-// source from the runloop and and shuts down.
+// descriptors it was that changed. A single thread and kqueue are shared by
+// every file the process has open, with each ExternalCommitHelper registering
+// its named pipe when it is created and removing it when it is destroyed. When
+// data is written to one of the named pipes, we signal the runloop sources of
+// the Realms for that file and wake up their runloops.
+namespace realm {
+namespace _impl {
+class NotificationListener {
+public:
+    // Created on first use and never destroyed, as the thread is blocked in
+    // kevent() for the life of the process
+    static NotificationListener& shared()
+    {
+        static NotificationListener* listener = new NotificationListener;
+        return *listener;
+    }
+
+    void add(ExternalCommitHelper* helper, int fd, unsigned int qos)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        // The listener thread applies the new class to itself when woken
+        if (qos > m_qos) {
+            m_qos = qos;
+            struct kevent ke;
+            EV_SET(&ke, c_qos_changed_event, EVFILT_USER, 0, NOTE_TRIGGER, 0, nullptr);
+            kevent(m_kq, &ke, 1, nullptr, 0, nullptr);
+        }
+
+        // EVFILT_READ indicates that we care about data being available to read
+        // on the given file descriptor.
+        // EV_CLEAR makes it wait for the amount of data available to be read to
+        // change rather than just returning when there is any data to read.
+        struct kevent ke;
+        EV_SET(&ke, fd, EVFILT_READ, EV_ADD | EV_CLEAR, 0, 0, helper);
+        if (kevent(m_kq, &ke, 1, nullptr, 0, nullptr) == -1) {
+            throw std::system_error(errno, std::system_category());
+        }
+        m_helpers.push_back(helper);
+    }
+
+    // Once this returns the helper will not be called again
+    void remove(ExternalCommitHelper* helper, int fd)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        struct kevent ke;
+        EV_SET(&ke, fd, EVFILT_READ, EV_DELETE, 0, 0, helper);
+        kevent(m_kq, &ke, 1, nullptr, 0, nullptr);
+        m_helpers.erase(std::remove(m_helpers.begin(), m_helpers.end(), helper), m_helpers.end());
+    }
+
+private:
+    // The identifier of the user event which tells the listener thread that
+    // m_qos has been raised
+    static const uintptr_t c_qos_changed_event = 0;
+
+    int m_kq;
+    std::mutex m_mutex;
+    std::vector<ExternalCommitHelper*> m_helpers;
+    // The highest QoS class requested by the config of any Realm which has
+    // been opened, which the listener thread runs at. Guarded by m_mutex.
+    unsigned int m_qos = 0;
+
+    NotificationListener()
+    {
+        m_kq = kqueue();
+        if (m_kq == -1) {
+            throw std::system_error(errno, std::system_category());
+        }
+
+        struct kevent ke;
+        EV_SET(&ke, c_qos_changed_event, EVFILT_USER, EV_ADD | EV_CLEAR, 0, 0, nullptr);
+        if (kevent(m_kq, &ke, 1, nullptr, 0, nullptr) == -1) {
+            ::close(m_kq);
+            throw std::system_error(errno, std::system_category());
+        }
+
+        // Use the minimum allowed stack size, as we need very little in our listener
+        // https://developer.apple.com/library/ios/documentation/Cocoa/Conceptual/Multithreading/CreatingThreads/CreatingThreads.html#//apple_ref/doc/uid/10000057i-CH15-SW7
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        pthread_attr_setstacksize(&attr, 16 * 1024);
+        pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+
+        auto fn = [](void *self) -> void * {
+            static_cast<NotificationListener *>(self)->listen();
+            return nullptr;
+        };
+        pthread_t thread;
+        int ret = pthread_create(&thread, &attr, fn, this);
+        pthread_attr_destroy(&attr);
+        if (ret != 0) {
+            ::close(m_kq);
+            throw std::system_error(ret, std::system_category());
+        }
+    }
+
+    void listen()
+    {
+        pthread_setname_np("RLMRealm notification listener");
+
+        while (true) {
+            struct kevent events[16];
+            // Wait for data to become available on any of the named pipes
+            int count = kevent(m_kq, nullptr, 0, events, 16, nullptr);
+            if (count == -1 && errno == EINTR) {
+                continue;
+            }
+            assert(count >= 0);
+
+            // Helpers are only called with the lock held so that they can't
+            // be destroyed while being notified
+            std::lock_guard<std::mutex> lock(m_mutex);
+            REALM_TRACE_POINT(ExternalCommit, nullptr, 0, count);
+            for (int i = 0; i < count; ++i) {
+                if (events[i].filter == EVFILT_USER) {
+                    pthread_set_qos_class_self_np(qos_class_t(m_qos), 0);
+                    continue;
+                }
+                auto helper = static_cast<ExternalCommitHelper*>(events[i].udata);
+                // The event may have been queued before the helper was removed
+                if (std::find(m_helpers.begin(), m_helpers.end(), helper) != m_helpers.end()) {
+                    helper->commit_available();
+                }
+            }
+        }
+    }
+};
+} // namespace _impl
+} // namespace realm
+
 ExternalCommitHelper::ExternalCommitHelper(Realm* realm)
 {
     add_realm(realm);
 
-    m_kq = kqueue();
-    if (m_kq == -1) {
-        throw std::system_error(errno, std::system_category());
+    auto const& config = realm->config();
+    if (config.compute_changes_in_background && !config.read_only) {
+        m_change_calculator = std::make_unique<ChangeCalculator>(config, [this] { signal_commits(); });
     }
 
     auto path = realm->config().path + ".note";
@@ -211,42 +458,22 @@ ExternalCommitHelper::ExternalCommitHelper(Realm* realm)
         throw std::system_error(errno, std::system_category());
     }
 
-    // Create the anonymous pipe
-    int pipeFd[2];
-    ret = pipe(pipeFd);
-    if (ret == -1) {
-        throw std::system_error(errno, std::system_category());
-    }
-
-    m_shutdown_read_fd = pipeFd[0];
-    m_shutdown_write_fd = pipeFd[1];
-
-    // Use the minimum allowed stack size, as we need very little in our listener
-    // https://developer.apple.com/library/ios/documentation/Cocoa/Conceptual/Multithreading/CreatingThreads/CreatingThreads.html#//apple_ref/doc/uid/10000057i-CH15-SW7
-    pthread_attr_t attr;
-    pthread_attr_init(&attr);
-    pthread_attr_setstacksize(&attr, 16 * 1024);
-
-    auto fn = [](void *self) -> void * {
-        static_cast<ExternalCommitHelper *>(self)->listen();
-        return nullptr;
-    };
-    ret = pthread_create(&m_thread, &attr, fn, this);
-    pthread_attr_destroy(&attr);
-    if (ret != 0) {
-        throw std::system_error(errno, std::system_category());
-    }
+    NotificationListener::shared().add(this, m_notify_fd, config.notification_thread_qos);
 }
 
 ExternalCommitHelper::~ExternalCommitHelper()
 {
     REALM_ASSERT_DEBUG(m_realms.empty());
-    notify_fd(m_shutdown_write_fd);
-    pthread_join(m_thread, nullptr); // Wait for the thread to exit
+    NotificationListener::shared().remove(this, m_notify_fd);
 }
 
 void ExternalCommitHelper::add_realm(realm::Realm* realm)
 {
+    if (realm->config().dispatch_queue) {
+        add_queue_realm(realm);
+        return;
+    }
+
     std::lock_guard<std::mutex> lock(m_realms_mutex);
 
     struct RefCountedWeakPointer {
@@ -276,9 +503,12 @@ void ExternalCommitHelper::add_realm(realm::Realm* realm)
     CFRunLoopRef runloop = CFRunLoopGetCurrent();
     CFRetain(runloop);
     CFRunLoopSourceRef signal = CFRunLoopSourceCreate(kCFAllocatorDefault, 0, &ctx);
-    CFRunLoopAddSource(runloop, signal, kCFRunLoopDefaultMode);
+    for_each_runloop_mode(realm->config(), [&](CFStringRef mode) {
+        CFRunLoopAddSource(runloop, signal, mode);
+    });
 
     m_realms.push_back({realm, runloop, signal});
+    add_coalescing_timer(m_realms.back());
 }
 
 void ExternalCommitHelper::remove_realm(realm::Realm* realm)
@@ -286,9 +516,15 @@ void ExternalCommitHelper::remove_realm(realm::Realm* realm)
     std::lock_guard<std::mutex> lock(m_realms_mutex);
     for (auto it = m_realms.begin(); it != m_realms.end(); ++it) {
         if (it->realm == realm) {
-            CFRunLoopSourceInvalidate(it->signal);
-            CFRelease(it->signal);
-            CFRelease(it->runloop);
+            if (it->coalescing_timer) {
+                CFRunLoopTimerInvalidate(it->coalescing_timer);
+                CFRelease(it->coalescing_timer);
+            }
+            if (it->signal) {
+                CFRunLoopSourceInvalidate(it->signal);
+                CFRelease(it->signal);
+                CFRelease(it->runloop);
+            }
             m_realms.erase(it);
             return;
         }
@@ -296,54 +532,169 @@ void ExternalCommitHelper::remove_realm(realm::Realm* realm)
     REALM_TERMINATE("Realm not registered");
 }
 
-void ExternalCommitHelper::listen()
+void ExternalCommitHelper::notify_others()
 {
-    pthread_setname_np("RLMRealm notification listener");
+    notify_fd(m_notify_fd);
+}
+#endif
+
+void ExternalCommitHelper::add_queue_realm(realm::Realm* realm)
+{
+    std::lock_guard<std::mutex> lock(m_realms_mutex);
 
+    PerRealmInfo info{realm, nullptr, nullptr};
+    info.queue = realm->config().dispatch_queue;
+    info.weak_realm = realm->shared_from_this();
+    info.queue_signal_pending = std::make_shared<std::atomic<bool>>(false);
+    info.notification_interval = realm->config().notification_interval;
+    m_realms.push_back(std::move(info));
+}
 
-    // Set up the kqueue
-    // EVFILT_READ indicates that we care about data being available to read
-    // on the given file descriptor.
-    // EV_CLEAR makes it wait for the amount of data available to be read to
-    // change rather than just returning when there is any data to read.
-    struct kevent ke[2];
-    EV_SET(&ke[0], m_notify_fd, EVFILT_READ, EV_ADD | EV_CLEAR, 0, 0, 0);
-    EV_SET(&ke[1], m_shutdown_read_fd, EVFILT_READ, EV_ADD | EV_CLEAR, 0, 0, 0);
-    int ret = kevent(m_kq, ke, 2, nullptr, 0, nullptr);
-    assert(ret == 0);
+void ExternalCommitHelper::add_coalescing_timer(PerRealmInfo& info)
+{
+    info.notification_interval = info.realm->config().notification_interval;
+    if (info.notification_interval == std::chrono::milliseconds::zero()) {
+        return;
+    }
 
-    while (true) {
-        struct kevent event;
-        // Wait for data to become on either fd
-        // Return code is number of bytes available or -1 on error
-        ret = kevent(m_kq, nullptr, 0, &event, 1, nullptr);
-        assert(ret >= 0);
-        if (ret == 0) {
-            // Spurious wakeup; just wait again
-            continue;
+    // The timer is only armed by signal_commit(), so it starts out far in the
+    // future with an interval long enough that it never repeats on its own.
+    // Firing just signals the source, which then runs on the same runloop.
+    const CFTimeInterval never = 1e10;
+    CFRunLoopTimerContext ctx{};
+    ctx.info = info.signal;
+    ctx.retain = CFRetain;
+    ctx.release = CFRelease;
+    info.coalescing_timer = CFRunLoopTimerCreate(kCFAllocatorDefault, CFAbsoluteTimeGetCurrent() + never, never, 0, 0,
+                                                 [](CFRunLoopTimerRef, void* source) {
+        CFRunLoopSourceSignal(static_cast<CFRunLoopSourceRef>(source));
+    }, &ctx);
+    for_each_runloop_mode(info.realm->config(), [&](CFStringRef mode) {
+        CFRunLoopAddTimer(info.runloop, info.coalescing_timer, mode);
+    });
+}
+
+// Queue-confined Realms are signalled by dispatching to their queue. The
+// pending flag is set until the block runs so that signals are coalesced.
+static void signal_queue(DispatchQueue const& queue, std::shared_ptr<std::atomic<bool>> const& pending,
+                         std::weak_ptr<Realm> const& weak_realm, std::chrono::nanoseconds delay)
+{
+    if (pending->exchange(true)) {
+        return;
+    }
+
+    queue.async_after(delay, [=] {
+        pending->store(false);
+        // The Realm may have been closed after the block was queued
+        auto realm = weak_realm.lock();
+        if (realm && !realm->is_closed()) {
+            realm->notify();
         }
+    });
+}
+
+void ExternalCommitHelper::signal(PerRealmInfo const& info)
+{
+    if (info.queue) {
+        signal_queue(info.queue, info.queue_signal_pending, info.weak_realm, std::chrono::nanoseconds::zero());
+        return;
+    }
+
+    CFRunLoopSourceSignal(info.signal);
+    // Signalling the source makes it run the next time the runloop gets
+    // to it, but doesn't make the runloop start if it's currently idle
+    // waiting for events
+    CFRunLoopWakeUp(info.runloop);
+}
+
+void ExternalCommitHelper::signal_commit(PerRealmInfo& info)
+{
+    auto now = std::chrono::steady_clock::now();
+    if (info.notification_interval == std::chrono::milliseconds::zero()
+        || now >= info.last_commit_signal + info.notification_interval) {
+        info.last_commit_signal = now;
+        signal(info);
+        return;
+    }
+    if (now < info.delayed_signal_time) {
+        // The pending delayed signal will deliver this commit too
+        return;
+    }
 
-        // Check which file descriptor had activity: if it's the shutdown
-        // pipe, then someone called -stop; otherwise it's the named pipe
-        // and someone committed a write transaction
-        if (event.ident == (uint32_t)m_shutdown_read_fd) {
+    auto time = info.last_commit_signal + info.notification_interval;
+    info.last_commit_signal = time;
+    info.delayed_signal_time = time;
+    if (info.queue) {
+        signal_queue(info.queue, info.queue_signal_pending, info.weak_realm, time - now);
+    }
+    else {
+        auto delay = std::chrono::duration_cast<std::chrono::duration<CFTimeInterval>>(time - now);
+        CFRunLoopTimerSetNextFireDate(info.coalescing_timer, CFAbsoluteTimeGetCurrent() + delay.count());
+    }
+}
+
+void ExternalCommitHelper::invoke_on_realm_thread(realm::Realm* realm, std::function<void ()> fn)
+{
+    std::lock_guard<std::mutex> lock(m_realms_mutex);
+    for (auto& info : m_realms) {
+        if (info.realm == realm) {
+            info.pending_invocations.push_back(std::move(fn));
+            signal(info);
             return;
         }
-        assert(event.ident == (uint32_t)m_notify_fd);
+    }
+}
 
-        std::lock_guard<std::mutex> lock(m_realms_mutex);
-        for (auto const& realm : m_realms) {
-            CFRunLoopSourceSignal(realm.signal);
-            // Signalling the source makes it run the next time the runloop gets
-            // to it, but doesn't make the runloop start if it's currently idle
-            // waiting for events
-            CFRunLoopWakeUp(realm.runloop);
+void ExternalCommitHelper::signal_realm(realm::Realm* realm)
+{
+    std::lock_guard<std::mutex> lock(m_realms_mutex);
+    for (auto const& info : m_realms) {
+        if (info.realm == realm) {
+            signal(info);
+            return;
         }
     }
 }
 
-void ExternalCommitHelper::notify_others()
+void ExternalCommitHelper::commit_available()
 {
-    notify_fd(m_notify_fd);
+    if (m_change_calculator) {
+        m_change_calculator->request_update();
+    }
+    else {
+        signal_commits();
+    }
+}
+
+void ExternalCommitHelper::signal_commits()
+{
+    std::lock_guard<std::mutex> lock(m_realms_mutex);
+    for (auto& realm : m_realms) {
+        signal_commit(realm);
+    }
+}
+
+bool ExternalCommitHelper::get_precomputed_changes(uint_fast64_t version, TransactionChangeInfo& changes,
+                                                   std::shared_ptr<RealmSnapshot>& target)
+{
+    return m_change_calculator && m_change_calculator->get_changes(version, changes, target);
+}
+
+void ExternalCommitHelper::run_pending_invocations(realm::Realm* realm)
+{
+    std::vector<std::function<void ()>> pending;
+    {
+        std::lock_guard<std::mutex> lock(m_realms_mutex);
+        for (auto& info : m_realms) {
+            if (info.realm == realm) {
+                pending.swap(info.pending_invocations);
+                break;
+            }
+        }
+    }
+
+    // Run without holding the lock as the functions may queue more work
+    for (auto& fn : pending) {
+        fn();
+    }
 }
-#endif
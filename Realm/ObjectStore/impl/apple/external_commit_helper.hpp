@@ -19,14 +19,27 @@
 #ifndef REALM_EXTERNAL_COMMIT_HELPER_HPP
 #define REALM_EXTERNAL_COMMIT_HELPER_HPP
 
+#include "dispatch_queue.hpp"
+
 #include <CoreFoundation/CFRunLoop.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include <mutex>
+#include <string>
 #include <vector>
 
 namespace realm {
 class Realm;
+class RealmSnapshot;
 
 namespace _impl {
+class ChangeCalculator;
+class NotificationListener;
+struct TransactionChangeInfo;
+
 #if TARGET_OS_TV
 class ExternalCommitHelper {
 public:
@@ -37,14 +50,74 @@ public:
     void add_realm(Realm* realm);
     void remove_realm(Realm* realm);
 
+    // Run the function on the given Realm's thread the next time it processes
+    // notifications. Does nothing if the Realm has been removed. Can be
+    // called from any thread.
+    void invoke_on_realm_thread(Realm* realm, std::function<void ()> fn);
+    // Run all functions queued for the Realm. Must be called on its thread.
+    void run_pending_invocations(Realm* realm);
+    // Make the Realm process notifications again on its thread even though
+    // nothing new has been committed. Can be called from any thread.
+    void signal_realm(Realm* realm);
+
+    // Get the changes from the given version which were computed in the
+    // background, if the file's first Realm asked for that, along with a
+    // snapshot pinning the version they end at. Returns false if they
+    // aren't available. Can be called from any thread.
+    bool get_precomputed_changes(uint_fast64_t version, TransactionChangeInfo& changes,
+                                 std::shared_ptr<RealmSnapshot>& target);
+
+    // The time of the most recent commit announced with notify_others() by a
+    // Realm in this process, for measuring how long it takes the other Realms
+    // to be notified of it. Can be called from any thread.
+    void set_last_commit_time(std::chrono::steady_clock::time_point time)
+    {
+        m_last_commit_time = time.time_since_epoch().count();
+    }
+    std::chrono::steady_clock::time_point last_commit_time() const
+    {
+        return std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(m_last_commit_time.load()));
+    }
+
 private:
+    std::atomic<std::chrono::steady_clock::rep> m_last_commit_time{0};
+
     struct PerRealmInfo {
         Realm* realm;
         CFRunLoopRef runloop;
         CFRunLoopSourceRef signal;
+        // Realms confined to a dispatch queue are notified by dispatching to
+        // the queue rather than with a runloop source. The flag is set while
+        // a notification is queued so that they are coalesced like a source's.
+        DispatchQueue queue;
+        std::weak_ptr<Realm> weak_realm;
+        std::shared_ptr<std::atomic<bool>> queue_signal_pending;
+        // Functions waiting to be run on the Realm's thread
+        std::vector<std::function<void ()>> pending_invocations;
+
+        // The Realm's minimum time between notifications of commits. Commits
+        // made sooner than that after a notification are delivered together
+        // at the end of the interval, by a timer on the Realm's runloop or
+        // by dispatching to its queue after a delay.
+        std::chrono::milliseconds notification_interval{0};
+        CFRunLoopTimerRef coalescing_timer = nullptr;
+        std::chrono::steady_clock::time_point last_commit_signal;
+        // Set to the end of the interval while a delayed signal is pending
+        std::chrono::steady_clock::time_point delayed_signal_time;
     };
 
+    // Wait for commit notifications on the listener thread until the helper
+    // is destroyed
     void listen();
+    void add_queue_realm(Realm* realm);
+    void add_coalescing_timer(PerRealmInfo& info);
+    static void signal(PerRealmInfo const& info);
+    // Signal the Realm about a commit, subject to its notification interval
+    static void signal_commit(PerRealmInfo& info);
+    // Signal every Realm about a commit, or have the change calculator do so
+    // once it has parsed the new transaction logs
+    void commit_available();
+    void signal_commits();
 
     // Currently registered realms and the signal for delivering notifications
     // to them
@@ -53,8 +126,24 @@ private:
     // Mutex which guards m_realms
     std::mutex m_realms_mutex;
 
+    // The name of the Darwin notification posted after each commit to the
+    // file by any process, and the registration and file descriptor through
+    // which the listener thread receives it
+    std::string m_notification_name;
+    int m_notify_token = 0;
+    int m_notify_fd = -1;
+
+    // The kqueue the listener thread waits on for the notification's file
+    // descriptor and for the user event telling it to exit
+    int m_kq = -1;
+    static const uintptr_t c_shutdown_event = 0;
+
     // The listener thread
     pthread_t m_thread;
+
+    // Declared last so that the worker is stopped before anything it uses
+    // when signalling Realms is destroyed
+    std::unique_ptr<ChangeCalculator> m_change_calculator;
 };
 #else
 class ExternalCommitHelper {
@@ -66,7 +155,38 @@ public:
     void add_realm(Realm* realm);
     void remove_realm(Realm* realm);
 
+    // Run the function on the given Realm's thread the next time it processes
+    // notifications. Does nothing if the Realm has been removed. Can be
+    // called from any thread.
+    void invoke_on_realm_thread(Realm* realm, std::function<void ()> fn);
+    // Run all functions queued for the Realm. Must be called on its thread.
+    void run_pending_invocations(Realm* realm);
+    // Make the Realm process notifications again on its thread even though
+    // nothing new has been committed. Can be called from any thread.
+    void signal_realm(Realm* realm);
+
+    // Get the changes from the given version which were computed in the
+    // background, if the file's first Realm asked for that, along with a
+    // snapshot pinning the version they end at. Returns false if they
+    // aren't available. Can be called from any thread.
+    bool get_precomputed_changes(uint_fast64_t version, TransactionChangeInfo& changes,
+                                 std::shared_ptr<RealmSnapshot>& target);
+
+    // The time of the most recent commit announced with notify_others() by a
+    // Realm in this process, for measuring how long it takes the other Realms
+    // to be notified of it. Can be called from any thread.
+    void set_last_commit_time(std::chrono::steady_clock::time_point time)
+    {
+        m_last_commit_time = time.time_since_epoch().count();
+    }
+    std::chrono::steady_clock::time_point last_commit_time() const
+    {
+        return std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(m_last_commit_time.load()));
+    }
+
 private:
+    std::atomic<std::chrono::steady_clock::rep> m_last_commit_time{0};
+
     // A RAII holder for a file descriptor which automatically closes the wrapped
     // fd when it's deallocated
     class FdHolder {
@@ -93,9 +213,37 @@ private:
         Realm* realm;
         CFRunLoopRef runloop;
         CFRunLoopSourceRef signal;
+        // Realms confined to a dispatch queue are notified by dispatching to
+        // the queue rather than with a runloop source. The flag is set while
+        // a notification is queued so that they are coalesced like a source's.
+        DispatchQueue queue;
+        std::weak_ptr<Realm> weak_realm;
+        std::shared_ptr<std::atomic<bool>> queue_signal_pending;
+        // Functions waiting to be run on the Realm's thread
+        std::vector<std::function<void ()>> pending_invocations;
+
+        // The Realm's minimum time between notifications of commits. Commits
+        // made sooner than that after a notification are delivered together
+        // at the end of the interval, by a timer on the Realm's runloop or
+        // by dispatching to its queue after a delay.
+        std::chrono::milliseconds notification_interval{0};
+        CFRunLoopTimerRef coalescing_timer = nullptr;
+        std::chrono::steady_clock::time_point last_commit_signal;
+        // Set to the end of the interval while a delayed signal is pending
+        std::chrono::steady_clock::time_point delayed_signal_time;
     };
 
-    void listen();
+    void add_queue_realm(Realm* realm);
+    void add_coalescing_timer(PerRealmInfo& info);
+    static void signal(PerRealmInfo const& info);
+    // Signal the Realm about a commit, subject to its notification interval
+    static void signal_commit(PerRealmInfo& info);
+    // Signal every Realm about a commit, or have the change calculator do so
+    // once it has parsed the new transaction logs
+    void commit_available();
+    void signal_commits();
+
+    friend class NotificationListener;
 
     // Currently registered realms and the signal for delivering notifications
     // to them
@@ -104,18 +252,14 @@ private:
     // Mutex which guards m_realms
     std::mutex m_realms_mutex;
 
-    // The listener thread
-    pthread_t m_thread;
-
     // Read-write file descriptor for the named pipe which is waited on for
-    // changes and written to when a commit is made
+    // changes by the process's NotificationListener and written to when a
+    // commit is made
     FdHolder m_notify_fd;
-    // File descriptor for the kqueue
-    FdHolder m_kq;
-    // The two ends of an anonymous pipe used to notify the kqueue() thread that
-    // it should be shut down.
-    FdHolder m_shutdown_read_fd;
-    FdHolder m_shutdown_write_fd;
+
+    // Declared last so that the worker is stopped before anything it uses
+    // when signalling Realms is destroyed
+    std::unique_ptr<ChangeCalculator> m_change_calculator;
 };
 #endif
 } // namespace _impl
@@ -0,0 +1,252 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "async_query.hpp"
+
+#include "collation_keys.hpp"
+#include "external_commit_helper.hpp"
+#include "results.hpp"
+
+#include <realm/commit_log.hpp>
+#include <realm/group_shared.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+using namespace realm;
+using namespace realm::_impl;
+
+namespace {
+// The parts of an async query which are used on the worker thread. This holds
+// no accessors, so it's safe for it to be destroyed on either thread.
+struct WorkerState {
+    std::string path;
+    std::vector<char> encryption_key;
+    bool in_memory;
+
+    VersionID version;
+    std::unique_ptr<SharedGroup::Handover<Query>> query;
+    SortOrder sort;
+
+    std::unique_ptr<SharedGroup::Handover<TableView>> table_view;
+    std::exception_ptr error;
+
+    // The version is pinned by the owning thread's SharedGroup so that it's
+    // still available when the worker gets to the query. Whichever of the
+    // worker and the owning thread clears this is responsible for unpinning it.
+    std::atomic<bool> version_pinned{true};
+};
+
+// Unpins the version on the given SharedGroup when destroyed, if it hasn't
+// already been unpinned by the other side
+class VersionPin {
+public:
+    VersionPin(SharedGroup& sg, std::shared_ptr<WorkerState> state)
+    : m_sg(sg), m_state(std::move(state)) { }
+
+    ~VersionPin()
+    {
+        if (m_state->version_pinned.exchange(false)) {
+            m_sg.unpin_version(m_state->version);
+        }
+    }
+
+    VersionPin(VersionPin const&) = delete;
+    VersionPin& operator=(VersionPin const&) = delete;
+
+private:
+    SharedGroup& m_sg;
+    std::shared_ptr<WorkerState> m_state;
+};
+
+// A single thread shared by every async query, which runs them one at a time
+// in the order they were started. Created on first use and never destroyed,
+// as the thread waits for more queries for the life of the process.
+class QueryWorker {
+public:
+    static QueryWorker& shared()
+    {
+        static QueryWorker* worker = new QueryWorker;
+        return *worker;
+    }
+
+    void enqueue(std::function<void ()> job)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_jobs.push_back(std::move(job));
+        }
+        m_cv.notify_one();
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<std::function<void ()>> m_jobs;
+
+    QueryWorker()
+    {
+        std::thread([this] { run(); }).detach();
+    }
+
+    void run()
+    {
+        while (true) {
+            std::function<void ()> job;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_cv.wait(lock, [&] { return !m_jobs.empty(); });
+                job = std::move(m_jobs.front());
+                m_jobs.pop_front();
+            }
+            job();
+        }
+    }
+};
+
+void evaluate(std::shared_ptr<WorkerState> const& state_ptr)
+{
+    auto& state = *state_ptr;
+    try {
+        auto history = realm::make_client_history(state.path, state.encryption_key.data());
+        SharedGroup sg(*history, state.in_memory ? SharedGroup::durability_MemOnly : SharedGroup::durability_Full,
+                       state.encryption_key.data());
+
+        // Once we have a read transaction on the version the pin is no longer
+        // needed, and if beginning it fails the pin is still released. If the
+        // owning thread already gave up on the query and unpinned the version
+        // there's nothing to do.
+        {
+            VersionPin pin(sg, state_ptr);
+            if (!state.version_pinned.load()) {
+                return;
+            }
+            sg.begin_read(state.version);
+        }
+
+        auto query = sg.import_from_handover(std::move(state.query));
+        TableView table_view = query->find_all();
+        if (state.sort) {
+            // Collation keys are cached by the owning thread's Realm, so they're
+            // computed just for this sort
+            sort_tableview(table_view, state.sort, nullptr);
+        }
+        state.table_view = sg.export_for_handover(table_view, MutableSourcePayload::Move);
+        sg.end_read();
+    }
+    catch (...) {
+        state.error = std::current_exception();
+    }
+}
+} // anonymous namespace
+
+void AsyncQuery::run(Results const& results, Callback callback)
+{
+    SharedRealm const& realm = results.m_realm;
+    realm->verify_thread();
+
+    // Read-only Realms can't be read from other threads via a SharedGroup,
+    // write transactions can't be handed over, and limited queries are run
+    // in multiple steps which aren't expressible as a single handover, as are
+    // queries with duplicates removed, so just run the query immediately in
+    // these cases
+    if (!realm->m_shared_group || !realm->m_notifier || realm->is_in_transaction() || results.is_limited()
+        || results.has_distinct()) {
+        Results copy(results);
+        try {
+            copy.update_tableview();
+        }
+        catch (...) {
+            callback({}, std::current_exception());
+            return;
+        }
+        callback(std::move(copy), nullptr);
+        return;
+    }
+
+    realm->read_group();
+    SharedGroup& sg = *realm->m_shared_group;
+
+    auto state = std::make_shared<WorkerState>();
+    state->path = realm->config().path;
+    state->encryption_key = realm->config().encryption_key;
+    state->in_memory = realm->config().in_memory;
+    state->query = sg.export_for_handover(results.m_query, ConstSourcePayload::Copy);
+    state->sort = results.m_sort;
+    state->version = sg.pin_version();
+
+    // If the worker fails before it can take over the pin, or the completion
+    // is discarded because the Realm is closed first, the pin is released
+    // along with the completion. Completions are always destroyed before the
+    // Realm's SharedGroup.
+    auto pin = std::make_shared<VersionPin>(sg, state);
+
+    // The Results and callback are only ever used on the Realm's thread, so
+    // they're stored on the Realm rather than being touched by the worker
+    size_t token = realm->m_next_async_token++;
+    realm->m_async_completions[token] = [=, results = results, pin = std::move(pin)]() mutable {
+        auto& realm = results.m_realm;
+        if (state->error) {
+            callback({}, state->error);
+            return;
+        }
+
+        // The TableView can only be imported at the version it was created
+        // at, so if we've advanced since then it needs to be recomputed
+        if (!realm->m_group || realm->is_in_transaction() ||
+            realm->m_shared_group->get_version_of_current_transaction() != state->version) {
+            run(results, std::move(callback));
+            return;
+        }
+
+        auto table_view = realm->m_shared_group->import_from_handover(std::move(state->table_view));
+        results.m_table_view = std::move(*table_view);
+        results.m_sorted_view.reset();
+        results.m_mode = Results::Mode::TableView;
+        results.m_synced_version = realm->current_transaction_version();
+        results.m_synced_write_count = realm->write_transaction_count();
+        callback(std::move(results), nullptr);
+    };
+
+    std::weak_ptr<Realm> weak_realm = realm;
+    Realm* realm_ptr = realm.get();
+    auto notifier = realm->m_notifier;
+    QueryWorker::shared().enqueue([=] {
+        evaluate(state);
+        notifier->invoke_on_realm_thread(realm_ptr, [=] {
+            if (auto realm = weak_realm.lock()) {
+                complete(*realm, token);
+            }
+        });
+    });
+}
+
+void AsyncQuery::complete(Realm& realm, size_t token)
+{
+    auto it = realm.m_async_completions.find(token);
+    if (it == realm.m_async_completions.end()) {
+        return;
+    }
+
+    auto completion = std::move(it->second);
+    realm.m_async_completions.erase(it);
+    completion();
+}
@@ -0,0 +1,55 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef REALM_ASYNC_QUERY_HPP
+#define REALM_ASYNC_QUERY_HPP
+
+#include <exception>
+#include <functional>
+
+namespace realm {
+class Realm;
+class Results;
+
+namespace _impl {
+// Runs the query for a Results on a background thread, against the same
+// version of the Realm as the Results is on, and then hands the resulting
+// TableView back to the thread which owns the Realm. The results are delivered
+// via the Realm's run loop source, so they are only delivered if that thread
+// runs its run loop. Queries are run one at a time, in the order they were
+// started, by a single worker thread shared by every Realm.
+class AsyncQuery {
+public:
+    using Callback = std::function<void (Results, std::exception_ptr)>;
+
+    // Start running the query for the given Results. The callback is called on
+    // the Results' thread with a copy of it which has the query results
+    // available, or with the exception which prevented them from being
+    // computed. If the Realm has advanced to a different version in the
+    // meantime, the query is rerun for the new version before the callback is
+    // called.
+    static void run(Results const& results, Callback callback);
+
+private:
+    // Run the completion function registered with the given token
+    static void complete(Realm& realm, size_t token);
+};
+} // namespace _impl
+} // namespace realm
+
+#endif // REALM_ASYNC_QUERY_HPP
@@ -0,0 +1,296 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "async_writer.hpp"
+
+#include "dispatch_queue.hpp"
+
+#include <algorithm>
+
+using namespace realm;
+using namespace realm::_impl;
+
+AsyncWriter::~AsyncWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        m_state->shutdown = true;
+    }
+    m_state->cv.notify_one();
+    if (!m_thread.joinable()) {
+        return;
+    }
+    // A thread can't join itself, but the writer thread only uses the shared
+    // state and so can finish the queued writes without the writer
+    if (m_thread.get_id() == std::this_thread::get_id()) {
+        m_thread.detach();
+        return;
+    }
+    m_thread.join();
+}
+
+void AsyncWriter::enqueue(Realm::Config const& config, WriteFunction write, CompletionFunction completion)
+{
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    auto& queue = m_state->queue;
+    queue.push_back({config, std::move(write), std::move(completion)});
+    // The writer's Realm belongs to the writer thread even if the Realm
+    // which enqueued the job is confined to a queue
+    queue.back().config.dispatch_queue = {};
+    // Nothing observes the writer's Realm, so it doesn't need to parse the
+    // transaction logs of the commits it advances over
+    queue.back().config.track_changes = false;
+    start_if_needed();
+    m_state->cv.notify_one();
+}
+
+void AsyncWriter::enqueue_write_behind(Realm::Config const& config, WriteFunction write)
+{
+    init_write_behind(config);
+    auto node = new WriteBehindNode;
+    node->write = std::move(write);
+    push_write_behind(node);
+}
+
+std::exception_ptr AsyncWriter::flush_write_behind(Realm::Config const& config)
+{
+    init_write_behind(config);
+    std::promise<std::exception_ptr> flushed;
+    auto future = flushed.get_future();
+
+    auto node = new WriteBehindNode;
+    node->flushed = &flushed;
+    m_state->flush_requested = true;
+    push_write_behind(node);
+    return future.get();
+}
+
+void AsyncWriter::init_write_behind(Realm::Config const& config)
+{
+    auto& state = *m_state;
+    std::call_once(state.write_behind_config_once, [&] {
+        state.write_behind_config = std::make_unique<Realm::Config>(config);
+        state.write_behind_config->dispatch_queue = {};
+        state.write_behind_config->track_changes = false;
+    });
+}
+
+void AsyncWriter::start_if_needed()
+{
+    if (!m_thread.joinable()) {
+        auto state = m_state;
+        m_thread = std::thread([state] { run(state); });
+    }
+}
+
+void AsyncWriter::push_write_behind(WriteBehindNode* node)
+{
+    auto& state = *m_state;
+    node->next = state.write_behind_head.load(std::memory_order_relaxed);
+    while (!state.write_behind_head.compare_exchange_weak(node->next, node, std::memory_order_release,
+                                                          std::memory_order_relaxed)) {
+    }
+    size_t count = ++state.write_behind_count;
+
+    // The writer only needs waking if the stack was empty, or if it's waiting
+    // for a full batch or a flush
+    if (!node->next || node->flushed || count == state.write_behind_config->write_behind_batch_size) {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        start_if_needed();
+        state.cv.notify_one();
+    }
+}
+
+void AsyncWriter::run(std::shared_ptr<State> state_ptr)
+{
+    set_current_thread_name("RLMRealm async writer");
+
+    auto& state = *state_ptr;
+    SharedRealm realm;
+    while (true) {
+        std::unique_lock<std::mutex> lock(state.mutex);
+        state.cv.wait(lock, [&] { return state.shutdown || !state.queue.empty() || state.write_behind_head.load(); });
+        if (!state.queue.empty()) {
+            Job job = std::move(state.queue.front());
+            state.queue.pop_front();
+            lock.unlock();
+
+            perform(realm, job);
+            continue;
+        }
+        if (!state.write_behind_head.load()) {
+            break;
+        }
+
+        // Give more write-behind writes a chance to join the batch
+        auto delay = state.write_behind_config->write_behind_delay;
+        if (delay.count()) {
+            state.cv.wait_for(lock, delay, [&] {
+                return state.shutdown || state.flush_requested
+                    || state.write_behind_count >= state.write_behind_config->write_behind_batch_size;
+            });
+        }
+        lock.unlock();
+
+        state.flush_requested = false;
+        state.write_behind_count = 0;
+        perform_write_behind(state, realm, state.write_behind_head.exchange(nullptr, std::memory_order_acquire));
+    }
+}
+
+void AsyncWriter::open(SharedRealm& realm, Realm::Config const& config)
+{
+    // The cached Realm is closed if the Realm cache is cleared
+    if (!realm || realm->is_closed()) {
+        realm = Realm::get_shared_realm(config);
+        // The writer's own Realm must not keep the writer or the
+        // expiry sweeper which queues writes on it alive
+        realm->m_async_writer.reset();
+        realm->m_expiry_sweeper.reset();
+    }
+}
+
+void AsyncWriter::perform(SharedRealm& realm, Job& job)
+{
+    std::exception_ptr error;
+    try {
+        open(realm, job.config);
+
+        realm->begin_transaction();
+        try {
+            job.write(*realm);
+            if (realm->is_in_transaction()) {
+                realm->commit_transaction();
+            }
+        }
+        catch (...) {
+            if (realm->is_in_transaction()) {
+                realm->cancel_transaction();
+            }
+            throw;
+        }
+    }
+    catch (...) {
+        error = std::current_exception();
+    }
+
+    // Release anything captured by the write function before reporting
+    // completion, as the completion may expect them to be gone
+    job.write = nullptr;
+    job.completion(error);
+}
+
+void AsyncWriter::perform_write_behind(State& state, SharedRealm& realm, WriteBehindNode* head)
+{
+    std::vector<std::unique_ptr<WriteBehindNode>> nodes;
+    for (auto node = head; node; node = node->next) {
+        nodes.emplace_back(node);
+    }
+    std::reverse(nodes.begin(), nodes.end());
+
+    size_t batch_size = std::max<size_t>(state.write_behind_config->write_behind_batch_size, 1);
+    std::vector<WriteFunction*> batch;
+    for (auto& node : nodes) {
+        if (node->write) {
+            batch.push_back(&node->write);
+            if (batch.size() < batch_size) {
+                continue;
+            }
+        }
+        commit_write_behind(state, realm, std::move(batch));
+        batch.clear();
+        if (node->flushed) {
+            node->flushed->set_value(state.write_behind_error);
+            state.write_behind_error = nullptr;
+        }
+    }
+    commit_write_behind(state, realm, std::move(batch));
+
+    // The write functions are destroyed outside of any write transaction, as
+    // releasing what they captured may not be allowed within one
+    nodes.clear();
+}
+
+void AsyncWriter::commit_write_behind(State& state, SharedRealm& realm, std::vector<WriteFunction*> writes)
+{
+    auto record_error = [&] {
+        if (!state.write_behind_error) {
+            state.write_behind_error = std::current_exception();
+        }
+    };
+    auto changes_size = [&] {
+        return realm->is_in_transaction() ? realm->m_history->get_uncommitted_changes().size() : 0;
+    };
+
+    // A write which throws before changing anything is just left out of the
+    // transaction. If one throws after making changes, the transaction has to
+    // be rolled back, and the writes before it which were rolled back with it
+    // are run again and committed on their own, rather than being run again
+    // each time a later write in the batch fails.
+    size_t rerun_count = 0;
+    while (!writes.empty()) {
+        try {
+            open(realm, *state.write_behind_config);
+            realm->begin_transaction();
+
+            size_t end = rerun_count ? rerun_count : writes.size();
+            bool rolled_back = false;
+            for (size_t i = 0; i < end; ) {
+                size_t changes_before = changes_size();
+                try {
+                    (*writes[i])(*realm);
+                    ++i;
+                    continue;
+                }
+                catch (...) {
+                    record_error();
+                }
+                writes.erase(writes.begin() + i);
+                --end;
+                if (realm->is_in_transaction() && changes_size() == changes_before) {
+                    continue;
+                }
+
+                if (realm->is_in_transaction()) {
+                    realm->cancel_transaction();
+                }
+                rerun_count = i;
+                rolled_back = true;
+                break;
+            }
+            if (rolled_back) {
+                continue;
+            }
+
+            if (realm->is_in_transaction()) {
+                realm->commit_transaction();
+            }
+            writes.erase(writes.begin(), writes.begin() + end);
+            rerun_count = 0;
+        }
+        catch (...) {
+            if (realm && realm->is_in_transaction()) {
+                realm->cancel_transaction();
+            }
+            record_error();
+            // Beginning or committing the transaction failed, so the rest of
+            // the batch is lost
+            return;
+        }
+    }
+}
@@ -0,0 +1,131 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef REALM_ASYNC_WRITER_HPP
+#define REALM_ASYNC_WRITER_HPP
+
+#include "shared_realm.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace realm {
+namespace _impl {
+// A serial background thread which performs write transactions for a single
+// Realm file on behalf of other threads, so that they never have to block
+// waiting for the write lock. The thread is started when the first write is
+// queued, and is stopped once all of the queued writes have been performed
+// when the writer is destroyed. Realms hold the only strong references to the
+// writer, so it's normally destroyed, and its thread joined, on the thread of
+// the last Realm for the file to be closed.
+class AsyncWriter {
+public:
+    using WriteFunction = std::function<void (Realm&)>;
+    using CompletionFunction = std::function<void (std::exception_ptr)>;
+
+    ~AsyncWriter();
+
+    // Run the write function in a write transaction on the writer thread's
+    // Realm, which is opened with the given config if needed, and then call
+    // the completion function on the writer thread with the exception which
+    // occurred, if any.
+    void enqueue(Realm::Config const& config, WriteFunction write, CompletionFunction completion);
+
+    // Queue the write function to be run on the writer thread in a write
+    // transaction shared with the other write-behind writes queued by the
+    // time the writer gets to it, up to the config's
+    // write_behind_batch_size writes per transaction. Queueing doesn't take
+    // a lock unless the writer thread has to be woken up. A write is run a
+    // second time if a later write in its transaction throws after making
+    // changes. The config passed by the first call to either write-behind
+    // function is used for all of the write-behind writes.
+    void enqueue_write_behind(Realm::Config const& config, WriteFunction write);
+
+    // Block until every write-behind write queued before the call has been
+    // committed, and return the first exception thrown by a write-behind
+    // write since the previous flush, if any.
+    std::exception_ptr flush_write_behind(Realm::Config const& config);
+
+private:
+    struct Job {
+        Realm::Config config;
+        WriteFunction write;
+        CompletionFunction completion;
+    };
+
+    // A node of the lock-free stack write-behind writes are pushed onto. The
+    // writer thread takes the whole stack at once and reverses it to get the
+    // writes in the order they were queued.
+    struct WriteBehindNode {
+        WriteFunction write;
+        // Set instead of write for the markers queued by flush_write_behind()
+        std::promise<std::exception_ptr>* flushed = nullptr;
+        WriteBehindNode* next = nullptr;
+    };
+
+    // Everything used by the writer thread, which keeps it alive, so that
+    // releasing whatever a write captured can destroy the writer on the
+    // writer thread without the thread being left with dangling members
+    struct State {
+        std::deque<Job> queue;
+        bool shutdown = false;
+
+        std::atomic<WriteBehindNode*> write_behind_head{nullptr};
+        std::atomic<size_t> write_behind_count{0};
+        std::atomic<bool> flush_requested{false};
+        // Set by the first call to enqueue or flush write-behind writes
+        std::once_flag write_behind_config_once;
+        std::unique_ptr<Realm::Config> write_behind_config;
+        // The first exception thrown by a write-behind write since the last
+        // flush. Only used by the writer thread.
+        std::exception_ptr write_behind_error;
+
+        // Guards queue, shutdown and starting the thread, and is held when
+        // notifying cv of write-behind writes
+        std::mutex mutex;
+        std::condition_variable cv;
+    };
+
+    std::shared_ptr<State> m_state = std::make_shared<State>();
+    // Started by the first write. Joined by the destructor unless that runs
+    // on the writer thread itself, in which case it's detached and exits once
+    // the queued writes are done.
+    std::thread m_thread;
+
+    void init_write_behind(Realm::Config const& config);
+    void start_if_needed();
+    void push_write_behind(WriteBehindNode* node);
+    static void run(std::shared_ptr<State> state);
+    static void open(SharedRealm& realm, Realm::Config const& config);
+    static void perform(SharedRealm& realm, Job& job);
+    static void perform_write_behind(State& state, SharedRealm& realm, WriteBehindNode* head);
+    static void commit_write_behind(State& state, SharedRealm& realm, std::vector<WriteFunction*> writes);
+};
+
+} // namespace _impl
+} // namespace realm
+
+#endif /* REALM_ASYNC_WRITER_HPP */
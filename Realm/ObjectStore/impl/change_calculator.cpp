@@ -0,0 +1,149 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "change_calculator.hpp"
+
+#include "dispatch_queue.hpp"
+#include "realm_snapshot.hpp"
+
+#include <realm/group_shared.hpp>
+
+#include <algorithm>
+
+using namespace realm;
+using namespace realm::_impl;
+
+// Realms lagging further behind than this many batches fall back to parsing
+// the logs themselves
+static const size_t s_max_batches = 16;
+
+ChangeCalculator::ChangeCalculator(Realm::Config config, std::function<void ()> did_update)
+: m_did_update(std::move(did_update))
+{
+    config.cache = false;
+    config.dispatch_queue = {};
+    config.schema = nullptr;
+
+    m_thread = std::thread([this, config = std::move(config)]() mutable {
+        set_current_thread_name("RLMRealm change calculator");
+        run(std::move(config));
+    });
+}
+
+ChangeCalculator::~ChangeCalculator()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopped = true;
+    }
+    m_cv.notify_one();
+    m_thread.join();
+}
+
+void ChangeCalculator::request_update()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_update_requested = true;
+    }
+    m_cv.notify_one();
+}
+
+void ChangeCalculator::run(Realm::Config config)
+{
+    try {
+        m_realm.reset(new Realm(std::move(config)));
+        m_realm->read_group();
+    }
+    catch (...) {
+        // Realms just parse the logs themselves if this can't run, but they
+        // still need to hear about commits
+        m_realm.reset();
+    }
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [&] { return m_update_requested || m_stopped; });
+            if (m_stopped) {
+                break;
+            }
+            m_update_requested = false;
+        }
+        if (m_realm) {
+            compute();
+        }
+        m_did_update();
+    }
+
+    // The worker's Realm was opened on this thread, so it's closed here too
+    m_realm.reset();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_newest.reset();
+}
+
+void ChangeCalculator::compute()
+{
+    TransactionChangeInfo changes;
+    std::shared_ptr<RealmSnapshot> newest;
+    try {
+        transaction::advance(*m_realm->m_shared_group, *m_realm->m_history, nullptr, &changes);
+        if (changes.initial_version == changes.final_version) {
+            return;
+        }
+        newest = RealmSnapshot::create(*m_realm);
+    }
+    catch (...) {
+        // Most likely a schema change which the Realms will report
+        // themselves when they parse the log, so stop providing changes
+        // from before it and start again from the newest version
+        m_realm->invalidate();
+        m_realm->read_group();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_changes.clear();
+        m_newest.reset();
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_changes.push_back(std::move(changes));
+    if (m_changes.size() > s_max_batches) {
+        m_changes.erase(m_changes.begin());
+    }
+    // Replacing the snapshot releases the previous batch's version, unless
+    // a Realm is still advancing to it
+    m_newest = std::move(newest);
+}
+
+bool ChangeCalculator::get_changes(uint_fast64_t version, TransactionChangeInfo& changes,
+                                   std::shared_ptr<RealmSnapshot>& target)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = std::find_if(m_changes.begin(), m_changes.end(),
+                           [=](auto const& batch) { return batch.initial_version == version; });
+    if (it == m_changes.end() || !m_newest) {
+        return false;
+    }
+
+    changes = *it;
+    for (++it; it != m_changes.end(); ++it) {
+        changes.merge(*it);
+    }
+    target = m_newest;
+    return true;
+}
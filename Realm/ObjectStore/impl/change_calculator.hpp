@@ -0,0 +1,82 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef REALM_CHANGE_CALCULATOR_HPP
+#define REALM_CHANGE_CALCULATOR_HPP
+
+#include "shared_realm.hpp"
+#include "transact_log_handler.hpp"
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace realm {
+class RealmSnapshot;
+
+namespace _impl {
+// Parses the transaction logs of new commits on a background thread, ahead
+// of the Realms which will advance over them, so that a Realm which isn't
+// observing any rows can advance without parsing the logs itself and reuse
+// the change summary computed here. Each batch of changes ends at a version
+// pinned by a RealmSnapshot, as that's the version the Realm must advance to
+// for the summary to be accurate.
+class ChangeCalculator {
+public:
+    // did_update is called on the worker thread after the changes up to the
+    // newest version have been computed
+    ChangeCalculator(Realm::Config config, std::function<void ()> did_update);
+    // Waits for the batch currently being computed, if any
+    ~ChangeCalculator();
+
+    // Wake the worker to compute changes up to the newest version. Returns
+    // immediately. Can be called from any thread.
+    void request_update();
+
+    // Get the changes from the given version to the newest one computed so
+    // far, along with a snapshot pinning that version. Returns false if the
+    // changes from that version aren't available. Can be called from any thread.
+    bool get_changes(uint_fast64_t version, TransactionChangeInfo& changes,
+                     std::shared_ptr<RealmSnapshot>& target);
+
+private:
+    void run(Realm::Config config);
+    void compute();
+
+    std::function<void ()> m_did_update;
+
+    // Only used on the worker thread
+    std::unique_ptr<Realm> m_realm;
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_update_requested = false;
+    bool m_stopped = false;
+    // Consecutive batches of changes, oldest first, ending at m_newest
+    std::vector<TransactionChangeInfo> m_changes;
+    std::shared_ptr<RealmSnapshot> m_newest;
+
+    std::thread m_thread;
+};
+} // namespace _impl
+} // namespace realm
+
+#endif /* REALM_CHANGE_CALCULATOR_HPP */
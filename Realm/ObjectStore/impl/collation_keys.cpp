@@ -0,0 +1,353 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+
+#include "collation_keys.hpp"
+
+#include "results.hpp"
+#include "shared_realm.hpp"
+#include "transact_log_handler.hpp"
+
+#include <realm/table.hpp>
+#include <realm/table_view.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+using namespace realm;
+using namespace realm::_impl;
+
+namespace {
+template<typename T>
+int compare(T a, T b)
+{
+    return a < b ? -1 : b < a;
+}
+
+// Null sorts before every other value
+int compare_strings(StringData a, StringData b)
+{
+    if (a.is_null() || b.is_null()) {
+        return int(!a.is_null()) - int(!b.is_null());
+    }
+    if (int c = memcmp(a.data(), b.data(), std::min(a.size(), b.size()))) {
+        return c;
+    }
+    return compare(a.size(), b.size());
+}
+
+int compare_values(Table const& table, size_t col, size_t a, size_t b)
+{
+    if (table.is_nullable(col)) {
+        bool a_is_null = table.is_null(col, a), b_is_null = table.is_null(col, b);
+        if (a_is_null || b_is_null) {
+            return int(!a_is_null) - int(!b_is_null);
+        }
+    }
+    switch (table.get_column_type(col)) {
+        case type_Int:      return compare(table.get_int(col, a), table.get_int(col, b));
+        case type_Bool:     return compare(table.get_bool(col, a), table.get_bool(col, b));
+        case type_Float:    return compare(table.get_float(col, a), table.get_float(col, b));
+        case type_Double:   return compare(table.get_double(col, a), table.get_double(col, b));
+        case type_DateTime: return compare(table.get_datetime(col, a).get_datetime(),
+                                           table.get_datetime(col, b).get_datetime());
+        case type_String:   return compare_strings(table.get_string(col, a), table.get_string(col, b));
+        default: REALM_UNREACHABLE();
+    }
+}
+} // anonymous namespace
+
+CollationKeyCache::CollationKeyCache(Table& table, size_t column, std::shared_ptr<const Collation> collation)
+: m_table(table.get_table_ref())
+, m_column(column)
+, m_collation(std::move(collation))
+{
+}
+
+bool CollationKeyCache::is_for(Table const& table, size_t column) const noexcept
+{
+    return m_table.get() == &table && m_column == column && m_table->is_attached();
+}
+
+bool CollationKeyCache::update(Realm& realm)
+{
+    if (realm.is_in_transaction() || !m_table->is_attached()) {
+        return false;
+    }
+
+    auto version = realm.current_transaction_version();
+    bool same_writes = realm.write_transaction_count() == m_write_count;
+    if (m_tracking && same_writes && version == m_version) {
+        return true;
+    }
+
+    TransactionChangeInfo info;
+    if (!m_tracking || !same_writes || !realm.get_changes_since(m_version, info) || !apply(info)) {
+        m_states.clear();
+        m_keys.clear();
+    }
+    m_tracking = true;
+    m_version = version;
+    m_write_count = realm.write_transaction_count();
+    return true;
+}
+
+bool CollationKeyCache::apply(TransactionChangeInfo const& info)
+{
+    if (info.schema_changed) {
+        return false;
+    }
+    size_t table_ndx = m_table->get_index_in_group();
+    if (table_ndx >= info.tables.size()) {
+        return true;
+    }
+
+    auto& changes = info.tables[table_ndx];
+    if (changes.row_indexes_lost) {
+        return false;
+    }
+    for (auto const& change : changes.row_index_changes) {
+        using Kind = TransactionChangeInfo::TableChanges::RowIndexChange::Kind;
+        size_t size = m_states.size();
+        switch (change.kind) {
+            case Kind::Insert:
+                if (change.row < size) {
+                    m_states.insert(m_states.begin() + change.row, change.other_or_count, Unknown);
+                    m_keys.insert(m_keys.begin() + change.row, change.other_or_count, std::string());
+                }
+                break;
+            case Kind::Erase:
+                if (change.row < size) {
+                    size_t end = std::min(change.row + change.other_or_count, size);
+                    m_states.erase(m_states.begin() + change.row, m_states.begin() + end);
+                    m_keys.erase(m_keys.begin() + change.row, m_keys.begin() + end);
+                }
+                break;
+            case Kind::MoveLastOver:
+                // `other` is the last row, which is then removed
+                if (change.other_or_count < size) {
+                    move_row(change.other_or_count, change.row);
+                    m_states.resize(change.other_or_count);
+                    m_keys.resize(change.other_or_count);
+                }
+                else if (change.row < size) {
+                    forget(change.row);
+                }
+                break;
+            case Kind::Swap: {
+                size_t last = std::max(change.row, change.other_or_count);
+                if (last >= size) {
+                    m_states.resize(last + 1, Unknown);
+                    m_keys.resize(last + 1);
+                }
+                std::swap(m_states[change.row], m_states[change.other_or_count]);
+                std::swap(m_keys[change.row], m_keys[change.other_or_count]);
+                break;
+            }
+            case Kind::Clear:
+                m_states.clear();
+                m_keys.clear();
+                break;
+        }
+    }
+
+    if (changes.column_modified(m_column)) {
+        for (auto const& range : changes.modifications) {
+            for (size_t row = range.first; row < std::min(range.second, m_states.size()); ++row) {
+                forget(row);
+            }
+        }
+    }
+    if (m_states.size() > m_table->size()) {
+        m_states.resize(m_table->size());
+        m_keys.resize(m_table->size());
+    }
+    return true;
+}
+
+void CollationKeyCache::forget(size_t row)
+{
+    m_states[row] = Unknown;
+    std::string().swap(m_keys[row]);
+}
+
+void CollationKeyCache::move_row(size_t from, size_t to)
+{
+    m_states[to] = m_states[from];
+    m_keys[to] = std::move(m_keys[from]);
+}
+
+void CollationKeyCache::compute(std::vector<size_t> const& rows)
+{
+    for (size_t row : rows) {
+        if (row >= m_states.size()) {
+            m_states.resize(m_table->size(), Unknown);
+            m_keys.resize(m_table->size());
+        }
+        if (m_states[row] != Unknown) {
+            continue;
+        }
+        StringData value = m_table->get_string(m_column, row);
+        if (value.is_null()) {
+            m_states[row] = Null;
+            continue;
+        }
+        m_keys[row] = m_collation->make_key(value);
+        m_states[row] = Known;
+    }
+}
+
+StringData CollationKeyCache::key(size_t row) const noexcept
+{
+    REALM_ASSERT_DEBUG(row < m_states.size() && m_states[row] != Unknown);
+    if (m_states[row] == Null) {
+        return StringData();
+    }
+    return m_keys[row];
+}
+
+SortComparator::SortComparator(Table& table, SortOrder const& sort, Realm* realm)
+: m_table(table)
+, m_sort(sort)
+, m_caches(sort.columnIndices.size())
+{
+    if (sort.has_link_paths()) {
+        m_linked.resize(m_caches.size());
+        for (size_t i = 0; i < sort.link_paths.size(); ++i) {
+            TableRef current = table.get_table_ref();
+            for (size_t col : sort.link_paths[i]) {
+                m_linked[i].link_tables.push_back(current);
+                current = current->get_link_target(col);
+            }
+            if (!sort.link_paths[i].empty()) {
+                m_linked[i].table = std::move(current);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < m_caches.size(); ++i) {
+        Table& values = !m_linked.empty() && m_linked[i].table ? *m_linked[i].table : table;
+        size_t col = sort.columnIndices[i];
+        if (i >= sort.collations.size() || !sort.collations[i] || values.get_column_type(col) != type_String) {
+            continue;
+        }
+        if (realm) {
+            auto cache = realm->get_collation_keys(values, col, sort.collations[i]);
+            if (cache->update(*realm)) {
+                m_caches[i] = std::move(cache);
+            }
+        }
+        if (!m_caches[i]) {
+            m_caches[i] = std::make_shared<CollationKeyCache>(values, col, sort.collations[i]);
+        }
+    }
+}
+
+void SortComparator::prepare(std::vector<size_t> const& rows)
+{
+    // The linked rows are gathered once up front so that comparisons don't
+    // have to follow links
+    std::vector<size_t> linked_rows;
+    for (size_t i = 0; i < m_caches.size(); ++i) {
+        if (m_linked.empty() || !m_linked[i].table) {
+            if (m_caches[i]) {
+                m_caches[i]->compute(rows);
+            }
+            continue;
+        }
+
+        auto& linked = m_linked[i];
+        auto const& path = m_sort.link_paths[i];
+        if (linked.rows.size() < m_table.size()) {
+            linked.rows.resize(m_table.size(), npos);
+        }
+        linked_rows.clear();
+        for (size_t row : rows) {
+            size_t target = row;
+            for (size_t j = 0; j < path.size() && target != npos; ++j) {
+                auto& link_table = *linked.link_tables[j];
+                target = link_table.is_null_link(path[j], target) ? npos : link_table.get_link(path[j], target);
+            }
+            linked.rows[row] = target;
+            if (target != npos) {
+                linked_rows.push_back(target);
+            }
+        }
+        if (m_caches[i]) {
+            m_caches[i]->compute(linked_rows);
+        }
+    }
+}
+
+int SortComparator::compare(size_t a, size_t b) const
+{
+    for (size_t i = 0; i < m_caches.size(); ++i) {
+        Table const* table = &m_table;
+        size_t row_a = a, row_b = b;
+        if (!m_linked.empty() && m_linked[i].table) {
+            table = m_linked[i].table.get();
+            row_a = m_linked[i].rows[a];
+            row_b = m_linked[i].rows[b];
+        }
+
+        int cmp;
+        if (row_a == npos || row_b == npos) {
+            // Rows with a null link sort as null values do
+            cmp = int(row_a != npos) - int(row_b != npos);
+        }
+        else {
+            cmp = m_caches[i] ? compare_strings(m_caches[i]->key(row_a), m_caches[i]->key(row_b))
+                              : compare_values(*table, m_sort.columnIndices[i], row_a, row_b);
+        }
+        if (cmp != 0) {
+            return m_sort.ascending[i] ? cmp : -cmp;
+        }
+    }
+    return 0;
+}
+
+void realm::_impl::sort_tableview(TableView& tv, SortOrder const& sort, Realm* realm)
+{
+    if (!sort.has_collation() && !sort.has_link_paths()) {
+        tv.sort(sort.columnIndices, sort.ascending);
+        return;
+    }
+
+    std::vector<size_t> rows(tv.size());
+    for (size_t i = 0; i < rows.size(); ++i) {
+        rows[i] = tv.get_source_ndx(i);
+    }
+
+    SortComparator comparator(tv.get_parent(), sort, realm);
+    comparator.prepare(rows);
+    std::stable_sort(rows.begin(), rows.end(), [&](size_t a, size_t b) {
+        return comparator.compare(a, b) < 0;
+    });
+    set_tableview_order(tv, rows);
+}
+
+void realm::_impl::set_tableview_order(TableView& tv, std::vector<size_t> const& rows)
+{
+    REALM_ASSERT_DEBUG(rows.size() == tv.size());
+    // Sorting on columns is the only public way to order a tableview, so the
+    // new order is written to its row indexes directly. The view isn't marked
+    // as sorted, so sync_if_needed() will not reorder it.
+    for (size_t i = 0; i < rows.size(); ++i) {
+        tv.m_row_indexes.set(i, rows[i]);
+    }
+}
@@ -0,0 +1,139 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef REALM_COLLATION_KEYS_HPP
+#define REALM_COLLATION_KEYS_HPP
+
+#include <realm/string_data.hpp>
+#include <realm/table_ref.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace realm {
+class Realm;
+class TableView;
+struct Collation;
+struct SortOrder;
+
+namespace _impl {
+struct TransactionChangeInfo;
+
+// The collation keys of the values in a string column, which are computed
+// when first needed and then kept until the row's value changes, so that
+// sorting the same rows again only compares keys rather than converting every
+// value again.
+//
+// The keys are kept in memory by the Realm, and are brought up to date with
+// the read transaction by discarding the keys of the rows which were modified
+// and moving the others along with their rows. If the changes aren't
+// available every key is discarded.
+class CollationKeyCache {
+public:
+    CollationKeyCache(Table& table, size_t column, std::shared_ptr<const Collation> collation);
+
+    bool is_for(Table const& table, size_t column) const noexcept;
+
+    // Bring the cache up to date with the Realm's read transaction. Returns
+    // false if that isn't possible, which is the case within a write
+    // transaction as local changes are not tracked. A cache which is never
+    // updated is still correct for as long as the table doesn't change.
+    bool update(Realm& realm);
+
+    // Compute the keys of the given rows which aren't already known
+    void compute(std::vector<size_t> const& rows);
+
+    // Get the key for the row's value, or null if the value is null. The key
+    // must have been computed since the cache was last updated.
+    StringData key(size_t row) const noexcept;
+
+private:
+    TableRef m_table;
+    const size_t m_column;
+    const std::shared_ptr<const Collation> m_collation;
+
+    enum KeyState : uint8_t {
+        Unknown,
+        Null,
+        Known
+    };
+    // The state and key of each row. Rows past the end haven't been read yet.
+    std::vector<KeyState> m_states;
+    std::vector<std::string> m_keys;
+
+    bool m_tracking = false;
+    uint_fast64_t m_version = 0;
+    size_t m_write_count = 0;
+
+    bool apply(TransactionChangeInfo const& info);
+    void forget(size_t row);
+    void move_row(size_t from, size_t to);
+};
+
+// Compares rows of a table by the columns of a sort order, with string
+// columns which have a collation compared by their collation keys. The keys
+// are read from the Realm's caches if `realm` is given and it's not in a
+// write transaction, and are otherwise computed just for this comparator.
+// For columns of linked objects, the linked row for each row is found once
+// when the row is prepared, and comparisons read the values from it directly.
+class SortComparator {
+public:
+    SortComparator(Table& table, SortOrder const& sort, Realm* realm);
+
+    // Follow the links to and compute the collation keys of the given rows.
+    // Must be called for each row before it's compared.
+    void prepare(std::vector<size_t> const& rows);
+
+    // Returns a negative value if row `a` sorts before row `b`, a positive
+    // value if it sorts after it, and zero if they're equal in every column
+    int compare(size_t a, size_t b) const;
+
+private:
+    Table& m_table;
+    SortOrder const& m_sort;
+    // The collation keys for each sort column, or null for columns without a
+    // collation
+    std::vector<std::shared_ptr<CollationKeyCache>> m_caches;
+
+    // A sort column on a linked object: the tables each link in the path is
+    // in, the table the value is read from, and the linked row for each
+    // prepared row of m_table (npos if a link was null)
+    struct LinkedColumn {
+        std::vector<TableRef> link_tables;
+        TableRef table;
+        std::vector<size_t> rows;
+    };
+    // Empty if no sort column is on a linked object, and otherwise with an
+    // entry for each sort column which is only used if it has a link path
+    std::vector<LinkedColumn> m_linked;
+};
+
+// Sort the tableview in the given order. Rows which are equal in every sort
+// column are left in their current relative order.
+void sort_tableview(TableView& tv, SortOrder const& sort, Realm* realm);
+
+// Reorder the tableview to have the given rows, which must be the rows it
+// already has
+void set_tableview_order(TableView& tv, std::vector<size_t> const& rows);
+} // namespace _impl
+} // namespace realm
+
+#endif /* REALM_COLLATION_KEYS_HPP */
@@ -0,0 +1,266 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+
+#include "compound_index.hpp"
+
+#include "shared_realm.hpp"
+#include "transact_log_handler.hpp"
+
+#include <realm/table.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+using namespace realm;
+using namespace realm::_impl;
+
+namespace {
+int compare_strings(StringData a, StringData b)
+{
+    if (a.is_null() || b.is_null()) {
+        return int(!a.is_null()) - int(!b.is_null());
+    }
+    if (int c = memcmp(a.data(), b.data(), std::min(a.size(), b.size()))) {
+        return c;
+    }
+    return a.size() < b.size() ? -1 : a.size() > b.size();
+}
+
+// The value of an int column, or of a date column as seconds since 1970
+int64_t get_int(Table const& table, DataType type, size_t column, size_t row)
+{
+    if (type == type_DateTime) {
+        return table.get_datetime(column, row).get_datetime();
+    }
+    return table.get_int(column, row);
+}
+
+int compare_ints(Table const& table, DataType type, size_t column, size_t row, bool is_null, int64_t value)
+{
+    bool row_is_null = table.is_null(column, row);
+    if (row_is_null || is_null) {
+        return int(!row_is_null) - int(!is_null);
+    }
+    int64_t row_value = get_int(table, type, column, row);
+    return row_value < value ? -1 : row_value > value;
+}
+} // anonymous namespace
+
+CompoundIndex::CompoundIndex(Realm& realm, Table& table, std::vector<size_t> columns)
+: m_realm(realm)
+, m_table(table.get_table_ref())
+, m_columns(std::move(columns))
+{
+    for (auto column : m_columns) {
+        m_types.push_back(table.get_column_type(column));
+    }
+}
+
+bool CompoundIndex::is_for(Table const& table, std::vector<size_t> const& columns) const noexcept
+{
+    return m_table.get() == &table && m_columns == columns && m_table->is_attached();
+}
+
+bool CompoundIndex::update()
+{
+    if (m_realm.is_in_transaction() || !m_table->is_attached()) {
+        return false;
+    }
+
+    auto version = m_realm.current_transaction_version();
+    bool same_writes = m_realm.write_transaction_count() == m_write_count;
+    if (m_built && same_writes && version == m_version) {
+        return true;
+    }
+
+    TransactionChangeInfo info;
+    if (!m_built || !same_writes || !m_realm.get_changes_since(m_version, info) || !apply(info)) {
+        rebuild();
+    }
+    m_version = version;
+    m_write_count = m_realm.write_transaction_count();
+    ++m_generation;
+    return true;
+}
+
+void CompoundIndex::rebuild()
+{
+    m_rows.resize(m_table->size());
+    for (size_t row = 0; row < m_rows.size(); ++row) {
+        m_rows[row] = row;
+    }
+    std::sort(m_rows.begin(), m_rows.end(), [&](size_t a, size_t b) { return compare(a, b) < 0; });
+    m_built = true;
+}
+
+bool CompoundIndex::apply(TransactionChangeInfo const& info)
+{
+    if (info.schema_changed) {
+        return false;
+    }
+    size_t table_ndx = m_table->get_index_in_group();
+    if (table_ndx >= info.tables.size()) {
+        return true;
+    }
+
+    auto& changes = info.tables[table_ndx];
+    if (changes.row_indexes_lost) {
+        return false;
+    }
+    bool keys_modified = std::any_of(m_columns.begin(), m_columns.end(),
+                                     [&](size_t col) { return changes.column_modified(col); });
+    bool rows_moved = !changes.row_index_changes.empty();
+
+    // Map the rows to their new indexes, which doesn't change their order,
+    // and drop the rows which were erased or which need to be moved as their
+    // values changed
+    size_t size = m_table->size();
+    std::vector<bool> present(size);
+    size_t kept = 0;
+    for (auto row : m_rows) {
+        if (rows_moved) {
+            row = changes.new_row_index(row);
+        }
+        if (row == npos || row >= size || (keys_modified && changes.modifications.contains(row))) {
+            continue;
+        }
+        present[row] = true;
+        m_rows[kept++] = row;
+    }
+    m_rows.resize(kept);
+
+    std::vector<size_t> added;
+    for (size_t row = 0; row < size; ++row) {
+        if (!present[row]) {
+            added.push_back(row);
+        }
+    }
+    // Each insertion shifts the following rows, so past a point sorting
+    // everything again is faster
+    if (added.size() > m_rows.size() / 8 + 16) {
+        return false;
+    }
+    for (auto row : added) {
+        auto pos = std::upper_bound(m_rows.begin(), m_rows.end(), row,
+                                    [&](size_t a, size_t b) { return compare(a, b) < 0; });
+        m_rows.insert(pos, row);
+    }
+    return true;
+}
+
+int CompoundIndex::compare(size_t a, size_t b) const
+{
+    for (size_t i = 0; i < m_columns.size(); ++i) {
+        size_t col = m_columns[i];
+        int c;
+        if (m_types[i] == type_String) {
+            c = compare_strings(m_table->get_string(col, a), m_table->get_string(col, b));
+        }
+        else {
+            c = compare_ints(*m_table, m_types[i], col, a, m_table->is_null(col, b),
+                             get_int(*m_table, m_types[i], col, b));
+        }
+        if (c) {
+            return c;
+        }
+    }
+    return 0;
+}
+
+int CompoundIndex::compare(size_t row, size_t i, Value const& value) const
+{
+    size_t col = m_columns[i];
+    if (m_types[i] == type_String) {
+        return compare_strings(m_table->get_string(col, row),
+                               value.is_null ? StringData() : StringData(value.string_value));
+    }
+    return compare_ints(*m_table, m_types[i], col, row, value.is_null, value.int_value);
+}
+
+int CompoundIndex::compare(size_t row, std::vector<Value> const& prefix) const
+{
+    for (size_t i = 0; i < prefix.size(); ++i) {
+        if (int c = compare(row, i, prefix[i])) {
+            return c;
+        }
+    }
+    return 0;
+}
+
+void CompoundIndex::find(std::vector<Value> const& prefix, util::Optional<int64_t> min,
+                         util::Optional<int64_t> max, std::vector<size_t>& rows) const
+{
+    bool has_range = min || max;
+    // Compare the row's values in the leading columns with the prefix, and then
+    // its value in the next column with the bound
+    auto compare_to = [&](size_t row, util::Optional<int64_t> const& bound) {
+        if (int c = compare(row, prefix)) {
+            return c;
+        }
+        if (!has_range) {
+            return 0;
+        }
+        size_t col = m_columns[prefix.size()];
+        if (m_table->is_null(col, row)) {
+            return -1;
+        }
+        if (!bound) {
+            return 0;
+        }
+        int64_t value = get_int(*m_table, m_types[prefix.size()], col, row);
+        return value < *bound ? -1 : int(value > *bound);
+    };
+
+    auto begin = std::partition_point(m_rows.begin(), m_rows.end(),
+                                      [&](size_t row) { return compare_to(row, min) < 0; });
+    auto end = std::partition_point(begin, m_rows.end(),
+                                    [&](size_t row) { return compare_to(row, max) <= 0; });
+    rows.assign(begin, end);
+    std::sort(rows.begin(), rows.end());
+}
+
+void CompoundIndex::find_strings(std::vector<Value> const& prefix, util::Optional<StringBound> const& min,
+                                 util::Optional<StringBound> const& max, std::vector<size_t>& rows) const
+{
+    REALM_ASSERT(m_types[prefix.size()] == type_String);
+    size_t col = m_columns[prefix.size()];
+    // Compare the row's value in the column with the bound, with rows which
+    // don't match the prefix or are null ordered before or after every bound
+    auto compare_to = [&](size_t row, StringBound const* bound) {
+        if (int c = compare(row, prefix)) {
+            return c;
+        }
+        StringData value = m_table->get_string(col, row);
+        if (value.is_null()) {
+            return -1;
+        }
+        return bound ? compare_strings(value, bound->value) : 0;
+    };
+
+    auto begin = std::partition_point(m_rows.begin(), m_rows.end(), [&](size_t row) {
+        int c = compare_to(row, min ? &*min : nullptr);
+        return c < 0 || (c == 0 && min && !min->inclusive);
+    });
+    auto end = std::partition_point(begin, m_rows.end(), [&](size_t row) {
+        int c = compare_to(row, max ? &*max : nullptr);
+        return c < 0 || (c == 0 && (!max || max->inclusive));
+    });
+    rows.assign(begin, end);
+    std::sort(rows.begin(), rows.end());
+}
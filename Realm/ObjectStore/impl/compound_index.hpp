@@ -0,0 +1,117 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef REALM_COMPOUND_INDEX_HPP
+#define REALM_COMPOUND_INDEX_HPP
+
+#include <realm/data_type.hpp>
+#include <realm/string_data.hpp>
+#include <realm/table_ref.hpp>
+#include <realm/util/optional.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace realm {
+class Realm;
+
+namespace _impl {
+struct TransactionChangeInfo;
+
+// An index over the values of one or more int, date or string columns of a
+// table, for finding the rows with given values in the leading columns,
+// optionally with the value of the following column within a range, without
+// searching the table.
+//
+// The index is the table's rows sorted by their values in each of the columns
+// in turn, with nulls first and strings compared bytewise, so the matching
+// rows are found with a binary search. It's kept in memory by the Realm and is
+// brought up to date with the read transaction by applying the changes made
+// since it was last updated, or re-sorted if those aren't available.
+class CompoundIndex {
+public:
+    struct Value {
+        bool is_null = false;
+        int64_t int_value = 0;
+        std::string string_value;
+    };
+
+    struct StringBound {
+        std::string value;
+        bool inclusive = true;
+    };
+
+    CompoundIndex(Realm& realm, Table& table, std::vector<size_t> columns);
+
+    bool is_for(Table const& table, std::vector<size_t> const& columns) const noexcept;
+
+    // Bring the index up to date with the Realm's read transaction. Returns
+    // false if that isn't possible, which is the case within a write
+    // transaction as local changes are not tracked.
+    bool update();
+
+    // Replace `rows` with the rows whose values in the leading columns of the
+    // index are equal to `prefix`, and, if `min` or `max` are given, whose
+    // value in the next column is non-null and within [min, max], in ascending
+    // order. The column after the prefix must be an int or date column if a
+    // range is given, with dates compared as seconds since 1970.
+    void find(std::vector<Value> const& prefix, util::Optional<int64_t> min, util::Optional<int64_t> max,
+              std::vector<size_t>& rows) const;
+
+    // Replace `rows` with the rows whose values in the leading columns of the
+    // index are equal to `prefix`, and whose value in the next column, which
+    // must be a string column, is non-null and between `min` and `max`, in
+    // ascending order. Strings are compared bytewise, which for UTF-8 is the
+    // order of their code points.
+    void find_strings(std::vector<Value> const& prefix, util::Optional<StringBound> const& min,
+                      util::Optional<StringBound> const& max, std::vector<size_t>& rows) const;
+
+    // Incremented whenever the rows in the index change
+    uint64_t generation() const noexcept { return m_generation; }
+
+private:
+    Realm& m_realm;
+    TableRef m_table;
+    const std::vector<size_t> m_columns;
+    // The type of each of the columns
+    std::vector<DataType> m_types;
+    // Every row in the table, sorted by their values in m_columns
+    std::vector<size_t> m_rows;
+
+    bool m_built = false;
+    uint_fast64_t m_version = 0;
+    size_t m_write_count = 0;
+    uint64_t m_generation = 0;
+
+    void rebuild();
+    bool apply(TransactionChangeInfo const& info);
+
+    // Compare the rows' values in the columns of the index, returning a
+    // negative number, zero or a positive number
+    int compare(size_t a, size_t b) const;
+    // Compare the row's value in the i-th column of the index with the value
+    int compare(size_t row, size_t i, Value const& value) const;
+    // Compare the row's values in the leading columns of the index with the prefix
+    int compare(size_t row, std::vector<Value> const& prefix) const;
+};
+} // namespace _impl
+} // namespace realm
+
+#endif /* REALM_COMPOUND_INDEX_HPP */
@@ -0,0 +1,97 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+
+#include "decrypted_file.hpp"
+
+#include <realm/group.hpp>
+#include <realm/util/file.hpp>
+
+#include <cstring>
+#include <map>
+#include <mutex>
+
+using namespace realm;
+using namespace realm::_impl;
+
+namespace {
+std::mutex s_decrypted_files_mutex;
+std::map<std::string, std::weak_ptr<DecryptedFile>> s_decrypted_files;
+
+// The size of the file's contents once decrypted, which util::File reports
+// when it has the key. Opening a Group first validates the file and the key,
+// so that the wrong key is reported in the same way as for other Realms.
+size_t decrypted_size(std::string const& path, std::vector<char> const& key)
+{
+    Group group(path, key.data(), Group::mode_ReadOnly);
+
+    util::File file(path, util::File::mode_Read);
+    file.set_encryption_key(key.data());
+    return size_t(file.get_size());
+}
+}
+
+std::shared_ptr<DecryptedFile> DecryptedFile::get(std::string const& path, std::vector<char> const& key,
+                                                  size_t max_size, bool& decrypted)
+{
+    decrypted = false;
+    std::lock_guard<std::mutex> lock(s_decrypted_files_mutex);
+    auto& weak_file = s_decrypted_files[path];
+    if (auto file = weak_file.lock()) {
+        if (file->m_key == key) {
+            return file;
+        }
+    }
+
+    size_t size = decrypted_size(path, key);
+    if (size > max_size) {
+        return nullptr;
+    }
+
+    // Drop the entries for files which are no longer open while we're here
+    for (auto it = s_decrypted_files.begin(); it != s_decrypted_files.end(); ) {
+        if (it->second.expired() && it->first != path) {
+            it = s_decrypted_files.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+
+    auto file = std::make_shared<DecryptedFile>(path, key, size);
+    decrypted = true;
+    // A copy made with a different key isn't replaced, as Realms opened with
+    // that key may still be reading from it and be reopened
+    if (weak_file.expired()) {
+        weak_file = file;
+    }
+    return file;
+}
+
+DecryptedFile::DecryptedFile(std::string const& path, std::vector<char> const& key, size_t size)
+: m_key(key)
+, m_size(size)
+, m_data(new char[size])
+{
+    // Mapping the file with the key makes core decrypt each page as it's
+    // read, so copying the whole mapping decrypts the whole file
+    util::File file(path, util::File::mode_Read);
+    file.set_encryption_key(m_key.data());
+    util::File::Map<char> map(file, util::File::access_ReadOnly, m_size);
+    std::memcpy(m_data.get(), map.get_addr(), m_size);
+}
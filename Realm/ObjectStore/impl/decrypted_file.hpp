@@ -0,0 +1,61 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef REALM_DECRYPTED_FILE_HPP
+#define REALM_DECRYPTED_FILE_HPP
+
+#include <realm/binary_data.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace realm {
+namespace _impl {
+// A decrypted copy in memory of an entire encrypted Realm file which is
+// shared by every immutable Realm for the file in the process. The file is
+// decrypted once, when the first Realm for it is opened, after which reading
+// from it costs the same as reading from an unencrypted file, rather than
+// each Realm's mapping decrypting every page it touches.
+class DecryptedFile {
+public:
+    // Get the decrypted copy of the file at the path, decrypting it if no
+    // existing copy made with the same key is still in use. Returns null if
+    // the file's decrypted size is more than `max_size` bytes. `decrypted`
+    // is set to whether the file had to be decrypted. Throws the util::File
+    // exceptions if the file can't be opened, and the core exceptions for
+    // the wrong key.
+    static std::shared_ptr<DecryptedFile> get(std::string const& path, std::vector<char> const& key,
+                                              size_t max_size, bool& decrypted);
+
+    DecryptedFile(std::string const& path, std::vector<char> const& key, size_t size);
+
+    // The decrypted contents of the file, for passing to Group's buffer
+    // constructor without it taking ownership
+    BinaryData data() const noexcept { return {m_data.get(), m_size}; }
+
+private:
+    std::vector<char> m_key;
+    size_t m_size;
+    std::unique_ptr<char[]> m_data;
+};
+} // namespace _impl
+} // namespace realm
+
+#endif /* REALM_DECRYPTED_FILE_HPP */
@@ -0,0 +1,92 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+
+#include "expiry_sweeper.hpp"
+
+#include "async_writer.hpp"
+#include "dispatch_queue.hpp"
+
+using namespace realm;
+using namespace realm::_impl;
+
+ExpirySweeper::ExpirySweeper(Realm::Config const& config, std::weak_ptr<AsyncWriter> writer)
+: m_config(config)
+, m_writer(std::move(writer))
+, m_state(std::make_shared<State>())
+{
+    m_thread = std::thread([this] { run(); });
+}
+
+ExpirySweeper::~ExpirySweeper()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        m_state->shutdown = true;
+    }
+    m_state->cv.notify_one();
+    m_thread.join();
+}
+
+void ExpirySweeper::run()
+{
+    set_current_thread_name("RLMRealm expiry sweeper");
+
+    std::unique_lock<std::mutex> lock(m_state->mutex);
+    while (true) {
+        m_state->cv.wait_for(lock, m_config.expiry_sweep_interval, [&] {
+            return m_state->shutdown || (m_state->more && !m_state->sweeping);
+        });
+        if (m_state->shutdown) {
+            break;
+        }
+        if (m_state->sweeping) {
+            continue;
+        }
+
+        auto writer = m_writer.lock();
+        if (!writer) {
+            break;
+        }
+        m_state->sweeping = true;
+        m_state->more = false;
+        lock.unlock();
+        sweep(*writer);
+        writer.reset();
+        lock.lock();
+    }
+}
+
+void ExpirySweeper::sweep(AsyncWriter& writer)
+{
+    auto state = m_state;
+    size_t batch_size = m_config.expiry_sweep_batch_size;
+    auto deleted = std::make_shared<size_t>(0);
+    writer.enqueue(m_config, [=](Realm& realm) {
+        *deleted = realm.delete_expired_objects(batch_size);
+        if (!*deleted) {
+            realm.cancel_transaction();
+        }
+    }, [=](std::exception_ptr error) {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->sweeping = false;
+        // A failed sweep is retried after the interval rather than immediately
+        state->more = !error && *deleted == batch_size;
+        state->cv.notify_one();
+    });
+}
@@ -0,0 +1,70 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef REALM_EXPIRY_SWEEPER_HPP
+#define REALM_EXPIRY_SWEEPER_HPP
+
+#include "shared_realm.hpp"
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace realm {
+namespace _impl {
+class AsyncWriter;
+
+// A background thread which periodically queues a write on the file's async
+// writer to delete the objects which have expired. Each write deletes at most
+// the config's expiry_sweep_batch_size objects, and if that many were deleted
+// the next batch is queued as soon as it completes rather than after the
+// interval, so that other writes can be interleaved with clearing a large
+// backlog. The thread is stopped when the sweeper is destroyed.
+class ExpirySweeper {
+public:
+    ExpirySweeper(Realm::Config const& config, std::weak_ptr<AsyncWriter> writer);
+    ~ExpirySweeper();
+
+private:
+    // Shared with the queued writes, which may complete after the sweeper
+    // is destroyed
+    struct State {
+        std::mutex mutex;
+        std::condition_variable cv;
+        bool shutdown = false;
+        // Whether a queued write has yet to complete
+        bool sweeping = false;
+        // Whether the last write deleted a full batch
+        bool more = false;
+    };
+
+    Realm::Config m_config;
+    std::weak_ptr<AsyncWriter> m_writer;
+    std::shared_ptr<State> m_state;
+    std::thread m_thread;
+
+    void run();
+    void sweep(AsyncWriter& writer);
+};
+
+} // namespace _impl
+} // namespace realm
+
+#endif /* REALM_EXPIRY_SWEEPER_HPP */
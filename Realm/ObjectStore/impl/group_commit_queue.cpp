@@ -0,0 +1,150 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "group_commit_queue.hpp"
+
+#include "shared_realm.hpp"
+
+#include <stdexcept>
+
+using namespace realm;
+using namespace realm::_impl;
+
+void GroupCommitQueue::write(Realm& realm, WriteFunction fn)
+{
+    Writer writer{std::move(fn), nullptr, false};
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_pending.push_back(&writer);
+    m_cv.wait(lock, [&] { return writer.done || !m_has_leader; });
+
+    if (!writer.done) {
+        m_has_leader = true;
+        lock.unlock();
+
+        // Acquire the write lock before picking up the group, as that's where
+        // other writers will be waiting
+        std::exception_ptr begin_error;
+        try {
+            realm.begin_transaction();
+        }
+        catch (...) {
+            begin_error = std::current_exception();
+        }
+
+        lock.lock();
+        std::vector<Writer*> group;
+        group.swap(m_pending);
+        lock.unlock();
+
+        if (begin_error) {
+            for (auto w : group) {
+                w->error = begin_error;
+            }
+        }
+        else {
+            commit_group(realm, group);
+        }
+
+        lock.lock();
+        for (auto w : group) {
+            w->done = true;
+        }
+        m_has_leader = false;
+        m_cv.notify_all();
+    }
+
+    lock.unlock();
+    if (writer.error) {
+        std::rethrow_exception(writer.error);
+    }
+}
+
+void GroupCommitQueue::commit_group(Realm& realm, std::vector<Writer*> group)
+{
+    auto fail_all = [&] {
+        for (auto w : group) {
+            w->error = std::current_exception();
+        }
+    };
+    auto changes_size = [&] {
+        return realm.is_in_transaction() ? realm.m_history->get_uncommitted_changes().size() : 0;
+    };
+
+    while (true) {
+        bool needs_rollback = false;
+        for (auto it = group.begin(); it != group.end(); ) {
+            Writer& w = **it;
+            size_t changes_before = changes_size();
+            try {
+                w.fn(realm);
+                ++it;
+                continue;
+            }
+            catch (IncorrectThreadException const&) {
+                // The function was run on behalf of another thread and used
+                // something confined to that thread
+                w.error = std::make_exception_ptr(std::logic_error("Grouped write functions may be run on another "
+                                                                   "thread, and so can only use the Realm they are "
+                                                                   "passed and objects obtained from it."));
+            }
+            catch (...) {
+                w.error = std::current_exception();
+            }
+            it = group.erase(it);
+
+            // A function which threw before changing anything can be dropped
+            // without disturbing the changes made by the others
+            if (!realm.is_in_transaction() || changes_size() != changes_before) {
+                needs_rollback = true;
+                break;
+            }
+        }
+        if (!needs_rollback) {
+            break;
+        }
+
+        // There's no way to roll back just the failed function's changes, so
+        // roll back everything and rerun the others without it
+        try {
+            if (realm.is_in_transaction()) {
+                realm.cancel_transaction();
+            }
+            if (group.empty()) {
+                return;
+            }
+            realm.begin_transaction();
+        }
+        catch (...) {
+            fail_all();
+            return;
+        }
+    }
+
+    try {
+        if (group.empty()) {
+            realm.cancel_transaction();
+        }
+        else {
+            realm.commit_transaction();
+        }
+    }
+    catch (...) {
+        fail_all();
+    }
+}
@@ -0,0 +1,71 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef REALM_GROUP_COMMIT_QUEUE_HPP
+#define REALM_GROUP_COMMIT_QUEUE_HPP
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace realm {
+class Realm;
+
+namespace _impl {
+// Coalesces write transactions from multiple threads for a single Realm file
+// into one commit. The first thread to arrive becomes the leader and runs the
+// write functions of every thread queued behind it in a single write
+// transaction, so that the whole group pays for only one durable commit and
+// one change notification.
+class GroupCommitQueue {
+public:
+    typedef std::function<void (Realm&)> WriteFunction;
+
+    // Run the function in a write transaction on either the given Realm or the
+    // Realm of another thread waiting to commit, so it must only use the Realm
+    // it is passed. Blocks until the transaction containing the function has
+    // been committed, and rethrows any exception thrown by the function or by
+    // beginning or committing the transaction. Functions which throw after
+    // making changes force the others in the group to be run again.
+    void write(Realm& realm, WriteFunction fn);
+
+private:
+    struct Writer {
+        WriteFunction fn;
+        std::exception_ptr error;
+        bool done;
+    };
+
+    // Writers which have not yet been picked up by a leader
+    std::vector<Writer*> m_pending;
+    // Is some thread currently committing a group?
+    bool m_has_leader = false;
+
+    // Guards m_pending, m_has_leader and the done and error fields of writers
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+
+    static void commit_group(Realm& realm, std::vector<Writer*> group);
+};
+
+} // namespace _impl
+} // namespace realm
+
+#endif /* REALM_GROUP_COMMIT_QUEUE_HPP */
@@ -0,0 +1,212 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+
+#include "link_list_aggregates.hpp"
+
+#include "shared_realm.hpp"
+#include "transact_log_handler.hpp"
+
+#include <realm/link_view.hpp>
+#include <realm/table.hpp>
+
+#include <algorithm>
+
+using namespace realm;
+using namespace realm::_impl;
+
+LinkListAggregates::LinkListAggregates(Realm& realm, Table& table, size_t link_column, size_t target_column)
+: m_realm(realm)
+, m_table(table.get_table_ref())
+, m_target(table.get_link_target(link_column))
+, m_link_column(link_column)
+, m_target_column(target_column)
+, m_is_int(target_column == npos || m_target->get_column_type(target_column) == type_Int)
+{
+}
+
+bool LinkListAggregates::is_for(Table const& table, size_t link_column, size_t target_column) const noexcept
+{
+    return m_table.get() == &table && m_link_column == link_column && m_target_column == target_column
+        && m_table->is_attached() && m_target->is_attached();
+}
+
+bool LinkListAggregates::update()
+{
+    if (m_realm.is_in_transaction() || !m_table->is_attached() || !m_target->is_attached()) {
+        return false;
+    }
+
+    auto version = m_realm.current_transaction_version();
+    bool same_writes = m_realm.write_transaction_count() == m_write_count;
+    if (m_built && same_writes && version == m_version) {
+        return true;
+    }
+
+    TransactionChangeInfo info;
+    if (!m_built || !same_writes || !m_realm.get_changes_since(m_version, info) || !apply(info)) {
+        rebuild();
+    }
+    m_version = version;
+    m_write_count = m_realm.write_transaction_count();
+    return true;
+}
+
+int64_t LinkListAggregates::compute_int(const Table& table, size_t link_column, size_t target_column, size_t row)
+{
+    auto list = table.get_linklist(link_column, row);
+    if (target_column == npos) {
+        return list->size();
+    }
+    const Table& target = list->get_target_table();
+    int64_t sum = 0;
+    for (size_t i = 0, size = list->size(); i < size; ++i) {
+        size_t target_row = list->get(i).get_index();
+        if (!target.is_null(target_column, target_row)) {
+            sum += target.get_int(target_column, target_row);
+        }
+    }
+    return sum;
+}
+
+double LinkListAggregates::compute_double(const Table& table, size_t link_column, size_t target_column, size_t row)
+{
+    auto list = table.get_linklist(link_column, row);
+    const Table& target = list->get_target_table();
+    bool is_float = target.get_column_type(target_column) == type_Float;
+    double sum = 0;
+    for (size_t i = 0, size = list->size(); i < size; ++i) {
+        size_t target_row = list->get(i).get_index();
+        if (!target.is_null(target_column, target_row)) {
+            sum += is_float ? target.get_float(target_column, target_row) : target.get_double(target_column, target_row);
+        }
+    }
+    return sum;
+}
+
+void LinkListAggregates::resize(size_t size)
+{
+    if (m_is_int) {
+        m_int_values.resize(size);
+    }
+    else {
+        m_double_values.resize(size);
+    }
+}
+
+void LinkListAggregates::compute(size_t row)
+{
+    if (m_is_int) {
+        m_int_values[row] = compute_int(*m_table, m_link_column, m_target_column, row);
+    }
+    else {
+        m_double_values[row] = compute_double(*m_table, m_link_column, m_target_column, row);
+    }
+}
+
+void LinkListAggregates::rebuild()
+{
+    size_t size = m_table->size();
+    resize(size);
+    for (size_t row = 0; row < size; ++row) {
+        compute(row);
+    }
+    m_built = true;
+}
+
+bool LinkListAggregates::apply(TransactionChangeInfo const& info)
+{
+    if (info.schema_changed) {
+        return false;
+    }
+
+    // The rows whose aggregates need to be recomputed
+    std::vector<size_t> changed;
+
+    size_t table_ndx = m_table->get_index_in_group();
+    if (table_ndx < info.tables.size()) {
+        auto& changes = info.tables[table_ndx];
+        if (changes.row_indexes_lost) {
+            return false;
+        }
+        for (auto& change : changes.row_index_changes) {
+            using Kind = TransactionChangeInfo::TableChanges::RowIndexChange::Kind;
+            switch (change.kind) {
+                case Kind::MoveLastOver:
+                    if (m_is_int) {
+                        m_int_values[change.row] = m_int_values[change.other_or_count];
+                    }
+                    else {
+                        m_double_values[change.row] = m_double_values[change.other_or_count];
+                    }
+                    resize(size() - 1);
+                    break;
+                case Kind::Swap:
+                    if (m_is_int) {
+                        std::swap(m_int_values[change.row], m_int_values[change.other_or_count]);
+                    }
+                    else {
+                        std::swap(m_double_values[change.row], m_double_values[change.other_or_count]);
+                    }
+                    break;
+                default:
+                    // Rows inserted or erased in the middle of the table shift
+                    // every following row, so it's simpler to start over
+                    return false;
+            }
+        }
+
+        if (changes.column_modified(m_link_column)) {
+            for (auto range : changes.modifications) {
+                for (size_t row = range.first; row < range.second; ++row) {
+                    changed.push_back(row);
+                }
+            }
+        }
+    }
+
+    // A change to a value being summed changes the sums for every row which
+    // links to it, which are found by following the backlinks
+    size_t target_ndx = m_target->get_index_in_group();
+    if (m_target_column != npos && target_ndx < info.tables.size()
+        && info.tables[target_ndx].column_modified(m_target_column)) {
+        for (auto range : info.tables[target_ndx].modifications) {
+            for (size_t row = range.first; row < std::min(range.second, m_target->size()); ++row) {
+                for (size_t i = 0, count = m_target->get_backlink_count(row, *m_table, m_link_column); i < count; ++i) {
+                    changed.push_back(m_target->get_backlink(row, *m_table, m_link_column, i));
+                }
+            }
+        }
+    }
+
+    size_t old_size = size();
+    size_t new_size = m_table->size();
+    resize(new_size);
+    for (size_t row = old_size; row < new_size; ++row) {
+        compute(row);
+    }
+
+    std::sort(changed.begin(), changed.end());
+    changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+    for (auto row : changed) {
+        if (row < old_size && row < new_size) {
+            compute(row);
+        }
+    }
+    return true;
+}
@@ -0,0 +1,93 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef REALM_LINK_LIST_AGGREGATES_HPP
+#define REALM_LINK_LIST_AGGREGATES_HPP
+
+#include <realm/data_type.hpp>
+#include <realm/table_ref.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace realm {
+class Realm;
+
+namespace _impl {
+struct TransactionChangeInfo;
+
+// The number of rows in each row's link list in a column, or the sum of the
+// values of a numeric column of the rows in it, for answering @count and @sum
+// queries without reading every row's link list.
+//
+// The aggregates are kept in memory by the Realm, and are brought up to date
+// with the read transaction by recomputing them for the rows whose link lists
+// changed, and, for sums, for the rows which link to a row whose value
+// changed, or recomputed for every row if the changes aren't available.
+class LinkListAggregates {
+public:
+    // Aggregate the link lists in `link_column` of the table: their sizes if
+    // `target_column` is npos, and otherwise the sum of the target table's
+    // values in that column
+    LinkListAggregates(Realm& realm, Table& table, size_t link_column, size_t target_column);
+
+    bool is_for(Table const& table, size_t link_column, size_t target_column) const noexcept;
+
+    // Bring the aggregates up to date with the Realm's read transaction.
+    // Returns false if that isn't possible, which is the case within a write
+    // transaction as local changes are not tracked.
+    bool update();
+
+    // Are the aggregates integers rather than doubles? Sizes and sums of int
+    // columns are, while sums of float and double columns are not.
+    bool is_int() const noexcept { return m_is_int; }
+
+    int64_t int_value(size_t row) const { return m_int_values[row]; }
+    double double_value(size_t row) const { return m_double_values[row]; }
+
+    // Compute the aggregate for a single row from its link list
+    static int64_t compute_int(const Table& table, size_t link_column, size_t target_column, size_t row);
+    static double compute_double(const Table& table, size_t link_column, size_t target_column, size_t row);
+
+private:
+    Realm& m_realm;
+    TableRef m_table;
+    TableRef m_target;
+    const size_t m_link_column;
+    const size_t m_target_column;
+    bool m_is_int;
+
+    // The aggregate for each row, in whichever of these is_int() selects
+    std::vector<int64_t> m_int_values;
+    std::vector<double> m_double_values;
+
+    bool m_built = false;
+    uint_fast64_t m_version = 0;
+    size_t m_write_count = 0;
+
+    size_t size() const noexcept { return m_is_int ? m_int_values.size() : m_double_values.size(); }
+    void resize(size_t size);
+    void compute(size_t row);
+    void rebuild();
+    bool apply(TransactionChangeInfo const& info);
+};
+} // namespace _impl
+} // namespace realm
+
+#endif /* REALM_LINK_LIST_AGGREGATES_HPP */
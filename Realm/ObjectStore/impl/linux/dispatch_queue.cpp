@@ -0,0 +1,79 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "dispatch_queue.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <pthread.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace realm;
+using namespace realm::_impl;
+
+DispatchQueue::DispatchQueue(std::shared_ptr<Scheduler> scheduler)
+: m_scheduler(std::move(scheduler))
+{
+}
+
+bool DispatchQueue::is_current() const
+{
+    return m_scheduler && m_scheduler->is_current();
+}
+
+void DispatchQueue::async(std::function<void ()> fn) const
+{
+    async_after(std::chrono::nanoseconds::zero(), std::move(fn));
+}
+
+void DispatchQueue::async_after(std::chrono::nanoseconds delay, std::function<void ()> fn) const
+{
+    m_scheduler->post(std::max(delay, std::chrono::nanoseconds::zero()), std::move(fn));
+}
+
+void DispatchQueue::apply(size_t count, std::function<void (size_t)> const& fn)
+{
+    // Indexes are handed out one at a time so that uneven amounts of work
+    // per index are balanced between the threads
+    std::atomic<size_t> next{0};
+    auto work = [&] {
+        for (size_t i = next++; i < count; i = next++) {
+            fn(i);
+        }
+    };
+
+    size_t thread_count = std::min<size_t>(count, std::max(1U, std::thread::hardware_concurrency()));
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < thread_count; ++i) {
+        threads.emplace_back(work);
+    }
+    // The calling thread does its share rather than just waiting
+    work();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+void realm::_impl::set_current_thread_name(const char* name)
+{
+    std::string truncated(name, std::min<size_t>(strlen(name), 15));
+    pthread_setname_np(pthread_self(), truncated.c_str());
+}
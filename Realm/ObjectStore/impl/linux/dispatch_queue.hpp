@@ -0,0 +1,78 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef REALM_DISPATCH_QUEUE_HPP
+#define REALM_DISPATCH_QUEUE_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+
+namespace realm {
+namespace _impl {
+// A serial queue of work which a Realm can be confined to instead of a
+// thread. There is no system dispatch library to build on, so the queue is
+// an event loop belonging to the host application, which it wraps in a
+// Scheduler. This is also how notifications of commits are delivered to
+// queue-confined Realms.
+class DispatchQueue {
+public:
+    class Scheduler {
+    public:
+        virtual ~Scheduler() = default;
+
+        // Run the function on the event loop once the delay has passed. Must
+        // be callable from any thread.
+        virtual void post(std::chrono::nanoseconds delay, std::function<void ()> fn) = 0;
+        // Is the calling code running on the event loop?
+        virtual bool is_current() const = 0;
+    };
+
+    DispatchQueue() = default;
+    explicit DispatchQueue(std::shared_ptr<Scheduler> scheduler);
+
+    explicit operator bool() const noexcept { return m_scheduler != nullptr; }
+    void* get() const noexcept { return m_scheduler.get(); }
+
+    // Is the calling code running on this queue?
+    bool is_current() const;
+
+    // Asynchronously run the function on the queue, optionally after a delay
+    void async(std::function<void ()> fn) const;
+    void async_after(std::chrono::nanoseconds delay, std::function<void ()> fn) const;
+
+    // Call the function with each index in [0, count) concurrently on a set
+    // of worker threads, returning once all of the calls have completed
+    static void apply(size_t count, std::function<void (size_t)> const& fn);
+
+    bool operator==(DispatchQueue const& other) const noexcept { return m_scheduler == other.m_scheduler; }
+    bool operator!=(DispatchQueue const& other) const noexcept { return m_scheduler != other.m_scheduler; }
+
+private:
+    std::shared_ptr<Scheduler> m_scheduler;
+};
+
+// Name the calling thread for debuggers and profilers. Linux limits thread
+// names to 15 characters, so longer names are truncated.
+void set_current_thread_name(const char* name);
+
+} // namespace _impl
+} // namespace realm
+
+#endif /* REALM_DISPATCH_QUEUE_HPP */
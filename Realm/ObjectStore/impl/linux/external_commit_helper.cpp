@@ -0,0 +1,344 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "external_commit_helper.hpp"
+
+#include "change_calculator.hpp"
+#include "shared_realm.hpp"
+#include "trace.hpp"
+
+#include <algorithm>
+#include <assert.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/stat.h>
+#include <system_error>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sstream>
+
+using namespace realm;
+using namespace realm::_impl;
+
+namespace {
+// Write a byte to a pipe to notify anyone waiting for data on the pipe
+void notify_fd(int fd)
+{
+    while (true) {
+        char c = 0;
+        ssize_t ret = write(fd, &c, 1);
+        if (ret == 1) {
+            break;
+        }
+
+        // If the pipe's buffer is full, we need to read some of the old data in
+        // it to make space. We don't just read in the code waiting for
+        // notifications so that we can notify multiple waiters with a single
+        // write.
+        assert(ret == -1 && errno == EAGAIN);
+        char buff[1024];
+        read(fd, buff, sizeof buff);
+    }
+}
+} // anonymous namespace
+
+void ExternalCommitHelper::FdHolder::close()
+{
+    if (m_fd != -1) {
+        ::close(m_fd);
+    }
+    m_fd = -1;
+}
+
+// This works the same way as the kqueue() implementation: everyone who wants
+// to be notified of commits waits for the amount of data in the named pipe to
+// change, and no one ever actually reads from it. Edge-triggered epoll reports
+// each write to the pipe to every process waiting on it.
+namespace realm {
+namespace _impl {
+class NotificationListener {
+public:
+    // Created on first use and never destroyed, as the thread is blocked in
+    // epoll_wait() for the life of the process
+    static NotificationListener& shared()
+    {
+        static NotificationListener* listener = new NotificationListener;
+        return *listener;
+    }
+
+    void add(ExternalCommitHelper* helper, int fd)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        struct epoll_event event{};
+        event.events = EPOLLIN | EPOLLET;
+        event.data.ptr = helper;
+        if (epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, fd, &event) == -1) {
+            throw std::system_error(errno, std::system_category());
+        }
+        m_helpers.push_back(helper);
+    }
+
+    // Once this returns the helper will not be called again
+    void remove(ExternalCommitHelper* helper, int fd)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+        m_helpers.erase(std::remove(m_helpers.begin(), m_helpers.end(), helper), m_helpers.end());
+    }
+
+private:
+    int m_epoll_fd;
+    std::mutex m_mutex;
+    std::vector<ExternalCommitHelper*> m_helpers;
+
+    NotificationListener()
+    {
+        m_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        if (m_epoll_fd == -1) {
+            throw std::system_error(errno, std::system_category());
+        }
+
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+
+        auto fn = [](void *self) -> void * {
+            static_cast<NotificationListener *>(self)->listen();
+            return nullptr;
+        };
+        pthread_t thread;
+        int ret = pthread_create(&thread, &attr, fn, this);
+        pthread_attr_destroy(&attr);
+        if (ret != 0) {
+            ::close(m_epoll_fd);
+            throw std::system_error(ret, std::system_category());
+        }
+    }
+
+    void listen()
+    {
+        set_current_thread_name("RLMRealm notification listener");
+
+        while (true) {
+            struct epoll_event events[16];
+            // Wait for data to become available on any of the named pipes
+            int count = epoll_wait(m_epoll_fd, events, 16, -1);
+            if (count == -1 && errno == EINTR) {
+                continue;
+            }
+            assert(count >= 0);
+
+            // Helpers are only called with the lock held so that they can't
+            // be destroyed while being notified
+            std::lock_guard<std::mutex> lock(m_mutex);
+            REALM_TRACE_POINT(ExternalCommit, nullptr, 0, count);
+            for (int i = 0; i < count; ++i) {
+                auto helper = static_cast<ExternalCommitHelper*>(events[i].data.ptr);
+                // The event may have been reported before the helper was removed
+                if (std::find(m_helpers.begin(), m_helpers.end(), helper) != m_helpers.end()) {
+                    helper->commit_available();
+                }
+            }
+        }
+    }
+};
+} // namespace _impl
+} // namespace realm
+
+ExternalCommitHelper::ExternalCommitHelper(Realm* realm)
+{
+    add_realm(realm);
+
+    auto const& config = realm->config();
+    if (config.compute_changes_in_background && !config.read_only) {
+        m_change_calculator = std::make_unique<ChangeCalculator>(config, [this] { signal_commits(); });
+    }
+
+    auto path = config.path + ".note";
+
+    // Create and open the named pipe
+    int ret = mkfifo(path.c_str(), 0600);
+    if (ret == -1) {
+        int err = errno;
+        if (err == ENOTSUP || err == EPERM) {
+            // Filesystem doesn't support named pipes, so try putting it in tmp instead
+            // Hash collisions are okay here because they just result in doing
+            // extra work, as opposed to correctness problems
+            const char* tmp = getenv("TMPDIR");
+            std::ostringstream ss;
+            ss << (tmp ? tmp : "/tmp/");
+            ss << "realm_" << std::hash<std::string>()(path) << ".note";
+            path = ss.str();
+            ret = mkfifo(path.c_str(), 0600);
+            err = errno;
+        }
+        // the fifo already existing isn't an error
+        if (ret == -1 && err != EEXIST) {
+            throw std::system_error(err, std::system_category());
+        }
+    }
+
+    // Make writing to the pipe return -1 when the pipe's buffer is full
+    // rather than blocking until there's space available
+    m_notify_fd = open(path.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if (m_notify_fd == -1) {
+        throw std::system_error(errno, std::system_category());
+    }
+
+    NotificationListener::shared().add(this, m_notify_fd);
+}
+
+ExternalCommitHelper::~ExternalCommitHelper()
+{
+    REALM_ASSERT_DEBUG(m_realms.empty());
+    NotificationListener::shared().remove(this, m_notify_fd);
+}
+
+void ExternalCommitHelper::add_realm(realm::Realm* realm)
+{
+    std::lock_guard<std::mutex> lock(m_realms_mutex);
+
+    PerRealmInfo info{realm};
+    info.queue = realm->config().dispatch_queue;
+    info.weak_realm = realm->shared_from_this();
+    info.queue_signal_pending = std::make_shared<std::atomic<bool>>(false);
+    info.notification_interval = realm->config().notification_interval;
+    m_realms.push_back(std::move(info));
+}
+
+void ExternalCommitHelper::remove_realm(realm::Realm* realm)
+{
+    std::lock_guard<std::mutex> lock(m_realms_mutex);
+    for (auto it = m_realms.begin(); it != m_realms.end(); ++it) {
+        if (it->realm == realm) {
+            m_realms.erase(it);
+            return;
+        }
+    }
+    REALM_TERMINATE("Realm not registered");
+}
+
+void ExternalCommitHelper::notify_others()
+{
+    notify_fd(m_notify_fd);
+}
+
+void ExternalCommitHelper::signal(PerRealmInfo const& info, std::chrono::nanoseconds delay)
+{
+    if (!info.queue || info.queue_signal_pending->exchange(true)) {
+        return;
+    }
+
+    auto pending = info.queue_signal_pending;
+    auto weak_realm = info.weak_realm;
+    info.queue.async_after(delay, [=] {
+        pending->store(false);
+        // The Realm may have been closed after the function was queued
+        auto realm = weak_realm.lock();
+        if (realm && !realm->is_closed()) {
+            realm->notify();
+        }
+    });
+}
+
+void ExternalCommitHelper::signal_commit(PerRealmInfo& info)
+{
+    auto now = std::chrono::steady_clock::now();
+    if (info.notification_interval == std::chrono::milliseconds::zero()
+        || now >= info.last_commit_signal + info.notification_interval) {
+        info.last_commit_signal = now;
+        signal(info);
+        return;
+    }
+    if (now < info.delayed_signal_time) {
+        // The pending delayed signal will deliver this commit too
+        return;
+    }
+
+    auto time = info.last_commit_signal + info.notification_interval;
+    info.last_commit_signal = time;
+    info.delayed_signal_time = time;
+    signal(info, time - now);
+}
+
+void ExternalCommitHelper::invoke_on_realm_thread(realm::Realm* realm, std::function<void ()> fn)
+{
+    std::lock_guard<std::mutex> lock(m_realms_mutex);
+    for (auto& info : m_realms) {
+        if (info.realm == realm) {
+            info.pending_invocations.push_back(std::move(fn));
+            signal(info);
+            return;
+        }
+    }
+}
+
+void ExternalCommitHelper::signal_realm(realm::Realm* realm)
+{
+    std::lock_guard<std::mutex> lock(m_realms_mutex);
+    for (auto const& info : m_realms) {
+        if (info.realm == realm) {
+            signal(info);
+            return;
+        }
+    }
+}
+
+void ExternalCommitHelper::commit_available()
+{
+    if (m_change_calculator) {
+        m_change_calculator->request_update();
+    }
+    else {
+        signal_commits();
+    }
+}
+
+void ExternalCommitHelper::signal_commits()
+{
+    std::lock_guard<std::mutex> lock(m_realms_mutex);
+    for (auto& realm : m_realms) {
+        signal_commit(realm);
+    }
+}
+
+bool ExternalCommitHelper::get_precomputed_changes(uint_fast64_t version, TransactionChangeInfo& changes,
+                                                   std::shared_ptr<RealmSnapshot>& target)
+{
+    return m_change_calculator && m_change_calculator->get_changes(version, changes, target);
+}
+
+void ExternalCommitHelper::run_pending_invocations(realm::Realm* realm)
+{
+    std::vector<std::function<void ()>> pending;
+    {
+        std::lock_guard<std::mutex> lock(m_realms_mutex);
+        for (auto& info : m_realms) {
+            if (info.realm == realm) {
+                pending.swap(info.pending_invocations);
+                break;
+            }
+        }
+    }
+
+    // Run without holding the lock as the functions may queue more work
+    for (auto& fn : pending) {
+        fn();
+    }
+}
@@ -0,0 +1,160 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef REALM_EXTERNAL_COMMIT_HELPER_HPP
+#define REALM_EXTERNAL_COMMIT_HELPER_HPP
+
+#include "dispatch_queue.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace realm {
+class Realm;
+class RealmSnapshot;
+
+namespace _impl {
+class ChangeCalculator;
+class NotificationListener;
+struct TransactionChangeInfo;
+
+// Commits are announced to other threads and processes by writing to a named
+// pipe next to the Realm file, which a single process-wide thread waits on
+// with epoll for every file the process has open. There is no runloop to
+// deliver notifications with, so they are delivered through the Realm's
+// DispatchQueue, which wraps the host's event loop. Realms which aren't
+// confined to a queue have nowhere to be notified, and only see new commits
+// and run pending invocations when refreshed or when the host calls
+// Realm::notify() itself.
+class ExternalCommitHelper {
+public:
+    ExternalCommitHelper(Realm* realm);
+    ~ExternalCommitHelper();
+
+    void notify_others();
+    void add_realm(Realm* realm);
+    void remove_realm(Realm* realm);
+
+    // Run the function on the given Realm's thread the next time it processes
+    // notifications. Does nothing if the Realm has been removed. Can be
+    // called from any thread.
+    void invoke_on_realm_thread(Realm* realm, std::function<void ()> fn);
+    // Run all functions queued for the Realm. Must be called on its thread.
+    void run_pending_invocations(Realm* realm);
+    // Make the Realm process notifications again on its thread even though
+    // nothing new has been committed. Can be called from any thread.
+    void signal_realm(Realm* realm);
+
+    // Get the changes from the given version which were computed in the
+    // background, if the file's first Realm asked for that, along with a
+    // snapshot pinning the version they end at. Returns false if they
+    // aren't available. Can be called from any thread.
+    bool get_precomputed_changes(uint_fast64_t version, TransactionChangeInfo& changes,
+                                 std::shared_ptr<RealmSnapshot>& target);
+
+    // The time of the most recent commit announced with notify_others() by a
+    // Realm in this process, for measuring how long it takes the other Realms
+    // to be notified of it. Can be called from any thread.
+    void set_last_commit_time(std::chrono::steady_clock::time_point time)
+    {
+        m_last_commit_time = time.time_since_epoch().count();
+    }
+    std::chrono::steady_clock::time_point last_commit_time() const
+    {
+        return std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(m_last_commit_time.load()));
+    }
+
+private:
+    std::atomic<std::chrono::steady_clock::rep> m_last_commit_time{0};
+
+    // A RAII holder for a file descriptor which automatically closes the wrapped
+    // fd when it's deallocated
+    class FdHolder {
+    public:
+        FdHolder() = default;
+        ~FdHolder() { close(); }
+        operator int() const { return m_fd; }
+
+        FdHolder& operator=(int newFd) {
+            close();
+            m_fd = newFd;
+            return *this;
+        }
+
+    private:
+        int m_fd = -1;
+        void close();
+
+        FdHolder& operator=(FdHolder const&) = delete;
+        FdHolder(FdHolder const&) = delete;
+    };
+
+    struct PerRealmInfo {
+        Realm* realm;
+        // Null for Realms which aren't confined to a queue. The flag is set
+        // while a notification is queued so that they are coalesced.
+        DispatchQueue queue;
+        std::weak_ptr<Realm> weak_realm;
+        std::shared_ptr<std::atomic<bool>> queue_signal_pending;
+        // Functions waiting to be run on the Realm's thread
+        std::vector<std::function<void ()>> pending_invocations;
+
+        // The Realm's minimum time between notifications of commits. Commits
+        // made sooner than that after a notification are delivered together
+        // at the end of the interval by dispatching to its queue after a delay.
+        std::chrono::milliseconds notification_interval{0};
+        std::chrono::steady_clock::time_point last_commit_signal;
+        // Set to the end of the interval while a delayed signal is pending
+        std::chrono::steady_clock::time_point delayed_signal_time;
+    };
+
+    static void signal(PerRealmInfo const& info, std::chrono::nanoseconds delay = {});
+    // Signal the Realm about a commit, subject to its notification interval
+    static void signal_commit(PerRealmInfo& info);
+    // Signal every Realm about a commit, or have the change calculator do so
+    // once it has parsed the new transaction logs
+    void commit_available();
+    void signal_commits();
+
+    friend class NotificationListener;
+
+    // Currently registered realms and the signal for delivering notifications
+    // to them
+    std::vector<PerRealmInfo> m_realms;
+
+    // Mutex which guards m_realms
+    std::mutex m_realms_mutex;
+
+    // Read-write file descriptor for the named pipe which is waited on for
+    // changes by the process's NotificationListener and written to when a
+    // commit is made
+    FdHolder m_notify_fd;
+
+    // Declared last so that the worker is stopped before anything it uses
+    // when signalling Realms is destroyed
+    std::unique_ptr<ChangeCalculator> m_change_calculator;
+};
+} // namespace _impl
+} // namespace realm
+
+#endif /* REALM_EXTERNAL_COMMIT_HELPER_HPP */
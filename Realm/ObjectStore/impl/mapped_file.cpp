@@ -0,0 +1,62 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "mapped_file.hpp"
+
+#include <map>
+#include <mutex>
+
+using namespace realm;
+using namespace realm::_impl;
+
+namespace {
+std::mutex s_mapped_files_mutex;
+std::map<std::string, std::weak_ptr<MappedFile>> s_mapped_files;
+}
+
+std::shared_ptr<MappedFile> MappedFile::get(std::string const& path)
+{
+    std::lock_guard<std::mutex> lock(s_mapped_files_mutex);
+    auto& weak_file = s_mapped_files[path];
+    if (auto file = weak_file.lock()) {
+        return file;
+    }
+
+    // Drop the entries for files which are no longer mapped while we're here
+    for (auto it = s_mapped_files.begin(); it != s_mapped_files.end(); ) {
+        if (it->second.expired() && it->first != path) {
+            it = s_mapped_files.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+
+    auto file = std::make_shared<MappedFile>(path);
+    weak_file = file;
+    return file;
+}
+
+MappedFile::MappedFile(std::string const& path)
+: m_file(path, util::File::mode_Read)
+, m_size(size_t(m_file.get_size()))
+, m_map(m_file, util::File::access_ReadOnly, m_size)
+{
+}
+
+MappedFile::~MappedFile() = default;
@@ -0,0 +1,56 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef REALM_MAPPED_FILE_HPP
+#define REALM_MAPPED_FILE_HPP
+
+#include <realm/binary_data.hpp>
+#include <realm/util/file.hpp>
+
+#include <memory>
+#include <string>
+
+namespace realm {
+namespace _impl {
+// A read-only mapping of an entire unencrypted Realm file which is shared by
+// every immutable Realm for the file in the process. Nothing is read up front:
+// the OS pages the file in as the mapped memory is accessed, and those pages
+// are shared by every Group reading from the mapping.
+class MappedFile {
+public:
+    // Get the mapping of the file at the path, mapping the file if no
+    // existing mapping of it is still in use. Throws the util::File
+    // exceptions if the file can't be opened.
+    static std::shared_ptr<MappedFile> get(std::string const& path);
+
+    MappedFile(std::string const& path);
+    ~MappedFile();
+
+    // The contents of the file, for passing to Group's buffer constructor
+    // without it taking ownership
+    BinaryData data() const noexcept { return {m_map.get_addr(), m_size}; }
+
+private:
+    util::File m_file;
+    size_t m_size;
+    util::File::Map<char> m_map;
+};
+} // namespace _impl
+} // namespace realm
+
+#endif /* REALM_MAPPED_FILE_HPP */
@@ -0,0 +1,334 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+
+#include "materialized_aggregate.hpp"
+
+#include "results.hpp"
+#include "shared_realm.hpp"
+#include "transact_log_handler.hpp"
+
+#include <realm/table.hpp>
+
+#include <algorithm>
+
+using namespace realm;
+using namespace realm::_impl;
+
+MaterializedAggregate::MaterializedAggregate(Table& table, Query query, size_t column, AggregateView::Operation op)
+: m_table(table.get_table_ref())
+, m_query(std::move(query))
+, m_column(op == AggregateView::Operation::Count ? npos : column)
+, m_op(op)
+{
+    if (m_column != npos) {
+        m_type = table.get_column_type(m_column);
+        m_nullable = table.is_nullable(m_column);
+    }
+    for (size_t col = 0, count = table.get_column_count(); col < count; ++col) {
+        auto type = table.get_column_type(col);
+        if (type == type_Link || type == type_LinkList) {
+            m_has_links = true;
+            break;
+        }
+    }
+}
+
+void MaterializedAggregate::update(Realm& realm)
+{
+    if (!m_table->is_attached()) {
+        throw Results::InvalidatedException();
+    }
+
+    auto count = m_count;
+    auto value_count = m_value_count;
+    auto int_sum = m_int_sum;
+    auto double_sum = m_double_sum;
+
+    if (realm.is_in_transaction()) {
+        // The changes made by the write transaction aren't known, so the next
+        // read after it ends has to start over as well
+        rebuild();
+        m_built = false;
+    }
+    else {
+        auto version = realm.current_transaction_version();
+        bool same_writes = realm.write_transaction_count() == m_write_count;
+        if (m_built && same_writes && version == m_version) {
+            return;
+        }
+
+        TransactionChangeInfo info;
+        if (!m_built || !same_writes || !realm.get_changes_since(m_version, info) || !apply(info)) {
+            rebuild();
+        }
+        m_version = version;
+        m_write_count = realm.write_transaction_count();
+    }
+
+    bool changed = false;
+    switch (m_op) {
+        case AggregateView::Operation::Count:
+            changed = count != m_count;
+            break;
+        case AggregateView::Operation::Sum:
+            changed = int_sum != m_int_sum || double_sum != m_double_sum;
+            break;
+        case AggregateView::Operation::Average:
+            changed = value_count != m_value_count || int_sum != m_int_sum || double_sum != m_double_sum;
+            break;
+    }
+    if (changed) {
+        ++m_generation;
+    }
+}
+
+util::Optional<Mixed> MaterializedAggregate::value() const
+{
+    switch (m_op) {
+        case AggregateView::Operation::Count:
+            return util::Optional<Mixed>(int64_t(m_count));
+        case AggregateView::Operation::Sum:
+            if (m_type == type_Int)
+                return util::Optional<Mixed>(m_int_sum);
+            return util::Optional<Mixed>(m_double_sum);
+        case AggregateView::Operation::Average:
+            if (m_value_count == 0)
+                return none;
+            if (m_type == type_Int)
+                return util::Optional<Mixed>(double(m_int_sum) / m_value_count);
+            return util::Optional<Mixed>(m_double_sum / m_value_count);
+    }
+    REALM_UNREACHABLE();
+}
+
+void MaterializedAggregate::rebuild()
+{
+    size_t size = m_table->size();
+    m_row_states.clear();
+    m_int_values.clear();
+    m_double_values.clear();
+    resize(size);
+    m_count = 0;
+    m_value_count = 0;
+    m_int_sum = 0;
+    m_double_sum = 0;
+
+    auto tv = m_query.find_all();
+    for (size_t i = 0, count = tv.size(); i < count; ++i) {
+        add_matching_row(tv.get_source_ndx(i));
+    }
+    m_built = true;
+}
+
+bool MaterializedAggregate::apply(TransactionChangeInfo const& info)
+{
+    if (info.schema_changed) {
+        return false;
+    }
+    size_t table_ndx = m_table->get_index_in_group();
+    // Changes to the tables the query follows links to can change which rows
+    // match without modifying them
+    if (m_has_links) {
+        for (size_t i = 0; i < info.tables.size(); ++i) {
+            if (i != table_ndx && !info.tables[i].empty()) {
+                return false;
+            }
+        }
+    }
+    if (table_ndx >= info.tables.size()) {
+        return true;
+    }
+
+    auto& changes = info.tables[table_ndx];
+    if (changes.row_indexes_lost) {
+        return false;
+    }
+    for (auto const& change : changes.row_index_changes) {
+        using Kind = TransactionChangeInfo::TableChanges::RowIndexChange::Kind;
+        size_t tracked = m_row_states.size();
+        switch (change.kind) {
+            case Kind::Insert:
+                // Would shift every later row's entries, so not worth handling
+                return false;
+            case Kind::Erase:
+                if (change.row + change.other_or_count > tracked)
+                    return false;
+                erase_rows(change.row, change.row + change.other_or_count);
+                break;
+            case Kind::MoveLastOver:
+                // Rows appended by the same transaction aren't tracked yet
+                if (change.row >= tracked || change.other_or_count != tracked - 1)
+                    return false;
+                remove_row(change.row);
+                move_row(change.other_or_count, change.row);
+                resize(tracked - 1);
+                break;
+            case Kind::Swap:
+                if (change.row >= tracked || change.other_or_count >= tracked)
+                    return false;
+                swap_rows(change.row, change.other_or_count);
+                break;
+            case Kind::Clear:
+                erase_rows(0, tracked);
+                break;
+        }
+    }
+
+    // The modified rows may have started or stopped matching, while rows
+    // appended to the end of the table are new
+    size_t old_size = m_row_states.size();
+    size_t size = m_table->size();
+    if (old_size > size) {
+        return false;
+    }
+    for (auto const& range : changes.modifications) {
+        for (size_t row = range.first; row < std::min(range.second, old_size); ++row) {
+            remove_row(row);
+            add_row(row);
+        }
+    }
+    resize(size);
+    for (size_t row = old_size; row < size; ++row) {
+        add_row(row);
+    }
+    return true;
+}
+
+void MaterializedAggregate::add_row(size_t row)
+{
+    if (m_query.count(row, row + 1, 1)) {
+        add_matching_row(row);
+    }
+}
+
+void MaterializedAggregate::add_matching_row(size_t row)
+{
+    ++m_count;
+    if (m_column == npos) {
+        m_row_states[row] = Matching;
+        return;
+    }
+    if (m_nullable && m_table->is_null(m_column, row)) {
+        m_row_states[row] = MatchingNull;
+        return;
+    }
+
+    m_row_states[row] = Matching;
+    ++m_value_count;
+    switch (m_type) {
+        case type_Int:
+            m_int_values[row] = m_table->get_int(m_column, row);
+            m_int_sum += m_int_values[row];
+            break;
+        case type_Float:
+            m_double_values[row] = m_table->get_float(m_column, row);
+            m_double_sum += m_double_values[row];
+            break;
+        case type_Double:
+            m_double_values[row] = m_table->get_double(m_column, row);
+            m_double_sum += m_double_values[row];
+            break;
+        default:
+            REALM_UNREACHABLE();
+    }
+}
+
+void MaterializedAggregate::remove_row(size_t row)
+{
+    switch (m_row_states[row]) {
+        case NotMatching:
+            return;
+        case MatchingNull:
+            break;
+        case Matching:
+            if (m_column != npos) {
+                --m_value_count;
+                if (m_type == type_Int)
+                    m_int_sum -= m_int_values[row];
+                else
+                    m_double_sum -= m_double_values[row];
+            }
+            break;
+    }
+    --m_count;
+    m_row_states[row] = NotMatching;
+}
+
+void MaterializedAggregate::resize(size_t size)
+{
+    m_row_states.resize(size, NotMatching);
+    if (m_column == npos)
+        return;
+    if (m_type == type_Int)
+        m_int_values.resize(size);
+    else
+        m_double_values.resize(size);
+}
+
+void MaterializedAggregate::move_row(size_t from, size_t to)
+{
+    m_row_states[to] = m_row_states[from];
+    if (!m_int_values.empty())
+        m_int_values[to] = m_int_values[from];
+    if (!m_double_values.empty())
+        m_double_values[to] = m_double_values[from];
+}
+
+void MaterializedAggregate::swap_rows(size_t a, size_t b)
+{
+    std::swap(m_row_states[a], m_row_states[b]);
+    if (!m_int_values.empty())
+        std::swap(m_int_values[a], m_int_values[b]);
+    if (!m_double_values.empty())
+        std::swap(m_double_values[a], m_double_values[b]);
+}
+
+void MaterializedAggregate::erase_rows(size_t begin, size_t end)
+{
+    for (size_t row = begin; row < end; ++row) {
+        remove_row(row);
+    }
+    m_row_states.erase(m_row_states.begin() + begin, m_row_states.begin() + end);
+    if (!m_int_values.empty())
+        m_int_values.erase(m_int_values.begin() + begin, m_int_values.begin() + end);
+    if (!m_double_values.empty())
+        m_double_values.erase(m_double_values.begin() + begin, m_double_values.begin() + end);
+}
+
+AggregateNotifier::AggregateNotifier(std::shared_ptr<MaterializedAggregate> aggregate,
+                                     AggregateView::NotificationCallback callback)
+: m_aggregate(std::move(aggregate))
+, m_callback(std::move(callback))
+, m_generation(m_aggregate->generation())
+{
+}
+
+void AggregateNotifier::deliver(SharedRealm const& realm)
+{
+    try {
+        m_aggregate->update(*realm);
+    }
+    catch (Results::InvalidatedException const&) {
+        return;
+    }
+    if (m_aggregate->generation() != m_generation) {
+        m_generation = m_aggregate->generation();
+        m_callback(m_aggregate->value());
+    }
+}
@@ -0,0 +1,119 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef REALM_MATERIALIZED_AGGREGATE_HPP
+#define REALM_MATERIALIZED_AGGREGATE_HPP
+
+#include "aggregate_view.hpp"
+
+#include <realm/query.hpp>
+#include <realm/table_ref.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace realm {
+namespace _impl {
+struct TransactionChangeInfo;
+
+// The state behind an AggregateView: the aggregate over the rows matching a
+// query along with each row's contribution to it, indexed by table row
+class MaterializedAggregate {
+public:
+    MaterializedAggregate(Table& table, Query query, size_t column, AggregateView::Operation op);
+
+    // Bring the aggregate up to date with the Realm's read transaction. Within
+    // a write transaction it's recomputed every time, as local changes are not
+    // tracked.
+    // Throws Results::InvalidatedException if the table has been detached
+    void update(Realm& realm);
+
+    util::Optional<Mixed> value() const;
+
+    // Incremented each time update() changes the value
+    uint64_t generation() const noexcept { return m_generation; }
+
+private:
+    TableRef m_table;
+    Query m_query;
+    const size_t m_column;
+    const AggregateView::Operation m_op;
+    DataType m_type = type_Int;
+    bool m_nullable = false;
+    // Does the table have link columns which the query could follow to rows
+    // in other tables?
+    bool m_has_links = false;
+
+    enum RowState : uint8_t {
+        NotMatching,
+        MatchingNull,
+        Matching
+    };
+    std::vector<RowState> m_row_states;
+    // The value of each matching row, in m_int_values for Int columns and
+    // in m_double_values for Float and Double columns
+    std::vector<int64_t> m_int_values;
+    std::vector<double> m_double_values;
+
+    size_t m_count = 0;
+    size_t m_value_count = 0;
+    int64_t m_int_sum = 0;
+    // Values are subtracted from this as they're removed, so it can differ
+    // from a sum computed from scratch by rounding error
+    double m_double_sum = 0;
+
+    bool m_built = false;
+    uint_fast64_t m_version = 0;
+    size_t m_write_count = 0;
+    uint64_t m_generation = 0;
+
+    void rebuild();
+    bool apply(TransactionChangeInfo const& info);
+
+    // Check if the row matches the query and add it to the aggregate if so
+    void add_row(size_t row);
+    // Add a row known to match the query
+    void add_matching_row(size_t row);
+    // Remove the row's contribution to the aggregate
+    void remove_row(size_t row);
+    // Resize the per-row state, with new rows not matching
+    void resize(size_t size);
+    void move_row(size_t from, size_t to);
+    void swap_rows(size_t a, size_t b);
+    void erase_rows(size_t begin, size_t end);
+};
+
+// Calls an AggregateView's notification callback when its value changes
+class AggregateNotifier {
+public:
+    AggregateNotifier(std::shared_ptr<MaterializedAggregate> aggregate, AggregateView::NotificationCallback callback);
+
+    // Update the aggregate and call the callback if its value changed since
+    // the last time this was called
+    void deliver(SharedRealm const& realm);
+
+private:
+    std::shared_ptr<MaterializedAggregate> m_aggregate;
+    AggregateView::NotificationCallback m_callback;
+    uint64_t m_generation;
+};
+} // namespace _impl
+} // namespace realm
+
+#endif /* REALM_MATERIALIZED_AGGREGATE_HPP */
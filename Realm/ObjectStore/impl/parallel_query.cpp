@@ -0,0 +1,83 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "parallel_query.hpp"
+
+#include "dispatch_queue.hpp"
+#include "realm_snapshot.hpp"
+#include "shared_realm.hpp"
+
+#include <realm/group_shared.hpp>
+#include <realm/query.hpp>
+
+#include <algorithm>
+#include <exception>
+#include <thread>
+#include <vector>
+
+using namespace realm;
+using namespace realm::_impl;
+
+// Chunks smaller than this aren't worth the cost of handing the query over
+static const size_t s_min_chunk_size = 16 * 1024;
+
+bool ParallelQuery::should_parallelize(Realm const& realm, size_t row_count)
+{
+    auto const& config = realm.config();
+    return config.parallel_aggregate_threshold && row_count >= config.parallel_aggregate_threshold
+        && !config.read_only && !realm.is_frozen() && !realm.is_in_transaction()
+        && chunk_count(row_count) > 1;
+}
+
+size_t ParallelQuery::chunk_count(size_t row_count)
+{
+    size_t threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    return std::max<size_t>(std::min(threads, row_count / s_min_chunk_size), 1);
+}
+
+void ParallelQuery::for_each_chunk(Realm& realm, Query const& query, size_t row_count, ChunkFunction const& fn)
+{
+    auto snapshot = realm.current_snapshot();
+
+    // Each import consumes its handover, so every chunk needs its own
+    size_t chunks = chunk_count(row_count);
+    std::vector<std::unique_ptr<SharedGroup::Handover<Query>>> handovers;
+    handovers.reserve(chunks);
+    for (size_t i = 0; i < chunks; ++i) {
+        handovers.push_back(realm.m_shared_group->export_for_handover(query, ConstSourcePayload::Copy));
+    }
+
+    std::vector<std::exception_ptr> errors(chunks);
+    DispatchQueue::apply(chunks, [&](size_t i) {
+        try {
+            snapshot->read([&](SharedRealm const& reader) {
+                auto chunk_query = reader->m_shared_group->import_from_handover(std::move(handovers[i]));
+                fn(i, *chunk_query, row_count * i / chunks, row_count * (i + 1) / chunks);
+            });
+        }
+        catch (...) {
+            errors[i] = std::current_exception();
+        }
+    });
+
+    for (auto& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
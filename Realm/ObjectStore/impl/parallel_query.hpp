@@ -0,0 +1,52 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef REALM_PARALLEL_QUERY_HPP
+#define REALM_PARALLEL_QUERY_HPP
+
+#include <cstddef>
+#include <functional>
+
+namespace realm {
+class Query;
+class Realm;
+
+namespace _impl {
+// Evaluates a query over chunks of its table's rows concurrently. Each chunk
+// gets its own copy of the query bound to a frozen Realm at the source
+// Realm's current version, as accessors can't be shared between threads.
+class ParallelQuery {
+public:
+    // Should a query which reads row_count rows be split into chunks? True
+    // only if the Realm's config enables it and a snapshot can be taken.
+    static bool should_parallelize(Realm const& realm, size_t row_count);
+
+    // The number of chunks the rows will be split into
+    static size_t chunk_count(size_t row_count);
+
+    // Call fn with a chunk index, the query and the [begin, end) range of
+    // rows for each chunk, concurrently and on arbitrary threads, returning
+    // once all have completed. The first exception thrown by fn is rethrown.
+    // Must be called on the Realm's thread outside of a write transaction.
+    using ChunkFunction = std::function<void (size_t chunk, Query& query, size_t begin, size_t end)>;
+    static void for_each_chunk(Realm& realm, Query const& query, size_t row_count, ChunkFunction const& fn);
+};
+} // namespace _impl
+} // namespace realm
+
+#endif /* REALM_PARALLEL_QUERY_HPP */
@@ -0,0 +1,101 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "prefetcher.hpp"
+
+#include "dispatch_queue.hpp"
+#include "object_store.hpp"
+#include "shared_realm.hpp"
+
+#include <realm/query.hpp>
+#include <realm/table.hpp>
+
+#include <memory>
+
+using namespace realm;
+using namespace realm::_impl;
+
+Prefetcher::Prefetcher(Realm const& realm, std::vector<std::string> object_types)
+{
+    Realm::Config config = realm.config();
+    config.cache = false;
+    config.dispatch_queue = {};
+    config.schema = nullptr;
+
+    m_thread = std::thread([this, config = std::move(config), object_types = std::move(object_types)]() mutable {
+        set_current_thread_name("RLMRealm prefetcher");
+        try {
+            run(std::move(config), object_types);
+        }
+        catch (...) {
+            // Prefetching is only an optimization, so failing to read the
+            // file here just leaves the first queries to do it
+        }
+    });
+}
+
+Prefetcher::~Prefetcher()
+{
+    m_cancelled = true;
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+void Prefetcher::run(Realm::Config config, std::vector<std::string> const& object_types)
+{
+    std::unique_ptr<Realm> reader(new Realm(std::move(config)));
+    Group* group = reader->read_group();
+    for (auto const& object_type : object_types) {
+        TableRef table = ObjectStore::table_for_object_type(group, object_type);
+        if (!table) {
+            continue;
+        }
+
+        for (size_t col = 0, count = table->get_column_count(); col < count; ++col) {
+            if (m_cancelled) {
+                return;
+            }
+
+            // Each of these visits every leaf of the column without using
+            // any search index it may have
+            switch (table->get_column_type(col)) {
+                case type_Int:
+                    table->sum_int(col);
+                    break;
+                case type_Float:
+                    table->sum_float(col);
+                    break;
+                case type_Double:
+                    table->sum_double(col);
+                    break;
+                case type_DateTime:
+                    table->maximum_datetime(col);
+                    break;
+                case type_Bool:
+                    table->where().equal(col, true).count();
+                    break;
+                case type_String:
+                    table->where().not_equal(col, StringData("")).count();
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+}
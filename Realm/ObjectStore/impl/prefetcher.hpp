@@ -0,0 +1,54 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef REALM_PREFETCHER_HPP
+#define REALM_PREFETCHER_HPP
+
+#include "shared_realm.hpp"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace realm {
+namespace _impl {
+// Reads the columns of the given object types on a background thread so that
+// the parts of the file holding them are in the OS's page cache before the
+// first queries on them are run, rather than each query blocking on page
+// faults. Core owns the file's mapping, so rather than advising the kernel
+// about address ranges this opens a separate reader and scans each column,
+// which faults in the same file pages. Binary columns and links are skipped.
+class Prefetcher {
+public:
+    // The config is copied, so the Realm need not outlive the prefetcher
+    Prefetcher(Realm const& realm, std::vector<std::string> object_types);
+    // Stops after the column currently being read
+    ~Prefetcher();
+
+private:
+    std::atomic<bool> m_cancelled{false};
+    std::thread m_thread;
+
+    void run(Realm::Config config, std::vector<std::string> const& object_types);
+};
+
+} // namespace _impl
+} // namespace realm
+
+#endif /* REALM_PREFETCHER_HPP */
@@ -0,0 +1,106 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "primary_key_cache.hpp"
+
+#include "transact_log_handler.hpp"
+
+#include <realm/table.hpp>
+
+using namespace realm;
+using namespace realm::_impl;
+
+PrimaryKeyCache::TableCache& PrimaryKeyCache::cache_for(Table& table, size_t column)
+{
+    size_t ndx = table.get_index_in_group();
+    if (ndx >= m_tables.size()) {
+        m_tables.resize(ndx + 1);
+    }
+
+    auto& cache = m_tables[ndx];
+    if (cache.table != &table || cache.column != column) {
+        cache = {};
+        cache.table = &table;
+        cache.column = column;
+    }
+    return cache;
+}
+
+template<typename Map, typename Key, typename Matches, typename Find>
+size_t PrimaryKeyCache::find(Map& map, Key&& key, size_t size, Matches&& matches, Find&& find_first)
+{
+    auto it = map.find(key);
+    if (it != map.end() && it->second < size && matches(it->second)) {
+        return it->second;
+    }
+
+    size_t row = find_first();
+    if (row == not_found) {
+        // Negative results can't be verified, so they aren't cached
+        if (it != map.end()) {
+            map.erase(it);
+        }
+        return row;
+    }
+
+    if (it != map.end()) {
+        it->second = row;
+    }
+    else {
+        if (map.size() >= max_entries_per_table) {
+            map.clear();
+        }
+        map.emplace(std::forward<Key>(key), row);
+    }
+    return row;
+}
+
+size_t PrimaryKeyCache::find(Table& table, size_t column, StringData key)
+{
+    return find(cache_for(table, column).string_rows, std::string(key.data(), key.size()), table.size(),
+                [&](size_t row) { return table.get_string(column, row) == key; },
+                [&] { return table.find_first_string(column, key); });
+}
+
+size_t PrimaryKeyCache::find(Table& table, size_t column, int64_t key)
+{
+    bool nullable = table.is_nullable(column);
+    return find(cache_for(table, column).int_rows, key, table.size(),
+                [&](size_t row) { return (!nullable || !table.is_null(column, row)) && table.get_int(column, row) == key; },
+                [&] { return table.find_first_int(column, key); });
+}
+
+void PrimaryKeyCache::apply(TransactionChangeInfo const& info)
+{
+    // Table indexes may have shifted
+    if (info.schema_changed) {
+        clear();
+        return;
+    }
+
+    for (size_t i = 0; i < m_tables.size() && i < info.tables.size(); ++i) {
+        if (info.tables[i].rows_moved) {
+            m_tables[i] = {};
+        }
+    }
+}
+
+void PrimaryKeyCache::clear()
+{
+    m_tables.clear();
+}
@@ -0,0 +1,78 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef REALM_PRIMARY_KEY_CACHE_HPP
+#define REALM_PRIMARY_KEY_CACHE_HPP
+
+#include <realm/string_data.hpp>
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace realm {
+class Table;
+
+namespace _impl {
+struct TransactionChangeInfo;
+
+// A cache of the rows found for primary key values, for making repeated
+// lookups of the same keys without searching the table's index.
+//
+// A cached row is only returned after checking that it still has the key
+// being looked up, so stale entries can never produce the wrong row. The
+// entries for a table are discarded when rows in it have been moved, as they
+// would otherwise all miss.
+class PrimaryKeyCache {
+public:
+    // Find the row in the table with the given non-null value in the primary
+    // key column, or not_found if there isn't one
+    size_t find(Table& table, size_t column, StringData key);
+    size_t find(Table& table, size_t column, int64_t key);
+
+    // Discard the entries which the given changes may have invalidated
+    void apply(TransactionChangeInfo const& info);
+    void clear();
+
+private:
+    // Tables are expected to be looked up by only a few thousand hot keys, so
+    // rather than tracking usage the cache for a table is just reset if it
+    // grows past this
+    static const size_t max_entries_per_table = 10000;
+
+    struct TableCache {
+        // The table and column the cached rows were found in, as table indexes
+        // can shift from local changes which are not in the change info
+        Table* table = nullptr;
+        size_t column = 0;
+        std::unordered_map<std::string, size_t> string_rows;
+        std::unordered_map<int64_t, size_t> int_rows;
+    };
+    // Indexed by the table's index in the group
+    std::vector<TableCache> m_tables;
+
+    TableCache& cache_for(Table& table, size_t column);
+
+    template<typename Map, typename Key, typename Matches, typename Find>
+    size_t find(Map& map, Key&& key, size_t size, Matches&& matches, Find&& find_first);
+};
+} // namespace _impl
+} // namespace realm
+
+#endif /* REALM_PRIMARY_KEY_CACHE_HPP */
@@ -0,0 +1,183 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "results_notifier.hpp"
+
+#include <algorithm>
+#include <unordered_map>
+
+using namespace realm;
+using namespace realm::_impl;
+
+ResultsNotifier::ResultsNotifier(Results const& results, Results::NotificationCallback callback)
+: m_results(results)
+, m_callback(std::move(callback))
+, m_version(results.m_realm->current_transaction_version())
+, m_table_ndx(results.m_table ? results.m_table->get_index_in_group() : npos)
+{
+    m_rows = evaluate();
+    m_results.m_realm = nullptr;
+}
+
+std::vector<size_t> ResultsNotifier::evaluate()
+{
+    std::vector<size_t> rows;
+    switch (m_results.get_mode()) {
+        case Results::Mode::Empty:
+            break;
+        case Results::Mode::Table:
+            rows.reserve(m_results.m_table->size());
+            for (size_t i = 0, size = m_results.m_table->size(); i < size; ++i) {
+                rows.push_back(i);
+            }
+            break;
+        case Results::Mode::Query:
+        case Results::Mode::TableView: {
+            auto tv = m_results.get_tableview();
+            rows.reserve(tv.size());
+            for (size_t i = 0, size = tv.size(); i < size; ++i) {
+                rows.push_back(tv.get_source_ndx(i));
+            }
+            break;
+        }
+    }
+    return rows;
+}
+
+void ResultsNotifier::deliver(SharedRealm const& realm)
+{
+    auto version = realm->current_transaction_version();
+    if (version == m_version) {
+        return;
+    }
+
+    CollectionChangeSet changes;
+    std::exception_ptr error;
+    m_results.m_realm = realm;
+    try {
+        TransactionChangeInfo info;
+        TransactionChangeInfo::TableChanges unchanged;
+        TransactionChangeInfo::TableChanges const* table_changes = nullptr;
+        // Inserting tables shifts the table indexes the changes are keyed by
+        if (realm->get_changes_since(m_version, info) && !info.schema_changed) {
+            table_changes = m_table_ndx < info.tables.size() ? &info.tables[m_table_ndx] : &unchanged;
+        }
+
+        auto rows = evaluate();
+        changes = calculate(m_rows, rows, table_changes, m_results.get_projection());
+        m_rows = std::move(rows);
+    }
+    catch (...) {
+        error = std::current_exception();
+        m_rows.clear();
+    }
+    m_results.m_realm = nullptr;
+    m_version = version;
+
+    if (error || !changes.empty()) {
+        m_callback(changes, error);
+    }
+}
+
+// The indexes into `values` of a longest strictly increasing subsequence
+static std::vector<size_t> longest_increasing_subsequence(std::vector<size_t> const& values)
+{
+    // tails[k] is the index of the smallest value which ends an increasing
+    // subsequence of length k + 1
+    std::vector<size_t> tails;
+    std::vector<size_t> prev(values.size(), npos);
+    for (size_t i = 0; i < values.size(); ++i) {
+        auto it = std::lower_bound(tails.begin(), tails.end(), values[i],
+                                   [&](size_t ndx, size_t value) { return values[ndx] < value; });
+        if (it != tails.begin()) {
+            prev[i] = *(it - 1);
+        }
+        if (it == tails.end()) {
+            tails.push_back(i);
+        }
+        else {
+            *it = i;
+        }
+    }
+
+    std::vector<size_t> ret(tails.size());
+    for (size_t i = tails.size(), ndx = tails.empty() ? npos : tails.back(); i > 0; --i) {
+        ret[i - 1] = ndx;
+        ndx = prev[ndx];
+    }
+    return ret;
+}
+
+CollectionChangeSet ResultsNotifier::calculate(std::vector<size_t> const& old_rows,
+                                               std::vector<size_t> const& new_rows,
+                                               TransactionChangeInfo::TableChanges const* changes,
+                                               std::vector<size_t> const& columns)
+{
+    CollectionChangeSet ret;
+    if (!changes || changes->row_indexes_lost) {
+        if (!old_rows.empty()) {
+            ret.deletions.set(old_rows.size());
+        }
+        if (!new_rows.empty()) {
+            ret.insertions.set(new_rows.size());
+        }
+        return ret;
+    }
+
+    std::unordered_map<size_t, size_t> new_index_of_row;
+    new_index_of_row.reserve(new_rows.size());
+    for (size_t i = 0; i < new_rows.size(); ++i) {
+        new_index_of_row[new_rows[i]] = i;
+    }
+
+    // The old and new indexes of each row which is still in the Results
+    std::vector<size_t> matched_old, matched_new;
+    for (size_t i = 0; i < old_rows.size(); ++i) {
+        size_t row = changes->rows_moved ? changes->new_row_index(old_rows[i]) : old_rows[i];
+        auto it = row == npos ? new_index_of_row.end() : new_index_of_row.find(row);
+        if (it == new_index_of_row.end()) {
+            ret.deletions.add(i);
+        }
+        else {
+            matched_old.push_back(i);
+            matched_new.push_back(it->second);
+        }
+    }
+
+    // Keep as many rows in place as possible, and report the rest as having
+    // been removed from their old position and inserted at the new one
+    std::vector<bool> kept(new_rows.size());
+    for (size_t i : longest_increasing_subsequence(matched_new)) {
+        kept[matched_new[i]] = true;
+    }
+    for (size_t i = 0; i < matched_old.size(); ++i) {
+        if (!kept[matched_new[i]]) {
+            ret.deletions.add(matched_old[i]);
+        }
+    }
+    for (size_t i = 0; i < new_rows.size(); ++i) {
+        if (!kept[i]) {
+            ret.insertions.add(i);
+        }
+        else if (columns.empty() ? changes->modifications.contains(new_rows[i])
+                                 : changes->row_modified(new_rows[i], columns)) {
+            ret.modifications.add(i);
+        }
+    }
+    return ret;
+}
@@ -0,0 +1,67 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef REALM_RESULTS_NOTIFIER_HPP
+#define REALM_RESULTS_NOTIFIER_HPP
+
+#include "results.hpp"
+#include "transact_log_handler.hpp"
+
+#include <vector>
+
+namespace realm {
+namespace _impl {
+// Reports how the rows in a Results changed each time the Realm it belongs to
+// advances to a new version. The rows are re-evaluated on the Realm's thread
+// after the advance, and compared against the previous rows using the row
+// index changes recorded from the transaction log, so that rows which stayed
+// in the Results are matched up even if their table indexes changed.
+class ResultsNotifier {
+public:
+    ResultsNotifier(Results const& results, Results::NotificationCallback callback);
+
+    // Re-evaluate the Results and call the callback if anything changed since
+    // the last time this was called
+    void deliver(SharedRealm const& realm);
+
+    // Compute the changes from old_rows to new_rows, which are the table row
+    // indexes before and after the given changes to the table. If `changes` is
+    // null, which rows moved isn't known and every row is reported as replaced.
+    // If `columns` is non-empty, only changes to those columns are reported as
+    // modifications.
+    static CollectionChangeSet calculate(std::vector<size_t> const& old_rows,
+                                         std::vector<size_t> const& new_rows,
+                                         TransactionChangeInfo::TableChanges const* changes,
+                                         std::vector<size_t> const& columns = {});
+
+private:
+    // The Realm is cleared while the Results isn't being evaluated, as the
+    // Realm owns the notifier
+    Results m_results;
+    Results::NotificationCallback m_callback;
+    // The table row indexes which were in the Results as of m_version
+    std::vector<size_t> m_rows;
+    uint_fast64_t m_version;
+    size_t m_table_ndx;
+
+    std::vector<size_t> evaluate();
+};
+} // namespace _impl
+} // namespace realm
+
+#endif // REALM_RESULTS_NOTIFIER_HPP
@@ -0,0 +1,179 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef REALM_SHARDED_CACHE_HPP
+#define REALM_SHARDED_CACHE_HPP
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace realm {
+namespace _impl {
+// A cache of weakly-held per-thread values (Realm instances) keyed on path
+// and thread. Entries are split into shards by thread, each with its own lock,
+// so that threads looking up their own Realm never contend with each other,
+// even when they are all opening the same file. Each shard is a small vector
+// as a thread rarely has more than a few Realms open at once.
+//
+// IsAlive is a functor which reports if a cached weak value still refers to a
+// live object; entries for dead values are pruned as new entries are added.
+template<typename ThreadKey, typename Value, typename IsAlive>
+class ShardedCache {
+public:
+    // Copy the value cached for the given path and thread to `out`, returning
+    // false if there is none
+    bool get(std::string const& path, ThreadKey const& thread, Value& out)
+    {
+        auto& shard = shard_for(thread);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (auto const& entry : shard.entries) {
+            if (entry.thread == thread && entry.path == path) {
+                out = entry.value;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Copy any live value cached for the given path on any thread to `out`.
+    // This has to look at every shard, so it should only be used when the
+    // current thread does not already have a value.
+    bool get_any(std::string const& path, Value& out)
+    {
+        for (auto& shard : m_shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            for (auto const& entry : shard.entries) {
+                if (entry.path == path && IsAlive()(entry.value)) {
+                    out = entry.value;
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    // Cache a value, replacing any existing one for the same path and thread
+    void insert(std::string const& path, ThreadKey const& thread, Value value)
+    {
+        auto& shard = shard_for(thread);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        prune(shard);
+        for (auto& entry : shard.entries) {
+            if (entry.thread == thread && entry.path == path) {
+                entry.value = std::move(value);
+                return;
+            }
+        }
+        shard.entries.push_back({path, thread, std::move(value)});
+    }
+
+    void remove(std::string const& path, ThreadKey const& thread)
+    {
+        auto& shard = shard_for(thread);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (auto it = shard.entries.begin(); it != shard.entries.end(); ++it) {
+            if (it->thread == thread && it->path == path) {
+                shard.entries.erase(it);
+                return;
+            }
+        }
+    }
+
+    // Get copies of all of the values cached for the given thread
+    std::vector<Value> values_for_thread(ThreadKey const& thread)
+    {
+        std::vector<Value> values;
+        auto& shard = shard_for(thread);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (auto const& entry : shard.entries) {
+            if (entry.thread == thread) {
+                values.push_back(entry.value);
+            }
+        }
+        return values;
+    }
+
+    // Get copies of all of the values cached for every path and thread
+    std::vector<Value> values()
+    {
+        std::vector<Value> values;
+        for (auto& shard : m_shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            for (auto const& entry : shard.entries) {
+                values.push_back(entry.value);
+            }
+        }
+        return values;
+    }
+
+    // Remove all entries, returning the values which were cached so that the
+    // caller can clean them up without holding any of the cache's locks
+    std::vector<Value> clear()
+    {
+        std::vector<Value> values;
+        for (auto& shard : m_shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            for (auto& entry : shard.entries) {
+                values.push_back(std::move(entry.value));
+            }
+            shard.entries.clear();
+        }
+        return values;
+    }
+
+private:
+    static constexpr size_t shard_count = 16;
+
+    struct Entry {
+        std::string path;
+        ThreadKey thread;
+        Value value;
+    };
+
+    // Padded to a cache line so that threads using neighbouring shards don't
+    // contend on the mutexes
+    struct alignas(64) Shard {
+        std::mutex mutex;
+        std::vector<Entry> entries;
+    };
+
+    std::array<Shard, shard_count> m_shards;
+
+    Shard& shard_for(ThreadKey const& thread)
+    {
+        return m_shards[std::hash<ThreadKey>()(thread) % shard_count];
+    }
+
+    static void prune(Shard& shard)
+    {
+        auto& entries = shard.entries;
+        entries.erase(std::remove_if(entries.begin(), entries.end(),
+                                     [](Entry const& entry) { return !IsAlive()(entry.value); }),
+                      entries.end());
+    }
+};
+
+} // namespace _impl
+} // namespace realm
+
+#endif /* REALM_SHARDED_CACHE_HPP */
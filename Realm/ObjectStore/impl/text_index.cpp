@@ -0,0 +1,213 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+
+#include "text_index.hpp"
+
+#include "shared_realm.hpp"
+#include "transact_log_handler.hpp"
+
+#include <realm/table.hpp>
+
+#include <algorithm>
+
+using namespace realm;
+using namespace realm::_impl;
+
+namespace {
+// Call `fn` with each word in the string, lowercased
+template<typename Func>
+void for_each_word(StringData value, Func&& fn)
+{
+    std::string word;
+    for (size_t i = 0; i <= value.size(); ++i) {
+        char c = i < value.size() ? value[i] : 0;
+        if (i < value.size() && TextIndex::is_word_char(c)) {
+            word += c >= 'A' && c <= 'Z' ? char(c - 'A' + 'a') : c;
+        }
+        else if (!word.empty()) {
+            fn(word);
+            word.clear();
+        }
+    }
+}
+} // anonymous namespace
+
+TextIndex::TextIndex(Realm& realm, Table& table, size_t column)
+: m_realm(realm)
+, m_table(table.get_table_ref())
+, m_column(column)
+{
+}
+
+bool TextIndex::is_for(Table const& table, size_t column) const noexcept
+{
+    return m_table.get() == &table && m_column == column && m_table->is_attached();
+}
+
+bool TextIndex::update()
+{
+    if (m_realm.is_in_transaction() || !m_table->is_attached()) {
+        return false;
+    }
+
+    auto version = m_realm.current_transaction_version();
+    bool same_writes = m_realm.write_transaction_count() == m_write_count;
+    if (m_built && same_writes && version == m_version) {
+        return true;
+    }
+
+    TransactionChangeInfo info;
+    if (!m_built || !same_writes || !m_realm.get_changes_since(m_version, info) || !apply(info)
+        || m_stale_entries > m_live_entries) {
+        rebuild();
+    }
+    m_version = version;
+    m_write_count = m_realm.write_transaction_count();
+    ++m_generation;
+    return true;
+}
+
+void TextIndex::rebuild()
+{
+    m_words.clear();
+    m_word_ids.clear();
+    m_postings.clear();
+    m_row_words.clear();
+    m_live_entries = 0;
+    m_stale_entries = 0;
+
+    size_t size = m_table->size();
+    m_row_words.resize(size);
+    for (size_t row = 0; row < size; ++row) {
+        index_row(row);
+    }
+    m_built = true;
+}
+
+bool TextIndex::apply(TransactionChangeInfo const& info)
+{
+    if (info.schema_changed) {
+        return false;
+    }
+    size_t table_ndx = m_table->get_index_in_group();
+    if (table_ndx >= info.tables.size()) {
+        return true;
+    }
+
+    auto& changes = info.tables[table_ndx];
+    if (changes.row_indexes_lost) {
+        return false;
+    }
+    for (auto& change : changes.row_index_changes) {
+        using Kind = TransactionChangeInfo::TableChanges::RowIndexChange::Kind;
+        switch (change.kind) {
+            case Kind::MoveLastOver:
+                unindex_row(change.row);
+                if (change.other_or_count != change.row) {
+                    move_row(change.other_or_count, change.row);
+                }
+                m_row_words.pop_back();
+                break;
+            case Kind::Swap:
+                std::swap(m_row_words[change.row], m_row_words[change.other_or_count]);
+                move_row(change.row, change.row);
+                move_row(change.other_or_count, change.other_or_count);
+                break;
+            default:
+                // Rows inserted or erased in the middle of the table shift
+                // every following row, so it's simpler to start over
+                return false;
+        }
+    }
+
+    size_t old_size = m_row_words.size();
+    size_t new_size = m_table->size();
+    if (changes.column_modified(m_column)) {
+        for (auto range : changes.modifications) {
+            for (size_t row = range.first; row < std::min(range.second, old_size); ++row) {
+                unindex_row(row);
+                index_row(row);
+            }
+        }
+    }
+    m_row_words.resize(new_size);
+    for (size_t row = old_size; row < new_size; ++row) {
+        index_row(row);
+    }
+    return true;
+}
+
+void TextIndex::index_row(size_t row)
+{
+    StringData value = m_table->get_string(m_column, row);
+    auto& row_words = m_row_words[row];
+    for_each_word(value, [&](std::string const& word) {
+        auto it = m_word_ids.find(word);
+        if (it == m_word_ids.end()) {
+            it = m_word_ids.emplace(word, uint32_t(m_words.size())).first;
+            m_words.push_back(word);
+            m_postings.emplace_back();
+        }
+        row_words.push_back(it->second);
+    });
+    std::sort(row_words.begin(), row_words.end());
+    row_words.erase(std::unique(row_words.begin(), row_words.end()), row_words.end());
+    for (auto id : row_words) {
+        m_postings[id].push_back(row);
+    }
+    m_live_entries += row_words.size();
+}
+
+void TextIndex::unindex_row(size_t row)
+{
+    // The postings for the row's old words are left to be filtered out
+    // when they're checked against the value
+    auto& row_words = m_row_words[row];
+    m_live_entries -= row_words.size();
+    m_stale_entries += row_words.size();
+    row_words.clear();
+}
+
+void TextIndex::move_row(size_t from, size_t to)
+{
+    // The entries for the old row index become stale and new ones are added
+    // for the new index
+    auto& row_words = m_row_words[to];
+    if (from != to) {
+        row_words = std::move(m_row_words[from]);
+        m_row_words[from].clear();
+    }
+    for (auto id : row_words) {
+        m_postings[id].push_back(to);
+    }
+    m_stale_entries += row_words.size();
+}
+
+void TextIndex::find_candidates(StringData needle, std::vector<size_t>& rows) const
+{
+    rows.clear();
+    for (size_t id = 0; id < m_words.size(); ++id) {
+        if (m_words[id].find(needle.data(), 0, needle.size()) != std::string::npos) {
+            rows.insert(rows.end(), m_postings[id].begin(), m_postings[id].end());
+        }
+    }
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+    rows.erase(std::lower_bound(rows.begin(), rows.end(), m_row_words.size()), rows.end());
+}
@@ -0,0 +1,108 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef REALM_TEXT_INDEX_HPP
+#define REALM_TEXT_INDEX_HPP
+
+#include <realm/string_data.hpp>
+#include <realm/table_ref.hpp>
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace realm {
+class Realm;
+
+namespace _impl {
+struct TransactionChangeInfo;
+
+// An inverted index from the words in a string column to the rows which
+// contain them, for answering CONTAINS queries for a single word without
+// reading the value of every row.
+//
+// A word is a run of ASCII letters and digits and non-ASCII characters, and
+// is stored lowercased. Any value which contains a needle made up only of word
+// characters has the needle within one of its words, so the rows of the words
+// containing the needle are a superset of the matching rows. The rows found
+// still need to be checked against the actual values, which also means that
+// entries for rows which no longer have a word can be left in place.
+//
+// The index is kept in memory by the Realm, and is brought up to date with the
+// read transaction by applying the changes made since it was last updated,
+// or rebuilt if those aren't available.
+class TextIndex {
+public:
+    TextIndex(Realm& realm, Table& table, size_t column);
+
+    bool is_for(Table const& table, size_t column) const noexcept;
+
+    // Bring the index up to date with the Realm's read transaction. Returns
+    // false if that isn't possible, which is the case within a write
+    // transaction as local changes are not tracked.
+    bool update();
+
+    // Replace `rows` with the rows which may contain the given lowercased
+    // needle, in ascending order
+    void find_candidates(StringData needle, std::vector<size_t>& rows) const;
+
+    // Incremented whenever the rows in the index change
+    uint64_t generation() const noexcept { return m_generation; }
+
+    // Is the character part of a word?
+    static bool is_word_char(char c) noexcept
+    {
+        return (c & 0x80) || (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+    }
+
+private:
+    Realm& m_realm;
+    TableRef m_table;
+    const size_t m_column;
+
+    // The vocabulary, with each word's id being its index in m_words
+    std::vector<std::string> m_words;
+    std::unordered_map<std::string, uint32_t> m_word_ids;
+    // The rows containing each word, by word id. Unsorted, and may have
+    // duplicates and rows which no longer contain the word.
+    std::vector<std::vector<size_t>> m_postings;
+    // The ids of the words in each row
+    std::vector<std::vector<uint32_t>> m_row_words;
+
+    // The number of entries in m_postings which are still correct, and which
+    // are out of date. The index is rebuilt once most of it is out of date.
+    size_t m_live_entries = 0;
+    size_t m_stale_entries = 0;
+
+    bool m_built = false;
+    uint_fast64_t m_version = 0;
+    size_t m_write_count = 0;
+    uint64_t m_generation = 0;
+
+    void rebuild();
+    bool apply(TransactionChangeInfo const& info);
+    void index_row(size_t row);
+    void unindex_row(size_t row);
+    void move_row(size_t from, size_t to);
+};
+} // namespace _impl
+} // namespace realm
+
+#endif /* REALM_TEXT_INDEX_HPP */
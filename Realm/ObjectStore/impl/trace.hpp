@@ -0,0 +1,97 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef REALM_TRACE_HPP
+#define REALM_TRACE_HPP
+
+// Probe points marking the start and end of transactions, refreshes,
+// notifications and query evaluation, so that they can be lined up with other
+// activity in Instruments or a system trace.
+//
+// They are only compiled in when REALM_ENABLE_TRACING is defined to 1, and
+// otherwise expand to nothing without evaluating their arguments. On Apple
+// platforms they are kdebug signposts, which appear as "Points of Interest" in
+// Instruments with the code from trace::Code and the arguments in order; the
+// path is passed as a hash, as signposts can only carry integers. Elsewhere
+// they are SystemTap/DTrace USDT probes in the `realm` provider named
+// `<name>_begin`, `<name>_end` and `<name>`, which carry the path as a string.
+//
+// Each takes the Realm file's path as a C string (or null if it isn't known),
+// the transaction version and a count of the rows or events involved.
+
+#if REALM_ENABLE_TRACING
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+
+namespace realm {
+namespace _impl {
+namespace trace {
+enum class Code : uint32_t {
+    BeginTransaction = 0x5241,
+    CommitTransaction,
+    Refresh,
+    Notify,
+    Advance,
+    UpdateTableView,
+    ExternalCommit,
+};
+
+inline uintptr_t path_id(const char* path)
+{
+    return path ? std::hash<std::string>()(std::string(path, std::strlen(path))) : 0;
+}
+} // namespace trace
+} // namespace _impl
+} // namespace realm
+
+#ifdef __APPLE__
+#include <sys/kdebug_signpost.h>
+
+#define REALM_TRACE_BEGIN(name, path, version, count) \
+    kdebug_signpost_start(uint32_t(::realm::_impl::trace::Code::name), ::realm::_impl::trace::path_id(path), \
+                          uintptr_t(version), uintptr_t(count), 0)
+#define REALM_TRACE_END(name, path, version, count) \
+    kdebug_signpost_end(uint32_t(::realm::_impl::trace::Code::name), ::realm::_impl::trace::path_id(path), \
+                        uintptr_t(version), uintptr_t(count), 0)
+#define REALM_TRACE_POINT(name, path, version, count) \
+    kdebug_signpost(uint32_t(::realm::_impl::trace::Code::name), ::realm::_impl::trace::path_id(path), \
+                    uintptr_t(version), uintptr_t(count), 0)
+
+#else
+#include <sys/sdt.h>
+
+#define REALM_TRACE_BEGIN(name, path, version, count) \
+    DTRACE_PROBE3(realm, name##_begin, (const char*)(path), uint64_t(version), uint64_t(count))
+#define REALM_TRACE_END(name, path, version, count) \
+    DTRACE_PROBE3(realm, name##_end, (const char*)(path), uint64_t(version), uint64_t(count))
+#define REALM_TRACE_POINT(name, path, version, count) \
+    DTRACE_PROBE3(realm, name, (const char*)(path), uint64_t(version), uint64_t(count))
+#endif
+
+#else // REALM_ENABLE_TRACING
+
+#define REALM_TRACE_BEGIN(name, path, version, count) ((void)0)
+#define REALM_TRACE_END(name, path, version, count) ((void)0)
+#define REALM_TRACE_POINT(name, path, version, count) ((void)0)
+
+#endif // REALM_ENABLE_TRACING
+
+#endif /* REALM_TRACE_HPP */
@@ -19,14 +19,28 @@
 #include "transact_log_handler.hpp"
 
 #include "binding_context.hpp"
+#include "change_feed.hpp"
+#include "trace.hpp"
 
 #include <realm/commit_log.hpp>
 #include <realm/group_shared.hpp>
+#include <realm/impl/input_stream.hpp>
+#include <realm/impl/transact_log.hpp>
 #include <realm/lang_bind_helper.hpp>
 
+#include <algorithm>
+#include <unordered_map>
+
 using namespace realm;
 
 namespace {
+REALM_NORETURN
+REALM_NOINLINE
+void throw_schema_mismatch()
+{
+    throw std::runtime_error("Schema mismatch detected: another process has modified the Realm file's schema in an incompatible way");
+}
+
 // A transaction log handler that just validates that all operations made are
 // ones supported by the object store
 class TransactLogValidator {
@@ -41,7 +55,7 @@ class TransactLogValidator {
     REALM_NOINLINE
     void schema_error()
     {
-        throw std::runtime_error("Schema mismatch detected: another process has modified the Realm file's schema in an incompatible way");
+        throw_schema_mismatch();
     }
 
     // Throw an exception if the currently modified table already existed before
@@ -142,66 +156,175 @@ public:
 class TransactLogObserver : public TransactLogValidator {
     using ColumnInfo = BindingContext::ColumnInfo;
     using ObserverState = BindingContext::ObserverState;
+    using RowIndexChange = _impl::TransactionChangeInfo::TableChanges::RowIndexChange;
 
     // Observed table rows which need change information
     std::vector<ObserverState> m_observers;
+    // The index in m_observers of the observer for each observed row, indexed
+    // by table and then keyed by row, so that applying each instruction only
+    // has to look at the observers it affects
+    using ObservedRows = std::unordered_map<size_t, size_t>;
+    std::vector<ObservedRows> m_observed_rows;
+    // Invalidated observers are left in m_observers until the log has been
+    // fully parsed, and are then all removed at once
+    bool m_has_invalidated_observers = false;
     // Userdata pointers for rows which have been deleted
     std::vector<void *> invalidated;
     // Delegate to send change information to
     BindingContext* m_context;
+    // Summary of the changes made to each table, if requested
+    _impl::TransactionChangeInfo* m_change_info = nullptr;
 
     // Change information for the currently selected LinkList, if any
     ColumnInfo* m_active_linklist = nullptr;
 
+    // Is the selected table a subtable of current_table()?
+    bool m_in_subtable = false;
+
     // Tables which were created during the transaction being processed, which
     // can have columns inserted without a schema version bump
     std::vector<size_t> m_new_tables;
 
-    // Get the change info for the given column, creating it if needed
-    static ColumnInfo& get_change(ObserverState& state, size_t i)
+    // Get the change summary for the currently selected table, or null if
+    // change information was not requested
+    _impl::TransactionChangeInfo::TableChanges* table_changes()
     {
-        if (state.changes.size() <= i) {
-            state.changes.resize(std::max(state.changes.size() * 2, i + 1));
+        if (!m_change_info) {
+            return nullptr;
         }
-        return state.changes[i];
+        auto& tables = m_change_info->tables;
+        if (tables.size() <= current_table()) {
+            tables.resize(std::max(tables.size() * 2, current_table() + 1));
+        }
+        return &tables[current_table()];
     }
 
-    // Loop over the columns which were changed in an observer state
-    template<typename Func>
-    static void for_each(ObserverState& state, Func&& f)
+    // Record that the given row/col was modified in the per-table summary
+    void record_modification(size_t row_ndx, size_t col_ndx)
     {
-        for (size_t i = 0; i < state.changes.size(); ++i) {
-            auto const& change = state.changes[i];
-            if (change.changed) {
-                f(i, change);
+        if (auto changes = table_changes()) {
+            changes->modifications.add(row_ndx);
+            auto& columns = changes->column_modifications;
+            if (columns.size() <= col_ndx) {
+                columns.resize(col_ndx + 1);
             }
+            columns[col_ndx].add(row_ndx);
+        }
+    }
+
+    // Record that rows in the current table no longer have the same indexes
+    void record_rows_moved()
+    {
+        if (auto changes = table_changes()) {
+            changes->rows_moved = true;
+        }
+    }
+
+    // Record how the indexes of rows in the current table changed. Changes
+    // within subtables don't affect the indexes of the table's own rows.
+    void record_row_index_change(RowIndexChange::Kind kind, size_t row, size_t other_or_count = 0)
+    {
+        record_rows_moved();
+        if (m_in_subtable) {
+            return;
+        }
+        if (auto changes = table_changes()) {
+            changes->add_row_index_change({kind, row, other_or_count});
         }
     }
 
+    // Describe the advance from the given version for did_change()
+    BindingContext::VersionChange version_change(uint_fast64_t old_version, SharedGroup& sg) const
+    {
+        BindingContext::VersionChange change;
+        change.old_version = old_version;
+        change.new_version = sg.get_version_of_current_transaction().version;
+        if (m_change_info && !m_change_info->schema_changed) {
+            change.modified_tables_known = true;
+            for (size_t i = 0; i < m_change_info->tables.size(); ++i) {
+                if (!m_change_info->tables[i].empty()) {
+                    change.modified_tables.push_back(i);
+                }
+            }
+        }
+        return change;
+    }
+
     // Mark the given row/col as needing notifications sent
     bool mark_dirty(size_t row_ndx, size_t col_ndx)
     {
-        auto it = lower_bound(begin(m_observers), end(m_observers), ObserverState{current_table(), row_ndx, nullptr});
-        if (it != end(m_observers) && it->table_ndx == current_table() && it->row_ndx == row_ndx) {
-            get_change(*it, col_ndx).changed = true;
+        record_modification(row_ndx, col_ndx);
+        if (auto o = find_observer(row_ndx)) {
+            o->mark_changed(col_ndx);
         }
         return true;
     }
 
-    // Remove the given observer from the list of observed objects and add it
-    // to the listed of invalidated objects
-    void invalidate(ObserverState *o)
+    void index_observers()
+    {
+        for (size_t i = 0; i < m_observers.size(); ++i) {
+            auto const& o = m_observers[i];
+            if (m_observed_rows.size() <= o.table_ndx) {
+                m_observed_rows.resize(o.table_ndx + 1);
+            }
+            m_observed_rows[o.table_ndx][o.row_ndx] = i;
+        }
+    }
+
+    // Get the observed rows in the current table, or null if there are none
+    ObservedRows* observed_rows()
+    {
+        if (current_table() >= m_observed_rows.size()) {
+            return nullptr;
+        }
+        auto& rows = m_observed_rows[current_table()];
+        return rows.empty() ? nullptr : &rows;
+    }
+
+    ObserverState* find_observer(size_t row_ndx)
+    {
+        if (auto rows = observed_rows()) {
+            auto it = rows->find(row_ndx);
+            if (it != rows->end()) {
+                return &m_observers[it->second];
+            }
+        }
+        return nullptr;
+    }
+
+    // Add the observer at the given index in m_observers to the list of
+    // invalidated objects. The caller must remove it from m_observed_rows.
+    void invalidate(size_t observer_ndx)
+    {
+        auto& o = m_observers[observer_ndx];
+        invalidated.push_back(o.info);
+        o.row_ndx = npos;
+        m_has_invalidated_observers = true;
+    }
+
+    // Remove the invalidated observers from m_observers
+    void remove_invalidated_observers()
     {
-        invalidated.push_back(o->info);
-        m_observers.erase(m_observers.begin() + (o - &m_observers[0]));
+        if (m_has_invalidated_observers) {
+            m_observers.erase(std::remove_if(begin(m_observers), end(m_observers),
+                                             [](auto const& o) { return o.row_ndx == npos; }),
+                              end(m_observers));
+            m_has_invalidated_observers = false;
+            m_observed_rows.clear();
+            index_observers();
+        }
     }
 
 public:
     template<typename Func>
-    TransactLogObserver(BindingContext* context, SharedGroup& sg, Func&& func, bool validate_schema_changes)
+    TransactLogObserver(BindingContext* context, SharedGroup& sg, Func&& func, bool validate_schema_changes,
+                        _impl::TransactionChangeInfo* change_info = nullptr,
+                        std::vector<bool> const* observed_tables = nullptr,
+                        _impl::TransactionChangeInfo const* precomputed_changes = nullptr)
     : m_context(context)
+    , m_change_info(validate_schema_changes ? change_info : nullptr)
     {
-        if (!context) {
+        if (!context && !m_change_info) {
             if (validate_schema_changes) {
                 // The handler functions are non-virtual, so the parent class's
                 // versions are called if we don't need to track changes to observed
@@ -214,30 +337,69 @@ public:
             return;
         }
 
-        m_observers = context->get_observed_rows();
+        if (context) {
+            m_observers = context->get_observed_rows();
+            index_observers();
+        }
         if (m_observers.empty()) {
             auto old_version = sg.get_version_of_current_transaction();
-            if (validate_schema_changes) {
+            if (m_change_info && precomputed_changes) {
+                // The log was already validated and summarized when the
+                // changes were computed, so it only needs to be applied
+                func();
+                *m_change_info = *precomputed_changes;
+            }
+            else if (m_change_info) {
+                m_change_info->initial_version = old_version.version;
+                func(*this);
+                m_change_info->final_version = sg.get_version_of_current_transaction().version;
+            }
+            else if (validate_schema_changes) {
                 func(static_cast<TransactLogValidator&>(*this));
             }
             else {
                 func();
             }
-            if (old_version != sg.get_version_of_current_transaction()) {
-                context->did_change({}, {});
+            // Commits which only touched tables the context isn't interested
+            // in don't need to be reported at all
+            bool interesting = !observed_tables || !m_change_info || m_change_info->modified_any(*observed_tables);
+            if (context && interesting && old_version != sg.get_version_of_current_transaction()) {
+                context->did_change({}, {}, version_change(old_version.version, sg));
             }
             return;
         }
 
+        auto old_version = sg.get_version_of_current_transaction().version;
+        if (m_change_info) {
+            m_change_info->initial_version = old_version;
+        }
         func(*this);
-        context->did_change(m_observers, invalidated);
+        if (m_change_info) {
+            m_change_info->final_version = sg.get_version_of_current_transaction().version;
+        }
+        remove_invalidated_observers();
+        context->did_change(m_observers, invalidated, version_change(old_version, sg));
     }
 
     // Called at the end of the transaction log immediately before the version
     // is advanced
     void parse_complete()
     {
-        m_context->will_change(m_observers, invalidated);
+        remove_invalidated_observers();
+        if (!m_observers.empty()) {
+            m_context->will_change(m_observers, invalidated);
+        }
+    }
+
+    bool select_table(size_t group_level_ndx, int levels, const size_t* path) noexcept
+    {
+        TransactLogValidator::select_table(group_level_ndx, levels, path);
+        m_in_subtable = levels != 0;
+        // Changes to subtables can't be mapped to rows of the parent table
+        if (levels != 0) {
+            record_rows_moved();
+        }
+        return true;
     }
 
     bool insert_group_level_table(size_t table_ndx, size_t prior_size, StringData name)
@@ -246,58 +408,105 @@ public:
             if (observer.table_ndx >= table_ndx)
                 ++observer.table_ndx;
         }
+        if (table_ndx < m_observed_rows.size()) {
+            m_observed_rows.insert(m_observed_rows.begin() + table_ndx, ObservedRows());
+        }
+        if (m_change_info) {
+            m_change_info->schema_changed = true;
+        }
         TransactLogValidator::insert_group_level_table(table_ndx, prior_size, name);
         return true;
     }
 
-    bool insert_empty_rows(size_t, size_t, size_t, bool)
+    bool insert_empty_rows(size_t row_ndx, size_t num_rows, size_t prior_num_rows, bool)
     {
-        // rows are only inserted at the end, so no need to do anything
+        // rows are only inserted at the end, so there are no observers to update
+        if (row_ndx != prior_num_rows) {
+            record_row_index_change(RowIndexChange::Kind::Insert, row_ndx, num_rows);
+        }
+        else if (auto changes = table_changes()) {
+            changes->insertions_start = std::min(changes->insertions_start, row_ndx);
+        }
         return true;
     }
 
-    bool erase_rows(size_t row_ndx, size_t, size_t last_row_ndx, bool unordered)
+    bool swap_rows(size_t row_ndx_1, size_t row_ndx_2)
     {
-        for (size_t i = 0; i < m_observers.size(); ++i) {
-            auto& o = m_observers[i];
-            if (o.table_ndx == current_table()) {
-                if (o.row_ndx == row_ndx) {
-                    invalidate(&o);
-                    --i;
-                }
-                else if (unordered && o.row_ndx == last_row_ndx) {
-                    o.row_ndx = row_ndx;
-                }
-                else if (!unordered && o.row_ndx > row_ndx) {
-                    o.row_ndx -= 1;
-                }
+        record_row_index_change(RowIndexChange::Kind::Swap, row_ndx_1, row_ndx_2);
+        return true;
+    }
+
+    bool erase_rows(size_t row_ndx, size_t num_rows, size_t last_row_ndx, bool unordered)
+    {
+        if (unordered) {
+            record_row_index_change(RowIndexChange::Kind::MoveLastOver, row_ndx, last_row_ndx);
+        }
+        else {
+            record_row_index_change(RowIndexChange::Kind::Erase, row_ndx, num_rows);
+        }
+        auto rows = observed_rows();
+        if (!rows) {
+            return true;
+        }
+
+        if (unordered) {
+            auto it = rows->find(row_ndx);
+            if (it != rows->end()) {
+                invalidate(it->second);
+                rows->erase(it);
+            }
+            it = rows->find(last_row_ndx);
+            if (it != rows->end() && last_row_ndx != row_ndx) {
+                size_t observer_ndx = it->second;
+                rows->erase(it);
+                m_observers[observer_ndx].row_ndx = row_ndx;
+                (*rows)[row_ndx] = observer_ndx;
+            }
+            return true;
+        }
+
+        // Every following row shifts down, so the table's observers have to
+        // be rekeyed
+        ObservedRows shifted;
+        shifted.reserve(rows->size());
+        for (auto const& row : *rows) {
+            if (row.first < row_ndx) {
+                shifted.insert(row);
+            }
+            else if (row.first < row_ndx + num_rows) {
+                invalidate(row.second);
+            }
+            else {
+                m_observers[row.second].row_ndx = row.first - num_rows;
+                shifted[row.first - num_rows] = row.second;
             }
         }
+        *rows = std::move(shifted);
         return true;
     }
 
     bool clear_table()
     {
-        for (size_t i = 0; i < m_observers.size(); ) {
-            auto& o = m_observers[i];
-            if (o.table_ndx == current_table()) {
-                invalidate(&o);
-            }
-            else {
-                ++i;
+        record_row_index_change(RowIndexChange::Kind::Clear, 0);
+        if (auto rows = observed_rows()) {
+            for (auto const& row : *rows) {
+                invalidate(row.second);
             }
+            rows->clear();
         }
         return true;
     }
 
     bool select_link_list(size_t col, size_t row, size_t)
     {
+        // Link list instructions are guaranteed to follow, so record the
+        // change to the containing row up front
+        record_modification(row, col);
+
         m_active_linklist = nullptr;
-        for (auto& o : m_observers) {
-            if (o.table_ndx == current_table() && o.row_ndx == row) {
-                m_active_linklist = &get_change(o, col);
-                break;
-            }
+        if (auto o = find_observer(row)) {
+            o->mark_changed(col);
+            m_active_linklist = &o->linklist_change(col);
         }
         return true;
     }
@@ -372,9 +581,9 @@ public:
         }
 
         if (o->kind == ColumnInfo::Kind::Remove)
-            old_size += o->indices.size();
+            old_size += o->indices.count();
         else if (o->kind == ColumnInfo::Kind::Insert)
-            old_size -= o->indices.size();
+            old_size -= o->indices.count();
 
         o->indices.set(old_size);
 
@@ -398,8 +607,7 @@ public:
             o->changed = true;
         }
         if (o->kind == ColumnInfo::Kind::Set) {
-            for (size_t i = from; i <= to; ++i)
-                o->indices.add(i);
+            o->indices.add_range(from, to + 1);
         }
         else {
             o->indices.set(0);
@@ -426,24 +634,622 @@ public:
     bool insert_substring(size_t col, size_t row, size_t, StringData) { return mark_dirty(row, col); }
     bool erase_substring(size_t col, size_t row, size_t, size_t) { return mark_dirty(row, col); }
 };
+
+// Extends TransactLogValidator to record each change along with the values
+// written, for ChangeFeed
+class TransactLogRecorder : public TransactLogValidator {
+    using Kind = ChangeRecord::Kind;
+    using ValueType = ChangeValue::Type;
+
+    std::vector<ChangeRecord>& m_records;
+    // The link list selected by select_link_list(), as the column and row
+    // which own it
+    size_t m_list_column = npos;
+    size_t m_list_row = npos;
+    // Is the selected table a subtable of current_table()?
+    bool m_in_subtable = false;
+
+    ChangeRecord& record(Kind kind, size_t row, size_t column = npos)
+    {
+        m_records.push_back({kind, current_table(), row, column});
+        return m_records.back();
+    }
+
+    bool record_row_change(Kind kind, size_t row, size_t other = npos)
+    {
+        if (!m_in_subtable) {
+            record(kind, row).other = other;
+        }
+        return true;
+    }
+
+    bool record_list_change(Kind kind, size_t index, size_t other = npos)
+    {
+        if (!m_in_subtable) {
+            auto& change = record(kind, m_list_row, m_list_column);
+            change.index = index;
+            change.other = other;
+        }
+        return true;
+    }
+
+    bool record_list_link(Kind kind, size_t index, size_t target)
+    {
+        if (!m_in_subtable) {
+            auto& change = record(kind, m_list_row, m_list_column);
+            change.index = index;
+            change.value.type = ValueType::Link;
+            change.value.int_value = target;
+        }
+        return true;
+    }
+
+    // Record a Set with the value filled in by the given function
+    template<typename Func>
+    bool record_set(size_t col, size_t row, Func&& fill_value)
+    {
+        if (!m_in_subtable) {
+            fill_value(record(Kind::Set, row, col).value);
+        }
+        return true;
+    }
+
+public:
+    TransactLogRecorder(std::vector<ChangeRecord>& records) : m_records(records) { }
+
+    bool select_table(size_t group_level_ndx, int levels, const size_t* path) noexcept
+    {
+        TransactLogValidator::select_table(group_level_ndx, levels, path);
+        m_in_subtable = levels != 0;
+        return true;
+    }
+
+    bool select_link_list(size_t col, size_t row, size_t)
+    {
+        m_list_column = col;
+        m_list_row = row;
+        return true;
+    }
+
+    // Records refer to tables by their index at the end of the range, so
+    // inserting a table shifts the ones already recorded after it
+    bool insert_group_level_table(size_t table_ndx, size_t prior_size, StringData name)
+    {
+        for (auto& change : m_records) {
+            if (change.table >= table_ndx)
+                ++change.table;
+        }
+        return TransactLogValidator::insert_group_level_table(table_ndx, prior_size, name);
+    }
+
+    bool insert_empty_rows(size_t row_ndx, size_t num_rows, size_t, bool)
+    {
+        return record_row_change(Kind::Insert, row_ndx, num_rows);
+    }
+
+    bool erase_rows(size_t row_ndx, size_t num_rows, size_t last_row_ndx, bool unordered)
+    {
+        if (unordered) {
+            return record_row_change(Kind::MoveLastOver, row_ndx, last_row_ndx);
+        }
+        return record_row_change(Kind::Erase, row_ndx, num_rows);
+    }
+
+    bool swap_rows(size_t row_ndx_1, size_t row_ndx_2) { return record_row_change(Kind::Swap, row_ndx_1, row_ndx_2); }
+    bool clear_table() { return record_row_change(Kind::Clear, 0); }
+
+    bool link_list_set(size_t index, size_t value) { return record_list_link(Kind::ListSet, index, value); }
+    bool link_list_insert(size_t index, size_t value) { return record_list_link(Kind::ListInsert, index, value); }
+    bool link_list_erase(size_t index) { return record_list_change(Kind::ListErase, index); }
+    bool link_list_nullify(size_t index) { return record_list_change(Kind::ListErase, index); }
+    bool link_list_clear(size_t) { return record_list_change(Kind::ListClear, 0); }
+    bool link_list_move(size_t from, size_t to) { return record_list_change(Kind::ListMove, from, to); }
+    bool link_list_swap(size_t index_1, size_t index_2) { return record_list_change(Kind::ListSwap, index_1, index_2); }
+
+    bool set_int(size_t col, size_t row, int_fast64_t value)
+    {
+        return record_set(col, row, [&](ChangeValue& v) { v.type = ValueType::Int; v.int_value = value; });
+    }
+    bool set_int_unique(size_t col, size_t row, int_fast64_t value) { return set_int(col, row, value); }
+    bool set_bool(size_t col, size_t row, bool value)
+    {
+        return record_set(col, row, [&](ChangeValue& v) { v.type = ValueType::Bool; v.bool_value = value; });
+    }
+    bool set_float(size_t col, size_t row, float value)
+    {
+        return record_set(col, row, [&](ChangeValue& v) { v.type = ValueType::Float; v.float_value = value; });
+    }
+    bool set_double(size_t col, size_t row, double value)
+    {
+        return record_set(col, row, [&](ChangeValue& v) { v.type = ValueType::Double; v.double_value = value; });
+    }
+    bool set_string(size_t col, size_t row, StringData value)
+    {
+        return record_set(col, row, [&](ChangeValue& v) {
+            if (value.is_null())
+                return;
+            v.type = ValueType::String;
+            v.data.assign(value.data(), value.size());
+        });
+    }
+    bool set_string_unique(size_t col, size_t row, StringData value) { return set_string(col, row, value); }
+    bool set_binary(size_t col, size_t row, BinaryData value)
+    {
+        return record_set(col, row, [&](ChangeValue& v) {
+            if (value.is_null())
+                return;
+            v.type = ValueType::Binary;
+            v.data.assign(value.data(), value.size());
+        });
+    }
+    bool set_date_time(size_t col, size_t row, DateTime value)
+    {
+        return record_set(col, row, [&](ChangeValue& v) { v.type = ValueType::Date; v.int_value = value.get_datetime(); });
+    }
+    bool set_link(size_t col, size_t row, size_t target, size_t)
+    {
+        return record_set(col, row, [&](ChangeValue& v) {
+            if (target == npos)
+                return;
+            v.type = ValueType::Link;
+            v.int_value = target;
+        });
+    }
+    bool set_null(size_t col, size_t row) { return record_set(col, row, [](ChangeValue&) { }); }
+    bool nullify_link(size_t col, size_t row, size_t) { return set_null(col, row); }
+
+    // Subtables, mixed columns and substring edits aren't used by the object
+    // store, so there's nothing in the schema to resolve them to
+};
+
+// Records which columns of each table the current write transaction has
+// written to. The transaction is a schema update, so schema changes are
+// expected rather than validated, and only shift the recorded columns.
+class WrittenColumnsRecorder : public TransactLogValidator {
+    _impl::WrittenColumns& m_written;
+
+    _impl::WrittenColumns::Table& table()
+    {
+        auto& tables = m_written.tables;
+        if (tables.size() <= current_table()) {
+            tables.resize(current_table() + 1);
+        }
+        return tables[current_table()];
+    }
+
+    bool mark_column(size_t col)
+    {
+        auto& columns = table().columns;
+        if (columns.size() <= col) {
+            columns.resize(col + 1);
+        }
+        columns[col] = true;
+        return true;
+    }
+
+    bool mark_all_columns()
+    {
+        table().all_columns = true;
+        return true;
+    }
+
+    // Moving or removing tables changes the indexes of the ones after them in
+    // ways not worth tracking for a schema update
+    bool mark_all_tables()
+    {
+        m_written.all_tables = true;
+        return true;
+    }
+
+    bool insert_column_at(size_t col)
+    {
+        auto& columns = table().columns;
+        if (col < columns.size()) {
+            columns.insert(columns.begin() + col, true);
+            return true;
+        }
+        return mark_column(col);
+    }
+
+    bool erase_column_at(size_t col)
+    {
+        auto& columns = table().columns;
+        if (col < columns.size()) {
+            columns.erase(columns.begin() + col);
+        }
+        return true;
+    }
+
+public:
+    WrittenColumnsRecorder(_impl::WrittenColumns& written) : m_written(written) { }
+
+    bool select_table(size_t group_level_ndx, int levels, const size_t* path)
+    {
+        TransactLogValidator::select_table(group_level_ndx, levels, path);
+        // Writes to subtables can't be attributed to a column of the parent
+        return levels == 0 || mark_all_columns();
+    }
+    bool select_descriptor(int levels, const size_t*) { return levels == 0 || mark_all_columns(); }
+
+    bool insert_group_level_table(size_t table_ndx, size_t prior_size, StringData name)
+    {
+        auto& tables = m_written.tables;
+        if (table_ndx < tables.size()) {
+            tables.insert(tables.begin() + table_ndx, _impl::WrittenColumns::Table());
+        }
+        else {
+            tables.resize(table_ndx + 1);
+        }
+        tables[table_ndx].all_columns = true;
+        return TransactLogValidator::insert_group_level_table(table_ndx, prior_size, name);
+    }
+    bool erase_group_level_table(size_t, size_t) { return mark_all_tables(); }
+    bool move_group_level_table(size_t, size_t) { return mark_all_tables(); }
+    bool rename_group_level_table(size_t, StringData) { return true; }
+
+    // A new column is filled with default values, which may not be unique
+    bool insert_column(size_t col, DataType, StringData, bool) { return insert_column_at(col); }
+    bool insert_link_column(size_t col, DataType, StringData, size_t, size_t) { return insert_column_at(col); }
+    bool erase_column(size_t col) { return erase_column_at(col); }
+    bool erase_link_column(size_t col, size_t, size_t) { return erase_column_at(col); }
+    bool move_column(size_t, size_t) { return mark_all_columns(); }
+    bool rename_column(size_t, StringData) { return true; }
+    bool add_primary_key(size_t) { return true; }
+    bool remove_primary_key() { return true; }
+    bool set_link_type(size_t, LinkType) { return true; }
+
+    // New rows have values in every column
+    bool insert_empty_rows(size_t, size_t, size_t, bool) { return mark_all_columns(); }
+
+    bool set_int(size_t col, size_t, int_fast64_t) { return mark_column(col); }
+    bool set_bool(size_t col, size_t, bool) { return mark_column(col); }
+    bool set_float(size_t col, size_t, float) { return mark_column(col); }
+    bool set_double(size_t col, size_t, double) { return mark_column(col); }
+    bool set_string(size_t col, size_t, StringData) { return mark_column(col); }
+    bool set_binary(size_t col, size_t, BinaryData) { return mark_column(col); }
+    bool set_date_time(size_t col, size_t, DateTime) { return mark_column(col); }
+    bool set_table(size_t col, size_t) { return mark_column(col); }
+    bool set_mixed(size_t col, size_t, const Mixed&) { return mark_column(col); }
+    bool set_link(size_t col, size_t, size_t, size_t) { return mark_column(col); }
+    bool set_null(size_t col, size_t) { return mark_column(col); }
+    bool nullify_link(size_t col, size_t, size_t) { return mark_column(col); }
+    bool set_int_unique(size_t col, size_t, int_fast64_t) { return mark_column(col); }
+    bool set_string_unique(size_t col, size_t, StringData) { return mark_column(col); }
+    bool insert_substring(size_t col, size_t, size_t, StringData) { return mark_column(col); }
+    bool erase_substring(size_t col, size_t, size_t, size_t) { return mark_column(col); }
+};
+
+// Records just the changes to row indexes made by part of a write
+// transaction's log, starting from the table selected by the earlier parts
+class RowIndexChangeRecorder : public TransactLogValidator {
+    using RowIndexChange = _impl::TransactionChangeInfo::TableChanges::RowIndexChange;
+
+    _impl::TransactionChangeInfo& m_changes;
+    bool m_in_subtable;
+
+    bool record(RowIndexChange::Kind kind, size_t row, size_t other_or_count = 0)
+    {
+        if (m_in_subtable) {
+            return true;
+        }
+        auto& tables = m_changes.tables;
+        if (tables.size() <= current_table()) {
+            tables.resize(current_table() + 1);
+        }
+        tables[current_table()].add_row_index_change({kind, row, other_or_count});
+        return true;
+    }
+
+    bool tables_changed()
+    {
+        m_changes.schema_changed = true;
+        return true;
+    }
+
+public:
+    RowIndexChangeRecorder(_impl::TransactionChangeInfo& changes, size_t current_table, bool in_subtable)
+    : m_changes(changes)
+    , m_in_subtable(in_subtable)
+    {
+        TransactLogValidator::select_table(current_table, 0, nullptr);
+    }
+
+    size_t selected_table() const noexcept { return current_table(); }
+    bool in_subtable() const noexcept { return m_in_subtable; }
+
+    bool select_table(size_t group_level_ndx, int levels, const size_t* path)
+    {
+        TransactLogValidator::select_table(group_level_ndx, levels, path);
+        m_in_subtable = levels != 0;
+        return true;
+    }
+    bool select_descriptor(int, const size_t*) { return true; }
+
+    // The log is this Realm's own write, so any schema change is allowed, but
+    // only changes to table indexes affect row keys
+    bool insert_group_level_table(size_t, size_t, StringData) { return tables_changed(); }
+    bool erase_group_level_table(size_t, size_t) { return tables_changed(); }
+    bool move_group_level_table(size_t, size_t) { return tables_changed(); }
+    bool rename_group_level_table(size_t, StringData) { return true; }
+    bool insert_column(size_t, DataType, StringData, bool) { return true; }
+    bool insert_link_column(size_t, DataType, StringData, size_t, size_t) { return true; }
+    bool erase_column(size_t) { return true; }
+    bool erase_link_column(size_t, size_t, size_t) { return true; }
+    bool move_column(size_t, size_t) { return true; }
+    bool rename_column(size_t, StringData) { return true; }
+    bool add_primary_key(size_t) { return true; }
+    bool remove_primary_key() { return true; }
+    bool set_link_type(size_t, LinkType) { return true; }
+
+    bool insert_empty_rows(size_t row_ndx, size_t num_rows, size_t prior_num_rows, bool)
+    {
+        // Rows appended to the end don't change the indexes of existing rows
+        return row_ndx == prior_num_rows || record(RowIndexChange::Kind::Insert, row_ndx, num_rows);
+    }
+    bool erase_rows(size_t row_ndx, size_t num_rows, size_t last_row_ndx, bool unordered)
+    {
+        if (unordered) {
+            return record(RowIndexChange::Kind::MoveLastOver, row_ndx, last_row_ndx);
+        }
+        return record(RowIndexChange::Kind::Erase, row_ndx, num_rows);
+    }
+    bool swap_rows(size_t row_ndx_1, size_t row_ndx_2) { return record(RowIndexChange::Kind::Swap, row_ndx_1, row_ndx_2); }
+    bool clear_table() { return record(RowIndexChange::Kind::Clear, 0); }
+};
 } // anonymous namespace
 
 namespace realm {
 namespace _impl {
+void TransactionChangeInfo::merge(TransactionChangeInfo const& next)
+{
+    REALM_ASSERT_DEBUG(final_version == next.initial_version);
+    final_version = next.final_version;
+    schema_changed = schema_changed || next.schema_changed;
+
+    if (tables.size() < next.tables.size()) {
+        tables.resize(next.tables.size());
+    }
+    for (size_t i = 0; i < next.tables.size(); ++i) {
+        auto& table = tables[i];
+        auto const& next_table = next.tables[i];
+
+        // The rows modified by the earlier changes are moved by the later
+        // changes' row index changes before adding the rows those modified,
+        // which are already at their final indexes
+        for (auto const& change : next_table.row_index_changes) {
+            table.add_row_index_change(change);
+        }
+        table.row_indexes_lost = table.row_indexes_lost || next_table.row_indexes_lost;
+        table.rows_moved = table.rows_moved || next_table.rows_moved;
+        table.insertions_start = std::min(table.insertions_start, next_table.insertions_start);
+
+        table.modifications.add(next_table.modifications);
+        if (table.column_modifications.size() < next_table.column_modifications.size()) {
+            table.column_modifications.resize(next_table.column_modifications.size());
+        }
+        for (size_t col = 0; col < next_table.column_modifications.size(); ++col) {
+            table.column_modifications[col].add(next_table.column_modifications[col]);
+        }
+    }
+}
+
+// Mapping a row through the changes is linear in the number of changes, so
+// past this many it's cheaper for anything that needs the mapping to start over
+static const size_t s_max_row_index_changes = 256;
+
+// Move the rows in the set to the indexes they have after the change
+static void move_rows(IndexSet& rows, TransactionChangeInfo::TableChanges::RowIndexChange const& change)
+{
+    using Kind = TransactionChangeInfo::TableChanges::RowIndexChange::Kind;
+    if (rows.empty()) {
+        return;
+    }
+    switch (change.kind) {
+        case Kind::Insert:
+            rows.shift_for_insert_at(change.row, change.other_or_count);
+            break;
+        case Kind::Erase:
+            rows.erase_at(change.row, change.other_or_count);
+            break;
+        case Kind::MoveLastOver: {
+            size_t last = change.other_or_count;
+            bool last_contained = last != change.row && rows.contains(last);
+            rows.remove_range(change.row, change.row + 1);
+            if (last_contained) {
+                rows.remove_range(last, last + 1);
+                rows.add(change.row);
+            }
+            break;
+        }
+        case Kind::Swap: {
+            size_t a = change.row, b = change.other_or_count;
+            bool contains_a = rows.contains(a), contains_b = rows.contains(b);
+            if (contains_a != contains_b) {
+                size_t from = contains_a ? a : b, to = contains_a ? b : a;
+                rows.remove_range(from, from + 1);
+                rows.add(to);
+            }
+            break;
+        }
+        case Kind::Clear:
+            rows.set(0);
+            break;
+    }
+}
+
+void TransactionChangeInfo::TableChanges::add_row_index_change(RowIndexChange change)
+{
+    // The modified rows are kept up to date even once the changes themselves
+    // are no longer tracked
+    move_rows(modifications, change);
+    for (auto& rows : column_modifications) {
+        move_rows(rows, change);
+    }
+
+    if (row_indexes_lost) {
+        return;
+    }
+    if (row_index_changes.size() == s_max_row_index_changes) {
+        row_indexes_lost = true;
+        row_index_changes = {};
+        return;
+    }
+    row_index_changes.push_back(change);
+}
+
+size_t TransactionChangeInfo::TableChanges::new_row_index(size_t index) const noexcept
+{
+    REALM_ASSERT_DEBUG(!row_indexes_lost);
+    for (auto const& change : row_index_changes) {
+        switch (change.kind) {
+            case RowIndexChange::Kind::Insert:
+                if (index >= change.row) {
+                    index += change.other_or_count;
+                }
+                break;
+            case RowIndexChange::Kind::Erase:
+                if (index >= change.row + change.other_or_count) {
+                    index -= change.other_or_count;
+                }
+                else if (index >= change.row) {
+                    return npos;
+                }
+                break;
+            case RowIndexChange::Kind::MoveLastOver:
+                if (index == change.row) {
+                    return npos;
+                }
+                if (index == change.other_or_count) {
+                    index = change.row;
+                }
+                break;
+            case RowIndexChange::Kind::Swap:
+                if (index == change.row) {
+                    index = change.other_or_count;
+                }
+                else if (index == change.other_or_count) {
+                    index = change.row;
+                }
+                break;
+            case RowIndexChange::Kind::Clear:
+                return npos;
+        }
+    }
+    return index;
+}
+
+bool TransactionChangeInfo::modified_any(std::vector<bool> const& observed) const noexcept
+{
+    if (schema_changed) {
+        return true;
+    }
+    for (size_t i = 0; i < tables.size() && i < observed.size(); ++i) {
+        if (observed[i] && !tables[i].empty()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+SchemaSummary::SchemaSummary(Group& group)
+{
+    m_tables.reserve(group.size());
+    for (size_t i = 0; i < group.size(); ++i) {
+        auto table = group.get_table(i);
+        TableSchema schema;
+        schema.name = std::string(table->get_name());
+        schema.columns.reserve(table->get_column_count());
+        for (size_t col = 0; col < table->get_column_count(); ++col) {
+            schema.columns.push_back({std::string(table->get_column_name(col)), table->get_column_type(col)});
+        }
+        m_tables.push_back(std::move(schema));
+    }
+}
+
+void SchemaSummary::validate(Group& group) const
+{
+    // Tables may have been inserted before existing ones, so they're found by
+    // name rather than by index
+    for (auto const& schema : m_tables) {
+        auto table = group.get_table(schema.name);
+        if (!table || table->get_column_count() != schema.columns.size()) {
+            throw_schema_mismatch();
+        }
+        for (size_t col = 0; col < schema.columns.size(); ++col) {
+            if (table->get_column_name(col) != schema.columns[col].name
+                || table->get_column_type(col) != schema.columns[col].type) {
+                throw_schema_mismatch();
+            }
+        }
+    }
+}
+
+bool WrittenColumns::may_have_written(size_t table_ndx, size_t col_ndx) const noexcept
+{
+    if (all_tables) {
+        return true;
+    }
+    if (table_ndx >= tables.size()) {
+        return false;
+    }
+    auto& table = tables[table_ndx];
+    return table.all_columns || (col_ndx < table.columns.size() && table.columns[col_ndx]);
+}
+
+void UncommittedRowIndexChanges::parse(ClientHistory& history, TransactionChangeInfo& changes)
+{
+    BinaryData log = history.get_uncommitted_changes();
+    if (log.size() <= m_parsed_size) {
+        return;
+    }
+
+    // Instructions are always appended whole, so the new part of the log
+    // starts at an instruction boundary
+    RowIndexChangeRecorder recorder(changes, m_current_table, m_in_subtable);
+    SimpleInputStream in(log.data() + m_parsed_size, log.size() - m_parsed_size);
+    TransactLogParser().parse(in, recorder);
+
+    m_parsed_size = log.size();
+    m_current_table = recorder.selected_table();
+    m_in_subtable = recorder.in_subtable();
+}
+
 namespace transaction {
-void advance(SharedGroup& sg, ClientHistory& history, BindingContext* context)
+void advance(SharedGroup& sg, ClientHistory& history, BindingContext* context,
+             TransactionChangeInfo* change_info, SharedGroup::VersionID target_version,
+             std::vector<bool> const* observed_tables, TransactionChangeInfo const* precomputed_changes,
+             bool validate_schema_changes)
 {
+    REALM_TRACE_BEGIN(Advance, nullptr, sg.get_version_of_current_transaction().version, 0);
     TransactLogObserver(context, sg, [&](auto&&... args) {
-        LangBindHelper::advance_read(sg, history, std::move(args)...);
-    }, true);
+        LangBindHelper::advance_read(sg, history, std::move(args)..., target_version);
+    }, validate_schema_changes, change_info, observed_tables, precomputed_changes);
+    REALM_TRACE_END(Advance, nullptr, sg.get_version_of_current_transaction().version,
+                    change_info ? change_info->tables.size() : 0);
+}
+
+void advance_recording_changes(SharedGroup& sg, ClientHistory& history, std::vector<ChangeRecord>& records)
+{
+    TransactLogRecorder recorder(records);
+    LangBindHelper::advance_read(sg, history, recorder);
+}
+
+WrittenColumns written_columns(ClientHistory& history)
+{
+    WrittenColumns written;
+    WrittenColumnsRecorder recorder(written);
+    BinaryData changes = history.get_uncommitted_changes();
+    SimpleInputStream in(changes.data(), changes.size());
+    TransactLogParser().parse(in, recorder);
+    return written;
 }
 
 void begin(SharedGroup& sg, ClientHistory& history, BindingContext* context,
-           bool validate_schema_changes)
+           bool validate_schema_changes, TransactionChangeInfo* change_info)
 {
     TransactLogObserver(context, sg, [&](auto&&... args) {
         LangBindHelper::promote_to_write(sg, history, std::move(args)...);
-    }, validate_schema_changes);
+    }, validate_schema_changes, change_info);
 }
 
 void commit(SharedGroup& sg, ClientHistory&, BindingContext* context)
@@ -451,7 +1257,11 @@ void commit(SharedGroup& sg, ClientHistory&, BindingContext* context)
     LangBindHelper::commit_and_continue_as_read(sg);
 
     if (context) {
-        context->did_change({}, {});
+        // The write transaction was begun at the version before the new one
+        BindingContext::VersionChange change;
+        change.new_version = sg.get_version_of_current_transaction().version;
+        change.old_version = change.new_version - 1;
+        context->did_change({}, {}, change);
     }
 }
 
@@ -19,22 +19,208 @@
 #ifndef REALM_TRANSACT_LOG_HANDLER_HPP
 #define REALM_TRANSACT_LOG_HANDLER_HPP
 
+#include "index_set.hpp"
+
+#include <realm/group_shared.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
 namespace realm {
 class BindingContext;
-class SharedGroup;
 class ClientHistory;
+class Group;
+struct ChangeRecord;
 
 namespace _impl {
+// A summary of the row-level changes made to each table by one or more
+// transactions, gathered while parsing the transaction log
+struct TransactionChangeInfo {
+    struct TableChanges {
+        // Rows which had at least one column modified, including link list
+        // changes, by row index after all of the changes. Rows recorded as
+        // modified are moved by each later change to row indexes, unless the
+        // changes were merged after row_indexes_lost was set.
+        IndexSet modifications;
+        // The rows modified in each column, indexed by column. May be shorter
+        // than the number of columns if later columns were not modified.
+        std::vector<IndexSet> column_modifications;
+        // The first row added to the end of the table, or npos if none were
+        size_t insertions_start = size_t(-1);
+        // Rows were erased, moved, swapped or inserted anywhere other than the
+        // end, so existing row indexes can't be compared with the new ones
+        bool rows_moved = false;
+
+        // A change to the indexes of existing rows. Rows appended to the end
+        // of the table don't change any existing indexes and aren't recorded.
+        struct RowIndexChange {
+            enum class Kind {
+                Insert,       // `count` rows inserted before `row`
+                Erase,        // `count` rows erased starting at `row`
+                MoveLastOver, // `row` erased and the row at `other` moved into its place
+                Swap,         // `row` and `other` swapped
+                Clear         // every row erased
+            } kind;
+            size_t row;
+            size_t other_or_count;
+        };
+        // The changes to row indexes, in the order they were made
+        std::vector<RowIndexChange> row_index_changes;
+        // There were too many changes to row indexes to record, so rows can't
+        // be mapped to their new indexes
+        bool row_indexes_lost = false;
+
+        bool empty() const noexcept
+        {
+            return modifications.empty() && insertions_start == size_t(-1) && !rows_moved;
+        }
+
+        bool column_modified(size_t col) const noexcept
+        {
+            return col < column_modifications.size() && !column_modifications[col].empty();
+        }
+
+        // Was the row modified in any of the given columns?
+        bool row_modified(size_t row, std::vector<size_t> const& cols) const
+        {
+            for (size_t col : cols) {
+                if (col < column_modifications.size() && column_modifications[col].contains(row))
+                    return true;
+            }
+            return false;
+        }
+
+        // Record a change to row indexes, or give up on tracking them if
+        // there have been too many, and move the rows already recorded as
+        // modified to their new indexes
+        void add_row_index_change(RowIndexChange change);
+
+        // The index after the changes of the row which had the given index
+        // before them, or npos if it was erased. Must not be called if
+        // row_indexes_lost is set.
+        size_t new_row_index(size_t old_index) const noexcept;
+    };
+
+    // Changes for each table, indexed by the table's index in the group. May
+    // be shorter than the number of tables if later tables were not modified.
+    std::vector<TableChanges> tables;
+
+    // Tables were inserted, shifting the indexes of existing tables
+    bool schema_changed = false;
+
+    // The versions of the read transaction before and after the changes
+    uint_fast64_t initial_version = 0;
+    uint_fast64_t final_version = 0;
+
+    // Combine the changes from a transaction which immediately followed the
+    // ones already in this object
+    void merge(TransactionChangeInfo const& next);
+
+    // Did the changes modify any of the tables marked in `tables` (indexed by
+    // the table's index in the group), or change the schema?
+    bool modified_any(std::vector<bool> const& tables) const noexcept;
+};
+
+// The names and columns of each table in a group, for checking that a read
+// transaction was advanced over only the schema changes which are allowed
+// while a Realm is open without parsing the transaction logs. This costs time
+// proportional to the size of the schema rather than the size of the commits.
+class SchemaSummary {
+public:
+    explicit SchemaSummary(Group& group);
+
+    // Throw the same exception as parsing the transaction logs would if the
+    // group's existing tables were removed, renamed or had columns changed.
+    // Adding tables and changing search indexes are allowed.
+    void validate(Group& group) const;
+
+private:
+    struct Column {
+        std::string name;
+        DataType type;
+    };
+    struct TableSchema {
+        std::string name;
+        std::vector<Column> columns;
+    };
+    std::vector<TableSchema> m_tables;
+};
+
+// The columns of each table which the current write transaction may have
+// written values to, found by parsing its uncommitted transaction log.
+// Inserting rows or creating a table counts as writing to all of its columns.
+struct WrittenColumns {
+    struct Table {
+        std::vector<bool> columns;
+        bool all_columns = false;
+    };
+    // Indexed by the table's index in the group at the end of the log. May be
+    // shorter than the number of tables if later tables were not written to.
+    std::vector<Table> tables;
+    // Tables were removed or moved, so nothing is known about any of them
+    bool all_tables = false;
+
+    bool may_have_written(size_t table_ndx, size_t col_ndx) const noexcept;
+};
+
+// Parses the uncommitted transaction log of a write transaction a piece at a
+// time, so that things keyed by row index can follow the rows moved by the
+// transaction while it's in progress without reparsing the whole log each time
+class UncommittedRowIndexChanges {
+public:
+    // Add the changes to row indexes made since the previous call to
+    // `changes`. Tables being inserted, removed or moved sets schema_changed.
+    void parse(ClientHistory& history, TransactionChangeInfo& changes);
+    // Start over for a new write transaction
+    void reset() { *this = UncommittedRowIndexChanges(); }
+
+private:
+    // How much of the log has been parsed, and the table selected at that
+    // point, which later instructions may rely on without selecting it again
+    size_t m_parsed_size = 0;
+    size_t m_current_table = 0;
+    bool m_in_subtable = false;
+};
+
 namespace transaction {
 // Advance the read transaction version, with change notifications sent to delegate
 // Must not be called from within a write transaction.
-void advance(SharedGroup& sg, ClientHistory& history, BindingContext* binding_context);
+// If change_info is non-null it is populated with a summary of the changes made
+// by the transactions which were advanced over.
+// Advances to the newest version unless a target version is given, which must
+// still be pinned by some reader.
+// If observed_tables is non-null and no rows are being observed, did_change()
+// is only sent if the advance modified one of the marked tables. This requires
+// change_info to be non-null.
+// If precomputed_changes is non-null it must be the changes from the current
+// version to target_version, which were computed elsewhere. If no rows are
+// being observed they are copied to change_info rather than parsing the
+// transaction log again.
+// If validate_schema_changes is false and there is no change_info and no rows
+// are being observed, the transaction log isn't parsed at all, and the caller
+// is responsible for checking the schema (e.g. with SchemaSummary).
+void advance(SharedGroup& sg, ClientHistory& history, BindingContext* binding_context,
+             TransactionChangeInfo* change_info=nullptr,
+             SharedGroup::VersionID target_version=SharedGroup::VersionID(),
+             std::vector<bool> const* observed_tables=nullptr,
+             TransactionChangeInfo const* precomputed_changes=nullptr,
+             bool validate_schema_changes=true);
+
+// Advance the read transaction to the newest version, appending a record of
+// each change made by the transactions advanced over, with the values written,
+// to `records`. Used by ChangeFeed; no notifications are sent.
+void advance_recording_changes(SharedGroup& sg, ClientHistory& history, std::vector<ChangeRecord>& records);
+
+// Parse the changes made so far by the current write transaction to find
+// which columns were written to
+WrittenColumns written_columns(ClientHistory& history);
 
 // Begin a write transaction
 // If the read transaction version is not up to date, will first advance to the
 // most recent read transaction and sent notifications to delegate
 void begin(SharedGroup& sg, ClientHistory& history, BindingContext* binding_context,
-           bool validate_schema_changes=true);
+           bool validate_schema_changes=true, TransactionChangeInfo* change_info=nullptr);
 
 // Commit a write transaction
 void commit(SharedGroup& sg, ClientHistory& history, BindingContext* binding_context);
@@ -0,0 +1,143 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "version_checkpoints.hpp"
+
+#include "realm_snapshot.hpp"
+#include "shared_realm.hpp"
+
+#include <algorithm>
+#include <limits>
+
+using namespace realm;
+using namespace realm::_impl;
+
+// Each checkpoint holds open a SharedGroup, so only this many are kept. When
+// there are more the oldest is released, making the step to it longer.
+static const size_t s_max_checkpoints = 32;
+// The versions between checkpoints for Realms which only limit the time
+// spent stepping and not the number of versions per step
+static const size_t s_default_checkpoint_spacing = 8;
+
+void VersionCheckpoints::add_realm(Realm* realm)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_realms.push_back(realm);
+}
+
+void VersionCheckpoints::remove_realm(Realm* realm)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_realms.erase(std::remove(m_realms.begin(), m_realms.end(), realm), m_realms.end());
+    prune();
+}
+
+bool VersionCheckpoints::needs_checkpoint(Realm& committer, uint_fast64_t version) const
+{
+    // Stepping Realms never have to take a step of more than their version
+    // limit, so a version only needs to be pinned once that many versions
+    // have been committed since the newest place they can already stop at:
+    // the newest checkpoint, or the oldest version being read if that's newer.
+    uint_fast64_t oldest_reader = 0;
+    size_t spacing = std::numeric_limits<size_t>::max();
+    for (auto realm : m_realms) {
+        uint_fast64_t read_version = realm->m_read_version;
+        // Realms without a read transaction will begin reading at the
+        // newest version, so they can't fall behind
+        if (realm == &committer || !read_version) {
+            continue;
+        }
+        oldest_reader = oldest_reader ? std::min(oldest_reader, read_version) : read_version;
+        size_t limit = realm->m_config.autorefresh_version_limit;
+        spacing = std::min(spacing, limit ? limit : s_default_checkpoint_spacing);
+    }
+    if (!oldest_reader) {
+        return false;
+    }
+    uint_fast64_t newest_stop = oldest_reader;
+    if (!m_checkpoints.empty()) {
+        newest_stop = std::max(newest_stop, m_checkpoints.back()->version());
+    }
+    return version - newest_stop >= spacing;
+}
+
+void VersionCheckpoints::did_commit(Realm& realm)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!needs_checkpoint(realm, realm.m_read_version)) {
+            return;
+        }
+    }
+
+    // Opening the snapshot's reader is done without holding the lock as it
+    // has to open the file
+    auto checkpoint = RealmSnapshot::create(realm);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_checkpoints.push_back(std::move(checkpoint));
+    if (m_checkpoints.size() > s_max_checkpoints) {
+        m_checkpoints.erase(m_checkpoints.begin());
+    }
+    prune();
+}
+
+void VersionCheckpoints::prune()
+{
+    uint_fast64_t oldest = std::numeric_limits<uint_fast64_t>::max();
+    for (auto realm : m_realms) {
+        // Realms without a read transaction will begin reading at the
+        // newest version, so they don't need any of the checkpoints
+        if (uint_fast64_t version = realm->m_read_version) {
+            oldest = std::min(oldest, version);
+        }
+    }
+
+    auto first_needed = std::find_if(m_checkpoints.begin(), m_checkpoints.end(),
+                                     [=](auto const& checkpoint) { return checkpoint->version() > oldest; });
+    m_checkpoints.erase(m_checkpoints.begin(), first_needed);
+}
+
+void VersionCheckpoints::clear()
+{
+    // The snapshots close their readers as they're destroyed, which is done
+    // after releasing the lock
+    std::vector<std::shared_ptr<RealmSnapshot>> checkpoints;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    checkpoints.swap(m_checkpoints);
+}
+
+std::shared_ptr<RealmSnapshot> VersionCheckpoints::next_step(uint_fast64_t version, size_t max_versions)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    prune();
+
+    auto it = std::find_if(m_checkpoints.begin(), m_checkpoints.end(),
+                           [=](auto const& checkpoint) { return checkpoint->version() > version; });
+    if (it == m_checkpoints.end()) {
+        return nullptr;
+    }
+    if (max_versions) {
+        for (auto next = it + 1; next != m_checkpoints.end() && (*next)->version() - version <= max_versions; ++next) {
+            it = next;
+        }
+    }
+    // The returned pointer keeps the version pinned even if the checkpoint
+    // is released before the Realm has finished advancing to it
+    return *it;
+}
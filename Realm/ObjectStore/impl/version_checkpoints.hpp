@@ -0,0 +1,77 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef REALM_VERSION_CHECKPOINTS_HPP
+#define REALM_VERSION_CHECKPOINTS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace realm {
+class Realm;
+class RealmSnapshot;
+
+namespace _impl {
+// Versions committed by Realms in this process which are kept pinned so that
+// Realms which automatically refresh in bounded steps have somewhere to stop.
+// Core can only advance a read transaction to the newest version or to one
+// which is still being read, so commits made by other processes can't be
+// stopped at and are advanced over along with the next checkpoint.
+class VersionCheckpoints {
+public:
+    // Realms which refresh in steps, whose read versions determine which
+    // checkpoints are still needed
+    void add_realm(Realm* realm);
+    void remove_realm(Realm* realm);
+
+    // Pin the version the Realm has just committed if another stepping Realm
+    // has fallen far enough behind that it may need to stop at it. Must be
+    // called on the Realm's thread.
+    void did_commit(Realm& realm);
+
+    // The checkpoint to advance to next from the given version: the newest
+    // one at most max_versions after it, or the first one after it if none
+    // are that close or max_versions is zero. Null if there are no
+    // checkpoints after the version, in which case the Realm should advance
+    // straight to the newest version.
+    std::shared_ptr<RealmSnapshot> next_step(uint_fast64_t version, size_t max_versions);
+
+    // Release every checkpoint, so that stepping Realms advance straight to
+    // the newest version until more commits are made
+    void clear();
+
+private:
+    // Check if a stepping Realm other than the committing one could need to
+    // stop at the version. Must be called with m_mutex held.
+    bool needs_checkpoint(Realm& committer, uint_fast64_t version) const;
+    // Release the checkpoints which all of the stepping Realms have advanced
+    // past. Must be called with m_mutex held.
+    void prune();
+
+    std::mutex m_mutex;
+    std::vector<Realm*> m_realms;
+    // Oldest first
+    std::vector<std::shared_ptr<RealmSnapshot>> m_checkpoints;
+};
+} // namespace _impl
+} // namespace realm
+
+#endif /* REALM_VERSION_CHECKPOINTS_HPP */
@@ -18,23 +18,151 @@
 
 #include "index_set.hpp"
 
+#include <algorithm>
+
 using namespace realm;
 
-IndexSet::iterator IndexSet::find(size_t index)
+const size_t IndexSet::npos;
+
+namespace {
+// Sets of fewer ranges than this are always kept as ranges
+const size_t s_min_ranges_for_bitmap = 32;
+// Bitmap sets with fewer ranges than this switch back to ranges. This is lower
+// than the threshold for switching to a bitmap so that a set which hovers
+// around it doesn't switch back and forth on every change.
+const size_t s_min_ranges_to_stay_bitmap = s_min_ranges_for_bitmap / 2;
+
+size_t word_count(size_t end)
+{
+    return (end + 63) / 64;
+}
+
+// Mask of the bits in word `word` for indexes less than `index`
+uint64_t mask_below(size_t word, size_t index)
+{
+    if (index >= word * 64 + 64)
+        return ~uint64_t(0);
+    if (index <= word * 64)
+        return 0;
+    return (uint64_t(1) << (index - word * 64)) - 1;
+}
+
+// Get the 64 bits starting at bit `pos`, which may be unaligned or negative,
+// with bits outside of `words` read as zero
+uint64_t get_bits(std::vector<uint64_t> const& words, ptrdiff_t pos)
+{
+    if (pos <= -64)
+        return 0;
+    if (pos < 0)
+        return get_bits(words, 0) << -pos;
+    size_t word = size_t(pos) / 64, bit = size_t(pos) % 64;
+    uint64_t ret = word < words.size() ? words[word] >> bit : 0;
+    if (bit && word + 1 < words.size())
+        ret |= words[word + 1] << (64 - bit);
+    return ret;
+}
+
+size_t count_trailing_zeros(uint64_t word)
+{
+    return __builtin_ctzll(word);
+}
+} // anonymous namespace
+
+IndexSet::const_iterator IndexSet::begin() const
+{
+    if (m_bitmap)
+        return {*this, next_bit_range(0), 0};
+    if (m_ranges.empty())
+        return end();
+    return {*this, m_ranges.front(), 0};
+}
+
+IndexSet::const_iterator& IndexSet::const_iterator::operator++()
+{
+    if (m_set->m_bitmap) {
+        m_range = m_set->next_bit_range(m_range.second);
+    }
+    else if (++m_pos < m_set->m_ranges.size()) {
+        m_range = m_set->m_ranges[m_pos];
+    }
+    else {
+        m_range = {npos, npos};
+    }
+    return *this;
+}
+
+IndexSet::value_type IndexSet::next_bit_range(size_t from) const
 {
-    for (auto it = m_ranges.begin(), end = m_ranges.end(); it != end; ++it) {
-        if (it->second > index)
-            return it;
+    size_t word = from / 64;
+    if (word >= m_bits.size())
+        return {npos, npos};
+
+    // Find the first set bit at or after `from`
+    uint64_t bits = m_bits[word] & ~mask_below(word, from);
+    while (!bits) {
+        if (++word == m_bits.size())
+            return {npos, npos};
+        bits = m_bits[word];
+    }
+    size_t begin = word * 64 + count_trailing_zeros(bits);
+
+    // Then the first unset bit after it
+    bits = ~m_bits[word] & ~mask_below(word, begin);
+    while (!bits) {
+        if (++word == m_bits.size())
+            return {begin, word * 64};
+        bits = ~m_bits[word];
     }
-    return m_ranges.end();
+    return {begin, word * 64 + count_trailing_zeros(bits)};
+}
+
+size_t IndexSet::size() const
+{
+    if (!m_bitmap)
+        return m_ranges.size();
+    return std::distance(begin(), end());
+}
+
+size_t IndexSet::count() const
+{
+    size_t count = 0;
+    if (m_bitmap) {
+        for (auto word : m_bits)
+            count += __builtin_popcountll(word);
+    }
+    else {
+        for (auto const& range : m_ranges)
+            count += range.second - range.first;
+    }
+    return count;
+}
+
+IndexSet::range_iterator IndexSet::find(size_t index)
+{
+    return std::upper_bound(m_ranges.begin(), m_ranges.end(), index,
+                            [](size_t index, value_type const& range) { return index < range.second; });
+}
+
+bool IndexSet::contains(size_t index) const
+{
+    if (m_bitmap) {
+        size_t word = index / 64;
+        return word < m_bits.size() && (m_bits[word] >> (index % 64) & 1);
+    }
+    auto it = std::upper_bound(m_ranges.begin(), m_ranges.end(), index,
+                               [](size_t index, value_type const& range) { return index < range.second; });
+    return it != m_ranges.end() && it->first <= index;
 }
 
 void IndexSet::add(size_t index)
 {
-    do_add(find(index), index);
+    if (m_bitmap)
+        set_bits(index, index + 1);
+    else
+        do_add(find(index), index);
 }
 
-void IndexSet::do_add(iterator it, size_t index)
+void IndexSet::do_add(range_iterator it, size_t index)
 {
     bool more_before = it != m_ranges.begin(), valid = it != m_ranges.end();
     if (valid && it->first <= index && it->second > index) {
@@ -43,11 +171,11 @@ void IndexSet::do_add(iterator it, size_t index)
     else if (more_before && (it - 1)->second == index) {
         // index is immediately after an existing range
         ++(it - 1)->second;
-    }
-    else if (more_before && valid && (it - 1)->second == it->first) {
-        // index joins two existing ranges
-        (it - 1)->second = it->second;
-        m_ranges.erase(it);
+        if (valid && (it - 1)->second == it->first) {
+            // index joins two existing ranges
+            (it - 1)->second = it->second;
+            m_ranges.erase(it);
+        }
     }
     else if (valid && it->first == index + 1) {
         // index is immediately before an existing range
@@ -56,12 +184,108 @@ void IndexSet::do_add(iterator it, size_t index)
     else {
         // index is not next to an existing range
         m_ranges.insert(it, {index, index + 1});
+        maybe_convert_to_bitmap();
+    }
+}
+
+void IndexSet::add_range(size_t begin, size_t end)
+{
+    if (begin >= end)
+        return;
+    if (m_bitmap) {
+        set_bits(begin, end);
+        return;
+    }
+
+    // Merge with every range which overlaps or touches [begin, end)
+    auto first = std::lower_bound(m_ranges.begin(), m_ranges.end(), begin,
+                                  [](value_type const& range, size_t begin) { return range.second < begin; });
+    auto last = first;
+    while (last != m_ranges.end() && last->first <= end) {
+        begin = std::min(begin, last->first);
+        end = std::max(end, last->second);
+        ++last;
+    }
+    if (first == last) {
+        m_ranges.insert(first, {begin, end});
+        maybe_convert_to_bitmap();
+        return;
+    }
+    *first = {begin, end};
+    m_ranges.erase(first + 1, last);
+}
+
+void IndexSet::add(IndexSet const& other)
+{
+    if (m_bitmap && other.m_bitmap) {
+        if (m_bits.size() < other.m_bits.size())
+            m_bits.resize(other.m_bits.size());
+        for (size_t i = 0; i < other.m_bits.size(); ++i)
+            m_bits[i] |= other.m_bits[i];
+        return;
+    }
+    for (auto const& range : other)
+        add_range(range.first, range.second);
+}
+
+void IndexSet::remove_range(size_t begin, size_t end)
+{
+    if (begin >= end)
+        return;
+    if (m_bitmap) {
+        clear_bits(begin, end);
+        trim_bits();
+        maybe_convert_to_ranges();
+        return;
+    }
+
+    auto first = find(begin);
+    auto last = first;
+    std::vector<value_type> split;
+    while (last != m_ranges.end() && last->first < end) {
+        if (last->first < begin)
+            split.push_back({last->first, begin});
+        if (last->second > end)
+            split.push_back({end, last->second});
+        ++last;
+    }
+    first = m_ranges.erase(first, last);
+    m_ranges.insert(first, split.begin(), split.end());
+}
+
+void IndexSet::intersect(IndexSet const& other)
+{
+    if (m_bitmap && other.m_bitmap) {
+        if (m_bits.size() > other.m_bits.size())
+            m_bits.resize(other.m_bits.size());
+        for (size_t i = 0; i < m_bits.size(); ++i)
+            m_bits[i] &= other.m_bits[i];
+        trim_bits();
+        maybe_convert_to_ranges();
+        return;
+    }
+
+    IndexSet result;
+    auto a = begin(), a_end = end();
+    auto b = other.begin(), b_end = other.end();
+    while (a != a_end && b != b_end) {
+        size_t first = std::max(a->first, b->first);
+        size_t second = std::min(a->second, b->second);
+        if (first < second)
+            result.add_range(first, second);
+        if (a->second < b->second)
+            ++a;
+        else
+            ++b;
     }
+    *this = std::move(result);
 }
 
 void IndexSet::set(size_t len)
 {
     m_ranges.clear();
+    m_bits.clear();
+    m_bitmap = false;
     if (len) {
         m_ranges.push_back({0, len});
     }
@@ -69,6 +293,12 @@ void IndexSet::set(size_t len)
 
 void IndexSet::insert_at(size_t index)
 {
+    if (m_bitmap) {
+        shift_for_insert_at(index);
+        set_bits(index, index + 1);
+        return;
+    }
+
     auto pos = find(index);
     if (pos != m_ranges.end()) {
         if (pos->first >= index)
@@ -82,11 +312,160 @@ void IndexSet::insert_at(size_t index)
     do_add(pos, index);
 }
 
+void IndexSet::shift_for_insert_at(size_t index, size_t count)
+{
+    if (!count)
+        return;
+
+    if (!m_bitmap) {
+        auto pos = find(index);
+        if (pos != m_ranges.end() && pos->first < index) {
+            // Split the range containing the index
+            auto tail = value_type{index + count, pos->second + count};
+            pos->second = index;
+            pos = m_ranges.insert(pos + 1, tail) + 1;
+        }
+        for (auto it = pos; it != m_ranges.end(); ++it) {
+            it->first += count;
+            it->second += count;
+        }
+        maybe_convert_to_bitmap();
+        return;
+    }
+
+    size_t first_word = index / 64;
+    if (first_word >= m_bits.size())
+        return;
+    size_t old_end = m_bits.size() * 64;
+    m_bits.resize(word_count(old_end + count));
+    // Work backwards so that each word is read before it's overwritten
+    for (size_t word = m_bits.size(); word-- > first_word; ) {
+        uint64_t keep = mask_below(word, index);
+        uint64_t moved = ~mask_below(word, index + count);
+        uint64_t old = word * 64 < old_end ? m_bits[word] : 0;
+        m_bits[word] = (old & keep) | (get_bits(m_bits, ptrdiff_t(word * 64) - ptrdiff_t(count)) & moved);
+    }
+    trim_bits();
+    maybe_convert_to_ranges();
+}
+
+void IndexSet::erase_at(size_t index, size_t count)
+{
+    if (!count)
+        return;
+
+    if (!m_bitmap) {
+        remove_range(index, index + count);
+        auto pos = find(index);
+        if (pos != m_ranges.begin() && pos != m_ranges.end() && (pos - 1)->second == index && pos->first == index + count) {
+            // The ranges on either side of the erased ones now touch
+            (pos - 1)->second = pos->second - count;
+            pos = m_ranges.erase(pos);
+        }
+        for (auto it = pos; it != m_ranges.end(); ++it) {
+            it->first -= count;
+            it->second -= count;
+        }
+        return;
+    }
+
+    // Work forwards so that each word is read before it's overwritten
+    for (size_t word = index / 64; word < m_bits.size(); ++word) {
+        uint64_t keep = mask_below(word, index);
+        m_bits[word] = (m_bits[word] & keep) | (get_bits(m_bits, ptrdiff_t(word * 64 + count)) & ~keep);
+    }
+    trim_bits();
+    maybe_convert_to_ranges();
+}
+
 void IndexSet::add_shifted(size_t index)
 {
+    if (m_bitmap) {
+        // Find the position of the index'th unset bit
+        for (size_t word = 0; word < m_bits.size(); ++word) {
+            size_t unset = 64 - __builtin_popcountll(m_bits[word]);
+            if (index >= unset) {
+                index -= unset;
+                continue;
+            }
+            for (size_t bit = 0; ; ++bit) {
+                if (!(m_bits[word] >> bit & 1) && index-- == 0) {
+                    set_bits(word * 64 + bit, word * 64 + bit + 1);
+                    return;
+                }
+            }
+        }
+        set_bits(m_bits.size() * 64 + index, m_bits.size() * 64 + index + 1);
+        return;
+    }
+
     auto it = m_ranges.begin();
     for (auto end = m_ranges.end(); it != end && it->first <= index; ++it) {
         index += it->second - it->first;
     }
     do_add(it, index);
 }
+
+void IndexSet::maybe_convert_to_bitmap()
+{
+    if (m_ranges.size() < s_min_ranges_for_bitmap)
+        return;
+    // Each range takes two words, so the bitmap is smaller once it needs
+    // fewer than twice as many words as there are ranges
+    size_t words = word_count(m_ranges.back().second);
+    if (words >= m_ranges.size() * 2)
+        return;
+
+    auto ranges = std::move(m_ranges);
+    m_ranges = {};
+    m_bitmap = true;
+    m_bits.reserve(words);
+    for (auto const& range : ranges)
+        set_bits(range.first, range.second);
+}
+
+void IndexSet::maybe_convert_to_ranges()
+{
+    // Switch back once the ranges would take less than half the space of the
+    // bitmap, rather than as soon as they'd be smaller, for the same reason.
+    // Reading the ranges stops as soon as there are too many, so this is cheap
+    // for sets which stay as bitmaps unless their ranges are very spread out.
+    size_t max_ranges = std::max(s_min_ranges_to_stay_bitmap, m_bits.size() / 4);
+    std::vector<value_type> ranges;
+    for (auto range = next_bit_range(0); range.first != npos; range = next_bit_range(range.second)) {
+        if (ranges.size() + 1 >= max_ranges)
+            return;
+        ranges.push_back(range);
+    }
+
+    m_ranges = std::move(ranges);
+    m_bits = {};
+    m_bitmap = false;
+}
+
+void IndexSet::set_bits(size_t begin, size_t end)
+{
+    if (begin >= end)
+        return;
+    if (m_bits.size() < word_count(end))
+        m_bits.resize(word_count(end));
+    size_t first = begin / 64, last = (end - 1) / 64;
+    for (size_t word = first; word <= last; ++word)
+        m_bits[word] |= ~mask_below(word, begin) & mask_below(word, end);
+}
+
+void IndexSet::clear_bits(size_t begin, size_t end)
+{
+    end = std::min(end, m_bits.size() * 64);
+    if (begin >= end)
+        return;
+    size_t first = begin / 64, last = (end - 1) / 64;
+    for (size_t word = first; word <= last; ++word)
+        m_bits[word] &= mask_below(word, begin) | ~mask_below(word, end);
+}
+
+void IndexSet::trim_bits()
+{
+    while (!m_bits.empty() && !m_bits.back())
+        m_bits.pop_back();
+}
@@ -19,23 +19,81 @@
 #ifndef REALM_INDEX_SET_HPP
 #define REALM_INDEX_SET_HPP
 
+#include <cstddef>
+#include <cstdint>
 #include <cstdlib>
+#include <iterator>
+#include <utility>
 #include <vector>
 
 namespace realm {
+// A set of indexes. Sparse sets are stored as a sorted vector of ranges, and
+// once a set has enough ranges that a bitmap covering all of them would be
+// smaller it switches to a dense bitmap, so that scattered changes to large
+// collections can be added and shifted in time proportional to the size of the
+// bitmap rather than with a search and shift of the ranges for every index.
+// Removing or shifting indexes in a bitmap set switches it back to ranges once
+// it has few enough ranges that they'd be much smaller than the bitmap. Either
+// way the set is read as a sequence of ranges.
 class IndexSet {
 public:
+    // A range [first, second) of indexes which are all in the set
     using value_type = std::pair<size_t, size_t>;
-    using iterator = std::vector<value_type>::iterator;
-    using const_iterator = std::vector<value_type>::const_iterator;
 
-    const_iterator begin() const { return m_ranges.begin(); }
-    const_iterator end() const { return m_ranges.end(); }
-    bool empty() const { return m_ranges.empty(); }
-    size_t size() const { return m_ranges.size(); }
+    // Iterates over the maximal ranges of indexes in the set, in order
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = IndexSet::value_type;
+        using difference_type = ptrdiff_t;
+        using pointer = value_type const*;
+        using reference = value_type const&;
+
+        value_type const& operator*() const noexcept { return m_range; }
+        value_type const* operator->() const noexcept { return &m_range; }
+        const_iterator& operator++();
+        const_iterator operator++(int) { auto ret = *this; ++*this; return ret; }
+
+        bool operator==(const_iterator const& other) const noexcept { return m_range == other.m_range; }
+        bool operator!=(const_iterator const& other) const noexcept { return m_range != other.m_range; }
+
+    private:
+        IndexSet const* m_set = nullptr;
+        // The index into m_ranges of the current range in range mode
+        size_t m_pos = 0;
+        value_type m_range{npos, npos};
+
+        const_iterator(IndexSet const& set, value_type range, size_t pos) : m_set(&set), m_pos(pos), m_range(range) { }
+        friend class IndexSet;
+    };
+    using iterator = const_iterator;
+
+    const_iterator begin() const;
+    const_iterator end() const { return {*this, {npos, npos}, 0}; }
+    bool empty() const noexcept { return m_bitmap ? m_bits.empty() : m_ranges.empty(); }
+    // Is the set currently stored as a bitmap rather than as ranges?
+    bool is_bitmap() const noexcept { return m_bitmap; }
+
+    // The number of ranges in the set. O(n) for bitmap sets.
+    size_t size() const;
+    // The number of indexes in the set
+    size_t count() const;
+
+    // Is the index in the set?
+    bool contains(size_t index) const;
 
     // Add an index to the set, doing nothing if it's already present
     void add(size_t index);
+    // Add the indexes [begin, end) to the set
+    void add_range(size_t begin, size_t end);
+    // Add every index in the other set to this one
+    void add(IndexSet const& other);
+
+    // Remove the indexes [begin, end) from the set, without shifting any
+    // following indexes
+    void remove_range(size_t begin, size_t end);
+    // Remove every index which is not also in the other set
+    void intersect(IndexSet const& other);
 
     // Remove all indexes from the set and then add a single range starting from
     // zero with the given length
@@ -45,18 +103,45 @@ public:
     // after that point back by one
     void insert_at(size_t index);
 
+    // Shift existing indexes at or after `index` back by `count`, without
+    // adding any
+    void shift_for_insert_at(size_t index, size_t count = 1);
+    // Remove the indexes [index, index + count), shifting the following
+    // indexes forward by `count`
+    void erase_at(size_t index, size_t count = 1);
+
     // Add an index which has had all of the ranges in the set before it removed
     void add_shifted(size_t index);
 
 private:
+    static const size_t npos = size_t(-1);
+
+    // Range mode: sorted, non-overlapping and non-adjacent ranges
     std::vector<value_type> m_ranges;
+    // Bitmap mode: bit i of word i / 64 is set if i is in the set. Trailing
+    // zero words are trimmed, so the set is empty iff m_bits is.
+    std::vector<uint64_t> m_bits;
+    bool m_bitmap = false;
+
+    using range_iterator = std::vector<value_type>::iterator;
 
     // Find the range which contains the index, or the first one after it if
     // none do
-    iterator find(size_t index);
+    range_iterator find(size_t index);
     // Insert the index before the given position, combining existing ranges as
     // applicable
-    void do_add(iterator pos, size_t index);
+    void do_add(range_iterator pos, size_t index);
+
+    // Switch to a bitmap if there are enough ranges that it would be smaller
+    void maybe_convert_to_bitmap();
+    // Switch back to ranges if there are few enough that they would be much
+    // smaller than the bitmap
+    void maybe_convert_to_ranges();
+    void set_bits(size_t begin, size_t end);
+    void clear_bits(size_t begin, size_t end);
+    void trim_bits();
+    // Get the range of set bits starting at or after `from`
+    value_type next_bit_range(size_t from) const;
 };
 } // namespace realm
 
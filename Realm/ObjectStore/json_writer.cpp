@@ -0,0 +1,317 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "json_writer.hpp"
+
+#include "object_schema.hpp"
+#include "object_store.hpp"
+#include "property.hpp"
+#include "results.hpp"
+#include "schema.hpp"
+#include "shared_realm.hpp"
+
+#include <realm/group.hpp>
+#include <realm/link_view.hpp>
+#include <realm/table.hpp>
+
+#include <algorithm>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+
+using namespace realm;
+
+namespace {
+// Output is passed on in chunks of about this size
+const size_t buffer_size = 64 * 1024;
+// The number of rows of the Results to look up at a time
+const size_t batch_size = 256;
+
+Schema const& schema_for(Realm& realm)
+{
+    if (!realm.config().schema) {
+        throw std::logic_error("Can't write JSON for a Realm without a schema.");
+    }
+    return *realm.config().schema;
+}
+} // anonymous namespace
+
+JSONWriter::JSONWriter(Realm& realm, size_t link_depth, OutputFunction output)
+: m_group(*realm.read_group())
+, m_schema(schema_for(realm))
+, m_link_depth(link_depth)
+, m_output(std::move(output))
+{
+    realm.verify_thread();
+    m_buffer.reserve(buffer_size);
+}
+
+void JSONWriter::write(Results& results)
+{
+    append('[');
+    if (results.get_mode() != Results::Mode::Empty) {
+        auto const& object_schema = object_schema_for(results.get_object_type());
+        TableRef table = ObjectStore::table_for_object_type(&m_group, object_schema.name);
+
+        auto const& projection = results.get_projection();
+        m_properties.clear();
+        for (auto const& prop : object_schema.properties) {
+            if (projection.empty() || std::binary_search(projection.begin(), projection.end(), prop.table_column)) {
+                m_properties.push_back(&prop);
+            }
+        }
+
+        m_rows.resize(batch_size);
+        bool first = true;
+        for (size_t start = 0;; start += batch_size) {
+            size_t count = results.get_source_indexes(start, batch_size, m_rows.data());
+            for (size_t i = 0; i < count; ++i) {
+                // Rows deleted since the Results was last evaluated are skipped
+                if (m_rows[i] == npos) {
+                    continue;
+                }
+                if (!first) {
+                    append(',');
+                }
+                first = false;
+                write_properties(m_properties, *table, m_rows[i], m_link_depth);
+            }
+            if (count < batch_size) {
+                break;
+            }
+        }
+    }
+    append(']');
+    flush();
+}
+
+ObjectSchema const& JSONWriter::object_schema_for(std::string const& object_type) const
+{
+    auto it = m_schema.find(object_type);
+    if (it == m_schema.end()) {
+        throw std::logic_error("Object type '" + object_type + "' is not in the Realm's schema.");
+    }
+    return *it;
+}
+
+void JSONWriter::write_object(ObjectSchema const& object_schema, Table const& table, size_t row, size_t depth)
+{
+    append('{');
+    bool first = true;
+    for (auto const& prop : object_schema.properties) {
+        if (!first) {
+            append(',');
+        }
+        first = false;
+        append_string(prop.name.data(), prop.name.size());
+        append(':');
+        write_property(prop, table, row, depth);
+    }
+    append('}');
+}
+
+void JSONWriter::write_properties(std::vector<Property const*> const& properties, Table const& table, size_t row, size_t depth)
+{
+    append('{');
+    bool first = true;
+    for (auto prop : properties) {
+        if (!first) {
+            append(',');
+        }
+        first = false;
+        append_string(prop->name.data(), prop->name.size());
+        append(':');
+        write_property(*prop, table, row, depth);
+    }
+    append('}');
+}
+
+void JSONWriter::write_link(ObjectSchema const& target_schema, Table const& target, size_t target_row, size_t depth)
+{
+    if (depth > 0) {
+        write_object(target_schema, target, target_row, depth - 1);
+    }
+    else if (auto primary_key = target_schema.primary_key_property()) {
+        write_property(*primary_key, target, target_row, 0);
+    }
+    else {
+        append("null", 4);
+    }
+}
+
+void JSONWriter::write_property(Property const& prop, Table const& table, size_t row, size_t depth)
+{
+    size_t col = prop.table_column;
+    if (prop.is_nullable && prop.type != PropertyTypeObject && table.is_null(col, row)) {
+        append("null", 4);
+        return;
+    }
+
+    char number[32];
+    switch (prop.type) {
+        case PropertyTypeInt:
+            append(number, snprintf(number, sizeof(number), "%" PRId64, table.get_int(col, row)));
+            break;
+        case PropertyTypeBool:
+            if (table.get_bool(col, row)) {
+                append("true", 4);
+            }
+            else {
+                append("false", 5);
+            }
+            break;
+        case PropertyTypeFloat:
+            append_double(table.get_float(col, row));
+            break;
+        case PropertyTypeDouble:
+            append_double(table.get_double(col, row));
+            break;
+        case PropertyTypeString: {
+            StringData value = table.get_string(col, row);
+            append_string(value.data(), value.size());
+            break;
+        }
+        case PropertyTypeData: {
+            BinaryData value = table.get_binary(col, row);
+            append_base64(value.data(), value.size());
+            break;
+        }
+        case PropertyTypeDate:
+            append(number, snprintf(number, sizeof(number), "%" PRId64,
+                                    int64_t(table.get_datetime(col, row).get_datetime())));
+            break;
+        case PropertyTypeAny:
+            append("null", 4);
+            break;
+        case PropertyTypeObject: {
+            if (table.is_null_link(col, row)) {
+                append("null", 4);
+                break;
+            }
+            ConstTableRef target = table.get_link_target(col);
+            write_link(object_schema_for(prop.object_type), *target, table.get_link(col, row), depth);
+            break;
+        }
+        case PropertyTypeArray: {
+            ConstLinkViewRef link_view = table.get_linklist(col, row);
+            ConstTableRef target = table.get_link_target(col);
+            auto const& target_schema = object_schema_for(prop.object_type);
+            append('[');
+            for (size_t i = 0, size = link_view->size(); i < size; ++i) {
+                if (i > 0) {
+                    append(',');
+                }
+                write_link(target_schema, *target, link_view->get(i).get_index(), depth);
+            }
+            append(']');
+            break;
+        }
+    }
+}
+
+void JSONWriter::flush()
+{
+    if (!m_buffer.empty()) {
+        m_output(m_buffer.data(), m_buffer.size());
+        m_buffer.clear();
+    }
+}
+
+void JSONWriter::append(const char* data, size_t size)
+{
+    if (m_buffer.size() + size > buffer_size) {
+        flush();
+    }
+    m_buffer.append(data, size);
+}
+
+void JSONWriter::append(char c)
+{
+    if (m_buffer.size() == buffer_size) {
+        flush();
+    }
+    m_buffer.push_back(c);
+}
+
+void JSONWriter::append_string(const char* data, size_t size)
+{
+    static const char hex[] = "0123456789abcdef";
+
+    append('"');
+    // Runs of characters which don't need escaping are copied in one go
+    size_t run_start = 0;
+    for (size_t i = 0; i < size; ++i) {
+        unsigned char c = data[i];
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        append(data + run_start, i - run_start);
+        run_start = i + 1;
+        switch (c) {
+            case '"':  append("\\\"", 2); break;
+            case '\\': append("\\\\", 2); break;
+            case '\n': append("\\n", 2); break;
+            case '\r': append("\\r", 2); break;
+            case '\t': append("\\t", 2); break;
+            default: {
+                char escape[] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xf]};
+                append(escape, sizeof(escape));
+            }
+        }
+    }
+    append(data + run_start, size - run_start);
+    append('"');
+}
+
+void JSONWriter::append_base64(const char* data, size_t size)
+{
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    append('"');
+    auto bytes = reinterpret_cast<const unsigned char*>(data);
+    size_t i = 0;
+    for (; i + 3 <= size; i += 3) {
+        uint32_t n = bytes[i] << 16 | bytes[i + 1] << 8 | bytes[i + 2];
+        char out[] = {alphabet[n >> 18], alphabet[(n >> 12) & 63], alphabet[(n >> 6) & 63], alphabet[n & 63]};
+        append(out, 4);
+    }
+    if (size - i == 1) {
+        uint32_t n = bytes[i] << 16;
+        char out[] = {alphabet[n >> 18], alphabet[(n >> 12) & 63], '=', '='};
+        append(out, 4);
+    }
+    else if (size - i == 2) {
+        uint32_t n = bytes[i] << 16 | bytes[i + 1] << 8;
+        char out[] = {alphabet[n >> 18], alphabet[(n >> 12) & 63], alphabet[(n >> 6) & 63], '='};
+        append(out, 4);
+    }
+    append('"');
+}
+
+void JSONWriter::append_double(double value)
+{
+    // JSON has no representation for NaN or infinity
+    if (!std::isfinite(value)) {
+        append("null", 4);
+        return;
+    }
+    // 17 significant digits are enough for any double to round-trip
+    char number[32];
+    append(number, snprintf(number, sizeof(number), "%.17g", value));
+}
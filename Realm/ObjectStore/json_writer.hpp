@@ -0,0 +1,85 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef REALM_JSON_WRITER_HPP
+#define REALM_JSON_WRITER_HPP
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace realm {
+class Group;
+class ObjectSchema;
+class Realm;
+class Results;
+class Schema;
+class Table;
+struct Property;
+
+// Serializes objects to UTF-8 JSON by reading their properties directly from
+// their tables, without creating accessors or intermediate values for them.
+// Output is collected in a fixed-size buffer which is handed to the output
+// function each time it fills, so the whole document is never held in memory.
+//
+// Each object is written as a JSON object keyed by property name. Dates are
+// written as seconds since 1970, binary data as base64 strings, and non-finite
+// floating point values and mixed properties as null. Links and lists are
+// followed to `link_depth` levels of nesting; beyond that they are written as
+// the linked objects' primary key values, or null for types without one.
+// Only the projected properties of the top-level objects are written for
+// Results with a projection.
+class JSONWriter {
+public:
+    // Called with each chunk of output. May throw to abandon the write, in
+    // which case the exception propagates out of write().
+    using OutputFunction = std::function<void (const char* data, size_t size)>;
+
+    // The Realm must have a schema, and the writer must only be used on the
+    // Realm's thread
+    JSONWriter(Realm& realm, size_t link_depth, OutputFunction output);
+
+    // Write the objects in the Results as a JSON array and flush the output
+    void write(Results& results);
+
+private:
+    Group& m_group;
+    Schema const& m_schema;
+    size_t m_link_depth;
+    OutputFunction m_output;
+    std::string m_buffer;
+    std::vector<size_t> m_rows;
+    std::vector<Property const*> m_properties;
+
+    void flush();
+    void append(const char* data, size_t size);
+    void append(char c);
+    void append_string(const char* data, size_t size);
+    void append_base64(const char* data, size_t size);
+    void append_double(double value);
+
+    void write_object(ObjectSchema const& object_schema, Table const& table, size_t row, size_t depth);
+    void write_properties(std::vector<Property const*> const& properties, Table const& table, size_t row, size_t depth);
+    void write_property(Property const& prop, Table const& table, size_t row, size_t depth);
+    void write_link(ObjectSchema const& target_schema, Table const& target, size_t target_row, size_t depth);
+    ObjectSchema const& object_schema_for(std::string const& object_type) const;
+};
+} // namespace realm
+
+#endif /* REALM_JSON_WRITER_HPP */
@@ -0,0 +1,302 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+
+#include "object_copier.hpp"
+
+#include "object_schema.hpp"
+#include "object_store.hpp"
+#include "property.hpp"
+#include "schema.hpp"
+
+#include <realm/link_view.hpp>
+#include <realm/table.hpp>
+
+#include <stdexcept>
+#include <unordered_map>
+
+using namespace realm;
+
+namespace {
+Schema const& schema_for(Realm& realm)
+{
+    if (!realm.config().schema) {
+        throw std::logic_error("Can't copy objects between Realms without a schema.");
+    }
+    return *realm.config().schema;
+}
+
+// A type being copied, with its tables and the destination column of each
+// of its properties in the source
+struct CopiedType {
+    ObjectSchema const* source_schema;
+    ConstTableRef source;
+    TableRef destination;
+    std::vector<size_t> destination_columns;
+    // The index in the destination table of the copy of the first source row
+    size_t first_row = 0;
+};
+
+// Check that the type has the same properties in both Realms, and find the
+// destination column for each source property
+void map_properties(ObjectSchema const& source, ObjectSchema const& destination, CopiedType& type)
+{
+    auto mismatch = [&](std::string const& message) {
+        throw std::logic_error("Objects of type '" + source.name + "' can't be copied: " + message);
+    };
+
+    if (source.properties.size() != destination.properties.size()) {
+        mismatch("the types have different numbers of properties in the two Realms.");
+    }
+    if (source.primary_key != destination.primary_key) {
+        mismatch("the types have different primary keys in the two Realms.");
+    }
+    type.destination_columns.resize(source.properties.size());
+    for (size_t i = 0; i < source.properties.size(); ++i) {
+        auto const& prop = source.properties[i];
+        auto target = destination.property_for_name(prop.name);
+        if (!target) {
+            mismatch("property '" + prop.name + "' is missing from the destination Realm.");
+        }
+        if (target->type != prop.type || target->object_type != prop.object_type
+            || target->is_nullable != prop.is_nullable) {
+            mismatch("property '" + prop.name + "' has a different type in the destination Realm.");
+        }
+        type.destination_columns[i] = target->table_column;
+    }
+}
+
+// Check that no source row has the same primary key as an existing
+// destination row
+void check_primary_keys(CopiedType const& type)
+{
+    auto primary = type.source_schema->primary_key_property();
+    if (!primary || type.destination->is_empty()) {
+        return;
+    }
+
+    size_t src_col = primary->table_column;
+    size_t dst_col = type.destination_columns[primary - &type.source_schema->properties[0]];
+    auto& source = *type.source;
+    auto& destination = *type.destination;
+    for (size_t row = 0, size = source.size(); row < size; ++row) {
+        size_t existing;
+        if (primary->is_nullable && source.is_null(src_col, row)) {
+            existing = destination.find_first_null(dst_col);
+        }
+        else if (primary->type == PropertyTypeString) {
+            existing = destination.find_first_string(dst_col, source.get_string(src_col, row));
+        }
+        else {
+            existing = destination.find_first_int(dst_col, source.get_int(src_col, row));
+        }
+        if (existing != not_found) {
+            throw std::logic_error("Objects of type '" + type.source_schema->name +
+                                   "' can't be copied: an object with the same value for primary key property '" +
+                                   primary->name + "' already exists in the destination Realm.");
+        }
+    }
+}
+
+// Copy the values of one property for every row of the type
+void copy_column(Property const& prop, size_t dst_col, CopiedType const& type, CopiedType const* target)
+{
+    auto& source = *type.source;
+    auto& destination = *type.destination;
+    size_t src_col = prop.table_column;
+    size_t first = type.first_row;
+    size_t size = source.size();
+
+    // New rows already have null values, and null links and empty lists
+    auto skip = [&](size_t row) {
+        return prop.is_nullable && prop.type != PropertyTypeObject && source.is_null(src_col, row);
+    };
+
+    switch (prop.type) {
+        case PropertyTypeInt:
+            for (size_t row = 0; row < size; ++row) {
+                if (!skip(row))
+                    destination.set_int(dst_col, first + row, source.get_int(src_col, row));
+            }
+            break;
+        case PropertyTypeBool:
+            for (size_t row = 0; row < size; ++row) {
+                if (!skip(row))
+                    destination.set_bool(dst_col, first + row, source.get_bool(src_col, row));
+            }
+            break;
+        case PropertyTypeFloat:
+            for (size_t row = 0; row < size; ++row) {
+                if (!skip(row))
+                    destination.set_float(dst_col, first + row, source.get_float(src_col, row));
+            }
+            break;
+        case PropertyTypeDouble:
+            for (size_t row = 0; row < size; ++row) {
+                if (!skip(row))
+                    destination.set_double(dst_col, first + row, source.get_double(src_col, row));
+            }
+            break;
+        case PropertyTypeString:
+            for (size_t row = 0; row < size; ++row) {
+                if (!skip(row))
+                    destination.set_string(dst_col, first + row, source.get_string(src_col, row));
+            }
+            break;
+        case PropertyTypeData:
+            for (size_t row = 0; row < size; ++row) {
+                if (!skip(row))
+                    destination.set_binary(dst_col, first + row, source.get_binary(src_col, row));
+            }
+            break;
+        case PropertyTypeDate:
+            for (size_t row = 0; row < size; ++row) {
+                if (!skip(row))
+                    destination.set_datetime(dst_col, first + row, source.get_datetime(src_col, row));
+            }
+            break;
+        case PropertyTypeAny:
+            for (size_t row = 0; row < size; ++row) {
+                // Subtables can't be stored in mixed properties by the
+                // bindings, so any which are present are left empty
+                Mixed value = source.get_mixed(src_col, row);
+                if (value.get_type() != type_Table)
+                    destination.set_mixed(dst_col, first + row, value);
+            }
+            break;
+        case PropertyTypeObject:
+            for (size_t row = 0; row < size; ++row) {
+                if (!source.is_null_link(src_col, row))
+                    destination.set_link(dst_col, first + row, target->first_row + source.get_link(src_col, row));
+            }
+            break;
+        case PropertyTypeArray:
+            for (size_t row = 0; row < size; ++row) {
+                size_t count = source.get_link_count(src_col, row);
+                if (count == 0)
+                    continue;
+                auto src_list = source.get_linklist(src_col, row);
+                auto dst_list = destination.get_linklist(dst_col, first + row);
+                for (size_t i = 0; i < count; ++i) {
+                    dst_list->add(target->first_row + src_list->get(i).get_index());
+                }
+            }
+            break;
+    }
+}
+} // anonymous namespace
+
+ObjectCopier::ObjectCopier(SharedRealm source, SharedRealm destination)
+: m_source(std::move(source))
+, m_destination(std::move(destination))
+{
+    m_source->verify_thread();
+    m_destination->verify_thread();
+    if (m_source->config().path == m_destination->config().path) {
+        throw std::logic_error("Objects can't be copied into the Realm they are read from.");
+    }
+}
+
+size_t ObjectCopier::copy(std::vector<std::string> object_types)
+{
+    m_source->verify_thread();
+    m_destination->verify_thread();
+    auto const& source_schema = schema_for(*m_source);
+    auto const& destination_schema = schema_for(*m_destination);
+    if (object_types.empty()) {
+        for (auto const& object_schema : source_schema) {
+            object_types.push_back(object_schema.name);
+        }
+    }
+
+    bool began = !m_destination->is_in_transaction();
+    if (began) {
+        m_destination->begin_transaction();
+    }
+    try {
+        std::vector<CopiedType> types(object_types.size());
+        std::unordered_map<std::string, size_t> type_indexes;
+        for (size_t i = 0; i < object_types.size(); ++i) {
+            auto const& name = object_types[i];
+            auto source = source_schema.find(name);
+            auto destination = destination_schema.find(name);
+            if (source == source_schema.end() || destination == destination_schema.end()) {
+                throw std::logic_error("Object type '" + name + "' is not in the schema of both Realms.");
+            }
+            if (!type_indexes.emplace(name, i).second) {
+                throw std::logic_error("Object type '" + name + "' is listed more than once.");
+            }
+
+            auto& type = types[i];
+            type.source_schema = &*source;
+            map_properties(*source, *destination, type);
+            const Group* source_group = m_source->read_group();
+            type.source = ObjectStore::table_for_object_type(source_group, name);
+            type.destination = ObjectStore::table_for_object_type(m_destination->read_group(), name);
+        }
+
+        // Every link must point at a type whose rows are being copied, as
+        // that's the only way to know which row the copy of the link targets
+        std::vector<std::vector<CopiedType const*>> targets(types.size());
+        for (size_t i = 0; i < types.size(); ++i) {
+            for (auto const& prop : types[i].source_schema->properties) {
+                CopiedType const* target = nullptr;
+                if (prop.type == PropertyTypeObject || prop.type == PropertyTypeArray) {
+                    auto it = type_indexes.find(prop.object_type);
+                    if (it == type_indexes.end()) {
+                        throw std::logic_error("Objects of type '" + object_types[i] + "' can't be copied: property '" +
+                                               prop.name + "' links to '" + prop.object_type +
+                                               "', which is not being copied.");
+                    }
+                    target = &types[it->second];
+                }
+                targets[i].push_back(target);
+            }
+            check_primary_keys(types[i]);
+        }
+
+        // Add all of the rows up front so that the index of the copy of every
+        // link target is known, then fill them in a column at a time
+        size_t count = 0;
+        for (auto& type : types) {
+            size_t size = type.source->size();
+            type.first_row = type.destination->size();
+            if (size) {
+                type.destination->add_empty_row(size);
+            }
+            count += size;
+        }
+        for (size_t i = 0; i < types.size(); ++i) {
+            auto const& properties = types[i].source_schema->properties;
+            for (size_t j = 0; j < properties.size(); ++j) {
+                copy_column(properties[j], types[i].destination_columns[j], types[i], targets[i][j]);
+            }
+        }
+
+        if (began) {
+            m_destination->commit_transaction();
+        }
+        return count;
+    }
+    catch (...) {
+        if (began && m_destination->is_in_transaction()) {
+            m_destination->cancel_transaction();
+        }
+        throw;
+    }
+}
@@ -0,0 +1,59 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef REALM_OBJECT_COPIER_HPP
+#define REALM_OBJECT_COPIER_HPP
+
+#include "shared_realm.hpp"
+
+#include <string>
+#include <vector>
+
+namespace realm {
+// Copies all of the objects of some types from one Realm to another a column
+// at a time, reading and writing the tables directly rather than creating and
+// validating each object. Links between the copied objects are remapped to
+// the new copies of their targets.
+//
+// Each type must have the same properties with the same types in both Realms,
+// although they may be in a different order. Every type linked to by a copied
+// type must also be copied. The copies are added to any objects already in the
+// destination, and no copied object may have the same primary key as an
+// existing one.
+class ObjectCopier {
+public:
+    // Both Realms must have a schema and be used on the current thread
+    ObjectCopier(SharedRealm source, SharedRealm destination);
+
+    // Copy every object of the given types, or of every type in the source's
+    // schema if none are given, from the source's current read transaction.
+    // The copies are written in the destination's current write transaction,
+    // or in a single new one which is committed if it isn't in one. The types
+    // and primary keys are validated before any objects are written. Returns
+    // the number of objects copied.
+    // Throws std::logic_error if the types can't be copied
+    size_t copy(std::vector<std::string> object_types = {});
+
+private:
+    SharedRealm m_source;
+    SharedRealm m_destination;
+};
+} // namespace realm
+
+#endif // REALM_OBJECT_COPIER_HPP
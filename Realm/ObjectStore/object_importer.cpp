@@ -0,0 +1,693 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "object_importer.hpp"
+
+#include "object_schema.hpp"
+#include "object_store.hpp"
+#include "property.hpp"
+
+#include <realm/table.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <unordered_map>
+#include <vector>
+
+using namespace realm;
+
+namespace {
+// A buffered reader of the input which tracks the current line number
+class Input {
+public:
+    static const int eof = -1;
+
+    Input(ObjectImporter::ReadFunction read) : m_read(std::move(read)), m_buffer(64 * 1024) { }
+
+    int peek()
+    {
+        if (m_pos == m_end && !fill()) {
+            return eof;
+        }
+        return static_cast<unsigned char>(m_buffer[m_pos]);
+    }
+
+    int get()
+    {
+        int c = peek();
+        if (c != eof) {
+            ++m_pos;
+            if (c == '\n') {
+                ++m_line;
+            }
+        }
+        return c;
+    }
+
+    size_t line() const noexcept { return m_line; }
+
+private:
+    ObjectImporter::ReadFunction m_read;
+    std::vector<char> m_buffer;
+    size_t m_pos = 0;
+    size_t m_end = 0;
+    size_t m_line = 1;
+
+    bool fill()
+    {
+        m_pos = 0;
+        m_end = m_read(m_buffer.data(), m_buffer.size());
+        return m_end != 0;
+    }
+};
+
+// A field value read from the input, before conversion to the property's type
+struct Value {
+    enum class Kind {
+        Missing,
+        Null,
+        // A JSON string
+        String,
+        // A JSON number, stored as its text
+        Number,
+        // A JSON boolean
+        Bool,
+        // A CSV field, which takes whatever type the property has
+        Text
+    };
+
+    Kind kind = Kind::Missing;
+    std::string text;
+    bool bool_value = false;
+
+    // The converted value, filled in when the row is validated
+    int64_t int_value = 0;
+    double double_value = 0;
+};
+
+bool is_valid_utf8(std::string const& str)
+{
+    for (size_t i = 0; i < str.size(); ) {
+        unsigned char c = str[i];
+        size_t length = c < 0x80 ? 1 : (c >> 5) == 0x6 ? 2 : (c >> 4) == 0xE ? 3 : (c >> 3) == 0x1E ? 4 : 0;
+        if (length == 0 || i + length > str.size()) {
+            return false;
+        }
+        for (size_t j = 1; j < length; ++j) {
+            if ((static_cast<unsigned char>(str[i + j]) >> 6) != 0x2) {
+                return false;
+            }
+        }
+        i += length;
+    }
+    return true;
+}
+
+// Writes the values read for each object to a new row, managing the write
+// transactions which the rows are written in
+class RowWriter {
+public:
+    RowWriter(SharedRealm realm, std::string const& object_type, size_t objects_per_transaction)
+    : m_realm(std::move(realm))
+    , m_object_schema(m_realm->read_group(), object_type)
+    , m_objects_per_transaction(objects_per_transaction)
+    , m_values(m_object_schema.properties.size())
+    {
+        for (size_t i = 0; i < m_object_schema.properties.size(); ++i) {
+            m_property_indexes[m_object_schema.properties[i].name] = i;
+        }
+    }
+
+    ~RowWriter()
+    {
+        // Discard the objects from the current transaction if an error
+        // occurred before they were committed
+        if (m_realm->is_in_transaction()) {
+            m_realm->cancel_transaction();
+        }
+    }
+
+    // Get the index of the property which a field with the given name should
+    // be stored in
+    size_t property_index(std::string const& name, size_t line) const
+    {
+        auto it = m_property_indexes.find(name);
+        if (it == m_property_indexes.end()) {
+            throw ImportException("'" + name + "' is not a property of '" + m_object_schema.name + "'", line);
+        }
+
+        auto& property = m_object_schema.properties[it->second];
+        switch (property.type) {
+            case PropertyTypeData:
+            case PropertyTypeAny:
+            case PropertyTypeObject:
+            case PropertyTypeArray:
+                throw ImportException(std::string("Property '") + name + "' of type '" +
+                                      string_for_property_type(property.type) + "' can not be imported", line);
+            default:
+                return it->second;
+        }
+    }
+
+    Value& value(size_t property_index) { return m_values[property_index]; }
+
+    // Write the values which have been set to a new row and reset them
+    void write_row(size_t line)
+    {
+        if (!m_realm->is_in_transaction()) {
+            m_realm->begin_transaction();
+            m_table = ObjectStore::table_for_object_type(m_realm->read_group(), m_object_schema.name);
+        }
+
+        // Validate all of the values before adding the row, so that an
+        // invalid object doesn't leave behind a partially filled in one
+        for (size_t i = 0; i < m_values.size(); ++i) {
+            validate(m_object_schema.properties[i], m_values[i], line);
+        }
+        if (auto primary = m_object_schema.primary_key_property()) {
+            check_unique(*primary, m_values[primary - &m_object_schema.properties[0]], line);
+        }
+
+        size_t row = m_table->add_empty_row();
+        for (size_t i = 0; i < m_values.size(); ++i) {
+            set(m_object_schema.properties[i], row, m_values[i]);
+            m_values[i].kind = Value::Kind::Missing;
+        }
+
+        ++m_count;
+        if (++m_objects_in_transaction == m_objects_per_transaction) {
+            commit();
+        }
+    }
+
+    size_t finish()
+    {
+        commit();
+        return m_count;
+    }
+
+private:
+    SharedRealm m_realm;
+    ObjectSchema m_object_schema;
+    size_t m_objects_per_transaction;
+    TableRef m_table;
+
+    std::unordered_map<std::string, size_t> m_property_indexes;
+    std::vector<Value> m_values;
+
+    size_t m_count = 0;
+    size_t m_objects_in_transaction = 0;
+
+    void commit()
+    {
+        if (m_realm->is_in_transaction()) {
+            m_realm->commit_transaction();
+        }
+        m_objects_in_transaction = 0;
+    }
+
+    [[noreturn]] void invalid_value(Property const& property, Value const& value, size_t line) const
+    {
+        throw ImportException("Invalid value '" + value.text + "' for " + string_for_property_type(property.type) +
+                              " property '" + property.name + "'", line);
+    }
+
+    void validate(Property const& property, Value& value, size_t line) const
+    {
+        using Kind = Value::Kind;
+        switch (value.kind) {
+            case Kind::Missing:
+                if (property.is_nullable || property.type == PropertyTypeObject || property.type == PropertyTypeArray) {
+                    value.kind = Kind::Null;
+                    return;
+                }
+                throw ImportException("Missing value for required property '" + property.name + "'", line);
+            case Kind::Null:
+                if (property.is_nullable) {
+                    return;
+                }
+                throw ImportException("Invalid null value for required property '" + property.name + "'", line);
+            default:
+                break;
+        }
+
+        bool is_number = value.kind == Kind::Number || value.kind == Kind::Text;
+        switch (property.type) {
+            case PropertyTypeInt: {
+                if (!is_number) {
+                    invalid_value(property, value, line);
+                }
+                char* end;
+                errno = 0;
+                value.int_value = std::strtoll(value.text.c_str(), &end, 10);
+                if (value.text.empty() || *end || errno == ERANGE) {
+                    invalid_value(property, value, line);
+                }
+                break;
+            }
+            case PropertyTypeFloat:
+            case PropertyTypeDouble:
+            case PropertyTypeDate: {
+                if (!is_number) {
+                    invalid_value(property, value, line);
+                }
+                char* end;
+                value.double_value = std::strtod(value.text.c_str(), &end);
+                if (value.text.empty() || *end) {
+                    invalid_value(property, value, line);
+                }
+                break;
+            }
+            case PropertyTypeBool:
+                if (value.kind == Kind::Text) {
+                    if (value.text == "true" || value.text == "1") {
+                        value.bool_value = true;
+                    }
+                    else if (value.text == "false" || value.text == "0") {
+                        value.bool_value = false;
+                    }
+                    else {
+                        invalid_value(property, value, line);
+                    }
+                }
+                else if (value.kind != Kind::Bool) {
+                    invalid_value(property, value, line);
+                }
+                break;
+            case PropertyTypeString:
+                if (value.kind != Kind::String && value.kind != Kind::Text) {
+                    invalid_value(property, value, line);
+                }
+                if (!is_valid_utf8(value.text)) {
+                    throw ImportException("Invalid UTF-8 in value for property '" + property.name + "'", line);
+                }
+                break;
+            default:
+                // Fields for other types are rejected when they're mapped to
+                // properties, so they can only ever be missing
+                REALM_UNREACHABLE();
+        }
+    }
+
+    void check_unique(Property const& property, Value const& value, size_t line) const
+    {
+        size_t col = property.table_column;
+        size_t existing;
+        if (value.kind == Value::Kind::Null) {
+            existing = m_table->find_first_null(col);
+        }
+        else if (property.type == PropertyTypeString) {
+            existing = m_table->find_first_string(col, value.text);
+        }
+        else {
+            existing = m_table->find_first_int(col, value.int_value);
+        }
+        if (existing != not_found) {
+            throw ImportException("Duplicate value for primary key property '" + property.name + "'", line);
+        }
+    }
+
+    void set(Property const& property, size_t row, Value const& value)
+    {
+        size_t col = property.table_column;
+        if (value.kind == Value::Kind::Null) {
+            // New rows already have null values, and an empty list or null
+            // link for link properties
+            return;
+        }
+
+        switch (property.type) {
+            case PropertyTypeInt:
+                m_table->set_int(col, row, value.int_value);
+                break;
+            case PropertyTypeBool:
+                m_table->set_bool(col, row, value.bool_value);
+                break;
+            case PropertyTypeFloat:
+                m_table->set_float(col, row, static_cast<float>(value.double_value));
+                break;
+            case PropertyTypeDouble:
+                m_table->set_double(col, row, value.double_value);
+                break;
+            case PropertyTypeString:
+                m_table->set_string(col, row, value.text);
+                break;
+            case PropertyTypeDate:
+                m_table->set_datetime(col, row, DateTime(static_cast<int64_t>(value.double_value)));
+                break;
+            default:
+                REALM_UNREACHABLE();
+        }
+    }
+};
+
+void skip_whitespace(Input& input)
+{
+    int c;
+    while ((c = input.peek()) == ' ' || c == '\t' || c == '\n' || c == '\r') {
+        input.get();
+    }
+}
+
+[[noreturn]] void unexpected(Input& input, const char* expected)
+{
+    int c = input.peek();
+    throw ImportException(std::string("Expected ") + expected + " but found " +
+                          (c == Input::eof ? std::string("end of input") : "'" + std::string(1, static_cast<char>(c)) + "'"),
+                          input.line());
+}
+
+void expect(Input& input, char c, const char* description)
+{
+    if (input.peek() != c) {
+        unexpected(input, description);
+    }
+    input.get();
+}
+
+void expect_literal(Input& input, const char* literal)
+{
+    for (const char* p = literal; *p; ++p) {
+        if (input.peek() != *p) {
+            unexpected(input, "a JSON value");
+        }
+        input.get();
+    }
+}
+
+void append_utf8(std::string& out, uint32_t code_point)
+{
+    if (code_point < 0x80) {
+        out += static_cast<char>(code_point);
+    }
+    else if (code_point < 0x800) {
+        out += static_cast<char>(0xC0 | (code_point >> 6));
+        out += static_cast<char>(0x80 | (code_point & 0x3F));
+    }
+    else if (code_point < 0x10000) {
+        out += static_cast<char>(0xE0 | (code_point >> 12));
+        out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code_point & 0x3F));
+    }
+    else {
+        out += static_cast<char>(0xF0 | (code_point >> 18));
+        out += static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code_point & 0x3F));
+    }
+}
+
+uint32_t read_hex4(Input& input)
+{
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i) {
+        int c = input.peek();
+        int digit = c >= '0' && c <= '9' ? c - '0'
+                  : c >= 'a' && c <= 'f' ? c - 'a' + 10
+                  : c >= 'A' && c <= 'F' ? c - 'A' + 10
+                  : -1;
+        if (digit < 0) {
+            unexpected(input, "a hexadecimal digit");
+        }
+        input.get();
+        value = value * 16 + digit;
+    }
+    return value;
+}
+
+void read_json_string(Input& input, std::string& out)
+{
+    out.clear();
+    expect(input, '"', "a string");
+    while (true) {
+        int c = input.get();
+        if (c == Input::eof) {
+            throw ImportException("Unterminated string", input.line());
+        }
+        if (c == '"') {
+            return;
+        }
+        if (c < 0x20) {
+            throw ImportException("Unescaped control character in string", input.line());
+        }
+        if (c != '\\') {
+            out += static_cast<char>(c);
+            continue;
+        }
+
+        switch (c = input.get()) {
+            case '"': case '\\': case '/': out += static_cast<char>(c); break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u': {
+                uint32_t code_point = read_hex4(input);
+                if (code_point >= 0xD800 && code_point < 0xDC00) {
+                    expect(input, '\\', "a low surrogate escape");
+                    expect(input, 'u', "a low surrogate escape");
+                    uint32_t low = read_hex4(input);
+                    if (low < 0xDC00 || low >= 0xE000) {
+                        throw ImportException("Invalid low surrogate in string", input.line());
+                    }
+                    code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+                }
+                else if (code_point >= 0xDC00 && code_point < 0xE000) {
+                    throw ImportException("Unpaired low surrogate in string", input.line());
+                }
+                append_utf8(out, code_point);
+                break;
+            }
+            default:
+                throw ImportException("Invalid escape sequence in string", input.line());
+        }
+    }
+}
+
+void read_json_value(Input& input, Value& value)
+{
+    switch (int c = input.peek()) {
+        case '"':
+            read_json_string(input, value.text);
+            value.kind = Value::Kind::String;
+            break;
+        case 't':
+            expect_literal(input, "true");
+            value.kind = Value::Kind::Bool;
+            value.bool_value = true;
+            value.text = "true";
+            break;
+        case 'f':
+            expect_literal(input, "false");
+            value.kind = Value::Kind::Bool;
+            value.bool_value = false;
+            value.text = "false";
+            break;
+        case 'n':
+            expect_literal(input, "null");
+            value.kind = Value::Kind::Null;
+            break;
+        case '{':
+        case '[':
+            throw ImportException("Nested objects and arrays can not be imported", input.line());
+        default:
+            if (c != '-' && (c < '0' || c > '9')) {
+                unexpected(input, "a JSON value");
+            }
+            // The number's syntax is checked when it's converted to the
+            // property's type
+            value.text.clear();
+            while ((c = input.peek()) == '-' || c == '+' || c == '.' || c == 'e' || c == 'E' || (c >= '0' && c <= '9')) {
+                value.text += static_cast<char>(input.get());
+            }
+            value.kind = Value::Kind::Number;
+            break;
+    }
+}
+
+void import_json(Input& input, RowWriter& writer)
+{
+    std::string key;
+
+    skip_whitespace(input);
+    expect(input, '[', "'['");
+    skip_whitespace(input);
+    if (input.peek() == ']') {
+        input.get();
+    }
+    else {
+        while (true) {
+            size_t line = input.line();
+            expect(input, '{', "an object");
+            skip_whitespace(input);
+            if (input.peek() == '}') {
+                input.get();
+            }
+            else {
+                while (true) {
+                    skip_whitespace(input);
+                    read_json_string(input, key);
+                    Value& value = writer.value(writer.property_index(key, input.line()));
+                    if (value.kind != Value::Kind::Missing) {
+                        throw ImportException("Duplicate key '" + key + "'", input.line());
+                    }
+                    skip_whitespace(input);
+                    expect(input, ':', "':'");
+                    skip_whitespace(input);
+                    read_json_value(input, value);
+                    skip_whitespace(input);
+                    if (input.peek() == '}') {
+                        input.get();
+                        break;
+                    }
+                    expect(input, ',', "',' or '}'");
+                }
+            }
+            writer.write_row(line);
+
+            skip_whitespace(input);
+            if (input.peek() == ']') {
+                input.get();
+                break;
+            }
+            expect(input, ',', "',' or ']'");
+            skip_whitespace(input);
+        }
+    }
+
+    skip_whitespace(input);
+    if (input.peek() != Input::eof) {
+        unexpected(input, "end of input");
+    }
+}
+
+// Read a single CSV field into `out`, returning the character which ended it:
+// ',', '\n' or eof
+int read_csv_field(Input& input, std::string& out, bool& quoted)
+{
+    out.clear();
+    quoted = input.peek() == '"';
+    int c;
+    if (quoted) {
+        input.get();
+        while (true) {
+            c = input.get();
+            if (c == Input::eof) {
+                throw ImportException("Unterminated quoted field", input.line());
+            }
+            if (c == '"') {
+                if (input.peek() != '"') {
+                    break;
+                }
+                input.get();
+            }
+            out += static_cast<char>(c);
+        }
+        c = input.get();
+        if (c == '\r' && input.peek() == '\n') {
+            c = input.get();
+        }
+        if (c != ',' && c != '\n' && c != Input::eof) {
+            throw ImportException("Unexpected character after quoted field", input.line());
+        }
+        return c;
+    }
+
+    while ((c = input.get()) != ',' && c != '\n' && c != Input::eof) {
+        if (c == '\r' && input.peek() == '\n') {
+            continue;
+        }
+        out += static_cast<char>(c);
+    }
+    return c;
+}
+
+void import_csv(Input& input, RowWriter& writer)
+{
+    // Map the header's fields to properties
+    std::vector<size_t> properties;
+    std::string name;
+    bool quoted;
+    int terminator;
+    do {
+        terminator = read_csv_field(input, name, quoted);
+        if (terminator == Input::eof && properties.empty() && name.empty() && !quoted) {
+            return; // empty input
+        }
+        size_t property = writer.property_index(name, 1);
+        if (std::find(properties.begin(), properties.end(), property) != properties.end()) {
+            throw ImportException("Duplicate field '" + name + "'", 1);
+        }
+        properties.push_back(property);
+    } while (terminator == ',');
+
+    while (input.peek() != Input::eof) {
+        size_t line = input.line();
+        // Skip blank lines
+        if (input.peek() == '\n' || input.peek() == '\r') {
+            input.get();
+            continue;
+        }
+
+        size_t field = 0;
+        do {
+            if (field == properties.size()) {
+                throw ImportException("Expected " + std::to_string(properties.size()) + " fields but found more", line);
+            }
+            Value& value = writer.value(properties[field++]);
+            terminator = read_csv_field(input, value.text, quoted);
+            value.kind = !quoted && value.text.empty() ? Value::Kind::Null : Value::Kind::Text;
+        } while (terminator == ',');
+
+        if (field != properties.size()) {
+            throw ImportException("Expected " + std::to_string(properties.size()) + " fields but found " +
+                                  std::to_string(field), line);
+        }
+        writer.write_row(line);
+    }
+}
+} // anonymous namespace
+
+ObjectImporter::ObjectImporter(SharedRealm realm, std::string object_type, Format format)
+: m_realm(std::move(realm))
+, m_object_type(std::move(object_type))
+, m_format(format)
+{
+}
+
+size_t ObjectImporter::import(ReadFunction read, size_t objects_per_transaction)
+{
+    m_realm->verify_thread();
+    if (m_realm->is_in_transaction()) {
+        throw InvalidTransactionException("Can't import objects within a write transaction");
+    }
+
+    Input input(std::move(read));
+    RowWriter writer(m_realm, m_object_type, std::max<size_t>(objects_per_transaction, 1));
+    switch (m_format) {
+        case Format::JSON:
+            import_json(input, writer);
+            break;
+        case Format::CSV:
+            import_csv(input, writer);
+            break;
+    }
+    return writer.finish();
+}
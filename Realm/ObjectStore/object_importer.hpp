@@ -0,0 +1,78 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef REALM_OBJECT_IMPORTER_HPP
+#define REALM_OBJECT_IMPORTER_HPP
+
+#include "shared_realm.hpp"
+
+#include <functional>
+#include <stdexcept>
+#include <string>
+
+namespace realm {
+// Reads objects of a single type from JSON or CSV and writes them directly to
+// the type's table, without building an intermediate representation of each
+// object.
+//
+// JSON input must be an array of objects whose keys are property names. CSV
+// input must start with a header line of property names, and an empty
+// unquoted field is read as null. Only properties of types which can be
+// represented as a single JSON or CSV value can be imported; dates are read as
+// a number of seconds since 1970.
+class ObjectImporter {
+public:
+    enum class Format {
+        JSON,
+        CSV
+    };
+
+    // Reads up to `size` bytes into `buffer`, returning the number of bytes
+    // read or 0 at the end of the input
+    using ReadFunction = std::function<size_t (char* buffer, size_t size)>;
+
+    ObjectImporter(SharedRealm realm, std::string object_type, Format format);
+
+    // Import all of the objects from the input, committing a write transaction
+    // after each `objects_per_transaction` objects. If an error occurs, the
+    // objects imported in previously committed transactions are kept.
+    // Returns the number of objects imported.
+    size_t import(ReadFunction read, size_t objects_per_transaction = 10000);
+
+private:
+    SharedRealm m_realm;
+    std::string m_object_type;
+    Format m_format;
+};
+
+// Thrown when the input to an ObjectImporter is malformed or does not match
+// the object schema
+class ImportException : public std::runtime_error {
+public:
+    ImportException(std::string const& message, size_t line)
+    : std::runtime_error(message + " (line " + std::to_string(line) + ")"), m_line(line) {}
+
+    // The line of the input containing the object which could not be imported
+    size_t line() const noexcept { return m_line; }
+
+private:
+    size_t m_line;
+};
+}
+
+#endif /* REALM_OBJECT_IMPORTER_HPP */
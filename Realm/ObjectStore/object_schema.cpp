@@ -24,6 +24,8 @@
 #include <realm/group_shared.hpp>
 #include <realm/link_view.hpp>
 
+#include <algorithm>
+
 using namespace realm;
 
 ObjectSchema::~ObjectSchema() = default;
@@ -84,3 +86,52 @@ void ObjectSchema::set_primary_key_property()
         primary_key_prop->is_primary = true;
     }
 }
+
+namespace {
+// 64-bit FNV-1a, used rather than std::hash as the fingerprint is persisted
+struct FingerprintHasher {
+    uint64_t hash = 14695981039346656037ULL;
+
+    void add(const void *data, size_t size) {
+        auto bytes = static_cast<const unsigned char *>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash = (hash ^ bytes[i]) * 1099511628211ULL;
+        }
+    }
+    void add(std::string const& str) {
+        add(str.data(), str.size() + 1);
+    }
+    void add(uint64_t value) {
+        for (int i = 0; i < 8; ++i) {
+            unsigned char byte = static_cast<unsigned char>(value >> (i * 8));
+            add(&byte, 1);
+        }
+    }
+};
+}
+
+uint64_t ObjectSchema::fingerprint() const
+{
+    FingerprintHasher hasher;
+    hasher.add(name);
+    hasher.add(primary_key);
+    hasher.add(properties.size());
+
+    // Properties are hashed in name order as bindings may reorder them to
+    // match the column order after aligning with the file
+    std::vector<const Property *> sorted;
+    for (auto const& prop : properties) {
+        sorted.push_back(&prop);
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const Property *a, const Property *b) {
+        return a->name < b->name;
+    });
+
+    for (auto prop : sorted) {
+        hasher.add(prop->name);
+        hasher.add(uint64_t(prop->type));
+        hasher.add(prop->object_type);
+        hasher.add(uint64_t(prop->is_primary) | uint64_t(prop->is_indexed) << 1 | uint64_t(prop->is_nullable) << 2);
+    }
+    return hasher.hash ? hasher.hash : 1;
+}
@@ -21,6 +21,8 @@
 
 #include <realm/string_data.hpp>
 
+#include <chrono>
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -42,6 +44,13 @@ namespace realm {
         std::vector<Property> properties;
         std::string primary_key;
 
+        // If time_to_live is non-zero, objects expire that long after the
+        // date in the named DateTime property: Results no longer include
+        // them, and Realms with an expiry_sweep_interval delete them in the
+        // background. Not stored in the file.
+        std::string expiry_property;
+        std::chrono::seconds time_to_live{0};
+
         Property *property_for_name(StringData name);
         const Property *property_for_name(StringData name) const;
         Property *primary_key_property() {
@@ -51,6 +60,10 @@ namespace realm {
             return property_for_name(primary_key);
         }
 
+        // Compute a hash of the name, properties and primary key of this type
+        // which is stable across runs and platforms. Never returns zero.
+        uint64_t fingerprint() const;
+
     private:
         void set_primary_key_property();
     };
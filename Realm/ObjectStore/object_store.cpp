@@ -27,6 +27,7 @@
 #include <realm/util/assert.hpp>
 
 #include <string.h>
+#include <unordered_set>
 
 using namespace realm;
 
@@ -35,6 +36,12 @@ const char * const c_metadataTableName = "metadata";
 const char * const c_versionColumnName = "version";
 const size_t c_versionColumnIndex = 0;
 
+const char * const c_schemaFingerprintTableName = "schema_fingerprint";
+const char * const c_schemaFingerprintObjectClassColumnName = "fingerprint_table";
+const size_t c_schemaFingerprintObjectClassColumnIndex = 0;
+const char * const c_schemaFingerprintColumnName = "fingerprint";
+const size_t c_schemaFingerprintColumnIndex = 1;
+
 const char * const c_primaryKeyTableName = "pk";
 const char * const c_primaryKeyObjectClassColumnName = "pk_table";
 const size_t c_primaryKeyObjectClassColumnIndex =  0;
@@ -67,6 +74,17 @@ void ObjectStore::create_metadata_tables(Group *group) {
         table->add_empty_row();
         table->set_int(c_versionColumnIndex, c_zeroRowIndex, ObjectStore::NotVersioned);
     }
+
+    // This is a separate table rather than a column on the metadata table as
+    // files created before it existed can gain new tables without a schema
+    // version bump, but not new columns on existing tables. There is a row per
+    // object type so that processes which open the file with different subsets
+    // of its types don't overwrite each other's fingerprints.
+    table = group->get_or_add_table(c_schemaFingerprintTableName);
+    if (table->get_column_count() == 0) {
+        table->add_column(type_String, c_schemaFingerprintObjectClassColumnName);
+        table->add_column(type_Int, c_schemaFingerprintColumnName);
+    }
 }
 
 uint64_t ObjectStore::get_schema_version(const Group *group) {
@@ -82,6 +100,58 @@ void ObjectStore::set_schema_version(Group *group, uint64_t version) {
     table->set_int(c_versionColumnIndex, c_zeroRowIndex, version);
 }
 
+void ObjectStore::set_schema_fingerprint(Group *group, Schema const& schema) {
+    TableRef table = group->get_table(c_schemaFingerprintTableName);
+    for (auto& object_schema : schema) {
+        // Only types in this schema are touched, and unchanged rows are not
+        // rewritten, so the fingerprints of other types are left as they were
+        auto fingerprint = int64_t(object_schema.fingerprint());
+        size_t row = table->find_first_string(c_schemaFingerprintObjectClassColumnIndex, object_schema.name);
+        if (row == not_found) {
+            row = table->add_empty_row();
+            table->set_string(c_schemaFingerprintObjectClassColumnIndex, row, object_schema.name);
+        }
+        else if (table->get_int(c_schemaFingerprintColumnIndex, row) == fingerprint) {
+            continue;
+        }
+        table->set_int(c_schemaFingerprintColumnIndex, row, fingerprint);
+    }
+}
+
+bool ObjectStore::verify_schema_fingerprint(const Group *group, Schema &target_schema) {
+    ConstTableRef table = group->get_table(c_schemaFingerprintTableName);
+    if (!table || table->get_column_count() != 2) {
+        return false;
+    }
+    // Types in the file which aren't in the target schema don't matter, so a
+    // subset of the schema the file was last updated to is also verified
+    for (auto& object_schema : target_schema) {
+        size_t row = table->find_first_string(c_schemaFingerprintObjectClassColumnIndex, object_schema.name);
+        if (row == not_found || uint64_t(table->get_int(c_schemaFingerprintColumnIndex, row)) != object_schema.fingerprint()) {
+            return false;
+        }
+    }
+
+    // The fingerprint is only maintained by the object store, so make sure
+    // nothing else has changed the tables' columns since it was written. This
+    // only needs to look at the table specs and not at the stored schema metadata.
+    for (auto& object_schema : target_schema) {
+        ConstTableRef object_table = table_for_object_type(group, object_schema.name);
+        if (!object_table || object_table->get_column_count() != object_schema.properties.size()) {
+            return false;
+        }
+        for (auto& prop : object_schema.properties) {
+            size_t column = object_table->get_column_index(prop.name);
+            if (column == npos || object_table->get_column_type(column) != DataType(prop.type)
+                || (object_table->is_nullable(column) || prop.type == PropertyTypeObject) != prop.is_nullable) {
+                return false;
+            }
+            prop.table_column = column;
+        }
+    }
+    return true;
+}
+
 StringData ObjectStore::get_primary_key_for_object(const Group *group, StringData object_type) {
     ConstTableRef table = group->get_table(c_primaryKeyTableName);
     if (!table) {
@@ -208,45 +278,76 @@ std::vector<ObjectSchemaValidationException> ObjectStore::verify_object_schema(O
     return exceptions;
 }
 
-template <typename T>
-static void copy_property_values(const Property& old_property, const Property& new_property, Table& table,
-                                 T (Table::*getter)(std::size_t, std::size_t) const noexcept,
-                                 void (Table::*setter)(std::size_t, std::size_t, T)) {
-    size_t old_column = old_property.table_column, new_column = new_property.table_column;
-    size_t count = table.size();
-    for (size_t i = 0; i < count; i++) {
-        (table.*setter)(new_column, i, (table.*getter)(old_column, i));
+template <typename Getter, typename Setter>
+static void copy_column(Table& table, size_t old_column, size_t new_column, Getter get, Setter set) {
+    // read and write through the concrete accessors so that the loop is a
+    // single pass over the column with no indirect calls per row
+    for (size_t i = 0, count = table.size(); i < count; ++i) {
+        set(new_column, i, get(old_column, i));
     }
 }
 
 static void copy_property_values(const Property& source, const Property& destination, Table& table) {
+    size_t old_column = source.table_column, new_column = destination.table_column;
     switch (destination.type) {
         case PropertyTypeInt:
-            copy_property_values(source, destination, table, &Table::get_int, &Table::set_int);
+            copy_column(table, old_column, new_column,
+                        [&](size_t col, size_t row) { return table.get_int(col, row); },
+                        [&](size_t col, size_t row, int64_t value) { table.set_int(col, row, value); });
             break;
         case PropertyTypeBool:
-            copy_property_values(source, destination, table, &Table::get_bool, &Table::set_bool);
+            copy_column(table, old_column, new_column,
+                        [&](size_t col, size_t row) { return table.get_bool(col, row); },
+                        [&](size_t col, size_t row, bool value) { table.set_bool(col, row, value); });
             break;
         case PropertyTypeFloat:
-            copy_property_values(source, destination, table, &Table::get_float, &Table::set_float);
+            copy_column(table, old_column, new_column,
+                        [&](size_t col, size_t row) { return table.get_float(col, row); },
+                        [&](size_t col, size_t row, float value) { table.set_float(col, row, value); });
             break;
         case PropertyTypeDouble:
-            copy_property_values(source, destination, table, &Table::get_double, &Table::set_double);
+            copy_column(table, old_column, new_column,
+                        [&](size_t col, size_t row) { return table.get_double(col, row); },
+                        [&](size_t col, size_t row, double value) { table.set_double(col, row, value); });
             break;
         case PropertyTypeString:
-            copy_property_values(source, destination, table, &Table::get_string, &Table::set_string);
+            copy_column(table, old_column, new_column,
+                        [&](size_t col, size_t row) { return table.get_string(col, row); },
+                        [&](size_t col, size_t row, StringData value) { table.set_string(col, row, value); });
             break;
         case PropertyTypeData:
-            copy_property_values(source, destination, table, &Table::get_binary, &Table::set_binary);
+            copy_column(table, old_column, new_column,
+                        [&](size_t col, size_t row) { return table.get_binary(col, row); },
+                        [&](size_t col, size_t row, BinaryData value) { table.set_binary(col, row, value); });
             break;
         case PropertyTypeDate:
-            copy_property_values(source, destination, table, &Table::get_datetime, &Table::set_datetime);
+            copy_column(table, old_column, new_column,
+                        [&](size_t col, size_t row) { return table.get_datetime(col, row); },
+                        [&](size_t col, size_t row, DateTime value) { table.set_datetime(col, row, value); });
             break;
         default:
             break;
     }
 }
 
+// replace the column for `current_prop` with a nullable column holding the same values
+static void migrate_column_to_nullable(Table& table, Property& current_prop, Property& target_prop) {
+    target_prop.table_column = current_prop.table_column;
+    current_prop.table_column = current_prop.table_column + 1;
+
+    // the new column is created without a search index even if the old one
+    // had one, as building the index once after all of the values have been
+    // copied is much cheaper than updating it for each row; update_indexes()
+    // adds it back afterwards
+    table.insert_column(target_prop.table_column, DataType(target_prop.type), target_prop.name, target_prop.is_nullable);
+    if (!table.is_empty()) {
+        copy_property_values(current_prop, target_prop, table);
+    }
+    table.remove_column(current_prop.table_column);
+
+    current_prop.table_column = target_prop.table_column;
+}
+
 // set references to tables on targetSchema and create/update any missing or out-of-date tables
 // if update existing is true, updates existing tables, otherwise validates existing tables
 // NOTE: must be called from within write transaction
@@ -275,14 +376,7 @@ void ObjectStore::create_tables(Group *group, Schema &target_schema, bool update
             if (!target_prop || !property_can_be_migrated_to_nullable(current_prop, *target_prop))
                 continue;
 
-            target_prop->table_column = current_prop.table_column;
-            current_prop.table_column = current_prop.table_column + 1;
-
-            table->insert_column(target_prop->table_column, DataType(target_prop->type), target_prop->name, target_prop->is_nullable);
-            copy_property_values(current_prop, *target_prop, *table);
-            table->remove_column(current_prop.table_column);
-
-            current_prop.table_column = target_prop->table_column;
+            migrate_column_to_nullable(*table, current_prop, *target_prop);
         }
 
         bool inserted_placeholder_column = false;
@@ -390,14 +484,27 @@ bool ObjectStore::needs_update(Schema const& old_schema, Schema const& schema) {
     return false;
 }
 
-void ObjectStore::update_realm_with_schema(Group *group, Schema const& old_schema,
+bool ObjectStore::update_realm_with_schema(Group *group, Schema const& old_schema,
                                            uint64_t version, Schema &schema,
-                                           MigrationFunction migration) {
+                                           MigrationFunction migration, bool defer_indexes,
+                                           ColumnWrittenFunction column_written) {
     // Recheck the schema version after beginning the write transaction as
     // another process may have done the migration after we opened the read
     // transaction
     bool migrating = !is_schema_at_version(group, version);
 
+    // Object types whose primary key was already enforced on the same property
+    // before this update, and so only needs revalidating if it's written to
+    std::unordered_set<std::string> enforced_primary_keys;
+    if (migrating && column_written) {
+        for (auto& object_schema : schema) {
+            if (object_schema.primary_key.size() && table_for_object_type(group, object_schema.name)
+                && get_primary_key_for_object(group, object_schema.name) == StringData(object_schema.primary_key)) {
+                enforced_primary_keys.insert(object_schema.name);
+            }
+        }
+    }
+
     // create tables
     create_metadata_tables(group);
     create_tables(group, schema, migrating);
@@ -408,20 +515,57 @@ void ObjectStore::update_realm_with_schema(Group *group, Schema const& old_schem
         verify_schema(old_schema, schema, true);
     }
 
-    update_indexes(group, schema);
+    // Primary keys need their indexes to be enforced, so they are never deferred
+    auto additions = defer_indexes ? IndexAddition::PrimaryKeys : IndexAddition::All;
 
     if (!migrating) {
-        return;
+        update_indexes(group, schema, additions);
     }
+    else {
+        // Indexes which are no longer needed are removed before the migration
+        // so that it doesn't have to keep them up to date, while new ones are
+        // added afterwards so that each is built once from the migrated values
+        // rather than being updated for every object the migration changes.
+        // Primary keys are not enforced during the migration, so nothing in it
+        // relies on the new indexes being present.
+        update_indexes(group, schema, IndexAddition::None, true);
+
+        // apply the migration block if provided and there's any old data
+        bool has_old_data = get_schema_version(group) != ObjectStore::NotVersioned;
+        if (has_old_data) {
+            migration(group, schema);
+        }
 
-    // apply the migration block if provided and there's any old data
-    if (get_schema_version(group) != ObjectStore::NotVersioned) {
-        migration(group, schema);
+        update_indexes(group, schema, additions, false);
 
-        validate_primary_column_uniqueness(group, schema);
+        if (has_old_data && column_written) {
+            validate_primary_column_uniqueness(group, schema, [&](ObjectSchema const& object_schema) {
+                if (!enforced_primary_keys.count(object_schema.name)) {
+                    return true;
+                }
+                ConstTableRef table = table_for_object_type(group, object_schema.name);
+                return column_written(table->get_index_in_group(), object_schema.primary_key_property()->table_column);
+            });
+        }
+        else if (has_old_data) {
+            validate_primary_column_uniqueness(group, schema);
+        }
+
+        set_schema_version(group, version);
+    }
+
+    // Leaving the old fingerprint in place makes the next open compare the
+    // full schema and so notice any indexes which are still missing
+    if (defer_indexes && has_missing_indexes(group, schema)) {
+        return true;
     }
+    set_schema_fingerprint(group, schema);
+    return false;
+}
 
-    set_schema_version(group, version);
+void ObjectStore::add_deferred_indexes(Group *group, Schema &schema) {
+    update_indexes(group, schema, IndexAddition::All, false);
+    set_schema_fingerprint(group, schema);
 }
 
 Schema ObjectStore::schema_from_group(const Group *group) {
@@ -435,7 +579,7 @@ Schema ObjectStore::schema_from_group(const Group *group) {
     return schema;
 }
 
-bool ObjectStore::update_indexes(Group *group, Schema &schema) {
+bool ObjectStore::update_indexes(Group *group, Schema &schema, IndexAddition add, bool remove_indexes) {
     bool changed = false;
     for (auto& object_schema : schema) {
         TableRef table = table_for_object_type(group, object_schema.name);
@@ -444,12 +588,19 @@ bool ObjectStore::update_indexes(Group *group, Schema &schema) {
         }
 
         for (auto& property : object_schema.properties) {
-            if (property.requires_index() == table->has_search_index(property.table_column)) {
+            bool requires_index = property.requires_index();
+            if (requires_index == table->has_search_index(property.table_column)) {
+                continue;
+            }
+            if (!requires_index && !remove_indexes) {
+                continue;
+            }
+            if (requires_index && (add == IndexAddition::None || (add == IndexAddition::PrimaryKeys && !property.is_primary))) {
                 continue;
             }
 
             changed = true;
-            if (property.requires_index()) {
+            if (requires_index) {
                 try {
                     table->add_search_index(property.table_column);
                 }
@@ -465,7 +616,23 @@ bool ObjectStore::update_indexes(Group *group, Schema &schema) {
     return changed;
 }
 
-void ObjectStore::validate_primary_column_uniqueness(const Group *group, Schema const& schema) {
+bool ObjectStore::has_missing_indexes(const Group *group, Schema const& schema) {
+    for (auto& object_schema : schema) {
+        ConstTableRef table = table_for_object_type(group, object_schema.name);
+        if (!table) {
+            continue;
+        }
+        for (auto& property : object_schema.properties) {
+            if (property.requires_index() && !table->has_search_index(property.table_column)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void ObjectStore::validate_primary_column_uniqueness(const Group *group, Schema const& schema,
+                                                     std::function<bool(ObjectSchema const&)> const& needs_validation) {
     for (auto& object_schema : schema) {
         auto primary_prop = object_schema.primary_key_property();
         if (!primary_prop) {
@@ -473,6 +640,11 @@ void ObjectStore::validate_primary_column_uniqueness(const Group *group, Schema
         }
 
         ConstTableRef table = table_for_object_type(group, object_schema.name);
+        if (table->size() < 2 || (needs_validation && !needs_validation(object_schema))) {
+            continue;
+        }
+        // The column always has a search index by now, which the distinct
+        // view is built from
         if (table->get_distinct_view(primary_prop->table_column).size() != table->size()) {
             throw DuplicatePrimaryKeyValueException(object_schema.name, *primary_prop);
         }
@@ -47,6 +47,11 @@ namespace realm {
         // throws if the schema is invalid or does not match
         static void verify_schema(Schema const& actual_schema, Schema& target_schema, bool allow_missing_tables = false);
 
+        // check if each type in target_schema was last updated to exactly that
+        // type by the object store, and if so set the column mapping on
+        // target_schema from the tables without reading or comparing the full schema
+        static bool verify_schema_fingerprint(const Group *group, Schema &target_schema);
+
         // determines if a realm with the given old schema needs non-migration
         // changes to make it compatible with the given target schema
         static bool needs_update(Schema const& old_schema, Schema const& schema);
@@ -55,9 +60,25 @@ namespace realm {
         // passed in target schema is updated with the correct column mapping
         // optionally runs migration function if schema is out of date
         // NOTE: must be performed within a write transaction
+        // if defer_indexes is set, search indexes other than those for primary
+        // keys are not added, and the schema is not recorded as fully applied
+        // until add_deferred_indexes() is called; returns true if any were deferred
+        // if column_written is given, primary keys which were already enforced
+        // before the migration are only revalidated if it reports that the
+        // write transaction may have written to their column
         typedef std::function<void(Group *, Schema &)> MigrationFunction;
-        static void update_realm_with_schema(Group *group, Schema const& old_schema, uint64_t version,
-                                             Schema &schema, MigrationFunction migration);
+        typedef std::function<bool(size_t table_ndx, size_t col_ndx)> ColumnWrittenFunction;
+        static bool update_realm_with_schema(Group *group, Schema const& old_schema, uint64_t version,
+                                             Schema &schema, MigrationFunction migration,
+                                             bool defer_indexes = false,
+                                             ColumnWrittenFunction column_written = nullptr);
+
+        // adds the search indexes skipped by update_realm_with_schema() with defer_indexes set
+        // NOTE: must be performed within a write transaction
+        static void add_deferred_indexes(Group *group, Schema &schema);
+
+        // checks if any property which requires a search index doesn't have one
+        static bool has_missing_indexes(const Group *group, Schema const& schema);
 
         // get a table for an object type
         static realm::TableRef table_for_object_type(Group *group, StringData object_type);
@@ -79,6 +100,9 @@ namespace realm {
         // set a new schema version
         static void set_schema_version(Group *group, uint64_t version);
 
+        // record the fingerprint of each type in the schema the group was updated to
+        static void set_schema_fingerprint(Group *group, Schema const& schema);
+
         // check if the realm already has all metadata tables
         static bool has_metadata_tables(const Group *group);
 
@@ -106,11 +130,18 @@ namespace realm {
 
         static TableRef table_for_object_type_create_if_needed(Group *group, StringData object_type, bool &created);
 
+        // which of the missing search indexes update_indexes() should add
+        enum class IndexAddition { None, PrimaryKeys, All };
+
+        // adds and/or removes search indexes so that the tables match the schema
         // returns if any indexes were changed
-        static bool update_indexes(Group *group, Schema &schema);
+        static bool update_indexes(Group *group, Schema &schema, IndexAddition add = IndexAddition::All,
+                                   bool remove_indexes = true);
 
         // validates that all primary key properties have unique values
-        static void validate_primary_column_uniqueness(const Group *group, Schema const& schema);
+        // if needs_validation is given, only the object types it returns true for are checked
+        static void validate_primary_column_uniqueness(const Group *group, Schema const& schema,
+                                                       std::function<bool(ObjectSchema const&)> const& needs_validation = nullptr);
 
         friend ObjectSchema;
     };
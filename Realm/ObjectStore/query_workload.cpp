@@ -0,0 +1,121 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "query_workload.hpp"
+
+#include "object_schema.hpp"
+#include "property.hpp"
+#include "schema.hpp"
+
+#include <algorithm>
+#include <set>
+
+using namespace realm;
+
+void QueryWorkload::record(std::string const& object_type, std::vector<QueryCondition> conditions,
+                           size_t rows_scanned, std::chrono::nanoseconds duration)
+{
+    std::sort(conditions.begin(), conditions.end());
+    conditions.erase(std::unique(conditions.begin(), conditions.end()), conditions.end());
+
+    auto& shape = m_shapes[Key(object_type, conditions)];
+    if (shape.runs == 0) {
+        shape.object_type = object_type;
+        shape.conditions = std::move(conditions);
+    }
+    ++shape.runs;
+    shape.rows_scanned += rows_scanned;
+    shape.duration += duration;
+}
+
+std::vector<QueryWorkload::Shape> QueryWorkload::shapes() const
+{
+    std::vector<Shape> shapes;
+    shapes.reserve(m_shapes.size());
+    for (auto const& shape : m_shapes) {
+        shapes.push_back(shape.second);
+    }
+    return shapes;
+}
+
+std::vector<QueryWorkload::IndexRecommendation> QueryWorkload::recommend_indexes(Schema const& schema, uint64_t min_runs,
+                                                                                 uint64_t min_average_rows) const
+{
+    std::vector<IndexRecommendation> recommendations;
+    for (auto const& object_schema : schema) {
+        std::vector<Property const*> properties_by_column;
+        for (auto const& property : object_schema.properties) {
+            if (property.table_column >= properties_by_column.size()) {
+                properties_by_column.resize(property.table_column + 1);
+            }
+            properties_by_column[property.table_column] = &property;
+        }
+        auto property_for_column = [&](size_t column) -> Property const* {
+            return column < properties_by_column.size() ? properties_by_column[column] : nullptr;
+        };
+
+        uint64_t type_runs = 0;
+        std::set<size_t> used;
+        // Runs and rows scanned by the queries which could use an index on
+        // each unindexed column
+        std::map<size_t, std::pair<uint64_t, uint64_t>> candidates;
+
+        auto begin = m_shapes.lower_bound(Key(object_schema.name, {}));
+        for (auto it = begin; it != m_shapes.end() && it->first.first == object_schema.name; ++it) {
+            auto const& shape = it->second;
+            type_runs += shape.runs;
+
+            bool uses_index = std::any_of(shape.conditions.begin(), shape.conditions.end(), [&](auto const& condition) {
+                auto property = property_for_column(condition.column);
+                return condition.kind == QueryCondition::Kind::Equal && property && property->requires_index();
+            });
+            for (auto const& condition : shape.conditions) {
+                used.insert(condition.column);
+                if (!uses_index && condition.kind != QueryCondition::Kind::Sort) {
+                    auto& candidate = candidates[condition.column];
+                    candidate.first += shape.runs;
+                    candidate.second += shape.rows_scanned;
+                }
+            }
+        }
+        if (type_runs == 0) {
+            continue;
+        }
+
+        for (auto const& property : object_schema.properties) {
+            if (property.requires_index()) {
+                if (!property.is_primary && type_runs >= min_runs && !used.count(property.table_column)) {
+                    recommendations.push_back({IndexRecommendation::Action::Remove, object_schema.name,
+                                               property.name, type_runs, 0});
+                }
+                continue;
+            }
+
+            auto candidate = candidates.find(property.table_column);
+            if (!property.is_indexable() || candidate == candidates.end()) {
+                continue;
+            }
+            uint64_t runs = candidate->second.first, rows = candidate->second.second;
+            if (runs >= min_runs && rows / runs >= min_average_rows) {
+                recommendations.push_back({IndexRecommendation::Action::Add, object_schema.name,
+                                           property.name, runs, rows});
+            }
+        }
+    }
+    return recommendations;
+}
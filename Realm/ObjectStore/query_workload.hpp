@@ -0,0 +1,118 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef REALM_QUERY_WORKLOAD_HPP
+#define REALM_QUERY_WORKLOAD_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace realm {
+class Schema;
+
+// A condition of a query on a single column of the table being queried, of
+// the kinds which a search index can answer
+struct QueryCondition {
+    enum class Kind {
+        // Equality or IN with a constant
+        Equal,
+        // Comparisons with a constant, BETWEEN and BEGINSWITH
+        Range,
+        // The Results are sorted on the column
+        Sort,
+    };
+
+    size_t column;
+    Kind kind;
+
+    bool operator==(QueryCondition const& other) const { return column == other.column && kind == other.kind; }
+    bool operator<(QueryCondition const& other) const
+    {
+        return column < other.column || (column == other.column && kind < other.kind);
+    }
+};
+
+// A record of the queries run by Results on a single Realm instance, grouped
+// by the object type queried and the conditions the query could use search
+// indexes for, which is used to recommend adding indexes which would have
+// avoided scanning tables and removing ones which no query has used
+class QueryWorkload {
+public:
+    // The queries with the same object type and conditions
+    struct Shape {
+        std::string object_type;
+        // Sorted and without duplicates
+        std::vector<QueryCondition> conditions;
+
+        // The number of times the query was run, including being rerun after
+        // the data changed
+        uint64_t runs = 0;
+        // The total number of rows in the tables or LinkViews the runs went
+        // over, which is what had to be scanned if no index was used
+        uint64_t rows_scanned = 0;
+        // The total time taken to run the queries and sort the results
+        std::chrono::nanoseconds duration{0};
+    };
+
+    struct IndexRecommendation {
+        enum class Action { Add, Remove };
+
+        Action action;
+        std::string object_type;
+        std::string property;
+        // For additions, the runs of queries with an equality or range
+        // condition on the property and the rows they went over. For
+        // removals, the runs of queries on the object type, none of which
+        // used the property.
+        uint64_t runs = 0;
+        uint64_t rows_scanned = 0;
+    };
+
+    // Record a run of a query on the table of the given object type
+    void record(std::string const& object_type, std::vector<QueryCondition> conditions,
+                size_t rows_scanned, std::chrono::nanoseconds duration);
+
+    // Every distinct query shape recorded, ordered by object type and then
+    // by conditions
+    std::vector<Shape> shapes() const;
+
+    // Recommend adding an index to each unindexed property which has an
+    // equality or range condition in queries which together ran at least
+    // `min_runs` times and went over an average of at least
+    // `min_average_rows` rows per run, and removing the index from each
+    // indexed property other than a primary key which isn't used by any
+    // recorded query of an object type which has been queried at least
+    // `min_runs` times. Queries which already have an equality condition on
+    // an indexed property are answered from that index, and so don't count
+    // towards indexing their other properties.
+    std::vector<IndexRecommendation> recommend_indexes(Schema const& schema, uint64_t min_runs = 10,
+                                                       uint64_t min_average_rows = 1000) const;
+
+    bool empty() const { return m_shapes.empty(); }
+    void clear() { m_shapes.clear(); }
+
+private:
+    using Key = std::pair<std::string, std::vector<QueryCondition>>;
+    std::map<Key, Shape> m_shapes;
+};
+} // namespace realm
+
+#endif /* REALM_QUERY_WORKLOAD_HPP */
@@ -0,0 +1,191 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "realm_snapshot.hpp"
+
+#include <realm/group.hpp>
+#include <realm/util/file.hpp>
+
+#include <algorithm>
+#include <ostream>
+#include <streambuf>
+#include <vector>
+
+using namespace realm;
+
+namespace {
+// Thrown out of the stream to abandon the copy
+struct CopyCancelled { };
+
+// Writes the stream to the file in fixed-size chunks, reporting progress
+// after each. Writing through util::File encrypts the data if the file has
+// an encryption key.
+class ChunkedFileStreambuf : public std::streambuf {
+public:
+    ChunkedFileStreambuf(util::File& file, size_t expected_size, RealmSnapshot::CopyProgressFunction const& progress)
+    : m_file(file)
+    , m_expected_size(expected_size)
+    , m_progress(progress)
+    , m_buffer(1024 * 1024)
+    {
+        reset();
+    }
+
+private:
+    util::File& m_file;
+    const size_t m_expected_size;
+    RealmSnapshot::CopyProgressFunction const& m_progress;
+    std::vector<char> m_buffer;
+    size_t m_written = 0;
+
+    void reset()
+    {
+        setp(m_buffer.data(), m_buffer.data() + m_buffer.size());
+    }
+
+    void write_chunk()
+    {
+        size_t size = pptr() - pbase();
+        if (size == 0) {
+            return;
+        }
+        m_file.write(pbase(), size);
+        m_written += size;
+        reset();
+
+        if (m_progress && !m_progress(m_written, std::max(m_written, m_expected_size))) {
+            throw CopyCancelled();
+        }
+    }
+
+    int_type overflow(int_type c) override
+    {
+        write_chunk();
+        if (!traits_type::eq_int_type(c, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(c);
+            pbump(1);
+        }
+        return traits_type::not_eof(c);
+    }
+
+    int sync() override
+    {
+        write_chunk();
+        return 0;
+    }
+};
+} // anonymous namespace
+
+std::shared_ptr<RealmSnapshot> RealmSnapshot::create(Realm& realm)
+{
+    realm.verify_thread();
+    if (realm.config().read_only) {
+        throw InvalidTransactionException("Can't take a snapshot of a read-only Realm.");
+    }
+    if (realm.is_in_transaction()) {
+        throw InvalidTransactionException("Can't take a snapshot of a Realm within a write transaction.");
+    }
+
+    realm.read_group();
+    Realm::Config config = realm.config();
+    // The readers are lent out to arbitrary threads, so they must not be
+    // found in the cache by the thread which happened to open them
+    config.cache = false;
+    config.dispatch_queue = {};
+
+    std::shared_ptr<RealmSnapshot> snapshot(new RealmSnapshot(std::move(config),
+                                                              realm.m_shared_group->get_version_of_current_transaction()));
+    snapshot->m_idle_readers.push_back(snapshot->open_reader());
+    return snapshot;
+}
+
+RealmSnapshot::RealmSnapshot(Realm::Config config, SharedGroup::VersionID version)
+: m_config(std::move(config))
+, m_version(version)
+{
+}
+
+SharedRealm RealmSnapshot::open_reader() const
+{
+    // Readers are not registered with the commit helper as they never
+    // advance, so they don't need to hear about commits
+    SharedRealm reader(new Realm(m_config));
+    reader->m_group = &const_cast<Group&>(reader->m_shared_group->begin_read(m_version));
+    reader->m_frozen = true;
+    reader->m_auto_refresh = false;
+    reader->update_read_version();
+    return reader;
+}
+
+SharedRealm RealmSnapshot::acquire()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_idle_readers.empty()) {
+            auto reader = std::move(m_idle_readers.back());
+            m_idle_readers.pop_back();
+            return reader;
+        }
+    }
+
+    // The reader being used by another thread keeps the version pinned, so
+    // opening another at the same version can't fail due to it being cleaned up
+    return open_reader();
+}
+
+void RealmSnapshot::release(SharedRealm realm)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_idle_readers.push_back(std::move(realm));
+}
+
+bool RealmSnapshot::write_copy(std::string const& path, const char* encryption_key,
+                               CopyProgressFunction const& progress)
+{
+    return read([&](SharedRealm const& reader) {
+        // The copy only contains the data in use by this version, which the
+        // space in use by the newest version is a close estimate of
+        size_t free_space, used_space;
+        reader->m_shared_group->get_stats(free_space, used_space);
+
+        // Like Group::write(), refuse to overwrite an existing file
+        util::File file;
+        file.open(path, util::File::access_ReadWrite, util::File::create_Must, 0);
+        file.set_encryption_key(encryption_key);
+        try {
+            ChunkedFileStreambuf streambuf(file, used_space, progress);
+            std::ostream out(&streambuf);
+            // Makes the stream rethrow exceptions from the streambuf
+            out.exceptions(std::ios_base::failbit | std::ios_base::badbit);
+            reader->read_group()->write(out, encryption_key != nullptr);
+            out.flush();
+            file.sync();
+            return true;
+        }
+        catch (CopyCancelled const&) {
+            file.close();
+            util::File::try_remove(path);
+            return false;
+        }
+        catch (...) {
+            file.close();
+            util::File::try_remove(path);
+            throw;
+        }
+    });
+}
@@ -0,0 +1,100 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef REALM_SNAPSHOT_HPP
+#define REALM_SNAPSHOT_HPP
+
+#include "shared_realm.hpp"
+
+#include <realm/group_shared.hpp>
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace realm {
+// An immutable view of a single version of a Realm file which can be read
+// from any number of threads at once. Group accessors are not thread-safe, so
+// each concurrent reader is lent its own frozen Realm at the pinned version;
+// these are pooled and reused, so there are only ever as many of them as the
+// most threads which have read at the same time. The version stays pinned for
+// as long as the snapshot exists.
+class RealmSnapshot {
+public:
+    // Called with the number of bytes written so far and an estimate of the
+    // total size of the copy. Returning false cancels the copy.
+    using CopyProgressFunction = std::function<bool (size_t bytes_written, size_t total_bytes)>;
+
+    // Pin the version which the Realm is currently reading. Must be called on
+    // the Realm's thread, outside of a write transaction.
+    static std::shared_ptr<RealmSnapshot> create(Realm& realm);
+
+    uint_fast64_t version() const { return m_version.version; }
+    SharedGroup::VersionID version_id() const { return m_version; }
+    Realm::Config const& config() const { return m_config; }
+
+    // Call the function with a frozen Realm at the snapshot's version which
+    // the calling thread has exclusive use of until the function returns.
+    // Objects obtained from the Realm must not be used after that. Can be
+    // called from any thread.
+    template<typename Function>
+    auto read(Function&& fn) -> decltype(fn(std::declval<SharedRealm const&>()))
+    {
+        Lease lease(*this);
+        return fn(lease.realm);
+    }
+
+    // Write a compacted copy of the snapshot's version to a new file at the
+    // path, encrypted with the 64-byte key if one is given (which need not
+    // match the source file's key). The copy is written in chunks, calling
+    // the progress function after each. Returns false if it was cancelled,
+    // in which case the partially written file is removed. Throws the
+    // util::File exceptions for failing to create or write the file. Can be
+    // called from any thread.
+    bool write_copy(std::string const& path, const char* encryption_key = nullptr,
+                    CopyProgressFunction const& progress = nullptr);
+
+private:
+    RealmSnapshot(Realm::Config config, SharedGroup::VersionID version);
+
+    struct Lease {
+        RealmSnapshot& snapshot;
+        SharedRealm realm;
+
+        Lease(RealmSnapshot& snapshot) : snapshot(snapshot), realm(snapshot.acquire()) { }
+        ~Lease() { snapshot.release(std::move(realm)); }
+    };
+
+    SharedRealm acquire();
+    void release(SharedRealm realm);
+    SharedRealm open_reader() const;
+
+    Realm::Config m_config;
+    SharedGroup::VersionID m_version;
+
+    // Readers which aren't currently lent out. There is always at least one
+    // reader in existence, so the version can't be released between reads.
+    std::vector<SharedRealm> m_idle_readers;
+    std::mutex m_mutex;
+};
+} // namespace realm
+
+#endif /* REALM_SNAPSHOT_HPP */
@@ -18,7 +18,20 @@
 
 #include "results.hpp"
 
+#include "async_query.hpp"
+#include "collation_keys.hpp"
+#include "parallel_query.hpp"
+#include "results_notifier.hpp"
+#include "trace.hpp"
+#include "transact_log_handler.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <queue>
 #include <stdexcept>
+#include <unordered_map>
+#include <vector>
 
 using namespace realm;
 
@@ -41,6 +54,18 @@ Results::Results(SharedRealm r, Query q, SortOrder s)
 , m_sort(std::move(s))
 , m_mode(Mode::Query)
 {
+    exclude_expired();
+}
+
+Results::Results(SharedRealm r, LinkViewRef lv, SortOrder s)
+: m_realm(std::move(r))
+, m_query(lv->get_target_table().where(lv))
+, m_table(&lv->get_target_table())
+, m_sort(std::move(s))
+, m_link_view(std::move(lv))
+, m_mode(Mode::Query)
+{
+    exclude_expired();
 }
 
 Results::Results(SharedRealm r, Table& table)
@@ -48,12 +73,60 @@ Results::Results(SharedRealm r, Table& table)
 , m_table(&table)
 , m_mode(Mode::Table)
 {
+    exclude_expired();
+}
+
+void Results::exclude_expired()
+{
+    size_t column;
+    DateTime cutoff;
+    if (!m_realm || !m_realm->get_expiry_cutoff(*m_table, column, cutoff))
+        return;
+
+    // Whether anything has expired changes as time passes without the table
+    // being modified, so Results of types with a time to live always run a
+    // query rather than using the Table mode fast paths
+    if (m_mode == Mode::Table) {
+        m_query = m_table->where();
+        m_mode = Mode::Query;
+    }
+    m_expiry_column = column;
+    m_query_before_expiry = m_query;
+    apply_expiry_cutoff(cutoff);
+}
+
+void Results::update_expiry_cutoff()
+{
+    size_t column;
+    DateTime cutoff;
+    if (m_expiry_column == npos || !m_realm || !m_realm->get_expiry_cutoff(*m_table, column, cutoff)
+        || cutoff.get_datetime() == m_expiry_cutoff) {
+        return;
+    }
+
+    // Rows which were unexpired when the query was last run may have expired
+    // since, even though the table hasn't changed
+    apply_expiry_cutoff(cutoff);
+    m_query_cache = {};
+    if (m_mode == Mode::TableView) {
+        m_mode = Mode::Query;
+    }
+}
+
+void Results::apply_expiry_cutoff(DateTime cutoff)
+{
+    Query query = m_query_before_expiry;
+    query.and_query(m_table->where().greater_equal_datetime(m_expiry_column, cutoff));
+    m_query = std::move(query);
+    m_expiry_cutoff = cutoff.get_datetime();
 }
 
 void Results::validate_read() const
 {
-    if (m_realm)
+    if (m_realm) {
         m_realm->verify_thread();
+        m_realm->did_access();
+    }
     if (m_table && !m_table->is_attached())
         throw InvalidatedException();
 }
@@ -71,10 +144,13 @@ size_t Results::size()
     switch (m_mode) {
         case Mode::Empty: return 0;
         case Mode::Table: return m_table->size();
-        case Mode::Query: return m_query.count();
+        case Mode::Query:
+            if (!has_distinct() && !is_paged() && !m_window_base)
+                return query_count();
+            REALM_FALLTHROUGH;
         case Mode::TableView:
             update_tableview();
-            return m_table_view.size();
+            return window_size(m_table_view.size());
     }
     REALM_UNREACHABLE();
 }
@@ -85,20 +161,79 @@ RowExpr Results::get(size_t row_ndx)
     switch (m_mode) {
         case Mode::Empty: break;
         case Mode::Table:
-            if (row_ndx < m_table->size())
+            if (row_ndx < m_table->size()) {
+                m_realm->record_access(*m_table, row_ndx);
                 return m_table->get(row_ndx);
+            }
             break;
         case Mode::Query:
         case Mode::TableView:
             update_tableview();
-            if (row_ndx < m_table_view.size())
-                return m_table_view.get(row_ndx);
+            if (row_ndx < window_size(m_table_view.size())) {
+                m_realm->record_access(*m_table, m_table_view.get_source_ndx(m_offset + row_ndx));
+                return m_table_view.get(m_offset + row_ndx);
+            }
             break;
     }
 
     throw OutOfBoundsIndexException{row_ndx, size()};
 }
 
+size_t Results::get_source_indexes(size_t index, size_t count, size_t* out)
+{
+    validate_read();
+    switch (m_mode) {
+        case Mode::Empty:
+            return 0;
+        case Mode::Table: {
+            size_t size = m_table->size();
+            count = index < size ? std::min(count, size - index) : 0;
+            for (size_t i = 0; i < count; ++i)
+                out[i] = index + i;
+            return count;
+        }
+        case Mode::Query:
+        case Mode::TableView: {
+            update_tableview();
+            size_t size = window_size(m_table_view.size());
+            count = index < size ? std::min(count, size - index) : 0;
+            for (size_t i = 0; i < count; ++i) {
+                size_t ndx = m_offset + index + i;
+                out[i] = m_table_view.is_row_attached(ndx) ? m_table_view.get_source_ndx(ndx) : npos;
+            }
+            return count;
+        }
+    }
+    REALM_UNREACHABLE();
+}
+
+Results::Cursor::Cursor(Results& results)
+: m_results(&results)
+, m_table(results.m_table)
+, m_rows(256)
+{
+    results.validate_read();
+}
+
+bool Results::Cursor::next()
+{
+    while (true) {
+        while (m_batch_index < m_batch_count) {
+            // Skip over rows which have been deleted
+            if (m_rows[m_batch_index++] != npos)
+                return true;
+        }
+        if (m_at_end)
+            return false;
+
+        m_batch_start += m_batch_count;
+        m_batch_count = m_results->get_source_indexes(m_batch_start, m_rows.size(), m_rows.data());
+        m_batch_index = 0;
+        // A batch smaller than the buffer is the last one
+        m_at_end = m_batch_count < m_rows.size();
+    }
+}
+
 util::Optional<RowExpr> Results::first()
 {
     validate_read();
@@ -108,9 +243,24 @@ util::Optional<RowExpr> Results::first()
         case Mode::Table:
             return m_table->size() == 0 ? util::none : util::make_optional(m_table->front());
         case Mode::Query:
+            // The first row of an unsorted query can be found without
+            // running the query over the rest of the table
+            if (!m_sort && !has_distinct() && m_offset == 0 && m_limit != 0 && !m_window_base) {
+                validate_query_cache();
+                if (!m_query_cache.first_row) {
+                    m_query_cache.first_row = m_query.find();
+                    update_query_cache_version();
+                }
+                if (*m_query_cache.first_row == not_found)
+                    return util::none;
+                return util::make_optional(m_table->get(*m_query_cache.first_row));
+            }
+            REALM_FALLTHROUGH;
         case Mode::TableView:
             update_tableview();
-            return m_table_view.size() == 0 ? util::none : util::make_optional(m_table_view.front());
+            if (window_size(m_table_view.size()) == 0)
+                return util::none;
+            return util::make_optional(m_table_view.get(m_offset));
     }
     REALM_UNREACHABLE();
 }
@@ -126,7 +276,9 @@ util::Optional<RowExpr> Results::last()
         case Mode::Query:
         case Mode::TableView:
             update_tableview();
-            return m_table_view.size() == 0 ? util::none : util::make_optional(m_table_view.back());
+            if (size_t size = window_size(m_table_view.size()))
+                return util::make_optional(m_table_view.get(m_offset + size - 1));
+            return util::none;
     }
     REALM_UNREACHABLE();
 }
@@ -134,195 +286,1875 @@ util::Optional<RowExpr> Results::last()
 void Results::update_tableview()
 {
     validate_read();
+    update_expiry_cutoff();
     switch (m_mode) {
         case Mode::Empty:
         case Mode::Table:
             return;
-        case Mode::Query:
-            m_table_view = m_query.find_all();
-            if (m_sort) {
-                m_table_view.sort(m_sort.columnIndices, m_sort.ascending);
-            }
+        case Mode::Query: {
+            REALM_TRACE_BEGIN(UpdateTableView, m_realm ? m_realm->config().path.c_str() : nullptr,
+                              m_realm ? m_realm->current_transaction_version() : 0, 0);
+            auto start = std::chrono::steady_clock::now();
+            run_query();
+            report_query_time(start);
             m_mode = Mode::TableView;
+            REALM_TRACE_END(UpdateTableView, m_realm ? m_realm->config().path.c_str() : nullptr,
+                            m_realm ? m_realm->current_transaction_version() : 0, m_table_view.size());
             break;
+        }
         case Mode::TableView:
-            m_table_view.sync_if_needed();
+            if (!tableview_is_up_to_date()) {
+                REALM_TRACE_BEGIN(UpdateTableView, m_realm ? m_realm->config().path.c_str() : nullptr,
+                                  m_realm ? m_realm->current_transaction_version() : 0, m_table_view.size());
+                auto start = std::chrono::steady_clock::now();
+                // The tableview for a limited query is built from a bounded
+                // query which sync_if_needed() would rerun with stale bounds,
+                // one built from a shared sorted view needs that view to
+                // be updated first, and duplicates have to be removed again.
+                // Sorted tableviews are reordered by update_sorted_tableview(),
+                // which sync_if_needed() wouldn't sort again.
+                if (is_limited() || m_sorted_view || has_distinct()) {
+                    run_query();
+                }
+                else if (m_sort) {
+                    if (!update_sorted_tableview()) {
+                        run_query();
+                    }
+                }
+                else {
+                    m_table_view.sync_if_needed();
+                }
+                report_query_time(start);
+                REALM_TRACE_END(UpdateTableView, m_realm ? m_realm->config().path.c_str() : nullptr,
+                                m_realm ? m_realm->current_transaction_version() : 0, m_table_view.size());
+            }
             break;
     }
+
+    if (m_realm) {
+        m_synced_version = m_realm->current_transaction_version();
+        m_synced_write_count = m_realm->write_transaction_count();
+    }
 }
 
-size_t Results::index_of(Row const& row)
+size_t Results::limit_end() const noexcept
 {
-    validate_read();
-    if (!row) {
-        throw DetatchedAccessorException{};
-    }
-    if (m_table && row.get_table() != m_table) {
-        throw IncorrectTableException{
-            ObjectStore::object_type_for_table_name(m_table->get_name()),
-            ObjectStore::object_type_for_table_name(row.get_table()->get_name())};
+    if (m_limit > size_t(-1) - m_offset) {
+        return size_t(-1);
     }
-    return index_of(row.get_index());
+    return m_offset + m_limit;
 }
 
-size_t Results::index_of(size_t row_ndx)
+size_t Results::window_size(size_t total) const noexcept
 {
-    validate_read();
-    switch (m_mode) {
-        case Mode::Empty:
-            return not_found;
-        case Mode::Table:
-            return row_ndx;
-        case Mode::Query:
-            if (!m_sort)
-                return m_query.count(row_ndx, row_ndx + 1) ? m_query.count(0, row_ndx) : not_found;
-            REALM_FALLTHROUGH;
-        case Mode::TableView:
-            update_tableview();
-            return m_table_view.find_by_source_ndx(row_ndx);
-    }
-    REALM_UNREACHABLE();
+    return total > m_offset ? std::min(total - m_offset, m_limit) : 0;
 }
 
-template<typename Int, typename Float, typename Double, typename DateTime>
-util::Optional<Mixed> Results::aggregate(size_t column, bool return_none_for_empty,
-                                         Int agg_int, Float agg_float,
-                                         Double agg_double, DateTime agg_datetime)
+namespace {
+// Call the function with each chunk of the rows the query matches among the
+// first `extent` rows (or LinkView positions), so that every match is seen
+// without materializing all of them at once
+template<typename Function>
+void for_each_match_chunk(Query& query, size_t extent, Function fn)
 {
-    validate_read();
-    if (!m_table)
-        return none;
-    if (column > m_table->get_column_count())
-        throw OutOfBoundsIndexException{column, m_table->get_column_count()};
+    const size_t chunk_size = 4096;
+    for (size_t begin = 0; begin < extent; begin += chunk_size) {
+        fn(query.find_all(begin, std::min(extent, begin + chunk_size)));
+    }
+}
 
-    auto do_agg = [&](auto const& getter) -> util::Optional<Mixed> {
-        switch (m_mode) {
-            case Mode::Empty:
-                return none;
-            case Mode::Table:
-                if (return_none_for_empty && m_table->size() == 0)
-                    return none;
-                return util::Optional<Mixed>(getter(*m_table));
-            case Mode::Query:
-            case Mode::TableView:
-                this->update_tableview();
-                if (return_none_for_empty && m_table_view.size() == 0)
-                    return none;
-                return util::Optional<Mixed>(getter(m_table_view));
+// Get the value of the column which sorts as the nth of the rows the query
+// matches when sorted by just that column, or none if n or fewer rows match
+// or a value has no order (NaN). Runs in linear time in the number of
+// matches, keeping only the n + 1 values which sort first.
+template<typename T, typename Getter>
+util::Optional<T> nth_sorted_value(Query& query, size_t extent, size_t n, bool ascending, Getter getter,
+                                   size_t& matches)
+{
+    auto select = [&](auto less) -> util::Optional<T> {
+        // The value which sorts last of the values kept is on top
+        std::priority_queue<T, std::vector<T>, decltype(less)> values(less);
+        bool unordered = false;
+        for_each_match_chunk(query, extent, [&](TableView const& tv) {
+            for (size_t i = 0; i < tv.size(); ++i) {
+                T value = getter(tv, i);
+                unordered = unordered || value != value;
+                if (values.size() <= n) {
+                    values.push(value);
+                }
+                else if (less(value, values.top())) {
+                    values.pop();
+                    values.push(value);
+                }
+            }
+            matches += tv.size();
+        });
+        if (unordered || values.size() <= n) {
+            return util::none;
         }
-        REALM_UNREACHABLE();
+        return values.top();
     };
+    return ascending ? select(std::less<T>()) : select(std::greater<T>());
+}
 
-    switch (m_table->get_column_type(column))
-    {
-        case type_DateTime: return do_agg(agg_datetime);
-        case type_Double: return do_agg(agg_double);
-        case type_Float: return do_agg(agg_float);
-        case type_Int: return do_agg(agg_int);
+// Add a condition to the query which excludes rows which can't be in the
+// first `count` rows of its matches once they're sorted, by bounding the
+// first sort column by its value in the row which would sort as the last one
+// needed. Rows tied with that row are kept, so the query may still match
+// slightly more rows than needed. Returns false if no bound was added, either
+// because no more than `count` rows match or the column's type can't be
+// bounded or it's on a linked object. `matches` is set to the number of rows
+// the query matched if they were counted, and npos otherwise.
+bool add_sort_bound(Query& query, size_t extent, SortOrder const& sort, size_t count, size_t& matches)
+{
+    size_t col = sort.columnIndices[0];
+    bool ascending = sort.ascending[0];
+    auto& table = *query.get_table();
+    matches = npos;
+    if ((!sort.link_paths.empty() && !sort.link_paths[0].empty()) || table.is_nullable(col)) {
+        return false;
+    }
+
+    matches = 0;
+    size_t n = count - 1;
+    switch (table.get_column_type(col)) {
+        case type_Int: {
+            auto value = nth_sorted_value<int64_t>(query, extent, n, ascending,
+                                                   [&](TableView const& tv, size_t i) { return tv.get_int(col, i); },
+                                                   matches);
+            if (!value)
+                return false;
+            ascending ? query.less_equal(col, *value) : query.greater_equal(col, *value);
+            return true;
+        }
+        case type_Bool: {
+            // Only rows with the value which sorts first can be excluded, and
+            // only if there are enough of them to fill the window
+            bool first_value = !ascending;
+            size_t first_value_matches = 0;
+            for_each_match_chunk(query, extent, [&](TableView const& tv) {
+                for (size_t i = 0; i < tv.size(); ++i) {
+                    first_value_matches += tv.get_bool(col, i) == first_value;
+                }
+                matches += tv.size();
+            });
+            if (first_value_matches < count) {
+                return false;
+            }
+            query.equal(col, first_value);
+            return true;
+        }
+        case type_Float: {
+            auto value = nth_sorted_value<float>(query, extent, n, ascending,
+                                                 [&](TableView const& tv, size_t i) { return tv.get_float(col, i); },
+                                                 matches);
+            if (!value)
+                return false;
+            ascending ? query.less_equal(col, *value) : query.greater_equal(col, *value);
+            return true;
+        }
+        case type_Double: {
+            auto value = nth_sorted_value<double>(query, extent, n, ascending,
+                                                  [&](TableView const& tv, size_t i) { return tv.get_double(col, i); },
+                                                  matches);
+            if (!value)
+                return false;
+            ascending ? query.less_equal(col, *value) : query.greater_equal(col, *value);
+            return true;
+        }
+        case type_DateTime: {
+            auto value = nth_sorted_value<time_t>(query, extent, n, ascending,
+                                                  [&](TableView const& tv, size_t i) { return tv.get_datetime(col, i).get_datetime(); },
+                                                  matches);
+            if (!value)
+                return false;
+            ascending ? query.less_equal_datetime(col, DateTime(*value)) : query.greater_equal_datetime(col, DateTime(*value));
+            return true;
+        }
         default:
-            throw UnsupportedColumnTypeException{column, m_table};
+            matches = npos;
+            return false;
     }
 }
+} // anonymous namespace
 
-util::Optional<Mixed> Results::max(size_t column)
+namespace {
+template<typename T>
+int compare(T a, T b)
 {
-    return aggregate(column, true,
-                     [=](auto const& table) { return table.maximum_int(column); },
-                     [=](auto const& table) { return table.maximum_float(column); },
-                     [=](auto const& table) { return table.maximum_double(column); },
-                     [=](auto const& table) { return table.maximum_datetime(column); });
+    return a < b ? -1 : b < a;
 }
 
-util::Optional<Mixed> Results::min(size_t column)
+Results::PageAnchor::Value read_anchor_value(Table const& table, size_t col, size_t row)
 {
-    return aggregate(column, true,
-                     [=](auto const& table) { return table.minimum_int(column); },
-                     [=](auto const& table) { return table.minimum_float(column); },
-                     [=](auto const& table) { return table.minimum_double(column); },
-                     [=](auto const& table) { return table.minimum_datetime(column); });
+    switch (table.get_column_type(col)) {
+        case type_Int:      return {table.get_int(col, row), 0};
+        case type_Bool:     return {table.get_bool(col, row), 0};
+        case type_DateTime: return {table.get_datetime(col, row).get_datetime(), 0};
+        case type_Float:    return {0, table.get_float(col, row)};
+        case type_Double:   return {0, table.get_double(col, row)};
+        default: REALM_UNREACHABLE();
+    }
 }
 
-util::Optional<Mixed> Results::sum(size_t column)
+// Compare a row's values for the sort columns with those of an anchor,
+// returning a negative value if the row sorts first, zero if the values are
+// equal, and a positive value if the anchor sorts first
+int compare_to_anchor(Table const& table, size_t row, SortOrder const& sort, Results::PageAnchor const& anchor)
 {
-    return aggregate(column, false,
-                     [=](auto const& table) { return table.sum_int(column); },
-                     [=](auto const& table) { return table.sum_float(column); },
-                     [=](auto const& table) { return table.sum_double(column); },
-                     [=](auto const&) -> util::None { throw UnsupportedColumnTypeException{column, m_table}; });
+    for (size_t i = 0; i < sort.columnIndices.size(); ++i) {
+        auto a = read_anchor_value(table, sort.columnIndices[i], row);
+        auto const& b = anchor.values[i];
+        int cmp = compare(a.int_value, b.int_value);
+        if (cmp == 0)
+            cmp = compare(a.double_value, b.double_value);
+        if (cmp != 0)
+            return sort.ascending[i] ? cmp : -cmp;
+    }
+    return 0;
 }
+} // anonymous namespace
 
-util::Optional<Mixed> Results::average(size_t column)
+void Results::validate_page_sort() const
 {
-    return aggregate(column, true,
-                     [=](auto const& table) { return table.average_int(column); },
-                     [=](auto const& table) { return table.average_float(column); },
-                     [=](auto const& table) { return table.average_double(column); },
-                     [=](auto const&) -> util::None { throw UnsupportedColumnTypeException{column, m_table}; });
+    if (!m_sort)
+        throw std::logic_error("Only sorted Results can be paged.");
+    if (m_sort.has_link_paths())
+        throw std::logic_error("Results sorted on properties of linked objects can't be paged.");
+    for (size_t col : m_sort.columnIndices) {
+        switch (m_table->is_nullable(col) ? type_Mixed : m_table->get_column_type(col)) {
+            case type_Int: case type_Bool: case type_Float: case type_Double: case type_DateTime:
+                break;
+            default:
+                throw UnsupportedColumnTypeException{col, m_table};
+        }
+    }
 }
 
-void Results::clear()
+size_t Results::position_after_anchor(TableView const& sorted) const
+{
+    // Sorting is stable and starts from the rows in table order, so rows
+    // with equal values for every sort column are ordered by row index
+    auto const& anchor = *m_page_anchor;
+    size_t begin = 0, end = sorted.size();
+    while (begin < end) {
+        size_t mid = begin + (end - begin) / 2;
+        size_t row = sorted.get_source_ndx(mid);
+        int cmp = compare_to_anchor(*m_table, row, m_sort, anchor);
+        if (cmp < 0 || (cmp == 0 && row <= anchor.row))
+            begin = mid + 1;
+        else
+            end = mid;
+    }
+    return begin;
+}
+
+Results::PageAnchor Results::page_anchor(size_t index)
+{
+    validate_read();
+    if (m_mode == Mode::Empty)
+        throw OutOfBoundsIndexException{index, 0};
+    validate_page_sort();
+
+    PageAnchor anchor;
+    anchor.row = get(index).get_index();
+    for (size_t col : m_sort.columnIndices)
+        anchor.values.push_back(read_anchor_value(*m_table, col, anchor.row));
+    return anchor;
+}
+
+Results Results::page_after(PageAnchor anchor, size_t count) const
+{
+    if (m_mode == Mode::Empty)
+        return *this;
+    validate_page_sort();
+    if (has_distinct())
+        throw std::logic_error("Results with duplicates removed can't be paged.");
+    if (m_link_view)
+        throw std::logic_error("Results backed by a list can't be paged.");
+    if (m_window_base)
+        throw std::logic_error("Results derived from a limited Results can't be paged.");
+
+    Results results(m_realm, get_query(), get_sort());
+    results.m_description = get_query_description();
+    results.m_conditions = m_conditions;
+    results.m_limit = count;
+    results.m_page_anchor = std::move(anchor);
+    results.m_projection = m_projection;
+    return results;
+}
+
+bool Results::should_use_sorted_view() const
+{
+    // Filtering the sorted view scans every row of the table, and the view
+    // itself has to be resorted in each version it's used in, which only
+    // pays off over sorting the matches if a good share of the table matches
+    constexpr double min_match_fraction = 0.25;
+    return m_realm && !m_link_view && !has_distinct() && m_sort.columnIndices.size() == 1
+        && !m_sort.has_collation() && !m_sort.has_link_paths() && m_table->has_search_index(m_sort.columnIndices[0])
+        && m_match_fraction && *m_match_fraction >= min_match_fraction;
+}
+
+void Results::record_match_fraction(size_t matches)
+{
+    if (size_t rows = m_table->size()) {
+        m_match_fraction = double(matches) / rows;
+    }
+}
+
+void Results::run_query()
+{
+    m_sorted_view.reset();
+    if (m_window_base) {
+        // The window is applied to the Results it was set on, so the query,
+        // sort and duplicate removal of this one only see the rows in it
+        m_window_rows = std::make_shared<TableView>(m_window_base->get_tableview());
+        m_table_view = m_table->where(m_window_rows.get()).and_query(m_query).find_all();
+        if (m_sort) {
+            _impl::sort_tableview(m_table_view, m_sort, m_realm.get());
+        }
+        if (has_distinct()) {
+            m_table_view.distinct(m_distinct_column);
+        }
+        return;
+    }
+    if (has_distinct()) {
+        // The limit applies to the distinct rows, so every match has to be
+        // found before the duplicates are removed
+        m_table_view = m_query.find_all();
+        if (m_sort) {
+            _impl::sort_tableview(m_table_view, m_sort, m_realm.get());
+        }
+        m_table_view.distinct(m_distinct_column);
+        return;
+    }
+
+    if (should_use_sorted_view()) {
+        // Filtering the already-sorted rows produces the matches in sorted
+        // order, and for limited Results lets the query stop as soon as
+        // enough rows are found. Pages start the search from the anchor.
+        m_sorted_view = m_realm->get_sorted_view(*m_table, m_sort.columnIndices[0], m_sort.ascending[0]);
+        size_t start = 0;
+        if (is_paged()) {
+            start = position_after_anchor(*m_sorted_view);
+            m_offset = 0;
+        }
+        size_t end = limit_end();
+        m_table_view = m_table->where(m_sorted_view.get()).and_query(m_query).find_all(start, size_t(-1), end);
+        // A search which stopped at the limit only saw part of the table, so
+        // the fraction found last time is kept
+        if (m_table_view.size() < end) {
+            record_match_fraction(m_table_view.size());
+        }
+        return;
+    }
+
+    if (is_paged()) {
+        m_table_view = m_query.find_all();
+        record_match_fraction(m_table_view.size());
+        _impl::sort_tableview(m_table_view, m_sort, m_realm.get());
+        m_offset = position_after_anchor(m_table_view);
+        return;
+    }
+
+    if (!is_limited()) {
+        m_table_view = m_query.find_all();
+        if (m_sort) {
+            record_match_fraction(m_table_view.size());
+            _impl::sort_tableview(m_table_view, m_sort, m_realm.get());
+        }
+        return;
+    }
+
+    size_t end = limit_end();
+    if (end == 0) {
+        m_table_view = m_query.find_all(0, size_t(-1), 0);
+        return;
+    }
+    if (!m_sort) {
+        m_table_view = m_query.find_all(0, size_t(-1), end);
+        return;
+    }
+
+    // Rather than sorting every matching row, select the boundary value of
+    // the first sort column in linear time and then only find and sort the
+    // rows which can come before it
+    Query bounded_query = m_query;
+    size_t matches;
+    add_sort_bound(bounded_query, m_link_view ? m_link_view->size() : m_table->size(), m_sort, end, matches);
+    m_table_view = bounded_query.find_all();
+    record_match_fraction(matches == npos ? m_table_view.size() : matches);
+    _impl::sort_tableview(m_table_view, m_sort, m_realm.get());
+}
+
+void Results::report_query_time(std::chrono::steady_clock::time_point start) const
+{
+    if (!m_realm) {
+        return;
+    }
+
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    m_realm->metrics().results_evaluation.add(elapsed);
+    if (auto workload = m_realm->query_workload()) {
+        record_query_run(*workload, elapsed);
+    }
+
+    auto& config = m_realm->config();
+    if (!config.slow_query_function) {
+        return;
+    }
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(elapsed);
+    if (duration >= config.slow_query_threshold) {
+        config.slow_query_function(describe(), duration);
+    }
+}
+
+void Results::record_query_run(QueryWorkload& workload, std::chrono::nanoseconds duration) const
+{
+    if (m_mode == Mode::Empty) {
+        return;
+    }
+
+    auto conditions = m_conditions;
+    for (size_t i = 0; i < m_sort.columnIndices.size(); ++i) {
+        if (i >= m_sort.link_paths.size() || m_sort.link_paths[i].empty()) {
+            conditions.push_back({m_sort.columnIndices[i], QueryCondition::Kind::Sort});
+        }
+    }
+    size_t rows_scanned = m_link_view ? m_link_view->size() : m_table->size();
+    workload.record(ObjectStore::object_type_for_table_name(m_table->get_name()), std::move(conditions),
+                    rows_scanned, duration);
+}
+
+void Results::set_query_conditions(ConditionsFunction const& conditions)
+{
+    if (m_realm && m_realm->query_workload()) {
+        m_conditions = conditions();
+    }
+}
+
+std::string Results::describe() const
 {
+    std::string description;
     switch (m_mode) {
         case Mode::Empty:
-            return;
+            return "FALSEPREDICATE";
         case Mode::Table:
-            validate_write();
-            m_table->clear();
+            description = "TRUEPREDICATE";
             break;
         case Mode::Query:
-            // Not using Query:remove() because building the tableview and
-            // clearing it is actually significantly faster
         case Mode::TableView:
-            validate_write();
-            update_tableview();
-            m_table_view.clear(RemoveMode::unordered);
+            description = m_description ? m_description() : "(unknown query)";
             break;
     }
+    if (m_window_base) {
+        description = "WITHIN(" + m_window_base->describe() + ") " + description;
+    }
+
+    for (size_t i = 0; i < m_sort.columnIndices.size(); ++i) {
+        description += i == 0 ? " SORT(" : ", ";
+        Table* table = m_table;
+        if (i < m_sort.link_paths.size()) {
+            for (size_t col : m_sort.link_paths[i]) {
+                description += std::string(table->get_column_name(col)) + ".";
+                table = table->get_link_target(col).get();
+            }
+        }
+        description += table->get_column_name(m_sort.columnIndices[i]);
+        description += m_sort.ascending[i] ? " ASC" : " DESC";
+        if (i < m_sort.collations.size() && m_sort.collations[i]) {
+            description += " COLLATE " + m_sort.collations[i]->name;
+        }
+    }
+    if (m_sort) {
+        description += ")";
+    }
+    if (has_distinct()) {
+        description += " DISTINCT(" + std::string(m_table->get_column_name(m_distinct_column)) + ")";
+    }
+    if (m_limit != size_t(-1)) {
+        description += " LIMIT(" + std::to_string(m_limit) + ")";
+    }
+    if (is_paged()) {
+        description += " AFTER(" + std::to_string(m_page_anchor->row) + ")";
+    }
+    else if (m_offset != 0) {
+        description += " OFFSET(" + std::to_string(m_offset) + ")";
+    }
+    return description;
 }
 
-Query Results::get_query() const
+Results::DescriptionFunction Results::get_query_description() const
 {
-    validate_read();
-    switch (m_mode) {
-        case Mode::Empty:
-        case Mode::Query:
-        case Mode::TableView:
-            return m_query;
-        case Mode::Table:
-            return m_table->where();
+    if (m_mode == Mode::Table) {
+        return [] { return std::string("TRUEPREDICATE"); };
     }
-    REALM_UNREACHABLE();
+    return m_description;
 }
 
-TableView Results::get_tableview()
+Results::Explanation Results::explain()
 {
     validate_read();
+
+    Explanation explanation;
+    explanation.description = describe();
     switch (m_mode) {
         case Mode::Empty:
-            return {};
+            return explanation;
+        case Mode::Table:
+            // No query is run, and every row is included
+            explanation.matches = m_table->size();
+            return explanation;
         case Mode::Query:
         case Mode::TableView:
-            update_tableview();
-            return m_table_view;
-        case Mode::Table:
-            return m_table->where().find_all();
+            break;
     }
-    REALM_UNREACHABLE();
+
+    explanation.rows_scanned = m_link_view ? m_link_view->size() : m_table->size();
+    auto start = std::chrono::steady_clock::now();
+    run_query();
+    explanation.duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    explanation.matches = m_table_view.size();
+
+    m_mode = Mode::TableView;
+    if (m_realm) {
+        m_synced_version = m_realm->current_transaction_version();
+        m_synced_write_count = m_realm->write_transaction_count();
+    }
+    return explanation;
 }
 
-StringData Results::get_object_type() const noexcept
+TableView Results::limited_view()
 {
-    return ObjectStore::object_type_for_table_name(m_table->get_name());
+    return m_table->where(&m_table_view).find_all(m_offset, std::min(limit_end(), m_table_view.size()));
 }
 
-Results Results::sort(realm::SortOrder&& sort) const
+namespace {
+// Get the changes made to every table since the given read transaction
+// version and write transaction count. Returns false if the changes can't be
+// determined.
+bool get_changes(Realm const& realm, uint_fast64_t version, size_t write_count,
+                 _impl::TransactionChangeInfo& info)
 {
-    return Results(m_realm, get_query(), std::move(sort));
+    // Local writes aren't recorded
+    if (realm.is_in_transaction() || realm.write_transaction_count() != write_count) {
+        return false;
+    }
+    if (realm.current_transaction_version() == version) {
+        info = {};
+        return true;
+    }
+    return realm.get_changes_since(version, info) && !info.schema_changed;
 }
 
-Results Results::filter(Query&& q) const
+// Get the changes to `table` from the changes to every table, without
+// considering changes to the tables it links to
+_impl::TransactionChangeInfo::TableChanges table_changes(_impl::TransactionChangeInfo const& info, Table const& table)
 {
-    return Results(m_realm, get_query().and_query(std::move(q)), get_sort());
+    size_t table_ndx = table.get_index_in_group();
+    if (table_ndx < info.tables.size()) {
+        return info.tables[table_ndx];
+    }
+    return {};
+}
+
+// Can the rows of the table matched by a query have been affected by changes
+// to other tables via links?
+bool links_modified(_impl::TransactionChangeInfo const& info, Table const& table)
+{
+    size_t table_ndx = table.get_index_in_group();
+    for (size_t col = 0, count = table.get_column_count(); col < count; ++col) {
+        auto type = table.get_column_type(col);
+        if (type == type_Link || type == type_LinkList) {
+            for (size_t i = 0; i < info.tables.size(); ++i) {
+                if (i != table_ndx && !info.tables[i].empty()) {
+                    return true;
+                }
+            }
+            return false;
+        }
+    }
+    return false;
+}
+
+// Get the changes made to `table` since the given read transaction version
+// and write transaction count. Returns false if the changes can't be
+// determined, or if rows in the table may have been affected by changes to
+// other tables via links.
+bool get_table_changes(Realm const& realm, Table const& table, bool is_link_view,
+                       uint_fast64_t version, size_t write_count,
+                       _impl::TransactionChangeInfo::TableChanges& changes)
+{
+    // Queries restricted to a LinkView can change without any rows in the
+    // target table changing
+    _impl::TransactionChangeInfo info;
+    if (is_link_view || !get_changes(realm, version, write_count, info) || links_modified(info, table)) {
+        return false;
+    }
+    changes = table_changes(info, table);
+    return true;
+}
+} // anonymous namespace
+
+bool Results::link_view_tableview_is_up_to_date() const
+{
+    // Each modified row has to be searched for in the LinkView, so only a
+    // few of them are checked before giving up and rerunning the query
+    static const size_t max_rows_to_check = 16;
+
+    _impl::TransactionChangeInfo info;
+    if (!m_realm || !m_link_view->is_attached()
+        || !get_changes(*m_realm, m_synced_version, m_synced_write_count, info)
+        || links_modified(info, *m_table)) {
+        return false;
+    }
+
+    // The list itself can only have changed if its row in the origin table
+    // was modified. Rows appended to the target table can't be in the list
+    // without it being modified.
+    auto origin_changes = table_changes(info, m_link_view->get_origin_table());
+    if (origin_changes.rows_moved || origin_changes.modifications.contains(m_link_view->get_origin_row_index())) {
+        return false;
+    }
+
+    // A modified row in the list may no longer match, may now match or may
+    // sort differently, but rows not in the list don't matter
+    auto changes = table_changes(info, *m_table);
+    if (changes.rows_moved) {
+        return false;
+    }
+    size_t rows_checked = 0;
+    for (auto range : changes.modifications) {
+        for (size_t row_ndx = range.first; row_ndx < range.second && row_ndx < changes.insertions_start; ++row_ndx) {
+            if (++rows_checked > max_rows_to_check || m_link_view->find(row_ndx) != not_found) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool Results::tableview_is_up_to_date() const
+{
+    // Rechecking each modified row is only worthwhile for a small number of
+    // modifications; past this a full rerun of the query is likely faster
+    static const size_t max_rows_to_check = 1000;
+
+    if (m_link_view) {
+        return link_view_tableview_is_up_to_date();
+    }
+
+    _impl::TransactionChangeInfo::TableChanges changes;
+    if (!m_realm || !get_table_changes(*m_realm, *m_table, bool(m_link_view), m_synced_version, m_synced_write_count, changes)) {
+        return false;
+    }
+    if (changes.empty()) {
+        return true;
+    }
+    if (changes.rows_moved) {
+        return false;
+    }
+
+    // New rows are only appended, so none of them can already be in the
+    // tableview and it's out of date if any of them match
+    size_t table_size = m_table->size();
+    if (changes.insertions_start < table_size && m_query.count(changes.insertions_start, table_size) != 0) {
+        return false;
+    }
+
+    // A row from an unsorted query has its position in the tableview in
+    // ascending order of row index, so it can be found with a binary search
+    auto contains = [&](size_t row_ndx) {
+        if (m_sort) {
+            return m_table_view.find_by_source_ndx(row_ndx) != not_found;
+        }
+        size_t low = 0, high = m_table_view.size();
+        while (low < high) {
+            size_t mid = low + (high - low) / 2;
+            size_t source_ndx = m_table_view.get_source_ndx(mid);
+            if (source_ndx == row_ndx) {
+                return true;
+            }
+            if (source_ndx < row_ndx) {
+                low = mid + 1;
+            }
+            else {
+                high = mid;
+            }
+        }
+        return false;
+    };
+
+    // Changes to linked objects were ruled out by get_table_changes(), so
+    // only the links to them can have changed the order
+    bool sort_column_modified = false;
+    for (size_t i = 0; i < m_sort.columnIndices.size(); ++i) {
+        sort_column_modified = sort_column_modified || changes.column_modified(m_sort.source_column(i));
+    }
+    // Which row is the first one with each value can change when any match
+    // is modified
+    if (has_distinct() && changes.column_modified(m_distinct_column)) {
+        return false;
+    }
+
+    // Modified rows must still match the query exactly when they're in the
+    // tableview, and must not have been moved if the tableview is sorted
+    size_t rows_checked = 0;
+    for (auto range : changes.modifications) {
+        for (size_t row_ndx = range.first; row_ndx < range.second && row_ndx < changes.insertions_start; ++row_ndx) {
+            if (++rows_checked > max_rows_to_check) {
+                return false;
+            }
+            bool is_present = contains(row_ndx);
+            if (is_present != (m_query.count(row_ndx, row_ndx + 1) != 0)) {
+                return false;
+            }
+            if (is_present && sort_column_modified) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool Results::update_sorted_tableview()
+{
+    // Sorting by core compares strings and nulls in ways which aren't
+    // reproduced by SortComparator, so views sorted by core on such columns
+    // can't be updated. Views sorted with a collation were sorted by it.
+    // Views sorted through links depend on the changes to the linked tables,
+    // which aren't tracked here.
+    if (m_sort.has_link_paths()) {
+        return false;
+    }
+    if (!m_sort.has_collation()) {
+        for (size_t col : m_sort.columnIndices) {
+            if (m_table->is_nullable(col) || m_table->get_column_type(col) == type_String) {
+                return false;
+            }
+        }
+    }
+
+    _impl::TransactionChangeInfo::TableChanges changes;
+    if (m_link_view || !m_realm || !get_table_changes(*m_realm, *m_table, false, m_synced_version, m_synced_write_count, changes)
+        || changes.row_indexes_lost) {
+        return false;
+    }
+
+    // Rows whose position has to be found again: modified and appended rows,
+    // and rows moved by erasing or swapping other rows, as rows with equal
+    // values are ordered by row index. Rows shifted down by erasing the rows
+    // before them keep their order relative to each other.
+    std::vector<size_t> moved;
+    for (auto const& change : changes.row_index_changes) {
+        using Kind = _impl::TransactionChangeInfo::TableChanges::RowIndexChange::Kind;
+        switch (change.kind) {
+            case Kind::Insert:
+                return false;
+            case Kind::Erase: {
+                size_t end = change.row + change.other_or_count;
+                auto out = moved.begin();
+                for (size_t row : moved) {
+                    if (row < change.row)
+                        *out++ = row;
+                    else if (row >= end)
+                        *out++ = row - change.other_or_count;
+                }
+                moved.erase(out, moved.end());
+                break;
+            }
+            case Kind::MoveLastOver:
+                moved.erase(std::remove(moved.begin(), moved.end(), change.row), moved.end());
+                std::replace(moved.begin(), moved.end(), change.other_or_count, change.row);
+                if (change.row != change.other_or_count)
+                    moved.push_back(change.row);
+                break;
+            case Kind::Swap:
+                for (auto& row : moved) {
+                    if (row == change.row)
+                        row = change.other_or_count;
+                    else if (row == change.other_or_count)
+                        row = change.row;
+                }
+                moved.push_back(change.row);
+                moved.push_back(change.other_or_count);
+                break;
+            case Kind::Clear:
+                moved.clear();
+                break;
+        }
+    }
+
+    size_t table_size = m_table->size();
+    size_t old_rows_end = std::min(changes.insertions_start, table_size);
+    std::vector<size_t> changed = std::move(moved);
+    for (auto const& range : changes.modifications) {
+        for (size_t row = range.first; row < std::min(range.second, old_rows_end); ++row) {
+            changed.push_back(row);
+        }
+    }
+    for (size_t row = old_rows_end; row < table_size; ++row) {
+        changed.push_back(row);
+    }
+    // Past this sorting every match is faster than positioning each row
+    if (changed.size() > m_table_view.size() / 8 + 16) {
+        return false;
+    }
+    std::sort(changed.begin(), changed.end());
+    changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+
+    // The unchanged rows are still in order once mapped to their new indexes
+    std::vector<size_t> rows;
+    rows.reserve(m_table_view.size() + changed.size());
+    for (size_t i = 0, size = m_table_view.size(); i < size; ++i) {
+        size_t row = m_table_view.get_source_ndx(i);
+        if (changes.rows_moved) {
+            row = changes.new_row_index(row);
+        }
+        if (row != npos && !std::binary_search(changed.begin(), changed.end(), row)) {
+            rows.push_back(row);
+        }
+    }
+
+    _impl::SortComparator comparator(*m_table, m_sort, m_realm.get());
+    comparator.prepare(rows);
+    comparator.prepare(changed);
+    auto less = [&](size_t a, size_t b) {
+        int cmp = comparator.compare(a, b);
+        return cmp < 0 || (cmp == 0 && a < b);
+    };
+    // Sort the changed rows which still match among themselves and then
+    // merge them into the unchanged ones, rather than inserting each one in
+    // turn and moving every row after it
+    changed.erase(std::remove_if(changed.begin(), changed.end(),
+                                 [&](size_t row) { return m_query.count(row, row + 1) == 0; }),
+                  changed.end());
+    std::sort(changed.begin(), changed.end(), less);
+    std::vector<size_t> merged;
+    merged.reserve(rows.size() + changed.size());
+    std::merge(rows.begin(), rows.end(), changed.begin(), changed.end(), std::back_inserter(merged), less);
+    rows = std::move(merged);
+
+    // Finding the matches is still needed to get a tableview of the right
+    // size, but it's cheap compared to sorting them
+    TableView tv = m_query.find_all();
+    if (tv.size() != rows.size()) {
+        return false;
+    }
+    _impl::set_tableview_order(tv, rows);
+    m_table_view = std::move(tv);
+    return true;
+}
+
+void Results::validate_query_cache()
+{
+    update_expiry_cutoff();
+    auto& cache = m_query_cache;
+    if (!cache.count && !cache.first_row && !cache.matching_rows) {
+        return;
+    }
+
+    _impl::TransactionChangeInfo::TableChanges changes;
+    if (!m_realm || !get_table_changes(*m_realm, *m_table, bool(m_link_view), cache.version, cache.write_count, changes)
+        || !changes.empty()) {
+        cache = {};
+        return;
+    }
+    cache.version = m_realm->current_transaction_version();
+}
+
+void Results::update_query_cache_version()
+{
+    if (m_realm) {
+        m_query_cache.version = m_realm->current_transaction_version();
+        m_query_cache.write_count = m_realm->write_transaction_count();
+    }
+}
+
+size_t Results::query_count()
+{
+    validate_query_cache();
+    if (!m_query_cache.count) {
+        auto start = std::chrono::steady_clock::now();
+        if (can_parallelize()) {
+            std::vector<size_t> counts(_impl::ParallelQuery::chunk_count(m_table->size()));
+            _impl::ParallelQuery::for_each_chunk(*m_realm, m_query, m_table->size(),
+                                          [&](size_t chunk, Query& query, size_t begin, size_t end) {
+                counts[chunk] = query.count(begin, end);
+            });
+            size_t count = 0;
+            for (size_t c : counts)
+                count += c;
+            m_query_cache.count = count;
+        }
+        else {
+            m_query_cache.count = window_size(m_query.count(0, size_t(-1), limit_end()));
+        }
+        report_query_time(start);
+        update_query_cache_version();
+    }
+    return *m_query_cache.count;
+}
+
+std::vector<size_t> const& Results::matching_rows()
+{
+    validate_query_cache();
+    if (!m_query_cache.matching_rows) {
+        auto start = std::chrono::steady_clock::now();
+        auto tv = m_query.find_all();
+        std::vector<size_t> rows(tv.size());
+        for (size_t i = 0; i < rows.size(); ++i) {
+            rows[i] = tv.get_source_ndx(i);
+        }
+        m_query_cache.count = rows.size();
+        m_query_cache.first_row = rows.empty() ? not_found : rows.front();
+        m_query_cache.matching_rows = std::move(rows);
+        report_query_time(start);
+        update_query_cache_version();
+    }
+    return *m_query_cache.matching_rows;
+}
+
+size_t Results::index_of(Row const& row)
+{
+    validate_read();
+    if (!row) {
+        throw DetatchedAccessorException{};
+    }
+    if (m_table && row.get_table() != m_table) {
+        throw IncorrectTableException{
+            ObjectStore::object_type_for_table_name(m_table->get_name()),
+            ObjectStore::object_type_for_table_name(row.get_table()->get_name())};
+    }
+    return index_of(row.get_index());
+}
+
+size_t Results::index_of(size_t row_ndx)
+{
+    validate_read();
+    switch (m_mode) {
+        case Mode::Empty:
+            return not_found;
+        case Mode::Table:
+            return row_ndx;
+        case Mode::Query:
+            // Queries restricted to a LinkView take positions in the LinkView
+            // rather than row indexes as their bounds
+            if (!m_sort && !m_link_view && !is_limited() && !has_distinct()) {
+                auto const& rows = matching_rows();
+                auto it = std::lower_bound(rows.begin(), rows.end(), row_ndx);
+                return it != rows.end() && *it == row_ndx ? size_t(it - rows.begin()) : not_found;
+            }
+            REALM_FALLTHROUGH;
+        case Mode::TableView: {
+            update_tableview();
+            size_t ndx = m_table_view.find_by_source_ndx(row_ndx);
+            if (ndx == not_found || ndx < m_offset || ndx - m_offset >= m_limit)
+                return not_found;
+            return ndx - m_offset;
+        }
+    }
+    REALM_UNREACHABLE();
+}
+
+size_t Results::index_of(Query&& q)
+{
+    validate_read();
+    if (m_mode == Mode::Empty) {
+        return not_found;
+    }
+    if (!is_limited() && !has_distinct()) {
+        size_t row = get_query().and_query(std::move(q)).find();
+        return row == not_found ? not_found : index_of(row);
+    }
+
+    // The query doesn't know about the limit or the removed duplicates, so
+    // search only the window of the tableview
+    update_tableview();
+    size_t end = std::min(limit_end(), m_table_view.size());
+    if (m_offset >= end) {
+        return not_found;
+    }
+    auto matches = m_table->where(&m_table_view).and_query(std::move(q)).find_all(m_offset, end, 1);
+    return matches.size() == 0 ? not_found : index_of(matches.get_source_ndx(0));
+}
+
+bool Results::can_parallelize() const
+{
+    if (!m_realm)
+        return false;
+    // Sorting doesn't change the count or aggregates, but queries restricted
+    // to a LinkView, limited to a window or with duplicates removed can't be
+    // split by row index
+    if (m_mode != Mode::Table && (m_mode != Mode::Query || m_link_view || is_limited() || has_distinct()))
+        return false;
+    return _impl::ParallelQuery::should_parallelize(*m_realm, m_table->size());
+}
+
+util::Optional<Mixed> Results::parallel_aggregate(size_t column, AggregateOperation op)
+{
+    // The matching row count and the min, max or sum of each chunk, which are
+    // combined once all of the chunks have been evaluated
+    struct Partial {
+        size_t count = 0;
+        int64_t int_value = 0;
+        double double_value = 0;
+    };
+
+    DataType type = m_table->get_column_type(column);
+    std::vector<Partial> partials(_impl::ParallelQuery::chunk_count(m_table->size()));
+    _impl::ParallelQuery::for_each_chunk(*m_realm, get_query(), m_table->size(),
+                                  [&](size_t chunk, Query& query, size_t begin, size_t end) {
+        auto& partial = partials[chunk];
+        switch (op) {
+            case AggregateOperation::Min:
+                if (type == type_Int)
+                    partial.int_value = query.minimum_int(column, &partial.count, begin, end);
+                else if (type == type_Float)
+                    partial.double_value = query.minimum_float(column, &partial.count, begin, end);
+                else
+                    partial.double_value = query.minimum_double(column, &partial.count, begin, end);
+                break;
+            case AggregateOperation::Max:
+                if (type == type_Int)
+                    partial.int_value = query.maximum_int(column, &partial.count, begin, end);
+                else if (type == type_Float)
+                    partial.double_value = query.maximum_float(column, &partial.count, begin, end);
+                else
+                    partial.double_value = query.maximum_double(column, &partial.count, begin, end);
+                break;
+            case AggregateOperation::Sum:
+            case AggregateOperation::Average:
+                if (type == type_Int)
+                    partial.int_value = query.sum_int(column, &partial.count, begin, end);
+                else if (type == type_Float)
+                    partial.double_value = query.sum_float(column, &partial.count, begin, end);
+                else
+                    partial.double_value = query.sum_double(column, &partial.count, begin, end);
+                break;
+        }
+    });
+
+    Partial total;
+    bool first = true;
+    for (auto const& partial : partials) {
+        if (partial.count == 0)
+            continue;
+        if (op == AggregateOperation::Sum || op == AggregateOperation::Average || first) {
+            total.int_value = first ? partial.int_value : total.int_value + partial.int_value;
+            total.double_value = first ? partial.double_value : total.double_value + partial.double_value;
+        }
+        else if (op == AggregateOperation::Min) {
+            total.int_value = std::min(total.int_value, partial.int_value);
+            total.double_value = std::min(total.double_value, partial.double_value);
+        }
+        else {
+            total.int_value = std::max(total.int_value, partial.int_value);
+            total.double_value = std::max(total.double_value, partial.double_value);
+        }
+        total.count += partial.count;
+        first = false;
+    }
+
+    if (total.count == 0 && op != AggregateOperation::Sum)
+        return none;
+    switch (op) {
+        case AggregateOperation::Min:
+        case AggregateOperation::Max:
+            if (type == type_Int)
+                return util::Optional<Mixed>(total.int_value);
+            if (type == type_Float)
+                return util::Optional<Mixed>(float(total.double_value));
+            return util::Optional<Mixed>(total.double_value);
+        case AggregateOperation::Sum:
+            if (type == type_Int)
+                return util::Optional<Mixed>(total.int_value);
+            return util::Optional<Mixed>(total.double_value);
+        case AggregateOperation::Average:
+            if (type == type_Int)
+                return util::Optional<Mixed>(double(total.int_value) / total.count);
+            return util::Optional<Mixed>(total.double_value / total.count);
+    }
+    REALM_UNREACHABLE();
+}
+
+template<typename Int, typename Float, typename Double, typename DateTime>
+util::Optional<Mixed> Results::aggregate(size_t column, AggregateOperation op,
+                                         Int agg_int, Float agg_float,
+                                         Double agg_double, DateTime agg_datetime)
+{
+    validate_read();
+    if (!m_table)
+        return none;
+    if (column > m_table->get_column_count())
+        throw OutOfBoundsIndexException{column, m_table->get_column_count()};
+
+    bool return_none_for_empty = op != AggregateOperation::Sum;
+    auto type = m_table->get_column_type(column);
+    // Null values are skipped by the aggregates but would still be counted
+    // as matches by the chunks, so nullable columns are aggregated serially
+    if ((type == type_Int || type == type_Float || type == type_Double)
+        && !m_table->is_nullable(column) && can_parallelize()) {
+        return parallel_aggregate(column, op);
+    }
+
+    auto do_agg = [&](auto const& getter) -> util::Optional<Mixed> {
+        switch (m_mode) {
+            case Mode::Empty:
+                return none;
+            case Mode::Table:
+                if (return_none_for_empty && m_table->size() == 0)
+                    return none;
+                return util::Optional<Mixed>(getter(*m_table));
+            case Mode::Query:
+            case Mode::TableView:
+                this->update_tableview();
+                if (return_none_for_empty && window_size(m_table_view.size()) == 0)
+                    return none;
+                if (is_limited())
+                    return util::Optional<Mixed>(getter(limited_view()));
+                return util::Optional<Mixed>(getter(m_table_view));
+        }
+        REALM_UNREACHABLE();
+    };
+
+    switch (type)
+    {
+        case type_DateTime: return do_agg(agg_datetime);
+        case type_Double: return do_agg(agg_double);
+        case type_Float: return do_agg(agg_float);
+        case type_Int: return do_agg(agg_int);
+        default:
+            throw UnsupportedColumnTypeException{column, m_table};
+    }
+}
+
+util::Optional<Mixed> Results::max(size_t column)
+{
+    return aggregate(column, AggregateOperation::Max,
+                     [=](auto const& table) { return table.maximum_int(column); },
+                     [=](auto const& table) { return table.maximum_float(column); },
+                     [=](auto const& table) { return table.maximum_double(column); },
+                     [=](auto const& table) { return table.maximum_datetime(column); });
+}
+
+util::Optional<Mixed> Results::min(size_t column)
+{
+    return aggregate(column, AggregateOperation::Min,
+                     [=](auto const& table) { return table.minimum_int(column); },
+                     [=](auto const& table) { return table.minimum_float(column); },
+                     [=](auto const& table) { return table.minimum_double(column); },
+                     [=](auto const& table) { return table.minimum_datetime(column); });
+}
+
+util::Optional<Mixed> Results::sum(size_t column)
+{
+    return aggregate(column, AggregateOperation::Sum,
+                     [=](auto const& table) { return table.sum_int(column); },
+                     [=](auto const& table) { return table.sum_float(column); },
+                     [=](auto const& table) { return table.sum_double(column); },
+                     [=](auto const&) -> util::None { throw UnsupportedColumnTypeException{column, m_table}; });
+}
+
+util::Optional<Mixed> Results::average(size_t column)
+{
+    return aggregate(column, AggregateOperation::Average,
+                     [=](auto const& table) { return table.average_int(column); },
+                     [=](auto const& table) { return table.average_float(column); },
+                     [=](auto const& table) { return table.average_double(column); },
+                     [=](auto const&) -> util::None { throw UnsupportedColumnTypeException{column, m_table}; });
+}
+
+namespace {
+// The running state for all of the aggregates requested on a single column
+// in Results::aggregate_many()
+struct ColumnAggregator {
+    size_t column;
+    DataType type;
+    bool nullable;
+
+    size_t count = 0;
+    int64_t int_min = 0, int_max = 0, int_sum = 0;
+    double double_min = 0, double_max = 0, double_sum = 0;
+
+    ColumnAggregator(Table const& table, size_t column)
+    : column(column)
+    , type(table.get_column_type(column))
+    , nullable(table.is_nullable(column))
+    {
+    }
+
+    void add(Table const& table, size_t row)
+    {
+        if (nullable && table.is_null(column, row))
+            return;
+
+        switch (type) {
+            case type_Int:
+                add_int(table.get_int(column, row));
+                break;
+            case type_DateTime:
+                add_int(table.get_datetime(column, row).get_datetime());
+                break;
+            case type_Float:
+                add_double(table.get_float(column, row));
+                break;
+            case type_Double:
+                add_double(table.get_double(column, row));
+                break;
+            default:
+                REALM_UNREACHABLE();
+        }
+        ++count;
+    }
+
+    void add_int(int64_t value)
+    {
+        int_min = count == 0 ? value : std::min(int_min, value);
+        int_max = count == 0 ? value : std::max(int_max, value);
+        int_sum += value;
+    }
+
+    void add_double(double value)
+    {
+        double_min = count == 0 ? value : std::min(double_min, value);
+        double_max = count == 0 ? value : std::max(double_max, value);
+        double_sum += value;
+    }
+
+    // The min or max value, as the column's type
+    Mixed value(int64_t int_value, double double_value) const
+    {
+        switch (type) {
+            case type_Int: return Mixed(int_value);
+            case type_DateTime: return Mixed(DateTime(int_value));
+            case type_Float: return Mixed(float(double_value));
+            default: return Mixed(double_value);
+        }
+    }
+
+    util::Optional<Mixed> get(Results::AggregateOperation op) const
+    {
+        using Op = Results::AggregateOperation;
+        switch (op) {
+            case Op::Min:
+                if (count == 0)
+                    return none;
+                return util::make_optional(value(int_min, double_min));
+            case Op::Max:
+                if (count == 0)
+                    return none;
+                return util::make_optional(value(int_max, double_max));
+            case Op::Sum:
+                return util::make_optional(type == type_Int ? Mixed(int_sum) : Mixed(double_sum));
+            case Op::Average:
+                if (count == 0)
+                    return none;
+                return util::make_optional(Mixed((type == type_Int ? double(int_sum) : double_sum) / count));
+        }
+        REALM_UNREACHABLE();
+    }
+};
+
+// Validate the requested aggregates and set up one aggregator for each
+// distinct column they use, storing the index of the aggregator for each
+// aggregate in `aggregator_for_request`
+std::vector<ColumnAggregator> make_column_aggregators(Table* table,
+                                                      std::vector<std::pair<size_t, Results::AggregateOperation>> const& aggregates,
+                                                      std::vector<size_t>& aggregator_for_request)
+{
+    std::vector<ColumnAggregator> columns;
+    aggregator_for_request.reserve(aggregates.size());
+    for (auto const& aggregate : aggregates) {
+        size_t column = aggregate.first;
+        if (column >= table->get_column_count())
+            throw Results::OutOfBoundsIndexException{column, table->get_column_count()};
+
+        switch (table->get_column_type(column)) {
+            case type_Int: case type_Float: case type_Double:
+                break;
+            case type_DateTime:
+                if (aggregate.second == Results::AggregateOperation::Min || aggregate.second == Results::AggregateOperation::Max)
+                    break;
+                REALM_FALLTHROUGH;
+            default:
+                throw Results::UnsupportedColumnTypeException{column, table};
+        }
+
+        auto it = std::find_if(columns.begin(), columns.end(), [=](auto const& c) { return c.column == column; });
+        if (it == columns.end()) {
+            columns.emplace_back(*table, column);
+            it = columns.end() - 1;
+        }
+        aggregator_for_request.push_back(it - columns.begin());
+    }
+    return columns;
+}
+
+// The aggregators for the rows of a single group in Results::group_by()
+struct GroupAggregator {
+    size_t first_row;
+    size_t count;
+    std::vector<ColumnAggregator> columns;
+
+    void add(Table const& table, size_t row)
+    {
+        ++count;
+        for (auto& column : columns)
+            column.add(table, row);
+    }
+};
+
+// The value of an Int, Bool or DateTime column as an integer, for use as the
+// key of a group
+int64_t group_key_int(Table const& table, DataType type, size_t column, size_t row)
+{
+    switch (type) {
+        case type_Bool: return table.get_bool(column, row);
+        case type_DateTime: return table.get_datetime(column, row).get_datetime();
+        default: return table.get_int(column, row);
+    }
+}
+
+Mixed group_key_value(Table const& table, DataType type, size_t column, size_t row)
+{
+    switch (type) {
+        case type_Bool: return Mixed(table.get_bool(column, row));
+        case type_DateTime: return Mixed(table.get_datetime(column, row));
+        case type_String: return Mixed(table.get_string(column, row));
+        default: return Mixed(table.get_int(column, row));
+    }
+}
+} // anonymous namespace
+
+namespace {
+template<typename T> T get_column_value(Table const& table, size_t column, size_t row);
+template<> int64_t get_column_value(Table const& table, size_t column, size_t row) { return table.get_int(column, row); }
+template<> float get_column_value(Table const& table, size_t column, size_t row) { return table.get_float(column, row); }
+template<> double get_column_value(Table const& table, size_t column, size_t row) { return table.get_double(column, row); }
+}
+
+template<typename T>
+size_t Results::copy_column_values(size_t column, DataType type, T* out, uint8_t* nulls)
+{
+    validate_read();
+    if (!m_table)
+        return 0;
+    if (column >= m_table->get_column_count())
+        throw OutOfBoundsIndexException{column, m_table->get_column_count()};
+    if (m_table->get_column_type(column) != type)
+        throw UnsupportedColumnTypeException{column, m_table};
+
+    size_t count;
+    if (m_mode == Mode::Table) {
+        count = m_table->size();
+    }
+    else {
+        update_tableview();
+        count = window_size(m_table_view.size());
+    }
+
+    bool nullable = m_table->is_nullable(column);
+    if (nulls)
+        std::fill(nulls, nulls + (count + 7) / 8, 0);
+
+    auto copy = [&](size_t i, size_t row) {
+        if (row == npos || (nullable && m_table->is_null(column, row))) {
+            out[i] = T();
+            if (nulls)
+                nulls[i / 8] |= uint8_t(1) << (i % 8);
+        }
+        else {
+            out[i] = get_column_value<T>(*m_table, column, row);
+        }
+    };
+
+    if (m_mode == Mode::Table) {
+        for (size_t i = 0; i < count; ++i)
+            copy(i, i);
+    }
+    else {
+        for (size_t i = 0; i < count; ++i) {
+            size_t ndx = m_offset + i;
+            copy(i, m_table_view.is_row_attached(ndx) ? m_table_view.get_source_ndx(ndx) : npos);
+        }
+    }
+    return count;
+}
+
+ColumnStatistics Results::column_statistics(size_t column)
+{
+    validate_read();
+    if (!m_table)
+        return {};
+    if (column >= m_table->get_column_count())
+        throw OutOfBoundsIndexException{column, m_table->get_column_count()};
+    if (!ColumnStatistics::is_supported(m_table->get_column_type(column)))
+        throw UnsupportedColumnTypeException{column, m_table};
+
+    switch (m_mode) {
+        case Mode::Empty:
+            return {};
+        case Mode::Table:
+            if (m_realm)
+                return m_realm->column_statistics(*m_table, column);
+            return ColumnStatistics::compute(*m_table, column);
+        case Mode::Query:
+        case Mode::TableView:
+            update_tableview();
+            if (is_limited())
+                return ColumnStatistics::compute(limited_view(), column);
+            return ColumnStatistics::compute(m_table_view, column);
+    }
+    REALM_UNREACHABLE();
+}
+
+size_t Results::copy_column(size_t column, int64_t* out, uint8_t* nulls)
+{
+    return copy_column_values(column, type_Int, out, nulls);
+}
+
+size_t Results::copy_column(size_t column, float* out, uint8_t* nulls)
+{
+    return copy_column_values(column, type_Float, out, nulls);
+}
+
+size_t Results::copy_column(size_t column, double* out, uint8_t* nulls)
+{
+    return copy_column_values(column, type_Double, out, nulls);
+}
+
+std::vector<util::Optional<Mixed>> Results::aggregate_many(std::vector<std::pair<size_t, AggregateOperation>> const& aggregates)
+{
+    validate_read();
+    if (!m_table)
+        return std::vector<util::Optional<Mixed>>(aggregates.size());
+
+    // Validate everything before doing any work
+    std::vector<size_t> aggregator_for_request;
+    auto columns = make_column_aggregators(m_table, aggregates, aggregator_for_request);
+
+    auto add_row = [&](size_t row) {
+        for (auto& column : columns)
+            column.add(*m_table, row);
+    };
+
+    switch (m_mode) {
+        case Mode::Empty:
+            break;
+        case Mode::Table:
+            for (size_t row = 0, size = m_table->size(); row < size; ++row)
+                add_row(row);
+            break;
+        case Mode::Query:
+        case Mode::TableView: {
+            update_tableview();
+            for (size_t i = m_offset, end = m_offset + window_size(m_table_view.size()); i < end; ++i) {
+                if (m_table_view.is_row_attached(i))
+                    add_row(m_table_view.get_source_ndx(i));
+            }
+            break;
+        }
+    }
+
+    std::vector<util::Optional<Mixed>> results;
+    results.reserve(aggregates.size());
+    for (size_t i = 0; i < aggregates.size(); ++i)
+        results.push_back(columns[aggregator_for_request[i]].get(aggregates[i].second));
+    return results;
+}
+
+std::vector<Results::Group> Results::group_by(size_t column, std::vector<std::pair<size_t, AggregateOperation>> const& aggregates)
+{
+    validate_read();
+    if (!m_table)
+        return {};
+    if (column >= m_table->get_column_count())
+        throw OutOfBoundsIndexException{column, m_table->get_column_count()};
+
+    DataType key_type = m_table->get_column_type(column);
+    switch (key_type) {
+        case type_Int: case type_Bool: case type_String: case type_DateTime:
+            break;
+        default:
+            throw UnsupportedColumnTypeException{column, m_table};
+    }
+
+    std::vector<size_t> aggregator_for_request;
+    auto prototype = make_column_aggregators(m_table, aggregates, aggregator_for_request);
+    bool nullable = m_table->is_nullable(column);
+
+    std::vector<GroupAggregator> groups;
+    if (m_mode == Mode::Table && m_table->has_search_index(column)
+        && (key_type == type_String || (key_type == type_Int && !nullable))) {
+        // Every row is in the Results, so each distinct value in the index
+        // is a group and the index lists the group's rows. find_all() gives
+        // the rows in ascending order, so the first is the one the groups
+        // are ordered by.
+        TableView distinct = m_table->get_distinct_view(column);
+        groups.reserve(distinct.size());
+        for (size_t i = 0; i < distinct.size(); ++i) {
+            size_t row = distinct.get_source_ndx(i);
+            TableView rows = key_type == type_String
+                           ? m_table->find_all_string(column, m_table->get_string(column, row))
+                           : m_table->find_all_int(column, m_table->get_int(column, row));
+            if (rows.size() == 0)
+                continue;
+            groups.push_back({rows.get_source_ndx(0), 0, prototype});
+            for (size_t j = 0; j < rows.size(); ++j)
+                groups.back().add(*m_table, rows.get_source_ndx(j));
+        }
+        std::sort(groups.begin(), groups.end(), [](auto const& a, auto const& b) { return a.first_row < b.first_row; });
+    }
+    else {
+        std::unordered_map<int64_t, size_t> int_groups;
+        std::unordered_map<std::string, size_t> string_groups;
+        size_t null_group = npos;
+
+        auto add_row = [&](size_t row) {
+            size_t ndx = groups.size();
+            if (nullable && m_table->is_null(column, row)) {
+                if (null_group == npos)
+                    null_group = ndx;
+                ndx = null_group;
+            }
+            else if (key_type == type_String) {
+                StringData value = m_table->get_string(column, row);
+                ndx = string_groups.emplace(std::string(value.data(), value.size()), ndx).first->second;
+            }
+            else {
+                ndx = int_groups.emplace(group_key_int(*m_table, key_type, column, row), ndx).first->second;
+            }
+            if (ndx == groups.size())
+                groups.push_back({row, 0, prototype});
+            groups[ndx].add(*m_table, row);
+        };
+
+        switch (m_mode) {
+            case Mode::Empty:
+                break;
+            case Mode::Table:
+                for (size_t row = 0, size = m_table->size(); row < size; ++row)
+                    add_row(row);
+                break;
+            case Mode::Query:
+            case Mode::TableView:
+                update_tableview();
+                for (size_t i = m_offset, end = m_offset + window_size(m_table_view.size()); i < end; ++i) {
+                    if (m_table_view.is_row_attached(i))
+                        add_row(m_table_view.get_source_ndx(i));
+                }
+                break;
+        }
+    }
+
+    std::vector<Group> results;
+    results.reserve(groups.size());
+    for (auto const& group : groups) {
+        Group result;
+        if (!nullable || !m_table->is_null(column, group.first_row))
+            result.key = group_key_value(*m_table, key_type, column, group.first_row);
+        result.count = group.count;
+        result.values.reserve(aggregates.size());
+        for (size_t i = 0; i < aggregates.size(); ++i)
+            result.values.push_back(group.columns[aggregator_for_request[i]].get(aggregates[i].second));
+        results.push_back(std::move(result));
+    }
+    return results;
+}
+
+void Results::clear()
+{
+    switch (m_mode) {
+        case Mode::Empty:
+            return;
+        case Mode::Table:
+            validate_write();
+            m_table->clear();
+            break;
+        case Mode::Query:
+        case Mode::TableView:
+            validate_write();
+            if (!is_limited() && !m_link_view && !has_distinct()) {
+                clear_matching_rows(m_query, 0, {});
+                break;
+            }
+            // Not using Query:remove() because building the tableview and
+            // clearing it is actually significantly faster
+            update_tableview();
+            if (is_limited())
+                limited_view().clear(RemoveMode::unordered);
+            else
+                m_table_view.clear(RemoveMode::unordered);
+            break;
+    }
+}
+
+void Results::clear(size_t batch_size, BatchFunction const& delete_batch)
+{
+    if (m_mode == Mode::Empty) {
+        return;
+    }
+
+    validate_read();
+    if (m_realm->is_in_transaction()) {
+        throw InvalidTransactionException("Can't delete in batches within a write transaction");
+    }
+
+    m_realm->begin_transaction();
+    try {
+        if (batch_size == 0 || is_limited() || m_link_view || has_distinct()) {
+            if (delete_batch) {
+                delete_batch([&] { clear(); });
+            }
+            else {
+                clear();
+            }
+        }
+        else {
+            // Table mode Results stay in Table mode
+            Query query = m_mode == Mode::Table ? m_table->where() : m_query;
+            clear_matching_rows(query, batch_size, delete_batch);
+        }
+        m_realm->commit_transaction();
+    }
+    catch (...) {
+        if (m_realm->is_in_transaction()) {
+            m_realm->cancel_transaction();
+        }
+        throw;
+    }
+}
+
+void Results::clear_matching_rows(Query& query, size_t batch_size, BatchFunction const& delete_batch)
+{
+    // Scan the table backwards in fixed-size windows of rows. Deleting a
+    // match moves the last row of the table into its place, which is always
+    // a row that has already been checked, so each row only needs to be
+    // checked once.
+    static const size_t rows_per_chunk = 64 * 1024;
+
+    size_t end = m_table->size();
+    while (true) {
+        size_t deleted_in_batch = 0;
+        auto delete_rows = [&] {
+            while (end > 0 && (!batch_size || deleted_in_batch < batch_size)) {
+                size_t begin = end > rows_per_chunk ? end - rows_per_chunk : 0;
+                TableView matches = query.find_all(begin, end);
+                size_t count = matches.size();
+                size_t to_delete = batch_size ? std::min(count, batch_size - deleted_in_batch) : count;
+
+                // Delete the highest rows first so that none of the matches
+                // yet to be deleted are moved
+                for (size_t i = count; i > count - to_delete; --i) {
+                    m_table->move_last_over(matches.get_source_ndx(i - 1));
+                }
+                // If the batch filled up partway through the window, the rest
+                // of the window still needs to be checked
+                end = to_delete < count ? matches.get_source_ndx(count - to_delete - 1) + 1 : begin;
+                deleted_in_batch += to_delete;
+            }
+        };
+        if (delete_batch) {
+            delete_batch(delete_rows);
+        }
+        else {
+            delete_rows();
+        }
+        // The last batch is committed by the caller
+        if (end == 0) {
+            return;
+        }
+
+        auto version = m_realm->current_transaction_version();
+        m_realm->commit_transaction();
+        m_realm->begin_transaction();
+
+        // If another thread committed in between, rows may have been moved
+        // into the part of the table which has been checked
+        if (m_realm->current_transaction_version() != version + 1) {
+            end = m_table->size();
+        }
+        end = std::min(end, m_table->size());
+    }
+}
+
+Query Results::get_query() const
+{
+    validate_read();
+    switch (m_mode) {
+        case Mode::Empty:
+        case Mode::Query:
+        case Mode::TableView:
+            return m_query;
+        case Mode::Table:
+            return m_table->where();
+    }
+    REALM_UNREACHABLE();
+}
+
+TableView Results::get_tableview()
+{
+    validate_read();
+    switch (m_mode) {
+        case Mode::Empty:
+            return {};
+        case Mode::Query:
+        case Mode::TableView:
+            update_tableview();
+            if (is_limited())
+                return limited_view();
+            return m_table_view;
+        case Mode::Table:
+            return m_table->where().find_all();
+    }
+    REALM_UNREACHABLE();
+}
+
+StringData Results::get_object_type() const noexcept
+{
+    return ObjectStore::object_type_for_table_name(m_table->get_name());
+}
+
+Results Results::sort(realm::SortOrder&& sort) const
+{
+    if (is_paged())
+        throw std::logic_error("A page of Results can't be sorted.");
+    Results results(m_realm, get_query(), std::move(sort));
+    results.m_link_view = m_link_view;
+    results.m_distinct_column = m_distinct_column;
+    results.m_projection = m_projection;
+    results.m_description = get_query_description();
+    results.m_conditions = m_conditions;
+    results.inherit_window(*this);
+    return results;
+}
+
+Results Results::filter(Query&& q) const
+{
+    Results results(m_realm, get_query().and_query(std::move(q)), get_sort());
+    results.m_link_view = m_link_view;
+    results.m_distinct_column = m_distinct_column;
+    results.m_projection = m_projection;
+    if (is_paged()) {
+        // The offset of a page is recalculated from its anchor
+        results.m_limit = m_limit;
+        results.m_page_anchor = m_page_anchor;
+    }
+    else {
+        results.inherit_window(*this);
+    }
+    return results;
+}
+
+void Results::inherit_window(Results const& parent)
+{
+    if (parent.is_limited()) {
+        m_window_base = std::make_shared<Results>(parent);
+    }
+}
+
+Results Results::limit(size_t count, size_t offset) const
+{
+    if (m_mode == Mode::Empty) {
+        return *this;
+    }
+    if (is_paged()) {
+        throw std::logic_error("A page of Results can't be limited.");
+    }
+
+    Results results(m_realm, get_query(), get_sort());
+    results.m_link_view = m_link_view;
+    results.m_distinct_column = m_distinct_column;
+    results.m_projection = m_projection;
+    results.m_description = get_query_description();
+    results.m_conditions = m_conditions;
+    results.m_window_base = m_window_base;
+    // Limiting an already limited Results selects a window within the
+    // existing window
+    results.m_offset = offset > size_t(-1) - m_offset ? size_t(-1) : m_offset + offset;
+    results.m_limit = std::min(count, m_limit - std::min(offset, m_limit));
+    return results;
+}
+
+Results Results::distinct(size_t column) const
+{
+    if (m_mode == Mode::Empty) {
+        return *this;
+    }
+    if (is_paged()) {
+        throw std::logic_error("Duplicates can't be removed from a page of Results.");
+    }
+    if (column >= m_table->get_column_count()) {
+        throw OutOfBoundsIndexException{column, m_table->get_column_count()};
+    }
+    switch (m_table->get_column_type(column)) {
+        case type_Int: case type_Bool: case type_Float: case type_Double:
+        case type_String: case type_DateTime:
+            break;
+        default:
+            throw UnsupportedColumnTypeException{column, m_table};
+    }
+
+    Results results(m_realm, get_query(), get_sort());
+    results.m_link_view = m_link_view;
+    results.m_distinct_column = column;
+    results.m_projection = m_projection;
+    results.m_description = get_query_description();
+    results.m_conditions = m_conditions;
+    results.inherit_window(*this);
+    return results;
+}
+
+Results Results::project(std::vector<size_t> columns) const
+{
+    if (m_mode == Mode::Empty) {
+        return *this;
+    }
+    for (size_t column : columns) {
+        if (column >= m_table->get_column_count()) {
+            throw OutOfBoundsIndexException{column, m_table->get_column_count()};
+        }
+    }
+    std::sort(columns.begin(), columns.end());
+    columns.erase(std::unique(columns.begin(), columns.end()), columns.end());
+
+    Results results(*this);
+    results.m_projection = std::move(columns);
+    return results;
+}
+
+void Results::evaluate_async(std::function<void (Results, std::exception_ptr)> callback) const
+{
+    validate_read();
+    switch (m_mode) {
+        case Mode::Empty:
+        case Mode::Table:
+            callback(*this, nullptr);
+            return;
+        case Mode::Query:
+        case Mode::TableView:
+            _impl::AsyncQuery::run(*this, std::move(callback));
+            return;
+    }
+    REALM_UNREACHABLE();
+}
+
+size_t Results::add_notification_callback(NotificationCallback callback)
+{
+    validate_read();
+    // Results which aren't backed by a Realm never change
+    if (!m_realm) {
+        return npos;
+    }
+    return m_realm->add_results_notifier(std::make_shared<_impl::ResultsNotifier>(*this, std::move(callback)));
+}
+
+void Results::remove_notification_callback(size_t token)
+{
+    if (m_realm) {
+        m_realm->remove_results_notifier(token);
+    }
 }
 
 Results::UnsupportedColumnTypeException::UnsupportedColumnTypeException(size_t column, const Table* table) {
@@ -19,25 +19,98 @@
 #ifndef REALM_RESULTS_HPP
 #define REALM_RESULTS_HPP
 
+#include "index_set.hpp"
 #include "shared_realm.hpp"
 
+#include <realm/link_view.hpp>
 #include <realm/table_view.hpp>
 #include <realm/table.hpp>
 #include <realm/util/optional.hpp>
 
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+
 namespace realm {
 template<typename T> class BasicRowExpr;
 using RowExpr = BasicRowExpr<Table>;
 class Mixed;
 
+namespace _impl {
+class AsyncQuery;
+class ResultsNotifier;
+}
+
+// An ordering for strings other than the default one, defined by a function
+// which converts each string to a key such that comparing the keys bytewise
+// gives the desired order. Keys are cached per row by the Realm, so the name
+// must uniquely identify the function.
+struct Collation {
+    std::string name;
+    std::function<std::string (StringData)> make_key;
+};
+
 struct SortOrder {
     std::vector<size_t> columnIndices;
     std::vector<bool> ascending;
+    // The collation to sort each string column with, or null to sort it by its
+    // values. Empty if no column uses one.
+    std::vector<std::shared_ptr<const Collation>> collations;
+    // For each sort column which belongs to a linked object rather than to
+    // the rows being sorted, the link columns followed from the sorted table
+    // to reach it, in which case the column index is in the last link's
+    // target table. Rows with a null link anywhere in the path sort as if
+    // the value were null. Empty if no column is on a linked object.
+    std::vector<std::vector<size_t>> link_paths;
 
     explicit operator bool() const
     {
         return !columnIndices.empty();
     }
+
+    bool has_link_paths() const
+    {
+        for (auto const& path : link_paths) {
+            if (!path.empty())
+                return true;
+        }
+        return false;
+    }
+
+    // The column of the sorted table which the given sort column is either
+    // read from or reached through
+    size_t source_column(size_t i) const
+    {
+        return i < link_paths.size() && !link_paths[i].empty() ? link_paths[i][0] : columnIndices[i];
+    }
+
+    bool has_collation() const
+    {
+        for (auto const& collation : collations) {
+            if (collation)
+                return true;
+        }
+        return false;
+    }
+};
+
+// The changes to the rows in a Results between two versions of the Realm.
+// A row which moved within the Results is reported as both a deletion and an
+// insertion.
+struct CollectionChangeSet {
+    // Indexes in the previous version of the rows which were removed
+    IndexSet deletions;
+    // Indexes in the new version of the rows which were added
+    IndexSet insertions;
+    // Indexes in the new version of the rows which were modified but not
+    // otherwise changed position
+    IndexSet modifications;
+
+    bool empty() const noexcept
+    {
+        return deletions.empty() && insertions.empty() && modifications.empty();
+    }
 };
 
 class Results {
@@ -48,6 +121,8 @@ public:
     Results() = default;
     Results(SharedRealm r, Table& table);
     Results(SharedRealm r, Query q, SortOrder s = {});
+    // Results restricted to the rows in a LinkView
+    Results(SharedRealm r, LinkViewRef lv, SortOrder s = {});
 
     // Results is copyable and moveable
     Results(Results const&) = default;
@@ -57,12 +132,17 @@ public:
 
     // Get a query which will match the same rows as is contained in this Results
     // Returned query will not be valid if the current mode is Empty
+    // Any limit, offset or distinct column applied to the Results is not part
+    // of the query
     Query get_query() const;
 
     // Get the currently applied sort order for this Results
     SortOrder const& get_sort() const noexcept { return m_sort; }
 
     // Get a tableview containing the same rows as this Results
+    // For limited Results the tableview is restricted to the rows of this
+    // Results' own tableview, and so must not be used after this Results is
+    // destroyed
     TableView get_tableview();
 
     // Get the object type which will be returned by get()
@@ -76,6 +156,58 @@ public:
     // Throws OutOfBoundsIndexException if index >= size()
     RowExpr get(size_t index);
 
+    // Copy the source table row indexes of up to `count` rows starting at
+    // `index` into `out`, returning the number copied. Rows which have been
+    // deleted are reported as npos.
+    size_t get_source_indexes(size_t index, size_t count, size_t* out);
+
+    // A forward-only cursor over the rows of a Results which reads values
+    // directly from the table, without creating a row accessor for each row.
+    // Row indexes are fetched from the Results a batch at a time, and rows
+    // deleted since the Results was last evaluated are skipped. The Results
+    // must outlive the cursor, and the typed getters must only be called
+    // after next() has returned true and with columns of the matching type.
+    class Cursor {
+    public:
+        explicit Cursor(Results& results);
+
+        // Move to the next row, returning false once there are no more
+        bool next();
+
+        // The index of the current row within the Results and within the table
+        size_t get_index() const noexcept { return m_batch_start + m_batch_index - 1; }
+        size_t get_row_index() const noexcept { return m_rows[m_batch_index - 1]; }
+
+        bool is_null(size_t col) const { return m_table->is_null(col, get_row_index()); }
+        int64_t get_int(size_t col) const { return m_table->get_int(col, get_row_index()); }
+        bool get_bool(size_t col) const { return m_table->get_bool(col, get_row_index()); }
+        float get_float(size_t col) const { return m_table->get_float(col, get_row_index()); }
+        double get_double(size_t col) const { return m_table->get_double(col, get_row_index()); }
+        StringData get_string(size_t col) const { return m_table->get_string(col, get_row_index()); }
+        BinaryData get_binary(size_t col) const { return m_table->get_binary(col, get_row_index()); }
+        DateTime get_datetime(size_t col) const { return m_table->get_datetime(col, get_row_index()); }
+
+        // The index of the linked row in the target table, or npos for a null link
+        size_t get_link(size_t col) const
+        {
+            size_t row = get_row_index();
+            return m_table->is_null_link(col, row) ? npos : m_table->get_link(col, row);
+        }
+        // The number of rows in a link list column
+        size_t get_link_count(size_t col) const { return m_table->get_link_count(col, get_row_index()); }
+
+    private:
+        Results* m_results;
+        Table const* m_table;
+        std::vector<size_t> m_rows;
+        // The index in the Results of the first row in m_rows, the number of
+        // rows in m_rows, and one past the position of the current row in it
+        size_t m_batch_start = 0;
+        size_t m_batch_count = 0;
+        size_t m_batch_index = 0;
+        bool m_at_end = false;
+    };
+
     // Get a row accessor for the first/last row, or none if the results are empty
     // More efficient than calling size()+get()
     util::Optional<RowExpr> first();
@@ -87,15 +219,98 @@ public:
     size_t index_of(size_t row_ndx);
     size_t index_of(Row const& row);
 
+    // Get the index of the first row in this Results which matches the query,
+    // or not_found
+    size_t index_of(Query&& q);
+
     // Delete all of the rows in this Results from the Realm
-    // size() will always be zero afterwards
+    // size() will always be zero afterwards unless a limit or offset is
+    // applied, in which case any following rows move into the window
     // Throws InvalidTransactionException if not in a write transaction
     void clear();
 
+    // Delete all of the rows in this Results from the Realm in a series of
+    // write transactions which each delete at most `batch_size` rows, or in a
+    // single one if `batch_size` is zero, so that other threads and processes
+    // can write between them. Unless a limit, offset or LinkView is involved,
+    // the matching rows are found and deleted a chunk at a time rather than
+    // by building a TableView of all of them. Rows added by other threads
+    // between batches may also be deleted if they match. If given,
+    // `delete_batch` is called within each write transaction with a function
+    // which deletes that batch's rows, so that the caller can observe them.
+    // Throws InvalidTransactionException if called in a write transaction, as
+    // committing the caller's own changes partway through isn't expected.
+    using BatchFunction = std::function<void(std::function<void()> const& delete_rows)>;
+    void clear(size_t batch_size, BatchFunction const& delete_batch = {});
+
     // Create a new Results by further filtering or sorting this Results
+    // If this Results is limited, the new filter or sort order applies to
+    // just the rows in its window, which are found first. The new Results has
+    // no limit of its own. Filtering a page keeps its anchor and count.
     Results filter(Query&& q) const;
     Results sort(SortOrder&& sort) const;
 
+    // Create a new Results which contains at most `count` rows, starting from
+    // the `offset`th row of this Results
+    // When sorted, only the first offset + count rows are fully sorted
+    Results limit(size_t count, size_t offset = 0) const;
+    // Check if the Results has a window of its own or was derived from a
+    // Results which does, in which case it's found from a tableview
+    bool is_limited() const noexcept { return m_offset != 0 || m_limit != size_t(-1) || m_window_base; }
+
+    // The position of a row in a sorted Results, holding copies of the row's
+    // values for each sort column so that it remains usable after the row is
+    // modified or deleted
+    struct PageAnchor {
+        struct Value {
+            int64_t int_value;   // Int, Bool and DateTime columns
+            double double_value; // Float and Double columns
+        };
+        std::vector<Value> values;
+        size_t row;
+    };
+    // Get the anchor for the row at the given index
+    // Throws OutOfBoundsIndexException if index >= size()
+    // Throws UnsupportedColumnTypeException if the Results are sorted on a
+    // column which can't be paged by (anything other than non-nullable Int,
+    // Bool, Float, Double or DateTime columns)
+    // Throws std::logic_error if the Results aren't sorted
+    PageAnchor page_anchor(size_t index);
+
+    // Create a new Results which contains at most `count` of the rows which
+    // sort after the anchor, with rows which have equal values for every sort
+    // column ordered by row index. Unlike limit(), the page is stable when
+    // rows before it are inserted or deleted. The start of the page is found
+    // with a binary search of the sorted rows, and for Results sorted on a
+    // single indexed column only the rows in the page are read.
+    // Any existing limit, offset or anchor is replaced. The page itself can
+    // be filtered, but not sorted, limited or have duplicates removed.
+    // Throws the same exceptions as page_anchor(), and std::logic_error for
+    // Results with duplicates removed, which are backed by a LinkView or
+    // which were derived from a limited Results
+    Results page_after(PageAnchor anchor, size_t count) const;
+    bool is_paged() const noexcept { return bool(m_page_anchor); }
+
+    // Create a new Results which contains only the first row for each
+    // distinct value of the given column, in the order of this Results
+    // Any sort order and filter are applied before removing duplicates, and
+    // if this Results is limited only the rows in its window are included
+    // Throws UnsupportedColumnTypeException for columns which aren't Int,
+    // Bool, Float, Double, String or DateTime
+    // Throws OutOfBoundsIndexException for an out-of-bounds column
+    Results distinct(size_t column) const;
+    bool has_distinct() const noexcept { return m_distinct_column != npos; }
+
+    // Create a new Results which declares that only the given columns of its
+    // rows are used. Notification callbacks then only report rows as
+    // modified when one of those columns changed, and serializing the
+    // Results only reads those columns. The rows are the same as this
+    // Results', and the projection is kept by filter(), sort(), limit(),
+    // page_after() and distinct(). An empty projection uses every column.
+    // Throws OutOfBoundsIndexException for an out-of-bounds column
+    Results project(std::vector<size_t> columns) const;
+    std::vector<size_t> const& get_projection() const noexcept { return m_projection; }
+
     // Get the min/max/average/sum of the given column
     // All but sum() returns none when there are zero matching rows
     // sum() returns 0, except for when it returns none
@@ -106,6 +321,112 @@ public:
     util::Optional<Mixed> average(size_t column);
     util::Optional<Mixed> sum(size_t column);
 
+    enum class AggregateOperation {
+        Min,
+        Max,
+        Sum,
+        Average
+    };
+    // Compute several aggregates in a single pass over the rows, reading each
+    // distinct column once per row. The results are in the same order as the
+    // requested aggregates and have the same values as calling the individual
+    // aggregate functions, and the same exceptions are thrown.
+    std::vector<util::Optional<Mixed>> aggregate_many(std::vector<std::pair<size_t, AggregateOperation>> const& aggregates);
+
+    // The rows of a Results which share a value of the column grouped by
+    struct Group {
+        // The value of the grouped column, or none for null. String values
+        // point into the Realm and so are only valid until it changes.
+        util::Optional<Mixed> key;
+        // The number of rows in the group
+        size_t count;
+        // The value of each aggregate over the group's rows, as for aggregate_many()
+        std::vector<util::Optional<Mixed>> values;
+    };
+    // Group the rows by the value of the given column and compute the
+    // aggregates for each group, in a single pass over the rows. Groups are
+    // in the order their first row appears in the Results. For Results
+    // backed directly by a table with a search index on the column, the
+    // groups and their rows are found with the index rather than by hashing
+    // every row's value.
+    // Throws UnsupportedColumnTypeException if the grouped column isn't Int,
+    // Bool, String or DateTime, and the same exceptions as aggregate_many()
+    // for the aggregates
+    // Throws OutOfBoundsIndexException for an out-of-bounds column
+    std::vector<Group> group_by(size_t column, std::vector<std::pair<size_t, AggregateOperation>> const& aggregates);
+
+    // Copy the value of an Int, Float or Double column for every row into `out`
+    // in a single pass, returning the number of values copied. `out` must
+    // have room for size() values. If `nulls` is non-null it must have room
+    // for (size() + 7) / 8 bytes, and bit i (LSB first) is set if row i is
+    // null; null values are written as zero.
+    // Throws UnsupportedColumnTypeException if the column's type does not match `out`
+    // Throws OutOfBoundsIndexException for an out-of-bounds column
+    size_t copy_column(size_t column, int64_t* out, uint8_t* nulls = nullptr);
+    size_t copy_column(size_t column, float* out, uint8_t* nulls = nullptr);
+    size_t copy_column(size_t column, double* out, uint8_t* nulls = nullptr);
+
+    // Get the count, null count, approximate distinct count and range of the
+    // values of the given column over the rows in this Results. For Results
+    // backed directly by a table the statistics are cached by the Realm
+    // until it changes.
+    // Throws UnsupportedColumnTypeException for columns which aren't Int,
+    // Bool, Float, Double, String, DateTime, Binary or Link
+    // Throws OutOfBoundsIndexException for an out-of-bounds column
+    ColumnStatistics column_statistics(size_t column);
+
+    // Run the query and sort for this Results on a background thread, and
+    // then call the callback on this thread with a copy of this Results which
+    // already has the results available, or with the error which occurred.
+    // Delivery is done via the Realm's run loop source. The callback is
+    // called immediately if there is nothing to run or the query can't be run
+    // in the background (for read-only Realms, in write transactions, and
+    // for limited Results or ones with duplicates removed).
+    void evaluate_async(std::function<void (Results, std::exception_ptr)> callback) const;
+
+    // Call the callback on this thread each time the Realm advances to a
+    // version in which the rows in this Results differ from the previous
+    // version, with which rows were inserted, deleted and modified. Changes
+    // made by write transactions on this Realm can't be tracked and so are
+    // reported as every row being replaced the next time the Realm advances.
+    // If re-evaluating the Results fails the callback is called with the
+    // exception, and the next change set is relative to an empty Results.
+    // Returns a token to pass to remove_notification_callback().
+    using NotificationCallback = std::function<void (CollectionChangeSet const&, std::exception_ptr)>;
+    size_t add_notification_callback(NotificationCallback callback);
+    void remove_notification_callback(size_t token);
+
+    // A function which returns a human-readable description of the query's
+    // conditions, supplied by whatever created the query. It's only called
+    // when a description is needed for explain() or for reporting a slow
+    // query, and is kept by sort() and limit() but not by filter().
+    using DescriptionFunction = std::function<std::string ()>;
+    void set_query_description(DescriptionFunction description) { m_description = std::move(description); }
+    DescriptionFunction get_query_description() const;
+
+    // A function which returns the conditions of the query which a search
+    // index could answer, supplied by whatever created the query. It's only
+    // called if the Realm is recording its query workload, and the
+    // conditions are kept by sort() and limit() but not by filter().
+    using ConditionsFunction = std::function<std::vector<QueryCondition> ()>;
+    void set_query_conditions(ConditionsFunction const& conditions);
+    std::vector<QueryCondition> const& get_query_conditions() const { return m_conditions; }
+
+    // Details of evaluating the query for this Results
+    struct Explanation {
+        // The query's conditions along with any sort order, limit and offset
+        std::string description;
+        // The number of rows in the table or LinkView the query ran over
+        size_t rows_scanned = 0;
+        // The number of rows found by the query, before applying the offset
+        // (a query with a limit stops once it has found enough rows)
+        size_t matches = 0;
+        // The time taken to run the query and sort the results
+        std::chrono::microseconds duration{0};
+    };
+    // Rerun the query and sort, reporting what was done and how long it took
+    Explanation explain();
+
     enum class Mode {
         Empty, // Backed by nothing (for missing tables)
         Table, // Backed directly by a Table
@@ -150,18 +471,153 @@ private:
     TableView m_table_view;
     Table* m_table = nullptr;
     SortOrder m_sort;
+    // The LinkView the query is restricted to, if any
+    LinkViewRef m_link_view;
+    // The window of rows to include: m_limit rows starting at m_offset, with
+    // m_limit set to npos if there is no limit
+    size_t m_limit = size_t(-1);
+    size_t m_offset = 0;
+    // The column to remove duplicate values of, or npos
+    size_t m_distinct_column = npos;
+    // The columns used by whatever reads the Results, or empty for all of them
+    std::vector<size_t> m_projection;
+    // The row the rows of a page sort after, if any. For pages which aren't
+    // found from a shared sorted view, m_offset is set to the position of
+    // the first row after the anchor each time the query is run.
+    util::Optional<PageAnchor> m_page_anchor;
+    // The limited Results this one was sorted, filtered or had duplicates
+    // removed from, whose window of rows is found before running m_query
+    // over just those rows. Null if this wasn't derived from a limited Results.
+    std::shared_ptr<Results> m_window_base;
+    // The rows in m_window_base's window, which m_table_view's query is
+    // restricted to and so are kept alive along with it
+    std::shared_ptr<TableView> m_window_rows;
+    // The Realm's shared sorted view of the table which m_table_view was
+    // found by filtering, kept alive for as long as m_table_view's query
+    // refers to it, or null if the matches were sorted directly
+    std::shared_ptr<TableView> m_sorted_view;
+    // The fraction of the table's rows which matched the query the last time
+    // every match was found, used to decide whether filtering the sorted view
+    // is cheaper than sorting the matches
+    util::Optional<double> m_match_fraction;
+
+    // The Realm's read transaction version and write transaction count when
+    // m_table_view was last brought up to date
+    uint_fast64_t m_synced_version = 0;
+    size_t m_synced_write_count = 0;
+
+    // The count and first row of the query in Query mode, which are reused
+    // until the table is modified so that repeatedly checking them doesn't
+    // rerun the query
+    struct QueryCache {
+        uint_fast64_t version = 0;
+        size_t write_count = 0;
+        util::Optional<size_t> count;
+        // not_found if no rows match the query
+        util::Optional<size_t> first_row;
+        // Every matching row in ascending order, so that the index of a row in
+        // unsorted Results is its position in this. Found the first time the
+        // index of a row is looked up.
+        util::Optional<std::vector<size_t>> matching_rows;
+    };
+    QueryCache m_query_cache;
+
+    DescriptionFunction m_description;
+    std::vector<QueryCondition> m_conditions;
+
+    // For object types with a time to live, the DateTime column they expire
+    // relative to (or npos), the query without the condition excluding the
+    // expired rows, and the cutoff that condition currently uses
+    size_t m_expiry_column = npos;
+    Query m_query_before_expiry;
+    int_fast64_t m_expiry_cutoff = 0;
 
     Mode m_mode = Mode::Empty;
 
     void validate_read() const;
     void validate_write() const;
 
+    // Add a condition excluding the objects which have expired if the
+    // table's object type has a time to live
+    void exclude_expired();
+    // Move the cutoff of that condition forward to the current time, so that
+    // the query is rerun if more objects have expired since it last ran
+    void update_expiry_cutoff();
+    void apply_expiry_cutoff(DateTime cutoff);
+
     void update_tableview();
+    // Rerun the query and sort, with any limit applied
+    void run_query();
+    // Delete the rows matching the query without materializing all of them,
+    // committing the write transaction after each `batch_size` rows deleted
+    // if it's non-zero
+    void clear_matching_rows(Query& query, size_t batch_size, BatchFunction const& delete_batch);
+    // The full description of the query used by explain()
+    std::string describe() const;
+
+    // Call the Realm's slow query function if the query started at `start`
+    // took too long
+    void report_query_time(std::chrono::steady_clock::time_point start) const;
+    // Add a run of the query which took `duration` to the Realm's workload
+    void record_query_run(QueryWorkload& workload, std::chrono::nanoseconds duration) const;
+    // Check if the Results are sorted on a single indexed column and enough
+    // of the table matched the query last time it ran, in which case the rows
+    // are found by filtering the Realm's shared sorted view of the table
+    // rather than by sorting the matches. Selective queries sort their
+    // matches directly so as to not keep a sorted copy of the whole table.
+    bool should_use_sorted_view() const;
+    // Record the fraction of the table which `matches` rows of matched
+    void record_match_fraction(size_t matches);
+    // Make the window of the parent, if it has one, the set of rows this
+    // Results derived from it is found from
+    void inherit_window(Results const& parent);
+    // Check that the sort order can be used for paging
+    void validate_page_sort() const;
+    // Find the position in the sorted view of the first row which sorts
+    // after the page anchor
+    size_t position_after_anchor(TableView const& sorted) const;
+    // The number of rows which need to be found to fill the window
+    size_t limit_end() const noexcept;
+    // The number of rows in the window given the total number of rows found
+    size_t window_size(size_t total) const noexcept;
+    // Get a tableview of just the rows in the window for limited Results
+    TableView limited_view();
+    // Discard the cached query state if the table may have changed since it
+    // was computed
+    void validate_query_cache();
+    void update_query_cache_version();
+    size_t query_count();
+    // The rows matching the query, for unsorted Results without a LinkView,
+    // limit or distinct
+    std::vector<size_t> const& matching_rows();
+    // Check if the changes made since m_table_view was last updated can not
+    // have changed which rows it contains or their order
+    bool tableview_is_up_to_date() const;
+    // The same for Results restricted to a LinkView, which only need to be
+    // rerun if the list or the rows in it were modified
+    bool link_view_tableview_is_up_to_date() const;
+    // Bring a sorted tableview up to date by placing just the rows which were
+    // added or changed into the existing order, rather than sorting every
+    // match again. Returns false if that isn't possible.
+    bool update_sorted_tableview();
+
+    // Can counts and aggregates be evaluated over chunks of the table's rows
+    // in parallel, as enabled by the Realm's parallel_aggregate_threshold?
+    bool can_parallelize() const;
+    util::Optional<Mixed> parallel_aggregate(size_t column, AggregateOperation op);
+
+    template<typename T>
+    size_t copy_column_values(size_t column, DataType type, T* out, uint8_t* nulls);
 
     template<typename Int, typename Float, typename Double, typename DateTime>
-    util::Optional<Mixed> aggregate(size_t column, bool return_none_for_empty,
+    util::Optional<Mixed> aggregate(size_t column, AggregateOperation op,
                                     Int agg_int, Float agg_float,
                                     Double agg_double, DateTime agg_datetime);
+
+    friend class _impl::AsyncQuery;
+    friend class _impl::ResultsNotifier;
+    friend class AggregateView;
+    friend class ThreadSafeReference;
 };
 }
 
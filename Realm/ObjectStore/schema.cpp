@@ -22,6 +22,8 @@
 #include "object_store.hpp"
 #include "property.hpp"
 
+#include <algorithm>
+
 using namespace realm;
 
 static bool compare_by_name(ObjectSchema const& lft, ObjectSchema const& rgt) {
@@ -94,6 +96,15 @@ void Schema::validate() const
                 }
             }
         }
+
+        // check expiry
+        if (object.time_to_live.count()) {
+            auto prop = object.property_for_name(object.expiry_property);
+            if (!prop || prop->type != PropertyTypeDate) {
+                exceptions.emplace_back(object.name, "Expiry property '" + object.expiry_property + "' for object '" +
+                                                     object.name + "' must be an existing date property.");
+            }
+        }
     }
 
     if (exceptions.size()) {
@@ -18,14 +18,40 @@
 
 #include "shared_realm.hpp"
 
+#include "access_tracker.hpp"
+#include "async_writer.hpp"
 #include "external_commit_helper.hpp"
 #include "binding_context.hpp"
+#include "collation_keys.hpp"
+#include "compound_index.hpp"
+#include "decrypted_file.hpp"
+#include "expiry_sweeper.hpp"
+#include "group_commit_queue.hpp"
+#include "link_list_aggregates.hpp"
+#include "mapped_file.hpp"
+#include "materialized_aggregate.hpp"
+#include "prefetcher.hpp"
+#include "primary_key_cache.hpp"
+#include "realm_snapshot.hpp"
+#include "results_notifier.hpp"
 #include "schema.hpp"
+#include "text_index.hpp"
+#include "trace.hpp"
 #include "transact_log_handler.hpp"
+#include "version_checkpoints.hpp"
 
+#include <realm/column.hpp>
 #include <realm/commit_log.hpp>
 #include <realm/group_shared.hpp>
-
+#include <realm/index_string.hpp>
+#include <realm/table_view.hpp>
+#include <realm/util/optional.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <ctime>
+#include <functional>
 #include <mutex>
 
 using namespace realm;
@@ -33,15 +59,117 @@ using namespace realm::_impl;
 
 RealmCache Realm::s_global_cache;
 
+// Every Realm with a SharedGroup, for reporting read transactions
+static std::mutex s_open_realms_mutex;
+static std::vector<Realm*> s_open_realms;
+
+namespace {
+// Forwards the notifications sent while advancing a read transaction to the
+// Realm's binding context, recording how long it spent handling did_change()
+// and how many observed rows it was told about
+class DidChangeTimer : public BindingContext {
+public:
+    DidChangeTimer(BindingContext* context, TransactionMetrics& metrics)
+    : m_context(context), m_metrics(metrics) { }
+
+    // The context to pass instead of the Realm's, or null if it has none
+    BindingContext* get() { return m_context ? this : nullptr; }
+
+    // Were any rows observed, which means that the transaction logs had to
+    // be parsed to update them?
+    bool has_observed_rows() const { return m_has_observed_rows; }
+
+    std::vector<ObserverState> get_observed_rows() override
+    {
+        auto observers = m_context->get_observed_rows();
+        m_has_observed_rows = !observers.empty();
+        return observers;
+    }
+
+    void will_change(std::vector<ObserverState> const& observers, std::vector<void*> const& invalidated) override
+    {
+        m_context->will_change(observers, invalidated);
+    }
+
+    using BindingContext::did_change;
+    void did_change(std::vector<ObserverState> const& observers, std::vector<void*> const& invalidated,
+                    VersionChange const& change) override
+    {
+        auto start = std::chrono::steady_clock::now();
+        m_context->did_change(observers, invalidated, change);
+        m_metrics.did_change.add(std::chrono::steady_clock::now() - start);
+        m_metrics.observers_notified += observers.size();
+    }
+
+private:
+    BindingContext* m_context;
+    TransactionMetrics& m_metrics;
+    bool m_has_observed_rows = false;
+};
+}
+
+static void unregister_open_realm(Realm* realm)
+{
+    std::lock_guard<std::mutex> lock(s_open_realms_mutex);
+    s_open_realms.erase(std::remove(s_open_realms.begin(), s_open_realms.end(), realm), s_open_realms.end());
+}
+
+// Get the shared decrypted copy of an immutable encrypted file, recording
+// whether it had to be decrypted or was already in memory, or null if the
+// file is too large to be decrypted in memory
+static std::shared_ptr<DecryptedFile> open_decrypted_file(Realm::Config const& config, TransactionMetrics& metrics)
+{
+    bool decrypted;
+    auto file = DecryptedFile::get(config.path, config.encryption_key, config.decrypted_cache_max_size, decrypted);
+    if (file && decrypted) {
+        ++metrics.files_decrypted;
+    }
+    else if (file) {
+        ++metrics.decrypted_cache_hits;
+    }
+    return file;
+}
+
 Realm::Config::Config(const Config& c)
 : path(c.path)
 , read_only(c.read_only)
+, immutable(c.immutable)
 , in_memory(c.in_memory)
+, idle_read_timeout(c.idle_read_timeout)
+, autorefresh_version_limit(c.autorefresh_version_limit)
+, autorefresh_time_budget(c.autorefresh_time_budget)
+, notification_interval(c.notification_interval)
+, notification_runloop_modes(c.notification_runloop_modes)
+, notification_thread_qos(c.notification_thread_qos)
 , cache(c.cache)
 , disable_format_upgrade(c.disable_format_upgrade)
+, compact_on_open_free_ratio(c.compact_on_open_free_ratio)
+, compact_on_open_min_size(c.compact_on_open_min_size)
+, compaction_function(c.compaction_function)
+, dispatch_queue(c.dispatch_queue)
 , encryption_key(c.encryption_key)
+, decrypted_cache_max_size(c.decrypted_cache_max_size)
+, initial_file_size(c.initial_file_size)
+, file_growth_increment(c.file_growth_increment)
+, file_growth_factor(c.file_growth_factor)
+, cache_max_objects(c.cache_max_objects)
+, cache_max_bytes(c.cache_max_bytes)
+, expiry_sweep_interval(c.expiry_sweep_interval)
+, expiry_sweep_batch_size(c.expiry_sweep_batch_size)
+, write_behind_batch_size(c.write_behind_batch_size)
+, write_behind_delay(c.write_behind_delay)
 , schema_version(c.schema_version)
 , migration_function(c.migration_function)
+, slow_query_function(c.slow_query_function)
+, slow_query_threshold(c.slow_query_threshold)
+, record_query_workload(c.record_query_workload)
+, prefetch_object_types(c.prefetch_object_types)
+, defer_index_creation(c.defer_index_creation)
+, index_creation_function(c.index_creation_function)
+, parallel_aggregate_threshold(c.parallel_aggregate_threshold)
+, observed_object_types(c.observed_object_types)
+, compute_changes_in_background(c.compute_changes_in_background)
+, track_changes(c.track_changes)
 {
     if (c.schema) {
         schema = std::make_unique<Schema>(*c.schema);
@@ -63,8 +191,25 @@ Realm::Config& Realm::Config::operator=(realm::Realm::Config const& c)
 Realm::Realm(Config config)
 : m_config(std::move(config))
 {
+    if (m_config.record_query_workload) {
+        m_query_workload = std::make_unique<QueryWorkload>();
+    }
+
     try {
-        if (m_config.read_only) {
+        if (m_config.immutable && m_config.encryption_key.empty()) {
+            // Group accessors can't be shared between threads, but a Group
+            // over an existing buffer is cheap to create, so each Realm gets
+            // its own Group reading from the process-wide mapping
+            m_mapped_file = MappedFile::get(m_config.path);
+            m_read_only_group = std::make_unique<Group>(m_mapped_file->data(), false);
+            m_group = m_read_only_group.get();
+        }
+        else if (m_config.immutable && m_config.decrypted_cache_max_size
+                 && (m_decrypted_file = open_decrypted_file(m_config, m_metrics))) {
+            m_read_only_group = std::make_unique<Group>(m_decrypted_file->data(), false);
+            m_group = m_read_only_group.get();
+        }
+        else if (m_config.read_only) {
             m_read_only_group = std::make_unique<Group>(m_config.path, m_config.encryption_key.data(), Group::mode_ReadOnly);
             m_group = m_read_only_group.get();
         }
@@ -73,6 +218,17 @@ Realm::Realm(Config config)
             SharedGroup::DurabilityLevel durability = m_config.in_memory ? SharedGroup::durability_MemOnly :
                                                                            SharedGroup::durability_Full;
             m_shared_group = std::make_unique<SharedGroup>(*m_history, durability, m_config.encryption_key.data(), !m_config.disable_format_upgrade);
+            if (m_config.initial_file_size && !m_config.in_memory) {
+                m_shared_group->reserve(m_config.initial_file_size);
+                m_reserved_file_size = m_config.initial_file_size;
+            }
+            if ((m_config.cache_max_objects || m_config.cache_max_bytes) && m_config.track_changes) {
+                m_access_tracker = std::make_unique<AccessTracker>();
+                m_eviction_pending = std::make_shared<std::atomic<bool>>(false);
+            }
+
+            std::lock_guard<std::mutex> lock(s_open_realms_mutex);
+            s_open_realms.push_back(this);
         }
     }
     catch (util::File::PermissionDenied const& ex) {
@@ -108,20 +264,139 @@ Realm::~Realm() {
     if (m_notifier) { // might not exist yet if an error occurred during init
         m_notifier->remove_realm(this);
     }
+    if (m_version_checkpoints) {
+        m_version_checkpoints->remove_realm(this);
+    }
+    unregister_open_realm(this);
+}
+
+std::shared_ptr<TableView> Realm::get_sorted_view(Table& table, size_t column, bool ascending)
+{
+    auto& view = m_sorted_views[std::make_tuple(table.get_index_in_group(), column, ascending)];
+    if (!view || !view->is_attached() || &view->get_parent() != &table) {
+        // Results with queries which refer to a view whose table accessor was
+        // replaced (e.g. by a schema change) keep it alive until they rerun
+        view = std::make_shared<TableView>(table.where().find_all());
+        view->sort(column, ascending);
+    }
+    else {
+        view->sync_if_needed();
+    }
+    return view;
+}
+
+void Realm::release_unused_sorted_views()
+{
+    for (auto it = m_sorted_views.begin(); it != m_sorted_views.end(); ) {
+        // Results keep the view their tableview was filtered from, so a view
+        // only the Realm refers to isn't used by the current version of any
+        // Results and would otherwise be resorted for nothing the next time
+        // one asks for it
+        if (it->second.use_count() == 1) {
+            it = m_sorted_views.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
+ColumnStatistics Realm::column_statistics(Table const& table, size_t column)
+{
+    verify_thread();
+    if (m_in_transaction) {
+        return ColumnStatistics::compute(table, column);
+    }
+
+    auto version = current_transaction_version();
+    auto key = std::make_pair(table.get_index_in_group(), column);
+    auto it = m_column_statistics.find(key);
+    if (it == m_column_statistics.end()) {
+        CachedColumnStatistics cached{version, m_write_transaction_count, ColumnStatistics::compute(table, column)};
+        return m_column_statistics.emplace(key, std::move(cached)).first->second.statistics;
+    }
+    if (it->second.version != version || it->second.write_count != m_write_transaction_count) {
+        it->second = {version, m_write_transaction_count, ColumnStatistics::compute(table, column)};
+    }
+    return it->second.statistics;
+}
+
+size_t Realm::find_by_primary_key(Table& table, size_t column, StringData key)
+{
+    if (!m_primary_key_cache) {
+        m_primary_key_cache = std::make_unique<PrimaryKeyCache>();
+    }
+    return m_primary_key_cache->find(table, column, key);
+}
+
+size_t Realm::find_by_primary_key(Table& table, size_t column, int64_t key)
+{
+    if (!m_primary_key_cache) {
+        m_primary_key_cache = std::make_unique<PrimaryKeyCache>();
+    }
+    return m_primary_key_cache->find(table, column, key);
+}
+
+std::shared_ptr<_impl::TextIndex> Realm::get_text_index(Table& table, size_t column)
+{
+    auto& index = m_text_indexes[std::make_pair(table.get_index_in_group(), column)];
+    if (!index || !index->is_for(table, column)) {
+        index = std::make_shared<TextIndex>(*this, table, column);
+    }
+    return index;
+}
+
+std::shared_ptr<_impl::CompoundIndex> Realm::get_compound_index(Table& table, std::vector<size_t> const& columns)
+{
+    auto& index = m_compound_indexes[std::make_pair(table.get_index_in_group(), columns)];
+    if (!index || !index->is_for(table, columns)) {
+        index = std::make_shared<CompoundIndex>(*this, table, columns);
+    }
+    return index;
+}
+
+std::shared_ptr<_impl::CollationKeyCache> Realm::get_collation_keys(Table& table, size_t column,
+                                                                    std::shared_ptr<const Collation> const& collation)
+{
+    auto& cache = m_collation_keys[std::make_tuple(table.get_index_in_group(), column, collation->name)];
+    if (!cache || !cache->is_for(table, column)) {
+        cache = std::make_shared<CollationKeyCache>(table, column, collation);
+    }
+    return cache;
+}
+
+std::shared_ptr<_impl::LinkListAggregates> Realm::get_link_list_aggregates(Table& table, size_t link_column,
+                                                                           size_t target_column)
+{
+    auto& aggregates = m_link_list_aggregates[std::make_tuple(table.get_index_in_group(), link_column, target_column)];
+    if (!aggregates || !aggregates->is_for(table, link_column, target_column)) {
+        aggregates = std::make_shared<LinkListAggregates>(*this, table, link_column, target_column);
+    }
+    return aggregates;
 }
 
 Group *Realm::read_group()
 {
     if (!m_group) {
         m_group = &const_cast<Group&>(m_shared_group->begin_read());
+        update_read_version();
     }
     return m_group;
 }
 
 SharedRealm Realm::get_shared_realm(Config config)
 {
+    if (config.dispatch_queue && !config.dispatch_queue.is_current()) {
+        throw IncorrectThreadException();
+    }
+    if (config.immutable) {
+        config.read_only = true;
+    }
+
     if (config.cache) {
-        if (SharedRealm realm = s_global_cache.get_realm(config.path)) {
+        auto cached = config.dispatch_queue ? s_global_cache.get_realm(config.path, config.dispatch_queue)
+                                            : s_global_cache.get_realm(config.path);
+        if (SharedRealm realm = std::move(cached)) {
             if (realm->config().read_only != config.read_only) {
                 throw MismatchedConfigException("Realm at path already opened with different read permissions.");
             }
@@ -157,24 +432,38 @@ SharedRealm Realm::get_shared_realm(Config config)
         // if there is an existing realm at the current path steal its schema/column mapping
         // FIXME - need to validate that schemas match
         realm->m_config.schema = std::make_unique<Schema>(*existing->m_config.schema);
+        realm->m_prefetcher = existing->m_prefetcher;
 
         if (!realm->m_config.read_only) {
             realm->m_notifier = existing->m_notifier;
             realm->m_notifier->add_realm(realm.get());
+            realm->m_group_commit_queue = existing->m_group_commit_queue;
+            realm->m_async_writer = existing->m_async_writer;
+            realm->m_expiry_sweeper = existing->m_expiry_sweeper;
+            realm->m_version_checkpoints = existing->m_version_checkpoints;
         }
     }
     else {
+        realm->compact_if_needed();
+
         if (!realm->m_config.read_only) {
             realm->m_notifier = std::make_shared<ExternalCommitHelper>(realm.get());
+            realm->m_group_commit_queue = std::make_shared<GroupCommitQueue>();
+            realm->m_async_writer = std::make_shared<AsyncWriter>();
+            realm->m_version_checkpoints = std::make_shared<VersionCheckpoints>();
         }
 
-        // otherwise get the schema from the group
-        realm->m_config.schema = std::make_unique<Schema>(ObjectStore::schema_from_group(realm->read_group()));
-
         // if a target schema is supplied, verify that it matches or migrate to
-        // it, as neeeded
-        if (target_schema) {
-            if (realm->m_config.read_only) {
+        // it, as neeeded. update_schema() only reads the schema from the
+        // group if the file's schema fingerprint doesn't match.
+        if (target_schema && !realm->m_config.read_only) {
+            realm->update_schema(std::move(target_schema), target_schema_version);
+        }
+        else {
+            // otherwise get the schema from the group
+            realm->m_config.schema = std::make_unique<Schema>(ObjectStore::schema_from_group(realm->read_group()));
+
+            if (target_schema) {
                 if (realm->m_config.schema_version == ObjectStore::NotVersioned) {
                     throw UnitializedRealmException("Can't open an un-initialized Realm without a Schema");
                 }
@@ -182,10 +471,27 @@ SharedRealm Realm::get_shared_realm(Config config)
                 ObjectStore::verify_schema(*realm->m_config.schema, *target_schema, true);
                 realm->m_config.schema = std::move(target_schema);
             }
-            else {
-                realm->update_schema(std::move(target_schema), target_schema_version);
-            }
         }
+
+        // Started once any migration is done so that it reads the final data
+        if (!realm->m_config.prefetch_object_types.empty() && !realm->m_config.in_memory) {
+            realm->m_prefetcher = std::make_shared<Prefetcher>(*realm, realm->m_config.prefetch_object_types);
+        }
+    }
+
+    auto const& realm_config = realm->m_config;
+    if (!realm->m_expiry_sweeper && realm_config.expiry_sweep_interval.count() && realm->m_async_writer) {
+        auto& schema = *realm_config.schema;
+        bool has_expiry = std::any_of(schema.begin(), schema.end(), [](auto const& object_schema) {
+            return object_schema.time_to_live.count() != 0;
+        });
+        if (has_expiry) {
+            realm->m_expiry_sweeper = std::make_shared<ExpirySweeper>(realm_config, realm->m_async_writer);
+        }
+    }
+
+    if (realm->refreshes_in_steps()) {
+        realm->m_version_checkpoints->add_realm(realm.get());
     }
 
     if (config.cache) {
@@ -199,6 +505,18 @@ void Realm::update_schema(std::unique_ptr<Schema> schema, uint64_t version)
     schema->validate();
 
     auto needs_update = [&] {
+        // If the file's tables for these types were last updated to exactly
+        // this schema, the column mapping can be read from the tables without
+        // a full comparison
+        if (m_config.schema_version == version && ObjectStore::verify_schema_fingerprint(read_group(), *schema)) {
+            m_config.schema = std::move(schema);
+            return false;
+        }
+
+        if (!m_config.schema) {
+            m_config.schema = std::make_unique<Schema>(ObjectStore::schema_from_group(read_group()));
+        }
+
         // If the schema version matches, just verify that the schema itself also matches
         bool needs_write = !m_config.read_only && (m_config.schema_version != version || ObjectStore::needs_update(*m_config.schema, *schema));
         if (needs_write) {
@@ -206,6 +524,11 @@ void Realm::update_schema(std::unique_ptr<Schema> schema, uint64_t version)
         }
 
         ObjectStore::verify_schema(*m_config.schema, *schema, m_config.read_only);
+        if (!m_config.read_only) {
+            // The schema matches but its fingerprint hasn't been recorded, so
+            // write it to let future opens skip the comparison
+            return true;
+        }
         m_config.schema = std::move(schema);
         m_config.schema_version = version;
         return false;
@@ -253,14 +576,32 @@ void Realm::update_schema(std::unique_ptr<Schema> schema, uint64_t version)
         m_config.migration_function(old_realm, shared_from_this());
     };
 
+    // The log is only parsed if there are primary keys to validate, and then
+    // only once for all of them
+    util::Optional<_impl::WrittenColumns> written_columns;
+    auto column_written = [&](size_t table_ndx, size_t col_ndx) {
+        if (!written_columns) {
+            written_columns = transaction::written_columns(*m_history);
+        }
+        return written_columns->may_have_written(table_ndx, col_ndx);
+    };
+
     try {
         m_config.schema = std::move(schema);
         m_config.schema_version = version;
 
-        ObjectStore::update_realm_with_schema(read_group(), *old_config.schema,
-                                              version, *m_config.schema,
-                                              migration_function);
+        // Deferring requires the async writer, which isn't available for
+        // the async writer's own Realm
+        bool defer_indexes = m_config.defer_index_creation && m_async_writer;
+        defer_indexes = ObjectStore::update_realm_with_schema(read_group(), *old_config.schema,
+                                                              version, *m_config.schema,
+                                                              migration_function, defer_indexes,
+                                                              column_written);
         commit_transaction();
+
+        if (defer_indexes) {
+            add_deferred_indexes();
+        }
     }
     catch (...) {
         m_config.schema = std::move(old_config.schema);
@@ -269,16 +610,78 @@ void Realm::update_schema(std::unique_ptr<Schema> schema, uint64_t version)
     }
 }
 
+void Realm::add_deferred_indexes()
+{
+    uint64_t version = m_config.schema_version;
+    auto completion = m_config.index_creation_function;
+
+    // If the writer thread has to open the file itself it then adds the
+    // indexes when it updates the schema, and either way its Realm must not
+    // try to defer them again
+    Config config = m_config;
+    config.defer_index_creation = false;
+    config.index_creation_function = nullptr;
+
+    auto on_realm_thread = completion_on_realm_thread(completion);
+    m_async_writer->enqueue(config, [=](Realm& realm) {
+        Group* group = realm.read_group();
+        // Another process may have changed the schema since this one
+        // updated it, in which case whichever open did that owns the indexes
+        if (ObjectStore::get_schema_version(group) != version
+            || !ObjectStore::has_missing_indexes(group, *realm.m_config.schema)) {
+            realm.cancel_transaction();
+            return;
+        }
+        ObjectStore::add_deferred_indexes(group, *realm.m_config.schema);
+    }, [=](std::exception_ptr error) {
+        if (completion) {
+            on_realm_thread(error);
+        }
+    });
+}
+
+std::function<void (std::exception_ptr)> Realm::completion_on_realm_thread(std::function<void (std::exception_ptr)> completion)
+{
+    // The notifier looks Realms up by address, and this one may have been
+    // destroyed and its address reused by another Realm by the time the
+    // completion runs, so it only runs if the weak pointer is still valid.
+    // It's only locked on this Realm's thread so that the writer thread
+    // never ends up releasing the last reference to it.
+    std::weak_ptr<ExternalCommitHelper> weak_notifier = m_notifier;
+    std::weak_ptr<Realm> weak_self = shared_from_this();
+    Realm* address = this;
+    return [=](std::exception_ptr error) {
+        if (auto notifier = weak_notifier.lock()) {
+            notifier->invoke_on_realm_thread(address, [=] {
+                auto self = weak_self.lock();
+                if (!self) {
+                    return;
+                }
+                if (!self->m_in_transaction) {
+                    self->refresh();
+                }
+                completion(error);
+            });
+        }
+    };
+}
+
 static void check_read_write(Realm *realm)
 {
     if (realm->config().read_only) {
         throw InvalidTransactionException("Can't perform transactions on read-only Realms.");
     }
+    if (realm->is_frozen()) {
+        throw InvalidTransactionException("Can't perform transactions on frozen Realms.");
+    }
 }
 
 void Realm::verify_thread() const
 {
-    if (m_thread_id != std::this_thread::get_id()) {
+    if (m_frozen) {
+        return;
+    }
+    if (m_config.dispatch_queue ? !m_config.dispatch_queue.is_current() : m_thread_id != std::this_thread::get_id()) {
         throw IncorrectThreadException();
     }
 }
@@ -302,8 +705,42 @@ void Realm::begin_transaction()
     // make sure we have a read transaction
     read_group();
 
-    transaction::begin(*m_shared_group, *m_history, m_binding_context.get());
+    REALM_TRACE_BEGIN(BeginTransaction, m_config.path.c_str(), current_transaction_version(), 0);
+    auto start = std::chrono::steady_clock::now();
+    TransactionChangeInfo info;
+    if (m_config.track_changes) {
+        transaction::begin(*m_shared_group, *m_history, m_binding_context.get(), true, &info);
+    }
+    else {
+        SchemaSummary schema(*m_group);
+        info.initial_version = current_transaction_version();
+        transaction::begin(*m_shared_group, *m_history, m_binding_context.get(), false);
+        info.final_version = current_transaction_version();
+        schema.validate(*m_group);
+    }
+    auto duration = std::chrono::steady_clock::now() - start;
+    if (info.final_version == info.initial_version) {
+        m_metrics.lock_wait.add(duration);
+    }
+    else {
+        m_metrics.lock_wait_and_advance.add(duration);
+        m_metrics.versions_advanced += info.final_version - info.initial_version;
+        if (m_config.track_changes) {
+            m_metrics.versions_parsed += info.final_version - info.initial_version;
+        }
+    }
+
+    if (m_config.track_changes) {
+        record_changes(std::move(info));
+    }
+    else {
+        m_recent_changes.clear();
+    }
+    update_read_version();
     m_in_transaction = true;
+    ++m_write_transaction_count;
+    REALM_TRACE_END(BeginTransaction, m_config.path.c_str(), info.final_version,
+                    info.final_version - info.initial_version);
 }
 
 void Realm::commit_transaction()
@@ -316,8 +753,247 @@ void Realm::commit_transaction()
     }
 
     m_in_transaction = false;
+    auto changes_size = m_history->get_uncommitted_changes().size();
+    m_metrics.bytes_committed += changes_size;
+    REALM_TRACE_BEGIN(CommitTransaction, m_config.path.c_str(), current_transaction_version(), changes_size);
+    auto start = std::chrono::steady_clock::now();
     transaction::commit(*m_shared_group, *m_history, m_binding_context.get());
+    m_metrics.commit.add(std::chrono::steady_clock::now() - start);
+    REALM_TRACE_END(CommitTransaction, m_config.path.c_str(), current_transaction_version(), changes_size);
+    update_read_version();
+    // Pin the new version before anyone is told about it, so that Realms
+    // advancing in steps can stop at it
+    if (m_version_checkpoints) {
+        m_version_checkpoints->did_commit(*this);
+    }
+    auto commit_time = std::chrono::steady_clock::now();
+    m_last_notified_commit_time = commit_time;
+    m_notifier->set_last_commit_time(commit_time);
     m_notifier->notify_others();
+
+    if ((m_config.file_growth_increment || m_config.file_growth_factor > 0) && !m_config.in_memory) {
+        reserve_file_growth();
+    }
+    // The writer thread's own Realm has no async writer, so evictions don't
+    // queue more evictions
+    if (m_access_tracker && m_async_writer) {
+        evict_if_over_cache_limits();
+    }
+    // Local commits aren't recorded as changes, so the notifiers report
+    // every row as having been replaced
+    deliver_results_notifications();
+}
+
+void Realm::reserve_file_growth()
+{
+    size_t free_space, used_space;
+    m_shared_group->get_stats(free_space, used_space);
+    size_t file_size = free_space + used_space;
+    size_t step = std::max(m_config.file_growth_increment, size_t(file_size * m_config.file_growth_factor));
+
+    // Reserving the next step once the file is within half a step of the end
+    // of the reserved space means a single large commit rarely outgrows it
+    if (file_size + step / 2 > m_reserved_file_size) {
+        m_reserved_file_size = file_size + step;
+        m_shared_group->reserve(m_reserved_file_size);
+    }
+}
+
+static DateTime expiry_cutoff(ObjectSchema const& object_schema)
+{
+    return DateTime(time(nullptr) - object_schema.time_to_live.count());
+}
+
+bool Realm::get_expiry_cutoff(Table const& table, size_t& column, DateTime& cutoff) const
+{
+    if (!m_config.schema) {
+        return false;
+    }
+    for (auto const& object_schema : *m_config.schema) {
+        if (object_schema.time_to_live.count() &&
+            ObjectStore::table_name_for_object_type(object_schema.name) == table.get_name()) {
+            column = object_schema.property_for_name(object_schema.expiry_property)->table_column;
+            cutoff = expiry_cutoff(object_schema);
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t Realm::delete_expired_objects(size_t limit)
+{
+    verify_in_write();
+
+    size_t deleted = 0;
+    for (auto const& object_schema : *m_config.schema) {
+        if (!object_schema.time_to_live.count()) {
+            continue;
+        }
+        TableRef table = ObjectStore::table_for_object_type(m_group, object_schema.name);
+        if (!table) {
+            continue;
+        }
+        size_t column = object_schema.property_for_name(object_schema.expiry_property)->table_column;
+        TableView expired = table->where().less_datetime(column, expiry_cutoff(object_schema))
+                                          .find_all(0, size_t(-1), limit - deleted);
+        deleted += expired.size();
+        expired.clear(RemoveMode::unordered);
+        if (deleted == limit) {
+            break;
+        }
+    }
+    return deleted;
+}
+
+void Realm::track_access(Table const& table, size_t row)
+{
+    m_access_tracker->touch(table.get_index_in_group(), row);
+}
+
+void Realm::evict_if_over_cache_limits()
+{
+    if (m_eviction_pending->load()) {
+        return;
+    }
+
+    // The byte limit is applied by evicting the same fraction of each type
+    double excess_fraction = 0;
+    if (m_config.cache_max_bytes) {
+        size_t free_space, used_space;
+        m_shared_group->get_stats(free_space, used_space);
+        if (used_space > m_config.cache_max_bytes) {
+            excess_fraction = double(used_space - m_config.cache_max_bytes) / used_space;
+        }
+    }
+
+    auto evictions = std::make_shared<Evictions>();
+    for (auto const& object_schema : *m_config.schema) {
+        ConstTableRef table = ObjectStore::table_for_object_type(m_group, object_schema.name);
+        if (!table) {
+            continue;
+        }
+        size_t size = table->size();
+        size_t excess = size_t(std::ceil(size * excess_fraction));
+        if (m_config.cache_max_objects && size > m_config.cache_max_objects) {
+            excess = std::max(excess, size - m_config.cache_max_objects);
+        }
+        if (excess) {
+            size_t table_ndx = table->get_index_in_group();
+            evictions->emplace_back(table_ndx, m_access_tracker->least_recently_used(table_ndx, size, excess));
+        }
+    }
+    if (evictions->empty()) {
+        return;
+    }
+
+    auto pending = m_eviction_pending;
+    pending->store(true);
+    uint_fast64_t version = current_transaction_version();
+    m_async_writer->enqueue(m_config, [=](Realm& realm) {
+        realm.evict_rows(version, *evictions);
+    }, [=](std::exception_ptr) {
+        // If the eviction failed or its rows couldn't be found, the next
+        // commit or refresh picks rows to evict again
+        pending->store(false);
+    });
+}
+
+void Realm::evict_rows(uint_fast64_t version, Evictions const& evictions)
+{
+    TransactionChangeInfo changes;
+    if (!get_changes_since(version, changes) || changes.schema_changed) {
+        // The rows can no longer be found, so leave it to the next commit
+        cancel_transaction();
+        return;
+    }
+
+    for (auto const& eviction : evictions) {
+        auto table_changes = eviction.first < changes.tables.size() ? &changes.tables[eviction.first] : nullptr;
+        if (table_changes && table_changes->row_indexes_lost) {
+            continue;
+        }
+
+        std::vector<size_t> rows;
+        rows.reserve(eviction.second.size());
+        for (size_t row : eviction.second) {
+            size_t new_row = table_changes ? table_changes->new_row_index(row) : row;
+            if (new_row != npos) {
+                rows.push_back(new_row);
+            }
+        }
+
+        // Removing from the end first means the row moved into each removed
+        // row's place is never one which still has to be removed
+        std::sort(rows.begin(), rows.end(), std::greater<size_t>());
+        TableRef table = m_group->get_table(eviction.first);
+        for (size_t row : rows) {
+            table->move_last_over(row);
+        }
+    }
+}
+
+void Realm::grouped_write(std::function<void (Realm&)> fn)
+{
+    check_read_write(this);
+    verify_thread();
+
+    if (m_in_transaction) {
+        throw InvalidTransactionException("The Realm is already in a write transaction");
+    }
+
+    m_group_commit_queue->write(*this, std::move(fn));
+
+    // If another thread committed the group this Realm won't have advanced
+    refresh();
+}
+
+void Realm::async_write(std::function<void (Realm&)> fn,
+                        std::function<void (std::exception_ptr)> completion)
+{
+    check_read_write(this);
+    verify_thread();
+
+    if (!m_async_writer) {
+        throw InvalidTransactionException("Cannot begin an asynchronous write from within an asynchronous write");
+    }
+
+    // The completion is only run if this Realm still exists
+    m_async_writer->enqueue(m_config, std::move(fn), completion_on_realm_thread(std::move(completion)));
+}
+
+void Realm::write_behind(std::function<void (Realm&)> fn)
+{
+    check_read_write(this);
+    verify_thread();
+    if (!m_async_writer) {
+        throw InvalidTransactionException("Cannot write behind from within an asynchronous write");
+    }
+    m_async_writer->enqueue_write_behind(m_config, std::move(fn));
+}
+
+void Realm::flush_write_behind()
+{
+    check_read_write(this);
+    verify_thread();
+    if (!m_async_writer) {
+        throw InvalidTransactionException("Cannot flush write-behind writes from within an asynchronous write");
+    }
+
+    auto error = m_async_writer->flush_write_behind(m_config);
+    if (!m_in_transaction) {
+        refresh();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void Realm::parse_uncommitted_row_index_changes(_impl::UncommittedRowIndexChanges& parser,
+                                               _impl::TransactionChangeInfo& changes)
+{
+    verify_thread();
+    verify_in_write();
+    parser.parse(*m_history, changes);
 }
 
 void Realm::cancel_transaction()
@@ -331,6 +1007,10 @@ void Realm::cancel_transaction()
 
     m_in_transaction = false;
     transaction::cancel(*m_shared_group, *m_history, m_binding_context.get());
+    // Anything computed during the write may include the rolled-back changes,
+    // and cancelling doesn't change the version, so count it as another write
+    ++m_write_transaction_count;
+    ++m_metrics.cancelled_transactions;
 }
 
 void Realm::invalidate()
@@ -347,13 +1027,82 @@ void Realm::invalidate()
 
     m_shared_group->end_read();
     m_group = nullptr;
+    update_read_version();
+    if (m_primary_key_cache) {
+        m_primary_key_cache->clear();
+    }
+    if (m_access_tracker) {
+        m_access_tracker->clear();
+    }
+    m_text_indexes.clear();
+    m_compound_indexes.clear();
+    m_collation_keys.clear();
+    m_link_list_aggregates.clear();
+    m_sorted_views.clear();
+}
+
+void Realm::trim_memory(TrimLevel level)
+{
+    verify_thread();
+
+    if (m_binding_context) {
+        m_binding_context->will_trim_memory();
+    }
+
+    m_primary_key_cache.reset();
+    m_column_statistics.clear();
+    m_text_indexes.clear();
+    m_compound_indexes.clear();
+    m_collation_keys.clear();
+    m_link_list_aggregates.clear();
+    m_sorted_views.clear();
+    m_recent_changes.clear();
+    m_recent_changes.shrink_to_fit();
+    // Anything still reading from the snapshot, such as an unresolved
+    // thread-safe reference, keeps its own reference to it
+    m_current_snapshot.reset();
+    // The prefetcher is shared by the file's Realms, and stops once all of
+    // them have let go of it
+    m_prefetcher.reset();
+
+    if (level != TrimLevel::Versions) {
+        return;
+    }
+    if (m_version_checkpoints) {
+        m_version_checkpoints->clear();
+    }
+    // Realms which don't refresh automatically have asked to stay at their
+    // version, and writes and frozen Realms can't be advanced at all
+    if (m_auto_refresh && m_group && !m_in_transaction && !m_frozen && m_shared_group->has_changed()) {
+        advance_read();
+    }
+}
+
+void Realm::trim_memory_for_all_realms(TrimLevel level)
+{
+    for (auto const& realm : s_global_cache.get_all_realms()) {
+        if (realm->is_frozen()) {
+            continue;
+        }
+        if (!realm->m_config.dispatch_queue && realm->thread_id() == std::this_thread::get_id()) {
+            realm->trim_memory(level);
+        }
+        else if (auto notifier = realm->m_notifier) {
+            std::weak_ptr<Realm> weak_realm = realm;
+            notifier->invoke_on_realm_thread(realm.get(), [=] {
+                if (auto realm = weak_realm.lock()) {
+                    realm->trim_memory(level);
+                }
+            });
+        }
+    }
 }
 
 bool Realm::compact()
 {
     verify_thread();
 
-    if (m_config.read_only) {
+    if (m_config.read_only || m_frozen) {
         throw InvalidTransactionException("Can't compact a read-only Realm");
     }
     if (m_in_transaction) {
@@ -366,27 +1115,97 @@ bool Realm::compact()
     }
     m_shared_group->end_read();
     m_group = nullptr;
+    update_read_version();
 
     return m_shared_group->compact();
 }
 
+void Realm::compact_if_needed()
+{
+    if (m_config.compact_on_open_free_ratio <= 0 || m_config.read_only || m_config.in_memory) {
+        return;
+    }
+
+    size_t free_space, used_space;
+    m_shared_group->get_stats(free_space, used_space);
+    size_t file_size = free_space + used_space;
+    if (file_size < m_config.compact_on_open_min_size
+        || free_space < file_size * m_config.compact_on_open_free_ratio) {
+        return;
+    }
+
+    if (m_group) {
+        m_shared_group->end_read();
+        m_group = nullptr;
+        update_read_version();
+    }
+    // Fails if another process has the file open
+    if (!m_shared_group->compact()) {
+        return;
+    }
+
+    m_shared_group->get_stats(free_space, used_space);
+    if (m_config.compaction_function) {
+        m_config.compaction_function(file_size - std::min(file_size, free_space + used_space));
+    }
+}
+
 void Realm::notify()
 {
     verify_thread();
 
-    if (m_shared_group->has_changed()) { // Throws
+    if (m_notifier) {
+        m_notifier->run_pending_invocations(this);
+    }
+
+    if (!m_shared_group->has_changed()) { // Throws
+        ++m_metrics.notifications_coalesced;
+        REALM_TRACE_POINT(Notify, m_config.path.c_str(), m_group ? current_transaction_version() : 0, 0);
+        return;
+    }
+
+    ++m_metrics.notifications_delivered;
+    REALM_TRACE_BEGIN(Notify, m_config.path.c_str(), m_group ? current_transaction_version() : 0, 1);
+    if (m_notifier) {
+        // Commits from other processes have no recorded time, and later
+        // ones from this process will have a newer one
+        auto commit_time = m_notifier->last_commit_time();
+        if (commit_time > m_last_notified_commit_time) {
+            m_last_notified_commit_time = commit_time;
+            m_metrics.notify.add(std::chrono::steady_clock::now() - commit_time);
+        }
+    }
+    if (idle_read_expired()) {
         if (m_binding_context) {
-            m_binding_context->changes_available();
+            m_binding_context->idle_read_expired();
         }
-        if (m_auto_refresh) {
-            if (m_group) {
-                transaction::advance(*m_shared_group, *m_history, m_binding_context.get());
-            }
-            else if (m_binding_context) {
-                m_binding_context->did_change({}, {});
-            }
+        if (m_group) {
+            invalidate();
+        }
+    }
+    if (m_binding_context) {
+        m_binding_context->changes_available();
+    }
+    if (m_auto_refresh) {
+        std::shared_ptr<RealmSnapshot> target;
+        TransactionChangeInfo changes;
+        if (m_group && refreshes_in_steps()) {
+            advance_read_in_steps();
+        }
+        else if (m_group && m_notifier
+                 && m_notifier->get_precomputed_changes(current_transaction_version(), changes, target)) {
+            // Newer commits than the ones computed so far will be
+            // signalled again once they have been computed too
+            advance_read(target.get(), &changes);
+        }
+        else if (m_group) {
+            advance_read();
+        }
+        else if (m_binding_context) {
+            m_binding_context->did_change({}, {}, BindingContext::VersionChange());
         }
     }
+    REALM_TRACE_END(Notify, m_config.path.c_str(), m_group ? current_transaction_version() : 0, 1);
 }
 
 
@@ -399,20 +1218,332 @@ bool Realm::refresh()
     if (m_in_transaction) {
         return false;
     }
+    // A Realm which is refreshed regularly is in use even if nothing changed
+    m_last_used = std::chrono::steady_clock::now();
 
     // advance transaction if database has changed
     if (!m_shared_group->has_changed()) { // Throws
         return false;
     }
 
+    REALM_TRACE_BEGIN(Refresh, m_config.path.c_str(), m_group ? current_transaction_version() : 0, 0);
     if (m_group) {
-        transaction::advance(*m_shared_group, *m_history, m_binding_context.get());
+        advance_read();
     }
     else {
         // Create the read transaction
         read_group();
     }
+    REALM_TRACE_END(Refresh, m_config.path.c_str(), current_transaction_version(), 0);
+
+    return true;
+}
+
+void Realm::advance_read(RealmSnapshot const* checkpoint, TransactionChangeInfo const* precomputed_changes)
+{
+    auto start = std::chrono::steady_clock::now();
+    TransactionChangeInfo info;
+    // Indexes are looked up in the version being advanced from, which is what
+    // the transaction log's table indexes refer to until a table is inserted,
+    // and inserting tables is always reported anyway
+    std::vector<bool> observed_tables;
+    for (auto const& object_type : m_config.observed_object_types) {
+        auto table_ndx = m_group->find_table(ObjectStore::table_name_for_object_type(object_type));
+        if (table_ndx != npos) {
+            if (observed_tables.size() <= table_ndx) {
+                observed_tables.resize(table_ndx + 1);
+            }
+            observed_tables[table_ndx] = true;
+        }
+    }
+    auto target_version = checkpoint ? checkpoint->version_id() : SharedGroup::VersionID();
+    DidChangeTimer timer(m_binding_context.get(), m_metrics);
+    if (m_config.track_changes || precomputed_changes) {
+        transaction::advance(*m_shared_group, *m_history, timer.get(), &info, target_version,
+                             m_config.observed_object_types.empty() ? nullptr : &observed_tables,
+                             precomputed_changes);
+    }
+    else {
+        // Only the versions are recorded, for the metrics
+        SchemaSummary schema(*m_group);
+        info.initial_version = current_transaction_version();
+        transaction::advance(*m_shared_group, *m_history, timer.get(), nullptr, target_version,
+                             nullptr, nullptr, false);
+        info.final_version = current_transaction_version();
+        schema.validate(*m_group);
+    }
+    m_metrics.advance.add(std::chrono::steady_clock::now() - start);
+    m_metrics.versions_advanced += info.final_version - info.initial_version;
+    if (timer.has_observed_rows() || (m_config.track_changes && !precomputed_changes)) {
+        m_metrics.versions_parsed += info.final_version - info.initial_version;
+    }
+    if (m_config.track_changes || precomputed_changes) {
+        record_changes(std::move(info));
+    }
+    else {
+        m_recent_changes.clear();
+    }
+    update_read_version();
+    release_unused_sorted_views();
+    // Rows other Realms added may have taken the cache over its limits, and
+    // an eviction which couldn't find its rows after an intervening commit
+    // needs to pick them again
+    if (m_access_tracker && m_async_writer) {
+        evict_if_over_cache_limits();
+    }
+    deliver_results_notifications();
+}
+
+size_t Realm::add_results_notifier(std::shared_ptr<_impl::ResultsNotifier> notifier)
+{
+    verify_thread();
+    size_t token = m_next_results_notifier_token++;
+    m_results_notifiers[token] = std::move(notifier);
+    return token;
+}
+
+void Realm::remove_results_notifier(size_t token)
+{
+    m_results_notifiers.erase(token);
+}
+
+size_t Realm::add_aggregate_notifier(std::shared_ptr<_impl::AggregateNotifier> notifier)
+{
+    verify_thread();
+    size_t token = m_next_aggregate_notifier_token++;
+    m_aggregate_notifiers[token] = std::move(notifier);
+    return token;
+}
+
+void Realm::remove_aggregate_notifier(size_t token)
+{
+    m_aggregate_notifiers.erase(token);
+}
+
+void Realm::deliver_results_notifications()
+{
+    if (m_results_notifiers.empty() && m_aggregate_notifiers.empty()) {
+        return;
+    }
+
+    auto self = shared_from_this();
+    auto deliver = [&](auto& notifiers) {
+        // Callbacks can add and remove notifiers, or close the Realm
+        std::vector<size_t> tokens;
+        tokens.reserve(notifiers.size());
+        for (auto const& notifier : notifiers) {
+            tokens.push_back(notifier.first);
+        }
+        for (size_t token : tokens) {
+            if (!m_group || m_in_transaction) {
+                return false;
+            }
+            auto it = notifiers.find(token);
+            if (it != notifiers.end()) {
+                auto notifier = it->second;
+                notifier->deliver(self);
+            }
+        }
+        return true;
+    };
+    if (deliver(m_results_notifiers)) {
+        deliver(m_aggregate_notifiers);
+    }
+}
+
+bool Realm::refreshes_in_steps() const
+{
+    return m_version_checkpoints && (m_config.autorefresh_version_limit
+                                     || m_config.autorefresh_time_budget != std::chrono::milliseconds::zero());
+}
+
+void Realm::advance_read_in_steps()
+{
+    auto start = std::chrono::steady_clock::now();
+    while (true) {
+        auto checkpoint = m_version_checkpoints->next_step(current_transaction_version(),
+                                                            m_config.autorefresh_version_limit);
+        if (!checkpoint) {
+            advance_read();
+            return;
+        }
+        advance_read(checkpoint.get());
+
+        // The change notifications for the step may have closed the Realm or
+        // begun a write transaction
+        if (!m_group || m_in_transaction || !m_shared_group->has_changed()) {
+            return;
+        }
+        if (std::chrono::steady_clock::now() - start >= m_config.autorefresh_time_budget) {
+            break;
+        }
+    }
+
+    // Continue from here on the next turn of the run loop
+    m_notifier->signal_realm(this);
+}
+
+void Realm::update_read_version()
+{
+    uint_fast64_t version = m_group ? current_transaction_version() : 0;
+    if (version != m_read_version) {
+        // Don't keep the old version pinned once this Realm has moved on
+        m_current_snapshot.reset();
+        m_read_version = version;
+        auto now = std::chrono::steady_clock::now();
+        m_read_began = now.time_since_epoch().count();
+        m_last_used = now;
+    }
+}
+
+std::shared_ptr<RealmSnapshot> const& Realm::current_snapshot()
+{
+    if (!m_current_snapshot) {
+        m_current_snapshot = RealmSnapshot::create(*this);
+    }
+    return m_current_snapshot;
+}
+
+bool Realm::idle_read_expired() const
+{
+    if (m_config.idle_read_timeout == std::chrono::milliseconds::zero()) {
+        return false;
+    }
+    if (m_auto_refresh || m_in_transaction || !m_group) {
+        return false;
+    }
+    return std::chrono::steady_clock::now() - m_last_used >= m_config.idle_read_timeout;
+}
 
+std::vector<ReadTransactionInfo> Realm::get_read_transactions(std::string const& path)
+{
+    std::vector<ReadTransactionInfo> readers;
+    auto now = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(s_open_realms_mutex);
+        for (auto realm : s_open_realms) {
+            uint_fast64_t version = realm->m_read_version;
+            if (version == 0 || realm->m_config.path != path) {
+                continue;
+            }
+            std::chrono::steady_clock::time_point began(std::chrono::steady_clock::duration(realm->m_read_began.load()));
+            readers.push_back({realm->m_thread_id, version, now - began});
+        }
+    }
+
+    std::sort(readers.begin(), readers.end(), [](auto const& a, auto const& b) {
+        return a.version < b.version || (a.version == b.version && a.age > b.age);
+    });
+    return readers;
+}
+
+namespace {
+// The total size of the arrays in the tree of nodes rooted at the given ref
+size_t tree_byte_size(Allocator& alloc, ref_type ref)
+{
+    Array node(alloc);
+    node.init_from_ref(ref);
+    size_t size = node.get_byte_size();
+    if (node.has_refs()) {
+        for (size_t i = 0; i < node.size(); ++i) {
+            int_fast64_t value = node.get(i);
+            // Odd values are tagged integers rather than refs
+            if (value != 0 && (value & 1) == 0) {
+                size += tree_byte_size(alloc, to_ref(value));
+            }
+        }
+    }
+    return size;
+}
+}
+
+FileStatistics Realm::file_statistics(bool include_tables)
+{
+    verify_thread();
+    check_read_write(this);
+
+    FileStatistics stats;
+    stats.version_count = m_shared_group->get_number_of_versions();
+    m_shared_group->get_stats(stats.free_space, stats.used_space);
+    stats.file_size = stats.free_space + stats.used_space;
+    if (!include_tables) {
+        return stats;
+    }
+
+    Group* group = read_group();
+    for (auto const& object_schema : *m_config.schema) {
+        auto table = ObjectStore::table_for_object_type(group, object_schema.name);
+        if (!table) {
+            continue;
+        }
+
+        TableSpaceUsage usage{object_schema.name, 0, {}};
+        for (auto const& property : object_schema.properties) {
+            auto& column = _impl::TableFriend::get_column(*table, property.table_column);
+            usage.data_size += tree_byte_size(column.get_alloc(), column.get_ref());
+            if (auto index = column.get_search_index()) {
+                usage.index_sizes.emplace_back(property.name, tree_byte_size(column.get_alloc(), index->get_ref()));
+            }
+        }
+        stats.tables.push_back(std::move(usage));
+    }
+    return stats;
+}
+
+uint_fast64_t Realm::current_transaction_version() const
+{
+    // Read-only Realms never change version
+    if (!m_shared_group) {
+        return 0;
+    }
+    return m_shared_group->get_version_of_current_transaction().version;
+}
+
+void Realm::record_changes(TransactionChangeInfo&& info)
+{
+    // Only a bounded number of transactions are kept; anything looking further
+    // back than this just has to recheck everything
+    static const size_t max_recent_changes = 16;
+
+    if (info.initial_version == info.final_version) {
+        return;
+    }
+    if (m_primary_key_cache) {
+        m_primary_key_cache->apply(info);
+    }
+    if (m_access_tracker) {
+        m_access_tracker->apply(info);
+    }
+    if (!m_recent_changes.empty() && m_recent_changes.back().final_version != info.initial_version) {
+        m_recent_changes.clear();
+    }
+    if (m_recent_changes.size() == max_recent_changes) {
+        m_recent_changes.erase(m_recent_changes.begin());
+    }
+    m_recent_changes.push_back(std::move(info));
+}
+
+bool Realm::get_changes_since(uint_fast64_t version, TransactionChangeInfo& info) const
+{
+    if (!m_group) {
+        return false;
+    }
+
+    uint_fast64_t current_version = current_transaction_version();
+    info = TransactionChangeInfo();
+    info.initial_version = info.final_version = version;
+    if (version == current_version) {
+        return true;
+    }
+
+    auto it = std::find_if(m_recent_changes.begin(), m_recent_changes.end(),
+                           [=](auto const& changes) { return changes.initial_version == version; });
+    if (it == m_recent_changes.end() || m_recent_changes.back().final_version != current_version) {
+        return false;
+    }
+    for (; it != m_recent_changes.end(); ++it) {
+        info.merge(*it);
+    }
     return true;
 }
 
@@ -422,104 +1553,124 @@ uint64_t Realm::get_schema_version(const realm::Realm::Config &config)
         return existing_realm->config().schema_version;
     }
 
+    // The version lives in the metadata table, so it can be read from a
+    // read-only mapping of the file without creating the lock file, history
+    // and commit helper which opening a full Realm would require
+    if (!config.in_memory) {
+        try {
+            Group group(config.path, config.encryption_key.data(), Group::mode_ReadOnly);
+            return ObjectStore::get_schema_version(&group);
+        }
+        catch (util::File::NotFound const&) {
+            // Opening a Realm would create an empty, unversioned file
+            return ObjectStore::NotVersioned;
+        }
+        catch (...) {
+            // Files which need an upgrade or can't be mapped directly are
+            // handled (and any errors reported) by opening them normally
+        }
+    }
+
     return ObjectStore::get_schema_version(Realm(config).read_group());
 }
 
 void Realm::close()
 {
+    // Pending async queries hold accessors which need to be released while
+    // the group still exists
+    auto async_completions = std::move(m_async_completions);
+    async_completions.clear();
+    auto results_notifiers = std::move(m_results_notifiers);
+    results_notifiers.clear();
+    auto aggregate_notifiers = std::move(m_aggregate_notifiers);
+    aggregate_notifiers.clear();
+
     invalidate();
 
     if (m_notifier) {
         m_notifier->remove_realm(this);
     }
+    if (m_version_checkpoints) {
+        m_version_checkpoints->remove_realm(this);
+    }
+    unregister_open_realm(this);
 
     m_group = nullptr;
     m_shared_group = nullptr;
     m_history = nullptr;
     m_read_only_group = nullptr;
     m_notifier = nullptr;
+    m_group_commit_queue = nullptr;
+    // The sweeper's thread briefly holds a reference to the writer, so it's
+    // stopped first to make sure the writer is released on this thread
+    m_expiry_sweeper = nullptr;
+    m_async_writer = nullptr;
+    m_version_checkpoints = nullptr;
+    m_prefetcher = nullptr;
     m_binding_context = nullptr;
 }
 
 SharedRealm RealmCache::get_realm(const std::string &path, std::thread::id thread_id)
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-
-    auto path_iter = m_cache.find(path);
-    if (path_iter == m_cache.end()) {
-        return SharedRealm();
-    }
-
-    auto thread_iter = path_iter->second.find(thread_id);
-    if (thread_iter == path_iter->second.end()) {
-        return SharedRealm();
-    }
+    WeakRealm realm;
+    m_cache.get(path, thread_id, realm);
+    return realm.lock();
+}
 
-    return thread_iter->second.lock();
+SharedRealm RealmCache::get_realm(const std::string &path, _impl::DispatchQueue const& queue)
+{
+    WeakRealm realm;
+    m_queue_cache.get(path, queue.get(), realm);
+    return realm.lock();
 }
 
 SharedRealm RealmCache::get_any_realm(const std::string &path)
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-
-    auto path_iter = m_cache.find(path);
-    if (path_iter == m_cache.end()) {
-        return SharedRealm();
+    WeakRealm realm;
+    if (!m_cache.get_any(path, realm)) {
+        m_queue_cache.get_any(path, realm);
     }
+    return realm.lock();
+}
 
-    auto thread_iter = path_iter->second.begin();
-    while (thread_iter != path_iter->second.end()) {
-        if (auto realm = thread_iter->second.lock()) {
-            return realm;
+std::vector<SharedRealm> RealmCache::get_all_realms()
+{
+    std::vector<SharedRealm> realms;
+    auto add = [&](std::vector<WeakRealm> const& weak_realms) {
+        for (auto const& weak_realm : weak_realms) {
+            if (auto realm = weak_realm.lock()) {
+                realms.push_back(std::move(realm));
+            }
         }
-        path_iter->second.erase(thread_iter++);
-    }
-
-    return SharedRealm();
+    };
+    add(m_cache.values());
+    add(m_queue_cache.values());
+    return realms;
 }
 
 void RealmCache::remove(const std::string &path, std::thread::id thread_id)
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-
-    auto path_iter = m_cache.find(path);
-    if (path_iter == m_cache.end()) {
-        return;
-    }
-
-    auto thread_iter = path_iter->second.find(thread_id);
-    if (thread_iter != path_iter->second.end()) {
-        path_iter->second.erase(thread_iter);
-    }
-
-    if (path_iter->second.size() == 0) {
-        m_cache.erase(path_iter);
-    }
+    m_cache.remove(path, thread_id);
 }
 
 void RealmCache::cache_realm(SharedRealm &realm, std::thread::id thread_id)
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-
-    auto path_iter = m_cache.find(realm->config().path);
-    if (path_iter == m_cache.end()) {
-        m_cache.emplace(realm->config().path, std::map<std::thread::id, WeakRealm>{{thread_id, realm}});
+    if (auto const& queue = realm->config().dispatch_queue) {
+        m_queue_cache.insert(realm->config().path, queue.get(), realm);
     }
     else {
-        path_iter->second.emplace(thread_id, realm);
+        m_cache.insert(realm->config().path, thread_id, realm);
     }
 }
 
 void RealmCache::clear()
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    for (auto const& path : m_cache) {
-        for (auto const& thread : path.second) {
-            if (auto realm = thread.second.lock()) {
-                realm->close();
-            }
+    auto realms = m_cache.clear();
+    auto queue_realms = m_queue_cache.clear();
+    realms.insert(realms.end(), queue_realms.begin(), queue_realms.end());
+    for (auto const& weak_realm : realms) {
+        if (auto realm = weak_realm.lock()) {
+            realm->close();
         }
     }
-
-    m_cache.clear();
 }
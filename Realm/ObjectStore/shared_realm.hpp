@@ -19,44 +19,283 @@
 #ifndef REALM_REALM_HPP
 #define REALM_REALM_HPP
 
+#include "column_statistics.hpp"
+#include "dispatch_queue.hpp"
 #include "object_store.hpp"
-
+#include "query_workload.hpp"
+#include "sharded_cache.hpp"
+#include "transaction_metrics.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <map>
 #include <memory>
-#include <mutex>
 #include <thread>
+#include <tuple>
 #include <vector>
 
 namespace realm {
     class ClientHistory;
+    class ChangeFeed;
+    struct Collation;
+    class DateTime;
+    class Table;
+    class TableView;
     class Realm;
     class RealmCache;
+    class RealmSnapshot;
+    class ThreadSafeReference;
     class BindingContext;
     typedef std::shared_ptr<Realm> SharedRealm;
     typedef std::weak_ptr<Realm> WeakRealm;
 
     namespace _impl {
+        class AccessTracker;
+        class AggregateNotifier;
+        class AsyncQuery;
+        class AsyncWriter;
+        class ChangeCalculator;
+        class CollationKeyCache;
+        class CompoundIndex;
+        class DecryptedFile;
+        class ExpirySweeper;
         class ExternalCommitHelper;
+        class GroupCommitQueue;
+        class LinkListAggregates;
+        class MappedFile;
+        class ParallelQuery;
+        class Prefetcher;
+        class VersionCheckpoints;
+        class PrimaryKeyCache;
+        class ResultsNotifier;
+        class TextIndex;
+        struct TransactionChangeInfo;
+        class UncommittedRowIndexChanges;
     }
 
+    // A Realm instance's read transaction, as seen from any thread
+    struct ReadTransactionInfo {
+        std::thread::id thread_id;
+        uint_fast64_t version;
+        // How long ago the Realm began reading from this version
+        std::chrono::steady_clock::duration age;
+    };
+
+    // The space used by the current version of an object type's table
+    struct TableSpaceUsage {
+        std::string object_type;
+        // Bytes used by the values of every property, including link lists,
+        // but not by search indexes
+        size_t data_size;
+        // Bytes used by the search index of each indexed property, by name
+        std::vector<std::pair<std::string, size_t>> index_sizes;
+    };
+
+    struct FileStatistics {
+        // The number of versions of the data which are being kept alive by
+        // the read transactions of all processes using the file
+        uint_fast64_t version_count;
+        // Bytes in the file which are available for reuse, and which are in
+        // use by the current and pinned versions. Space used only by pinned
+        // versions is the used space not accounted for by the tables.
+        size_t free_space;
+        size_t used_space;
+        size_t file_size;
+        // Only computed when asked for, as it reads every node of every table
+        std::vector<TableSpaceUsage> tables;
+    };
+
     class Realm : public std::enable_shared_from_this<Realm>
     {
       public:
         typedef std::function<void(SharedRealm old_realm, SharedRealm realm)> MigrationFunction;
+        typedef std::function<void(std::string const& description, std::chrono::microseconds duration)> SlowQueryFunction;
+        typedef std::function<void(size_t bytes_reclaimed)> CompactionFunction;
+        typedef std::function<void(std::exception_ptr error)> IndexCreationFunction;
 
         struct Config
         {
             std::string path;
             bool read_only = false;
+            // The file is never modified while it's open, such as a file
+            // bundled with the app. Implies read_only. Realms for unencrypted
+            // immutable files all read from a single shared mapping of the
+            // file which is paged in as it's accessed, rather than each
+            // mapping and validating the file separately.
+            bool immutable = false;
             bool in_memory = false;
+
+            // If non-zero, a Realm with auto-refresh disabled which has been
+            // neither refreshed nor read from for at least this long ends its
+            // read transaction the next time it is notified of a commit, so
+            // that it does not keep old versions of the data alive and make
+            // the file grow
+            std::chrono::milliseconds idle_read_timeout{0};
+
+            // If either is non-zero, automatic refreshes advance through the
+            // versions committed by other Realms in this process in bounded
+            // steps rather than straight to the newest version: at most
+            // autorefresh_version_limit versions per step, and taking steps
+            // for at most autorefresh_time_budget per notification (or a
+            // single step per notification if zero), continuing on the next
+            // turn of the run loop. Steps are a few versions long if only the
+            // time budget is set. Change notifications are sent after each
+            // step. Explicit calls to refresh() always advance to the newest version.
+            size_t autorefresh_version_limit = 0;
+            std::chrono::milliseconds autorefresh_time_budget{0};
+
+            // The shortest time between notifications of commits made by other
+            // threads and processes. Commits made sooner than that after the
+            // previous notification are delivered together in a single
+            // notification at the end of the interval. Zero notifies of each
+            // commit as soon as possible.
+            std::chrono::milliseconds notification_interval{0};
+
+            // The runloop modes in which Realms confined to a thread process
+            // notifications, e.g. "kCFRunLoopCommonModes" to keep delivering
+            // them while a scroll view is tracking. Empty means only the
+            // default mode.
+            std::vector<std::string> notification_runloop_modes;
+            // The QoS class (a qos_class_t) requested for the thread which
+            // listens for commits made by other threads and processes, or 0
+            // for no preference. The thread is shared by every Realm in the
+            // process and runs at the highest class any of them has
+            // requested. Ignored on platforms without QoS classes.
+            unsigned int notification_thread_qos = 0;
             bool cache = true;
             bool disable_format_upgrade = false;
+
+            // If non-zero, the file is compacted when it is first opened in
+            // this process, before any Realm for it is returned, if at least
+            // this fraction of it is free space and it is at least
+            // compact_on_open_min_size bytes. Compaction is skipped if the
+            // file is open in another process. compaction_function is then
+            // called on the opening thread with the number of bytes reclaimed.
+            double compact_on_open_free_ratio = 0;
+            size_t compact_on_open_min_size = 0;
+            CompactionFunction compaction_function;
+
+            // If set, the Realm is confined to this serial queue rather than to
+            // the thread which opened it: it can be used from any thread while
+            // running on the queue, is cached per queue, and is notified of
+            // changes by dispatching to the queue. It must be opened on the queue.
+            _impl::DispatchQueue dispatch_queue;
             std::vector<char> encryption_key;
+            // If non-zero, immutable encrypted files which are no larger than
+            // this many bytes once decrypted are decrypted into memory when
+            // the first Realm for the file is opened in this process, and
+            // every immutable Realm for the file with the same key reads from
+            // that copy, without paying for decryption on each access. The
+            // copy is freed once no Realm is using it. Larger files are read
+            // through core's decrypting mapping as usual.
+            size_t decrypted_cache_max_size = 0;
+
+            // If non-zero, disk space is reserved for the file to be at
+            // least initial_file_size bytes when it is opened for writing,
+            // and, once a commit brings it close to the end of the reserved
+            // space, for it to grow by the larger of file_growth_increment
+            // bytes and file_growth_factor times its current size, so that
+            // bulk imports extend the file in a few large steps rather than
+            // many small ones. Ignored for in-memory Realms.
+            size_t initial_file_size = 0;
+            size_t file_growth_increment = 0;
+            double file_growth_factor = 0;
+
+            // Use the Realm as a size-limited cache, typically with
+            // in_memory set: after a commit leaves more than
+            // cache_max_objects objects of any type, or the Realm using
+            // more than cache_max_bytes bytes, the least recently accessed
+            // objects are deleted by a write on the background async write
+            // thread. Objects are accessed by reading them from Results and
+            // by the binding creating accessors for them. Zero disables each
+            // limit. Requires track_changes.
+            // Accesses are tracked per Realm instance, and so per thread: the
+            // rows evicted are picked by the instance which commits or
+            // refreshes past a limit, from the accesses made through it.
+            size_t cache_max_objects = 0;
+            size_t cache_max_bytes = 0;
+
+            // If non-zero, objects of types with a time to live which have
+            // expired are deleted on the background async write thread
+            // this often, in write transactions which each delete at most
+            // expiry_sweep_batch_size objects so that a large backlog
+            // doesn't hold the write lock for long. Sweeping starts once a
+            // Realm with this set is opened for writing, and stops when the
+            // last Realm for the file is closed.
+            std::chrono::milliseconds expiry_sweep_interval{0};
+            size_t expiry_sweep_batch_size = 1000;
+
+            // The most write_behind() writes committed in a single write
+            // transaction, and how long the writer thread waits for more of
+            // them to arrive after the first one before it begins the
+            // transaction. Zero begins it as soon as the writer is free, with
+            // whatever writes were queued while it was busy. Only the values
+            // from the first Realm which writes behind to the file are used.
+            size_t write_behind_batch_size = 1000;
+            std::chrono::milliseconds write_behind_delay{0};
 
             std::unique_ptr<Schema> schema;
             uint64_t schema_version = ObjectStore::NotVersioned;
 
             MigrationFunction migration_function;
 
+            // Called on the Realm's thread with a description of each query
+            // which takes at least slow_query_threshold to run
+            SlowQueryFunction slow_query_function;
+            std::chrono::microseconds slow_query_threshold{0};
+
+            // Record the shape, rows scanned and duration of each query run
+            // by Results on this Realm in query_workload(), so that indexes
+            // can be recommended for the queries the app actually runs
+            bool record_query_workload = false;
+
+            // Object types whose data is read on a background thread when the
+            // file is first opened in this process, so that the first queries
+            // on them find it in the OS's page cache rather than blocking on
+            // reads from disk
+            std::vector<std::string> prefetch_object_types;
+
+            // Add the search indexes which update_schema() finds missing,
+            // other than those for primary keys, in a write on the background
+            // async write thread rather than before it returns. Queries on
+            // the unindexed properties scan the table until then.
+            // index_creation_function is then called on the Realm's thread,
+            // after refreshing it, with the error which occurred, if any. If
+            // the indexes aren't added, such as if the app exits first, they
+            // are found to be missing again the next time the file is opened.
+            bool defer_index_creation = false;
+            IndexCreationFunction index_creation_function;
+
+            // Aggregates and counts over unsorted Results which have to read
+            // at least this many rows are split into chunks which are evaluated
+            // concurrently on background threads, each reading from a snapshot
+            // of the Realm's current version. Zero disables this.
+            size_t parallel_aggregate_threshold = 0;
+
+            // If non-empty, refreshes which only advance over commits that did
+            // not modify any of these object types do not call the binding
+            // context's did_change(), unless it is observing specific rows
+            std::vector<std::string> observed_object_types;
+
+            // Parse the transaction logs of new commits on a background thread
+            // before notifying Realms of them, so that Realms which aren't
+            // observing any rows can refresh without parsing the logs. Only
+            // the config of the first Realm opened for the file in the process
+            // is used for this. Ignored for read-only Realms.
+            bool compute_changes_in_background = false;
+
+            // Summarize the changes made by the transactions this Realm
+            // advances over. Without this, Realms which aren't observing any
+            // rows refresh without parsing the transaction logs, checking only
+            // that the schema wasn't changed incompatibly, but
+            // get_changes_since() is never able to report changes,
+            // observed_object_types has no effect and Results notifications
+            // report every row as replaced. Intended for Realms used by
+            // background workers.
+            bool track_changes = true;
+
             Config();
             Config(Config&&);
             Config(const Config& c);
@@ -90,21 +329,209 @@ namespace realm {
         void cancel_transaction();
         bool is_in_transaction() const { return m_in_transaction; }
 
+        // Run the function in a write transaction which may be shared with
+        // other threads calling grouped_write() on this file at the same
+        // time, so that all of their changes are committed to disk at once.
+        // The function may be called on another thread, and is passed the
+        // Realm to use, which belongs to that thread. It must only use that
+        // Realm, objects obtained from it, and data handed over to it (such as
+        // values copied into it), and must have no side effects other than
+        // writing to the Realm. Using anything confined to another Realm's
+        // thread makes it fail with a logic_error. If it throws before making
+        // any changes it is simply left out of the group; if it throws after
+        // making changes, the changes from the entire group are rolled back
+        // and the other functions are called again in a new write transaction.
+        // Returns once the function's changes have been committed, after
+        // which this Realm is refreshed to the latest version.
+        void grouped_write(std::function<void (Realm&)> fn);
+
+        // Run the function in a write transaction on a background thread
+        // dedicated to writing to this file, passing it that thread's Realm,
+        // so that this thread never waits for the write lock. Writes are
+        // performed in the order they were queued. The completion function is
+        // called on this Realm's thread, after refreshing it to the latest
+        // version, with the exception thrown by the write function or by
+        // committing the transaction, if any. As with async queries, the
+        // completion is only called if this thread runs its run loop.
+        void async_write(std::function<void (Realm&)> fn,
+                         std::function<void (std::exception_ptr)> completion);
+
+        // Queue the function to be run on the same background writer thread
+        // as async_write(), in a write transaction shared with the other
+        // write-behind functions queued by any thread by the time the writer
+        // gets to it, and return without waiting for it or being told when
+        // it's done. Functions queued by a single thread are run in order.
+        // The function is always called on the writer thread, so it must only
+        // use the Realm it is passed and data handed over to it. If a function
+        // throws after making changes, the transaction is rolled back and the
+        // functions which ran before it in that transaction are called a
+        // second time, so functions must have no side effects other than
+        // writing to the Realm. A function which throws before making any
+        // changes is just left out.
+        void write_behind(std::function<void (Realm&)> fn);
+        // Block until every function passed to write_behind() by any thread
+        // before the call has been committed, then refresh. Rethrows the first
+        // exception thrown by a write-behind function or by committing their
+        // transactions since the previous flush.
+        void flush_write_behind();
+
         bool refresh();
         void set_auto_refresh(bool auto_refresh) { m_auto_refresh = auto_refresh; }
         bool auto_refresh() const { return m_auto_refresh; }
         void notify();
 
+        // The version of the read transaction the Realm is currently on
+        uint_fast64_t current_transaction_version() const;
+
+        // Get the combined row-level changes made between the given version
+        // and the current read transaction version. Returns false if changes
+        // from that far back are no longer available, in which case the
+        // caller needs to assume that anything could have changed.
+        bool get_changes_since(uint_fast64_t version, _impl::TransactionChangeInfo& info) const;
+
+        // The number of write transactions which have been begun or cancelled
+        // on this Realm. Local writes are not included in the changes reported
+        // by get_changes_since(), and a cancelled write does not change the
+        // version, so anything computed inside a write has to be recomputed
+        // once it ends either way.
+        size_t write_transaction_count() const { return m_write_transaction_count; }
+
+        // Add the changes to row indexes made by the current write transaction
+        // since the parser's previous call to `changes`, so that things keyed
+        // by row index can follow rows moved by deletions within the write
+        void parse_uncommitted_row_index_changes(_impl::UncommittedRowIndexChanges& parser,
+                                                 _impl::TransactionChangeInfo& changes);
+
+        // Get a view of every row in the table sorted on the given column,
+        // brought up to date with the current version. The view is shared by
+        // all Results on this Realm with the same sort, so that the table is
+        // only sorted once per version rather than once per Results. The
+        // Realm releases views which nothing else holds a reference to when
+        // it advances to a new version.
+        std::shared_ptr<TableView> get_sorted_view(Table& table, size_t column, bool ascending);
+
+        // Find the row in the table with the given non-null value for the
+        // primary key in the given column, or not_found if there is none.
+        // Repeated lookups of a key usually return the row found previously
+        // without searching the table.
+        size_t find_by_primary_key(Table& table, size_t column, StringData key);
+        size_t find_by_primary_key(Table& table, size_t column, int64_t key);
+
+        // Get the statistics of the values in a column of every row of the
+        // table. They are computed the first time they're requested for each
+        // version and reused until the Realm changes, but are recomputed on
+        // each call in a write transaction.
+        ColumnStatistics column_statistics(Table const& table, size_t column);
+
+        // Note that the row was read, so that a Realm used as a size-limited
+        // cache evicts it after the rows which were read less recently
+        void record_access(Table const& table, size_t row)
+        {
+            if (m_access_tracker) {
+                track_access(table, row);
+            }
+        }
+
+        // Get the full-text index of the given string column, creating it if
+        // needed. The index is only brought up to date when it's used, by
+        // calling update() on it.
+        std::shared_ptr<_impl::TextIndex> get_text_index(Table& table, size_t column);
+
+        // Get the index over the values of the given int and string columns,
+        // creating it if needed. As with text indexes, the index must be
+        // brought up to date by calling update() on it.
+        std::shared_ptr<_impl::CompoundIndex> get_compound_index(Table& table, std::vector<size_t> const& columns);
+
+        // Get the cache of collation keys for the given string column and
+        // collation, creating it if needed. It must be brought up to date by
+        // calling update() on it before it's used.
+        std::shared_ptr<_impl::CollationKeyCache> get_collation_keys(Table& table, size_t column,
+                                                                     std::shared_ptr<const Collation> const& collation);
+
+        // Get the cached sizes of the link lists in the given column, or the
+        // sums of the given column of the rows in them if `target_column` isn't
+        // npos, creating them if needed. They must be brought up to date by
+        // calling update() on them before they're used.
+        std::shared_ptr<_impl::LinkListAggregates> get_link_list_aggregates(Table& table, size_t link_column,
+                                                                            size_t target_column);
+
+        // If objects in the table expire, get the DateTime column they expire
+        // relative to and the earliest date in it which hasn't expired yet
+        bool get_expiry_cutoff(Table const& table, size_t& column, DateTime& cutoff) const;
+        // Delete up to `limit` objects which have expired, returning how many
+        // were deleted. Must be called in a write transaction.
+        size_t delete_expired_objects(size_t limit);
+
+        // Timings and counts of the work done by this Realm since it was
+        // opened or the metrics were last reset
+        TransactionMetrics const& metrics() const { return m_metrics; }
+        // For recording work done for this Realm by Results and the binding
+        TransactionMetrics& metrics() { return m_metrics; }
+        void reset_metrics() { m_metrics = TransactionMetrics(); }
+
+        // The queries run by Results on this Realm since it was opened or the
+        // workload was last cleared, or null if the config doesn't have
+        // record_query_workload set
+        QueryWorkload* query_workload() { return m_query_workload.get(); }
+        QueryWorkload const* query_workload() const { return m_query_workload.get(); }
+
+        // Get the read transactions of every open Realm for the file in this
+        // process, with the oldest version first. Can be called from any
+        // thread.
+        static std::vector<ReadTransactionInfo> get_read_transactions(std::string const& path);
+
+        // Get the version count and space usage of the file, and optionally
+        // the space used by each object type's table in the current version
+        FileStatistics file_statistics(bool include_tables = false);
+
         void invalidate();
         bool compact();
 
+        // How much of its memory use trim_memory() has a Realm give up
+        enum class TrimLevel {
+            // Drop caches which are rebuilt when next needed: primary key
+            // lookups, recent change summaries, the current version's
+            // snapshot and its pooled readers, and background prefetching
+            Caches,
+            // Also stop keeping old versions pinned, by releasing refresh
+            // checkpoints and refreshing to the newest version if the Realm
+            // would automatically do so anyway
+            Versions,
+        };
+
+        // Release memory which the Realm can do without, e.g. in response to
+        // a memory warning. The binding context is told first so that it can
+        // drop its own caches. Must be called on the Realm's thread.
+        void trim_memory(TrimLevel level);
+
+        // Trim the memory of every cached Realm in the process. Realms which
+        // belong to the calling thread are trimmed immediately, and others
+        // the next time their thread processes notifications. Can be called
+        // from any thread.
+        static void trim_memory_for_all_realms(TrimLevel level);
+
         std::thread::id thread_id() const { return m_thread_id; }
         void verify_thread() const;
+        // Note that the read transaction is being read from, so that it isn't
+        // ended for being idle. Only Realms which can be ended for being idle
+        // read the clock, so it's cheap enough to call on every read.
+        void did_access() noexcept
+        {
+            if (m_config.idle_read_timeout != std::chrono::milliseconds::zero() && !m_auto_refresh && !m_frozen) {
+                m_last_used = std::chrono::steady_clock::now();
+            }
+        }
         void verify_in_write() const;
 
         // Close this Realm and remove it from the cache. Continuing to use a
         // Realm after closing it will produce undefined behavior.
         void close();
+        bool is_closed() const { return !m_read_only_group && !m_shared_group; }
+
+        // Frozen Realms are the readers of a RealmSnapshot: they stay at a
+        // single version, can't be written to or refreshed, and can be used
+        // from whichever thread currently has exclusive use of them
+        bool is_frozen() const { return m_frozen; }
 
         ~Realm();
 
@@ -115,14 +542,154 @@ namespace realm {
         std::thread::id m_thread_id = std::this_thread::get_id();
         bool m_in_transaction = false;
         bool m_auto_refresh = true;
+        bool m_frozen = false;
+        size_t m_write_transaction_count = 0;
+        TransactionMetrics m_metrics;
+        std::unique_ptr<QueryWorkload> m_query_workload;
+        // The commit time of the newest commit by another Realm in this
+        // process which this Realm has been notified of, for m_metrics.notify
+        std::chrono::steady_clock::time_point m_last_notified_commit_time;
+        // The file size which this Realm has reserved disk space up to
+        size_t m_reserved_file_size = 0;
+
+        // The version of the current read transaction (or 0 if there is none)
+        // and when it began, so that it can be read from other threads
+        std::atomic<uint_fast64_t> m_read_version{0};
+        std::atomic<std::chrono::steady_clock::rep> m_read_began{0};
+        // When the read transaction was last begun, advanced, refreshed or
+        // read from, for idle_read_timeout
+        std::chrono::steady_clock::time_point m_last_used;
 
         std::unique_ptr<ClientHistory> m_history;
         std::unique_ptr<SharedGroup> m_shared_group;
+        // The mapping m_read_only_group reads from for immutable files, which
+        // must outlive the group
+        std::shared_ptr<_impl::MappedFile> m_mapped_file;
+        // The decrypted copy m_read_only_group reads from for immutable
+        // encrypted files, which must also outlive the group
+        std::shared_ptr<_impl::DecryptedFile> m_decrypted_file;
         std::unique_ptr<Group> m_read_only_group;
 
         Group *m_group = nullptr;
 
         std::shared_ptr<_impl::ExternalCommitHelper> m_notifier;
+        std::shared_ptr<_impl::GroupCommitQueue> m_group_commit_queue;
+        std::shared_ptr<_impl::AsyncWriter> m_async_writer;
+        std::shared_ptr<_impl::ExpirySweeper> m_expiry_sweeper;
+        std::shared_ptr<_impl::VersionCheckpoints> m_version_checkpoints;
+        std::shared_ptr<_impl::Prefetcher> m_prefetcher;
+
+        // Summaries of the most recent transactions advanced over, oldest first
+        std::vector<_impl::TransactionChangeInfo> m_recent_changes;
+
+        // Functions to run on this thread when work being done in the
+        // background for this Realm completes, keyed by the token passed to
+        // the background work
+        std::map<size_t, std::function<void ()>> m_async_completions;
+        size_t m_next_async_token = 0;
+
+        // Notifiers for Results being observed on this Realm, keyed by the
+        // token returned from Results::add_notification_callback()
+        std::map<size_t, std::shared_ptr<_impl::ResultsNotifier>> m_results_notifiers;
+        size_t m_next_results_notifier_token = 0;
+        // Notifiers for AggregateViews being observed on this Realm
+        std::map<size_t, std::shared_ptr<_impl::AggregateNotifier>> m_aggregate_notifiers;
+        size_t m_next_aggregate_notifier_token = 0;
+
+        // Views of entire tables sorted on a single column, keyed by the
+        // table's index in the group, the column and the sort order
+        std::map<std::tuple<size_t, size_t, bool>, std::shared_ptr<TableView>> m_sorted_views;
+
+        std::unique_ptr<_impl::PrimaryKeyCache> m_primary_key_cache;
+
+        // Column statistics, keyed by the table's index in the group and the
+        // column, along with the version and write transaction count they
+        // were computed at
+        struct CachedColumnStatistics {
+            uint_fast64_t version;
+            size_t write_count;
+            ColumnStatistics statistics;
+        };
+        std::map<std::pair<size_t, size_t>, CachedColumnStatistics> m_column_statistics;
+
+        // The order rows were accessed in, if the Realm is a size-limited
+        // cache, and whether an eviction it queued has yet to run
+        std::unique_ptr<_impl::AccessTracker> m_access_tracker;
+        std::shared_ptr<std::atomic<bool>> m_eviction_pending;
+
+        // Full-text indexes of string columns, keyed by the table's index in
+        // the group and the column. Queries hold weak references to these.
+        std::map<std::pair<size_t, size_t>, std::shared_ptr<_impl::TextIndex>> m_text_indexes;
+        // Compound indexes, keyed by the table's index in the group and the columns
+        std::map<std::pair<size_t, std::vector<size_t>>, std::shared_ptr<_impl::CompoundIndex>> m_compound_indexes;
+        // Collation keys, keyed by the table's index in the group, the column
+        // and the collation's name
+        std::map<std::tuple<size_t, size_t, std::string>, std::shared_ptr<_impl::CollationKeyCache>> m_collation_keys;
+        // Link list aggregates, keyed by the table's index in the group, the
+        // link list column and the target column
+        std::map<std::tuple<size_t, size_t, size_t>, std::shared_ptr<_impl::LinkListAggregates>> m_link_list_aggregates;
+
+        // A snapshot of the current version, which parallel aggregates read
+        // from and thread-safe references keep the version pinned with. It's
+        // kept for as long as the Realm stays at the same version so that its
+        // readers are reused.
+        std::shared_ptr<RealmSnapshot> m_current_snapshot;
+
+        friend class _impl::AsyncQuery;
+        friend class _impl::AsyncWriter;
+        friend class _impl::ChangeCalculator;
+        friend class _impl::GroupCommitQueue;
+        friend class _impl::ParallelQuery;
+        friend class _impl::Prefetcher;
+        friend class _impl::VersionCheckpoints;
+        friend class ChangeFeed;
+        friend class RealmSnapshot;
+        friend class AggregateView;
+        friend class Results;
+        friend class ThreadSafeReference;
+
+        size_t add_results_notifier(std::shared_ptr<_impl::ResultsNotifier> notifier);
+        void remove_results_notifier(size_t token);
+        size_t add_aggregate_notifier(std::shared_ptr<_impl::AggregateNotifier> notifier);
+        void remove_aggregate_notifier(size_t token);
+        // Tell each Results and AggregateView notifier that the read
+        // transaction advanced, either by refreshing or by committing a write
+        void deliver_results_notifications();
+
+        void record_changes(_impl::TransactionChangeInfo&& info);
+        // Drop the sorted views which no Results is using
+        void release_unused_sorted_views();
+        // Advance to the newest version, or to the checkpoint if one is given
+        void advance_read(RealmSnapshot const* checkpoint = nullptr,
+                          _impl::TransactionChangeInfo const* precomputed_changes = nullptr);
+        // Advance towards the newest version in the steps configured by
+        // autorefresh_version_limit and autorefresh_time_budget
+        void advance_read_in_steps();
+        // Compact the file if the config's compaction policy calls for it.
+        // Must be called before any other Realm for the path exists.
+        void compact_if_needed();
+        // Queue a write adding the indexes deferred by update_schema()
+        void add_deferred_indexes();
+        // Wrap an async write completion so that it can be called on the
+        // writer thread, and runs on this Realm's thread after refreshing it,
+        // if this Realm still exists by then
+        std::function<void (std::exception_ptr)> completion_on_realm_thread(std::function<void (std::exception_ptr)> completion);
+        // Reserve the next step of file growth if the file is close to
+        // outgrowing the space reserved so far
+        void reserve_file_growth();
+        void track_access(Table const& table, size_t row);
+        // Queue a write evicting the least recently used rows if the Realm is
+        // over its cache limits
+        void evict_if_over_cache_limits();
+        // Delete the given rows, by table index and then row index at the
+        // given version, from within a write transaction
+        using Evictions = std::vector<std::pair<size_t, std::vector<size_t>>>;
+        void evict_rows(uint_fast64_t version, Evictions const& evictions);
+        bool refreshes_in_steps() const;
+        void update_read_version();
+        bool idle_read_expired() const;
+        // Get m_current_snapshot, creating it if needed
+        std::shared_ptr<RealmSnapshot> const& current_snapshot();
 
       public:
         std::unique_ptr<BindingContext> m_binding_context;
@@ -136,14 +703,22 @@ namespace realm {
     {
       public:
         SharedRealm get_realm(const std::string &path, std::thread::id thread_id = std::this_thread::get_id());
+        SharedRealm get_realm(const std::string &path, _impl::DispatchQueue const& queue);
         SharedRealm get_any_realm(const std::string &path);
+        // Every live Realm in the cache, for any path and thread
+        std::vector<SharedRealm> get_all_realms();
         void remove(const std::string &path, std::thread::id thread_id);
+        // Realms confined to a dispatch queue are cached for their queue
+        // rather than the given thread
         void cache_realm(SharedRealm &realm, std::thread::id thread_id = std::this_thread::get_id());
         void clear();
 
       private:
-        std::map<std::string, std::map<std::thread::id, WeakRealm>> m_cache;
-        std::mutex m_mutex;
+        struct IsAlive {
+            bool operator()(WeakRealm const& realm) const { return !realm.expired(); }
+        };
+        _impl::ShardedCache<std::thread::id, WeakRealm, IsAlive> m_cache;
+        _impl::ShardedCache<void*, WeakRealm, IsAlive> m_queue_cache;
     };
 
     class RealmFileException : public std::runtime_error {
@@ -0,0 +1,248 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "thread_safe_reference.hpp"
+
+#include "realm_snapshot.hpp"
+#include "transact_log_handler.hpp"
+
+#include <realm/commit_log.hpp>
+#include <realm/group.hpp>
+
+#include <stdexcept>
+
+using namespace realm;
+
+ThreadSafeReference::ThreadSafeReference(SharedRealm const& realm, Row const& row)
+: m_type(Type::Row)
+{
+    capture_row(*realm, row);
+}
+
+ThreadSafeReference::ThreadSafeReference(SharedRealm const& realm, Row const& row, size_t link_list_column)
+: m_type(Type::LinkList)
+, m_column_ndx(link_list_column)
+{
+    capture_row(*realm, row);
+}
+
+ThreadSafeReference::ThreadSafeReference(Results const& results)
+: m_type(Type::Results)
+, m_mode(results.m_mode == Results::Mode::TableView ? Results::Mode::Query : results.m_mode)
+, m_sort(results.m_sort)
+, m_limit(results.m_limit)
+, m_offset(results.m_offset)
+, m_distinct_column(results.m_distinct_column)
+, m_page_anchor(results.m_page_anchor)
+, m_description(results.m_description)
+, m_conditions(results.m_conditions)
+{
+    results.validate_read();
+    // Empty Results aren't backed by anything, so there's nothing to pin
+    if (m_mode == Results::Mode::Empty) {
+        return;
+    }
+
+    Realm& realm = *results.m_realm;
+    m_snapshot = realm.current_snapshot();
+    m_version = m_snapshot->version_id();
+
+    if (m_mode == Results::Mode::Table) {
+        m_table_ndx = results.m_table->get_index_in_group();
+        return;
+    }
+
+    // The query's handover carries its restriction to the LinkView, but the
+    // Results also needs the LinkView itself, which is found again from the
+    // row which owns it
+    if (auto const& link_view = results.m_link_view) {
+        if (link_view->is_attached()) {
+            Table& origin = link_view->get_origin_table();
+            m_table_ndx = origin.get_index_in_group();
+            m_row_ndx = link_view->get_origin_row_index();
+            for (size_t col = 0, count = origin.get_column_count(); col < count; ++col) {
+                if (origin.get_column_type(col) == type_LinkList
+                    && origin.get_linklist(col, m_row_ndx).get() == link_view.get()) {
+                    m_column_ndx = col;
+                    break;
+                }
+            }
+        }
+    }
+    m_query = realm.m_shared_group->export_for_handover(results.m_query, ConstSourcePayload::Copy);
+    if (results.m_window_base) {
+        m_window_base = std::make_unique<ThreadSafeReference>(*results.m_window_base);
+    }
+}
+
+ThreadSafeReference::ThreadSafeReference(ThreadSafeReference&&) = default;
+ThreadSafeReference& ThreadSafeReference::operator=(ThreadSafeReference&&) = default;
+ThreadSafeReference::~ThreadSafeReference() = default;
+
+void ThreadSafeReference::capture_row(Realm& realm, Row const& row)
+{
+    realm.verify_thread();
+    if (!row.is_attached()) {
+        throw std::logic_error("Can't create a thread-safe reference to a deleted row.");
+    }
+
+    m_snapshot = realm.current_snapshot();
+    m_version = m_snapshot->version_id();
+    m_table_ndx = row.get_table()->get_index_in_group();
+    m_row_ndx = row.get_index();
+}
+
+Group& ThreadSafeReference::prepare_to_resolve(Realm& realm, Type type)
+{
+    realm.verify_thread();
+    if (m_resolved) {
+        throw std::logic_error("A thread-safe reference can only be resolved once.");
+    }
+    if (type != m_type) {
+        throw std::logic_error("Can't resolve a thread-safe reference as a different type than it refers to.");
+    }
+    if (realm.config().path != m_snapshot->config().path) {
+        throw MismatchedConfigException("Can't resolve a thread-safe reference with a Realm for a different file.");
+    }
+    if (!realm.m_shared_group) {
+        throw InvalidTransactionException("Can't resolve a thread-safe reference in a read-only Realm.");
+    }
+    if (realm.is_in_transaction()) {
+        throw InvalidTransactionException("Can't resolve a thread-safe reference within a write transaction.");
+    }
+
+    realm.read_group();
+    auto version = realm.m_shared_group->get_version_of_current_transaction();
+    if (version.version < m_version.version) {
+        if (realm.is_frozen()) {
+            throw InvalidTransactionException("Can't resolve a thread-safe reference in a frozen Realm at an older version.");
+        }
+        realm.advance_read(m_snapshot.get());
+    }
+    else if (version != m_version) {
+        move_to_version(version);
+    }
+
+    // The Realm is now reading the version the row and query refer to, so
+    // the source version no longer needs to be kept around
+    m_snapshot.reset();
+    m_resolved = true;
+    return *realm.m_group;
+}
+
+void ThreadSafeReference::move_to_version(SharedGroup::VersionID version)
+{
+    auto const& config = m_snapshot->config();
+    auto history = realm::make_client_history(config.path, config.encryption_key.data());
+    SharedGroup sg(*history, config.in_memory ? SharedGroup::durability_MemOnly : SharedGroup::durability_Full,
+                   config.encryption_key.data());
+
+    // The reference's version is pinned by the snapshot and the target
+    // version by the Realm reading it, so both are still available
+    Group& group = const_cast<Group&>(sg.begin_read(m_version));
+
+    // Row and table accessors and imported queries are updated as the
+    // transaction advances, so they end up at wherever the row moved to
+    TableRef table;
+    Row row;
+    if (m_table_ndx != npos) {
+        table = group.get_table(m_table_ndx);
+        if (m_row_ndx != npos) {
+            row = table->get(m_row_ndx);
+        }
+    }
+    std::unique_ptr<Query> query;
+    if (m_query) {
+        query = sg.import_from_handover(std::move(m_query));
+    }
+
+    _impl::transaction::advance(sg, *history, nullptr, nullptr, version);
+
+    if (table) {
+        m_table_ndx = table->get_index_in_group();
+    }
+    if (m_row_ndx != npos) {
+        m_row_ndx = row.is_attached() ? row.get_index() : npos;
+    }
+    if (query) {
+        m_query = sg.export_for_handover(*query, ConstSourcePayload::Copy);
+    }
+    sg.end_read();
+}
+
+Row ThreadSafeReference::resolve_row(SharedRealm const& realm)
+{
+    Group& group = prepare_to_resolve(*realm, Type::Row);
+    if (m_row_ndx == npos) {
+        return {};
+    }
+    return group.get_table(m_table_ndx)->get(m_row_ndx);
+}
+
+LinkViewRef ThreadSafeReference::resolve_link_list(SharedRealm const& realm)
+{
+    Group& group = prepare_to_resolve(*realm, Type::LinkList);
+    if (m_row_ndx == npos) {
+        return {};
+    }
+    return group.get_table(m_table_ndx)->get_linklist(m_column_ndx, m_row_ndx);
+}
+
+Results ThreadSafeReference::resolve_results(SharedRealm const& realm)
+{
+    if (m_type == Type::Results && m_mode == Results::Mode::Empty) {
+        if (m_resolved) {
+            throw std::logic_error("A thread-safe reference can only be resolved once.");
+        }
+        m_resolved = true;
+        return {};
+    }
+
+    Group& group = prepare_to_resolve(*realm, Type::Results);
+    // A Results restricted to a LinkView whose owner was deleted can't have
+    // its LinkView found again, and would have no rows anyway
+    if (m_column_ndx != npos && m_row_ndx == npos) {
+        return {};
+    }
+
+    Results results;
+    results.m_realm = realm;
+    results.m_mode = m_mode;
+    if (m_mode == Results::Mode::Table) {
+        results.m_table = group.get_table(m_table_ndx).get();
+    }
+    else {
+        results.m_query = std::move(*realm->m_shared_group->import_from_handover(std::move(m_query)));
+        results.m_table = results.m_query.get_table().get();
+        if (m_column_ndx != npos) {
+            results.m_link_view = group.get_table(m_table_ndx)->get_linklist(m_column_ndx, m_row_ndx);
+        }
+    }
+    results.m_sort = std::move(m_sort);
+    results.m_limit = m_limit;
+    results.m_offset = m_offset;
+    results.m_distinct_column = m_distinct_column;
+    results.m_page_anchor = std::move(m_page_anchor);
+    results.m_description = std::move(m_description);
+    results.m_conditions = std::move(m_conditions);
+    if (m_window_base) {
+        results.m_window_base = std::make_shared<Results>(m_window_base->resolve_results(realm));
+    }
+    results.exclude_expired();
+    return results;
+}
@@ -0,0 +1,121 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef REALM_THREAD_SAFE_REFERENCE_HPP
+#define REALM_THREAD_SAFE_REFERENCE_HPP
+
+#include "results.hpp"
+#include "shared_realm.hpp"
+
+#include <realm/group_shared.hpp>
+
+#include <memory>
+
+namespace realm {
+// A reference to a row, to the link list in a column of a row, or to a
+// Results, which can be passed to another thread and resolved there against
+// that thread's Realm for the same file. Resolving doesn't rerun queries or
+// look rows up by primary key: rows are found directly by index, and a
+// Results' query is handed over with its table and LinkView already bound.
+//
+// The version the reference was created at is kept pinned until it's
+// resolved or destroyed. If the resolving Realm is at an older version it's
+// first advanced to that version (sending change notifications as a refresh
+// would), and if it's at a newer version the row and query are followed
+// through the commits in between, so that the resolved accessor refers to
+// the same row even if rows were moved or deleted in the meantime.
+//
+// Each reference can only be resolved once.
+class ThreadSafeReference {
+public:
+    enum class Type {
+        Row,
+        LinkList,
+        Results,
+    };
+
+    // These must be called on the Realm's thread, outside of a write
+    // transaction, and throw InvalidTransactionException otherwise or for
+    // read-only Realms
+    ThreadSafeReference(SharedRealm const& realm, Row const& row);
+    ThreadSafeReference(SharedRealm const& realm, Row const& row, size_t link_list_column);
+    explicit ThreadSafeReference(Results const& results);
+
+    ThreadSafeReference(ThreadSafeReference&&);
+    ThreadSafeReference& operator=(ThreadSafeReference&&);
+    ~ThreadSafeReference();
+
+    Type type() const noexcept { return m_type; }
+    // The version of the Realm the reference was created at
+    uint_fast64_t version() const noexcept { return m_version.version; }
+    bool is_resolved() const noexcept { return m_resolved; }
+
+    // Get the referenced row, link list or Results from the given Realm,
+    // which must be for the same file as the Realm the reference was created
+    // from and must not be in a write transaction. A detached Row or null
+    // LinkViewRef is returned if the row was deleted by the commits the
+    // Realm is ahead of the reference by, and an empty Results if the row
+    // owning the LinkView a Results is restricted to was.
+    // Throws MismatchedConfigException for a Realm for a different file,
+    // InvalidTransactionException in a write transaction or if the Realm is
+    // frozen at an older version, and std::logic_error if the reference has
+    // already been resolved or is of a different type.
+    Row resolve_row(SharedRealm const& realm);
+    LinkViewRef resolve_link_list(SharedRealm const& realm);
+    Results resolve_results(SharedRealm const& realm);
+
+private:
+    Type m_type;
+    bool m_resolved = false;
+    // Keeps the version pinned until the reference is resolved. Null for
+    // references to empty Results, which aren't backed by any version.
+    std::shared_ptr<RealmSnapshot> m_snapshot;
+    SharedGroup::VersionID m_version;
+
+    // The row, or for a Results restricted to a LinkView the row which owns
+    // it, along with the link list column for LinkList references and such
+    // Results. Updated by move_to_version() if the row moves, and npos if
+    // the row was deleted.
+    size_t m_table_ndx = npos;
+    size_t m_row_ndx = npos;
+    size_t m_column_ndx = npos;
+
+    // The parts of a Results which aren't tied to the source thread
+    Results::Mode m_mode = Results::Mode::Empty;
+    std::unique_ptr<SharedGroup::Handover<Query>> m_query;
+    SortOrder m_sort;
+    size_t m_limit = size_t(-1);
+    size_t m_offset = 0;
+    size_t m_distinct_column = npos;
+    util::Optional<Results::PageAnchor> m_page_anchor;
+    Results::DescriptionFunction m_description;
+    std::vector<QueryCondition> m_conditions;
+    // A reference to the limited Results a Results was derived from, if any
+    std::unique_ptr<ThreadSafeReference> m_window_base;
+
+    void capture_row(Realm& realm, Row const& row);
+    // Validate the Realm and bring it and the reference to the same version,
+    // returning the Realm's group
+    Group& prepare_to_resolve(Realm& realm, Type type);
+    // Follow the row and query from the reference's version to the given
+    // newer version so that they can be resolved by a Realm at that version
+    void move_to_version(SharedGroup::VersionID version);
+};
+} // namespace realm
+
+#endif /* REALM_THREAD_SAFE_REFERENCE_HPP */
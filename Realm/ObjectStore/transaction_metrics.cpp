@@ -0,0 +1,61 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "transaction_metrics.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace realm;
+
+void DurationHistogram::add(std::chrono::nanoseconds duration)
+{
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+    size_t index = 0;
+    while (us > 0 && index + 1 < bucket_count) {
+        us >>= 1;
+        ++index;
+    }
+
+    ++m_buckets[index];
+    ++m_count;
+    m_total += duration;
+    m_max = std::max(m_max, duration);
+}
+
+std::chrono::microseconds DurationHistogram::bucket_upper_bound(size_t index)
+{
+    return std::chrono::microseconds(int64_t(1) << index);
+}
+
+std::chrono::nanoseconds DurationHistogram::percentile(double percentile) const
+{
+    if (m_count == 0) {
+        return std::chrono::nanoseconds::zero();
+    }
+
+    auto target = static_cast<uint64_t>(std::ceil(m_count * std::min(std::max(percentile, 0.0), 100.0) / 100.0));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < bucket_count; ++i) {
+        seen += m_buckets[i];
+        if (seen >= target && seen > 0) {
+            return std::min<std::chrono::nanoseconds>(bucket_upper_bound(i), m_max);
+        }
+    }
+    return m_max;
+}
@@ -0,0 +1,111 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef REALM_TRANSACTION_METRICS_HPP
+#define REALM_TRANSACTION_METRICS_HPP
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+namespace realm {
+// A histogram of durations using power-of-two buckets, which can record a
+// duration in constant time and space
+class DurationHistogram {
+public:
+    // Bucket 0 counts durations shorter than a microsecond and bucket i
+    // counts durations of at least 2^(i-1) and less than 2^i microseconds,
+    // except for the last bucket, which counts everything longer
+    static const size_t bucket_count = 32;
+
+    void add(std::chrono::nanoseconds duration);
+
+    uint64_t count() const { return m_count; }
+    std::chrono::nanoseconds total() const { return m_total; }
+    std::chrono::nanoseconds max() const { return m_max; }
+    uint64_t bucket(size_t index) const { return m_buckets[index]; }
+
+    // The exclusive upper bound of the durations counted by a bucket
+    static std::chrono::microseconds bucket_upper_bound(size_t index);
+
+    // An upper bound for the given percentile (from 0 to 100) of the recorded
+    // durations, accurate to within a factor of two
+    std::chrono::nanoseconds percentile(double percentile) const;
+
+private:
+    std::array<uint64_t, bucket_count> m_buckets{};
+    uint64_t m_count = 0;
+    std::chrono::nanoseconds m_total{0};
+    std::chrono::nanoseconds m_max{0};
+};
+
+// Timings and counts of the work done by a single Realm instance, both for
+// its transactions and by the Results and binding objects using it
+struct TransactionMetrics {
+    // Beginning write transactions when the Realm was already at the latest
+    // version, which is the time spent waiting for the write lock
+    DurationHistogram lock_wait;
+    // Beginning write transactions which also had to advance the Realm to a
+    // version committed by someone else after acquiring the write lock
+    DurationHistogram lock_wait_and_advance;
+    // Committing write transactions, including writing to disk
+    DurationHistogram commit;
+    // Advancing the read transaction to the latest version in refresh() and
+    // when notified of a commit, including parsing the transaction logs
+    DurationHistogram advance;
+    // From a commit by another Realm instance in this process to this Realm
+    // starting to process the notification of it
+    DurationHistogram notify;
+    // Delivering the change notifications for advancing the read transaction
+    // to the binding, which is included in `advance`
+    DurationHistogram did_change;
+
+    // Running the queries for Results, both the first time and when
+    // rerunning them after the data they depend on has changed
+    DurationHistogram results_evaluation;
+
+    uint64_t cancelled_transactions = 0;
+    // The total size of the transaction logs written by committing write
+    // transactions
+    uint64_t bytes_committed = 0;
+    // The number of versions advanced over by both advancing read
+    // transactions and beginning write transactions
+    uint64_t versions_advanced = 0;
+    // The number of those versions whose transaction logs were parsed, rather
+    // than the changes having been computed elsewhere or not being needed
+    uint64_t versions_parsed = 0;
+    // The total number of observed rows which were reported to the binding
+    // context's did_change()
+    uint64_t observers_notified = 0;
+    // Accessor objects created for rows by the binding
+    uint64_t accessors_created = 0;
+    // Notifications of commits which advanced the Realm or told the binding
+    // that there were changes available, and notifications which found that
+    // there was nothing new because an earlier notification or refresh() had
+    // already covered the commit
+    uint64_t notifications_delivered = 0;
+    uint64_t notifications_coalesced = 0;
+    // For an immutable encrypted file opened with a decrypted cache size,
+    // whether opening this Realm decrypted the file into memory or reused the
+    // copy decrypted for another Realm
+    uint64_t files_decrypted = 0;
+    uint64_t decrypted_cache_hits = 0;
+};
+} // namespace realm
+
+#endif /* REALM_TRANSACTION_METRICS_HPP */
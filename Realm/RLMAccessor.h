@@ -51,6 +51,13 @@ FOUNDATION_EXTERN id __nullable RLMDynamicGet(RLMObjectBase *obj, RLMProperty *p
 // by property/column
 FOUNDATION_EXTERN void RLMDynamicSet(RLMObjectBase *obj, RLMProperty *prop, id val, RLMCreationOptions options);
 
+// Ranged access to data properties of persisted objects, which reads from and
+// writes to the file without copying the whole value into an NSData
+FOUNDATION_EXTERN NSUInteger RLMGetDataLength(RLMObjectBase *obj, RLMProperty *prop);
+FOUNDATION_EXTERN NSUInteger RLMGetDataBytes(RLMObjectBase *obj, RLMProperty *prop, void *buffer, NSRange range);
+FOUNDATION_EXTERN void RLMReplaceDataBytes(RLMObjectBase *obj, RLMProperty *prop, NSRange range,
+                                           const void *bytes, NSUInteger length);
+
 //
 // Class modification
 //
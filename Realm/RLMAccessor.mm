@@ -107,7 +107,13 @@ static inline void RLMSetValue(__unsafe_unretained RLMObjectBase *const obj, NSU
 // string getter/setter
 static inline NSString *RLMGetString(__unsafe_unretained RLMObjectBase *const obj, NSUInteger colIndex) {
     RLMVerifyAttached(obj);
-    return RLMStringDataToNSString(obj->_row.get_string(colIndex));
+    realm::StringData str = obj->_row.get_string(colIndex);
+    RLMPropertyValueCache *cache = obj->_realm->_propertyValueCache.get();
+    if (cache && str.size() >= cache->minimum_size()) {
+        return cache->get(*obj->_realm->_realm, obj->_row.get_table(), obj->_row.get_index(), colIndex,
+                          [&] { return RLMStringDataToNSString(str); });
+    }
+    return RLMStringDataToNSString(str);
 }
 static inline void RLMSetValue(__unsafe_unretained RLMObjectBase *const obj, NSUInteger colIndex, __unsafe_unretained NSString *const val) {
     RLMVerifyInWriteTransaction(obj);
@@ -161,6 +167,11 @@ static inline void RLMSetValue(__unsafe_unretained RLMObjectBase *const obj, NSU
 static inline NSData *RLMGetData(__unsafe_unretained RLMObjectBase *const obj, NSUInteger colIndex) {
     RLMVerifyAttached(obj);
     realm::BinaryData data = obj->_row.get_binary(colIndex);
+    RLMPropertyValueCache *cache = obj->_realm->_propertyValueCache.get();
+    if (cache && data.size() >= cache->minimum_size()) {
+        return cache->get(*obj->_realm->_realm, obj->_row.get_table(), obj->_row.get_index(), colIndex,
+                          [&] { return RLMBinaryDataToNSData(data); });
+    }
     return RLMBinaryDataToNSData(data);
 }
 static inline void RLMSetValue(__unsafe_unretained RLMObjectBase *const obj, NSUInteger colIndex, __unsafe_unretained NSData *const data) {
@@ -216,6 +227,9 @@ static inline RLMObjectBase *RLMGetLink(__unsafe_unretained RLMObjectBase *const
         return nil;
     }
     NSUInteger index = obj->_row.get_link(colIndex);
+    if (RLMObjectBase *prefetched = RLMPrefetchedLink(obj, colIndex, index)) {
+        return prefetched;
+    }
     return RLMCreateObjectAccessor(obj->_realm, obj->_realm.schema[objectClassName], index);
 }
 
@@ -522,7 +536,7 @@ template<typename ArgType, typename StorageType=ArgType>
 static IMP RLMMakeSetter(RLMProperty *prop) {
     NSUInteger colIndex = prop.column;
     NSString *name = prop.name;
-    if (prop.isPrimary) {
+    if (prop.isPrimary || prop.inCompoundPrimaryKey) {
         return imp_implementationWithBlock(^(__unused RLMObjectBase *obj, __unused ArgType val) {
             @throw RLMException(@"Primary key can't be changed after an object is inserted.");
         });
@@ -788,7 +802,7 @@ void RLMDynamicValidatedSet(RLMObjectBase *obj, NSString *propName, id val) {
     if (!prop) {
         @throw RLMException(@"Invalid property name `%@` for class `%@`.", propName, obj->_objectSchema.className);
     }
-    if (prop.isPrimary) {
+    if (prop.isPrimary || prop.inCompoundPrimaryKey) {
         @throw RLMException(@"Primary key can't be changed to '%@' after an object is inserted.", val);
     }
     if (!RLMIsObjectValidForProperty(val, prop)) {
@@ -884,6 +898,60 @@ void RLMDynamicSet(__unsafe_unretained RLMObjectBase *const obj, __unsafe_unreta
     }
 }
 
+NSUInteger RLMGetDataLength(__unsafe_unretained RLMObjectBase *const obj,
+                            __unsafe_unretained RLMProperty *const prop) {
+    RLMVerifyAttached(obj);
+    return obj->_row.get_binary(prop.column).size();
+}
+
+NSUInteger RLMGetDataBytes(__unsafe_unretained RLMObjectBase *const obj, __unsafe_unretained RLMProperty *const prop,
+                           void *buffer, NSRange range) {
+    RLMVerifyAttached(obj);
+    // The BinaryData points into the mapped file, so only the requested
+    // range is copied
+    realm::BinaryData data = obj->_row.get_binary(prop.column);
+    if (range.location > data.size()) {
+        @throw RLMException(@"Range %@ is out of bounds for data of length %zu", NSStringFromRange(range), data.size());
+    }
+    NSUInteger length = std::min<NSUInteger>(range.length, data.size() - range.location);
+    if (length) {
+        memcpy(buffer, data.data() + range.location, length);
+    }
+    return length;
+}
+
+void RLMReplaceDataBytes(__unsafe_unretained RLMObjectBase *const obj, __unsafe_unretained RLMProperty *const prop,
+                         NSRange range, const void *bytes, NSUInteger length) {
+    RLMVerifyInWriteTransaction(obj);
+
+    NSUInteger col = prop.column;
+    realm::BinaryData old = obj->_row.get_binary(col);
+    if (range.location > old.size() || range.length > old.size() - range.location) {
+        @throw RLMException(@"Range %@ is out of bounds for data of length %zu", NSStringFromRange(range), old.size());
+    }
+
+    // Core can only set whole values, so the new value is assembled here and
+    // every call is O(size of the value), including appends. Only the
+    // unchanged bytes are read from the file, without an NSData copy of the
+    // old value.
+    std::vector<char> value;
+    value.reserve(old.size() - range.length + length);
+    value.insert(value.end(), old.data(), old.data() + range.location);
+    value.insert(value.end(), static_cast<const char *>(bytes), static_cast<const char *>(bytes) + length);
+    value.insert(value.end(), old.data() + range.location + range.length, old.data() + old.size());
+
+    RLMWrapSetter(obj, prop.name, [&] {
+        try {
+            // As with NSData values, an empty value must not be stored as null
+            static const char empty = 0;
+            obj->_row.set_binary(col, realm::BinaryData(value.empty() ? &empty : value.data(), value.size()));
+        }
+        catch (std::exception const& e) {
+            @throw RLMException(e);
+        }
+    });
+}
+
 RLMProperty *RLMValidatedGetProperty(__unsafe_unretained RLMObjectBase *const obj, __unsafe_unretained NSString *const propName) {
     RLMProperty *prop = obj->_objectSchema[propName];
     if (!prop) {
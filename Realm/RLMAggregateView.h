@@ -0,0 +1,89 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+
+#import <Foundation/Foundation.h>
+#import <Realm/RLMDefines.h>
+
+RLM_ASSUME_NONNULL_BEGIN
+
+@class RLMNotificationToken;
+
+/**
+ An RLMAggregateView keeps the count, sum or average of the objects in an
+ `RLMResults` up to date as the Realm changes, so that reading it doesn't need
+ to read every object again.
+
+     RLMAggregateView *total = [[Person objectsWhere:@"age > 18"] sumViewOfProperty:@"age"];
+     NSLog(@"%@", total.value);
+     token = [total addNotificationBlock:^(NSNumber *value) {
+         label.text = value.stringValue;
+     }];
+
+ Each refresh of the Realm only re-examines the objects which were added,
+ deleted or modified since the last one. Changes made in write transactions on
+ the view's own Realm, changes to objects of other types, and objects being
+ inserted anywhere other than the end of the table instead cause the value to
+ be computed from scratch the next time it's needed.
+
+ Like the `RLMResults` it was created from, an aggregate view can only be used
+ on the thread its Realm was opened on.
+ */
+@interface RLMAggregateView : NSObject
+
+/**
+ The current value of the aggregate.
+
+ Counts and sums are never nil, while the average is nil if no object has a
+ non-nil value for the property.
+ */
+@property (nonatomic, readonly, nullable) NSNumber *value;
+
+/**
+ Register a block to be called each time the Realm is refreshed and the value
+ of the aggregate differs from its value when the block was last called.
+
+ Unlike `-[RLMResults addNotificationBlock:]`, the block is not called when it
+ is registered, and is not called for refreshes which don't change the value.
+
+ You must retain the returned token for as long as you want updates to
+ continue to be sent, and pass it to `removeNotification:` on the view's Realm
+ to stop receiving updates.
+
+ @param block The block to be called with the new value.
+ @return A token which must be held for as long as you want updates to be delivered.
+ */
+- (RLMNotificationToken *)addNotificationBlock:(void (^)(NSNumber *__nullable value))block;
+
+#pragma mark - Unavailable Methods
+
+/**
+ -[RLMAggregateView init] is not available because an RLMAggregateView must be
+ created from an RLMResults.
+ */
+- (instancetype)init __attribute__((unavailable("Use -[RLMResults sumViewOfProperty:] and friends")));
+
+/**
+ +[RLMAggregateView new] is not available because an RLMAggregateView must be
+ created from an RLMResults.
+ */
++ (instancetype)new __attribute__((unavailable("Use -[RLMResults sumViewOfProperty:] and friends")));
+
+@end
+
+RLM_ASSUME_NONNULL_END
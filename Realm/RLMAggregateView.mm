@@ -0,0 +1,99 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+
+#import "RLMAggregateView_Private.hpp"
+
+#import "RLMRealm_Private.hpp"
+#import "RLMUtil.hpp"
+
+#import "results.hpp"
+
+#import <realm/util/optional.hpp>
+
+static NSNumber *RLMAggregateValueToNumber(realm::util::Optional<realm::Mixed> const& value) {
+    if (!value) {
+        return nil;
+    }
+    switch (value->get_type()) {
+        case realm::type_Int:    return @(value->get_int());
+        case realm::type_Double: return @(value->get_double());
+        default: REALM_UNREACHABLE();
+    }
+}
+
+@implementation RLMAggregateView {
+    RLMRealm *_realm;
+    // Shared with the notification blocks' unregister blocks
+    std::shared_ptr<realm::AggregateView> _view;
+}
+
+- (instancetype)initWithRealm:(RLMRealm *)realm view:(realm::AggregateView)view {
+    self = [super init];
+    if (self) {
+        _realm = realm;
+        _view = std::make_shared<realm::AggregateView>(std::move(view));
+    }
+    return self;
+}
+
+- (NSNumber *)value {
+    [_realm verifyThread];
+    try {
+        return RLMAggregateValueToNumber(_view->get());
+    }
+    catch (realm::Results::InvalidatedException const&) {
+        @throw RLMException(@"RLMResults has been invalidated");
+    }
+    catch (std::exception const& ex) {
+        @throw RLMException(ex);
+    }
+}
+
+- (RLMNotificationToken *)addNotificationBlock:(void (^)(NSNumber *))block {
+    if (!block) {
+        @throw RLMException(@"The notification block should not be nil");
+    }
+    if (!RLMIsInRunLoop()) {
+        @throw RLMException(@"Can only add notification blocks from within runloops.");
+    }
+    [_realm verifyThread];
+
+    size_t token;
+    try {
+        token = _view->add_notification_callback([=](realm::util::Optional<realm::Mixed> value) {
+            block(RLMAggregateValueToNumber(value));
+        });
+    }
+    catch (realm::Results::InvalidatedException const&) {
+        @throw RLMException(@"RLMResults has been invalidated");
+    }
+    catch (std::exception const& ex) {
+        @throw RLMException(ex);
+    }
+
+    RLMNotificationToken *notificationToken = [[RLMNotificationToken alloc] init];
+    notificationToken.realm = _realm;
+    auto view = _view;
+    notificationToken.unregisterBlock = ^{
+        view->remove_notification_callback(token);
+    };
+    return notificationToken;
+}
+
+@end
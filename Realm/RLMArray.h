@@ -147,6 +147,22 @@ RLM_ASSUME_NONNULL_BEGIN
  */
 - (void)insertObject:(RLMObjectArgument)anObject atIndex:(NSUInteger)index;
 
+/**
+ Inserts objects at the given indexes, as a single change to the array.
+
+ Each object is inserted at the corresponding index in order, so the indexes
+ refer to positions in the array once all of the objects have been inserted.
+ Throws an exception when the number of objects doesn't match the number of
+ indexes or an index is out of bounds, in which case the array is unchanged.
+
+ @warning This method can only be called during a write transaction.
+
+ @param objects  An enumerable object such as NSArray or RLMResults which contains objects of the
+                 same class as this RLMArray.
+ @param indexes  The array indexes at which the objects are inserted.
+ */
+- (void)insertObjects:(id<NSFastEnumeration>)objects atIndexes:(NSIndexSet *)indexes;
+
 /**
  Removes an object at a given index.
 
@@ -158,6 +174,18 @@ RLM_ASSUME_NONNULL_BEGIN
  */
 - (void)removeObjectAtIndex:(NSUInteger)index;
 
+/**
+ Removes the objects at the given indexes, as a single change to the array.
+
+ Throws an exception when any of the indexes exceeds the bounds of this
+ RLMArray, in which case no objects are removed.
+
+ @warning This method can only be called during a write transaction.
+
+ @param indexes  The array indexes identifying the objects to be removed.
+ */
+- (void)removeObjectsAtIndexes:(NSIndexSet *)indexes;
+
 /**
  Removes the last object in an RLMArray.
 
@@ -280,6 +308,24 @@ RLM_ASSUME_NONNULL_BEGIN
  */
 - (RLMResults RLM_GENERIC_RETURN*)sortedResultsUsingDescriptors:(NSArray *)properties;
 
+#pragma mark - Enumerating Without Allocating
+
+/**
+ Calls the block for each object in the array with a single accessor object which
+ is reused for every object, rather than creating a new object for each one as
+ fast enumeration does. Standalone arrays call the block with the objects they
+ contain.
+
+ Because the accessor is changed to point at the next object after the block
+ returns, it must not be retained, stored, or otherwise used outside of the
+ block, and the array must not be modified during enumeration. Reading property
+ values inside the block is safe.
+
+ @param block   The block to call with the object, its index, and a pointer
+                which can be set to YES to stop the enumeration.
+ */
+- (void)enumerateObjectsUsingReusedAccessor:(void (^)(RLMObjectType object, NSUInteger index, BOOL *stop))block;
+
 /// :nodoc:
 - (RLMObjectType)objectAtIndexedSubscript:(NSUInteger)index;
 
@@ -314,6 +360,12 @@ RLM_ASSUME_NONNULL_BEGIN
  
 /**
  The name of the property which this sort descriptor orders results by.
+
+ This may be a key path through to-one links to a property of a linked object,
+ such as `sender.name`. Objects whose link along the path is `nil` sort as if
+ the property were `nil`. Results sorted on a property of a linked object
+ follow each object's links once per sort rather than in every comparison,
+ but can't be paged with `-resultsAfterObjectAtIndex:limit:`.
  */
 @property (nonatomic, readonly) NSString *property;
 
@@ -322,6 +374,16 @@ RLM_ASSUME_NONNULL_BEGIN
  */
 @property (nonatomic, readonly) BOOL ascending;
 
+/**
+ The locale used to compare the values of a string property, or nil to compare
+ them with the default ordering.
+
+ With a locale, strings are ordered ignoring case, diacritics and width as
+ defined by the locale, with strings which differ only in those respects
+ ordered by their Unicode values.
+ */
+@property (nonatomic, readonly, nullable) NSLocale *locale;
+
 #pragma mark - Methods
 
 /**
@@ -329,6 +391,19 @@ RLM_ASSUME_NONNULL_BEGIN
  */
 + (instancetype)sortDescriptorWithProperty:(NSString *)propertyName ascending:(BOOL)ascending;
 
+/**
+ Returns a new sort descriptor which orders a string property using the rules
+ of the given locale.
+
+ The key derived from each value for comparisons is cached per object and only
+ recomputed when the object's value changes, so re-sorting after the Realm
+ refreshes is much cheaper than the first sort.
+
+ @warning Only string properties can be sorted with a locale.
+ */
++ (instancetype)sortDescriptorWithProperty:(NSString *)propertyName ascending:(BOOL)ascending
+                                    locale:(nullable NSLocale *)locale;
+
 /**
  Returns a copy of the receiver with the sort order reversed.
  */
@@ -22,6 +22,7 @@
 #import "RLMObjectStore.h"
 #import "RLMObjectSchema.h"
 #import "RLMQueryUtil.hpp"
+#import "RLMSchema_Private.h"
 #import "RLMSwiftSupport.h"
 #import "RLMUtil.hpp"
 
@@ -40,6 +41,11 @@
 @public
     // array for standalone
     NSMutableArray *_backingArray;
+
+    // the most recent predicate given to indexOfObjectWithPredicate: and its
+    // compiled form, which is empty if it has to be evaluated by NSPredicate
+    NSPredicate *_lastPredicate;
+    RLMObjectPredicate _compiledPredicate;
 }
 
 template<typename IndexSetFactory>
@@ -103,9 +109,11 @@ static void changeArray(__unsafe_unretained RLMArray *const ar, NSKeyValueChange
 }
 
 - (void)addObjects:(id<NSFastEnumeration>)objects {
+    NSMutableArray *array = [NSMutableArray new];
     for (id obj in objects) {
-        [self addObject:obj];
+        [array addObject:obj];
     }
+    [self addObjectsFromArray:array];
 }
 
 - (void)addObject:(RLMObject *)object {
@@ -212,13 +220,20 @@ static void RLMValidateArrayBounds(__unsafe_unretained RLMArray *const ar,
 }
 
 - (void)insertObjects:(id<NSFastEnumeration>)objects atIndexes:(NSIndexSet *)indexes {
+    NSMutableArray *array = [NSMutableArray arrayWithCapacity:indexes.count];
+    for (RLMObject *obj in objects) {
+        RLMValidateMatchingObjectType(self, obj);
+        [array addObject:obj];
+    }
+    if (array.count != indexes.count) {
+        @throw RLMException(@"Number of objects (%zu) does not match the number of indexes (%zu)",
+                            (size_t)array.count, (size_t)indexes.count);
+    }
+    if (indexes.count && indexes.lastIndex >= _backingArray.count + indexes.count) {
+        @throw RLMException(@"Trying to insert object at invalid index");
+    }
     changeArray(self, NSKeyValueChangeInsertion, indexes, ^{
-        NSUInteger currentIndex = [indexes firstIndex];
-        for (RLMObject *obj in objects) {
-            RLMValidateMatchingObjectType(self, obj);
-            [_backingArray insertObject:obj atIndex:currentIndex];
-            currentIndex = [indexes indexGreaterThanIndex:currentIndex];
-        }
+        [_backingArray insertObjects:array atIndexes:indexes];
     });
 }
 
@@ -230,11 +245,48 @@ static void RLMValidateArrayBounds(__unsafe_unretained RLMArray *const ar,
 }
 
 - (void)removeObjectsAtIndexes:(NSIndexSet *)indexes {
+    if (indexes.count && indexes.lastIndex >= _backingArray.count) {
+        @throw RLMException(@"Trying to remove object at invalid index");
+    }
     changeArray(self, NSKeyValueChangeRemoval, indexes, ^{
         [_backingArray removeObjectsAtIndexes:indexes];
     });
 }
 
+- (void)replaceObjectsInRange:(NSRange)range withObjects:(id<NSFastEnumeration>)objects {
+    NSMutableArray *array = [NSMutableArray new];
+    for (RLMObject *obj in objects) {
+        RLMValidateMatchingObjectType(self, obj);
+        [array addObject:obj];
+    }
+    if (range.location > _backingArray.count || range.length > _backingArray.count - range.location) {
+        @throw RLMException(@"Trying to replace objects at invalid range");
+    }
+
+    // Report the replaced objects as a replacement, and the difference in
+    // count as an insertion or removal after them
+    NSUInteger replaced = std::min(range.length, array.count);
+    if (replaced) {
+        changeArray(self, NSKeyValueChangeReplacement, NSMakeRange(range.location, replaced), ^{
+            [_backingArray replaceObjectsInRange:NSMakeRange(range.location, replaced)
+                            withObjectsFromArray:array range:NSMakeRange(0, replaced)];
+        });
+    }
+    if (array.count > replaced) {
+        NSRange inserted = NSMakeRange(range.location + replaced, array.count - replaced);
+        changeArray(self, NSKeyValueChangeInsertion, inserted, ^{
+            [_backingArray insertObjects:[array subarrayWithRange:NSMakeRange(replaced, inserted.length)]
+                               atIndexes:[NSIndexSet indexSetWithIndexesInRange:inserted]];
+        });
+    }
+    else if (range.length > replaced) {
+        NSRange removed = NSMakeRange(range.location + replaced, range.length - replaced);
+        changeArray(self, NSKeyValueChangeRemoval, removed, ^{
+            [_backingArray removeObjectsInRange:removed];
+        });
+    }
+}
+
 - (void)replaceObjectAtIndex:(NSUInteger)index withObject:(id)anObject {
     RLMValidateMatchingObjectType(self, anObject);
     RLMValidateArrayBounds(self, index);
@@ -334,10 +386,38 @@ static void RLMValidateArrayBounds(__unsafe_unretained RLMArray *const ar,
     [_backingArray setValue:value forKey:key];
 }
 
+- (NSArray *)dictionariesWithValuesForKeys:(NSArray *)keys {
+    NSMutableArray *results = [NSMutableArray arrayWithCapacity:_backingArray.count];
+    for (RLMObjectBase *object in _backingArray) {
+        [results addObject:[object dictionaryWithValuesForKeys:keys]];
+    }
+    return results;
+}
+
 - (NSUInteger)indexOfObjectWithPredicate:(NSPredicate *)predicate {
     if (!_backingArray) {
         return NSNotFound;
     }
+
+    // standalone arrays are often built up and then searched repeatedly, so
+    // the predicate is only validated and compiled when it changes
+    if (!_lastPredicate || ![_lastPredicate isEqual:predicate]) {
+        RLMObjectSchema *objectSchema = [RLMSchema.sharedSchema schemaForClassName:_objectClassName];
+        _compiledPredicate = objectSchema ? RLMCompileObjectPredicate(predicate, RLMSchema.sharedSchema, objectSchema)
+                                          : RLMObjectPredicate();
+        _lastPredicate = predicate;
+    }
+
+    if (auto const& compiled = _compiledPredicate) {
+        NSUInteger index = 0;
+        for (RLMObjectBase *obj in _backingArray) {
+            if (compiled(obj)) {
+                return index;
+            }
+            ++index;
+        }
+        return NSNotFound;
+    }
     return [_backingArray indexOfObjectPassingTest:^BOOL(id obj, NSUInteger, BOOL *) {
         return [predicate evaluateWithObject:obj];
     }];
@@ -377,6 +457,14 @@ static void RLMValidateArrayBounds(__unsafe_unretained RLMArray *const ar,
     @throw RLMException(@"This method can only be called on RLMArray instances retrieved from an RLMRealm");
 }
 
+- (void)enumerateObjectsUsingReusedAccessor:(void (^)(id, NSUInteger, BOOL *))block {
+    if (!block) {
+        @throw RLMException(@"The enumeration block should not be nil");
+    }
+    // Standalone arrays already hold their objects, so there's nothing to reuse
+    [[_backingArray copy] enumerateObjectsUsingBlock:block];
+}
+
 #pragma GCC diagnostic pop
 
 - (NSUInteger)indexOfObjectWhere:(NSString *)predicateFormat, ...
@@ -442,18 +530,36 @@ static void RLMValidateArrayBounds(__unsafe_unretained RLMArray *const ar,
 @interface RLMSortDescriptor ()
 @property (nonatomic, strong) NSString *property;
 @property (nonatomic, assign) BOOL ascending;
+@property (nonatomic, strong) NSLocale *locale;
 @end
 
 @implementation RLMSortDescriptor
 + (instancetype)sortDescriptorWithProperty:(NSString *)propertyName ascending:(BOOL)ascending {
+    return [self sortDescriptorWithProperty:propertyName ascending:ascending locale:nil];
+}
+
++ (instancetype)sortDescriptorWithProperty:(NSString *)propertyName ascending:(BOOL)ascending locale:(NSLocale *)locale {
     RLMSortDescriptor *desc = [[RLMSortDescriptor alloc] init];
     desc->_property = propertyName;
     desc->_ascending = ascending;
+    desc->_locale = locale;
     return desc;
 }
 
 - (instancetype)reversedSortDescriptor {
-    return [self.class sortDescriptorWithProperty:_property ascending:!_ascending];
+    return [self.class sortDescriptorWithProperty:_property ascending:!_ascending locale:_locale];
+}
+
+- (BOOL)isEqual:(id)object {
+    if (RLMSortDescriptor *other = RLMDynamicCast<RLMSortDescriptor>(object)) {
+        return _ascending == other->_ascending && [_property isEqualToString:other->_property]
+            && (_locale == other->_locale || [_locale.localeIdentifier isEqualToString:other->_locale.localeIdentifier]);
+    }
+    return NO;
+}
+
+- (NSUInteger)hash {
+    return _property.hash ^ _ascending;
 }
 
 @end
@@ -26,12 +26,35 @@
 #import "RLMQueryUtil.hpp"
 #import "RLMRealm_Private.hpp"
 #import "RLMSchema.h"
+#import "RLMThreadSafeReference_Private.hpp"
 #import "RLMUtil.hpp"
 
 #import "results.hpp"
+#import "thread_safe_reference.hpp"
 
 #import <realm/table_view.hpp>
 #import <objc/runtime.h>
+#import <unordered_map>
+#import <vector>
+
+namespace {
+// The position of the first link to each target row in a LinkView, for
+// answering indexOfObject: without scanning the LinkView. It's only valid for
+// the read transaction it was built in, and isn't used in write transactions
+// since the LinkView can then be modified through any accessor.
+struct RLMLinkViewIndex {
+    uint_fast64_t version = 0;
+    size_t write_count = 0;
+    // Lookups done at this version, as the index is only worth building once
+    // the same array is searched repeatedly
+    size_t lookups = 0;
+    bool built = false;
+    std::unordered_map<size_t, size_t> positions;
+};
+
+// Smaller LinkViews are always scanned linearly
+const size_t RLMLinkViewIndexMinimumSize = 64;
+}
 
 //
 // RLMArray implementation
@@ -42,6 +65,7 @@
     RLMRealm *_realm;
     __unsafe_unretained RLMObjectSchema *_containingObjectSchema;
     std::unique_ptr<RLMObservationInfo> _observationInfo;
+    RLMLinkViewIndex _index;
 }
 
 + (RLMArrayLinkView *)arrayWithObjectClassName:(NSString *)objectClassName
@@ -95,6 +119,7 @@ static inline void RLMLinkViewArrayValidateInWriteTransaction(__unsafe_unretaine
     if (!ar->_realm.inWriteTransaction) {
         @throw RLMException(@"Can't mutate a persisted array outside of a write transaction.");
     }
+    [ar->_realm detachAllEnumerators];
 }
 static inline void RLMValidateObjectClass(__unsafe_unretained RLMObjectBase *const obj, __unsafe_unretained NSString *const expected) {
     if (!obj) {
@@ -230,24 +255,59 @@ static void RLMInsertObject(RLMArrayLinkView *ar, RLMObject *object, NSUInteger
     RLMInsertObject(self, object, index);
 }
 
+// Validate all of the objects to be inserted into the array before anything
+// is modified, then add the ones not yet in this Realm to it in a single
+// batch and get the target row index for each object. If `expectedCount` is
+// not NSNotFound, there must be exactly that many objects.
+static std::vector<size_t> RLMTargetRowsForObjects(__unsafe_unretained RLMArrayLinkView *const ar,
+                                                   __unsafe_unretained id<NSFastEnumeration> const objects,
+                                                   NSUInteger expectedCount=NSNotFound) {
+    std::vector<RLMObject *> validated;
+    NSMutableArray *toAdd;
+    for (RLMObject *obj in objects) {
+        RLMValidateObjectClass(obj, ar.objectClassName);
+        if (obj->_realm != ar.realm) {
+            if (!toAdd) {
+                toAdd = [NSMutableArray new];
+            }
+            [toAdd addObject:obj];
+        }
+        else if (!obj->_row.is_attached()) {
+            @throw RLMException(@"Object has been deleted or invalidated.");
+        }
+        validated.push_back(obj);
+    }
+    if (expectedCount != NSNotFound && validated.size() != expectedCount) {
+        @throw RLMException(@"Number of objects (%zu) does not match the number of indexes (%zu)",
+                            validated.size(), (size_t)expectedCount);
+    }
+    if (toAdd) {
+        RLMAddObjectsToRealm(toAdd, ar.realm, false);
+    }
+
+    std::vector<size_t> rows;
+    rows.reserve(validated.size());
+    for (RLMObject *obj : validated) {
+        rows.push_back(obj->_row.get_index());
+    }
+    return rows;
+}
+
 - (void)insertObjects:(id<NSFastEnumeration>)objects atIndexes:(NSIndexSet *)indexes {
     RLMLinkViewArrayValidateInWriteTransaction(self);
 
-    changeArray(self, NSKeyValueChangeInsertion, indexes, ^{
-        NSUInteger index = [indexes firstIndex];
-        for (RLMObject *obj in objects) {
-            if (index > _backingLinkView->size()) {
-                @throw RLMException(@"Trying to insert object at invalid index");
-            }
-            if (obj->_realm != _realm) {
-                [_realm addObject:obj];
-            }
-            else if (!obj->_row.is_attached()) {
-                @throw RLMException(@"Object has been deleted or invalidated.");
-            }
+    std::vector<NSUInteger> positions(indexes.count);
+    [indexes getIndexes:positions.data() maxCount:positions.size() inIndexRange:nil];
+    // Each object is inserted after the previous ones, so an index past the
+    // end is only valid if the indexes before it fill the gap
+    if (!positions.empty() && positions.back() >= _backingLinkView->size() + positions.size()) {
+        @throw RLMException(@"Trying to insert object at invalid index");
+    }
+    std::vector<size_t> rows = RLMTargetRowsForObjects(self, objects, positions.size());
 
-            _backingLinkView->insert(index, obj->_row.get_index());
-            index = [indexes indexGreaterThanIndex:index];
+    changeArray(self, NSKeyValueChangeInsertion, indexes, ^{
+        for (size_t i = 0; i < rows.size(); ++i) {
+            _backingLinkView->insert(positions[i], rows[i]);
         }
     });
 }
@@ -264,31 +324,45 @@ static void RLMInsertObject(RLMArrayLinkView *ar, RLMObject *object, NSUInteger
 - (void)removeObjectsAtIndexes:(NSIndexSet *)indexes {
     RLMLinkViewArrayValidateInWriteTransaction(self);
 
+    std::vector<NSUInteger> positions(indexes.count);
+    [indexes getIndexes:positions.data() maxCount:positions.size() inIndexRange:nil];
+    size_t size = _backingLinkView->size();
+    if (!positions.empty() && positions.back() >= size) {
+        @throw RLMException(@"Trying to remove object at invalid index");
+    }
+
     changeArray(self, NSKeyValueChangeRemoval, indexes, ^{
-        for (NSUInteger index = [indexes lastIndex]; index != NSNotFound; index = [indexes indexLessThanIndex:index]) {
-            if (index >= _backingLinkView->size()) {
-                @throw RLMException(@"Trying to remove object at invalid index");
-            }
-            _backingLinkView->remove(index);
+        if (positions.size() == size) {
+            _backingLinkView->clear();
+            return;
+        }
+        // Remove from the end so that the remaining positions stay valid
+        for (auto it = positions.rbegin(); it != positions.rend(); ++it) {
+            _backingLinkView->remove(*it);
         }
     });
 }
 
-- (void)addObjectsFromArray:(NSArray *)array {
-    RLMLinkViewArrayValidateInWriteTransaction(self);
-
-    changeArray(self, NSKeyValueChangeInsertion, NSMakeRange(_backingLinkView->size(), array.count), ^{
-        for (RLMObject *obj in array) {
-            RLMValidateObjectClass(obj, _objectClassName);
-            if (obj->_realm != _realm) {
-                [_realm addObject:obj];
-            }
+static void RLMAppendObjects(__unsafe_unretained RLMArrayLinkView *const ar,
+                             __unsafe_unretained id<NSFastEnumeration> const objects) {
+    RLMLinkViewArrayValidateInWriteTransaction(ar);
 
-            _backingLinkView->add(obj->_row.get_index());
+    std::vector<size_t> rows = RLMTargetRowsForObjects(ar, objects);
+    changeArray(ar, NSKeyValueChangeInsertion, NSMakeRange(ar->_backingLinkView->size(), rows.size()), ^{
+        for (size_t row : rows) {
+            ar->_backingLinkView->add(row);
         }
     });
 }
 
+- (void)addObjects:(id<NSFastEnumeration>)objects {
+    RLMAppendObjects(self, objects);
+}
+
+- (void)addObjectsFromArray:(NSArray *)array {
+    RLMAppendObjects(self, array);
+}
+
 - (void)removeAllObjects {
     RLMLinkViewArrayValidateInWriteTransaction(self);
 
@@ -311,6 +385,42 @@ static void RLMInsertObject(RLMArrayLinkView *ar, RLMObject *object, NSUInteger
     });
 }
 
+- (void)replaceObjectsInRange:(NSRange)range withObjects:(id<NSFastEnumeration>)objects {
+    RLMLinkViewArrayValidateInWriteTransaction(self);
+
+    size_t size = _backingLinkView->size();
+    if (range.location > size || range.length > size - range.location) {
+        @throw RLMException(@"Trying to replace objects at invalid range");
+    }
+    std::vector<size_t> rows = RLMTargetRowsForObjects(self, objects);
+
+    // Report the replaced objects as a replacement, and the difference in
+    // count as an insertion or removal after them
+    size_t replaced = std::min<size_t>(range.length, rows.size());
+    if (replaced) {
+        changeArray(self, NSKeyValueChangeReplacement, NSMakeRange(range.location, replaced), ^{
+            for (size_t i = 0; i < replaced; ++i) {
+                _backingLinkView->set(range.location + i, rows[i]);
+            }
+        });
+    }
+    if (rows.size() > replaced) {
+        changeArray(self, NSKeyValueChangeInsertion, NSMakeRange(range.location + replaced, rows.size() - replaced), ^{
+            for (size_t i = replaced; i < rows.size(); ++i) {
+                _backingLinkView->insert(range.location + i, rows[i]);
+            }
+        });
+    }
+    else if (range.length > replaced) {
+        changeArray(self, NSKeyValueChangeRemoval, NSMakeRange(range.location + replaced, range.length - replaced), ^{
+            // Remove from the end so that the remaining positions stay valid
+            for (size_t i = range.location + range.length; i > range.location + replaced; --i) {
+                _backingLinkView->remove(i - 1);
+            }
+        });
+    }
+}
+
 - (void)moveObjectAtIndex:(NSUInteger)sourceIndex toIndex:(NSUInteger)destinationIndex {
     RLMLinkViewArrayValidateInWriteTransaction(self);
     RLMValidateArrayBounds(self, sourceIndex);
@@ -356,17 +466,38 @@ static void RLMInsertObject(RLMArrayLinkView *ar, RLMObject *object, NSUInteger
         return NSNotFound;
     }
 
-    // call find on backing array
     size_t object_ndx = object->_row.get_index();
-    return RLMConvertNotFound(_backingLinkView->find(object_ndx));
+    auto& realm = *_realm->_realm;
+    if (realm.is_in_transaction() || _backingLinkView->size() < RLMLinkViewIndexMinimumSize) {
+        return RLMConvertNotFound(_backingLinkView->find(object_ndx));
+    }
+
+    if (_index.version != realm.current_transaction_version() || _index.write_count != realm.write_transaction_count()) {
+        _index = {};
+        _index.version = realm.current_transaction_version();
+        _index.write_count = realm.write_transaction_count();
+    }
+    if (!_index.built) {
+        if (++_index.lookups < 2) {
+            return RLMConvertNotFound(_backingLinkView->find(object_ndx));
+        }
+        size_t size = _backingLinkView->size();
+        _index.positions.reserve(size);
+        for (size_t i = 0; i < size; ++i) {
+            _index.positions.emplace(_backingLinkView->get(i).get_index(), i);
+        }
+        _index.built = true;
+    }
+
+    auto it = _index.positions.find(object_ndx);
+    return it == _index.positions.end() ? NSNotFound : it->second;
 }
 
 - (id)valueForKeyPath:(NSString *)keyPath {
     if ([keyPath hasPrefix:@"@"]) {
         // Delegate KVC collection operators to RLMResults
-        realm::Query query = _backingLinkView->get_target_table().where(_backingLinkView);
         RLMResults *results = [RLMResults resultsWithObjectSchema:_realm.schema[self.objectClassName]
-                                                          results:realm::Results(_realm->_realm, std::move(query))];
+                                                          results:realm::Results(_realm->_realm, _backingLinkView)];
         return [results valueForKeyPath:keyPath];
     }
     return [super valueForKeyPath:keyPath];
@@ -387,6 +518,11 @@ static void RLMInsertObject(RLMArrayLinkView *ar, RLMObject *object, NSUInteger
     return RLMCollectionValueForKey(self, key);
 }
 
+- (NSArray *)dictionariesWithValuesForKeys:(NSArray *)keys {
+    RLMLinkViewArrayValidateAttached(self);
+    return RLMCollectionDictionariesWithValuesForKeys(self, keys);
+}
+
 - (void)setValue:(id)value forKey:(NSString *)key {
     RLMLinkViewArrayValidateInWriteTransaction(self);
     RLMCollectionSetValueForKey(self, key, value);
@@ -401,23 +537,38 @@ static void RLMInsertObject(RLMArrayLinkView *ar, RLMObject *object, NSUInteger
     });
 }
 
+// The key for a view of this array cached on the Realm. LinkViews are
+// interned and kept alive by the cached Results, so the LinkView's address
+// identifies the list.
+static NSArray *RLMCachedResultsKey(__unsafe_unretained RLMArrayLinkView *const ar, id parameters, SEL selector) {
+    return @[[NSValue valueWithPointer:ar->_backingLinkView.get()], NSStringFromSelector(selector), parameters ?: NSNull.null];
+}
+
 - (RLMResults *)sortedResultsUsingDescriptors:(NSArray *)properties {
     RLMLinkViewArrayValidateAttached(self);
 
-    auto results = realm::Results(_realm->_realm,
-                                  _backingLinkView->get_target_table().where(_backingLinkView),
-                                  RLMSortOrderFromDescriptors(_realm.schema[_objectClassName], properties));
-    return [RLMResults resultsWithObjectSchema:_realm.schema[self.objectClassName]
-                                       results:std::move(results)];
+    properties = [properties copy];
+    return [_realm cachedResultsForKey:RLMCachedResultsKey(self, properties, _cmd) create:^{
+        auto results = realm::Results(_realm->_realm, _backingLinkView,
+                                      RLMSortOrderFromDescriptors(_realm.schema[_objectClassName], properties));
+        return [RLMResults resultsWithObjectSchema:_realm.schema[self.objectClassName]
+                                           results:std::move(results)];
+    }];
 }
 
 - (RLMResults *)objectsWithPredicate:(NSPredicate *)predicate {
     RLMLinkViewArrayValidateAttached(self);
 
-    realm::Query query = _backingLinkView->get_target_table().where(_backingLinkView);
-    RLMUpdateQueryWithPredicate(&query, predicate, _realm.schema, _realm.schema[self.objectClassName]);
-    return [RLMResults resultsWithObjectSchema:_realm.schema[self.objectClassName]
-                                       results:realm::Results(_realm->_realm, std::move(query))];
+    predicate = [predicate copy];
+    return [_realm cachedResultsForKey:RLMCachedResultsKey(self, predicate, _cmd) create:^{
+        RLMObjectSchema *objectSchema = _realm.schema[self.objectClassName];
+        realm::Query query = _backingLinkView->get_target_table().where();
+        RLMUpdateQueryWithPredicate(&query, predicate, _realm.schema, objectSchema);
+        auto results = realm::Results(_realm->_realm, _backingLinkView).filter(std::move(query));
+        results.set_query_description(RLMPredicateDescriptionFunction(predicate, objectSchema));
+        results.set_query_conditions(RLMPredicateConditionsFunction(predicate, objectSchema));
+        return [RLMResults resultsWithObjectSchema:objectSchema results:std::move(results)];
+    }];
 }
 
 - (NSUInteger)indexOfObjectWithPredicate:(NSPredicate *)predicate {
@@ -446,8 +597,38 @@ static void RLMInsertObject(RLMArrayLinkView *ar, RLMObject *object, NSUInteger
     return _backingLinkView->get(index).get_index();
 }
 
+- (void)enumerateObjectsUsingReusedAccessor:(void (^)(id, NSUInteger, BOOL *))block {
+    RLMLinkViewArrayValidateAttached(self);
+    RLMEnumerateWithReusedAccessor(self, block);
+}
+
+- (NSUInteger)copySourceIndexes:(size_t *)indexes from:(NSUInteger)index count:(NSUInteger)count {
+    size_t size = _backingLinkView->size();
+    count = index < size ? std::min<size_t>(count, size - index) : 0;
+    for (size_t i = 0; i < count; ++i) {
+        indexes[i] = _backingLinkView->get(index + i).get_index();
+    }
+    return count;
+}
+
 - (realm::TableView)tableView {
     return _backingLinkView->get_target_table().where(_backingLinkView).find_all();
 }
 
+- (RLMThreadSafeReference *)threadSafeReference {
+    RLMLinkViewArrayValidateAttached(self);
+    try {
+        auto& table = _backingLinkView->get_origin_table();
+        size_t column = _containingObjectSchema[_key].column;
+        realm::ThreadSafeReference reference(_realm->_realm, table[_backingLinkView->get_origin_row_index()], column);
+        return [[RLMThreadSafeReference alloc] initWithReference:std::move(reference)
+                                                 objectClassName:_objectClassName
+                                                 parentClassName:_containingObjectSchema.className
+                                                             key:_key];
+    }
+    catch (std::exception const& ex) {
+        @throw RLMException(ex);
+    }
+}
+
 @end
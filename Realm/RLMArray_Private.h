@@ -18,7 +18,30 @@
 
 #import <Realm/RLMArray.h>
 
+@class RLMObjectBase;
+
+RLM_ASSUME_NONNULL_BEGIN
+
 @interface RLMArray ()
 - (instancetype)initWithObjectClassName:(NSString *)objectClassName;
 - (NSString *)descriptionWithMaxDepth:(NSUInteger)depth;
+
+// Replace the objects in the range with the given objects, which may be a
+// different number of them, validating all of them before changing anything
+- (void)replaceObjectsInRange:(NSRange)range withObjects:(id<NSFastEnumeration>)objects;
 @end
+
+// Enumerates an RLMArray or RLMResults which is backed by a Realm, creating
+// accessors directly from batches of row indexes
+@interface RLMFastEnumerator : NSObject
+// Get the next object, or nil once all of them have been returned. If an
+// accessor is given, it is pointed at the next object's row and returned
+// rather than creating a new one.
+- (nullable RLMObjectBase *)nextObjectReusingAccessor:(nullable RLMObjectBase *)accessor;
+@end
+
+// Get an enumerator for stepping through the collection one object at a
+// time, or nil if it is a standalone RLMArray
+FOUNDATION_EXTERN RLMFastEnumerator *_Nullable RLMEnumeratorForCollection(id<RLMCollection> collection);
+
+RLM_ASSUME_NONNULL_END
@@ -36,14 +36,26 @@ namespace realm {
 
 @class RLMObjectBase;
 @class RLMObjectSchema;
+@class RLMThreadSafeReference;
 class RLMObservationInfo;
 
+// A chain of to-one link properties to follow from each enumerated object so
+// that the linked objects' accessors are created ahead of time
+struct RLMPrefetchHop {
+    size_t column;
+    __unsafe_unretained RLMObjectSchema *targetSchema;
+};
+using RLMPrefetchPath = std::vector<RLMPrefetchHop>;
+
 @protocol RLMFastEnumerable
 @property (nonatomic, readonly) RLMRealm *realm;
 @property (nonatomic, readonly) RLMObjectSchema *objectSchema;
 @property (nonatomic, readonly) NSUInteger count;
 
 - (NSUInteger)indexInSource:(NSUInteger)index;
+// Copy the source row indexes of up to `count` objects starting at `index`
+// into `indexes`, returning the number copied. Deleted rows are realm::npos.
+- (NSUInteger)copySourceIndexes:(size_t *)indexes from:(NSUInteger)index count:(NSUInteger)count;
 - (realm::TableView)tableView;
 @end
 
@@ -72,6 +84,8 @@ class RLMObservationInfo;
 
 // deletes all objects in the RLMArray from their containing realms
 - (void)deleteObjectsFromRealm;
+
+- (RLMThreadSafeReference *)threadSafeReference;
 @end
 
 void RLMValidateArrayObservationKey(NSString *keyPath, RLMArray *array);
@@ -88,12 +102,27 @@ void RLMEnsureArrayObservationInfo(std::unique_ptr<RLMObservationInfo>& info, NS
                                    results:(realm::Results)results;
 
 - (void)deleteObjectsFromRealm;
+// deletes the objects, committing the write transaction and beginning a new
+// one after every batchSize objects
+- (void)deleteObjectsFromRealmInBatchesOfSize:(NSUInteger)batchSize;
+
+- (RLMThreadSafeReference *)threadSafeReference;
+
+// The link chains set by resultsPrefetchingKeyPaths:, which enumerators of
+// the results follow for each batch of objects
+- (std::vector<RLMPrefetchPath> const&)prefetchPaths;
 @end
 
 // An object which encapulates the shared logic for fast-enumerating RLMArray
 // and RLMResults, and has a buffer to store strong references to the current
 // set of enumerated items
-@interface RLMFastEnumerator : NSObject
+@interface RLMFastEnumerator () {
+    @public
+    // Links in the Realm's list of enumerators which need to be detached
+    // before it is modified, which are maintained by the Realm
+    __unsafe_unretained RLMFastEnumerator *_previousEnumerator;
+    __unsafe_unretained RLMFastEnumerator *_nextEnumerator;
+}
 - (instancetype)initWithCollection:(id<RLMFastEnumerable>)collection objectSchema:(RLMObjectSchema *)objectSchema;
 
 // Detach this enumerator from the source collection. Must be called before the
@@ -103,3 +132,8 @@ void RLMEnsureArrayObservationInfo(std::unique_ptr<RLMObservationInfo>& info, NS
 - (NSUInteger)countByEnumeratingWithState:(NSFastEnumerationState *)state
                                     count:(NSUInteger)len;
 @end
+
+// Call the block for each object in the collection with a single accessor
+// which is re-pointed at each row in turn
+void RLMEnumerateWithReusedAccessor(id<RLMFastEnumerable> collection,
+                                    void (^block)(id object, NSUInteger index, BOOL *stop));
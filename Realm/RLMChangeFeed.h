@@ -0,0 +1,146 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#import <Foundation/Foundation.h>
+#import <Realm/RLMDefines.h>
+
+RLM_ASSUME_NONNULL_BEGIN
+
+@class RLMRealm;
+
+/**
+ The kind of change an `RLMChangeRecord` describes.
+ */
+typedef NS_ENUM(NSInteger, RLMChangeRecordType) {
+    /** `otherIndex` new objects were inserted at `index`. */
+    RLMChangeRecordTypeInsert,
+    /** `otherIndex` objects were deleted starting at `index`. */
+    RLMChangeRecordTypeDelete,
+    /** The object at `index` was deleted and the one at `otherIndex` moved into its place. */
+    RLMChangeRecordTypeMoveLastOver,
+    /** The objects at `index` and `otherIndex` swapped places. */
+    RLMChangeRecordTypeSwap,
+    /** Every object of the class was deleted. */
+    RLMChangeRecordTypeDeleteAll,
+    /** The property of the object at `index` was set to `value`. */
+    RLMChangeRecordTypeSet,
+    /** The link at `arrayIndex` in the array property was replaced with `value`. */
+    RLMChangeRecordTypeArraySet,
+    /** `value` was inserted into the array property at `arrayIndex`. */
+    RLMChangeRecordTypeArrayInsert,
+    /** The link at `arrayIndex` was removed from the array property. */
+    RLMChangeRecordTypeArrayDelete,
+    /** The link at `arrayIndex` in the array property was moved to `otherIndex`. */
+    RLMChangeRecordTypeArrayMove,
+    /** The links at `arrayIndex` and `otherIndex` in the array property swapped places. */
+    RLMChangeRecordTypeArraySwap,
+    /** Every link was removed from the array property. */
+    RLMChangeRecordTypeArrayDeleteAll,
+};
+
+/**
+ A single change to the objects in a Realm, as returned by `RLMChangeFeed`.
+
+ Objects are identified by their index among the objects of their class at
+ the point the change was made, so applying the records from a change feed in
+ order to a copy of the objects at the feed's starting version reproduces the
+ later versions.
+ */
+@interface RLMChangeRecord : NSObject
+
+/** The kind of change. */
+@property (nonatomic, readonly) RLMChangeRecordType type;
+
+/** The class of the changed object. */
+@property (nonatomic, readonly) NSString *className;
+
+/** The index of the changed object. */
+@property (nonatomic, readonly) NSUInteger index;
+
+/** The changed property, for sets and changes to array properties. */
+@property (nonatomic, readonly, nullable) NSString *propertyName;
+
+/** The position within the array for changes to array properties, or `NSNotFound`. */
+@property (nonatomic, readonly) NSUInteger arrayIndex;
+
+/**
+ The second index or count for inserts, deletes, moves and swaps, as
+ described by each `RLMChangeRecordType`, or `NSNotFound`.
+ */
+@property (nonatomic, readonly) NSUInteger otherIndex;
+
+/**
+ The new value for sets, as an `NSNumber`, `NSString`, `NSData` or `NSDate`,
+ or `nil` if the property was set to nil. For links and array changes this is
+ the index of the linked object, as an `NSNumber`.
+ */
+@property (nonatomic, readonly, nullable) id value;
+
+@end
+
+/**
+ An RLMChangeFeed reads the changes made to a Realm file from the log of each
+ write transaction kept in the file, so that they can be sent elsewhere without
+ comparing versions of the data.
+
+ Each call to `-nextChanges` returns every change made since the previous call,
+ or since the feed was created. Change feeds can be used from any thread, but
+ not from more than one thread at a time.
+
+ The feed keeps the version it last returned changes up to alive, so the file
+ can't reuse the space freed by later write transactions until the feed is
+ advanced again or deallocated.
+ */
+@interface RLMChangeFeed : NSObject
+
+/**
+ Create a change feed starting at the version the Realm is currently reading.
+
+ This must be called on the Realm's thread, outside of a write transaction,
+ and can't be used with read-only Realms.
+ */
++ (instancetype)changeFeedForRealm:(RLMRealm *)realm;
+
+/**
+ The version the next changes returned will start from.
+ */
+@property (nonatomic, readonly) uint64_t version;
+
+/**
+ Return the changes made by every write transaction since the previous call,
+ or an empty array if there have been none.
+ */
+- (NSArray RLM_GENERIC(RLMChangeRecord *) *)nextChanges;
+
+#pragma mark - Unavailable Methods
+
+/**
+ -[RLMChangeFeed init] is not available because an RLMChangeFeed must be
+ created with +[RLMChangeFeed changeFeedForRealm:].
+ */
+- (instancetype)init __attribute__((unavailable("Use +changeFeedForRealm:")));
+
+/**
+ +[RLMChangeFeed new] is not available because an RLMChangeFeed must be
+ created with +[RLMChangeFeed changeFeedForRealm:].
+ */
++ (instancetype)new __attribute__((unavailable("Use +changeFeedForRealm:")));
+
+@end
+
+RLM_ASSUME_NONNULL_END
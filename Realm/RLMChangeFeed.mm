@@ -0,0 +1,111 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#import "RLMChangeFeed.h"
+
+#import "RLMRealm_Private.hpp"
+#import "RLMUtil.hpp"
+
+#import "change_feed.hpp"
+
+#import <realm/util/optional.hpp>
+
+static id RLMChangeValueToObjC(realm::ChangeValue const& value) {
+    using Type = realm::ChangeValue::Type;
+    switch (value.type) {
+        case Type::Null:   return nil;
+        case Type::Int:    return @(value.int_value);
+        case Type::Bool:   return @(value.bool_value);
+        case Type::Float:  return @(value.float_value);
+        case Type::Double: return @(value.double_value);
+        case Type::String: return RLMStringDataToNSString({value.data.data(), value.data.size()});
+        case Type::Binary: return RLMBinaryDataToNSData({value.data.data(), value.data.size()});
+        case Type::Date:   return [NSDate dateWithTimeIntervalSince1970:value.int_value];
+        case Type::Link:   return @(value.int_value);
+    }
+    REALM_UNREACHABLE();
+}
+
+static NSUInteger RLMIndexOrNotFound(size_t index) {
+    return index == realm::npos ? NSNotFound : index;
+}
+
+@implementation RLMChangeRecord
+
+- (instancetype)initWithRecord:(realm::ChangeRecord const&)record changes:(realm::ChangeSet const&)changes {
+    self = [super init];
+    if (self) {
+        // RLMChangeRecordType is declared in the same order as ChangeRecord::Kind
+        _type = static_cast<RLMChangeRecordType>(record.kind);
+        _className = RLMStringDataToNSString(changes.object_type(record));
+        _index = record.row;
+        if (record.column != realm::npos) {
+            _propertyName = RLMStringDataToNSString(changes.property(record));
+        }
+        _arrayIndex = RLMIndexOrNotFound(record.index);
+        _otherIndex = RLMIndexOrNotFound(record.other);
+        _value = RLMChangeValueToObjC(record.value);
+    }
+    return self;
+}
+
+@end
+
+@implementation RLMChangeFeed {
+    realm::util::Optional<realm::ChangeFeed> _feed;
+}
+
++ (instancetype)changeFeedForRealm:(RLMRealm *)realm {
+    return [[self alloc] initWithRealm:realm];
+}
+
+- (instancetype)initWithRealm:(RLMRealm *)realm {
+    [realm verifyThread];
+    self = [super init];
+    if (self) {
+        try {
+            _feed.emplace(*realm->_realm);
+        }
+        catch (std::exception const& ex) {
+            @throw RLMException(ex);
+        }
+    }
+    return self;
+}
+
+- (uint64_t)version {
+    return _feed->version();
+}
+
+- (NSArray *)nextChanges {
+    realm::ChangeSet changes;
+    try {
+        changes = _feed->next();
+    }
+    catch (std::exception const& ex) {
+        @throw RLMException(ex);
+    }
+
+    NSMutableArray *records = [NSMutableArray arrayWithCapacity:changes.records.size()];
+    for (auto const& record : changes.records) {
+        [records addObject:[[RLMChangeRecord alloc] initWithRecord:record changes:changes]];
+    }
+    return records;
+}
+
+@end
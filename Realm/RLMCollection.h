@@ -169,6 +169,19 @@ RLM_ASSUME_NONNULL_BEGIN
  */
 - (void)setValue:(nullable id)value forKey:(NSString *)key;
 
+/**
+ Returns an NSArray containing the results of invoking `dictionaryWithValuesForKeys:` using keys on
+ each of the collection's objects.
+
+ Property values are read directly for each object rather than through its accessor, so this is
+ much faster than calling `dictionaryWithValuesForKeys:` on each object.
+
+ @param keys The names of the properties.
+
+ @return NSArray containing an NSDictionary of the values of the given properties for each object.
+ */
+- (NSArray RLM_GENERIC(NSDictionary *) *)dictionariesWithValuesForKeys:(NSArray RLM_GENERIC(NSString *) *)keys;
+
 @end
 
 RLM_ASSUME_NONNULL_END
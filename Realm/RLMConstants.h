@@ -81,6 +81,8 @@ typedef NS_ENUM(NSInteger, RLMError) {
         process which cannot share with the current process due to an
         architecture mismatch. */
     RLMErrorIncompatibleLockFile  = 8,
+    /** Returned by RLMSnapshot if writing a copy was cancelled by its progress block. */
+    RLMErrorCancelled             = 9,
 };
 
 #pragma mark - Constants
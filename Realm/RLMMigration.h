@@ -34,6 +34,15 @@ accessed using keyed subscripting.
 */
 typedef void (^RLMObjectMigrationBlock)(RLMObject * __nullable oldObject, RLMObject * __nullable newObject);
 
+/**
+Computes the new value of a property from its old value.
+
+@param oldValue The value of the property in the original RLMRealm.
+
+@return The value for the property in the migrated RLMRealm.
+*/
+typedef id __nullable (^RLMPropertyMigrationBlock)(id __nullable oldValue);
+
 /**
  RLMMigration is the object passed into a user defined RLMMigrationBlock when updating the version
  of an RLMRealm instance.
@@ -102,6 +111,55 @@ typedef void (^RLMObjectMigrationBlock)(RLMObject * __nullable oldObject, RLMObj
  */
 - (BOOL)deleteDataForClassName:(NSString *)name;
 
+
+#pragma mark - Migrating Property Values
+
+/**
+ Copies the value of a property of every object of a given type in the original Realm to a property
+ of the same object in the migrated Realm, such as when a property is renamed or its type is changed.
+
+ The values are copied directly between the old and new tables without creating any objects. A
+ property can be copied to a property of the same type, and integer, float and double properties can
+ also be copied to each other with the usual C conversions. Only integer, boolean, float, double,
+ string, data and date properties are supported, and `nil` values can only be copied to optional
+ properties.
+
+ @param oldPropertyName The name of the property in the original Realm's schema.
+ @param newPropertyName The name of the property in the migrated Realm's schema.
+ @param className       The name of the RLMObject class.
+ */
+- (void)copyValuesOfProperty:(NSString *)oldPropertyName toProperty:(NSString *)newPropertyName ofClass:(NSString *)className;
+
+/**
+ Sets a property of every object of a given type in the migrated Realm to the same value, such as
+ when giving a new property a default value.
+
+ Only integer, boolean, float, double, string, data and date properties are supported.
+
+ @param value           The value to set, or `nil` for an optional property.
+ @param propertyName    The name of the property in the migrated Realm's schema.
+ @param className       The name of the RLMObject class.
+ */
+- (void)setValue:(nullable id)value forProperty:(NSString *)propertyName ofClass:(NSString *)className;
+
+/**
+ Sets a property of every object of a given type in the migrated Realm to the result of calling a
+ block with the value of a property of the same object in the original Realm.
+
+ Unlike `enumerateObjects:block:`, no objects are created: the block is only given the old value
+ of the one property, and the value it returns is written directly to the new property. Only
+ integer, boolean, float, double, string, data and date properties are supported.
+
+ @param oldPropertyName The name of the property in the original Realm's schema.
+ @param newPropertyName The name of the property in the migrated Realm's schema.
+ @param className       The name of the RLMObject class.
+ @param block           The block which returns the new value for each old value.
+ */
+- (void)transformValuesOfProperty:(NSString *)oldPropertyName
+                       toProperty:(NSString *)newPropertyName
+                          ofClass:(NSString *)className
+                            block:(RLMPropertyMigrationBlock)block;
+
 @end
 
 RLM_ASSUME_NONNULL_END
@@ -27,11 +27,63 @@
 #import "RLMRealm_Private.hpp"
 #import "RLMResults_Private.h"
 #import "RLMSchema_Private.h"
+#import "RLMUtil.hpp"
 
 #import "shared_realm.hpp"
 
+#import <algorithm>
+
 using namespace realm;
 
+// Get a property of a class in the schema of one of the migration's Realms
+// and the table for the class, checking that its values can be read and
+// written directly
+static RLMProperty *RLMMigratedProperty(__unsafe_unretained RLMRealm *const realm,
+                                        __unsafe_unretained NSString *const className,
+                                        __unsafe_unretained NSString *const propertyName,
+                                        Table *&table) {
+    RLMObjectSchema *objectSchema = [realm.schema schemaForClassName:className];
+    if (!objectSchema) {
+        @throw RLMException(@"Object type '%@' is not persisted in the Realm.", className);
+    }
+    RLMProperty *prop = objectSchema[propertyName];
+    if (!prop) {
+        @throw RLMException(@"Invalid property name `%@` for class `%@`.", propertyName, className);
+    }
+    switch (prop.type) {
+        case RLMPropertyTypeInt:
+        case RLMPropertyTypeBool:
+        case RLMPropertyTypeFloat:
+        case RLMPropertyTypeDouble:
+        case RLMPropertyTypeString:
+        case RLMPropertyTypeData:
+        case RLMPropertyTypeDate:
+            break;
+        default:
+            @throw RLMException(@"Property '%@' of type '%@' can't be migrated as values.",
+                                propertyName, RLMTypeToString(prop.type));
+    }
+    table = objectSchema.table;
+    return prop;
+}
+
+static bool RLMIsNumericProperty(__unsafe_unretained RLMProperty *const prop) {
+    return prop.type == RLMPropertyTypeInt || prop.type == RLMPropertyTypeFloat || prop.type == RLMPropertyTypeDouble;
+}
+
+template<typename T>
+static T RLMGetNumber(Table const& table, __unsafe_unretained RLMProperty *const prop, size_t row) {
+    switch (prop.type) {
+        case RLMPropertyTypeInt:    return static_cast<T>(table.get_int(prop.column, row));
+        case RLMPropertyTypeFloat:  return static_cast<T>(table.get_float(prop.column, row));
+        case RLMPropertyTypeDouble: return static_cast<T>(table.get_double(prop.column, row));
+        default: REALM_UNREACHABLE();
+    }
+}
+
+// The number of objects between calls to the migration's progress block
+static const NSUInteger RLMMigrationProgressInterval = 1024;
+
 // The source realm for a migration has to use a SharedGroup to be able to share
 // the file with the destination realm, but we don't want to let the user call
 // beginWriteTransaction on it as that would make no sense.
@@ -69,30 +121,42 @@ using namespace realm;
     return self.realm.schema;
 }
 
+- (void)reportProgressForClass:(NSString *)className completed:(NSUInteger)completed total:(NSUInteger)total {
+    if (_progressBlock && (completed % RLMMigrationProgressInterval == 0 || completed == total)) {
+        _progressBlock(className, completed, total);
+    }
+}
+
 - (void)enumerateObjects:(NSString *)className block:(RLMObjectMigrationBlock)block {
     // get all objects
     RLMResults *objects = [_realm.schema schemaForClassName:className] ? [_realm allObjects:className] : nil;
     RLMResults *oldObjects = [_oldRealm.schema schemaForClassName:className] ? [_oldRealm allObjects:className] : nil;
 
     if (objects && oldObjects) {
-        for (long i = oldObjects.count - 1; i >= 0; i--) {
+        NSUInteger count = oldObjects.count;
+        for (long i = count - 1; i >= 0; i--) {
             @autoreleasepool {
                 block(oldObjects[i], objects[i]);
             }
+            [self reportProgressForClass:className completed:count - i total:count];
         }
     }
     else if (objects) {
-        for (long i = objects.count - 1; i >= 0; i--) {
+        NSUInteger count = objects.count;
+        for (long i = count - 1; i >= 0; i--) {
             @autoreleasepool {
                 block(nil, objects[i]);
             }
+            [self reportProgressForClass:className completed:count - i total:count];
         }
     }
     else if (oldObjects) {
-        for (long i = oldObjects.count - 1; i >= 0; i--) {
+        NSUInteger count = oldObjects.count;
+        for (long i = count - 1; i >= 0; i--) {
             @autoreleasepool {
                 block(oldObjects[i], nil);
             }
+            [self reportProgressForClass:className completed:count - i total:count];
         }
     }
 }
@@ -125,6 +189,108 @@ using namespace realm;
     [_realm deleteObject:object];
 }
 
+- (void)copyValuesOfProperty:(NSString *)oldPropertyName toProperty:(NSString *)newPropertyName ofClass:(NSString *)className {
+    Table *oldTable, *newTable;
+    RLMProperty *oldProp = RLMMigratedProperty(_oldRealm, className, oldPropertyName, oldTable);
+    RLMProperty *newProp = RLMMigratedProperty(_realm, className, newPropertyName, newTable);
+    if (oldProp.type != newProp.type && !(RLMIsNumericProperty(oldProp) && RLMIsNumericProperty(newProp))) {
+        @throw RLMException(@"Cannot copy values of %@ property '%@' to %@ property '%@'.",
+                            RLMTypeToString(oldProp.type), oldPropertyName,
+                            RLMTypeToString(newProp.type), newPropertyName);
+    }
+
+    size_t oldCol = oldProp.column, newCol = newProp.column;
+    size_t count = std::min(oldTable->size(), newTable->size());
+    try {
+        for (size_t row = 0; row < count; ++row) {
+            if (oldProp.optional && oldTable->is_null(oldCol, row)) {
+                if (!newProp.optional) {
+                    @throw RLMException(@"Cannot copy nil value of '%@' to non-optional property '%@'.",
+                                        oldPropertyName, newPropertyName);
+                }
+                newTable->set_null(newCol, row);
+                continue;
+            }
+            switch (newProp.type) {
+                case RLMPropertyTypeInt:
+                    newTable->set_int(newCol, row, RLMGetNumber<int64_t>(*oldTable, oldProp, row));
+                    break;
+                case RLMPropertyTypeFloat:
+                    newTable->set_float(newCol, row, RLMGetNumber<float>(*oldTable, oldProp, row));
+                    break;
+                case RLMPropertyTypeDouble:
+                    newTable->set_double(newCol, row, RLMGetNumber<double>(*oldTable, oldProp, row));
+                    break;
+                case RLMPropertyTypeBool:
+                    newTable->set_bool(newCol, row, oldTable->get_bool(oldCol, row));
+                    break;
+                case RLMPropertyTypeString:
+                    newTable->set_string(newCol, row, oldTable->get_string(oldCol, row));
+                    break;
+                case RLMPropertyTypeData:
+                    newTable->set_binary(newCol, row, oldTable->get_binary(oldCol, row));
+                    break;
+                case RLMPropertyTypeDate:
+                    newTable->set_datetime(newCol, row, oldTable->get_datetime(oldCol, row));
+                    break;
+                default:
+                    REALM_UNREACHABLE();
+            }
+        }
+    }
+    catch (std::exception const& e) {
+        @throw RLMException(e);
+    }
+}
+
+- (void)setValue:(id)value forProperty:(NSString *)propertyName ofClass:(NSString *)className {
+    Table *table;
+    RLMProperty *prop = RLMMigratedProperty(_realm, className, propertyName, table);
+    value = RLMCoerceToNil(value);
+    if (!RLMIsObjectValidForProperty(value, prop)) {
+        @throw RLMException(@"Invalid value '%@' for property '%@'.", value, propertyName);
+    }
+
+    try {
+        for (size_t row = 0, count = table->size(); row < count; ++row) {
+            RLMSetTableValue(*table, prop, row, value);
+        }
+    }
+    catch (std::exception const& e) {
+        @throw RLMException(e);
+    }
+}
+
+- (void)transformValuesOfProperty:(NSString *)oldPropertyName
+                       toProperty:(NSString *)newPropertyName
+                          ofClass:(NSString *)className
+                            block:(RLMPropertyMigrationBlock)block {
+    static const size_t rowsPerAutoreleasePool = RLMMigrationProgressInterval;
+
+    Table *oldTable, *newTable;
+    RLMProperty *oldProp = RLMMigratedProperty(_oldRealm, className, oldPropertyName, oldTable);
+    RLMProperty *newProp = RLMMigratedProperty(_realm, className, newPropertyName, newTable);
+
+    size_t count = std::min(oldTable->size(), newTable->size());
+    try {
+        for (size_t start = 0; start < count; start += rowsPerAutoreleasePool) {
+            @autoreleasepool {
+                for (size_t row = start, end = std::min(count, start + rowsPerAutoreleasePool); row < end; ++row) {
+                    id value = RLMCoerceToNil(block(RLMGetTableValue(*oldTable, oldProp, row)));
+                    if (!RLMIsObjectValidForProperty(value, newProp)) {
+                        @throw RLMException(@"Invalid value '%@' for property '%@'.", value, newPropertyName);
+                    }
+                    RLMSetTableValue(*newTable, newProp, row, value);
+                }
+            }
+            [self reportProgressForClass:className completed:std::min(count, start + rowsPerAutoreleasePool) total:count];
+        }
+    }
+    catch (std::exception const& e) {
+        @throw RLMException(e);
+    }
+}
+
 - (BOOL)deleteDataForClassName:(NSString *)name {
     if (!name) {
         return false;
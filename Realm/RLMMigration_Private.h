@@ -19,6 +19,7 @@
 #import <Realm/RLMMigration.h>
 #import <Realm/RLMObjectBase.h>
 #import <Realm/RLMRealm.h>
+#import <Realm/RLMRealmConfiguration.h>
 
 typedef void (^RLMObjectBaseMigrationBlock)(RLMObjectBase *oldObject, RLMObjectBase *newObject);
 
@@ -26,6 +27,7 @@ typedef void (^RLMObjectBaseMigrationBlock)(RLMObjectBase *oldObject, RLMObjectB
 
 @property (nonatomic, strong) RLMRealm *oldRealm;
 @property (nonatomic, strong) RLMRealm *realm;
+@property (nonatomic, copy) RLMMigrationProgressBlock progressBlock;
 
 - (instancetype)initWithRealm:(RLMRealm *)realm oldRealm:(RLMRealm *)oldRealm;
 
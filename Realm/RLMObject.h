@@ -25,6 +25,16 @@ RLM_ASSUME_NONNULL_BEGIN
 @class RLMRealm;
 @class RLMResults;
 @class RLMObjectSchema;
+@class RLMNotificationToken;
+
+/**
+ The type of block passed to `-[RLMObject addNotificationBlock:]`.
+
+ @param changedProperties   The names of the properties which were changed, or
+                            nil if the object was deleted.
+ @param deleted             YES if the object was deleted.
+ */
+typedef void (^RLMObjectNotificationBlock)(NSArray RLM_GENERIC(NSString *) * __nullable changedProperties, BOOL deleted);
 
 /**
  
@@ -208,6 +218,36 @@ RLM_ASSUME_NONNULL_BEGIN
  */
 + (instancetype)createOrUpdateInRealm:(RLMRealm *)realm withValue:(id)value;
 
+/**
+ Create RLMObjects in a Realm from an array of values.
+
+ This is equivalent to calling `createInRealm:withValue:` with each of the values,
+ but is faster when creating many objects as the schema of the object type only
+ needs to be looked up once. The objects are not returned.
+
+ @param realm   The Realm in which the objects are persisted.
+ @param values  The values used to populate the objects. Each can be any value
+                accepted by `createInRealm:withValue:`.
+
+ @see   createInRealm:withValue:
+ */
++ (void)createInRealm:(RLMRealm *)realm withValues:(id<NSFastEnumeration>)values;
+
+/**
+ Create or update RLMObjects in a Realm from an array of values.
+
+ This is equivalent to calling `createOrUpdateInRealm:withValue:` with each of
+ the values, but is faster when creating or updating many objects as the schema
+ of the object type only needs to be looked up once. The objects are not returned.
+
+ @param realm   The Realm in which the objects are persisted.
+ @param values  The values used to populate the objects. Each can be any value
+                accepted by `createOrUpdateInRealm:withValue:`.
+
+ @see   createOrUpdateInRealm:withValue:, primaryKey
+ */
++ (void)createOrUpdateInRealm:(RLMRealm *)realm withValues:(id<NSFastEnumeration>)values;
+
 #pragma mark - Properties
 
 /**
@@ -238,6 +278,40 @@ RLM_ASSUME_NONNULL_BEGIN
  */
 + (NSArray RLM_GENERIC(NSString *) *)indexedProperties;
 
+/**
+ Return an array of property names for properties which should have a full-text index, which
+ speeds up `CONTAINS` queries for a single word. Only supported for string properties.
+
+ The index is built in memory the first time it is queried, and is kept up to date with changes
+ made on other threads. Queries made within a write transaction do not use it.
+ @return    NSArray of property names.
+ */
++ (NSArray RLM_GENERIC(NSString *) *)textIndexedProperties;
+
+/**
+ Return an array of property names for `RLMArray` properties whose `@count`, and `@sum` of each numeric
+ property of the objects in them, should be cached for each object. Queries which compare these with a
+ constant value read the cached values rather than every object's array.
+
+ The values are computed in memory the first time they are queried, and are kept up to date with changes
+ made on other threads. Queries made within a write transaction do not use them.
+ @return    NSArray of property names.
+ */
++ (NSArray RLM_GENERIC(NSString *) *)cachedAggregateProperties;
+
+/**
+ Return an array of compound indexes, each of which is an array of the names of two or more string
+ or int properties. Queries which compare the leading properties of a compound index with constant
+ values using `==`, optionally along with comparing the next property with `<`, `<=`, `>` or `>=`
+ if it is an int property, use the index to find the matching objects rather than checking
+ every object.
+
+ Compound indexes are built in memory the first time they are queried, and are kept up to date
+ with changes made on other threads. Queries made within a write transaction do not use them.
+ @return    NSArray of arrays of property names.
+ */
++ (NSArray RLM_GENERIC(NSArray RLM_GENERIC(NSString *) *) *)compoundIndexes;
+
 /**
  Implement to indicate the default values to be used for each property.
  
@@ -255,6 +329,38 @@ RLM_ASSUME_NONNULL_BEGIN
  */
 + (nullable NSString *)primaryKey;
 
+/**
+ Implement to designate two or more properties which together are the primary key for an RLMObject
+ subclass, as an alternative to `primaryKey`. Only properties of type RLMPropertyTypeString and
+ RLMPropertyTypeInt can be part of a compound primary key.
+
+ Adding an object with the same values for these properties as an existing object throws an
+ exception, unless it is added with one of the methods which update existing objects. The
+ properties can't be changed after an object is inserted. A compound index is created
+ automatically for the properties.
+
+ @return    Array of the names of the properties which make up the primary key.
+ */
++ (nullable NSArray RLM_GENERIC(NSString *) *)compoundPrimaryKey;
+
+/**
+ Implement to designate an NSDate property which objects of an RLMObject subclass expire relative to,
+ along with `timeToLive`. Once an object's date is more than `timeToLive` seconds in the past it is
+ no longer included in `RLMResults`, and Realms opened with an `expirySweepInterval` delete it in the
+ background. Objects in `RLMArray` properties are not hidden until they are deleted.
+
+ @return    Name of the date property objects expire relative to.
+ */
++ (nullable NSString *)timeToLiveProperty;
+
+/**
+ Implement along with `timeToLiveProperty` to give the number of seconds after the date in that property
+ at which objects expire. Must be at least one second.
+
+ @return    The time to live of objects of this class.
+ */
++ (NSTimeInterval)timeToLive;
+
 /**
  Implement to return an array of property names to ignore. These properties will not be persisted
  and are treated as transient.
@@ -397,6 +503,94 @@ RLM_ASSUME_NONNULL_BEGIN
  */
 - (BOOL)isEqualToObject:(RLMObject *)object;
 
+#pragma mark - Data Property Access
+
+/**
+ Returns the length in bytes of the value of a data property.
+
+ For persisted objects this reads the length from the Realm file without
+ copying the value into an `NSData`.
+
+ @param property    The name of an `NSData` property of this object.
+
+ @return    The length of the property's value, or 0 if it is `nil`.
+ */
+- (NSUInteger)lengthOfDataProperty:(NSString *)property;
+
+/**
+ Copies a range of bytes from the value of a data property into a buffer.
+
+ For persisted objects only the requested bytes are read from the Realm file,
+ which allows reading large values in chunks of a fixed size.
+
+ @param buffer      A buffer at least `range.length` bytes long.
+ @param range       The range of bytes to copy. The range is truncated if it extends
+                    past the end of the value, but its location must not.
+ @param property    The name of an `NSData` property of this object.
+
+ @return    The number of bytes copied into `buffer`.
+ */
+- (NSUInteger)getBytes:(void *)buffer range:(NSRange)range ofDataProperty:(NSString *)property;
+
+/**
+ Replaces a range of bytes in the value of a data property.
+
+ This is not an in-place edit: the entire new value is assembled in memory and
+ written back, so each call costs time and memory proportional to the full
+ length of the value rather than to `length`. It avoids creating an `NSData`
+ copy of the old value, but is not suitable for building up a large value
+ through many small edits.
+
+ Persisted objects can only be modified within a write transaction.
+
+ @param range       The range of bytes to replace, which must be within the current value.
+ @param bytes       The bytes to replace the range with.
+ @param length      The number of bytes in `bytes`.
+ @param property    The name of an `NSData` property of this object.
+ */
+- (void)replaceBytesInRange:(NSRange)range withBytes:(const void *)bytes length:(NSUInteger)length
+             ofDataProperty:(NSString *)property;
+
+/**
+ Appends bytes to the value of a data property. Appending to a `nil` value sets
+ it to the appended bytes.
+
+ Appending is not incremental. As with `-replaceBytesInRange:withBytes:length:ofDataProperty:`,
+ each call rewrites the entire value, so writing a value of length n in chunks
+ of size k costs O(n²/k) in total. To write a large value, assemble it in an
+ `NSData` and set it once.
+
+ Persisted objects can only be modified within a write transaction.
+
+ @param bytes       The bytes to append.
+ @param length      The number of bytes in `bytes`.
+ @param property    The name of an `NSData` property of this object.
+ */
+- (void)appendBytes:(const void *)bytes length:(NSUInteger)length toDataProperty:(NSString *)property;
+
+#pragma mark - Notifications
+
+/**
+ Register a block to be called each time the Realm is refreshed to a version
+ in which this object was changed by a write transaction on a different thread
+ or process.
+
+ Unlike key-value observing, which sends a separate pair of notifications for
+ each changed property, the block is called once per refresh with the names of
+ all of the properties of this object which were changed. If the object was
+ deleted the block is called with `deleted` set to YES, and is not called again.
+ Objects which are only observed with notification blocks do not send any KVO
+ notifications for changes from other threads.
+
+ The block and this object are retained until the notification is removed with
+ `-[RLMRealm removeNotification:]`.
+
+ @param block   The block to be called when this object changes.
+
+ @return    A token which must be passed to `-[RLMRealm removeNotification:]` to stop notifications.
+ */
+- (RLMNotificationToken *)addNotificationBlock:(RLMObjectNotificationBlock)block;
+
 #pragma mark - Dynamic Accessors
 
 /// :nodoc:
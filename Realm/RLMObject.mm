@@ -23,6 +23,7 @@
 #import "RLMSchema_Private.h"
 #import "RLMRealm_Private.hpp"
 #import "RLMQueryUtil.hpp"
+#import "RLMUtil.hpp"
 
 // We declare things in RLMObject which are actually implemented in RLMObjectBase
 // for documentation's sake, which leads to -Wunimplemented-method warnings.
@@ -50,7 +51,7 @@
 }
 
 + (instancetype)createInDefaultRealmWithValue:(id)value {
-    return (RLMObject *)RLMCreateObjectInRealmWithValue([RLMRealm defaultRealm], [self className], value, false);
+    return (RLMObject *)RLMCreateObjectInRealmWithValue([RLMRealm defaultRealm], self, value, false);
 }
 
 + (instancetype)createInDefaultRealmWithObject:(id)object {
@@ -58,7 +59,7 @@
 }
 
 + (instancetype)createInRealm:(RLMRealm *)realm withValue:(id)value {
-    return (RLMObject *)RLMCreateObjectInRealmWithValue(realm, [self className], value, false);
+    return (RLMObject *)RLMCreateObjectInRealmWithValue(realm, self, value, false);
 }
 
 + (instancetype)createInRealm:(RLMRealm *)realm withObject:(id)object {
@@ -76,17 +77,31 @@
 + (instancetype)createOrUpdateInRealm:(RLMRealm *)realm withValue:(id)value {
     // verify primary key
     RLMObjectSchema *schema = [self sharedSchema];
-    if (!schema.primaryKeyProperty) {
+    if (!schema.hasPrimaryKey) {
         NSString *reason = [NSString stringWithFormat:@"'%@' does not have a primary key and can not be updated", schema.className];
         @throw [NSException exceptionWithName:@"RLMExecption" reason:reason userInfo:nil];
     }
-    return (RLMObject *)RLMCreateObjectInRealmWithValue(realm, [self className], value, true);
+    return (RLMObject *)RLMCreateObjectInRealmWithValue(realm, self, value, true);
 }
 
 + (instancetype)createOrUpdateInRealm:(RLMRealm *)realm withObject:(id)object {
     return [self createOrUpdateInRealm:realm withValue:object];
 }
 
++ (void)createInRealm:(RLMRealm *)realm withValues:(id<NSFastEnumeration>)values {
+    RLMCreateObjectsInRealmWithValues(realm, [self className], values, false);
+}
+
++ (void)createOrUpdateInRealm:(RLMRealm *)realm withValues:(id<NSFastEnumeration>)values {
+    // verify primary key
+    RLMObjectSchema *schema = [self sharedSchema];
+    if (!schema.hasPrimaryKey) {
+        NSString *reason = [NSString stringWithFormat:@"'%@' does not have a primary key and can not be updated", schema.className];
+        @throw [NSException exceptionWithName:@"RLMExecption" reason:reason userInfo:nil];
+    }
+    RLMCreateObjectsInRealmWithValues(realm, [self className], values, true);
+}
+
 - (id)objectForKeyedSubscript:(NSString *)key {
     return RLMObjectBaseObjectForKeyedSubscript(self, key);
 }
@@ -96,11 +111,11 @@
 }
 
 + (RLMResults *)allObjects {
-    return RLMGetObjects(RLMRealm.defaultRealm, self.className, nil);
+    return RLMGetObjects(RLMRealm.defaultRealm, self, nil);
 }
 
 + (RLMResults *)allObjectsInRealm:(RLMRealm *)realm {
-    return RLMGetObjects(realm, self.className, nil);
+    return RLMGetObjects(realm, self, nil);
 }
 
 + (RLMResults *)objectsWhere:(NSString *)predicateFormat, ... {
@@ -128,19 +143,19 @@
 }
 
 + (RLMResults *)objectsWithPredicate:(NSPredicate *)predicate {
-    return RLMGetObjects(RLMRealm.defaultRealm, self.className, predicate);
+    return RLMGetObjects(RLMRealm.defaultRealm, self, predicate);
 }
 
 + (RLMResults *)objectsInRealm:(RLMRealm *)realm withPredicate:(NSPredicate *)predicate {
-    return RLMGetObjects(realm, self.className, predicate);
+    return RLMGetObjects(realm, self, predicate);
 }
 
 + (instancetype)objectForPrimaryKey:(id)primaryKey {
-    return RLMGetObject(RLMRealm.defaultRealm, self.className, primaryKey);
+    return RLMGetObject(RLMRealm.defaultRealm, self, primaryKey);
 }
 
 + (instancetype)objectInRealm:(RLMRealm *)realm forPrimaryKey:(id)primaryKey {
-    return RLMGetObject(realm, self.className, primaryKey);
+    return RLMGetObject(realm, self, primaryKey);
 }
 
 - (NSArray *)linkingObjectsOfClass:(NSString *)className forProperty:(NSString *)property {
@@ -151,6 +166,64 @@
     return [object isKindOfClass:RLMObject.class] && RLMObjectBaseAreEqual(self, object);
 }
 
+static RLMProperty *RLMValidatedGetDataProperty(RLMObjectBase *obj, NSString *name) {
+    RLMProperty *prop = RLMValidatedGetProperty(obj, name);
+    if (prop.type != RLMPropertyTypeData) {
+        @throw RLMException(@"Property '%@' of object '%@' is not a data property", name, obj->_objectSchema.className);
+    }
+    return prop;
+}
+
+- (NSUInteger)lengthOfDataProperty:(NSString *)property {
+    RLMProperty *prop = RLMValidatedGetDataProperty(self, property);
+    if (_realm) {
+        return RLMGetDataLength(self, prop);
+    }
+    return [(NSData *)[self valueForKey:prop.name] length];
+}
+
+- (NSUInteger)getBytes:(void *)buffer range:(NSRange)range ofDataProperty:(NSString *)property {
+    RLMProperty *prop = RLMValidatedGetDataProperty(self, property);
+    if (_realm) {
+        return RLMGetDataBytes(self, prop, buffer, range);
+    }
+
+    NSData *data = [self valueForKey:prop.name];
+    if (range.location > data.length) {
+        @throw RLMException(@"Range %@ is out of bounds for data of length %lu",
+                            NSStringFromRange(range), (unsigned long)data.length);
+    }
+    range.length = MIN(range.length, data.length - range.location);
+    [data getBytes:buffer range:range];
+    return range.length;
+}
+
+- (void)replaceBytesInRange:(NSRange)range withBytes:(const void *)bytes length:(NSUInteger)length
+             ofDataProperty:(NSString *)property {
+    RLMProperty *prop = RLMValidatedGetDataProperty(self, property);
+    if (_realm) {
+        RLMReplaceDataBytes(self, prop, range, bytes, length);
+        return;
+    }
+
+    NSMutableData *data = [[self valueForKey:prop.name] mutableCopy] ?: [NSMutableData data];
+    if (range.location > data.length || range.length > data.length - range.location) {
+        @throw RLMException(@"Range %@ is out of bounds for data of length %lu",
+                            NSStringFromRange(range), (unsigned long)data.length);
+    }
+    [data replaceBytesInRange:range withBytes:bytes length:length];
+    [self setValue:data forKey:prop.name];
+}
+
+- (void)appendBytes:(const void *)bytes length:(NSUInteger)length toDataProperty:(NSString *)property {
+    NSUInteger end = [self lengthOfDataProperty:property];
+    [self replaceBytesInRange:NSMakeRange(end, 0) withBytes:bytes length:length ofDataProperty:property];
+}
+
+- (RLMNotificationToken *)addNotificationBlock:(RLMObjectNotificationBlock)block {
+    return RLMObjectBaseAddNotificationBlock(self, block);
+}
+
 + (NSString *)className {
     return [super className];
 }
@@ -159,6 +232,18 @@
     return @[];
 }
 
++ (NSArray *)textIndexedProperties {
+    return @[];
+}
+
++ (NSArray *)cachedAggregateProperties {
+    return @[];
+}
+
++ (NSArray *)compoundIndexes {
+    return @[];
+}
+
 + (NSDictionary *)defaultPropertyValues {
     return nil;
 }
@@ -167,6 +252,18 @@
     return nil;
 }
 
++ (NSArray *)compoundPrimaryKey {
+    return nil;
+}
+
++ (NSString *)timeToLiveProperty {
+    return nil;
+}
+
++ (NSTimeInterval)timeToLive {
+    return 0;
+}
+
 + (NSArray *)ignoredProperties {
     return nil;
 }
@@ -149,6 +149,16 @@ static id RLMValidatedObjectForProperty(id obj, RLMProperty *prop, RLMSchema *sc
     return [super valueForKey:key];
 }
 
+- (NSDictionary *)dictionaryWithValuesForKeys:(NSArray *)keys {
+    // Observed objects have to read through the observation info, which
+    // holds the values of an object after it has been deleted
+    if (!_row.is_attached() || _observationInfo) {
+        return [super dictionaryWithValuesForKeys:keys];
+    }
+    [_realm verifyThread];
+    return RLMObjectDictionaryWithValuesForKeys(self, keys);
+}
+
 // Generic Swift properties can't be dynamic, so KVO doesn't work for them by default
 - (id)valueForUndefinedKey:(NSString *)key {
     if (Ivar ivar = _objectSchema[key].swiftIvar) {
@@ -337,6 +347,32 @@ RLMObjectSchema *RLMObjectBaseObjectSchema(__unsafe_unretained RLMObjectBase *ob
     return object ? object->_objectSchema : nil;
 }
 
+RLMNotificationToken *RLMObjectBaseAddNotificationBlock(RLMObjectBase *object, RLMObjectNotificationBlock block) {
+    if (!block) {
+        @throw RLMException(@"The notification block should not be nil");
+    }
+    if (!object->_realm) {
+        @throw RLMException(@"Notification blocks can only be added to objects in a Realm.");
+    }
+    RLMVerifyAttached(object);
+
+    if (!object->_observationInfo) {
+        object->_observationInfo = std::make_unique<RLMObservationInfo>(object);
+    }
+    block = [block copy];
+    object->_observationInfo->addChangeBlock(object->_row, object->_objectSchema, block);
+
+    // The token keeps the object alive until the notification is removed
+    RLMNotificationToken *token = [[RLMNotificationToken alloc] init];
+    token.realm = object->_realm;
+    token.unregisterBlock = ^{
+        if (object->_observationInfo) {
+            object->_observationInfo->removeChangeBlock(block);
+        }
+    };
+    return token;
+}
+
 NSArray *RLMObjectBaseLinkingObjectsOfClass(RLMObjectBase *object, NSString *className, NSString *property) {
     if (!object) {
         return nil;
@@ -457,6 +493,30 @@ Class RLMObjectUtilClass(BOOL isSwift) {
     return [cls indexedProperties];
 }
 
++ (NSArray *)textIndexedPropertiesForClass:(Class)cls {
+    return [cls textIndexedProperties];
+}
+
++ (NSArray *)cachedAggregatePropertiesForClass:(Class)cls {
+    return [cls cachedAggregateProperties];
+}
+
++ (NSArray *)compoundIndexesForClass:(Class)cls {
+    return [cls compoundIndexes];
+}
+
++ (NSArray *)compoundPrimaryKeyForClass:(Class)cls {
+    return [cls compoundPrimaryKey];
+}
+
++ (NSString *)timeToLivePropertyForClass:(Class)cls {
+    return [cls timeToLiveProperty];
+}
+
++ (NSTimeInterval)timeToLiveForClass:(Class)cls {
+    return [cls timeToLive];
+}
+
 + (NSArray *)getGenericListPropertyNames:(__unused id)obj {
     return nil;
 }
@@ -55,6 +55,18 @@ FOUNDATION_EXTERN RLMObjectSchema *RLMObjectBaseObjectSchema(RLMObjectBase *obje
  */
 FOUNDATION_EXTERN NSArray *RLMObjectBaseLinkingObjectsOfClass(RLMObjectBase *object, NSString *className, NSString *property);
 
+/**
+ This function is useful only in specialized circumstances, for example, when building components
+ that integrate with Realm. If you are simply building an app on Realm, it is
+ recommended to add notification blocks via `RLMObject`.
+
+ @param object		an RLMObjectBase obtained via a Swift Object or RLMObject
+ @param block		The block to be called once per refresh with all of the changed properties of the object.
+
+ @return A token which must be passed to `-[RLMRealm removeNotification:]` to stop notifications.
+ */
+FOUNDATION_EXTERN RLMNotificationToken *RLMObjectBaseAddNotificationBlock(RLMObjectBase *object, RLMObjectNotificationBlock block);
+
 /**
  This function is useful only in specialized circumstances, for example, when building components
  that integrate with Realm. If you are simply building an app on Realm, it is
@@ -18,6 +18,7 @@
 
 #import "RLMObjectSchema_Private.hpp"
 
+#import "RLMAccessor.h"
 #import "RLMArray.h"
 #import "RLMListBase.h"
 #import "RLMObject_Private.h"
@@ -28,8 +29,120 @@
 #import "RLMSwiftSupport.h"
 #import "RLMUtil.hpp"
 
+#import <memory>
+#import <mutex>
+#import <vector>
+
 using namespace realm;
 
+namespace {
+// An accessor class which is generated the first time it's needed, shared by
+// all copies of the object schema it was set up for
+struct RLMLazyAccessorClass {
+    NSString *prefix;
+    __unsafe_unretained Class cls = Nil;
+    std::mutex mutex;
+};
+
+// A perfect hash table from property name to property, built when the
+// properties of an object schema are set. Looking up properties by name is on
+// the path of every dynamic and KVC property access, and only hashing the
+// length and a few characters of the name is much cheaper than hashing the
+// full string for a dictionary lookup.
+class RLMPropertyLookupTable {
+public:
+    RLMPropertyLookupTable(NSArray *properties) {
+        NSUInteger count = properties.count;
+        if (count == 0) {
+            return;
+        }
+
+        size_t minSize = 1;
+        while (minSize < count * 2) {
+            minSize <<= 1;
+        }
+        for (size_t size = minSize; size <= minSize * 4; size <<= 1) {
+            for (uint32_t seed = 0; seed < 256; ++seed) {
+                if (build(properties, size, seed)) {
+                    return;
+                }
+            }
+        }
+
+        // no collision-free seed found, so callers fall back to the dictionary
+        _names.clear();
+        _properties.clear();
+    }
+
+    bool valid() const {
+        return !_names.empty();
+    }
+
+    RLMProperty *find(__unsafe_unretained NSString *const name) const {
+        size_t i = hash((__bridge CFStringRef)name, _seed) & (_names.size() - 1);
+        __unsafe_unretained NSString *const candidate = _names[i];
+        if (candidate == name || (candidate && [candidate isEqualToString:name])) {
+            return _properties[i];
+        }
+        return nil;
+    }
+
+private:
+    std::vector<NSString *> _names;
+    std::vector<RLMProperty *> _properties;
+    uint32_t _seed = 0;
+
+    static uint32_t hash(CFStringRef str, uint32_t seed) {
+        CFIndex length = CFStringGetLength(str);
+        uint32_t h = (seed + 1) * 2166136261u ^ (uint32_t)length;
+        if (length > 0) {
+            h = (h ^ CFStringGetCharacterAtIndex(str, 0)) * 16777619u;
+            h = (h ^ CFStringGetCharacterAtIndex(str, length / 2)) * 16777619u;
+            h = (h ^ CFStringGetCharacterAtIndex(str, length - 1)) * 16777619u;
+        }
+        h ^= h >> 15;
+        h *= 0x2c1b3c6du;
+        h ^= h >> 12;
+        return h;
+    }
+
+    bool build(NSArray *properties, size_t size, uint32_t seed) {
+        _names.assign(size, nil);
+        _properties.assign(size, nil);
+        _seed = seed;
+        for (RLMProperty *prop in properties) {
+            NSString *name = prop.name;
+            size_t i = hash((__bridge CFStringRef)name, seed) & (size - 1);
+            if (_names[i] && ![_names[i] isEqualToString:name]) {
+                return false;
+            }
+            // later duplicates replace earlier ones, as with the dictionary
+            _names[i] = name;
+            _properties[i] = prop;
+        }
+        return true;
+    }
+};
+
+// Check that the properties of a compound index or compound primary key exist
+// and can be indexed
+void RLMValidateCompoundIndexProperties(RLMObjectSchema *schema, NSArray *propertyNames) {
+    if (propertyNames.count < 2 || [NSSet setWithArray:propertyNames].count != propertyNames.count) {
+        @throw RLMException(@"Compound index (%@) on object '%@' must have two or more different properties",
+                            [propertyNames componentsJoinedByString:@", "], schema.className);
+    }
+    for (NSString *propertyName in propertyNames) {
+        RLMProperty *prop = schema[propertyName];
+        if (!prop) {
+            @throw RLMException(@"Compound index property '%@' does not exist on object '%@'", propertyName, schema.className);
+        }
+        if (prop.type != RLMPropertyTypeInt && prop.type != RLMPropertyTypeString) {
+            @throw RLMException(@"Only 'string' and 'int' properties can be part of a compound index");
+        }
+    }
+}
+}
+
 // private properties
 @interface RLMObjectSchema ()
 @property (nonatomic, readwrite) NSDictionary RLM_GENERIC(id, RLMProperty *) *propertiesByName;
@@ -40,6 +153,8 @@ using namespace realm;
     // table accessor optimization
     realm::TableRef _table;
     NSArray *_propertiesInDeclaredOrder;
+    std::shared_ptr<RLMLazyAccessorClass> _lazyAccessorClass;
+    std::shared_ptr<const RLMPropertyLookupTable> _propertyLookupTable;
 }
 
 - (instancetype)initWithClassName:(NSString *)objectClassName objectClass:(Class)objectClass properties:(NSArray *)properties {
@@ -52,8 +167,43 @@ using namespace realm;
     return self;
 }
 
+@synthesize accessorClass = _accessorClass;
+
+- (Class)accessorClass {
+    // _lazyAccessorClass is only changed while setting up the schema, but
+    // this can be called on the same object schema from multiple threads
+    if (!_accessorClass && _lazyAccessorClass) {
+        auto& lazy = *_lazyAccessorClass;
+        std::lock_guard<std::mutex> lock(lazy.mutex);
+        if (!lazy.cls) {
+            lazy.cls = RLMAccessorClassForObjectClass(_objectClass, self, lazy.prefix);
+        }
+        _accessorClass = lazy.cls;
+    }
+    return _accessorClass;
+}
+
+- (void)setAccessorClass:(Class)accessorClass {
+    _accessorClass = accessorClass;
+    _lazyAccessorClass.reset();
+}
+
+- (void)setLazyAccessorClassPrefix:(NSString *)prefix {
+    _accessorClass = Nil;
+    _lazyAccessorClass = std::make_shared<RLMLazyAccessorClass>();
+    _lazyAccessorClass->prefix = prefix;
+}
+
+- (void)setAccessorClassFromObjectSchema:(RLMObjectSchema *)objectSchema {
+    _accessorClass = objectSchema->_accessorClass;
+    _lazyAccessorClass = objectSchema->_lazyAccessorClass;
+}
+
 // return properties by name
 -(RLMProperty *)objectForKeyedSubscript:(id <NSCopying>)key {
+    if (_propertyLookupTable && [(id)key isKindOfClass:[NSString class]]) {
+        return _propertyLookupTable->find((NSString *)key);
+    }
     return _propertiesByName[key];
 }
 
@@ -69,6 +219,9 @@ using namespace realm;
     }
     _propertiesByName = map;
     _propertiesInDeclaredOrder = nil;
+
+    auto lookupTable = std::make_shared<const RLMPropertyLookupTable>(_properties);
+    _propertyLookupTable = lookupTable->valid() ? std::move(lookupTable) : nullptr;
 }
 
 - (void)setPrimaryKeyProperty:(RLMProperty *)primaryKeyProperty {
@@ -77,6 +230,14 @@ using namespace realm;
     _primaryKeyProperty = primaryKeyProperty;
 }
 
+- (BOOL)hasPrimaryKey {
+    return _primaryKeyProperty || _compoundPrimaryKey;
+}
+
+- (NSArray *)compoundIndexes {
+    return _compoundIndexes ?: @[];
+}
+
 + (instancetype)schemaForObjectClass:(Class)objectClass {
     RLMObjectSchema *schema = [RLMObjectSchema new];
 
@@ -137,6 +298,65 @@ using namespace realm;
         }
     }
 
+    for (NSString *propertyName in [RLMObjectUtilClass(isSwift) textIndexedPropertiesForClass:objectClass]) {
+        RLMProperty *prop = schema[propertyName];
+        if (!prop) {
+            @throw RLMException(@"Text indexed property '%@' does not exist on object '%@'", propertyName, className);
+        }
+        if (prop.type != RLMPropertyTypeString) {
+            @throw RLMException(@"Only 'string' properties can be text indexed");
+        }
+        prop.textIndexed = YES;
+    }
+
+    for (NSString *propertyName in [RLMObjectUtilClass(isSwift) cachedAggregatePropertiesForClass:objectClass]) {
+        RLMProperty *prop = schema[propertyName];
+        if (!prop) {
+            @throw RLMException(@"Cached aggregate property '%@' does not exist on object '%@'", propertyName, className);
+        }
+        if (prop.type != RLMPropertyTypeArray) {
+            @throw RLMException(@"Only 'RLMArray' properties can have cached aggregates");
+        }
+        prop.cachedAggregates = YES;
+    }
+
+    NSMutableArray *compoundIndexes = [NSMutableArray new];
+    if (NSArray *compoundPrimaryKey = [RLMObjectUtilClass(isSwift) compoundPrimaryKeyForClass:objectClass]) {
+        if (schema.primaryKeyProperty) {
+            @throw RLMException(@"Object '%@' can't have both a primary key and a compound primary key", className);
+        }
+        RLMValidateCompoundIndexProperties(schema, compoundPrimaryKey);
+        for (NSString *propertyName in compoundPrimaryKey) {
+            schema[propertyName].inCompoundPrimaryKey = YES;
+        }
+        // Existing objects are looked up within write transactions, where the
+        // compound index can't be used
+        schema[compoundPrimaryKey.firstObject].indexed = YES;
+        schema.compoundPrimaryKey = compoundPrimaryKey;
+        [compoundIndexes addObject:compoundPrimaryKey];
+    }
+    for (NSArray *propertyNames in [RLMObjectUtilClass(isSwift) compoundIndexesForClass:objectClass]) {
+        RLMValidateCompoundIndexProperties(schema, propertyNames);
+        [compoundIndexes addObject:[propertyNames copy]];
+    }
+    schema.compoundIndexes = compoundIndexes;
+
+    if (NSString *timeToLiveProperty = [RLMObjectUtilClass(isSwift) timeToLivePropertyForClass:objectClass]) {
+        RLMProperty *prop = schema[timeToLiveProperty];
+        if (!prop) {
+            @throw RLMException(@"Time to live property '%@' does not exist on object '%@'", timeToLiveProperty, className);
+        }
+        if (prop.type != RLMPropertyTypeDate) {
+            @throw RLMException(@"Only 'date' properties can be the time to live property");
+        }
+        NSTimeInterval timeToLive = [RLMObjectUtilClass(isSwift) timeToLiveForClass:objectClass];
+        if (timeToLive < 1) {
+            @throw RLMException(@"Time to live of object '%@' must be at least one second", className);
+        }
+        schema.timeToLiveProperty = timeToLiveProperty;
+        schema.timeToLive = timeToLive;
+    }
+
     for (RLMProperty *prop in schema.properties) {
         RLMPropertyType type = prop.type;
         if (prop.optional && !RLMPropertyTypeIsNullable(type)) {
@@ -261,11 +481,16 @@ using namespace realm;
     schema->_className = _className;
     schema->_objectClass = _objectClass;
     schema->_accessorClass = _accessorClass;
+    schema->_lazyAccessorClass = _lazyAccessorClass;
     schema->_standaloneClass = _standaloneClass;
     schema->_isSwiftClass = _isSwiftClass;
 
     // call property setter to reset map and primary key
     schema.properties = [[NSArray allocWithZone:zone] initWithArray:_properties copyItems:YES];
+    schema->_compoundPrimaryKey = _compoundPrimaryKey;
+    schema->_compoundIndexes = _compoundIndexes;
+    schema->_timeToLiveProperty = _timeToLiveProperty;
+    schema->_timeToLive = _timeToLive;
 
     // _table not copied as it's realm::Group-specific
     return schema;
@@ -277,13 +502,20 @@ using namespace realm;
     schema->_className = _className;
     schema->_objectClass = _objectClass;
     schema->_accessorClass = _accessorClass;
+    schema->_lazyAccessorClass = _lazyAccessorClass;
     schema->_standaloneClass = _standaloneClass;
     schema->_isSwiftClass = _isSwiftClass;
 
     // reuse propery array, map, and primary key instnaces
     schema->_properties = _properties;
     schema->_propertiesByName = _propertiesByName;
+    schema->_propertyLookupTable = _propertyLookupTable;
+    schema->_propertiesInDeclaredOrder = _propertiesInDeclaredOrder;
     schema->_primaryKeyProperty = _primaryKeyProperty;
+    schema->_compoundPrimaryKey = _compoundPrimaryKey;
+    schema->_compoundIndexes = _compoundIndexes;
+    schema->_timeToLiveProperty = _timeToLiveProperty;
+    schema->_timeToLive = _timeToLive;
 
     // _table not copied as it's realm::Group-specific
     return schema;
@@ -333,6 +565,10 @@ using namespace realm;
     ObjectSchema objectSchema;
     objectSchema.name = _className.UTF8String;
     objectSchema.primary_key = _primaryKeyProperty ? _primaryKeyProperty.name.UTF8String : "";
+    if (_timeToLiveProperty) {
+        objectSchema.expiry_property = _timeToLiveProperty.UTF8String;
+        objectSchema.time_to_live = std::chrono::seconds((long long)_timeToLive);
+    }
     for (RLMProperty *prop in _properties) {
         Property p;
         p.name = prop.name.UTF8String;
@@ -33,9 +33,29 @@ RLM_ASSUME_NONNULL_BEGIN
 // class used for this object schema
 @property (nonatomic, readwrite, assign) Class objectClass;
 @property (nonatomic, readwrite, assign) Class accessorClass;
+
+// Generate the accessor class with the given prefix the first time
+// accessorClass is read rather than immediately. Copies of the object schema
+// share the generated class.
+- (void)setLazyAccessorClassPrefix:(NSString *)prefix;
+// Use the same accessor class as another object schema, whether or not it has
+// been generated yet
+- (void)setAccessorClassFromObjectSchema:(RLMObjectSchema *)objectSchema;
 @property (nonatomic, readwrite, assign) Class standaloneClass;
 
 @property (nonatomic, readwrite, nullable) RLMProperty *primaryKeyProperty;
+// The names of the properties which together are the primary key for objects
+// with a compound primary key, which have no primaryKeyProperty
+@property (nonatomic, readwrite, copy, nullable) NSArray RLM_GENERIC(NSString *) *compoundPrimaryKey;
+// Does the object have either kind of primary key?
+@property (nonatomic, readonly) BOOL hasPrimaryKey;
+// The names of the properties in each compound index, including the compound
+// primary key
+@property (nonatomic, readwrite, copy) NSArray RLM_GENERIC(NSArray RLM_GENERIC(NSString *) *) *compoundIndexes;
+// The date property objects expire relative to and how long after it they
+// expire, if the class has a time to live
+@property (nonatomic, readwrite, copy, nullable) NSString *timeToLiveProperty;
+@property (nonatomic, readwrite, assign) NSTimeInterval timeToLive;
 
 @property (nonatomic, readonly) NSArray RLM_GENERIC(RLMProperty *) *propertiesInDeclaredOrder;
 
@@ -36,6 +36,9 @@ class RLMObservationInfo;
 @interface RLMObjectSchema () {
     @public
     std::vector<RLMObservationInfo *> _observedObjects;
+    // Set whenever _observedObjects is modified so that cached observed row
+    // lists built from it know they need to be rebuilt
+    bool _observedObjectsChanged;
 }
 @property (nonatomic) realm::Table *table;
 
@@ -57,9 +57,17 @@ typedef NS_OPTIONS(NSUInteger, RLMCreationOptions) {
 // add an object to the given realm
 void RLMAddObjectToRealm(RLMObjectBase *object, RLMRealm *realm, bool createOrUpdate);
 
+// add or update each of the objects in the given realm, handling runs of
+// objects of the same type in a single batch where possible
+void RLMAddObjectsToRealm(id<NSFastEnumeration> objects, RLMRealm *realm, bool createOrUpdate);
+
 // delete an object from its realm
 void RLMDeleteObjectFromRealm(RLMObjectBase *object, RLMRealm *realm);
 
+// delete each of the objects which are RLMObjects from the given realm, which
+// they must belong to
+void RLMDeleteObjectsFromRealm(id<NSFastEnumeration> objects, RLMRealm *realm);
+
 // deletes all objects from a realm
 void RLMDeleteAllObjectsFromRealm(RLMRealm *realm);
 
@@ -71,6 +79,9 @@ id RLMGetObject(RLMRealm *realm, NSString *objectClassName, id key) NS_RETURNS_R
 
 // create object from array or dictionary
 RLMObjectBase *RLMCreateObjectInRealmWithValue(RLMRealm *realm, NSString *className, id value, bool createOrUpdate) NS_RETURNS_RETAINED;
+
+// create objects of a single type from an array of arrays or dictionaries
+void RLMCreateObjectsInRealmWithValues(RLMRealm *realm, NSString *className, id<NSFastEnumeration> values, bool createOrUpdate);
     
 
 //
@@ -89,6 +100,13 @@ namespace realm {
     template<typename T> class BasicRowExpr;
     using RowExpr = BasicRowExpr<Table>;
 }
+
+// Variants of the above for RLMObject subclasses, which look the object schema
+// up by class rather than by name
+RLMResults *RLMGetObjects(RLMRealm *realm, Class objectClass, NSPredicate *predicate) NS_RETURNS_RETAINED;
+id RLMGetObject(RLMRealm *realm, Class objectClass, id key) NS_RETURNS_RETAINED;
+RLMObjectBase *RLMCreateObjectInRealmWithValue(RLMRealm *realm, Class objectClass, id value, bool createOrUpdate) NS_RETURNS_RETAINED;
+
 // Create accessors
 RLMObjectBase *RLMCreateObjectAccessor(RLMRealm *realm,
                                        RLMObjectSchema *objectSchema,
@@ -37,6 +37,9 @@
 #import "shared_realm.hpp"
 
 #import <objc/message.h>
+#import <algorithm>
+#import <unordered_map>
+#import <unordered_set>
 
 using namespace realm;
 
@@ -56,16 +59,18 @@ void RLMRealmCreateAccessors(RLMSchema *schema) {
     if (matchingSchema) {
         // reuse accessors
         for (RLMObjectSchema *objectSchema in schema.objectSchema) {
-            objectSchema.accessorClass = matchingSchema[objectSchema.className].accessorClass;
+            [objectSchema setAccessorClassFromObjectSchema:matchingSchema[objectSchema.className]];
         }
     }
     else {
-        // create accessors and cache in s_accessorSchema
+        // create accessors and cache in s_accessorSchema. Most apps only use
+        // a few of their classes on each launch, so each accessor class is
+        // generated the first time an object of that type is accessed.
         for (RLMObjectSchema *objectSchema in schema.objectSchema) {
             if (objectSchema.table) {
                 NSString *prefix = [NSString stringWithFormat:@"RLMAccessor_v%lu_",
                                     (unsigned long)s_accessorSchema.count];
-                objectSchema.accessorClass = RLMAccessorClassForObjectClass(objectSchema.objectClass, objectSchema, prefix);
+                [objectSchema setLazyAccessorClassPrefix:prefix];
             }
         }
         [s_accessorSchema addObject:schema];
@@ -89,6 +94,34 @@ static inline void RLMVerifyInWriteTransaction(__unsafe_unretained RLMRealm *con
     if (!realm.inWriteTransaction) {
         @throw RLMException(@"Can only add, remove, or create objects in a Realm in a write transaction - call beginWriteTransaction on an RLMRealm instance first.");
     }
+    [realm detachAllEnumerators];
+}
+
+// Look up the object schema in the realm for an RLMObject subclass, caching it
+// on the realm by class. Returns nil if the realm does not persist the class.
+static RLMObjectSchema *RLMObjectSchemaForClass(__unsafe_unretained RLMRealm *const realm, Class objectClass) {
+    auto& cache = realm->_objectSchemaForClass;
+    auto it = cache.find(objectClass);
+    if (it != cache.end()) {
+        return it->second;
+    }
+    RLMObjectSchema *objectSchema = [realm.schema schemaForClassName:[objectClass className]];
+    if (objectSchema) {
+        cache.emplace(objectClass, objectSchema);
+    }
+    return objectSchema;
+}
+
+static RLMObjectSchema *RLMObjectSchemaForCreating(__unsafe_unretained RLMRealm *const realm,
+                                                   __unsafe_unretained NSString *const className) {
+    RLMObjectSchema *objectSchema = [realm.schema schemaForClassName:className];
+    if (!objectSchema) {
+        @throw RLMException(@"Object type '%@' is not persisted in the Realm. "
+                            @"If using a custom `objectClasses` / `objectTypes` array in your configuration, "
+                            @"add `%@` to the list of `objectClasses` / `objectTypes`.",
+                            className, className);
+    }
+    return objectSchema;
 }
 
 void RLMInitializeSwiftAccessorGenerics(__unsafe_unretained RLMObjectBase *const object) {
@@ -115,6 +148,19 @@ void RLMInitializeSwiftAccessorGenerics(__unsafe_unretained RLMObjectBase *const
     }
 }
 
+// Called when an accessor is pointed at its row: counts the row as accessed,
+// for Realms used as size-limited caches, and makes the accessor the one
+// returned for the row by Realms which reuse accessors
+static inline void RLMDidAttachAccessor(__unsafe_unretained RLMRealm *const realm,
+                                        __unsafe_unretained RLMObjectBase *const object) {
+    if (object->_row.is_attached()) {
+        realm->_realm->record_access(*object->_row.get_table(), object->_row.get_index());
+        if (auto& identityMap = realm->_accessorIdentityMap) {
+            identityMap->add(*realm->_realm, object->_row.get_table(), object->_row.get_index(), object);
+        }
+    }
+}
+
 template<typename F>
 static inline NSUInteger RLMCreateOrGetRowForObject(__unsafe_unretained RLMObjectSchema *const schema, F primaryValueGetter, bool createOrUpdate, bool &created) {
     // try to get existing row if updating
@@ -136,6 +182,37 @@ static inline NSUInteger RLMCreateOrGetRowForObject(__unsafe_unretained RLMObjec
             rowIndex = table.find_first_int(primaryProperty.column, [primaryValue longLongValue]);
         }
     }
+    else if (NSArray *compoundPrimaryKey = schema.compoundPrimaryKey) {
+        // existing objects are looked for even when not updating, as unlike
+        // primary key columns nothing else checks that they're unique
+        realm::Query query = table.where();
+        bool missingValue = false;
+        for (NSString *propertyName in compoundPrimaryKey) {
+            RLMProperty *prop = schema[propertyName];
+            id value = RLMCoerceToNil(primaryValueGetter(prop));
+            if (!value && !prop.optional) {
+                // left for populating the object to report
+                missingValue = true;
+                break;
+            }
+            if (prop.type == RLMPropertyTypeString) {
+                query.equal(prop.column, RLMStringDataWithNSString(value));
+            }
+            else if (!value) {
+                query.and_query(table.column<realm::Int>(prop.column) == realm::null());
+            }
+            else {
+                query.equal(prop.column, (int64_t)[value longLongValue]);
+            }
+        }
+        if (!missingValue) {
+            rowIndex = query.find();
+        }
+        if (rowIndex != realm::not_found && !createOrUpdate) {
+            @throw RLMException(@"Can't create object with existing value for compound primary key (%@).",
+                                [compoundPrimaryKey componentsJoinedByString:@", "]);
+        }
+    }
 
     // if no existing, create row
     created = NO;
@@ -148,11 +225,27 @@ static inline NSUInteger RLMCreateOrGetRowForObject(__unsafe_unretained RLMObjec
     return rowIndex;
 }
 
-void RLMAddObjectToRealm(__unsafe_unretained RLMObjectBase *const object,
-                         __unsafe_unretained RLMRealm *const realm, 
-                         bool createOrUpdate) {
-    RLMVerifyInWriteTransaction(realm);
+// get the value of a property from a standalone object
+static id RLMStandaloneValueForProperty(__unsafe_unretained RLMObjectBase *const object,
+                                        __unsafe_unretained RLMProperty *const prop) {
+    // get object from ivar using key value coding
+    if (prop.swiftIvar) {
+        if (prop.type == RLMPropertyTypeArray) {
+            return static_cast<RLMListBase *>(object_getIvar(object, prop.swiftIvar))._rlmArray;
+        }
+        // optional
+        return static_cast<RLMOptionalBase *>(object_getIvar(object, prop.swiftIvar)).underlyingValue;
+    }
+    if ([object respondsToSelector:prop.getterSel]) {
+        return [object valueForKey:prop.getterName];
+    }
+    return nil;
+}
 
+// verify that the object can be added to the realm, returning the schema to
+// add it with, or nil if the object is already persisted in the realm
+static RLMObjectSchema *RLMSchemaForAddingObject(__unsafe_unretained RLMObjectBase *const object,
+                                                 __unsafe_unretained RLMRealm *const realm) {
     // verify that object is standalone
     if (object.invalidated) {
         @throw RLMException(@"Adding a deleted or invalidated object to a Realm is not permitted");
@@ -160,7 +253,7 @@ void RLMAddObjectToRealm(__unsafe_unretained RLMObjectBase *const object,
     if (object->_realm) {
         if (object->_realm == realm) {
             // no-op
-            return;
+            return nil;
         }
         // for differing realms users must explicitly create the object in the second realm
         @throw RLMException(@"Object is already persisted in a Realm");
@@ -169,15 +262,28 @@ void RLMAddObjectToRealm(__unsafe_unretained RLMObjectBase *const object,
         @throw RLMException(@"Cannot add an object with observers to a Realm");
     }
 
-    // set the realm and schema
+    // Copies of a schema share the class name strings, so this normally only
+    // compares pointers. The check is needed as all dynamic object schemas
+    // share a class.
     NSString *objectClassName = object->_objectSchema.className;
-    RLMObjectSchema *schema = [realm.schema schemaForClassName:objectClassName];
+    RLMObjectSchema *schema = RLMObjectSchemaForClass(realm, object->_objectSchema.objectClass);
+    if (schema && (schema.className == objectClassName || [schema.className isEqualToString:objectClassName])) {
+        return schema;
+    }
+    return RLMObjectSchemaForCreating(realm, objectClassName);
+}
+
+void RLMAddObjectToRealm(__unsafe_unretained RLMObjectBase *const object,
+                         __unsafe_unretained RLMRealm *const realm, 
+                         bool createOrUpdate) {
+    RLMVerifyInWriteTransaction(realm);
+
+    RLMObjectSchema *schema = RLMSchemaForAddingObject(object, realm);
     if (!schema) {
-        @throw RLMException(@"Object type '%@' is not persisted in the Realm. "
-                            @"If using a custom `objectClasses` / `objectTypes` array in your configuration, "
-                            @"add `%@` to the list of `objectClasses` / `objectTypes`.",
-                            objectClassName, objectClassName);
+        return;
     }
+
+    // set the realm and schema
     object->_objectSchema = schema;
     object->_realm = realm;
 
@@ -185,6 +291,7 @@ void RLMAddObjectToRealm(__unsafe_unretained RLMObjectBase *const object,
     bool created;
     auto primaryGetter = [=](__unsafe_unretained RLMProperty *const p) { return [object valueForKey:p.getterName]; };
     object->_row = (*schema.table)[RLMCreateOrGetRowForObject(schema, primaryGetter, createOrUpdate, created)];
+    RLMDidAttachAccessor(realm, object);
 
     RLMCreationOptions creationOptions = RLMCreationOptionsPromoteStandalone;
     if (createOrUpdate) {
@@ -193,19 +300,7 @@ void RLMAddObjectToRealm(__unsafe_unretained RLMObjectBase *const object,
 
     // populate all properties
     for (RLMProperty *prop in schema.properties) {
-        // get object from ivar using key value coding
-        id value = nil;
-        if (prop.swiftIvar) {
-            if (prop.type == RLMPropertyTypeArray) {
-                value = static_cast<RLMListBase *>(object_getIvar(object, prop.swiftIvar))._rlmArray;
-            }
-            else { // optional
-                value = static_cast<RLMOptionalBase *>(object_getIvar(object, prop.swiftIvar)).underlyingValue;
-            }
-        }
-        else if ([object respondsToSelector:prop.getterSel]) {
-            value = [object valueForKey:prop.getterName];
-        }
+        id value = RLMStandaloneValueForProperty(object, prop);
 
         // FIXME: Add condition to check for Mixed once it can support a nil value.
         if (!value && !prop.optional) {
@@ -237,6 +332,280 @@ void RLMAddObjectToRealm(__unsafe_unretained RLMObjectBase *const object,
     RLMInitializeSwiftAccessorGenerics(object);
 }
 
+static bool RLMHasLinkProperties(__unsafe_unretained RLMObjectSchema *const schema) {
+    for (RLMProperty *prop in schema.properties) {
+        if (prop.type == RLMPropertyTypeObject || prop.type == RLMPropertyTypeArray) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Objects with no link properties can't cause other objects to be added, so
+// many objects of such a type can be added at once without changing the result.
+// Inserting objects with a primary key one at a time is still required to
+// check for duplicates, but upserting them can be batched.
+static bool RLMCanAddInBatch(__unsafe_unretained RLMObjectSchema *const schema, bool createOrUpdate) {
+    return createOrUpdate == !!schema.primaryKeyProperty && !schema.compoundPrimaryKey && !RLMHasLinkProperties(schema);
+}
+
+// check that every non-optional property of each of the objects has a value,
+// so that none of them are attached to rows before finding that one of them
+// can't be added
+static void RLMValidateObjectsInBatch(std::vector<RLMObjectBase *> const& objects,
+                                      __unsafe_unretained RLMObjectSchema *const schema) {
+    for (RLMProperty *prop in schema.properties) {
+        if (prop.isPrimary) {
+            continue;
+        }
+        for (RLMObjectBase *object : objects) {
+            id value = RLMStandaloneValueForProperty(object, prop);
+            if (!value && !prop.optional) {
+                @throw RLMException(@"No value or default value specified for property '%@' in '%@'",
+                                    prop.name, schema.className);
+            }
+        }
+    }
+}
+
+// set all of the non-primary key properties of the objects, which must have
+// rows already, a column at a time and then promote them to accessors
+static void RLMPopulateObjectsInBatch(std::vector<RLMObjectBase *> const& objects,
+                                      __unsafe_unretained RLMObjectSchema *const schema,
+                                      RLMCreationOptions creationOptions) {
+    for (RLMProperty *prop in schema.properties) {
+        if (prop.isPrimary) {
+            continue;
+        }
+        for (RLMObjectBase *object : objects) {
+            id value = RLMStandaloneValueForProperty(object, prop);
+            if (!value && !prop.optional) {
+                @throw RLMException(@"No value or default value specified for property '%@' in '%@'",
+                                    prop.name, schema.className);
+            }
+            RLMDynamicSet(object, prop, RLMCoerceToNil(value), creationOptions);
+        }
+    }
+
+    for (RLMObjectBase *object : objects) {
+        object_setClass(object, schema.accessorClass);
+        RLMInitializeSwiftAccessorGenerics(object);
+    }
+}
+
+static void RLMInsertObjectsInBatch(std::vector<RLMObjectBase *> const& objects,
+                                    __unsafe_unretained RLMObjectSchema *const schema,
+                                    __unsafe_unretained RLMRealm *const realm) {
+    RLMValidateObjectsInBatch(objects, schema);
+
+    // reserve all of the rows up front and then fill them in a column at a time
+    realm::Table &table = *schema.table;
+    size_t firstRow = table.add_empty_row(objects.size());
+    std::vector<RLMObjectSchema *> standaloneSchemas;
+    standaloneSchemas.reserve(objects.size());
+    for (size_t i = 0; i < objects.size(); ++i) {
+        RLMObjectBase *object = objects[i];
+        standaloneSchemas.push_back(object->_objectSchema);
+        object->_objectSchema = schema;
+        object->_realm = realm;
+        object->_row = table[firstRow + i];
+        RLMDidAttachAccessor(realm, object);
+    }
+    @try {
+        RLMPopulateObjectsInBatch(objects, schema, RLMCreationOptionsPromoteStandalone);
+    }
+    @catch (NSException *) {
+        // the objects are still of their standalone classes with their values
+        // in their ivars, so detaching them and removing their rows leaves
+        // them as they were before being added
+        for (size_t i = 0; i < objects.size(); ++i) {
+            RLMObjectBase *object = objects[i];
+            object->_objectSchema = standaloneSchemas[i];
+            object->_realm = nil;
+            object->_row = realm::Row();
+        }
+        for (size_t i = objects.size(); i > 0; --i) {
+            table.remove(firstRow + i - 1);
+        }
+        @throw;
+    }
+}
+
+// Looking up the existing rows by scanning the primary key column rather than
+// using the index is faster when there are at least 1/RLMPrimaryKeyScanRatio as
+// many distinct keys as rows in the table
+static const size_t RLMPrimaryKeyScanRatio = 8;
+
+template<typename Key, typename GetKey, typename FindRow, typename SetKey>
+static void RLMUpsertObjectsInBatch(std::vector<RLMObjectBase *> const& objects,
+                                    std::vector<Key> const& keys,
+                                    __unsafe_unretained RLMObjectSchema *const schema,
+                                    __unsafe_unretained RLMRealm *const realm,
+                                    GetKey getKey, FindRow findRow, SetKey setKey) {
+    realm::Table &table = *schema.table;
+
+    // find the existing row for each distinct key
+    std::unordered_map<Key, size_t> rows;
+    rows.reserve(keys.size());
+    for (auto const& key : keys) {
+        rows.emplace(key, realm::not_found);
+    }
+    if (table.size() / RLMPrimaryKeyScanRatio <= rows.size()) {
+        Key key;
+        for (size_t row = 0, size = table.size(); row < size; ++row) {
+            if (getKey(row, key)) {
+                auto it = rows.find(key);
+                if (it != rows.end()) {
+                    it->second = row;
+                }
+            }
+        }
+    }
+    else {
+        for (auto& entry : rows) {
+            entry.second = findRow(entry.first);
+        }
+    }
+
+    // add rows for the new keys in the order the objects were given, with
+    // later objects with the same key updating the row created for the first
+    size_t newRowCount = std::count_if(rows.begin(), rows.end(), [](auto const& entry) {
+        return entry.second == realm::not_found;
+    });
+    size_t nextRow = newRowCount ? table.add_empty_row(newRowCount) : realm::not_found;
+    for (size_t i = 0; i < objects.size(); ++i) {
+        size_t& row = rows[keys[i]];
+        if (row == realm::not_found) {
+            row = nextRow++;
+            setKey(row, keys[i]);
+        }
+
+        RLMObjectBase *object = objects[i];
+        object->_objectSchema = schema;
+        object->_realm = realm;
+        object->_row = table[row];
+        RLMDidAttachAccessor(realm, object);
+    }
+    RLMPopulateObjectsInBatch(objects, schema, RLMCreationOptionsPromoteStandalone | RLMCreationOptionsCreateOrUpdate);
+}
+
+static void RLMUpsertObjectsInBatch(std::vector<RLMObjectBase *> const& objects,
+                                    __unsafe_unretained RLMObjectSchema *const schema,
+                                    __unsafe_unretained RLMRealm *const realm) {
+    realm::Table &table = *schema.table;
+    RLMProperty *primaryProperty = schema.primaryKeyProperty;
+    size_t col = primaryProperty.column;
+
+    // the empty rows added for new objects are given their keys directly, as
+    // checking for duplicates would find the other new rows' default values
+    if (primaryProperty.type == RLMPropertyTypeString) {
+        std::vector<std::string> keys;
+        keys.reserve(objects.size());
+        for (RLMObjectBase *object : objects) {
+            StringData key = RLMStringDataWithNSString([object valueForKey:primaryProperty.getterName]);
+            keys.emplace_back(key.data(), key.size());
+        }
+        RLMUpsertObjectsInBatch(objects, keys, schema, realm,
+                                [&](size_t row, std::string& key) {
+                                    StringData value = table.get_string(col, row);
+                                    if (value.is_null()) {
+                                        return false;
+                                    }
+                                    key.assign(value.data(), value.size());
+                                    return true;
+                                },
+                                [&](std::string const& key) { return table.find_first_string(col, key); },
+                                [&](size_t row, std::string const& key) { table.set_string(col, row, key); });
+    }
+    else {
+        std::vector<long long> keys;
+        keys.reserve(objects.size());
+        for (RLMObjectBase *object : objects) {
+            keys.push_back([[object valueForKey:primaryProperty.getterName] longLongValue]);
+        }
+        bool nullable = table.is_nullable(col);
+        RLMUpsertObjectsInBatch(objects, keys, schema, realm,
+                                [&](size_t row, long long& key) {
+                                    if (nullable && table.is_null(col, row)) {
+                                        return false;
+                                    }
+                                    key = table.get_int(col, row);
+                                    return true;
+                                },
+                                [&](long long key) { return table.find_first_int(col, key); },
+                                [&](size_t row, long long key) { table.set_int(col, row, key); });
+    }
+}
+
+void RLMAddObjectsToRealm(id<NSFastEnumeration> objects, RLMRealm *realm, bool createOrUpdate) {
+    RLMVerifyInWriteTransaction(realm);
+
+    std::vector<RLMObjectBase *> batch;
+    std::unordered_set<void *> batched;
+    RLMObjectSchema *batchSchema = nil;
+    auto addBatch = [&] {
+        if (!batch.empty()) {
+            if (createOrUpdate) {
+                RLMUpsertObjectsInBatch(batch, batchSchema, realm);
+            }
+            else {
+                RLMInsertObjectsInBatch(batch, batchSchema, realm);
+            }
+        }
+        batch.clear();
+        batched.clear();
+        batchSchema = nil;
+    };
+
+    for (id obj in objects) {
+        if (batched.count((__bridge void *)obj)) {
+            continue;
+        }
+
+        RLMObjectSchema *schema;
+        @try {
+            if (![obj isKindOfClass:[RLMObject class]]) {
+                @throw RLMException(@"Cannot insert objects of type %@ with %@. Only RLMObjects are supported.",
+                                    NSStringFromClass([obj class]),
+                                    createOrUpdate ? @"addOrUpdateObjectsFromArray:" : @"addObjects:");
+            }
+            if (createOrUpdate && ![obj objectSchema].hasPrimaryKey) {
+                @throw RLMException(@"'%@' does not have a primary key and can not be updated", [obj objectSchema].className);
+            }
+            schema = RLMSchemaForAddingObject(obj, realm);
+        }
+        @catch (NSException *) {
+            // the objects before this one are still added, as they would be
+            // if each object was added individually
+            addBatch();
+            @throw;
+        }
+
+        // null primary keys are left to the single object path
+        bool canBatch = schema && (schema == batchSchema || RLMCanAddInBatch(schema, createOrUpdate));
+        if (canBatch && createOrUpdate) {
+            id primaryValue = [obj valueForKey:schema.primaryKeyProperty.getterName];
+            canBatch = primaryValue && primaryValue != NSNull.null;
+        }
+
+        if (canBatch) {
+            if (schema != batchSchema) {
+                addBatch();
+                batchSchema = schema;
+            }
+            batch.push_back(obj);
+            batched.insert((__bridge void *)obj);
+        }
+        else if (schema) {
+            // this object may link to objects in the batch, so they need to
+            // be added first
+            addBatch();
+            RLMAddObjectToRealm(obj, realm, createOrUpdate);
+        }
+    }
+    addBatch();
+}
+
 static void RLMValidateValueForProperty(__unsafe_unretained id const obj,
                                         __unsafe_unretained RLMProperty *const prop,
                                         __unsafe_unretained RLMSchema *const schema,
@@ -345,88 +714,267 @@ static void RLMValidateValueForObjectSchema(__unsafe_unretained id const value,
     }
 }
 
-RLMObjectBase *RLMCreateObjectInRealmWithValue(RLMRealm *realm, NSString *className, id value, bool createOrUpdate = false) {
-    if (createOrUpdate && RLMIsObjectSubclass([value class])) {
-        RLMObjectBase *obj = value;
-        if ([obj->_objectSchema.className isEqualToString:className] && obj->_realm == realm) {
-            // This is a no-op if value is an RLMObject of the same type already backed by the target realm.
-            return value;
+// The objects created so far while copying an object graph into a Realm, keyed
+// by the object they were copied from, so that objects which are referenced
+// more than once in the graph are only copied once and graphs with cycles can
+// be copied
+class RLMCopiedObjects {
+public:
+    // The object which values are being copied from, if it is one which can
+    // be remembered
+    static RLMObjectBase *sourceForValue(__unsafe_unretained RLMRealm *const realm,
+                                         __unsafe_unretained NSString *const className,
+                                         __unsafe_unretained id const value) {
+        RLMObjectBase *source = RLMDynamicCast<RLMObjectBase>(value);
+        if (!source || source->_realm == realm || (source->_realm && !source->_row.is_attached())) {
+            return nil;
         }
+        return [source->_objectSchema.className isEqualToString:className] ? source : nil;
     }
 
-    // verify writable
-    RLMVerifyInWriteTransaction(realm);
+    RLMObjectBase *find(__unsafe_unretained RLMObjectBase *const source) const {
+        auto it = _objects.find(keyFor(source));
+        return it == _objects.end() ? nil : it->second.second;
+    }
 
-    // create the object
-    RLMSchema *schema = realm.schema;
-    RLMObjectSchema *objectSchema = [realm.schema schemaForClassName:className];
-    if (!objectSchema) {
-        @throw RLMException(@"Object type '%@' is not persisted in the Realm. "
-                             @"If using a custom `objectClasses` / `objectTypes` array in your configuration, "
-                             @"add `%@` to the list of `objectClasses` / `objectTypes`.",
-                             className, className);
+    void add(__unsafe_unretained RLMObjectBase *const source, __unsafe_unretained RLMObjectBase *const copy) {
+        _objects[keyFor(source)] = {source, copy};
     }
-    RLMObjectBase *object = [[objectSchema.accessorClass alloc] initWithRealm:realm schema:objectSchema];
 
-    RLMCreationOptions creationOptions = createOrUpdate ? RLMCreationOptionsCreateOrUpdate : RLMCreationOptionsNone;
+private:
+    // Objects from other Realms are identified by their row, as a new
+    // accessor object is created each time a link is read. Standalone objects
+    // are identified by address, and are retained by the map so that the
+    // address can't be reused.
+    struct Key {
+        const void *tableOrObject;
+        size_t row;
+
+        bool operator==(Key const& other) const {
+            return tableOrObject == other.tableOrObject && row == other.row;
+        }
+    };
+    struct KeyHash {
+        size_t operator()(Key const& key) const {
+            return std::hash<const void *>()(key.tableOrObject) ^ key.row;
+        }
+    };
 
-    // create row, and populate
-    if (NSArray *array = RLMDynamicCast<NSArray>(value)) {
-        // get or create our accessor
-        bool created;
-        auto primaryGetter = [=](__unsafe_unretained RLMProperty *const p) { return array[p.column]; };
-        object->_row = (*objectSchema.table)[RLMCreateOrGetRowForObject(objectSchema, primaryGetter, createOrUpdate, created)];
+    static Key keyFor(__unsafe_unretained RLMObjectBase *const source) {
+        if (source->_realm) {
+            return {source->_row.get_table(), source->_row.get_index()};
+        }
+        return {(__bridge const void *)source, realm::npos};
+    }
 
-        // populate
-        NSArray *props = objectSchema.propertiesInDeclaredOrder;
-        for (NSUInteger i = 0; i < array.count; i++) {
-            RLMProperty *prop = props[i];
-            // skip primary key when updating since it doesn't change
-            if (created || !prop.isPrimary) {
-                id val = array[i];
-                RLMValidateValueForProperty(val, prop, schema, false, false);
-                RLMDynamicSet(object, prop, RLMCoerceToNil(val), creationOptions);
-            }
+    std::unordered_map<Key, std::pair<RLMObjectBase *, RLMObjectBase *>, KeyHash> _objects;
+};
+
+namespace {
+// Makes the outermost create call on a Realm keep track of the objects copied
+// by it and by the nested create calls for its links
+class RLMCopiedObjectsScope {
+public:
+    RLMCopiedObjectsScope(RLMRealm *realm) : _realm(realm), _outermost(!realm->_copiedObjects) {
+        if (_outermost) {
+            realm->_copiedObjects = &_objects;
         }
     }
-    else {
-        // get or create our accessor
-        bool created;
-        auto primaryGetter = [=](RLMProperty *p) { return [value valueForKey:p.name]; };
-        object->_row = (*objectSchema.table)[RLMCreateOrGetRowForObject(objectSchema, primaryGetter, createOrUpdate, created)];
-
-        // populate
-        NSDictionary *defaultValues = nil;
-        for (RLMProperty *prop in objectSchema.properties) {
-            id propValue = RLMValidatedValueForProperty(value, prop.name, objectSchema.className);
-
-            if (!propValue && created) {
-                if (!defaultValues) {
-                    defaultValues = RLMDefaultValuesForObjectSchema(objectSchema);
-                }
-                propValue = defaultValues[prop.name];
-                if (!propValue && (prop.type == RLMPropertyTypeObject || prop.type == RLMPropertyTypeArray)) {
-                    propValue = NSNull.null;
-                }
-            }
 
-            if (propValue) {
+    ~RLMCopiedObjectsScope() {
+        if (_outermost) {
+            _realm->_copiedObjects = nullptr;
+        }
+    }
+
+    RLMCopiedObjects *get() const {
+        return _realm->_copiedObjects;
+    }
+
+private:
+    RLMRealm *_realm;
+    bool _outermost;
+    RLMCopiedObjects _objects;
+};
+
+// Creates or updates the rows for values of a single object type, with the
+// schema lookups which only depend on the type done up front rather than for
+// each value
+class RLMObjectCreator {
+public:
+    RLMObjectCreator(RLMRealm *realm, NSString *className, bool createOrUpdate)
+    : RLMObjectCreator(realm, RLMObjectSchemaForCreating(realm, className), createOrUpdate)
+    {
+    }
+
+    RLMObjectCreator(RLMRealm *realm, RLMObjectSchema *objectSchema, bool createOrUpdate)
+    : _realm(realm)
+    , _schema(realm.schema)
+    , _objectSchema(objectSchema)
+    , _createOrUpdate(createOrUpdate)
+    , _creationOptions(createOrUpdate ? RLMCreationOptionsCreateOrUpdate : RLMCreationOptionsNone)
+    {
+        _table = _objectSchema.table;
+        _propertiesInDeclaredOrder = _objectSchema.propertiesInDeclaredOrder;
+        _properties = _objectSchema.properties;
+    }
+
+    // This is a no-op if the value is an RLMObject of the same type already
+    // backed by the target realm
+    bool isNoOp(__unsafe_unretained id const value) const {
+        if (!_createOrUpdate || !RLMIsObjectSubclass([value class])) {
+            return false;
+        }
+        RLMObjectBase *obj = value;
+        return obj->_realm == _realm && [obj->_objectSchema.className isEqualToString:_objectSchema.className];
+    }
+
+    RLMObjectBase *newAccessor() const {
+        return [[_objectSchema.accessorClass alloc] initWithRealm:_realm schema:_objectSchema];
+    }
+
+    // Create or update the row for the value, and point the accessor at it.
+    // If copiedObjects is given, the value is an object which is remembered
+    // as having been copied to the accessor before its links are copied.
+    void populate(__unsafe_unretained RLMObjectBase *const object, __unsafe_unretained id const value,
+                  RLMCopiedObjects *copiedObjects = nullptr) {
+        if (NSArray *array = RLMDynamicCast<NSArray>(value)) {
+            // get or create our accessor
+            bool created;
+            auto primaryGetter = [=](__unsafe_unretained RLMProperty *const p) { return array[p.column]; };
+            object->_row = (*_table)[RLMCreateOrGetRowForObject(_objectSchema, primaryGetter, _createOrUpdate, created)];
+            RLMDidAttachAccessor(_realm, object);
+
+            // populate
+            for (NSUInteger i = 0; i < array.count; i++) {
+                RLMProperty *prop = _propertiesInDeclaredOrder[i];
+                // skip primary key when updating since it doesn't change
                 if (created || !prop.isPrimary) {
-                    // skip missing properties and primary key when updating since it doesn't change
-                    RLMValidateValueForProperty(propValue, prop, schema, false, false);
-                    RLMDynamicSet(object, prop, RLMCoerceToNil(propValue), creationOptions);
+                    id val = array[i];
+                    RLMValidateValueForProperty(val, prop, _schema, false, false);
+                    RLMDynamicSet(object, prop, RLMCoerceToNil(val), _creationOptions);
                 }
             }
-            else if (created && !prop.optional) {
-                @throw RLMException(@"Property '%@' of object of type '%@' cannot be nil.", prop.name, objectSchema.className);
+        }
+        else {
+            // get or create our accessor
+            bool created;
+            auto primaryGetter = [=](RLMProperty *p) { return [value valueForKey:p.name]; };
+            object->_row = (*_table)[RLMCreateOrGetRowForObject(_objectSchema, primaryGetter, _createOrUpdate, created)];
+            RLMDidAttachAccessor(_realm, object);
+            if (copiedObjects) {
+                copiedObjects->add(value, object);
             }
+
+            // populate
+            for (RLMProperty *prop in _properties) {
+                id propValue = RLMValidatedValueForProperty(value, prop.name, _objectSchema.className);
+
+                if (!propValue && created) {
+                    if (!_defaultValues) {
+                        _defaultValues = RLMDefaultValuesForObjectSchema(_objectSchema);
+                    }
+                    propValue = _defaultValues[prop.name];
+                    if (!propValue && (prop.type == RLMPropertyTypeObject || prop.type == RLMPropertyTypeArray)) {
+                        propValue = NSNull.null;
+                    }
+                }
+
+                if (propValue) {
+                    if (created || !prop.isPrimary) {
+                        // skip missing properties and primary key when updating since it doesn't change
+                        RLMValidateValueForProperty(propValue, prop, _schema, false, false);
+                        RLMDynamicSet(object, prop, RLMCoerceToNil(propValue), _creationOptions);
+                    }
+                }
+                else if (created && !prop.optional) {
+                    @throw RLMException(@"Property '%@' of object of type '%@' cannot be nil.", prop.name, _objectSchema.className);
+                }
+            }
+        }
+    }
+
+private:
+    RLMRealm *_realm;
+    RLMSchema *_schema;
+    RLMObjectSchema *_objectSchema;
+    Table *_table;
+    NSArray *_propertiesInDeclaredOrder;
+    NSArray *_properties;
+    NSDictionary *_defaultValues;
+    bool _createOrUpdate;
+    RLMCreationOptions _creationOptions;
+};
+}
+
+static RLMObjectBase *RLMCreateObject(RLMRealm *realm, RLMObjectSchema *objectSchema, id value, bool createOrUpdate) {
+    // objects which have already been copied by this call are reused
+    RLMCopiedObjectsScope copiedObjects(realm);
+    RLMObjectBase *source = RLMCopiedObjects::sourceForValue(realm, objectSchema.className, value);
+    if (source) {
+        if (RLMObjectBase *copy = copiedObjects.get()->find(source)) {
+            return copy;
         }
     }
 
+    // create the object
+    RLMObjectCreator creator(realm, objectSchema, createOrUpdate);
+    RLMObjectBase *object = creator.newAccessor();
+    creator.populate(object, value, source ? copiedObjects.get() : nullptr);
+
     RLMInitializeSwiftAccessorGenerics(object);
     return object;
 }
 
+RLMObjectBase *RLMCreateObjectInRealmWithValue(RLMRealm *realm, NSString *className, id value, bool createOrUpdate = false) {
+    if (createOrUpdate && RLMIsObjectSubclass([value class])) {
+        RLMObjectBase *obj = value;
+        if ([obj->_objectSchema.className isEqualToString:className] && obj->_realm == realm) {
+            // This is a no-op if value is an RLMObject of the same type already backed by the target realm.
+            return value;
+        }
+    }
+
+    // verify writable
+    RLMVerifyInWriteTransaction(realm);
+
+    return RLMCreateObject(realm, RLMObjectSchemaForCreating(realm, className), value, createOrUpdate);
+}
+
+RLMObjectBase *RLMCreateObjectInRealmWithValue(RLMRealm *realm, Class objectClass, id value, bool createOrUpdate) {
+    if (createOrUpdate && RLMIsObjectSubclass([value class])) {
+        // rare enough that the class name being looked up again doesn't matter
+        return RLMCreateObjectInRealmWithValue(realm, [objectClass className], value, createOrUpdate);
+    }
+
+    RLMVerifyInWriteTransaction(realm);
+
+    RLMObjectSchema *objectSchema = RLMObjectSchemaForClass(realm, objectClass);
+    if (!objectSchema) {
+        objectSchema = RLMObjectSchemaForCreating(realm, [objectClass className]);
+    }
+    return RLMCreateObject(realm, objectSchema, value, createOrUpdate);
+}
+
+void RLMCreateObjectsInRealmWithValues(RLMRealm *realm, NSString *className, id<NSFastEnumeration> values, bool createOrUpdate) {
+    RLMVerifyInWriteTransaction(realm);
+
+    RLMObjectCreator creator(realm, className, createOrUpdate);
+    // the accessor is only used to write each row, so a single one is reused
+    // for all of the values
+    RLMObjectBase *object = creator.newAccessor();
+    for (id value in values) {
+        @autoreleasepool {
+            if (!creator.isNoOp(value)) {
+                // each value is copied as if it was created on its own
+                RLMCopiedObjectsScope copiedObjects(realm);
+                bool remember = RLMCopiedObjects::sourceForValue(realm, className, value) != nil;
+                creator.populate(object, value, remember ? copiedObjects.get() : nullptr);
+            }
+        }
+    }
+}
+
 void RLMDeleteObjectFromRealm(__unsafe_unretained RLMObjectBase *const object,
                               __unsafe_unretained RLMRealm *const realm) {
     if (realm != object->_realm) {
@@ -446,6 +994,56 @@ void RLMDeleteObjectFromRealm(__unsafe_unretained RLMObjectBase *const object,
     object->_realm = nil;
 }
 
+void RLMDeleteObjectsFromRealm(id<NSFastEnumeration> objects, __unsafe_unretained RLMRealm *const realm) {
+    // rows to delete, grouped by table
+    std::unordered_map<realm::Table *, std::vector<size_t>> rows;
+    auto deleteRows = [&] {
+        if (rows.empty()) {
+            return;
+        }
+        for (auto& tableRows : rows) {
+            auto& indexes = tableRows.second;
+            std::sort(indexes.begin(), indexes.end(), std::greater<size_t>());
+            indexes.erase(std::unique(indexes.begin(), indexes.end()), indexes.end());
+        }
+
+        auto tables = &rows;
+        RLMTrackDeletions(realm, ^{
+            // deleting from the end first means the row moved into each
+            // deleted row's place is never one which still needs deleting
+            for (auto const& tableRows : *tables) {
+                for (size_t row : tableRows.second) {
+                    tableRows.first->move_last_over(row);
+                }
+            }
+        });
+        rows.clear();
+    };
+
+    for (id obj in objects) {
+        if (![obj isKindOfClass:RLMObjectBase.class]) {
+            continue;
+        }
+
+        RLMObjectBase *object = obj;
+        if (realm != object->_realm) {
+            // delete the objects before this one as they would be if each
+            // object was deleted individually
+            deleteRows();
+            @throw RLMException(@"Can only delete an object from the Realm it belongs to.");
+        }
+        RLMVerifyInWriteTransaction(realm);
+
+        if (object->_row.is_attached()) {
+            rows[object->_row.get_table()].push_back(object->_row.get_index());
+        }
+
+        // set realm to nil
+        object->_realm = nil;
+    }
+    deleteRows();
+}
+
 void RLMDeleteAllObjectsFromRealm(RLMRealm *realm) {
     RLMVerifyInWriteTransaction(realm);
 
@@ -455,11 +1053,8 @@ void RLMDeleteAllObjectsFromRealm(RLMRealm *realm) {
     }
 }
 
-RLMResults *RLMGetObjects(RLMRealm *realm, NSString *objectClassName, NSPredicate *predicate) {
-    RLMVerifyRealmRead(realm);
-
+static RLMResults *RLMGetObjects(RLMRealm *realm, RLMObjectSchema *objectSchema, NSPredicate *predicate) {
     // create view from table and predicate
-    RLMObjectSchema *objectSchema = realm.schema[objectClassName];
     if (!objectSchema.table) {
         // read-only realms may be missing tables since we can't add any
         // missing ones on init
@@ -471,22 +1066,31 @@ RLMResults *RLMGetObjects(RLMRealm *realm, NSString *objectClassName, NSPredicat
         RLMUpdateQueryWithPredicate(&query, predicate, realm.schema, objectSchema);
 
         // create and populate array
-        return [RLMResults resultsWithObjectSchema:objectSchema
-                                           results:realm::Results(realm->_realm, std::move(query))];
+        realm::Results results(realm->_realm, std::move(query));
+        results.set_query_description(RLMPredicateDescriptionFunction(predicate, objectSchema));
+        results.set_query_conditions(RLMPredicateConditionsFunction(predicate, objectSchema));
+        return [RLMResults resultsWithObjectSchema:objectSchema results:std::move(results)];
     }
 
     return [RLMResults resultsWithObjectSchema:objectSchema
                                        results:realm::Results(realm->_realm, *objectSchema.table)];
 }
 
-id RLMGetObject(RLMRealm *realm, NSString *objectClassName, id key) {
+RLMResults *RLMGetObjects(RLMRealm *realm, NSString *objectClassName, NSPredicate *predicate) {
     RLMVerifyRealmRead(realm);
+    return RLMGetObjects(realm, realm.schema[objectClassName], predicate);
+}
 
-    RLMObjectSchema *objectSchema = realm.schema[objectClassName];
+RLMResults *RLMGetObjects(RLMRealm *realm, Class objectClass, NSPredicate *predicate) {
+    RLMVerifyRealmRead(realm);
+    RLMObjectSchema *objectSchema = RLMObjectSchemaForClass(realm, objectClass);
+    return RLMGetObjects(realm, objectSchema ?: realm.schema[[objectClass className]], predicate);
+}
 
+static id RLMGetObject(RLMRealm *realm, RLMObjectSchema *objectSchema, id key) {
     RLMProperty *primaryProperty = objectSchema.primaryKeyProperty;
     if (!primaryProperty) {
-        @throw RLMException(@"%@ does not have a primary key", objectClassName);
+        @throw RLMException(@"%@ does not have a primary key", objectSchema.className);
     }
 
     if (!objectSchema.table) {
@@ -500,8 +1104,11 @@ id RLMGetObject(RLMRealm *realm, NSString *objectClassName, id key) {
     size_t row = realm::not_found;
     if (primaryProperty.type == RLMPropertyTypeString) {
         NSString *str = RLMDynamicCast<NSString>(key);
-        if (str || (!key && primaryProperty.optional)) {
-            row = objectSchema.table->find_first_string(primaryProperty.column, RLMStringDataWithNSString(str));
+        if (str) {
+            row = realm->_realm->find_by_primary_key(*objectSchema.table, primaryProperty.column, RLMStringDataWithNSString(str));
+        }
+        else if (!key && primaryProperty.optional) {
+            row = objectSchema.table->find_first_string(primaryProperty.column, realm::StringData());
         }
         else {
             @throw RLMException(@"Invalid value '%@' for primary key", key);
@@ -510,7 +1117,7 @@ id RLMGetObject(RLMRealm *realm, NSString *objectClassName, id key) {
     else {
         NSNumber *number = RLMDynamicCast<NSNumber>(key);
         if (number) {
-            row = objectSchema.table->find_first_int(primaryProperty.column, number.longLongValue);
+            row = realm->_realm->find_by_primary_key(*objectSchema.table, primaryProperty.column, number.longLongValue);
         }
         else if (!key && primaryProperty.optional) {
             row = objectSchema.table->find_first_null(primaryProperty.column);
@@ -527,6 +1134,17 @@ id RLMGetObject(RLMRealm *realm, NSString *objectClassName, id key) {
     return RLMCreateObjectAccessor(realm, objectSchema, row);
 }
 
+id RLMGetObject(RLMRealm *realm, NSString *objectClassName, id key) {
+    RLMVerifyRealmRead(realm);
+    return RLMGetObject(realm, realm.schema[objectClassName], key);
+}
+
+id RLMGetObject(RLMRealm *realm, Class objectClass, id key) {
+    RLMVerifyRealmRead(realm);
+    RLMObjectSchema *objectSchema = RLMObjectSchemaForClass(realm, objectClass);
+    return RLMGetObject(realm, objectSchema ?: realm.schema[[objectClass className]], key);
+}
+
 RLMObjectBase *RLMCreateObjectAccessor(__unsafe_unretained RLMRealm *const realm,
                                        __unsafe_unretained RLMObjectSchema *const objectSchema,
                                        NSUInteger index) {
@@ -537,8 +1155,17 @@ RLMObjectBase *RLMCreateObjectAccessor(__unsafe_unretained RLMRealm *const realm
 RLMObjectBase *RLMCreateObjectAccessor(__unsafe_unretained RLMRealm *const realm,
                                        __unsafe_unretained RLMObjectSchema *const objectSchema,
                                        realm::RowExpr row) {
+    if (auto& identityMap = realm->_accessorIdentityMap) {
+        if (RLMObjectBase *existing = identityMap->get(*realm->_realm, objectSchema, row.get_table(), row.get_index())) {
+            realm->_realm->record_access(*row.get_table(), row.get_index());
+            return existing;
+        }
+    }
+
     RLMObjectBase *accessor = [[objectSchema.accessorClass alloc] initWithRealm:realm schema:objectSchema];
     accessor->_row = row;
     RLMInitializeSwiftAccessorGenerics(accessor);
+    ++realm->_realm->metrics().accessors_created;
+    RLMDidAttachAccessor(realm, accessor);
     return accessor;
 }
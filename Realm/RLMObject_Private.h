@@ -55,6 +55,9 @@ FOUNDATION_EXTERN RLMObjectSchema *RLMObjectBaseObjectSchema(RLMObjectBase *obje
 // Get linking objects for an RLMObjectBase
 FOUNDATION_EXTERN NSArray *RLMObjectBaseLinkingObjectsOfClass(RLMObjectBase *object, NSString *className, NSString *property);
 
+// Register a block to be called once per refresh with all of the changed properties of the object
+FOUNDATION_EXTERN RLMNotificationToken *RLMObjectBaseAddNotificationBlock(RLMObjectBase *object, RLMObjectNotificationBlock block);
+
 // Dynamic access to RLMObjectBase properties
 FOUNDATION_EXTERN id RLMObjectBaseObjectForKeyedSubscript(RLMObjectBase *object, NSString *key);
 FOUNDATION_EXTERN void RLMObjectBaseSetObjectForKeyedSubscript(RLMObjectBase *object, NSString *key, id obj);
@@ -75,6 +78,12 @@ FOUNDATION_EXTERN const NSUInteger RLMDescriptionMaxDepth;
 
 + (NSArray RLM_GENERIC(NSString *) *)ignoredPropertiesForClass:(Class)cls;
 + (NSArray RLM_GENERIC(NSString *) *)indexedPropertiesForClass:(Class)cls;
++ (NSArray RLM_GENERIC(NSString *) *)textIndexedPropertiesForClass:(Class)cls;
++ (NSArray RLM_GENERIC(NSString *) *)cachedAggregatePropertiesForClass:(Class)cls;
++ (NSArray RLM_GENERIC(NSArray RLM_GENERIC(NSString *) *) *)compoundIndexesForClass:(Class)cls;
++ (NSArray RLM_GENERIC(NSString *) *)compoundPrimaryKeyForClass:(Class)cls;
++ (NSString *)timeToLivePropertyForClass:(Class)cls;
++ (NSTimeInterval)timeToLiveForClass:(Class)cls;
 
 + (NSArray RLM_GENERIC(NSString *) *)getGenericListPropertyNames:(id)obj;
 + (void)initializeListProperty:(RLMObjectBase *)object property:(RLMProperty *)property array:(RLMArray *)array;
@@ -23,6 +23,8 @@
 #import <realm/link_view.hpp> // required by row.hpp
 #import <realm/row.hpp>
 
+#import <vector>
+
 class RLMObservationInfo;
 
 // RLMObject accessor and read/write realm
@@ -30,9 +32,24 @@ class RLMObservationInfo;
     @public
     realm::Row _row;
     std::unique_ptr<RLMObservationInfo> _observationInfo;
+    // Accessors for linked objects created ahead of time by enumerating an
+    // RLMResults with prefetched key paths, keyed by link column
+    std::vector<std::pair<size_t, RLMObjectBase *>> _prefetchedLinks;
 }
 @end
 
+// Get the prefetched accessor for the link in the given column if it's still
+// for the row at `index`, or nil if there isn't one
+static inline RLMObjectBase *RLMPrefetchedLink(__unsafe_unretained RLMObjectBase *const obj, size_t col, size_t index) {
+    for (auto const& link : obj->_prefetchedLinks) {
+        if (link.first == col) {
+            RLMObjectBase *accessor = link.second;
+            return accessor->_row.is_attached() && accessor->_row.get_index() == index ? accessor : nil;
+        }
+    }
+    return nil;
+}
+
 // throw an exception if the object is invalidated or on the wrong thread
 static inline void RLMVerifyAttached(__unsafe_unretained RLMObjectBase *const obj) {
     if (!obj->_row.is_attached()) {
@@ -49,4 +66,5 @@ static inline void RLMVerifyInWriteTransaction(__unsafe_unretained RLMObjectBase
     if (!obj->_realm.inWriteTransaction) {
         @throw RLMException(@"Attempting to modify object outside of a write transaction - call beginWriteTransaction on an RLMRealm instance first.");
     }
+    [obj->_realm detachAllEnumerators];
 }
@@ -51,6 +51,12 @@ public:
     RLMObservationInfo(RLMObjectSchema *objectSchema, std::size_t row, id object);
     ~RLMObservationInfo();
 
+    // Infos are allocated from shared fixed-size slabs rather than
+    // individually, as binding large numbers of objects creates and destroys
+    // them in bulk
+    static void *operator new(size_t size);
+    static void operator delete(void *ptr, size_t size) noexcept;
+
     realm::Row const& getRow() const {
         return row;
     }
@@ -72,6 +78,17 @@ public:
     void removeObserver();
     bool hasObservers() const { return observerCount > 0; }
 
+    // Blocks registered with -[RLMObject addNotificationBlock:], which are
+    // called once per refresh with all of the changed properties rather than
+    // once per property like KVO
+    void addChangeBlock(realm::Row& row, RLMObjectSchema *objectSchema, void (^block)(NSArray *, BOOL));
+    void removeChangeBlock(id block);
+
+    // Call the change blocks of all of the infos for this row, returning
+    // immediately if there are none. Must be called on the head of the linked list.
+    template<typename GetChangedProperties>
+    void notifyChangeBlocks(GetChangedProperties&& getChangedProperties, bool deleted) const;
+
     // valueForKey: on observed object and array properties needs to return the
     // same object each time for KVO to work at all. Doing this all the time
     // requires some odd semantics to avoid reference cycles, so instead we do
@@ -112,12 +129,20 @@ private:
 
     void setRow(realm::Table &table, size_t newRow);
 
+    // blocks registered with addChangeBlock()
+    NSMutableArray *changeBlocks;
+
+    // Infos which only have change blocks don't send KVO notifications
+    bool sendsKVO() const { return observerCount > 0 || changeBlocks.count == 0; }
+
     template<typename F>
     void forEach(F&& f) const {
         for (auto info = prev; info; info = info->prev)
-            f(info->object);
+            if (info->sendsKVO())
+                f(info->object);
         for (auto info = this; info; info = info->next)
-            f(info->object);
+            if (info->sendsKVO())
+                f(info->object);
     }
 
     // Default move/copy constructors don't work due to the intrusive linked
@@ -132,6 +157,28 @@ public:
     void *kvoInfo = nullptr;
 };
 
+template<typename GetChangedProperties>
+void RLMObservationInfo::notifyChangeBlocks(GetChangedProperties&& getChangedProperties, bool deleted) const {
+    NSArray *changedProperties = nil;
+    bool haveChangedProperties = deleted;
+    for (auto info = this; info; info = info->next) {
+        if (info->changeBlocks.count == 0) {
+            continue;
+        }
+        if (!haveChangedProperties) {
+            changedProperties = getChangedProperties();
+            haveChangedProperties = true;
+        }
+        if (!deleted && !changedProperties) {
+            return;
+        }
+        // Copy the array so that blocks can remove themselves
+        for (void (^block)(NSArray *, BOOL) in [info->changeBlocks copy]) {
+            block(changedProperties, deleted);
+        }
+    }
+}
+
 // Get the the observation info chain for the given row
 // Will simply return info if it's non-null, and will search ojectSchema's array
 // for a matching one otherwise, and return null if there are none
@@ -144,5 +191,12 @@ void RLMClearTable(RLMObjectSchema *realm);
 void RLMTrackDeletions(RLMRealm *realm, dispatch_block_t block);
 
 std::vector<realm::BindingContext::ObserverState> RLMGetObservedRows(NSArray RLM_GENERIC(RLMObjectSchema *) *schema);
+// Bring a list previously returned by RLMGetObservedRows() up to date. The list
+// is only rebuilt if objects have started or stopped being observed since it
+// was last updated (or if rebuild is true); otherwise just the row indexes are
+// refreshed.
+void RLMUpdateObservedRows(NSArray RLM_GENERIC(RLMObjectSchema *) *schema,
+                           std::vector<realm::BindingContext::ObserverState>& observers,
+                           bool rebuild=false);
 void RLMWillChange(std::vector<realm::BindingContext::ObserverState> const& observed, std::vector<void *> const& invalidated);
 void RLMDidChange(std::vector<realm::BindingContext::ObserverState> const& observed, std::vector<void *> const& invalidated);
@@ -28,6 +28,13 @@
 
 #import <realm/lang_bind_helper.hpp>
 
+#import <map>
+#import <memory>
+#import <mutex>
+#import <unordered_map>
+#import <unordered_set>
+#import <vector>
+
 using namespace realm;
 
 namespace {
@@ -51,6 +58,73 @@ namespace {
     }
 }
 
+namespace {
+// Fixed-size slab allocator for RLMObservationInfo. Freed infos are kept on a
+// free list for reuse rather than returned to malloc, and the slabs are never
+// released. Standalone objects can be deallocated on any thread, so this
+// needs a lock.
+class ObservationInfoPool {
+public:
+    void *allocate() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_free) {
+            auto slab = std::make_unique<Slot[]>(s_slab_size);
+            for (size_t i = s_slab_size; i > 0; --i) {
+                slab[i - 1].next = m_free;
+                m_free = &slab[i - 1];
+            }
+            m_slabs.push_back(std::move(slab));
+        }
+        Slot *slot = m_free;
+        m_free = slot->next;
+        return slot;
+    }
+
+    void deallocate(void *ptr) noexcept {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto slot = static_cast<Slot *>(ptr);
+        slot->next = m_free;
+        m_free = slot;
+    }
+
+    static ObservationInfoPool& shared() {
+        // Intentionally leaked so that infos destroyed during static
+        // destruction don't use a destroyed pool
+        static auto pool = new ObservationInfoPool;
+        return *pool;
+    }
+
+private:
+    union Slot {
+        Slot *next;
+        alignas(RLMObservationInfo) unsigned char storage[sizeof(RLMObservationInfo)];
+    };
+    static const size_t s_slab_size = 128;
+
+    std::mutex m_mutex;
+    Slot *m_free = nullptr;
+    std::vector<std::unique_ptr<Slot[]>> m_slabs;
+};
+}
+
+void *RLMObservationInfo::operator new(size_t size) {
+    if (size != sizeof(RLMObservationInfo)) {
+        return ::operator new(size);
+    }
+    return ObservationInfoPool::shared().allocate();
+}
+
+void RLMObservationInfo::operator delete(void *ptr, size_t size) noexcept {
+    if (!ptr) {
+        return;
+    }
+    if (size != sizeof(RLMObservationInfo)) {
+        ::operator delete(ptr);
+        return;
+    }
+    ObservationInfoPool::shared().deallocate(ptr);
+}
+
 RLMObservationInfo::RLMObservationInfo(RLMObjectSchema *objectSchema, std::size_t row, id object)
 : object(object)
 , objectSchema(objectSchema)
@@ -89,6 +163,7 @@ RLMObservationInfo::~RLMObservationInfo() {
                 iter_swap(it, std::prev(end));
                 objectSchema->_observedObjects.pop_back();
             }
+            objectSchema->_observedObjectsChanged = true;
         }
     }
     // Otherwise the observed object was standalone, so nothing to do
@@ -149,6 +224,7 @@ void RLMObservationInfo::setRow(realm::Table &table, size_t newRow) {
         }
     }
     objectSchema->_observedObjects.push_back(this);
+    objectSchema->_observedObjectsChanged = true;
 }
 
 void RLMObservationInfo::recordObserver(realm::Row& objectRow,
@@ -194,6 +270,23 @@ void RLMObservationInfo::removeObserver() {
     --observerCount;
 }
 
+void RLMObservationInfo::addChangeBlock(realm::Row& objectRow,
+                                        __unsafe_unretained RLMObjectSchema *const objectSchema,
+                                        void (^block)(NSArray *, BOOL)) {
+    if (!row) {
+        this->objectSchema = objectSchema;
+        setRow(*objectRow.get_table(), objectRow.get_index());
+    }
+    if (!changeBlocks) {
+        changeBlocks = [NSMutableArray new];
+    }
+    [changeBlocks addObject:block];
+}
+
+void RLMObservationInfo::removeChangeBlock(__unsafe_unretained id const block) {
+    [changeBlocks removeObjectIdenticalTo:block];
+}
+
 id RLMObservationInfo::valueForKey(NSString *key) {
     if (invalidated) {
         if ([key isEqualToString:RLMInvalidatedKey]) {
@@ -284,9 +377,12 @@ void RLMClearTable(RLMObjectSchema *objectSchema) {
     }
 
     objectSchema->_observedObjects.clear();
+    objectSchema->_observedObjectsChanged = true;
 }
 
 void RLMTrackDeletions(__unsafe_unretained RLMRealm *const realm, dispatch_block_t block) {
+    [realm detachAllEnumerators];
+
     std::vector<std::vector<RLMObservationInfo *> *> observers;
 
     // Build up an array of observation info arrays which is indexed by table
@@ -320,59 +416,81 @@ void RLMTrackDeletions(__unsafe_unretained RLMRealm *const realm, dispatch_block
     // This callback is called by core with a list of row deletions and
     // resulting link nullifications immediately before things are deleted and nullified
     realm.group->set_cascade_notification_handler([&](realm::Group::CascadeNotification const& cs) {
-        for (auto const& link : cs.links) {
-            size_t table_ndx = link.origin_table->get_index_in_group();
-            if (table_ndx >= observers.size() || !observers[table_ndx]) {
-                // The modified table has no observers
+        // Index the observed objects by row so that each deleted row and
+        // nullified link can look up its observer directly. Row accessors are
+        // updated by core as rows move, so this has to be built here, where no
+        // rows have yet been deleted, rather than kept up to date in setRow()
+        std::vector<std::unordered_map<size_t, RLMObservationInfo *>> rows(observers.size());
+        for (size_t i = 0; i < observers.size(); ++i) {
+            if (!observers[i]) {
                 continue;
             }
-
-            for (auto observer : *observers[table_ndx]) {
-                if (!observer->isForRow(link.origin_row_ndx)) {
-                    continue;
-                }
-
-                RLMProperty *prop = observer->getObjectSchema().properties[link.origin_col_ndx];
-                NSString *name = prop.name;
-                if (prop.type != RLMPropertyTypeArray) {
-                    changes.push_back({observer, name});
-                    continue;
+            rows[i].reserve(observers[i]->size());
+            for (auto observer : *observers[i]) {
+                if (observer->getRow().is_attached()) {
+                    rows[i].emplace(observer->getRow().get_index(), observer);
                 }
+            }
+        }
 
-                auto c = find_if(begin(changes), end(changes), [&](auto const& c) {
-                    return c.info == observer && c.property == name;
-                });
-                if (c == end(changes)) {
-                    changes.push_back({observer, name, [NSMutableIndexSet new]});
-                    c = prev(end(changes));
-                }
+        auto find_observer = [&](size_t table_ndx, size_t row_ndx) -> RLMObservationInfo * {
+            if (table_ndx >= rows.size()) {
+                return nullptr;
+            }
+            auto it = rows[table_ndx].find(row_ndx);
+            return it == rows[table_ndx].end() ? nullptr : it->second;
+        };
+
+        // Removed link targets for each (observer, linklist column), so that
+        // each affected LinkView only has to be scanned once
+        struct link_list_change {
+            size_t change_ndx;
+            size_t col;
+            std::unordered_set<size_t> targets;
+        };
+        std::map<std::pair<RLMObservationInfo *, size_t>, link_list_change> link_list_changes;
 
-                // We know what row index is being removed from the LinkView,
-                // but what we actually want is the indexes in the LinkView that
-                // are going away
-                auto linkview = observer->getRow().get_linklist(prop.column);
-                size_t start = 0, index;
-                while ((index = linkview->find(link.old_target_row_ndx, start)) != realm::not_found) {
-                    [c->indexes addIndex:index];
-                    start = index + 1;
-                }
+        for (auto const& link : cs.links) {
+            auto observer = find_observer(link.origin_table->get_index_in_group(), link.origin_row_ndx);
+            if (!observer) {
+                continue;
             }
-        }
 
-        for (auto const& row : cs.rows) {
-            if (row.table_ndx >= observers.size() || !observers[row.table_ndx]) {
-                // The modified table has no observers
+            RLMProperty *prop = observer->getObjectSchema().properties[link.origin_col_ndx];
+            NSString *name = prop.name;
+            if (prop.type != RLMPropertyTypeArray) {
+                changes.push_back({observer, name});
                 continue;
             }
 
-            for (auto observer : *observers[row.table_ndx]) {
-                if (observer->isForRow(row.row_ndx)) {
-                    invalidated.push_back(observer);
-                    break;
+            auto& c = link_list_changes[{observer, link.origin_col_ndx}];
+            if (c.targets.empty()) {
+                c.change_ndx = changes.size();
+                c.col = prop.column;
+                changes.push_back({observer, name, [NSMutableIndexSet new]});
+            }
+            c.targets.insert(link.old_target_row_ndx);
+        }
+
+        // We know what row indexes are being removed from the LinkView, but
+        // what we actually want is the indexes in the LinkView that are going away
+        for (auto const& entry : link_list_changes) {
+            auto const& c = entry.second;
+            auto linkview = entry.first.first->getRow().get_linklist(c.col);
+            NSMutableIndexSet *indexes = changes[c.change_ndx].indexes;
+            for (size_t i = 0, size = linkview->size(); i < size; ++i) {
+                if (c.targets.count(linkview->get(i).get_index())) {
+                    [indexes addIndex:i];
                 }
             }
         }
 
+        for (auto const& row : cs.rows) {
+            if (auto observer = find_observer(row.table_ndx, row.row_ndx)) {
+                invalidated.push_back(observer);
+            }
+        }
+
         // The relative order of these loops is very important
         for (auto info : invalidated) {
             info->willChange(RLMInvalidatedKey);
@@ -400,29 +518,60 @@ void RLMTrackDeletions(__unsafe_unretained RLMRealm *const realm, dispatch_block
 namespace {
 template<typename Func>
 void forEach(realm::BindingContext::ObserverState const& state, Func&& func) {
-    for (size_t i = 0, size = state.changes.size(); i < size; ++i) {
-        if (state.changes[i].changed) {
-            func(i, state.changes[i], static_cast<RLMObservationInfo *>(state.info));
-        }
-    }
+    state.for_each_change([&](size_t i, auto const& change) {
+        func(i, change, static_cast<RLMObservationInfo *>(state.info));
+    });
 }
 }
 
 std::vector<realm::BindingContext::ObserverState> RLMGetObservedRows(NSArray RLM_GENERIC(RLMObjectSchema *) *schema) {
     std::vector<realm::BindingContext::ObserverState> observers;
+    RLMUpdateObservedRows(schema, observers, true);
+    return observers;
+}
+
+void RLMUpdateObservedRows(NSArray RLM_GENERIC(RLMObjectSchema *) *schema,
+                           std::vector<realm::BindingContext::ObserverState>& observers,
+                           bool rebuild) {
+    if (!rebuild) {
+        for (RLMObjectSchema *objectSchema in schema) {
+            if (objectSchema->_observedObjectsChanged) {
+                rebuild = true;
+                break;
+            }
+        }
+    }
+
+    if (!rebuild) {
+        // The set of observed objects is unchanged, so only the row indexes
+        // need to be updated. Row accessors are kept up to date by core when
+        // rows move, and rows which were deleted are dropped.
+        observers.erase(remove_if(begin(observers), end(observers), [](auto& o) {
+            auto const& row = static_cast<RLMObservationInfo *>(o.info)->getRow();
+            if (!row.is_attached()) {
+                return true;
+            }
+            o.row_ndx = row.get_index();
+            return false;
+        }), end(observers));
+        return;
+    }
+
+    observers.clear();
     for (RLMObjectSchema *objectSchema in schema) {
+        objectSchema->_observedObjectsChanged = false;
+        if (objectSchema->_observedObjects.empty()) {
+            continue;
+        }
+        size_t table_ndx = objectSchema.table->get_index_in_group();
+        observers.reserve(observers.size() + objectSchema->_observedObjects.size());
         for (auto info : objectSchema->_observedObjects) {
             auto const& row = info->getRow();
             if (!row.is_attached())
                 continue;
-            observers.push_back({
-                row.get_table()->get_index_in_group(),
-                row.get_index(),
-                info});
+            observers.push_back({table_ndx, row.get_index(), info});
         }
     }
-    sort(begin(observers), end(observers));
-    return observers;
 }
 
 static NSKeyValueChange convert(realm::BindingContext::ColumnInfo::Kind kind) {
@@ -481,4 +630,20 @@ void RLMDidChange(std::vector<realm::BindingContext::ObserverState> const& obser
     for (auto const& info : reverse(invalidated)) {
         static_cast<RLMObservationInfo *>(info)->didChange(RLMInvalidatedKey);
     }
+
+    // Objects observed with notification blocks get a single call with all
+    // of the properties which changed
+    for (auto const& o : observed) {
+        auto info = static_cast<RLMObservationInfo *>(o.info);
+        info->notifyChangeBlocks([&] {
+            NSMutableArray *names = [NSMutableArray new];
+            o.for_each_change([&](size_t i, auto const&) {
+                [names addObject:[info->getObjectSchema().properties[i] name]];
+            });
+            return names.count ? names : nil;
+        }, false);
+    }
+    for (auto const& info : invalidated) {
+        static_cast<RLMObservationInfo *>(info)->notifyChangeBlocks([] { return nil; }, true);
+    }
 }
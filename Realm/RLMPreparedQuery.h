@@ -0,0 +1,104 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#import <Foundation/Foundation.h>
+#import <Realm/RLMDefines.h>
+
+RLM_ASSUME_NONNULL_BEGIN
+
+@class RLMRealm, RLMResults;
+
+/**
+ An RLMPreparedQuery is a predicate which has been validated and converted for
+ a specific object type once, so that it can be run many times with different
+ values for its substitution variables without the overhead of processing the
+ predicate each time.
+
+     NSPredicate *predicate = [NSPredicate predicateWithFormat:@"age > $minAge AND name BEGINSWITH $prefix"];
+     RLMPreparedQuery *query = [RLMPreparedQuery preparedQueryWithObjectClassName:@"Person"
+                                                                        predicate:predicate
+                                                                          inRealm:realm];
+     RLMResults *results = [query objectsWithSubstitutionVariables:@{@"minAge": @18, @"prefix": @"J"}];
+
+ Like RLMRealm, an RLMPreparedQuery can only be used on the thread it was
+ created on.
+ */
+@interface RLMPreparedQuery : NSObject
+
+/**
+ The Realm this query retrieves objects from.
+ */
+@property (nonatomic, readonly) RLMRealm *realm;
+
+/**
+ The class name (i.e. type) of the objects this query retrieves.
+ */
+@property (nonatomic, readonly, copy) NSString *objectClassName;
+
+/**
+ The predicate, possibly containing substitution variables, used by this query.
+ */
+@property (nonatomic, readonly) NSPredicate *predicate;
+
+/**
+ Prepares a query for the objects of the given type in the given Realm.
+
+ Key paths in the predicate are validated immediately, and an exception is
+ thrown if any are invalid. Values for substitution variables are validated
+ when the query is run.
+
+ @param objectClassName The class name of the objects to query.
+ @param predicate       The predicate to filter the objects with, using `$name`
+                        substitution variables for the values which change
+                        between runs.
+ @param realm           The Realm to query.
+
+ @return A prepared query.
+ */
++ (instancetype)preparedQueryWithObjectClassName:(NSString *)objectClassName
+                                       predicate:(NSPredicate *)predicate
+                                         inRealm:(RLMRealm *)realm;
+
+/**
+ Get the objects matching the predicate with the given values for its
+ substitution variables.
+
+ @param variables   A dictionary with a value for each substitution variable
+                    in the predicate. May be `nil` if there are none.
+
+ @return An RLMResults of the objects matching the predicate.
+ */
+- (RLMResults *)objectsWithSubstitutionVariables:(nullable NSDictionary *)variables;
+
+#pragma mark - Unavailable Methods
+
+/**
+ -[RLMPreparedQuery init] is not available because an RLMPreparedQuery must
+ be created for a specific Realm and object type.
+ */
+- (instancetype)init __attribute__((unavailable("Use +preparedQueryWithObjectClassName:predicate:inRealm:")));
+
+/**
+ +[RLMPreparedQuery new] is not available because an RLMPreparedQuery must
+ be created for a specific Realm and object type.
+ */
++ (instancetype)new __attribute__((unavailable("Use +preparedQueryWithObjectClassName:predicate:inRealm:")));
+
+@end
+
+RLM_ASSUME_NONNULL_END
@@ -0,0 +1,77 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#import "RLMPreparedQuery.h"
+
+#import "RLMArray_Private.hpp"
+#import "RLMObjectSchema_Private.hpp"
+#import "RLMQueryUtil.hpp"
+#import "RLMRealm_Private.hpp"
+#import "RLMSchema_Private.h"
+#import "RLMUtil.hpp"
+
+#import "results.hpp"
+
+@implementation RLMPreparedQuery {
+    RLMObjectSchema *_objectSchema;
+    RLMCompiledPredicate _compiledPredicate;
+}
+
++ (instancetype)preparedQueryWithObjectClassName:(NSString *)objectClassName
+                                       predicate:(NSPredicate *)predicate
+                                         inRealm:(RLMRealm *)realm {
+    return [[self alloc] initWithObjectClassName:objectClassName predicate:predicate realm:realm];
+}
+
+- (instancetype)initWithObjectClassName:(NSString *)objectClassName
+                              predicate:(NSPredicate *)predicate
+                                  realm:(RLMRealm *)realm {
+    if (!realm) {
+        @throw RLMException(@"Realm must not be nil");
+    }
+    [realm verifyThread];
+
+    self = [super init];
+    if (self) {
+        _realm = realm;
+        _objectClassName = [objectClassName copy];
+        _predicate = predicate;
+        _objectSchema = realm.schema[objectClassName];
+        _compiledPredicate = RLMCompilePredicate(predicate, realm.schema, _objectSchema);
+    }
+    return self;
+}
+
+- (RLMResults *)objectsWithSubstitutionVariables:(NSDictionary *)variables {
+    [_realm verifyThread];
+
+    if (!_objectSchema.table) {
+        // read-only realms may be missing tables since we can't add any
+        // missing ones on init
+        return [RLMResults resultsWithObjectSchema:_objectSchema results:{}];
+    }
+
+    realm::Query query = _objectSchema.table->where();
+    RLMUpdateQueryWithCompiledPredicate(&query, _compiledPredicate, variables);
+    realm::Results results(_realm->_realm, std::move(query));
+    results.set_query_description(RLMPredicateDescriptionFunction(_predicate, _objectSchema));
+    results.set_query_conditions(RLMPredicateConditionsFunction(_predicate, _objectSchema));
+    return [RLMResults resultsWithObjectSchema:_objectSchema results:std::move(results)];
+}
+
+@end
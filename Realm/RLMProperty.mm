@@ -407,6 +407,9 @@ BOOL RLMPropertyTypeIsNumeric(RLMPropertyType propertyType) {
     prop->_getterSel = _getterSel;
     prop->_setterSel = _setterSel;
     prop->_isPrimary = _isPrimary;
+    prop->_textIndexed = _textIndexed;
+    prop->_cachedAggregates = _cachedAggregates;
+    prop->_inCompoundPrimaryKey = _inCompoundPrimaryKey;
     prop->_swiftIvar = _swiftIvar;
     prop->_optional = _optional;
     prop->_declarationIndex = _declarationIndex;
@@ -57,6 +57,9 @@ FOUNDATION_EXTERN BOOL RLMPropertyTypeIsNumeric(RLMPropertyType propertyType);
 @property (nonatomic, assign) char objcType;
 @property (nonatomic, copy) NSString *objcRawType;
 @property (nonatomic, assign) BOOL isPrimary;
+@property (nonatomic, assign) BOOL textIndexed;
+@property (nonatomic, assign) BOOL cachedAggregates;
+@property (nonatomic, assign) BOOL inCompoundPrimaryKey;
 @property (nonatomic, assign) Ivar swiftIvar;
 @property (nonatomic, assign) NSUInteger declarationIndex;
 
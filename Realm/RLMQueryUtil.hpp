@@ -17,6 +17,10 @@
 ////////////////////////////////////////////////////////////////////////////
 
 #import <Foundation/Foundation.h>
+#import "query_workload.hpp"
+
+#import <functional>
+#import <string>
 #import <vector>
 
 namespace realm {
@@ -26,6 +30,7 @@ namespace realm {
     class TableView;
 }
 
+@class RLMObjectBase;
 @class RLMObjectSchema;
 @class RLMProperty;
 @class RLMSchema;
@@ -37,6 +42,47 @@ extern NSString * const RLMUnsupportedTypesFoundInPropertyComparisonException;
 void RLMUpdateQueryWithPredicate(realm::Query *query, NSPredicate *predicate, RLMSchema *schema,
                                  RLMObjectSchema *objectSchema);
 
+// a predicate which has been validated against an object schema, and which
+// adds its conditions to a query using the given values for its substitution
+// variables
+using RLMCompiledPredicate = std::function<void (realm::Query&, NSDictionary *)>;
+
+// validate the predicate, which may contain substitution variables, and
+// convert it into a form which can be applied to queries repeatedly
+RLMCompiledPredicate RLMCompilePredicate(NSPredicate *predicate, RLMSchema *schema,
+                                         RLMObjectSchema *objectSchema);
+
+// apply the compiled predicate to the passed in query with the given values
+// for its substitution variables
+void RLMUpdateQueryWithCompiledPredicate(realm::Query *query, RLMCompiledPredicate const& predicate,
+                                         NSDictionary *variables);
+
+// a predicate which has been validated against an object schema and which
+// tests objects that aren't backed by a Realm by calling their property
+// getters directly
+using RLMObjectPredicate = std::function<bool (RLMObjectBase *)>;
+
+// validate the predicate and convert it into a form which can be evaluated
+// for many objects, or return an empty function if it uses anything other
+// than comparisons of the object's own properties with constants, which
+// should then be evaluated with -[NSPredicate evaluateWithObject:]
+RLMObjectPredicate RLMCompileObjectPredicate(NSPredicate *predicate, RLMSchema *schema,
+                                             RLMObjectSchema *objectSchema);
+
+// get a function which describes the conditions of the predicate for query
+// explanations and slow query reports, marking which conditions can use a
+// search index. If `base` is given the description is of `base AND predicate`.
+std::function<std::string ()> RLMPredicateDescriptionFunction(NSPredicate *predicate, RLMObjectSchema *objectSchema,
+                                                              std::function<std::string ()> base = {});
+
+// get a function which finds the conditions of the predicate which compare a
+// property of the object itself with a constant for equality or a range, for
+// recording a Realm's query workload. If `base` is given its conditions are
+// included as well, for a predicate which is ANDed with an existing query.
+std::function<std::vector<realm::QueryCondition> ()> RLMPredicateConditionsFunction(NSPredicate *predicate,
+                                                                                   RLMObjectSchema *objectSchema,
+                                                                                   std::vector<realm::QueryCondition> base = {});
+
 // return property - throw for invalid column name
 RLMProperty *RLMValidatedProperty(RLMObjectSchema *objectSchema, NSString *columnName);
 
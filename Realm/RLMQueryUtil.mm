@@ -21,13 +21,24 @@
 #import "RLMArray_Private.hpp"
 #import "RLMObject_Private.hpp"
 #import "RLMObjectSchema_Private.hpp"
+#import "RLMOptionalBase.h"
 #import "RLMProperty_Private.h"
+#import "RLMRealm_Private.hpp"
 #import "RLMSchema_Private.h"
 #import "RLMUtil.hpp"
 
+#import "compound_index.hpp"
+#import "link_list_aggregates.hpp"
 #import "results.hpp"
+#import "text_index.hpp"
 
 #include <realm.hpp>
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <thread>
+#include <unordered_set>
 
 using namespace realm;
 
@@ -93,6 +104,610 @@ struct FalseExpression : realm::Expression {
     const Table* get_table() const override { return nullptr; }
 };
 
+// IN clauses with at least this many values use InSetExpression rather than an
+// OR group of equality conditions
+const NSUInteger min_in_set_size = 16;
+
+// Matches rows where the value in an int or string column is one of a fixed
+// set of values. Checking membership in a hash set is constant-time per row,
+// unlike OR'ing together an equality condition for each value.
+template<typename T, typename Hash, typename Derived>
+class InSetExpression : public realm::Expression {
+public:
+    InSetExpression(const Table* table, size_t column) : m_table(table), m_column(column) { }
+
+    size_t find_first(size_t start, size_t end) const override
+    {
+        auto& self = static_cast<const Derived&>(*this);
+        for (; start < end; ++start) {
+            if (self.matches(m_table, m_column, start))
+                return start;
+        }
+        return realm::not_found;
+    }
+    void set_table(const Table* table) override { m_table = table; }
+    const Table* get_table() const override { return m_table; }
+
+protected:
+    std::unordered_set<T, Hash> m_values;
+
+private:
+    const Table* m_table;
+    size_t m_column;
+};
+
+class IntInSetExpression : public InSetExpression<int64_t, std::hash<int64_t>, IntInSetExpression> {
+public:
+    IntInSetExpression(const Table* table, size_t column, std::vector<int64_t> const& values, bool contains_null)
+    : InSetExpression(table, column)
+    , m_contains_null(contains_null)
+    {
+        m_values.insert(values.begin(), values.end());
+    }
+
+    bool matches(const Table* table, size_t column, size_t row) const
+    {
+        // Nulls in nullable columns read as zero, so they have to be checked
+        // for before the value
+        if (table->is_nullable(column) && table->is_null(column, row))
+            return m_contains_null;
+        return m_values.count(table->get_int(column, row));
+    }
+
+private:
+    const bool m_contains_null;
+};
+
+struct StringDataHash {
+    size_t operator()(StringData str) const noexcept
+    {
+        // FNV-1a
+        size_t hash = 2166136261U;
+        for (size_t i = 0; i < str.size(); ++i) {
+            hash = (hash ^ static_cast<unsigned char>(str[i])) * 16777619U;
+        }
+        return hash;
+    }
+};
+
+class StringInSetExpression : public InSetExpression<StringData, StringDataHash, StringInSetExpression> {
+public:
+    StringInSetExpression(const Table* table, size_t column, std::vector<std::string> values, bool contains_null)
+    : InSetExpression(table, column)
+    , m_storage(std::move(values))
+    , m_contains_null(contains_null)
+    {
+        // m_storage is never modified after this, so the StringData in the
+        // set remain valid
+        m_values.insert(m_storage.begin(), m_storage.end());
+    }
+
+    bool matches(const Table* table, size_t column, size_t row) const
+    {
+        StringData value = table->get_string(column, row);
+        if (value.is_null())
+            return m_contains_null;
+        return m_values.count(value);
+    }
+
+private:
+    const std::vector<std::string> m_storage;
+    const bool m_contains_null;
+};
+
+char ascii_lower(char c) {
+    return c >= 'A' && c <= 'Z' ? char(c - 'A' + 'a') : c;
+}
+
+// Matches rows where the value in a string column contains a needle made up
+// only of word characters, using the column's full-text index to find the rows
+// which need to be checked. Every row is checked instead if the index can't be
+// used, which is the case within write transactions and when the query is
+// run on a thread other than the one it was created on.
+class TextSearchExpression : public realm::Expression {
+public:
+    TextSearchExpression(const Table* table, size_t column, std::shared_ptr<_impl::TextIndex> const& index,
+                         std::string needle, bool case_sensitive)
+    : m_table(table)
+    , m_column(column)
+    , m_index(index)
+    , m_needle(std::move(needle))
+    , m_case_sensitive(case_sensitive)
+    {
+        std::transform(m_needle.begin(), m_needle.end(), std::back_inserter(m_lowered), ascii_lower);
+    }
+
+    size_t find_first(size_t start, size_t end) const override
+    {
+        auto index = m_index.lock();
+        if (!index || std::this_thread::get_id() != m_thread_id
+            || !index->is_for(*m_table, m_column) || !index->update()) {
+            for (; start < end; ++start) {
+                if (matches(start))
+                    return start;
+            }
+            return realm::not_found;
+        }
+
+        if (index->generation() != m_generation) {
+            index->find_candidates(m_lowered, m_candidates);
+            m_generation = index->generation();
+        }
+        for (auto it = std::lower_bound(m_candidates.begin(), m_candidates.end(), start);
+             it != m_candidates.end() && *it < end; ++it) {
+            if (matches(*it))
+                return *it;
+        }
+        return realm::not_found;
+    }
+    void set_table(const Table* table) override { m_table = table; }
+    const Table* get_table() const override { return m_table; }
+
+private:
+    const Table* m_table;
+    const size_t m_column;
+    const std::weak_ptr<_impl::TextIndex> m_index;
+    const std::thread::id m_thread_id = std::this_thread::get_id();
+    std::string m_needle;
+    std::string m_lowered;
+    const bool m_case_sensitive;
+
+    // The rows which may match as of the index generation they were found in
+    mutable std::vector<size_t> m_candidates;
+    mutable uint64_t m_generation = 0;
+
+    bool matches(size_t row) const
+    {
+        StringData value = m_table->get_string(m_column, row);
+        if (value.is_null())
+            return false;
+        const char* value_end = value.data() + value.size();
+        if (m_case_sensitive)
+            return std::search(value.data(), value_end, m_needle.begin(), m_needle.end()) != value_end;
+        return std::search(value.data(), value_end, m_lowered.begin(), m_lowered.end(),
+                           [](char a, char b) { return ascii_lower(a) == b; }) != value_end;
+    }
+};
+
+// Matches rows whose values in the leading columns of a compound index are
+// equal to the given values, and whose value in the next column is within the
+// given range if there is one, using the index to find them. As with
+// TextSearchExpression, every row is checked instead if the index can't be used.
+class CompoundIndexExpression : public realm::Expression {
+public:
+    using Value = _impl::CompoundIndex::Value;
+
+    CompoundIndexExpression(const Table* table, std::shared_ptr<_impl::CompoundIndex> const& index,
+                            std::vector<size_t> columns, std::vector<Value> prefix,
+                            util::Optional<int64_t> min, util::Optional<int64_t> max)
+    : m_table(table)
+    , m_index(index)
+    , m_columns(std::move(columns))
+    , m_prefix(std::move(prefix))
+    , m_min(min)
+    , m_max(max)
+    {
+    }
+
+    size_t find_first(size_t start, size_t end) const override
+    {
+        auto index = m_index.lock();
+        if (!index || std::this_thread::get_id() != m_thread_id
+            || !index->is_for(*m_table, m_columns) || !index->update()) {
+            for (; start < end; ++start) {
+                if (matches(start))
+                    return start;
+            }
+            return realm::not_found;
+        }
+
+        if (index->generation() != m_generation) {
+            index->find(m_prefix, m_min, m_max, m_rows);
+            m_generation = index->generation();
+        }
+        auto it = std::lower_bound(m_rows.begin(), m_rows.end(), start);
+        return it != m_rows.end() && *it < end ? *it : realm::not_found;
+    }
+    void set_table(const Table* table) override { m_table = table; }
+    const Table* get_table() const override { return m_table; }
+
+private:
+    const Table* m_table;
+    const std::weak_ptr<_impl::CompoundIndex> m_index;
+    const std::thread::id m_thread_id = std::this_thread::get_id();
+    const std::vector<size_t> m_columns;
+    const std::vector<Value> m_prefix;
+    const util::Optional<int64_t> m_min;
+    const util::Optional<int64_t> m_max;
+
+    // The matching rows as of the index generation they were found in
+    mutable std::vector<size_t> m_rows;
+    mutable uint64_t m_generation = 0;
+
+    bool matches(size_t row) const
+    {
+        for (size_t i = 0; i < m_prefix.size(); ++i) {
+            size_t col = m_columns[i];
+            auto& value = m_prefix[i];
+            if (m_table->get_column_type(col) == type_String) {
+                StringData str = m_table->get_string(col, row);
+                if (value.is_null ? !str.is_null() : str.is_null() || str != StringData(value.string_value))
+                    return false;
+            }
+            else {
+                bool is_null = m_table->is_null(col, row);
+                if (value.is_null != is_null || (!is_null && m_table->get_int(col, row) != value.int_value))
+                    return false;
+            }
+        }
+        if (m_min || m_max) {
+            size_t col = m_columns[m_prefix.size()];
+            if (m_table->is_null(col, row))
+                return false;
+            int64_t value = m_table->get_column_type(col) == type_DateTime
+                          ? m_table->get_datetime(col, row).get_datetime() : m_table->get_int(col, row);
+            if ((m_min && value < *m_min) || (m_max && value > *m_max))
+                return false;
+        }
+        return true;
+    }
+};
+
+// Compare two non-null strings bytewise, as the compound index does
+int compare_bytes(StringData a, StringData b) {
+    if (int c = memcmp(a.data(), b.data(), std::min(a.size(), b.size())))
+        return c;
+    return a.size() < b.size() ? -1 : a.size() > b.size();
+}
+
+// Matches rows whose value in a string column is non-null and within the given
+// bounds, which is how both BEGINSWITH and string range comparisons are
+// answered. If the column has a search index, a single-column compound index
+// ordered by the column's values is used to find the rows as a contiguous
+// range; otherwise, or if the index can't be used, every row is checked.
+class StringRangeExpression : public realm::Expression {
+public:
+    using StringBound = _impl::CompoundIndex::StringBound;
+
+    StringRangeExpression(const Table* table, size_t column, std::shared_ptr<_impl::CompoundIndex> const& index,
+                          util::Optional<StringBound> min, util::Optional<StringBound> max)
+    : m_table(table)
+    , m_column(column)
+    , m_index(index)
+    , m_min(std::move(min))
+    , m_max(std::move(max))
+    {
+    }
+
+    size_t find_first(size_t start, size_t end) const override
+    {
+        auto index = m_index.lock();
+        if (!index || std::this_thread::get_id() != m_thread_id
+            || !index->is_for(*m_table, {m_column}) || !index->update()) {
+            for (; start < end; ++start) {
+                if (matches(start))
+                    return start;
+            }
+            return realm::not_found;
+        }
+
+        if (index->generation() != m_generation) {
+            index->find_strings({}, m_min, m_max, m_rows);
+            m_generation = index->generation();
+        }
+        auto it = std::lower_bound(m_rows.begin(), m_rows.end(), start);
+        return it != m_rows.end() && *it < end ? *it : realm::not_found;
+    }
+    void set_table(const Table* table) override { m_table = table; }
+    const Table* get_table() const override { return m_table; }
+
+private:
+    const Table* m_table;
+    const size_t m_column;
+    const std::weak_ptr<_impl::CompoundIndex> m_index;
+    const std::thread::id m_thread_id = std::this_thread::get_id();
+    const util::Optional<StringBound> m_min;
+    const util::Optional<StringBound> m_max;
+
+    // The matching rows as of the index generation they were found in
+    mutable std::vector<size_t> m_rows;
+    mutable uint64_t m_generation = 0;
+
+    bool matches(size_t row) const
+    {
+        StringData value = m_table->get_string(m_column, row);
+        if (value.is_null())
+            return false;
+        if (m_min) {
+            int c = compare_bytes(value, m_min->value);
+            if (c < 0 || (c == 0 && !m_min->inclusive))
+                return false;
+        }
+        if (m_max) {
+            int c = compare_bytes(value, m_max->value);
+            if (c > 0 || (c == 0 && !m_max->inclusive))
+                return false;
+        }
+        return true;
+    }
+};
+
+// Matches rows which link, directly or through a chain of links, to a row
+// whose value in an indexed string or int column is equal to the given value.
+// Rather than following the links from every row, the matching rows of the
+// last table are found with its search index, and then the backlinks to them
+// are followed back to the rows of the queried table. The rows found are kept
+// until the Realm moves to another version; within write transactions and on
+// other threads, where that can't be detected, each row's links are followed
+// instead. The linked tables are always looked up from the table the query is
+// currently bound to, as a query handed over to another thread is bound to
+// that thread's copy of the table.
+class BacklinkExpression : public realm::Expression {
+public:
+    BacklinkExpression(const Table* table, std::vector<size_t> links, size_t column,
+                       std::shared_ptr<Realm> const& realm, std::string string_value, int64_t int_value)
+    : m_table(table)
+    , m_links(std::move(links))
+    , m_column(column)
+    , m_realm(realm)
+    , m_string_value(std::move(string_value))
+    , m_int_value(int_value)
+    {
+        m_is_string = linked_tables().back()->get_column_type(m_column) == type_String;
+    }
+
+    size_t find_first(size_t start, size_t end) const override
+    {
+        auto shared_realm = m_realm.lock();
+        if (!shared_realm || std::this_thread::get_id() != m_thread_id || shared_realm->is_in_transaction()) {
+            for (; start < end; ++start) {
+                if (matches(*m_table, 0, start))
+                    return start;
+            }
+            return realm::not_found;
+        }
+
+        auto version = shared_realm->current_transaction_version();
+        if (!m_found || version != m_version || shared_realm->write_transaction_count() != m_write_count) {
+            find_rows();
+            m_found = true;
+            m_version = version;
+            m_write_count = shared_realm->write_transaction_count();
+        }
+        auto it = std::lower_bound(m_rows.begin(), m_rows.end(), start);
+        return it != m_rows.end() && *it < end ? *it : realm::not_found;
+    }
+    void set_table(const Table* table) override { m_table = table; }
+    const Table* get_table() const override { return m_table; }
+
+private:
+    const Table* m_table;
+    const std::vector<size_t> m_links;
+    const size_t m_column;
+    const std::weak_ptr<Realm> m_realm;
+    const std::thread::id m_thread_id = std::this_thread::get_id();
+    const std::string m_string_value;
+    const int64_t m_int_value;
+    bool m_is_string;
+
+    // The matching rows as of the version they were found in
+    mutable std::vector<size_t> m_rows;
+    mutable bool m_found = false;
+    mutable uint_fast64_t m_version = 0;
+    mutable size_t m_write_count = 0;
+
+    // The queried table followed by the target table of each of the links
+    std::vector<ConstTableRef> linked_tables() const
+    {
+        std::vector<ConstTableRef> tables;
+        tables.push_back(m_table->get_table_ref());
+        for (auto col : m_links) {
+            tables.push_back(tables.back()->get_link_target(col));
+        }
+        return tables;
+    }
+
+    void find_rows() const
+    {
+        auto tables = linked_tables();
+        const Table& target = *tables.back();
+        ConstTableView tv = m_is_string ? target.find_all_string(m_column, m_string_value)
+                                        : target.find_all_int(m_column, m_int_value);
+        std::vector<size_t> rows;
+        rows.reserve(tv.size());
+        for (size_t i = 0; i < tv.size(); ++i) {
+            rows.push_back(tv.get_source_ndx(i));
+        }
+
+        std::vector<size_t> origins;
+        for (size_t level = m_links.size(); level > 0; --level) {
+            const Table& table = *tables[level];
+            const Table& origin = *tables[level - 1];
+            size_t col = m_links[level - 1];
+            origins.clear();
+            for (auto row : rows) {
+                size_t count = table.get_backlink_count(row, origin, col);
+                for (size_t i = 0; i < count; ++i) {
+                    origins.push_back(table.get_backlink(row, origin, col, i));
+                }
+            }
+            // A row can link to several matching rows, or to one several times
+            std::sort(origins.begin(), origins.end());
+            origins.erase(std::unique(origins.begin(), origins.end()), origins.end());
+            rows.swap(origins);
+        }
+        m_rows = std::move(rows);
+    }
+
+    bool matches(const Table& table, size_t level, size_t row) const
+    {
+        if (level == m_links.size()) {
+            if (m_is_string)
+                return table.get_string(m_column, row) == StringData(m_string_value);
+            return !table.is_null(m_column, row) && table.get_int(m_column, row) == m_int_value;
+        }
+
+        size_t col = m_links[level];
+        const Table& target = *table.get_link_target(col);
+        if (table.get_column_type(col) == type_Link) {
+            return !table.is_null_link(col, row) && matches(target, level + 1, table.get_link(col, row));
+        }
+        auto list = table.get_linklist(col, row);
+        for (size_t i = 0; i < list->size(); ++i) {
+            if (matches(target, level + 1, list->get(i).get_index()))
+                return true;
+        }
+        return false;
+    }
+};
+
+// Matches rows whose count of the objects in a link list, or sum of a column
+// of them, compares in the given way with a constant value, reading the
+// aggregate for each row from the Realm's cached link list aggregates. As with
+// the indexes, each row's link list is read instead if they can't be used,
+// from the table the query is currently bound to.
+class LinkListAggregateExpression : public realm::Expression {
+public:
+    LinkListAggregateExpression(const Table* table, size_t link_column, size_t target_column,
+                                std::shared_ptr<_impl::LinkListAggregates> const& aggregates,
+                                NSPredicateOperatorType operatorType, int64_t int_value, double double_value)
+    : m_table(table)
+    , m_link_column(link_column)
+    , m_target_column(target_column)
+    , m_aggregates(aggregates)
+    , m_operator(operatorType)
+    , m_int_value(int_value)
+    , m_double_value(double_value)
+    , m_is_int(aggregates->is_int())
+    {
+    }
+
+    size_t find_first(size_t start, size_t end) const override
+    {
+        auto aggregates = m_aggregates.lock();
+        if (!aggregates || std::this_thread::get_id() != m_thread_id
+            || !aggregates->is_for(*m_table, m_link_column, m_target_column) || !aggregates->update()) {
+            aggregates = nullptr;
+        }
+        for (; start < end; ++start) {
+            if (matches(aggregates.get(), start))
+                return start;
+        }
+        return realm::not_found;
+    }
+    void set_table(const Table* table) override { m_table = table; }
+    const Table* get_table() const override { return m_table; }
+
+private:
+    const Table* m_table;
+    const size_t m_link_column;
+    const size_t m_target_column;
+    const std::weak_ptr<_impl::LinkListAggregates> m_aggregates;
+    const std::thread::id m_thread_id = std::this_thread::get_id();
+    const NSPredicateOperatorType m_operator;
+    const int64_t m_int_value;
+    const double m_double_value;
+    const bool m_is_int;
+
+    bool matches(_impl::LinkListAggregates* aggregates, size_t row) const
+    {
+        using _impl::LinkListAggregates;
+        if (m_is_int) {
+            return compare(aggregates ? aggregates->int_value(row)
+                                      : LinkListAggregates::compute_int(*m_table, m_link_column, m_target_column, row),
+                           m_int_value);
+        }
+        return compare(aggregates ? aggregates->double_value(row)
+                                  : LinkListAggregates::compute_double(*m_table, m_link_column, m_target_column, row),
+                       m_double_value);
+    }
+
+    template<typename T>
+    bool compare(T a, T b) const
+    {
+        switch (m_operator) {
+            case NSLessThanPredicateOperatorType: return a < b;
+            case NSLessThanOrEqualToPredicateOperatorType: return a <= b;
+            case NSGreaterThanPredicateOperatorType: return a > b;
+            case NSGreaterThanOrEqualToPredicateOperatorType: return a >= b;
+            case NSNotEqualToPredicateOperatorType: return a != b;
+            default: return a == b;
+        }
+    }
+};
+
+// Matches rows where the number of objects in a link list which match a query
+// on the linked table compares in the given way with a constant value, as for
+// SUBQUERY(...).@count. Each object in a row's link list is checked against
+// the query in turn, stopping once one more than the value have matched as
+// counting any further can't change the result of the comparison.
+//
+// The query on the linked table belongs to the Group it was created in, so
+// when the expression is bound to another table, as happens when the query is
+// handed over to another thread, it's rebuilt for that table's link target.
+class SubqueryCountExpression : public realm::Expression {
+public:
+    using SubqueryFunction = std::function<Query(const Table& target)>;
+
+    SubqueryCountExpression(const Table* table, size_t link_column, Query subquery,
+                            SubqueryFunction make_subquery, NSPredicateOperatorType operatorType, int64_t value)
+    : m_table(table)
+    , m_link_column(link_column)
+    , m_subquery(std::move(subquery))
+    , m_make_subquery(std::move(make_subquery))
+    , m_operator(operatorType)
+    , m_value(value)
+    , m_limit(value < 0 ? 0 : size_t(value) + 1)
+    {
+    }
+
+    size_t find_first(size_t start, size_t end) const override
+    {
+        for (; start < end; ++start) {
+            if (matches(start))
+                return start;
+        }
+        return realm::not_found;
+    }
+    void set_table(const Table* table) override
+    {
+        if (table != m_table) {
+            m_subquery = m_make_subquery(*table->get_link_target(m_link_column));
+            m_table = table;
+        }
+    }
+    const Table* get_table() const override { return m_table; }
+
+private:
+    const Table* m_table;
+    const size_t m_link_column;
+    mutable Query m_subquery;
+    const SubqueryFunction m_make_subquery;
+    const NSPredicateOperatorType m_operator;
+    const int64_t m_value;
+    const size_t m_limit;
+
+    bool matches(size_t row) const
+    {
+        ConstLinkViewRef list = m_table->get_linklist(m_link_column, row);
+        size_t count = 0;
+        for (size_t i = 0, size = list->size(); i < size && count < m_limit; ++i) {
+            size_t target = list->get(i).get_index();
+            count += m_subquery.count(target, target + 1, 1);
+        }
+
+        int64_t n = count;
+        switch (m_operator) {
+            case NSLessThanPredicateOperatorType: return n < m_value;
+            case NSLessThanOrEqualToPredicateOperatorType: return n <= m_value;
+            case NSGreaterThanPredicateOperatorType: return n > m_value;
+            case NSGreaterThanOrEqualToPredicateOperatorType: return n >= m_value;
+            case NSNotEqualToPredicateOperatorType: return n != m_value;
+            default: return n == m_value;
+        }
+    }
+};
+
 NSString *operatorName(NSPredicateOperatorType operatorType)
 {
     switch (operatorType) {
@@ -148,6 +763,7 @@ public:
     size_t index() const { return m_property.column; }
     RLMPropertyType type() const { return m_property.type; }
     bool has_links() const { return m_links.size(); }
+    std::vector<size_t> const& links() const { return m_links; }
 
 private:
     Table* table_for_query(Query& query) const
@@ -563,58 +1179,498 @@ void process_or_group(Query &query, id array, Func&& func) {
     query.end_group();
 }
 
-template <typename RequestedType>
-RequestedType convert(id value);
+// Add a hash set based IN constraint to the query if the column and values are
+// suitable for one, returning false if an OR group should be used instead.
+// Small sets are left to the OR group, which can use the column's search index
+// and avoids building the set.
+template<typename Func>
+bool add_in_set_constraint_to_query(Query& query, ColumnReference const& column,
+                                    NSComparisonPredicateOptions options,
+                                    id array, Func&& normalize) {
+    if (column.has_links() || options != 0 || ![array respondsToSelector:@selector(count)]
+        || [array count] < min_in_set_size) {
+        return false;
+    }
 
-template <>
-DateTime convert<DateTime>(id value) {
-    return [value timeIntervalSince1970];
+    const Table* table = query.get_table().get();
+    switch (column.type()) {
+        case RLMPropertyTypeInt: {
+            std::vector<int64_t> values;
+            values.reserve([array count]);
+            bool contains_null = false;
+            for (id item in array) {
+                id value = normalize(item);
+                if (value == NSNull.null) {
+                    contains_null = true;
+                }
+                else if ([value isKindOfClass:[NSNumber class]]) {
+                    values.push_back([value longLongValue]);
+                }
+                else {
+                    // Let the regular constraints report the invalid value
+                    return false;
+                }
+            }
+            query.and_query(new IntInSetExpression(table, column.index(), values, contains_null));
+            return true;
+        }
+        case RLMPropertyTypeString: {
+            std::vector<std::string> values;
+            values.reserve([array count]);
+            bool contains_null = false;
+            for (id item in array) {
+                id value = normalize(item);
+                if (value == NSNull.null) {
+                    contains_null = true;
+                }
+                else {
+                    StringData str = RLMStringDataWithNSString(value);
+                    values.emplace_back(str.data(), str.size());
+                }
+            }
+            query.and_query(new StringInSetExpression(table, column.index(), std::move(values), contains_null));
+            return true;
+        }
+        default:
+            return false;
+    }
 }
 
-template <>
-bool convert<bool>(id value) {
-    return [value boolValue];
+// Can a CONTAINS query for the needle with the given options be answered with
+// a full-text index? The needle must lie within a single word for the index to
+// find it, and case-insensitive matching of non-ASCII characters is left to
+// core's Unicode-aware comparison.
+bool can_use_text_index(id needle, NSComparisonPredicateOptions options) {
+    NSString *string = RLMDynamicCast<NSString>(needle);
+    if (!string.length || (options & ~NSCaseInsensitivePredicateOption)) {
+        return false;
+    }
+    StringData str = RLMStringDataWithNSString(string);
+    for (size_t i = 0; i < str.size(); ++i) {
+        if (!_impl::TextIndex::is_word_char(str[i]) || ((options & NSCaseInsensitivePredicateOption) && (str[i] & 0x80))) {
+            return false;
+        }
+    }
+    return true;
 }
 
-template <>
-Double convert<Double>(id value) {
-    return [value doubleValue];
-}
+// Add a CONTAINS constraint which uses the property's full-text index to the
+// query if possible, returning false if a regular constraint should be used
+bool add_text_index_constraint_to_query(RLMObjectSchema *desc, Query& query, ColumnReference const& column,
+                                        NSComparisonPredicate *pred, id value) {
+    if (pred.predicateOperatorType != NSContainsPredicateOperatorType
+        || pred.leftExpression.expressionType != NSKeyPathExpressionType
+        || column.has_links() || !column.property().textIndexed || !desc.realm
+        || !can_use_text_index(value, pred.options)) {
+        return false;
+    }
 
-template <>
-Float convert<Float>(id value) {
-    return [value floatValue];
+    Table* table = query.get_table().get();
+    auto index = desc.realm->_realm->get_text_index(*table, column.index());
+    StringData needle = RLMStringDataWithNSString(value);
+    bool case_sensitive = !(pred.options & NSCaseInsensitivePredicateOption);
+    query.and_query(new TextSearchExpression(table, column.index(), index,
+                                             std::string(needle.data(), needle.size()), case_sensitive));
+    return true;
 }
 
-template <>
-Int convert<Int>(id value) {
-    return [value longLongValue];
+// The operator which gives the same result with the operands swapped, so that
+// `value < property` can be treated as `property > value`
+NSPredicateOperatorType reversed_operator(NSPredicateOperatorType operatorType) {
+    switch (operatorType) {
+        case NSLessThanPredicateOperatorType: return NSGreaterThanPredicateOperatorType;
+        case NSLessThanOrEqualToPredicateOperatorType: return NSGreaterThanOrEqualToPredicateOperatorType;
+        case NSGreaterThanPredicateOperatorType: return NSLessThanPredicateOperatorType;
+        case NSGreaterThanOrEqualToPredicateOperatorType: return NSLessThanOrEqualToPredicateOperatorType;
+        default: return operatorType;
+    }
 }
 
-template <>
-String convert<String>(id value) {
-    return RLMStringDataWithNSString(value);
+// Add a constraint for a BEGINSWITH or range comparison of a string property
+// with a constant string to the query as a range of values, returning false if
+// a regular constraint should be used. BEGINSWITH is only turned into a range
+// if the property has a search index for the range to be looked up in, as
+// core's own scan is as fast as checking every row against the range. Core
+// has no range comparisons on strings, so those always become a range.
+bool add_string_range_constraint_to_query(RLMObjectSchema *desc, Query& query, ColumnReference const& column,
+                                          NSComparisonPredicate *pred, id value) {
+    using StringBound = _impl::CompoundIndex::StringBound;
+
+    NSString *string = RLMDynamicCast<NSString>(value);
+    if (column.type() != RLMPropertyTypeString || column.has_links() || !string || pred.options) {
+        return false;
+    }
+    NSPredicateOperatorType operatorType = pred.predicateOperatorType;
+    bool keyPathOnLeft = pred.leftExpression.expressionType == NSKeyPathExpressionType;
+    bool indexed = column.property().indexed && desc.realm;
+    if (operatorType == NSBeginsWithPredicateOperatorType && (!keyPathOnLeft || !indexed || !string.length)) {
+        return false;
+    }
+    if (!keyPathOnLeft) {
+        operatorType = reversed_operator(operatorType);
+    }
+
+    StringData str = RLMStringDataWithNSString(string);
+    StringBound bound{std::string(str.data(), str.size()), true};
+    util::Optional<StringBound> min, max;
+    switch (operatorType) {
+        case NSBeginsWithPredicateOperatorType: {
+            // The strings beginning with the prefix are those from the prefix
+            // up to the first string after it which doesn't, found by
+            // incrementing its last byte which isn't already 0xFF
+            std::string after = bound.value;
+            while (!after.empty() && static_cast<unsigned char>(after.back()) == 0xFF) {
+                after.pop_back();
+            }
+            if (!after.empty()) {
+                ++after.back();
+                max = StringBound{std::move(after), false};
+            }
+            min = std::move(bound);
+            break;
+        }
+        case NSGreaterThanPredicateOperatorType:
+            bound.inclusive = false;
+            // fallthrough
+        case NSGreaterThanOrEqualToPredicateOperatorType:
+            min = std::move(bound);
+            break;
+        case NSLessThanPredicateOperatorType:
+            bound.inclusive = false;
+            // fallthrough
+        case NSLessThanOrEqualToPredicateOperatorType:
+            max = std::move(bound);
+            break;
+        default:
+            return false;
+    }
+
+    Table* table = query.get_table().get();
+    std::shared_ptr<_impl::CompoundIndex> index;
+    if (indexed) {
+        index = desc.realm->_realm->get_compound_index(*table, {column.index()});
+    }
+    query.and_query(new StringRangeExpression(table, column.index(), index, std::move(min), std::move(max)));
+    return true;
 }
 
-template <typename>
-realm::null value_of_type_for_query(Query&, realm::null) {
-    return realm::null();
+// The conditions in an AND group which a compound index can be used for:
+// comparisons of the leading properties of the index with constant values for
+// equality, and optionally comparisons of the next property with a range
+struct CompoundIndexMatch {
+    NSArray *propertyNames;
+    std::vector<_impl::CompoundIndex::Value> prefix;
+    util::Optional<int64_t> min;
+    util::Optional<int64_t> max;
+    // The subpredicates which the index covers
+    std::vector<NSComparisonPredicate *> used;
+
+    bool uses(NSPredicate *predicate) const {
+        return std::find(used.begin(), used.end(), predicate) != used.end();
+    }
+};
+
+bool is_integer_number(id value) {
+    NSNumber *number = RLMDynamicCast<NSNumber>(value);
+    return number && strchr("cislqCISLQ", *number.objCType);
 }
 
-template <typename RequestedType>
-auto value_of_type_for_query(Query&, id value) {
-    return ::convert<RequestedType>(value);
+bool is_range_operator(NSPredicateOperatorType operatorType) {
+    return operatorType == NSLessThanPredicateOperatorType || operatorType == NSLessThanOrEqualToPredicateOperatorType
+        || operatorType == NSGreaterThanPredicateOperatorType || operatorType == NSGreaterThanOrEqualToPredicateOperatorType;
 }
 
-template <typename RequestedType>
-auto value_of_type_for_query(Query& query, const ColumnReference& column) {
-    return column.resolve<RequestedType>(query);
+// The value of an int or date constant as the index compares it: dates are
+// stored as whole seconds since 1970, truncated as core truncates them
+int64_t range_index_value(RLMPropertyType type, id value) {
+    if (type == RLMPropertyTypeDate) {
+        return static_cast<int64_t>([value timeIntervalSince1970]);
+    }
+    return [value longLongValue];
 }
 
+// Add a constraint for an equality comparison of an indexed string or int
+// property of a linked object with a constant value to the query which finds
+// the matching objects by following backlinks from the linked objects, as
+// finding those few with the search index and walking back is much cheaper
+// than following the links from every object. Returns false if a regular
+// constraint should be used.
+bool add_backlink_constraint_to_query(RLMObjectSchema *desc, Query& query, ColumnReference const& column,
+                                      NSComparisonPredicate *pred, id value) {
+    RLMPropertyType type = column.type();
+    if (!column.has_links() || !column.property().indexed || !desc.realm || pred.options
+        || pred.predicateOperatorType != NSEqualToPredicateOperatorType) {
+        return false;
+    }
 
-template <typename... T>
-void do_add_constraint_to_query(realm::Query &query, RLMPropertyType type,
-                                NSPredicateOperatorType operatorType,
+    std::string stringValue;
+    int64_t intValue = 0;
+    if (type == RLMPropertyTypeString && [value isKindOfClass:[NSString class]]) {
+        StringData str = RLMStringDataWithNSString(value);
+        stringValue.assign(str.data(), str.size());
+    }
+    else if (type == RLMPropertyTypeInt && [value isKindOfClass:[NSNumber class]]) {
+        intValue = [value longLongValue];
+    }
+    else {
+        return false;
+    }
+
+    query.and_query(new BacklinkExpression(query.get_table().get(), column.links(), column.index(), desc.realm->_realm,
+                                           std::move(stringValue), intValue));
+    return true;
+}
+
+// Add a constraint for a BETWEEN or range comparison of an indexed int or date
+// property with constant values to the query, which uses a single-column
+// compound index ordered by the property's values to find the matching rows
+// as a contiguous range. Returns false if a regular constraint should be used.
+// Within write transactions core's scan is used, as the index can't be.
+bool add_range_index_constraint_to_query(RLMObjectSchema *desc, Query& query, ColumnReference const& column,
+                                         NSComparisonPredicate *pred, id value) {
+    RLMPropertyType type = column.type();
+    if ((type != RLMPropertyTypeInt && type != RLMPropertyTypeDate) || column.has_links()
+        || !column.property().indexed || !desc.realm || desc.realm->_realm->is_in_transaction()) {
+        return false;
+    }
+
+    Class valueClass = type == RLMPropertyTypeDate ? [NSDate class] : [NSNumber class];
+    util::Optional<int64_t> min, max;
+    NSPredicateOperatorType operatorType = pred.predicateOperatorType;
+    if (operatorType == NSBetweenPredicateOperatorType) {
+        id from, to;
+        validate_and_extract_between_range(value, column.property(), &from, &to);
+        if (![from isKindOfClass:valueClass] || ![to isKindOfClass:valueClass]) {
+            return false;
+        }
+        min = range_index_value(type, from);
+        max = range_index_value(type, to);
+    }
+    else {
+        if (!is_range_operator(operatorType) || ![value isKindOfClass:valueClass]) {
+            return false;
+        }
+        if (pred.leftExpression.expressionType != NSKeyPathExpressionType) {
+            operatorType = reversed_operator(operatorType);
+        }
+        int64_t bound = range_index_value(type, value);
+        switch (operatorType) {
+            case NSGreaterThanPredicateOperatorType:
+                if (bound == std::numeric_limits<int64_t>::max()) {
+                    query.and_query(new FalseExpression);
+                    return true;
+                }
+                min = bound + 1;
+                break;
+            case NSGreaterThanOrEqualToPredicateOperatorType:
+                min = bound;
+                break;
+            case NSLessThanPredicateOperatorType:
+                if (bound == std::numeric_limits<int64_t>::min()) {
+                    query.and_query(new FalseExpression);
+                    return true;
+                }
+                max = bound - 1;
+                break;
+            default:
+                max = bound;
+                break;
+        }
+    }
+
+    Table* table = query.get_table().get();
+    std::vector<size_t> columns{column.index()};
+    auto index = desc.realm->_realm->get_compound_index(*table, columns);
+    query.and_query(new CompoundIndexExpression(table, index, std::move(columns), {}, min, max));
+    return true;
+}
+
+// Find the compound index of the object type which covers the most properties
+// compared in the AND group's subpredicates, if any covers at least two
+bool find_compound_index(NSArray *subpredicates, RLMObjectSchema *desc, CompoundIndexMatch& match) {
+    if (!desc.compoundIndexes.count) {
+        return false;
+    }
+
+    // The comparisons with constant values which an index could be used for,
+    // by property name
+    NSMutableDictionary *comparisons = [NSMutableDictionary new];
+    for (NSPredicate *subp in subpredicates) {
+        if (![subp isMemberOfClass:[NSComparisonPredicate class]]) {
+            continue;
+        }
+        NSComparisonPredicate *compp = (NSComparisonPredicate *)subp;
+        if (compp.options || compp.comparisonPredicateModifier != NSDirectPredicateModifier
+            || compp.leftExpression.expressionType != NSKeyPathExpressionType
+            || compp.rightExpression.expressionType != NSConstantValueExpressionType) {
+            continue;
+        }
+        RLMProperty *prop = desc[compp.leftExpression.keyPath];
+        id value = RLMCoerceToNil(compp.rightExpression.constantValue);
+        bool isEqual = compp.predicateOperatorType == NSEqualToPredicateOperatorType;
+        bool nullAllowed = isEqual && !value && prop.optional;
+        bool indexable = false;
+        if (prop.type == RLMPropertyTypeString) {
+            indexable = isEqual && ([value isKindOfClass:[NSString class]] || nullAllowed);
+        }
+        else if (prop.type == RLMPropertyTypeInt) {
+            indexable = ((isEqual || is_range_operator(compp.predicateOperatorType)) && is_integer_number(value))
+                     || nullAllowed;
+        }
+        if (indexable) {
+            NSMutableArray *propertyComparisons = comparisons[prop.name] ?: (comparisons[prop.name] = [NSMutableArray new]);
+            [propertyComparisons addObject:compp];
+        }
+    }
+
+    NSUInteger bestCovered = 1;
+    for (NSArray *propertyNames in desc.compoundIndexes) {
+        CompoundIndexMatch candidate;
+        candidate.propertyNames = propertyNames;
+
+        NSUInteger covered = 0;
+        for (; covered < propertyNames.count; ++covered) {
+            NSArray *propertyComparisons = comparisons[propertyNames[covered]];
+            NSUInteger equal = [propertyComparisons indexOfObjectPassingTest:^BOOL(NSComparisonPredicate *compp, NSUInteger, BOOL *) {
+                return compp.predicateOperatorType == NSEqualToPredicateOperatorType;
+            }];
+            if (!propertyComparisons || equal == NSNotFound) {
+                break;
+            }
+            NSComparisonPredicate *compp = propertyComparisons[equal];
+            id value = RLMCoerceToNil(compp.rightExpression.constantValue);
+            _impl::CompoundIndex::Value indexValue;
+            indexValue.is_null = !value;
+            if (NSString *str = RLMDynamicCast<NSString>(value)) {
+                StringData data = RLMStringDataWithNSString(str);
+                indexValue.string_value.assign(data.data(), data.size());
+            }
+            else {
+                indexValue.int_value = [value longLongValue];
+            }
+            candidate.prefix.push_back(std::move(indexValue));
+            candidate.used.push_back(compp);
+        }
+
+        if (covered < propertyNames.count && desc[propertyNames[covered]].type == RLMPropertyTypeInt) {
+            for (NSComparisonPredicate *compp in comparisons[propertyNames[covered]]) {
+                int64_t value = [compp.rightExpression.constantValue longLongValue];
+                switch (compp.predicateOperatorType) {
+                    case NSGreaterThanPredicateOperatorType:
+                        if (value == std::numeric_limits<int64_t>::max()) {
+                            continue;
+                        }
+                        ++value;
+                        // fallthrough
+                    case NSGreaterThanOrEqualToPredicateOperatorType:
+                        candidate.min = candidate.min ? std::max(*candidate.min, value) : value;
+                        break;
+                    case NSLessThanPredicateOperatorType:
+                        if (value == std::numeric_limits<int64_t>::min()) {
+                            continue;
+                        }
+                        --value;
+                        // fallthrough
+                    case NSLessThanOrEqualToPredicateOperatorType:
+                        candidate.max = candidate.max ? std::min(*candidate.max, value) : value;
+                        break;
+                    default:
+                        continue;
+                }
+                candidate.used.push_back(compp);
+            }
+            if (candidate.min || candidate.max) {
+                ++covered;
+            }
+        }
+
+        if (covered > bestCovered) {
+            bestCovered = covered;
+            match = std::move(candidate);
+        }
+    }
+    return bestCovered > 1;
+}
+
+// Add a constraint which uses a compound index to the query for the
+// subpredicates of an AND group if possible, returning the subpredicates which
+// still need to be added
+NSArray *add_compound_index_constraint_to_query(Query& query, NSArray *subpredicates, RLMObjectSchema *desc) {
+    CompoundIndexMatch match;
+    if (!desc.realm || desc.realm->_realm->is_in_transaction() || !find_compound_index(subpredicates, desc, match)) {
+        return subpredicates;
+    }
+
+    std::vector<size_t> columns;
+    for (NSString *propertyName in match.propertyNames) {
+        columns.push_back(desc[propertyName].column);
+    }
+    Table* table = query.get_table().get();
+    auto index = desc.realm->_realm->get_compound_index(*table, columns);
+    query.and_query(new CompoundIndexExpression(table, index, std::move(columns), std::move(match.prefix),
+                                                match.min, match.max));
+
+    NSMutableArray *remaining = [NSMutableArray arrayWithCapacity:subpredicates.count];
+    for (NSPredicate *subp in subpredicates) {
+        if (!match.uses(subp)) {
+            [remaining addObject:subp];
+        }
+    }
+    return remaining;
+}
+
+template <typename RequestedType>
+RequestedType convert(id value);
+
+template <>
+DateTime convert<DateTime>(id value) {
+    return [value timeIntervalSince1970];
+}
+
+template <>
+bool convert<bool>(id value) {
+    return [value boolValue];
+}
+
+template <>
+Double convert<Double>(id value) {
+    return [value doubleValue];
+}
+
+template <>
+Float convert<Float>(id value) {
+    return [value floatValue];
+}
+
+template <>
+Int convert<Int>(id value) {
+    return [value longLongValue];
+}
+
+template <>
+String convert<String>(id value) {
+    return RLMStringDataWithNSString(value);
+}
+
+template <typename>
+realm::null value_of_type_for_query(Query&, realm::null) {
+    return realm::null();
+}
+
+template <typename RequestedType>
+auto value_of_type_for_query(Query&, id value) {
+    return ::convert<RequestedType>(value);
+}
+
+template <typename RequestedType>
+auto value_of_type_for_query(Query& query, const ColumnReference& column) {
+    return column.resolve<RequestedType>(query);
+}
+
+
+template <typename... T>
+void do_add_constraint_to_query(realm::Query &query, RLMPropertyType type,
+                                NSPredicateOperatorType operatorType,
                                 NSComparisonPredicateOptions predicateOptions,
                                 T... values)
 {
@@ -882,6 +1938,36 @@ CollectionOperation collection_operation_from_key_path(RLMSchema *schema,
     return { collectionOperationName, std::move(linkColumn), std::move(column) };
 }
 
+// Add a constraint comparing the @count or @sum of an RLMArray property with
+// cached aggregates with a constant value to the query, which reads each
+// object's value from the Realm's cache. Returns false if a regular
+// constraint should be used.
+bool add_link_list_aggregate_constraint_to_query(RLMObjectSchema *desc, Query& query,
+                                                 CollectionOperation const& operation,
+                                                 NSComparisonPredicate *pred, id value) {
+    ColumnReference const& link = operation.link_column();
+    if ((operation.type() != CollectionOperation::Count && operation.type() != CollectionOperation::Sum)
+        || link.has_links() || !link.property().cachedAggregates || !desc.realm
+        || ![value isKindOfClass:[NSNumber class]]) {
+        return false;
+    }
+
+    NSPredicateOperatorType operatorType = pred.predicateOperatorType;
+    if (pred.leftExpression.expressionType != NSKeyPathExpressionType) {
+        operatorType = reversed_operator(operatorType);
+    }
+    if (!is_range_operator(operatorType) && operatorType != NSEqualToPredicateOperatorType
+        && operatorType != NSNotEqualToPredicateOperatorType) {
+        return false;
+    }
+
+    size_t targetColumn = operation.type() == CollectionOperation::Sum ? operation.column_index() : realm::npos;
+    auto aggregates = desc.realm->_realm->get_link_list_aggregates(*query.get_table(), link.index(), targetColumn);
+    query.and_query(new LinkListAggregateExpression(query.get_table().get(), link.index(), targetColumn, aggregates,
+                                                    operatorType, [value longLongValue], [value doubleValue]));
+    return true;
+}
+
 void update_query_with_collection_operator_expression(RLMSchema *schema,
                                                       RLMObjectSchema *desc,
                                                       realm::Query &query,
@@ -890,6 +1976,9 @@ void update_query_with_collection_operator_expression(RLMSchema *schema,
                                                       NSComparisonPredicate *pred) {
     CollectionOperation operation = collection_operation_from_key_path(schema, desc, keyPath);
     operation.validate_comparison(value);
+    if (add_link_list_aggregate_constraint_to_query(desc, query, operation, pred, value)) {
+        return;
+    }
 
     if (pred.leftExpression.expressionType == NSKeyPathExpressionType) {
         add_collection_operation_constraint_to_query(query, pred.predicateOperatorType, operation, operation, value);
@@ -898,45 +1987,70 @@ void update_query_with_collection_operator_expression(RLMSchema *schema,
     }
 }
 
-void update_query_with_value_expression(RLMSchema *schema,
-                                        RLMObjectSchema *desc,
-                                        realm::Query &query,
-                                        NSString *keyPath,
-                                        id value,
-                                        NSComparisonPredicate *pred)
+void update_query_with_value(RLMObjectSchema *desc,
+                             realm::Query &query,
+                             ColumnReference const& column,
+                             NSString *keyPath,
+                             id value,
+                             NSComparisonPredicate *pred)
 {
-    if (key_path_contains_collection_operator(keyPath)) {
-        update_query_with_collection_operator_expression(schema, desc, query, keyPath, value, pred);
-        return;
-    }
-
-    bool isAny = pred.comparisonPredicateModifier == NSAnyPredicateModifier;
-    ColumnReference column = column_reference_from_key_path(schema, desc, keyPath, isAny);
-
     // check to see if this is a between query
     if (pred.predicateOperatorType == NSBetweenPredicateOperatorType) {
-        add_between_constraint_to_query(query, std::move(column), value);
+        if (!add_range_index_constraint_to_query(desc, query, column, pred, value)) {
+            add_between_constraint_to_query(query, column, value);
+        }
         return;
     }
 
-    // turn IN into ored together ==
+    // turn IN into either a set membership check or ored together ==
     if (pred.predicateOperatorType == NSInPredicateOperatorType) {
-        process_or_group(query, value, [&](id item) {
+        auto normalize = [&](id item) {
             id normalized = value_from_constant_expression_or_value(item);
             validate_property_value(column, normalized, @"Expected object of type %@ in IN clause for property '%@' on object of type '%@', but received: %@", desc, keyPath);
-            add_constraint_to_query(query, column.type(), NSEqualToPredicateOperatorType, pred.options, column, normalized);
+            return normalized;
+        };
+        if (add_in_set_constraint_to_query(query, column, pred.options, value, normalize)) {
+            return;
+        }
+        process_or_group(query, value, [&](id item) {
+            add_constraint_to_query(query, column.type(), NSEqualToPredicateOperatorType, pred.options, column, normalize(item));
         });
         return;
     }
 
+    // The value is validated before trying any of the index-based constraints
+    // so that they reject the same values as the regular ones
     validate_property_value(column, value, @"Expected object of type %@ for property '%@' on object of type '%@', but received: %@", desc, keyPath);
+    if (add_range_index_constraint_to_query(desc, query, column, pred, value)
+        || add_text_index_constraint_to_query(desc, query, column, pred, value)
+        || add_string_range_constraint_to_query(desc, query, column, pred, value)
+        || add_backlink_constraint_to_query(desc, query, column, pred, value)) {
+        return;
+    }
     if (pred.leftExpression.expressionType == NSKeyPathExpressionType) {
         add_constraint_to_query(query, column.type(), pred.predicateOperatorType,
-                                pred.options, std::move(column), value);
+                                pred.options, column, value);
     } else {
         add_constraint_to_query(query, column.type(), pred.predicateOperatorType,
-                                pred.options, value, std::move(column));
+                                pred.options, value, column);
+    }
+}
+
+void update_query_with_value_expression(RLMSchema *schema,
+                                        RLMObjectSchema *desc,
+                                        realm::Query &query,
+                                        NSString *keyPath,
+                                        id value,
+                                        NSComparisonPredicate *pred)
+{
+    if (key_path_contains_collection_operator(keyPath)) {
+        update_query_with_collection_operator_expression(schema, desc, query, keyPath, value, pred);
+        return;
     }
+
+    bool isAny = pred.comparisonPredicateModifier == NSAnyPredicateModifier;
+    ColumnReference column = column_reference_from_key_path(schema, desc, keyPath, isAny);
+    update_query_with_value(desc, query, column, keyPath, value, pred);
 }
 
 void update_query_with_column_expression(RLMSchema *schema, RLMObjectSchema *desc, Query &query,
@@ -980,6 +2094,109 @@ void update_query_with_column_expression(RLMSchema *schema, RLMObjectSchema *des
                             std::move(left), std::move(right));
 }
 
+NSArray *order_conjuncts(NSArray *subpredicates, RLMObjectSchema *desc);
+void update_query_with_predicate(NSPredicate *predicate, RLMSchema *schema,
+                                 RLMObjectSchema *objectSchema, realm::Query &query);
+
+// Returns the SUBQUERY() expression if the expression is SUBQUERY(...).@count,
+// or nil if it's anything else
+NSExpression *subquery_from_count_expression(NSExpression *expression) {
+    if (expression.expressionType != NSFunctionExpressionType
+        || ![expression.function isEqualToString:@"valueForKeyPath:"]
+        || expression.arguments.count != 1) {
+        return nil;
+    }
+    NSExpression *keyPathExpression = expression.arguments.firstObject;
+    if (keyPathExpression.expressionType != NSKeyPathExpressionType
+        || ![keyPathExpression.keyPath isEqualToString:@"@count"]
+        || expression.operand.expressionType != NSSubqueryExpressionType) {
+        return nil;
+    }
+    return expression.operand;
+}
+
+// Replace FUNCTION(SELF, 'valueForKeyPath:', 'keyPath'), which is what
+// $variable.keyPath becomes once SELF is substituted for the variable, with
+// the plain key path
+NSExpression *simplify_self_key_path_expression(NSExpression *expression) {
+    if (expression.expressionType == NSFunctionExpressionType
+        && expression.operand.expressionType == NSEvaluatedObjectExpressionType
+        && [expression.function isEqualToString:@"valueForKeyPath:"]
+        && expression.arguments.count == 1) {
+        NSExpression *keyPathExpression = expression.arguments.firstObject;
+        if (keyPathExpression.expressionType == NSKeyPathExpressionType) {
+            return [NSExpression expressionForKeyPath:keyPathExpression.keyPath];
+        }
+    }
+    return expression;
+}
+
+NSPredicate *simplify_self_key_paths(NSPredicate *predicate) {
+    if ([predicate isMemberOfClass:[NSCompoundPredicate class]]) {
+        NSCompoundPredicate *comp = (NSCompoundPredicate *)predicate;
+        NSMutableArray *subpredicates = [NSMutableArray arrayWithCapacity:comp.subpredicates.count];
+        for (NSPredicate *subp in comp.subpredicates) {
+            [subpredicates addObject:simplify_self_key_paths(subp)];
+        }
+        return [[NSCompoundPredicate alloc] initWithType:comp.compoundPredicateType subpredicates:subpredicates];
+    }
+    if ([predicate isMemberOfClass:[NSComparisonPredicate class]]) {
+        NSComparisonPredicate *compp = (NSComparisonPredicate *)predicate;
+        return [NSComparisonPredicate predicateWithLeftExpression:simplify_self_key_path_expression(compp.leftExpression)
+                                                  rightExpression:simplify_self_key_path_expression(compp.rightExpression)
+                                                         modifier:compp.comparisonPredicateModifier
+                                                             type:compp.predicateOperatorType
+                                                          options:compp.options];
+    }
+    return predicate;
+}
+
+// Add a constraint comparing SUBQUERY(collection, $variable, predicate).@count
+// with a constant number to the query. The subquery's predicate is converted
+// to a query on the linked table which is checked against each object in the
+// link lists by SubqueryCountExpression.
+void update_query_with_subquery_count_expression(RLMSchema *schema, RLMObjectSchema *desc, Query& query,
+                                                 NSExpression *subquery, id value,
+                                                 NSPredicateOperatorType operatorType) {
+    RLMPrecondition([value isKindOfClass:[NSNumber class]], @"Invalid predicate expression",
+                    @"SUBQUERY(...).@count is only supported when compared with a constant number");
+    RLMPrecondition(is_range_operator(operatorType) || operatorType == NSEqualToPredicateOperatorType
+                    || operatorType == NSNotEqualToPredicateOperatorType,
+                    @"Invalid operator type",
+                    @"Operator '%@' not supported for SUBQUERY(...).@count", operatorName(operatorType));
+
+    NSExpression *collection = subquery.collection;
+    RLMPrecondition(collection.expressionType == NSKeyPathExpressionType, @"Invalid predicate expression",
+                    @"The collection of a SUBQUERY must be the key path of an RLMArray property");
+    ColumnReference column = column_reference_from_key_path(schema, desc, collection.keyPath, true);
+    RLMPrecondition(!column.has_links() && column.type() == RLMPropertyTypeArray, @"Invalid predicate expression",
+                    @"The collection of a SUBQUERY must be an RLMArray property of the object being queried");
+
+    NSPredicate *predicate = [subquery.predicate predicateWithSubstitutionVariables:@{subquery.variable: [NSExpression expressionForEvaluatedObject]}];
+    predicate = simplify_self_key_paths(predicate);
+
+    TableRef target = query.get_table()->get_link_target(column.index());
+    Query inner = target->where();
+    update_query_with_predicate(predicate, schema, schema[column.property().objectClassName], inner);
+    std::string validateMessage = inner.validate();
+    RLMPrecondition(validateMessage.empty(), @"Invalid query", @"%.*s",
+                    (int)validateMessage.size(), validateMessage.c_str());
+
+    // Rebuilding the subquery for another thread's table can't use this
+    // thread's Realm, so it uses a copy of the schema which isn't attached to
+    // one, which skips the optimizations that need the Realm
+    RLMSchema *detachedSchema = [schema shallowCopy];
+    RLMObjectSchema *targetSchema = detachedSchema[column.property().objectClassName];
+    auto makeSubquery = [=](const Table& table) {
+        Query subquery = table.where();
+        update_query_with_predicate(predicate, detachedSchema, targetSchema, subquery);
+        return subquery;
+    };
+
+    query.and_query(new SubqueryCountExpression(query.get_table().get(), column.index(), std::move(inner),
+                                                std::move(makeSubquery), operatorType, [value longLongValue]));
+}
+
 void update_query_with_predicate(NSPredicate *predicate, RLMSchema *schema,
                                  RLMObjectSchema *objectSchema, realm::Query &query)
 {
@@ -990,9 +2207,12 @@ void update_query_with_predicate(NSPredicate *predicate, RLMSchema *schema,
         switch ([comp compoundPredicateType]) {
             case NSAndPredicateType:
                 if (comp.subpredicates.count) {
-                    // Add all of the subpredicates.
+                    // Add all of the subpredicates, with the ones a compound
+                    // index covers replaced by a single condition using it
+                    // and the rest in order of their estimated cost
                     query.group();
-                    for (NSPredicate *subp in comp.subpredicates) {
+                    NSArray *remaining = add_compound_index_constraint_to_query(query, comp.subpredicates, objectSchema);
+                    for (NSPredicate *subp in order_conjuncts(remaining, objectSchema)) {
                         update_query_with_predicate(subp, schema, objectSchema, query);
                     }
                     query.end_group();
@@ -1064,6 +2284,20 @@ void update_query_with_predicate(NSPredicate *predicate, RLMSchema *schema,
             update_query_with_value_expression(schema, objectSchema, query, compp.rightExpression.keyPath,
                                                compp.leftExpression.constantValue, compp);
         }
+        else if (NSExpression *subquery = subquery_from_count_expression(compp.leftExpression)) {
+            RLMPrecondition(exp2Type == NSConstantValueExpressionType, @"Invalid predicate expression",
+                            @"SUBQUERY(...).@count is only supported when compared with a constant number");
+            update_query_with_subquery_count_expression(schema, objectSchema, query, subquery,
+                                                        compp.rightExpression.constantValue,
+                                                        compp.predicateOperatorType);
+        }
+        else if (NSExpression *subquery = subquery_from_count_expression(compp.rightExpression)) {
+            RLMPrecondition(exp1Type == NSConstantValueExpressionType, @"Invalid predicate expression",
+                            @"SUBQUERY(...).@count is only supported when compared with a constant number");
+            update_query_with_subquery_count_expression(schema, objectSchema, query, subquery,
+                                                        compp.leftExpression.constantValue,
+                                                        reversed_operator(compp.predicateOperatorType));
+        }
         else {
             @throw RLMPredicateException(@"Invalid predicate expressions",
                                          @"Predicate expressions must compare a keypath and another keypath or a constant value");
@@ -1081,9 +2315,23 @@ void update_query_with_predicate(NSPredicate *predicate, RLMSchema *schema,
     }
 }
 
-RLMProperty *RLMValidatedPropertyForSort(RLMObjectSchema *schema, NSString *propName) {
-    // validate
-    RLMPrecondition([propName rangeOfString:@"."].location == NSNotFound, @"Invalid sort property", @"Cannot sort on '%@': sorting on key paths is not supported.", propName);
+// Validate a sort property, which may be a key path of to-one links ending in
+// a property of the linked object, appending the columns of the links to
+// `linkPath`
+RLMProperty *RLMValidatedPropertyForSort(RLMObjectSchema *schema, NSString *keyPath, std::vector<size_t>& linkPath) {
+    NSArray *names = [keyPath componentsSeparatedByString:@"."];
+    for (NSUInteger i = 0; i + 1 < names.count; ++i) {
+        RLMProperty *link = schema[names[i]];
+        RLMPrecondition(link, @"Invalid sort property", @"Cannot sort on key path '%@': property '%@' not found on object of type '%@'.",
+                        keyPath, names[i], schema.className);
+        RLMPrecondition(link.type == RLMPropertyTypeObject, @"Invalid sort property",
+                        @"Cannot sort on key path '%@': property '%@' on object of type '%@' is not a link to a single object.",
+                        keyPath, names[i], schema.className);
+        linkPath.push_back(link.column);
+        schema = schema.realm.schema[link.objectClassName];
+    }
+
+    NSString *propName = names.lastObject;
     RLMProperty *prop = schema[propName];
     RLMPrecondition(prop, @"Invalid sort property", @"Cannot sort on property '%@' on object of type '%@': property not found.", propName, schema.className);
 
@@ -1103,6 +2351,694 @@ RLMProperty *RLMValidatedPropertyForSort(RLMObjectSchema *schema, NSString *prop
     return prop;
 }
 
+bool expression_contains_variable(NSExpression *expression) {
+    switch (expression.expressionType) {
+        case NSVariableExpressionType:
+            return true;
+        case NSAggregateExpressionType:
+            for (id item in expression.collection) {
+                if ([item isKindOfClass:[NSExpression class]] && expression_contains_variable(item)) {
+                    return true;
+                }
+            }
+            return false;
+        default:
+            return false;
+    }
+}
+
+bool predicate_contains_variable(NSPredicate *predicate) {
+    if ([predicate isMemberOfClass:[NSCompoundPredicate class]]) {
+        for (NSPredicate *subp in ((NSCompoundPredicate *)predicate).subpredicates) {
+            if (predicate_contains_variable(subp)) {
+                return true;
+            }
+        }
+        return false;
+    }
+    if ([predicate isMemberOfClass:[NSComparisonPredicate class]]) {
+        NSComparisonPredicate *compp = (NSComparisonPredicate *)predicate;
+        return expression_contains_variable(compp.leftExpression) || expression_contains_variable(compp.rightExpression);
+    }
+    return false;
+}
+
+bool is_value_expression(NSExpression *expression) {
+    return expression.expressionType == NSConstantValueExpressionType
+        || expression.expressionType == NSVariableExpressionType;
+}
+
+// Compile a comparison between a key path and either a constant or a variable,
+// validating and resolving the key path up front. Returns an empty function
+// for any other kind of comparison.
+RLMCompiledPredicate compile_value_comparison(NSComparisonPredicate *compp, RLMSchema *schema, RLMObjectSchema *desc) {
+    if (compp.comparisonPredicateModifier == NSAllPredicateModifier) {
+        return {};
+    }
+
+    NSExpression *keyPathExpression, *valueExpression;
+    if (compp.leftExpression.expressionType == NSKeyPathExpressionType && is_value_expression(compp.rightExpression)) {
+        keyPathExpression = compp.leftExpression;
+        valueExpression = compp.rightExpression;
+    }
+    else if (is_value_expression(compp.leftExpression) && compp.rightExpression.expressionType == NSKeyPathExpressionType) {
+        // ANY, BETWEEN and IN require the key path to be on the left, which
+        // update_query_with_predicate() reports
+        if (compp.comparisonPredicateModifier == NSAnyPredicateModifier
+            || compp.predicateOperatorType == NSBetweenPredicateOperatorType
+            || compp.predicateOperatorType == NSInPredicateOperatorType) {
+            return {};
+        }
+        keyPathExpression = compp.rightExpression;
+        valueExpression = compp.leftExpression;
+    }
+    else {
+        return {};
+    }
+
+    NSString *keyPath = keyPathExpression.keyPath;
+    if (key_path_contains_collection_operator(keyPath)) {
+        return {};
+    }
+
+    bool isAny = compp.comparisonPredicateModifier == NSAnyPredicateModifier;
+    ColumnReference column = column_reference_from_key_path(schema, desc, keyPath, isAny);
+
+    if (valueExpression.expressionType == NSConstantValueExpressionType) {
+        id value = valueExpression.constantValue;
+        return [=](Query& query, NSDictionary *) {
+            update_query_with_value(desc, query, column, keyPath, value, compp);
+        };
+    }
+
+    NSString *variable = valueExpression.variable;
+    return [=](Query& query, NSDictionary *variables) {
+        id value = variables[variable];
+        RLMPrecondition(value, @"Invalid predicate", @"No value given for substitution variable '$%@'", variable);
+        update_query_with_value(desc, query, column, keyPath, value, compp);
+    };
+}
+
+RLMCompiledPredicate compile_predicate(NSPredicate *predicate, RLMSchema *schema, RLMObjectSchema *desc) {
+    if ([predicate isMemberOfClass:[NSCompoundPredicate class]]) {
+        NSCompoundPredicate *comp = (NSCompoundPredicate *)predicate;
+        NSArray *ordered = comp.compoundPredicateType == NSAndPredicateType
+                         ? order_conjuncts(comp.subpredicates, desc) : comp.subpredicates;
+        std::vector<RLMCompiledPredicate> subpredicates;
+        for (NSPredicate *subp in ordered) {
+            subpredicates.push_back(compile_predicate(subp, schema, desc));
+        }
+
+        switch (comp.compoundPredicateType) {
+            case NSAndPredicateType:
+                return [=](Query& query, NSDictionary *variables) {
+                    if (subpredicates.empty()) {
+                        query.and_query(new TrueExpression);
+                        return;
+                    }
+                    query.group();
+                    for (auto const& subp : subpredicates) {
+                        subp(query, variables);
+                    }
+                    query.end_group();
+                };
+            case NSOrPredicateType:
+                return [=](Query& query, NSDictionary *variables) {
+                    query.group();
+                    for (size_t i = 0; i < subpredicates.size(); ++i) {
+                        if (i > 0) {
+                            query.Or();
+                        }
+                        subpredicates[i](query, variables);
+                    }
+                    if (subpredicates.empty()) {
+                        query.and_query(new FalseExpression);
+                    }
+                    query.end_group();
+                };
+            case NSNotPredicateType:
+                if (subpredicates.empty()) {
+                    break;
+                }
+                return [=](Query& query, NSDictionary *variables) {
+                    query.Not();
+                    subpredicates.front()(query, variables);
+                };
+            default:
+                break;
+        }
+    }
+    else if ([predicate isMemberOfClass:[NSComparisonPredicate class]]) {
+        if (auto compiled = compile_value_comparison((NSComparisonPredicate *)predicate, schema, desc)) {
+            return compiled;
+        }
+    }
+
+    // Anything else is converted each time it's applied, substituting the
+    // variables into the predicate first if it has any
+    if (!predicate_contains_variable(predicate)) {
+        if (desc.table) {
+            // Report invalid predicates when compiling rather than when used
+            Query query = desc.table->where();
+            update_query_with_predicate(predicate, schema, desc, query);
+        }
+        return [=](Query& query, NSDictionary *) {
+            update_query_with_predicate(predicate, schema, desc, query);
+        };
+    }
+    return [=](Query& query, NSDictionary *variables) {
+        update_query_with_predicate([predicate predicateWithSubstitutionVariables:variables ?: @{}], schema, desc, query);
+    };
+}
+
+// Call a property getter directly rather than through KVC, which would look
+// the getter up and box the value each time
+template<typename T>
+T call_getter(__unsafe_unretained RLMObjectBase *const obj, SEL getter) {
+    auto imp = reinterpret_cast<T (*)(id, SEL)>(class_getMethodImplementation(object_getClass(obj), getter));
+    return imp(obj, getter);
+}
+
+// Read a property whose value is an object, which includes optional numbers
+id object_value(__unsafe_unretained RLMObjectBase *const obj, __unsafe_unretained RLMProperty *const prop) {
+    if (Ivar ivar = prop.swiftIvar) {
+        return static_cast<RLMOptionalBase *>(object_getIvar(obj, ivar)).underlyingValue;
+    }
+    return call_getter<id>(obj, prop.getterSel);
+}
+
+template<typename T>
+bool compare_values(NSPredicateOperatorType operatorType, T const& a, T const& b) {
+    switch (operatorType) {
+        case NSEqualToPredicateOperatorType:              return a == b;
+        case NSNotEqualToPredicateOperatorType:           return a != b;
+        case NSLessThanPredicateOperatorType:             return a < b;
+        case NSLessThanOrEqualToPredicateOperatorType:    return a <= b;
+        case NSGreaterThanPredicateOperatorType:          return a > b;
+        case NSGreaterThanOrEqualToPredicateOperatorType: return a >= b;
+        default:                                          REALM_UNREACHABLE();
+    }
+}
+
+template<typename T> T number_value(NSNumber *number);
+template<> int64_t number_value<int64_t>(NSNumber *number) { return number.longLongValue; }
+template<> double number_value<double>(NSNumber *number) { return number.doubleValue; }
+
+// Call the function with a value of the type of a non-optional number
+// property, or return an empty predicate for any other type
+template<typename Func>
+RLMObjectPredicate with_number_type(char objcType, Func&& func) {
+    switch (objcType) {
+        case 'c': return func(char());
+        case 'B': return func(bool());
+        case 's': return func(short());
+        case 'i': return func(int());
+        case 'l': return func(long());
+        case 'q': return func((long long)0);
+        case 'f': return func(float());
+        case 'd': return func(double());
+        default:  return {};
+    }
+}
+
+template<typename T>
+RLMObjectPredicate compile_number_comparison(RLMProperty *prop, NSPredicateOperatorType operatorType, T value) {
+    if (prop.swiftIvar || prop.objcType == '@') {
+        return [=](RLMObjectBase *obj) {
+            NSNumber *number = object_value(obj, prop);
+            if (!number) {
+                return operatorType == NSNotEqualToPredicateOperatorType;
+            }
+            return compare_values(operatorType, number_value<T>(number), value);
+        };
+    }
+    SEL getter = prop.getterSel;
+    return with_number_type(prop.objcType, [=](auto type) -> RLMObjectPredicate {
+        using Stored = decltype(type);
+        return [=](RLMObjectBase *obj) {
+            return compare_values(operatorType, static_cast<T>(call_getter<Stored>(obj, getter)), value);
+        };
+    });
+}
+
+RLMObjectPredicate compile_string_comparison(RLMProperty *prop, NSPredicateOperatorType operatorType,
+                                             NSComparisonPredicateOptions predicateOptions, NSString *value) {
+    NSStringCompareOptions options = 0;
+    if (predicateOptions & NSCaseInsensitivePredicateOption) {
+        options |= NSCaseInsensitiveSearch;
+    }
+    if (predicateOptions & NSDiacriticInsensitivePredicateOption) {
+        options |= NSDiacriticInsensitiveSearch;
+    }
+
+    switch (operatorType) {
+        case NSEqualToPredicateOperatorType:
+        case NSNotEqualToPredicateOperatorType: {
+            bool equal = operatorType == NSEqualToPredicateOperatorType;
+            return [=](RLMObjectBase *obj) {
+                NSString *str = object_value(obj, prop);
+                if (!str) {
+                    return !equal;
+                }
+                bool matches = options ? [str compare:value options:options] == NSOrderedSame
+                                       : [str isEqualToString:value];
+                return matches == equal;
+            };
+        }
+        case NSBeginsWithPredicateOperatorType:
+            options |= NSAnchoredSearch;
+            break;
+        case NSEndsWithPredicateOperatorType:
+            options |= NSAnchoredSearch | NSBackwardsSearch;
+            break;
+        case NSContainsPredicateOperatorType:
+            break;
+        default:
+            return {};
+    }
+    return [=](RLMObjectBase *obj) {
+        NSString *str = object_value(obj, prop);
+        return str && [str rangeOfString:value options:options].location != NSNotFound;
+    };
+}
+
+// Compile a comparison between a property of the object and a constant into a
+// function which reads the property directly, after validating it as it
+// would be for a query. Returns an empty function for anything else.
+RLMObjectPredicate compile_object_comparison(NSComparisonPredicate *compp, RLMSchema *schema, RLMObjectSchema *desc) {
+    if (compp.comparisonPredicateModifier != NSDirectPredicateModifier) {
+        return {};
+    }
+
+    NSPredicateOperatorType operatorType = compp.predicateOperatorType;
+    NSExpression *keyPathExpression, *valueExpression;
+    if (compp.leftExpression.expressionType == NSKeyPathExpressionType
+        && compp.rightExpression.expressionType == NSConstantValueExpressionType) {
+        keyPathExpression = compp.leftExpression;
+        valueExpression = compp.rightExpression;
+    }
+    else if (compp.leftExpression.expressionType == NSConstantValueExpressionType
+             && compp.rightExpression.expressionType == NSKeyPathExpressionType) {
+        if (!is_range_operator(operatorType) && operatorType != NSEqualToPredicateOperatorType
+            && operatorType != NSNotEqualToPredicateOperatorType) {
+            return {};
+        }
+        keyPathExpression = compp.rightExpression;
+        valueExpression = compp.leftExpression;
+        operatorType = reversed_operator(operatorType);
+    }
+    else {
+        return {};
+    }
+
+    NSString *keyPath = keyPathExpression.keyPath;
+    if ([keyPath rangeOfString:@"."].location != NSNotFound || key_path_contains_collection_operator(keyPath)) {
+        return {};
+    }
+    bool isEquality = operatorType == NSEqualToPredicateOperatorType || operatorType == NSNotEqualToPredicateOperatorType;
+    if (!isEquality && !is_range_operator(operatorType) && operatorType != NSBeginsWithPredicateOperatorType
+        && operatorType != NSEndsWithPredicateOperatorType && operatorType != NSContainsPredicateOperatorType) {
+        return {};
+    }
+
+    ColumnReference column = column_reference_from_key_path(schema, desc, keyPath, false);
+    id value = RLMCoerceToNil(valueExpression.constantValue);
+    validate_property_value(column, value, @"Expected object of type %@ for property '%@' on object of type '%@', but received: %@", desc, keyPath);
+
+    RLMProperty *prop = column.property();
+    if (!value) {
+        if (!isEquality || !(prop.swiftIvar || prop.objcType == '@')) {
+            return {};
+        }
+        bool equal = operatorType == NSEqualToPredicateOperatorType;
+        return [=](RLMObjectBase *obj) {
+            return !object_value(obj, prop) == equal;
+        };
+    }
+
+    switch (prop.type) {
+        case RLMPropertyTypeInt:
+        case RLMPropertyTypeBool:
+        case RLMPropertyTypeFloat:
+        case RLMPropertyTypeDouble:
+            if (!isEquality && !is_range_operator(operatorType)) {
+                return {};
+            }
+            if (prop.type == RLMPropertyTypeFloat || prop.type == RLMPropertyTypeDouble || !is_integer_number(value)) {
+                return compile_number_comparison<double>(prop, operatorType, [value doubleValue]);
+            }
+            return compile_number_comparison<int64_t>(prop, operatorType, [value longLongValue]);
+        case RLMPropertyTypeString:
+            return compile_string_comparison(prop, operatorType, compp.options, value);
+        case RLMPropertyTypeDate: {
+            if (!isEquality && !is_range_operator(operatorType)) {
+                return {};
+            }
+            NSDate *date = value;
+            return [=](RLMObjectBase *obj) {
+                NSDate *propertyValue = object_value(obj, prop);
+                if (!propertyValue) {
+                    return operatorType == NSNotEqualToPredicateOperatorType;
+                }
+                return compare_values(operatorType, (int)[propertyValue compare:date], (int)NSOrderedSame);
+            };
+        }
+        default:
+            return {};
+    }
+}
+
+RLMObjectPredicate compile_object_predicate(NSPredicate *predicate, RLMSchema *schema, RLMObjectSchema *desc) {
+    if ([predicate isMemberOfClass:[NSCompoundPredicate class]]) {
+        NSCompoundPredicate *comp = (NSCompoundPredicate *)predicate;
+        std::vector<RLMObjectPredicate> subpredicates;
+        for (NSPredicate *subp in comp.subpredicates) {
+            auto compiled = compile_object_predicate(subp, schema, desc);
+            if (!compiled) {
+                return {};
+            }
+            subpredicates.push_back(std::move(compiled));
+        }
+
+        switch (comp.compoundPredicateType) {
+            case NSAndPredicateType:
+                return [=](RLMObjectBase *obj) {
+                    return std::all_of(subpredicates.begin(), subpredicates.end(), [&](auto const& subp) { return subp(obj); });
+                };
+            case NSOrPredicateType:
+                return [=](RLMObjectBase *obj) {
+                    return std::any_of(subpredicates.begin(), subpredicates.end(), [&](auto const& subp) { return subp(obj); });
+                };
+            case NSNotPredicateType:
+                if (subpredicates.size() != 1) {
+                    return {};
+                }
+                return [=](RLMObjectBase *obj) {
+                    return !subpredicates.front()(obj);
+                };
+            default:
+                return {};
+        }
+    }
+    if ([predicate isMemberOfClass:[NSComparisonPredicate class]]) {
+        return compile_object_comparison((NSComparisonPredicate *)predicate, schema, desc);
+    }
+    if ([predicate isEqual:[NSPredicate predicateWithValue:YES]]) {
+        return [](RLMObjectBase *) { return true; };
+    }
+    if ([predicate isEqual:[NSPredicate predicateWithValue:NO]]) {
+        return [](RLMObjectBase *) { return false; };
+    }
+    return {};
+}
+
+NSUInteger value_count(NSExpression *expression) {
+    if (expression.expressionType == NSAggregateExpressionType) {
+        return [expression.collection count];
+    }
+    if (expression.expressionType == NSConstantValueExpressionType
+        && [expression.constantValue respondsToSelector:@selector(count)]) {
+        return [expression.constantValue count];
+    }
+    return 0;
+}
+
+// Does the comparison match on the value of an indexed property of linked
+// objects, so that add_backlink_constraint_to_query() can be used for it?
+bool can_use_backlinks(NSComparisonPredicate *compp, RLMObjectSchema *desc) {
+    if (compp.predicateOperatorType != NSEqualToPredicateOperatorType || compp.options || !desc.realm) {
+        return false;
+    }
+    bool keyPathOnLeft = compp.leftExpression.expressionType == NSKeyPathExpressionType;
+    NSExpression *keyPathExpression = keyPathOnLeft ? compp.leftExpression : compp.rightExpression;
+    NSExpression *valueExpression = keyPathOnLeft ? compp.rightExpression : compp.leftExpression;
+    if (keyPathExpression.expressionType != NSKeyPathExpressionType
+        || valueExpression.expressionType != NSConstantValueExpressionType
+        || key_path_contains_collection_operator(keyPathExpression.keyPath)) {
+        return false;
+    }
+    NSArray *components = [keyPathExpression.keyPath componentsSeparatedByString:@"."];
+    if (components.count < 2) {
+        return false;
+    }
+
+    RLMSchema *schema = desc.realm.schema;
+    RLMObjectSchema *objectSchema = desc;
+    for (NSUInteger i = 0; i + 1 < components.count; ++i) {
+        RLMProperty *link = objectSchema[components[i]];
+        if (link.type != RLMPropertyTypeObject && link.type != RLMPropertyTypeArray) {
+            return false;
+        }
+        objectSchema = schema[link.objectClassName];
+    }
+    RLMProperty *prop = objectSchema[components.lastObject];
+    id value = valueExpression.constantValue;
+    return prop.indexed && ((prop.type == RLMPropertyTypeString && [value isKindOfClass:[NSString class]])
+                            || (prop.type == RLMPropertyTypeInt && [value isKindOfClass:[NSNumber class]]));
+}
+
+// How the condition on a single comparison is expected to be evaluated: via
+// the search index, the full-text index or the ordered index, by following
+// backlinks from the matches in a linked class's search index, from cached
+// link list aggregates, with a hash set of values, or by checking every row
+NSString *condition_strategy(NSComparisonPredicate *compp, RLMObjectSchema *desc) {
+    NSExpression *keyPathExpression = compp.leftExpression.expressionType == NSKeyPathExpressionType
+                                    ? compp.leftExpression : compp.rightExpression;
+    if (can_use_backlinks(compp, desc)) {
+        return @"backlinks";
+    }
+    if (keyPathExpression.expressionType == NSKeyPathExpressionType) {
+        NSArray *components = [keyPathExpression.keyPath componentsSeparatedByString:@"."];
+        if ((components.count == 2 && [components[1] isEqualToString:@"@count"])
+            || (components.count == 3 && [components[1] isEqualToString:@"@sum"])) {
+            if (desc[components[0]].cachedAggregates) {
+                return @"cached aggregates";
+            }
+        }
+    }
+    if (keyPathExpression.expressionType != NSKeyPathExpressionType
+        || [keyPathExpression.keyPath rangeOfString:@"."].location != NSNotFound
+        || key_path_contains_collection_operator(keyPathExpression.keyPath)) {
+        return @"scan";
+    }
+
+    RLMProperty *prop = desc[keyPathExpression.keyPath];
+    if (!prop) {
+        return @"scan";
+    }
+    if (compp.predicateOperatorType == NSInPredicateOperatorType && compp.options == 0
+        && (prop.type == RLMPropertyTypeInt || prop.type == RLMPropertyTypeString)
+        && value_count(compp.rightExpression) >= min_in_set_size) {
+        return @"hash set";
+    }
+    if (prop.textIndexed && compp.predicateOperatorType == NSContainsPredicateOperatorType
+        && compp.leftExpression == keyPathExpression
+        && compp.rightExpression.expressionType == NSConstantValueExpressionType
+        && can_use_text_index(compp.rightExpression.constantValue, compp.options)) {
+        return @"text index";
+    }
+    if (prop.indexed && prop.type == RLMPropertyTypeString && compp.options == 0
+        && (is_range_operator(compp.predicateOperatorType)
+            || (compp.predicateOperatorType == NSBeginsWithPredicateOperatorType && compp.leftExpression == keyPathExpression))) {
+        return @"ordered index";
+    }
+    if (prop.indexed && (prop.type == RLMPropertyTypeInt || prop.type == RLMPropertyTypeDate)
+        && (is_range_operator(compp.predicateOperatorType)
+            || compp.predicateOperatorType == NSBetweenPredicateOperatorType)) {
+        return @"ordered index";
+    }
+    if (prop.indexed && compp.options == 0
+        && (compp.predicateOperatorType == NSEqualToPredicateOperatorType
+            || compp.predicateOperatorType == NSInPredicateOperatorType)) {
+        return @"index";
+    }
+    return @"scan";
+}
+
+// A rough estimate of how expensive a condition of an AND group is to check
+// and how few rows it's likely to match, with lower being cheaper and more
+// selective: equality on an indexed property, then lookups in the other
+// indexes or via backlinks, then comparisons of numeric values, then of strings and other
+// properties, then substring searches, and finally anything which follows
+// links or is itself a compound predicate
+int conjunct_cost(NSPredicate *predicate, RLMObjectSchema *desc) {
+    if (![predicate isMemberOfClass:[NSComparisonPredicate class]]) {
+        return 5;
+    }
+    NSComparisonPredicate *compp = (NSComparisonPredicate *)predicate;
+    if (can_use_backlinks(compp, desc)) {
+        return 1;
+    }
+    if ([condition_strategy(compp, desc) isEqualToString:@"cached aggregates"]) {
+        return 2;
+    }
+    if (compp.comparisonPredicateModifier != NSDirectPredicateModifier) {
+        return 5;
+    }
+    bool leftIsKeyPath = compp.leftExpression.expressionType == NSKeyPathExpressionType;
+    bool rightIsKeyPath = compp.rightExpression.expressionType == NSKeyPathExpressionType;
+    NSString *keyPath = leftIsKeyPath ? compp.leftExpression.keyPath
+                      : rightIsKeyPath ? compp.rightExpression.keyPath : nil;
+    if (!keyPath || [keyPath rangeOfString:@"."].location != NSNotFound
+        || key_path_contains_collection_operator(keyPath)) {
+        return 5;
+    }
+    RLMProperty *prop = desc[keyPath];
+    if (!prop || prop.type == RLMPropertyTypeArray) {
+        return 5;
+    }
+
+    NSString *strategy = condition_strategy(compp, desc);
+    if ([strategy isEqualToString:@"index"]) {
+        return 0;
+    }
+    if ([strategy isEqualToString:@"ordered index"] || [strategy isEqualToString:@"text index"]) {
+        return 1;
+    }
+    if (leftIsKeyPath && rightIsKeyPath) {
+        return 3;
+    }
+    switch (prop.type) {
+        case RLMPropertyTypeInt:
+        case RLMPropertyTypeBool:
+        case RLMPropertyTypeFloat:
+        case RLMPropertyTypeDouble:
+        case RLMPropertyTypeDate:
+        case RLMPropertyTypeObject:
+            return 2;
+        default:
+            break;
+    }
+    switch (compp.predicateOperatorType) {
+        case NSContainsPredicateOperatorType:
+        case NSEndsWithPredicateOperatorType:
+        case NSLikePredicateOperatorType:
+        case NSMatchesPredicateOperatorType:
+            return 4;
+        default:
+            return 3;
+    }
+}
+
+// Sort the subpredicates of an AND group by their estimated cost, keeping the
+// order they were written in for those with the same cost. The conditions are
+// checked in the order they're added to the query, so this avoids checking an
+// unselective condition for every row before a selective one.
+NSArray *order_conjuncts(NSArray *subpredicates, RLMObjectSchema *desc) {
+    if (subpredicates.count < 2) {
+        return subpredicates;
+    }
+    std::vector<std::pair<int, NSPredicate *>> ranked;
+    ranked.reserve(subpredicates.count);
+    for (NSPredicate *subp in subpredicates) {
+        ranked.emplace_back(conjunct_cost(subp, desc), subp);
+    }
+    std::stable_sort(ranked.begin(), ranked.end(), [](auto const& a, auto const& b) { return a.first < b.first; });
+
+    NSMutableArray *ordered = [NSMutableArray arrayWithCapacity:ranked.size()];
+    for (auto const& subp : ranked) {
+        [ordered addObject:subp.second];
+    }
+    return ordered;
+}
+
+NSString *describe_predicate(NSPredicate *predicate, RLMObjectSchema *desc) {
+    if ([predicate isMemberOfClass:[NSCompoundPredicate class]]) {
+        NSCompoundPredicate *comp = (NSCompoundPredicate *)predicate;
+        if (comp.compoundPredicateType == NSNotPredicateType) {
+            return [@"NOT " stringByAppendingString:describe_predicate(comp.subpredicates.firstObject, desc)];
+        }
+
+        NSMutableArray *subpredicates = [NSMutableArray arrayWithCapacity:comp.subpredicates.count];
+        if (comp.compoundPredicateType != NSAndPredicateType) {
+            for (NSPredicate *subp in comp.subpredicates) {
+                [subpredicates addObject:describe_predicate(subp, desc)];
+            }
+        }
+        else {
+            // List the conditions in the order they're added to the query:
+            // those covered by a compound index first, then the rest by cost
+            CompoundIndexMatch match;
+            bool usesCompoundIndex = find_compound_index(comp.subpredicates, desc, match);
+            NSMutableArray *remaining = [NSMutableArray arrayWithCapacity:comp.subpredicates.count];
+            for (NSPredicate *subp in comp.subpredicates) {
+                if (usesCompoundIndex && match.uses(subp)) {
+                    [subpredicates addObject:[NSString stringWithFormat:@"%@ [compound index]", subp.predicateFormat]];
+                }
+                else {
+                    [remaining addObject:subp];
+                }
+            }
+            for (NSPredicate *subp in order_conjuncts(remaining, desc)) {
+                [subpredicates addObject:describe_predicate(subp, desc)];
+            }
+        }
+        NSString *separator = comp.compoundPredicateType == NSAndPredicateType ? @" AND " : @" OR ";
+        return [NSString stringWithFormat:@"(%@)", [subpredicates componentsJoinedByString:separator]];
+    }
+    if ([predicate isMemberOfClass:[NSComparisonPredicate class]]) {
+        NSComparisonPredicate *compp = (NSComparisonPredicate *)predicate;
+        return [NSString stringWithFormat:@"%@ [%@]", compp.predicateFormat, condition_strategy(compp, desc)];
+    }
+    return predicate.predicateFormat;
+}
+
+// Add the conditions of an AND group which compare a property of the object
+// with a constant or substitution variable in a way a search index could
+// answer. Conditions under OR
+// and NOT are skipped, as the index couldn't narrow down the rows scanned.
+void collect_conditions(NSPredicate *predicate, RLMObjectSchema *desc, std::vector<QueryCondition>& conditions) {
+    if ([predicate isMemberOfClass:[NSCompoundPredicate class]]) {
+        NSCompoundPredicate *comp = (NSCompoundPredicate *)predicate;
+        if (comp.compoundPredicateType == NSAndPredicateType) {
+            for (NSPredicate *subp in comp.subpredicates) {
+                collect_conditions(subp, desc, conditions);
+            }
+        }
+        return;
+    }
+    if (![predicate isMemberOfClass:[NSComparisonPredicate class]]) {
+        return;
+    }
+
+    NSComparisonPredicate *compp = (NSComparisonPredicate *)predicate;
+    bool leftIsKeyPath = compp.leftExpression.expressionType == NSKeyPathExpressionType;
+    NSExpression *keyPathExpression = leftIsKeyPath ? compp.leftExpression : compp.rightExpression;
+    NSExpression *valueExpression = leftIsKeyPath ? compp.rightExpression : compp.leftExpression;
+    if (compp.comparisonPredicateModifier != NSDirectPredicateModifier || compp.options != 0
+        || keyPathExpression.expressionType != NSKeyPathExpressionType
+        || (valueExpression.expressionType != NSConstantValueExpressionType
+            && valueExpression.expressionType != NSVariableExpressionType)
+        || [keyPathExpression.keyPath rangeOfString:@"."].location != NSNotFound) {
+        return;
+    }
+    RLMProperty *prop = desc[keyPathExpression.keyPath];
+    if (!prop) {
+        return;
+    }
+
+    switch (compp.predicateOperatorType) {
+        case NSEqualToPredicateOperatorType:
+        case NSInPredicateOperatorType:
+            conditions.push_back({prop.column, QueryCondition::Kind::Equal});
+            break;
+        case NSBeginsWithPredicateOperatorType:
+            if (leftIsKeyPath) {
+                conditions.push_back({prop.column, QueryCondition::Kind::Range});
+            }
+            break;
+        case NSLessThanPredicateOperatorType:
+        case NSLessThanOrEqualToPredicateOperatorType:
+        case NSGreaterThanPredicateOperatorType:
+        case NSGreaterThanOrEqualToPredicateOperatorType:
+        case NSBetweenPredicateOperatorType:
+            conditions.push_back({prop.column, QueryCondition::Kind::Range});
+            break;
+        default:
+            break;
+    }
+}
+
 } // namespace
 
 void RLMUpdateQueryWithPredicate(realm::Query *query, NSPredicate *predicate, RLMSchema *schema,
@@ -1124,14 +3060,104 @@ void RLMUpdateQueryWithPredicate(realm::Query *query, NSPredicate *predicate, RL
                     (int)validateMessage.size(), validateMessage.c_str());
 }
 
+RLMCompiledPredicate RLMCompilePredicate(NSPredicate *predicate, RLMSchema *schema,
+                                         RLMObjectSchema *objectSchema)
+{
+    RLMPrecondition([predicate isKindOfClass:NSPredicate.class], @"Invalid argument",
+                    @"predicate must be an NSPredicate object");
+
+    return compile_predicate(predicate, schema, objectSchema);
+}
+
+void RLMUpdateQueryWithCompiledPredicate(realm::Query *query, RLMCompiledPredicate const& predicate,
+                                         NSDictionary *variables)
+{
+    predicate(*query, variables);
+
+    // Test the constructed query in core
+    std::string validateMessage = query->validate();
+    RLMPrecondition(validateMessage.empty(), @"Invalid query", @"%.*s",
+                    (int)validateMessage.size(), validateMessage.c_str());
+}
+
+RLMObjectPredicate RLMCompileObjectPredicate(NSPredicate *predicate, RLMSchema *schema,
+                                             RLMObjectSchema *objectSchema)
+{
+    RLMPrecondition([predicate isKindOfClass:NSPredicate.class], @"Invalid argument",
+                    @"predicate must be an NSPredicate object");
+
+    return compile_object_predicate(predicate, schema, objectSchema);
+}
+
+std::function<std::string ()> RLMPredicateDescriptionFunction(NSPredicate *predicate, RLMObjectSchema *objectSchema,
+                                                              std::function<std::string ()> base) {
+    return [=] {
+        std::string description = describe_predicate(predicate, objectSchema).UTF8String;
+        if (base) {
+            return base() + " AND " + description;
+        }
+        return description;
+    };
+}
+
+std::function<std::vector<QueryCondition> ()> RLMPredicateConditionsFunction(NSPredicate *predicate,
+                                                                            RLMObjectSchema *objectSchema,
+                                                                            std::vector<QueryCondition> base) {
+    return [=] {
+        auto conditions = base;
+        if (predicate) {
+            collect_conditions(predicate, objectSchema, conditions);
+        }
+        return conditions;
+    };
+}
+
+// Strings are compared by their values folded as defined by the locale,
+// followed by a NUL and the original value to order strings which fold to the
+// same value, so that a shorter folded value sorts before any it prefixes
+static std::shared_ptr<const realm::Collation> RLMCollationForLocale(NSLocale *locale) {
+    auto collation = std::make_shared<realm::Collation>();
+    collation->name = std::string("folded:") + locale.localeIdentifier.UTF8String;
+    collation->make_key = [=](StringData value) {
+        @autoreleasepool {
+            NSString *string = RLMStringDataToNSString(value);
+            NSStringCompareOptions options = NSCaseInsensitiveSearch | NSDiacriticInsensitiveSearch | NSWidthInsensitiveSearch;
+            std::string key = [string stringByFoldingWithOptions:options locale:locale].UTF8String;
+            key.push_back('\0');
+            key.append(value.data(), value.size());
+            return key;
+        }
+    };
+    return collation;
+}
+
 realm::SortOrder RLMSortOrderFromDescriptors(RLMObjectSchema *objectSchema, NSArray *descriptors) {
     realm::SortOrder sort;
     sort.columnIndices.reserve(descriptors.count);
     sort.ascending.reserve(descriptors.count);
 
     for (RLMSortDescriptor *descriptor in descriptors) {
-        sort.columnIndices.push_back(RLMValidatedPropertyForSort(objectSchema, descriptor.property).column);
+        std::vector<size_t> linkPath;
+        RLMProperty *prop = RLMValidatedPropertyForSort(objectSchema, descriptor.property, linkPath);
+        if (!linkPath.empty()) {
+            sort.link_paths.resize(sort.columnIndices.size());
+            sort.link_paths.push_back(std::move(linkPath));
+        }
+        sort.columnIndices.push_back(prop.column);
         sort.ascending.push_back(descriptor.ascending);
+        if (descriptor.locale) {
+            RLMPrecondition(prop.type == RLMPropertyTypeString, @"Invalid sort property",
+                            @"Cannot sort on property '%@' on object of type '%@' with a locale: only string properties can be sorted with a locale.",
+                            prop.name, objectSchema.className);
+            sort.collations.resize(sort.columnIndices.size() - 1);
+            sort.collations.push_back(RLMCollationForLocale(descriptor.locale));
+        }
+    }
+    if (!sort.collations.empty()) {
+        sort.collations.resize(sort.columnIndices.size());
+    }
+    if (!sort.link_paths.empty()) {
+        sort.link_paths.resize(sort.columnIndices.size());
     }
 
     return sort;
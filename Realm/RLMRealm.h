@@ -19,7 +19,7 @@
 #import <Foundation/Foundation.h>
 #import <Realm/RLMDefines.h>
 
-@class RLMRealmConfiguration, RLMObject, RLMSchema, RLMMigration, RLMNotificationToken;
+@class RLMRealmConfiguration, RLMObject, RLMResults, RLMSchema, RLMMigration, RLMNotificationToken, RLMTransactionMetrics, RLMSnapshot, RLMRealmChange, RLMFileSpaceUsage, RLMIndexRecommendation, RLMPropertyStatistics, RLMThreadSafeReference;
 
 RLM_ASSUME_NONNULL_BEGIN
 
@@ -78,6 +78,29 @@ RLM_ASSUME_NONNULL_BEGIN
  */
 + (nullable instancetype)realmWithConfiguration:(RLMRealmConfiguration *)configuration error:(NSError **)error;
 
+/**
+ Obtains an `RLMRealm` instance with the given configuration which is confined
+ to a serial dispatch queue rather than to the current thread.
+
+ The returned Realm can be used from any block running on `queue`, whichever
+ thread runs it, and is shared by all of them. Change notifications and
+ autorefresh are delivered by dispatching to `queue` rather than via the
+ current thread's run loop. This method must be called from a block running
+ on `queue`.
+
+ @param configuration The configuration for the realm.
+ @param queue         The serial queue to confine the Realm to. If `nil`, this
+                      is the same as `+realmWithConfiguration:error:`.
+ @param error         If an error occurs, upon return contains an `NSError` object
+                      that describes the problem. If you are not interested in
+                      possible errors, pass in `NULL`.
+
+ @return An `RLMRealm` instance.
+ */
++ (nullable instancetype)realmWithConfiguration:(RLMRealmConfiguration *)configuration
+                                          queue:(nullable dispatch_queue_t)queue
+                                          error:(NSError **)error;
+
 /**
  Obtains an `RLMRealm` instance persisted at a specific file path.
 
@@ -166,6 +189,15 @@ typedef void(^RLMNotificationBlock)(NSString *notification, RLMRealm *realm);
  */
 - (void)removeNotification:(RLMNotificationToken *)notificationToken;
 
+/**
+ The versions and modified classes for the most recent change to this Realm.
+
+ This is updated immediately before `RLMRealmDidChangeNotification` is sent, so
+ notification blocks can use it to decide whether data they have derived from
+ the Realm is still valid. It is nil until the first change notification.
+ */
+@property (nonatomic, readonly, nullable) RLMRealmChange *lastChange;
+
 #pragma mark - Transactions
 
 
@@ -268,6 +300,111 @@ typedef void(^RLMNotificationBlock)(NSString *notification, RLMRealm *realm);
  */
 - (BOOL)transactionWithBlock:(RLM_NOESCAPE void(^)(void))block error:(NSError **)error;
 
+/**
+ Performs actions contained within the given block inside a write transaction
+ which may be shared with other threads.
+
+ When several threads call this method for the same Realm file at the same
+ time, their blocks are run one after another on one of the threads inside a
+ single write transaction, which is then committed to disk once and produces a
+ single change notification. This makes many small concurrent write
+ transactions much faster, as the cost of committing is shared between them.
+ Each call returns once the write transaction containing its block has been
+ committed.
+
+ The block itself may be run on a different thread than the one which called
+ this method, and is passed the `RLMRealm` belonging to that thread to perform
+ its reads and writes with. The
+ block must not use any other `RLMRealm` or any objects obtained outside of the
+ block, and must not begin, commit or cancel write transactions itself. Using
+ objects which belong to the calling thread throws an exception whenever the
+ block is run on another thread.
+
+ If the block throws an exception before making any changes, it is left out of
+ the group and the exception is rethrown from this method. If it throws after
+ making changes, the write transaction is rolled back and the blocks from the
+ other threads in the group are performed again in a new write transaction.
+ Blocks should therefore not have side effects other than writing to the Realm.
+
+ This `RLMRealm` is updated to the latest version before returning, as if
+ `refresh` was called.
+
+ @warning This method cannot be called during a write transaction.
+
+ @param block The block to perform.
+ @param error If an error occurs, upon return contains an `NSError` object
+              that describes the problem. If you are not interested in
+              possible errors, pass in `NULL`.
+
+ @return Whether the transaction succeeded.
+ */
+- (BOOL)groupedTransactionWithBlock:(void(^)(RLMRealm *realm))block error:(NSError **)error;
+
+/**
+ Performs actions contained within the given block inside a write transaction
+ on a background thread, without blocking the calling thread.
+
+ The write transactions for each Realm file are performed one at a time, in the
+ order they were requested, on a thread dedicated to writing to that file. The
+ block is passed the `RLMRealm` for that thread, which it must use for all of
+ its reads and writes. The block must not use any objects obtained from other
+ threads, and must not commit or cancel the write transaction itself.
+
+ Once the write transaction has been committed, or has failed, this `RLMRealm`
+ is refreshed to the latest version and then the completion block is called on
+ the current thread. This requires the current thread to have a run loop which
+ is being run, as with notifications.
+
+ If the block throws an exception, the write transaction is rolled back and the
+ error is passed to the completion block rather than being rethrown.
+
+ @warning This method cannot be used with dynamic Realms.
+
+ @param block       The block to perform on the writer thread.
+ @param completion  A block called on the current thread once the write
+                    transaction has finished, with an `NSError` describing the
+                    problem if it could not be committed.
+ */
+- (void)asyncTransactionWithBlock:(void(^)(RLMRealm *realm))block
+                       completion:(nullable void(^)(NSError * __nullable error))completion;
+
+/**
+ Queues a block to be performed in a write transaction on the same background
+ thread as `asyncTransactionWithBlock:completion:`, and returns immediately.
+
+ Blocks queued this way from any number of threads are committed together, in
+ write transactions of up to the configuration's `writeBehindBatchSize` blocks,
+ so that many small writes share one commit rather than each waiting for the
+ write lock. Blocks queued by one thread are performed in the order they were
+ queued. As with `asyncTransactionWithBlock:completion:`, the block is always
+ run on the writer thread rather than the calling thread, is passed the writer
+ thread's `RLMRealm`, and must not use objects from other threads.
+
+ If a block throws an exception after making changes, its write transaction is
+ rolled back and the blocks which were performed before it in that transaction
+ are performed a second time. Blocks may therefore run more than once, and
+ should not have side effects other than writing to the Realm. A block which
+ throws before making any changes is simply left out. In both cases the error
+ is reported by the next call to `flushWriteBehind:`.
+
+ @warning This method cannot be used with dynamic Realms.
+
+ @param block   The block to perform on the writer thread.
+ */
+- (void)writeBehind:(void(^)(RLMRealm *realm))block;
+
+/**
+ Waits until every block passed to `writeBehind:` on any thread before this call
+ has been committed, and then refreshes this Realm.
+
+ @param error   If a write-behind block threw an exception or its transaction
+                could not be committed since the previous flush, upon return
+                contains an `NSError` describing the first such problem.
+
+ @return Whether every write-behind block since the previous flush succeeded.
+ */
+- (BOOL)flushWriteBehind:(NSError **)error;
+
 /**
  Update an `RLMRealm` and outstanding objects to point to the most recent data for this `RLMRealm`.
 
@@ -335,6 +472,120 @@ typedef void(^RLMNotificationBlock)(NSString *notification, RLMRealm *realm);
 */
 - (BOOL)writeCopyToPath:(NSString *)path encryptionKey:(NSData *)key error:(NSError **)error;
 
+/**
+ A snapshot of the timings of the write transactions, commits and refreshes
+ performed by this `RLMRealm` instance, and of the queries, accessors and
+ notifications handled for it, since it was created or
+ `resetTransactionMetrics` was last called.
+
+ Only the work done by this instance is included, and not that of other
+ instances for the same file on other threads.
+ */
+@property (nonatomic, readonly) RLMTransactionMetrics *transactionMetrics;
+
+/**
+ Reset the `transactionMetrics` for this `RLMRealm` instance.
+ */
+- (void)resetTransactionMetrics;
+
+/**
+ Reports how the space in the Realm file is used, for deciding when it is worth
+ compacting it with `-writeCopyToPath:error:` or
+ `RLMRealmConfiguration.compactOnOpenFreeSpaceRatio`.
+
+ This reads every object in the Realm, so takes time proportional to the amount
+ of data. Must not be called on a read-only Realm.
+ */
+- (RLMFileSpaceUsage *)fileSpaceUsage;
+
+/**
+ Returns the statistics of the values of a property over every object of a
+ class, as for `-[RLMResults statisticsForProperty:]` on `-allObjects:`.
+
+ The statistics are computed the first time they are requested and kept until
+ the Realm next changes, so this is cheap to call repeatedly between changes.
+
+ @param property  The name of the property.
+ @param className The name of the `RLMObject` subclass.
+
+ @return The statistics of the property's values.
+ */
+- (RLMPropertyStatistics *)statisticsForProperty:(NSString *)property ofClass:(NSString *)className;
+
+/**
+ Recommends search indexes to add or remove, based on the queries run by this
+ `RLMRealm` instance since it was created or `resetQueryWorkload` was last
+ called. Queries are only recorded if the Realm's configuration has
+ `recordsQueryWorkload` set.
+
+ Adding an index is recommended for each unindexed property which is compared
+ for equality or with a range by queries which together ran at least
+ `minimumQueryCount` times and went over an average of at least
+ `minimumObjectsScanned` objects each time. Queries which already compare an
+ indexed property for equality don't count, as they are answered from that
+ index. Removing an index is recommended for each indexed property other than
+ the primary key which none of the queries on a class queried at least
+ `minimumQueryCount` times used, as every write to an indexed property also has
+ to update its index.
+
+ Apply the recommendations by changing `indexedProperties`. No migration is
+ needed to add or remove an index.
+
+ @param minimumQueryCount     The number of times queries must have run.
+ @param minimumObjectsScanned The average number of objects they must have
+                              gone over.
+
+ @return An array of `RLMIndexRecommendation`s.
+ */
+- (NSArray RLM_GENERIC(RLMIndexRecommendation *) *)indexRecommendationsWithMinimumQueryCount:(NSUInteger)minimumQueryCount
+                                                                      minimumObjectsScanned:(NSUInteger)minimumObjectsScanned;
+
+/**
+ Recommends search indexes to add or remove for queries which ran at least 10
+ times over an average of at least 1000 objects.
+
+ @see -indexRecommendationsWithMinimumQueryCount:minimumObjectsScanned:
+ */
+- (NSArray RLM_GENERIC(RLMIndexRecommendation *) *)indexRecommendations;
+
+/**
+ Discard the queries recorded for `indexRecommendations` by this `RLMRealm`
+ instance.
+ */
+- (void)resetQueryWorkload;
+
+/**
+ Creates an immutable snapshot of the version of the data this Realm is
+ currently reading, which can be read from any number of threads at once.
+
+ This cannot be called on a read-only Realm or within a write transaction.
+
+ @return An `RLMSnapshot` at this Realm's current version.
+
+ @see RLMSnapshot
+ */
+- (RLMSnapshot *)snapshot;
+
+/**
+ Get the object, results or array which a thread-safe reference refers to from
+ this Realm, which must be for the same file as the Realm the reference was
+ created from.
+
+ If this Realm is at an older version than the reference was created at, it is
+ first refreshed to that version, sending the same notifications as
+ `-refresh`. Each reference can only be resolved once.
+
+ This cannot be called within a write transaction.
+
+ @param reference The reference to resolve.
+
+ @return The referenced `RLMObject`, `RLMResults` or `RLMArray`, or `nil` if the
+         object (or the object owning the array) has since been deleted.
+
+ @see RLMThreadSafeReference
+ */
+- (nullable id)resolveThreadSafeReference:(RLMThreadSafeReference *)reference;
+
 /**
  Invalidate all RLMObjects and RLMResults read from this Realm.
 
@@ -442,6 +693,25 @@ typedef void(^RLMNotificationBlock)(NSString *notification, RLMRealm *realm);
  */
 - (void)deleteObjects:(id)array;
 
+/**
+ Delete the objects in an `RLMResults` from this Realm in a series of write
+ transactions which each delete at most `batchSize` objects.
+
+ The objects are found and deleted a chunk at a time, so deleting a very large
+ number of objects does not need memory proportional to the number of objects,
+ and other threads and processes can write between the batches. Objects which
+ are added by other threads between batches and which match the results'
+ query may also be deleted.
+
+ @warning This method cannot be called during a write transaction, as it
+          begins and commits its own.
+
+ @param results     The objects to delete.
+ @param batchSize   The number of objects to delete in each write transaction,
+                    or 0 to delete all of them in a single one.
+ */
+- (void)deleteObjects:(RLMResults *)results batchSize:(NSUInteger)batchSize;
+
 /**
  Deletes all objects in this Realm.
 
@@ -449,6 +719,100 @@ typedef void(^RLMNotificationBlock)(NSString *notification, RLMRealm *realm);
  */
 - (void)deleteAllObjects;
 
+#pragma mark - Importing Objects
+
+/**
+ Formats of data which can be imported into a Realm.
+ */
+typedef NS_ENUM(NSUInteger, RLMImportFormat) {
+    /** A JSON array of objects whose keys are property names. */
+    RLMImportFormatJSON,
+    /** CSV with a header line of property names. Empty fields which are not quoted are read as `nil`. */
+    RLMImportFormatCSV,
+};
+
+/**
+ Create objects of the given class from JSON or CSV data read from a stream.
+
+ The data is read and written to the Realm incrementally without creating an
+ object for each value, making this much faster than creating objects from
+ parsed JSON for large imports. Only properties of types which can be
+ represented by a single JSON or CSV value can be imported, and dates are read
+ as a number of seconds since 1970. Properties missing from the data take on a
+ value of `nil`, and default property values are not used.
+
+ The objects are added in a series of write transactions, so this method can
+ not be called from within a write transaction. If an error occurs, the objects
+ added by the transactions which were already committed are kept.
+
+ @param className   The name of the class of the objects to create.
+ @param stream      The stream to read from. It is opened if it is not already open.
+ @param format      The format of the data.
+ @param error       If an error occurs, upon return contains an `NSError` object
+                    that describes the problem. If you are not interested in
+                    possible errors, pass in `NULL`.
+
+ @return YES if all of the objects were imported successfully.
+ */
+- (BOOL)importObjectsWithClassName:(NSString *)className
+                        fromStream:(NSInputStream *)stream
+                            format:(RLMImportFormat)format
+                             error:(NSError **)error;
+
+/**
+ Create objects of the given class from JSON or CSV data read from a file descriptor.
+
+ @see -importObjectsWithClassName:fromStream:format:error:
+
+ @param className       The name of the class of the objects to create.
+ @param fileDescriptor  The file descriptor to read from until the end of the
+                        file. It is not closed.
+ @param format          The format of the data.
+ @param error           If an error occurs, upon return contains an `NSError` object
+                        that describes the problem. If you are not interested in
+                        possible errors, pass in `NULL`.
+
+ @return YES if all of the objects were imported successfully.
+ */
+- (BOOL)importObjectsWithClassName:(NSString *)className
+                fromFileDescriptor:(int)fileDescriptor
+                            format:(RLMImportFormat)format
+                             error:(NSError **)error;
+
+#pragma mark - Copying Objects Between Realms
+
+/**
+ Copy all of the objects of the given classes from another Realm into this one.
+
+ The objects are copied a property at a time directly between the two Realm
+ files, without creating or validating an object for each one, making this
+ much faster than re-creating each object with `createInRealm:withValue:`.
+ Links between the copied objects are pointed at the copies of the objects
+ they linked to. The copies are added alongside any objects already in this
+ Realm.
+
+ Each class must have the same properties in both Realms, and every class
+ linked to by a copied class must also be copied. No copied object may have
+ the same primary key as an object already in this Realm. These requirements
+ are checked before any objects are copied.
+
+ The copies are written in the current write transaction if there is one, and
+ otherwise in a single write transaction which this method begins and commits.
+
+ @param classNames  The names of the classes to copy, or `nil` to copy every
+                    class in the source Realm's schema.
+ @param realm       The Realm to copy from, which must be a different Realm
+                    file open on the current thread.
+ @param error       If an error occurs, upon return contains an `NSError` object
+                    that describes the problem. If you are not interested in
+                    possible errors, pass in `NULL`.
+
+ @return YES if the objects were copied successfully.
+ */
+- (BOOL)copyObjectsWithClassNames:(nullable NSArray RLM_GENERIC(NSString *) *)classNames
+                        fromRealm:(RLMRealm *)realm
+                            error:(NSError **)error;
+
 
 #pragma mark - Migrations
 
@@ -510,4 +874,107 @@ typedef void (^RLMMigrationBlock)(RLMMigration *migration, uint64_t oldSchemaVer
 @interface RLMNotificationToken : NSObject
 @end
 
+/**
+ Describes a change to a Realm which an `RLMRealmDidChangeNotification` was sent
+ for. Obtained from `-[RLMRealm lastChange]`.
+ */
+@interface RLMRealmChange : NSObject
+
+/**
+ The version of the Realm's read transaction before the change. Zero if the
+ Realm was not in a read transaction.
+ */
+@property (nonatomic, readonly) uint64_t oldVersion;
+
+/**
+ The version of the Realm's read transaction after the change.
+ */
+@property (nonatomic, readonly) uint64_t newVersion;
+
+/**
+ The number of write transactions made by any thread or process between the two
+ versions.
+ */
+@property (nonatomic, readonly) uint64_t commitCount;
+
+/**
+ The names of the classes with objects which were inserted, deleted or modified.
+ nil if which classes changed is not known, for example after a write transaction
+ on this Realm or when new classes were added. Any class may have changed in
+ that case.
+ */
+@property (nonatomic, readonly, nullable) NSSet RLM_GENERIC(NSString *) *modifiedClassNames;
+
+@end
+
+/**
+ A report of how the space in a Realm file is used. Obtained from
+ `-[RLMRealm fileSpaceUsage]`.
+ */
+@interface RLMFileSpaceUsage : NSObject
+
+/// The size of the file in bytes.
+@property (nonatomic, readonly) unsigned long long fileSize;
+
+/// Bytes which are free to be reused by later commits, and which would be
+/// reclaimed by compacting the file.
+@property (nonatomic, readonly) unsigned long long freeSize;
+
+/// Bytes used by the current version of the data and by older versions which
+/// are still being read by some thread or process.
+@property (nonatomic, readonly) unsigned long long usedSize;
+
+/// Bytes used only by those older versions, which will become free once they
+/// are no longer being read. This is estimated as the used bytes not accounted
+/// for by `classSizes` and `indexSizes`, so also includes the schema and other
+/// bookkeeping stored in the file.
+@property (nonatomic, readonly) unsigned long long pinnedVersionsSize;
+
+/// The number of versions of the data being kept in the file.
+@property (nonatomic, readonly) uint64_t versionCount;
+
+/// The bytes used by the objects of each class in the current version, as
+/// `NSNumber`s keyed by class name, not including search indexes.
+@property (nonatomic, readonly) NSDictionary RLM_GENERIC(NSString *, NSNumber *) *classSizes;
+
+/// The bytes used by the search index of each indexed property, as
+/// dictionaries keyed by class name of `NSNumber`s keyed by property name.
+@property (nonatomic, readonly) NSDictionary RLM_GENERIC(NSString *, NSDictionary *) *indexSizes;
+
+@end
+
+/// Whether an `RLMIndexRecommendation` is to add or remove an index.
+typedef NS_ENUM(NSInteger, RLMIndexRecommendationAction) {
+    /// Add the property to `indexedProperties`.
+    RLMIndexRecommendationActionAdd,
+    /// Remove the property from `indexedProperties`.
+    RLMIndexRecommendationActionRemove,
+};
+
+/**
+ A recommendation to add or remove the search index of a property. Obtained
+ from `-[RLMRealm indexRecommendations]`.
+ */
+@interface RLMIndexRecommendation : NSObject
+
+/// Whether to add or remove the index.
+@property (nonatomic, readonly) RLMIndexRecommendationAction action;
+
+/// The name of the class the property belongs to.
+@property (nonatomic, readonly) NSString *className;
+
+/// The name of the property.
+@property (nonatomic, readonly) NSString *propertyName;
+
+/// For additions, the number of times queries which could have used the index
+/// ran. For removals, the number of times queries on the class ran without
+/// using it.
+@property (nonatomic, readonly) uint64_t queryCount;
+
+/// For additions, the total number of objects the queries went over.
+/// Zero for removals.
+@property (nonatomic, readonly) uint64_t objectsScanned;
+
+@end
+
 RLM_ASSUME_NONNULL_END
@@ -32,10 +32,16 @@
 #import "RLMQueryUtil.hpp"
 #import "RLMRealmUtil.hpp"
 #import "RLMSchema_Private.hpp"
+#import "RLMSnapshot_Private.hpp"
+#import "RLMThreadSafeReference_Private.hpp"
+#import "RLMTransactionMetrics_Private.hpp"
 #import "RLMUpdateChecker.hpp"
 #import "RLMUtil.hpp"
 
+#include "object_copier.hpp"
+#include "object_importer.hpp"
 #include "object_store.hpp"
+#include "realm_snapshot.hpp"
 #include "schema.hpp"
 #include "shared_realm.hpp"
 
@@ -43,6 +49,8 @@
 #include <realm/disable_sync_to_disk.hpp>
 #include <realm/version.hpp>
 
+#include <algorithm>
+
 using namespace realm;
 using util::File;
 
@@ -59,15 +67,10 @@ void RLMDisableSyncToDisk() {
 }
 
 // Notification Token
-@interface RLMNotificationToken ()
-@property (nonatomic, strong) RLMRealm *realm;
-@property (nonatomic, copy) RLMNotificationBlock block;
-@end
-
 @implementation RLMNotificationToken
 - (void)dealloc
 {
-    if (_realm || _block) {
+    if (_realm || _block || _unregisterBlock) {
         NSLog(@"RLMNotificationToken released without unregistering a notification. You must hold "
               @"on to the RLMNotificationToken returned from addNotificationBlock and call "
               @"removeNotification: when you no longer wish to recieve RLMRealm notifications.");
@@ -75,6 +78,96 @@ void RLMDisableSyncToDisk() {
 }
 @end
 
+@implementation RLMRealmChange
+- (instancetype)initWithVersionChange:(realm::BindingContext::VersionChange const&)change
+                                group:(realm::Group *)group {
+    self = [super init];
+    if (self) {
+        _oldVersion = change.old_version;
+        _newVersion = change.new_version;
+        _commitCount = change.commit_count();
+        if (change.modified_tables_known && group) {
+            NSMutableSet *classNames = [NSMutableSet new];
+            for (size_t table_ndx : change.modified_tables) {
+                // Tables which aren't for object classes (such as the metadata
+                // table) have no object type
+                auto objectType = realm::ObjectStore::object_type_for_table_name(group->get_table_name(table_ndx));
+                if (objectType.size()) {
+                    [classNames addObject:RLMStringDataToNSString(objectType)];
+                }
+            }
+            _modifiedClassNames = [classNames copy];
+        }
+    }
+    return self;
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<RLMRealmChange: %p> versions %llu to %llu (%llu commits), modified classes: %@",
+            self, _oldVersion, _newVersion, _commitCount, _modifiedClassNames];
+}
+@end
+
+@implementation RLMFileSpaceUsage
+- (instancetype)initWithStatistics:(realm::FileStatistics const&)stats {
+    self = [super init];
+    if (self) {
+        _fileSize = stats.file_size;
+        _freeSize = stats.free_space;
+        _usedSize = stats.used_space;
+        _versionCount = stats.version_count;
+
+        unsigned long long tablesSize = 0;
+        NSMutableDictionary *classSizes = [NSMutableDictionary new];
+        NSMutableDictionary *indexSizes = [NSMutableDictionary new];
+        for (auto const& table : stats.tables) {
+            NSString *className = @(table.object_type.c_str());
+            classSizes[className] = @(table.data_size);
+            tablesSize += table.data_size;
+
+            NSMutableDictionary *propertySizes = [NSMutableDictionary new];
+            for (auto const& index : table.index_sizes) {
+                propertySizes[@(index.first.c_str())] = @(index.second);
+                tablesSize += index.second;
+            }
+            if (propertySizes.count) {
+                indexSizes[className] = [propertySizes copy];
+            }
+        }
+        _classSizes = [classSizes copy];
+        _indexSizes = [indexSizes copy];
+        _pinnedVersionsSize = _usedSize > tablesSize ? _usedSize - tablesSize : 0;
+    }
+    return self;
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<RLMFileSpaceUsage: %p> file size %llu, free %llu, used %llu (%llu by %llu versions other than the current one), classes: %@, indexes: %@",
+            self, _fileSize, _freeSize, _usedSize, _pinnedVersionsSize, _versionCount - 1, _classSizes, _indexSizes];
+}
+@end
+
+@implementation RLMIndexRecommendation
+- (instancetype)initWithRecommendation:(realm::QueryWorkload::IndexRecommendation const&)recommendation {
+    self = [super init];
+    if (self) {
+        _action = recommendation.action == realm::QueryWorkload::IndexRecommendation::Action::Add
+                ? RLMIndexRecommendationActionAdd : RLMIndexRecommendationActionRemove;
+        _className = @(recommendation.object_type.c_str());
+        _propertyName = @(recommendation.property.c_str());
+        _queryCount = recommendation.runs;
+        _objectsScanned = recommendation.rows_scanned;
+    }
+    return self;
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<RLMIndexRecommendation: %p> %@ index on %@.%@ (%llu queries, %llu objects scanned)",
+            self, _action == RLMIndexRecommendationActionAdd ? @"add" : @"remove",
+            _className, _propertyName, _queryCount, _objectsScanned];
+}
+@end
+
 static bool shouldForciblyDisableEncryption() {
     static bool disableEncryption = getenv("REALM_DISABLE_ENCRYPTION");
     return disableEncryption;
@@ -97,9 +190,144 @@ NSData *RLMRealmValidatedEncryptionKey(NSData *key) {
     return key;
 }
 
+RLMObjectBase *RLMAccessorIdentityMap::get(realm::Realm& realm, RLMObjectSchema *objectSchema,
+                                           realm::Table const* table, size_t row) {
+    update(realm);
+
+    auto it = m_accessors.find({table, row});
+    if (it == m_accessors.end()) {
+        return nil;
+    }
+    RLMObjectBase *accessor = it->second;
+    if (accessor && accessor->_objectSchema == objectSchema && accessor->_row.is_attached()
+        && accessor->_row.get_table() == table && accessor->_row.get_index() == row) {
+        return accessor;
+    }
+    return nil;
+}
+
+void RLMAccessorIdentityMap::add(realm::Realm& realm, realm::Table const* table, size_t row, RLMObjectBase *accessor) {
+    // The new entry is keyed by the row's current index, so any moves made
+    // before now must be applied to the existing ones first
+    update(realm);
+    if (m_accessors.size() >= m_prune_size) {
+        prune();
+    }
+    m_accessors[{table, row}] = accessor;
+}
+
+void RLMAccessorIdentityMap::update(realm::Realm& realm) {
+    auto version = realm.current_transaction_version();
+    auto write_count = realm.write_transaction_count();
+    if (version != m_version || write_count != m_write_count) {
+        rekey();
+        m_version = version;
+        m_write_count = write_count;
+
+        // The keys now match the accessors' current rows, so only moves made
+        // by the rest of the write transaction need to be followed
+        m_log_parser.reset();
+        if (realm.is_in_transaction()) {
+            realm::_impl::TransactionChangeInfo changes;
+            realm.parse_uncommitted_row_index_changes(m_log_parser, changes);
+        }
+        return;
+    }
+    if (realm.is_in_transaction()) {
+        follow_row_moves(realm);
+    }
+}
+
+void RLMAccessorIdentityMap::follow_row_moves(realm::Realm& realm) {
+    using Kind = realm::_impl::TransactionChangeInfo::TableChanges::RowIndexChange::Kind;
+
+    realm::_impl::TransactionChangeInfo changes;
+    realm.parse_uncommitted_row_index_changes(m_log_parser, changes);
+    if (changes.schema_changed) {
+        rekey();
+        return;
+    }
+
+    for (size_t i = 0; i < changes.tables.size(); ++i) {
+        auto const& table_changes = changes.tables[i];
+        if (table_changes.row_index_changes.empty() && !table_changes.row_indexes_lost) {
+            continue;
+        }
+        if (table_changes.row_indexes_lost) {
+            rekey();
+            return;
+        }
+
+        realm::Table const* table = realm.read_group()->get_table(i).get();
+        for (auto const& change : table_changes.row_index_changes) {
+            switch (change.kind) {
+                case Kind::MoveLastOver:
+                    m_accessors.erase({table, change.row});
+                    if (change.other_or_count != change.row) {
+                        move(table, change.other_or_count, change.row);
+                    }
+                    break;
+                case Kind::Swap: {
+                    auto it = m_accessors.find({table, change.row});
+                    RLMObjectBase *first = it == m_accessors.end() ? nil : it->second;
+                    if (it != m_accessors.end()) {
+                        m_accessors.erase(it);
+                    }
+                    move(table, change.other_or_count, change.row);
+                    if (first) {
+                        m_accessors[{table, change.other_or_count}] = first;
+                    }
+                    break;
+                }
+                default:
+                    // Inserting, erasing in order and clearing shift or remove
+                    // every later row, which the accessors already reflect
+                    rekey();
+                    return;
+            }
+        }
+    }
+}
+
+void RLMAccessorIdentityMap::move(realm::Table const* table, size_t from, size_t to) {
+    auto it = m_accessors.find({table, from});
+    if (it == m_accessors.end()) {
+        return;
+    }
+    RLMObjectBase *accessor = it->second;
+    m_accessors.erase(it);
+    if (accessor) {
+        m_accessors[{table, to}] = accessor;
+    }
+}
+
+void RLMAccessorIdentityMap::rekey() {
+    decltype(m_accessors) accessors;
+    accessors.reserve(m_accessors.size());
+    for (auto const& entry : m_accessors) {
+        RLMObjectBase *accessor = entry.second;
+        if (accessor && accessor->_row.is_attached()) {
+            accessors.emplace(Key{accessor->_row.get_table(), accessor->_row.get_index()}, accessor);
+        }
+    }
+    m_accessors = std::move(accessors);
+}
+
+void RLMAccessorIdentityMap::prune() {
+    for (auto it = m_accessors.begin(); it != m_accessors.end(); ) {
+        RLMObjectBase *accessor = it->second;
+        it = accessor ? std::next(it) : m_accessors.erase(it);
+    }
+    m_prune_size = std::max<size_t>(1024, m_accessors.size() * 2);
+}
+
 @implementation RLMRealm {
-    NSHashTable *_collectionEnumerators;
+    // The head of an intrusive list of the enumerators which have not yet
+    // been detached. Enumerators remove themselves when they finish or are
+    // deallocated, so registering and unregistering is a few pointer writes.
+    __unsafe_unretained RLMFastEnumerator *_firstEnumerator;
     NSHashTable *_notificationHandlers;
+    NSCache *_cachedResults;
 }
 
 + (BOOL)isCoreDebug {
@@ -115,15 +343,25 @@ NSData *RLMRealmValidatedEncryptionKey(NSData *key) {
 
     RLMCheckForUpdates();
     RLMInstallUncaughtExceptionHandler();
+    RLMInstallMemoryPressureHandler();
     RLMSendAnalytics();
 }
 
+- (void)setSchema:(RLMSchema *)schema {
+    _schema = schema;
+    _objectSchemaForClass.clear();
+    if (_accessorIdentityMap) {
+        _accessorIdentityMap->clear();
+    }
+}
+
 - (BOOL)isEmpty {
     return realm::ObjectStore::is_empty(self.group);
 }
 
 - (void)verifyThread {
     _realm->verify_thread();
+    _realm->did_access();
 }
 
 - (BOOL)inWriteTransaction {
@@ -221,6 +459,7 @@ static void RLMRealmSetSchemaAndAlign(RLMRealm *realm, RLMSchema *targetSchema)
     RLMRealm *realm = [RLMRealm new];
     realm->_realm = sharedRealm;
     realm->_dynamic = YES;
+    realm->_enumerationBatchSize = RLMDefaultEnumerationBatchSize;
     RLMRealmSetSchemaAndAlign(realm, schema);
     return RLMAutorelease(realm);
 }
@@ -269,15 +508,26 @@ static void RLMRealmSetSchemaAndAlign(RLMRealm *realm, RLMSchema *targetSchema)
 }
 
 + (instancetype)realmWithConfiguration:(RLMRealmConfiguration *)configuration error:(NSError **)error {
+    return [self realmWithConfiguration:configuration queue:nil error:error];
+}
+
++ (instancetype)realmWithConfiguration:(RLMRealmConfiguration *)configuration queue:(dispatch_queue_t)queue error:(NSError **)error {
     configuration = [configuration copy];
     Realm::Config& config = configuration.config;
 
+    // The configuration of an existing queue-confined Realm carries its
+    // queue, so always replace it with the requested one
+    config.dispatch_queue = realm::_impl::DispatchQueue((__bridge void *)queue);
+    if (queue && !config.dispatch_queue.is_current()) {
+        @throw RLMException(@"Realms confined to a queue must be opened from a block running on that queue.");
+    }
+
     bool dynamic = configuration.dynamic;
     bool readOnly = configuration.readOnly;
 
     // try to reuse existing realm first
     if (config.cache || dynamic) {
-        RLMRealm *realm = RLMGetThreadLocalCachedRealmForPath(config.path);
+        RLMRealm *realm = RLMGetThreadLocalCachedRealmForPath(config.path, queue);
         if (realm) {
             auto const& old_config = realm->_realm->config();
             if (old_config.read_only != config.read_only) {
@@ -298,8 +548,16 @@ static void RLMRealmSetSchemaAndAlign(RLMRealm *realm, RLMSchema *targetSchema)
 
     RLMRealm *realm = [RLMRealm new];
     realm->_dynamic = dynamic;
+    realm->_enumerationBatchSize = configuration.enumerationBatchSize;
+    if (NSUInteger minimumSize = configuration.cachedPropertyValueMinimumSize) {
+        realm->_propertyValueCache = std::make_unique<RLMPropertyValueCache>(minimumSize);
+    }
+    if (configuration.reusesObjectAccessors) {
+        realm->_accessorIdentityMap = std::make_unique<RLMAccessorIdentityMap>();
+    }
 
     auto migrationBlock = configuration.migrationBlock;
+    auto migrationProgressBlock = configuration.migrationProgressBlock;
     if (migrationBlock && config.schema_version > 0) {
         auto customSchema = configuration.customSchema;
         config.migration_function = [=](SharedRealm old_realm, SharedRealm realm) {
@@ -313,7 +571,9 @@ static void RLMRealmSetSchemaAndAlign(RLMRealm *realm, RLMSchema *targetSchema)
             RLMSchema *newSchema = [customSchema ?: RLMSchema.sharedSchema copy];
             RLMRealm *newRealm = [RLMRealm realmWithSharedRealm:realm schema:newSchema];
 
-            [[[RLMMigration alloc] initWithRealm:newRealm oldRealm:oldRealm] execute:migrationBlock];
+            RLMMigration *migration = [[RLMMigration alloc] initWithRealm:newRealm oldRealm:oldRealm];
+            migration.progressBlock = migrationProgressBlock;
+            [migration execute:migrationBlock];
 
             oldRealm->_realm = nullptr;
             newRealm->_realm = nullptr;
@@ -364,13 +624,17 @@ static void RLMRealmSetSchemaAndAlign(RLMRealm *realm, RLMSchema *targetSchema)
         }
 
         if (config.cache) {
-            RLMCacheRealm(config.path, realm);
+            RLMCacheRealm(config.path, realm, queue);
         }
     }
 
     if (!readOnly) {
-        // initializing the schema started a read transaction, so end it
-        [realm invalidate];
+        // initializing the schema started a read transaction, so end it,
+        // unless this is the async writer thread's Realm and it's already in
+        // the write transaction the new RLMRealm is being created for
+        if (!realm->_realm->is_in_transaction()) {
+            [realm invalidate];
+        }
         realm->_realm->m_binding_context = RLMCreateBindingContext(realm);
     }
 
@@ -416,8 +680,12 @@ static void CheckReadWrite(RLMRealm *realm, NSString *msg=@"Cannot write to a re
     [self verifyThread];
     if (token) {
         [_notificationHandlers removeObject:token];
+        if (token.unregisterBlock) {
+            token.unregisterBlock();
+        }
         token.realm = nil;
         token.block = nil;
+        token.unregisterBlock = nil;
     }
 }
 
@@ -437,6 +705,9 @@ static void CheckReadWrite(RLMRealm *realm, NSString *msg=@"Cannot write to a re
     configuration.config = _realm->config();
     configuration.dynamic = _dynamic;
     configuration.customSchema = _schema;
+    configuration.enumerationBatchSize = _enumerationBatchSize;
+    configuration.cachedPropertyValueMinimumSize = _propertyValueCache ? _propertyValueCache->minimum_size() : 0;
+    configuration.reusesObjectAccessors = _accessorIdentityMap != nullptr;
     return configuration;
 }
 
@@ -477,6 +748,156 @@ static void CheckReadWrite(RLMRealm *realm, NSString *msg=@"Cannot write to a re
     return YES;
 }
 
+- (BOOL)groupedTransactionWithBlock:(void(^)(RLMRealm *))block error:(NSError **)outError {
+    [self verifyThread];
+    CheckReadWrite(self);
+    if (_realm->is_in_transaction()) {
+        @throw RLMException(@"The Realm is already in a write transaction");
+    }
+
+    // The block may be run on another thread, so exceptions thrown by it are
+    // passed back to this thread as a C++ exception and rethrown here
+    NSException *blockException;
+    try {
+        _realm->grouped_write([&](realm::Realm& realm) {
+            @try {
+                @autoreleasepool {
+                    block(RLMGetRealmForBindingContext(realm.m_binding_context.get()));
+                }
+            }
+            @catch (NSException *e) {
+                blockException = e;
+                throw std::runtime_error(e.reason.UTF8String ?: "");
+            }
+        });
+        return YES;
+    }
+    catch (std::exception const& ex) {
+        if (blockException) {
+            @throw blockException;
+        }
+        RLMSetErrorOrThrow(RLMMakeError(RLMErrorFail, ex), outError);
+        return NO;
+    }
+}
+
+- (void)asyncTransactionWithBlock:(void(^)(RLMRealm *))block completion:(void(^)(NSError *))completion {
+    [self verifyThread];
+    CheckReadWrite(self);
+    if (_dynamic) {
+        @throw RLMException(@"Asynchronous write transactions are not supported on dynamic Realms");
+    }
+
+    // The writer thread's RLMRealm is held by the write function so that it
+    // is released on the writer thread after the transaction is committed, as
+    // releasing it within the transaction would cancel the transaction
+    struct WriterState {
+        RLMRealm *realm;
+    };
+    struct CompletionState {
+        NSException *exception;
+    };
+    auto writerState = std::make_shared<WriterState>();
+    auto completionState = std::make_shared<CompletionState>();
+    RLMRealmConfiguration *configuration = self.configuration;
+
+    try {
+        _realm->async_write([=](realm::Realm&) {
+            @autoreleasepool {
+                @try {
+                    writerState->realm = [RLMRealm realmWithConfiguration:configuration error:nil];
+                    block(writerState->realm);
+                }
+                @catch (NSException *e) {
+                    completionState->exception = e;
+                }
+            }
+            if (completionState->exception) {
+                throw std::runtime_error(completionState->exception.reason.UTF8String ?: "");
+            }
+        }, [=](std::exception_ptr error) {
+            if (!completion) {
+                return;
+            }
+            NSError *nsError;
+            if (completionState->exception) {
+                nsError = RLMMakeError(completionState->exception);
+            }
+            else if (error) {
+                try {
+                    std::rethrow_exception(error);
+                }
+                catch (std::system_error const& ex) {
+                    nsError = RLMMakeError(ex);
+                }
+                catch (std::exception const& ex) {
+                    nsError = RLMMakeError(RLMErrorFail, ex);
+                }
+            }
+            completion(nsError);
+        });
+    }
+    catch (std::exception const& ex) {
+        @throw RLMException(ex);
+    }
+}
+
+- (void)writeBehind:(void(^)(RLMRealm *))block {
+    [self verifyThread];
+    CheckReadWrite(self);
+    if (_dynamic) {
+        @throw RLMException(@"Write-behind transactions are not supported on dynamic Realms");
+    }
+
+    // As with asynchronous transactions, the writer thread's RLMRealm is held
+    // by the write function, which is destroyed after its batch is committed
+    struct WriterState {
+        RLMRealm *realm;
+    };
+    auto writerState = std::make_shared<WriterState>();
+    RLMRealmConfiguration *configuration = self.configuration;
+    try {
+        _realm->write_behind([=](realm::Realm&) {
+            NSString *reason;
+            @autoreleasepool {
+                @try {
+                    writerState->realm = [RLMRealm realmWithConfiguration:configuration error:nil];
+                    block(writerState->realm);
+                }
+                @catch (NSException *e) {
+                    reason = e.reason ?: e.name;
+                }
+            }
+            if (reason) {
+                throw std::runtime_error(reason.UTF8String);
+            }
+        });
+    }
+    catch (std::exception const& ex) {
+        @throw RLMException(ex);
+    }
+}
+
+- (BOOL)flushWriteBehind:(NSError **)outError {
+    [self verifyThread];
+    CheckReadWrite(self);
+    try {
+        _realm->flush_write_behind();
+        return YES;
+    }
+    catch (InvalidTransactionException const& ex) {
+        @throw RLMException(ex);
+    }
+    catch (std::system_error const& ex) {
+        RLMSetErrorOrThrow(RLMMakeError(ex), outError);
+        return NO;
+    }
+    catch (std::exception const& ex) {
+        RLMSetErrorOrThrow(RLMMakeError(RLMErrorFail, ex), outError);
+        return NO;
+    }
+}
+
 - (void)cancelWriteTransaction {
     try {
         _realm->cancel_transaction();
@@ -486,6 +907,69 @@ static void CheckReadWrite(RLMRealm *realm, NSString *msg=@"Cannot write to a re
     }
 }
 
+- (RLMTransactionMetrics *)transactionMetrics {
+    [self verifyThread];
+    return [[RLMTransactionMetrics alloc] initWithMetrics:_realm->metrics()];
+}
+
+- (void)resetTransactionMetrics {
+    [self verifyThread];
+    _realm->reset_metrics();
+}
+
+- (RLMFileSpaceUsage *)fileSpaceUsage {
+    try {
+        return [[RLMFileSpaceUsage alloc] initWithStatistics:_realm->file_statistics(true)];
+    }
+    catch (std::exception &ex) {
+        @throw RLMException(ex);
+    }
+}
+
+- (RLMPropertyStatistics *)statisticsForProperty:(NSString *)property ofClass:(NSString *)className {
+    return [[self allObjects:className] statisticsForProperty:property];
+}
+
+- (NSArray *)indexRecommendationsWithMinimumQueryCount:(NSUInteger)minimumQueryCount
+                                 minimumObjectsScanned:(NSUInteger)minimumObjectsScanned {
+    [self verifyThread];
+    auto workload = _realm->query_workload();
+    if (!workload || !_realm->config().schema) {
+        return @[];
+    }
+
+    NSMutableArray *recommendations = [NSMutableArray new];
+    for (auto const& recommendation : workload->recommend_indexes(*_realm->config().schema, minimumQueryCount,
+                                                                  minimumObjectsScanned)) {
+        [recommendations addObject:[[RLMIndexRecommendation alloc] initWithRecommendation:recommendation]];
+    }
+    return recommendations;
+}
+
+- (NSArray *)indexRecommendations {
+    return [self indexRecommendationsWithMinimumQueryCount:10 minimumObjectsScanned:1000];
+}
+
+- (void)resetQueryWorkload {
+    [self verifyThread];
+    if (auto workload = _realm->query_workload()) {
+        workload->clear();
+    }
+}
+
+- (RLMSnapshot *)snapshot {
+    try {
+        return [[RLMSnapshot alloc] initWithSnapshot:realm::RealmSnapshot::create(*_realm) schema:_schema];
+    }
+    catch (std::exception const& ex) {
+        @throw RLMException(ex);
+    }
+}
+
+- (id)resolveThreadSafeReference:(RLMThreadSafeReference *)reference {
+    return [reference resolveInRealm:self];
+}
+
 - (void)invalidate {
     if (_realm->is_in_transaction()) {
         NSLog(@"WARNING: An RLMRealm instance was invalidated during a write "
@@ -493,6 +977,7 @@ static void CheckReadWrite(RLMRealm *realm, NSString *msg=@"Cannot write to a re
     }
 
     [self detachAllEnumerators];
+    [_cachedResults removeAllObjects];
 
     for (RLMObjectSchema *objectSchema in _schema.objectSchema) {
         for (RLMObservationInfo *info : objectSchema->_observedObjects) {
@@ -501,6 +986,9 @@ static void CheckReadWrite(RLMRealm *realm, NSString *msg=@"Cannot write to a re
     }
 
     _realm->invalidate();
+    if (_accessorIdentityMap) {
+        _accessorIdentityMap->clear();
+    }
 
     for (RLMObjectSchema *objectSchema in _schema.objectSchema) {
         for (RLMObservationInfo *info : objectSchema->_observedObjects) {
@@ -571,18 +1059,12 @@ static void CheckReadWrite(RLMRealm *realm, NSString *msg=@"Cannot write to a re
 }
 
 - (void)addObjects:(id<NSFastEnumeration>)array {
-    for (RLMObject *obj in array) {
-        if (![obj isKindOfClass:[RLMObject class]]) {
-            @throw RLMException(@"Cannot insert objects of type %@ with addObjects:. Only RLMObjects are supported.",
-                                NSStringFromClass(obj.class));
-        }
-        [self addObject:obj];
-    }
+    RLMAddObjectsToRealm(array, self, false);
 }
 
 - (void)addOrUpdateObject:(RLMObject *)object {
     // verify primary key
-    if (!object.objectSchema.primaryKeyProperty) {
+    if (!object.objectSchema.hasPrimaryKey) {
         @throw RLMException(@"'%@' does not have a primary key and can not be updated", object.objectSchema.className);
     }
 
@@ -590,9 +1072,7 @@ static void CheckReadWrite(RLMRealm *realm, NSString *msg=@"Cannot write to a re
 }
 
 - (void)addOrUpdateObjectsFromArray:(id)array {
-    for (RLMObject *obj in array) {
-        [self addOrUpdateObject:obj];
-    }
+    RLMAddObjectsToRealm(array, self, true);
 }
 
 - (void)deleteObject:(RLMObject *)object {
@@ -607,17 +1087,20 @@ static void CheckReadWrite(RLMRealm *realm, NSString *msg=@"Cannot write to a re
         [array deleteObjectsFromRealm];
     }
     else if ([array conformsToProtocol:@protocol(NSFastEnumeration)]) {
-        for (id obj in array) {
-            if ([obj isKindOfClass:RLMObjectBase.class]) {
-                RLMDeleteObjectFromRealm(obj, self);
-            }
-        }
+        RLMDeleteObjectsFromRealm(array, self);
     }
     else {
         @throw RLMException(@"Invalid array type - container must be an RLMArray, RLMArray, or NSArray of RLMObjects");
     }
 }
 
+- (void)deleteObjects:(RLMResults *)results batchSize:(NSUInteger)batchSize {
+    if (self != results.realm) {
+        @throw RLMException(@"Can only delete objects from the Realm they belong to.");
+    }
+    [results deleteObjectsFromRealmInBatchesOfSize:batchSize];
+}
+
 - (void)deleteAllObjects {
     RLMDeleteAllObjectsFromRealm(self);
 }
@@ -732,23 +1215,150 @@ static void CheckReadWrite(RLMRealm *realm, NSString *msg=@"Cannot write to a re
     return [self writeCopyToPath:path key:key error:error];
 }
 
-- (void)registerEnumerator:(RLMFastEnumerator *)enumerator {
-    if (!_collectionEnumerators) {
-        _collectionEnumerators = [NSHashTable hashTableWithOptions:NSPointerFunctionsWeakMemory];
+- (BOOL)importObjectsWithClassName:(NSString *)className
+                              read:(realm::ObjectImporter::ReadFunction)read
+                            format:(RLMImportFormat)format
+                             error:(NSError **)error {
+    [self verifyThread];
+    if (self.inWriteTransaction) {
+        @throw RLMException(@"Cannot import objects from within a write transaction.");
+    }
+    if (!self.schema[className].table) {
+        @throw RLMException(@"Object type '%@' is not persisted in the Realm.", className);
     }
-    [_collectionEnumerators addObject:enumerator];
 
+    auto importFormat = format == RLMImportFormatCSV ? realm::ObjectImporter::Format::CSV
+                                                     : realm::ObjectImporter::Format::JSON;
+    try {
+        realm::ObjectImporter(_realm, className.UTF8String, importFormat).import(std::move(read));
+        return YES;
+    }
+    catch (std::system_error const& ex) {
+        if (error) {
+            *error = RLMMakeError(ex);
+        }
+    }
+    catch (std::exception const& ex) {
+        if (error) {
+            *error = RLMMakeError(RLMErrorFail, ex);
+        }
+    }
+    return NO;
+}
+
+- (BOOL)importObjectsWithClassName:(NSString *)className
+                        fromStream:(NSInputStream *)stream
+                            format:(RLMImportFormat)format
+                             error:(NSError **)error {
+    if (stream.streamStatus == NSStreamStatusNotOpen) {
+        [stream open];
+    }
+    auto read = [=](char *buffer, size_t size) -> size_t {
+        NSInteger bytesRead = [stream read:reinterpret_cast<uint8_t *>(buffer) maxLength:size];
+        if (bytesRead < 0) {
+            NSString *reason = stream.streamError.localizedDescription ?: @"Unknown error";
+            throw std::runtime_error(std::string("Failed to read from stream: ") + reason.UTF8String);
+        }
+        return bytesRead;
+    };
+    return [self importObjectsWithClassName:className read:read format:format error:error];
+}
+
+- (BOOL)importObjectsWithClassName:(NSString *)className
+                fromFileDescriptor:(int)fileDescriptor
+                            format:(RLMImportFormat)format
+                             error:(NSError **)error {
+    auto read = [=](char *buffer, size_t size) -> size_t {
+        ssize_t bytesRead;
+        do {
+            bytesRead = ::read(fileDescriptor, buffer, size);
+        } while (bytesRead < 0 && errno == EINTR);
+        if (bytesRead < 0) {
+            throw std::system_error(errno, std::system_category());
+        }
+        return bytesRead;
+    };
+    return [self importObjectsWithClassName:className read:read format:format error:error];
+}
+
+- (BOOL)copyObjectsWithClassNames:(NSArray *)classNames fromRealm:(RLMRealm *)realm error:(NSError **)error {
+    [self verifyThread];
+    [realm verifyThread];
+
+    std::vector<std::string> objectTypes;
+    for (NSString *className in classNames) {
+        objectTypes.push_back(className.UTF8String);
+    }
+    try {
+        realm::ObjectCopier(realm->_realm, _realm).copy(std::move(objectTypes));
+        return YES;
+    }
+    catch (std::exception const& ex) {
+        if (error) {
+            *error = RLMMakeError(RLMErrorFail, ex);
+        }
+    }
+    return NO;
+}
+
+- (void)registerEnumerator:(RLMFastEnumerator *)enumerator {
+    enumerator->_previousEnumerator = nil;
+    enumerator->_nextEnumerator = _firstEnumerator;
+    if (_firstEnumerator) {
+        _firstEnumerator->_previousEnumerator = enumerator;
+    }
+    _firstEnumerator = enumerator;
 }
 
 - (void)unregisterEnumerator:(RLMFastEnumerator *)enumerator {
-    [_collectionEnumerators removeObject:enumerator];
+    if (enumerator->_previousEnumerator) {
+        enumerator->_previousEnumerator->_nextEnumerator = enumerator->_nextEnumerator;
+    }
+    else if (_firstEnumerator == enumerator) {
+        _firstEnumerator = enumerator->_nextEnumerator;
+    }
+    else {
+        // not registered
+        return;
+    }
+    if (enumerator->_nextEnumerator) {
+        enumerator->_nextEnumerator->_previousEnumerator = enumerator->_previousEnumerator;
+    }
+    enumerator->_previousEnumerator = nil;
+    enumerator->_nextEnumerator = nil;
 }
 
 - (void)detachAllEnumerators {
-    for (RLMFastEnumerator *enumerator in _collectionEnumerators) {
+    // unlink all of the enumerators before detaching any so that the list is
+    // left empty even if detaching one throws
+    RLMFastEnumerator *enumerator = _firstEnumerator;
+    _firstEnumerator = nil;
+    while (enumerator) {
+        RLMFastEnumerator *next = enumerator->_nextEnumerator;
+        enumerator->_previousEnumerator = nil;
+        enumerator->_nextEnumerator = nil;
         [enumerator detach];
+        enumerator = next;
     }
-    _collectionEnumerators = nil;
+}
+
+- (void)discardCachedResults {
+    [_cachedResults removeAllObjects];
+}
+
+- (RLMResults *)cachedResultsForKey:(id<NSCopying>)key create:(RLMResults *(^)())create {
+    static const NSUInteger maxCachedResults = 64;
+
+    RLMResults *results = [_cachedResults objectForKey:key];
+    if (!results) {
+        results = create();
+        if (!_cachedResults) {
+            _cachedResults = [NSCache new];
+            _cachedResults.countLimit = maxCachedResults;
+        }
+        [_cachedResults setObject:results forKey:key];
+    }
+    return results;
 }
 
 @end
@@ -21,6 +21,27 @@
 
 RLM_ASSUME_NONNULL_BEGIN
 
+/**
+ A block called with a description of a query which took at least the
+ configuration's `slowQueryThreshold` to run, and how long it took.
+
+ @see -[RLMResults explain]
+ */
+typedef void (^RLMSlowQueryBlock)(NSString *queryDescription, NSTimeInterval duration);
+
+/// A block called with the number of bytes reclaimed when a Realm file is
+/// automatically compacted on open.
+typedef void (^RLMCompactionBlock)(NSUInteger bytesReclaimed);
+
+/// A block called when the indexes whose creation was deferred by
+/// `deferIndexCreation` have been added, or with the error which prevented it.
+typedef void (^RLMIndexCreationBlock)(NSError * __nullable error);
+
+/// A block called during a migration with the number of objects of a class
+/// which have been migrated by `-[RLMMigration enumerateObjects:block:]` or
+/// `-[RLMMigration transformValuesOfProperty:toProperty:ofClass:block:]`.
+typedef void (^RLMMigrationProgressBlock)(NSString *className, NSUInteger completed, NSUInteger total);
+
 /**
  An `RLMRealmConfiguration` is used to describe the different options used to
  create an `RLMRealm` instance.
@@ -65,15 +86,310 @@ RLM_ASSUME_NONNULL_BEGIN
 /// Whether the Realm is read-only (must be YES for read-only files).
 @property (nonatomic) BOOL readOnly;
 
+/**
+ Whether the file is never modified while it is open, such as a file bundled
+ with the app or a reference database shared with app extensions. Setting this
+ to `YES` also makes the Realm read-only.
+
+ Every `RLMRealm` for an unencrypted immutable file in the process reads from a
+ single shared memory mapping of the file, which is paged in from disk only as
+ it is accessed, rather than each opening and mapping the file separately. No
+ lock file is created for the file.
+
+ Modifying the file while it is open results in undefined behavior.
+ */
+@property (nonatomic) BOOL immutable;
+
+/**
+ The largest decrypted size in bytes of an encrypted immutable file which is
+ decrypted into memory when it is opened, or 0 to never do so. Defaults to 0.
+
+ Reading from an encrypted Realm normally decrypts each page of the file as it
+ is accessed, which makes scanning large amounts of data several times slower
+ than for an unencrypted file. When this is set, an immutable file which is no
+ larger than this is instead decrypted once, when the first `RLMRealm` for it
+ is opened, and every immutable `RLMRealm` for the file in the process with
+ the same encryption key reads from that copy. The memory is freed once none
+ of them are still open.
+ */
+@property (nonatomic) NSUInteger maximumDecryptedCacheSize;
+
 /// The current schema version.
 @property (nonatomic) uint64_t schemaVersion;
 
 /// The block which migrates the Realm to the current version.
 @property (nonatomic, copy, nullable) RLMMigrationBlock migrationBlock;
 
+/**
+ A block which is called on the migrating thread periodically while the
+ migration block enumerates objects, for displaying the progress of long
+ migrations. It is called at least once for each class enumerated, after the
+ last object.
+
+ The migration is still performed in a single write transaction, so nothing is
+ written to the file until the migration block returns.
+ */
+@property (nonatomic, copy, nullable) RLMMigrationProgressBlock migrationProgressBlock;
+
 /// The classes persisted in the Realm.
 @property (nonatomic, copy, nullable) NSArray *objectClasses;
 
+/**
+ If non-zero, the Realm file is compacted when it is first opened by the
+ process if at least this fraction of the file (between 0 and 1) is free space
+ and the file is at least `compactOnOpenMinimumFileSize` bytes. Files which are
+ open in another process are not compacted. Defaults to 0, which never compacts.
+
+ Files only grow as data is written, and the space freed by deleting objects or
+ by old versions being released is reused but not returned to the filesystem.
+ */
+@property (nonatomic) double compactOnOpenFreeSpaceRatio;
+
+/// The smallest file size, in bytes, which is compacted by `compactOnOpenFreeSpaceRatio`.
+@property (nonatomic) NSUInteger compactOnOpenMinimumFileSize;
+
+/// A block which is called on the opening thread before the `RLMRealm` is
+/// returned when the file was compacted on open.
+@property (nonatomic, copy, nullable) RLMCompactionBlock compactionBlock;
+
+/**
+ The size in bytes which disk space is reserved for the Realm file to grow to
+ when it is opened for writing, or 0 to not reserve any. Defaults to 0.
+ */
+@property (nonatomic) NSUInteger initialFileSize;
+
+/**
+ If either is non-zero, disk space for the Realm file is reserved ahead of the
+ file growing, in steps of the larger of `fileGrowthIncrement` bytes and
+ `fileGrowthFactor` times the current size of the file. Both default to 0.
+
+ Writing large amounts of data otherwise grows the file in many small steps,
+ each of which makes the `RLMRealm`s reading the file on other threads remap
+ it. Setting these, e.g. to 64 MB and 0.25, before a bulk import makes it grow
+ the file in a few large steps instead.
+ */
+@property (nonatomic) NSUInteger fileGrowthIncrement;
+@property (nonatomic) double fileGrowthFactor;
+
+/**
+ Limits which make the Realm a size-limited cache, typically for an in-memory
+ Realm holding data fetched from a server. Both default to 0, which disables
+ the limit.
+
+ After a write transaction leaves more than `maximumCachedObjectCount` objects
+ of any class, or the Realm using more than `maximumCacheSize` bytes, the least
+ recently accessed objects are deleted by a write on a background thread.
+ Objects count as accessed when they are read from an `RLMResults`, `RLMArray`
+ or a link, looked up by primary key, or created.
+
+ Accesses are tracked separately by each thread's `RLMRealm` instance, and the
+ objects to delete are chosen by the instance which commits or refreshes past
+ the limit, using only the accesses made on its own thread. For the least
+ recently used order to cover every read, use the cache from a single thread.
+ */
+@property (nonatomic) NSUInteger maximumCachedObjectCount;
+@property (nonatomic) NSUInteger maximumCacheSize;
+
+/**
+ If non-zero, the number of seconds between deleting the objects of classes
+ with a `timeToLive` which have expired. The objects are deleted by writes on a
+ background thread which each delete at most `expirySweepBatchSize` objects, so
+ that a large backlog is cleared without holding up other writes for long.
+ Expired objects are excluded from `RLMResults` whether or not this is set.
+ Defaults to 0, which never deletes them; `expirySweepBatchSize` defaults to 1000.
+ */
+@property (nonatomic) NSTimeInterval expirySweepInterval;
+@property (nonatomic) NSUInteger expirySweepBatchSize;
+
+/**
+ The most blocks passed to `-[RLMRealm writeBehind:]` which are committed in a
+ single write transaction, and the number of seconds the writer thread waits
+ for more blocks after the first one before beginning the transaction. A delay
+ of 0 begins it as soon as the writer thread is free, with whichever blocks
+ were queued while it was busy. Only the values from the first `RLMRealm` to
+ write behind to the file are used. Default to 1000 blocks and 0 seconds.
+ */
+@property (nonatomic) NSUInteger writeBehindBatchSize;
+@property (nonatomic) NSTimeInterval writeBehindDelay;
+
+/**
+ Whether indexes which the schema declares but the file doesn't have yet, such
+ as those added to a property by an app update, are added by a write on a
+ background thread after the Realm is opened, rather than before opening it
+ returns. Queries on the properties are still correct but are not accelerated
+ by the index until it has been added. Indexes for primary keys are always
+ added when the Realm is opened.
+ */
+@property (nonatomic) BOOL deferIndexCreation;
+
+/// A block which is called on the opening thread once the indexes deferred by
+/// `deferIndexCreation` have been added.
+@property (nonatomic, copy, nullable) RLMIndexCreationBlock indexCreationBlock;
+
+/**
+ `RLMObject` subclasses whose data is read on a background thread when the
+ Realm file is first opened by the process, so that the first queries on them
+ do not have to wait for that data to be read from disk.
+
+ This is intended for the classes which are queried immediately after launch
+ in apps with large Realm files. Binary and link properties are not prefetched.
+ */
+@property (nonatomic, copy, nullable) NSArray *prefetchObjectClasses;
+
+/**
+ A block which is called on the Realm's thread for each query which takes at
+ least `slowQueryThreshold` seconds to run, for finding the queries which need
+ to be optimized.
+ */
+@property (nonatomic, copy, nullable) RLMSlowQueryBlock slowQueryBlock;
+
+/// The minimum duration, in seconds, of a query which is reported to `slowQueryBlock`.
+@property (nonatomic) NSTimeInterval slowQueryThreshold;
+
+/**
+ Whether each `RLMRealm` instance opened with this configuration records the
+ queries it runs, so that `-[RLMRealm indexRecommendations]` can suggest which
+ properties to add to or remove from `indexedProperties`.
+
+ Only the properties which queries compare for equality or with a range, the
+ number of objects they went over, and how often each combination of these
+ ran are recorded, but this still adds a small cost to every query, so it is
+ intended for diagnostic builds.
+ */
+@property (nonatomic) BOOL recordsQueryWorkload;
+
+/**
+ If non-zero, the number of seconds after which an `RLMRealm` with
+ `autorefresh` disabled which has been neither refreshed nor read from is
+ invalidated, the next time it is notified of a change made by another thread
+ or process.
+
+ An `RLMRealm` which is never refreshed keeps the version of the data it is
+ reading alive, so the file has to grow to hold all of the changes made after
+ that version. Setting this lets forgotten background Realms release their old
+ version. All objects read from the Realm are invalidated when this happens.
+ Defaults to 0, which never invalidates Realms.
+ */
+@property (nonatomic) NSTimeInterval idleReadTransactionTimeout;
+
+/**
+ If non-zero, the most versions an `RLMRealm` with `autorefresh` enabled
+ advances at a time when it is notified of changes made on other threads.
+
+ An `RLMRealm` which is many commits behind, such as the main thread's Realm
+ after a large import on a background thread, otherwise has to process all of
+ them at once before the run loop can continue. When advancing in steps, an
+ `RLMRealmDidChangeNotification` is sent after each step and the Realm
+ continues on the next turn of the run loop. Only commits made in this process
+ can be stopped at, so commits made by other processes are advanced over along
+ with the next step. `-[RLMRealm refresh]` always advances to the newest version.
+ Defaults to 0.
+ */
+@property (nonatomic) NSUInteger autorefreshVersionLimit;
+
+/**
+ If non-zero, the longest time in seconds that an `RLMRealm` with `autorefresh`
+ enabled spends advancing in steps each time it is notified of changes before
+ continuing on the next turn of the run loop. A step which has begun is always
+ completed. If `autorefreshVersionLimit` is 0, each step covers about eight
+ versions committed in this process. Defaults to 0, which takes a single step
+ per notification when `autorefreshVersionLimit` is set.
+ */
+@property (nonatomic) NSTimeInterval autorefreshTimeBudget;
+
+/**
+ The shortest time in seconds between the notifications an `RLMRealm` receives
+ of changes made on other threads and in other processes.
+
+ Changes committed sooner than this after the previous notification are
+ delivered together at the end of the interval, so a burst of commits results
+ in a single refresh and a single `RLMRealmDidChangeNotification` rather than
+ one per commit. Commits made on the Realm's own thread are unaffected.
+ Defaults to 0, which notifies of each change as soon as possible.
+ */
+@property (nonatomic) NSTimeInterval minimumNotificationInterval;
+
+/**
+ The run loop modes in which an `RLMRealm` confined to a thread processes
+ notifications of changes made on other threads and in other processes, or
+ `nil` for only `NSDefaultRunLoopMode`. Defaults to `nil`.
+
+ Set this to `@[NSRunLoopCommonModes]` to keep refreshing a Realm used by the
+ UI while a scroll view is tracking. Realms confined to a dispatch queue are
+ unaffected.
+ */
+@property (nonatomic, copy, nullable) NSArray<NSString *> *notificationRunLoopModes;
+
+/**
+ The quality of service requested for the background thread which listens for
+ changes made on other threads and in other processes. The thread is shared by
+ every `RLMRealm` in the process and runs at the highest quality of service
+ requested by any of them. Defaults to `NSQualityOfServiceDefault`, which makes
+ no request.
+ */
+@property (nonatomic) NSQualityOfService notificationQualityOfService;
+
+/**
+ The `RLMObject` subclasses whose changes the `RLMRealm` sends notifications for.
+
+ When set, automatic refreshes which only pick up changes to objects of other
+ classes made on other threads or in other processes do not send
+ `RLMRealmDidChangeNotification`. Changes to objects being observed with
+ Key-Value Observing are always reported. Defaults to `nil`, which reports
+ changes to all classes.
+ */
+@property (nonatomic, copy, nullable) NSArray *observedObjectClasses;
+
+/**
+ Whether the changes made by commits on other threads and in other processes
+ are computed on a background thread before the `RLMRealm` is notified of them.
+
+ This moves most of the work of an automatic refresh off the `RLMRealm`'s
+ thread, at the cost of notifications of commits arriving slightly later.
+ Refreshes of `RLMRealm`s which have objects being observed with Key-Value
+ Observing still do that work on their own thread. Only the configuration of
+ the first `RLMRealm` opened for a file in the process is used for this.
+ */
+@property (nonatomic) BOOL computeChangesInBackground;
+
+/**
+ The number of rows a count or aggregate of an unsorted `RLMResults` has to read
+ before it is split into chunks which are evaluated concurrently on background
+ threads, or 0 to always evaluate them on the calling thread. Defaults to 0.
+
+ Parallel evaluation only applies outside of write transactions, and only to
+ results which are not limited or backed by an `RLMArray`.
+ */
+@property (nonatomic) NSUInteger parallelAggregateThreshold;
+
+/**
+ The number of objects created at a time when fast-enumerating an `RLMResults`
+ or `RLMArray` from the Realm. Larger batches reduce the per-object overhead of
+ enumeration at the cost of keeping more objects alive at once. Must be greater
+ than zero. Defaults to 16.
+ */
+@property (nonatomic) NSUInteger enumerationBatchSize;
+
+/**
+ If non-zero, string and data property values of at least this many bytes
+ which are read outside of write transactions are cached by the Realm until it
+ advances to a new version, so that reading the same property of the same
+ object again returns the same `NSString` or `NSData` rather than copying the
+ value out of the file again. A limited number of values is kept. Defaults to
+ 0, which never caches values.
+ */
+@property (nonatomic) NSUInteger cachedPropertyValueMinimumSize;
+
+/**
+ Whether reading an object which already has a live `RLMObject` from the same
+ `RLMRealm`, whether by index from an `RLMResults` or `RLMArray`, by following
+ a link or by primary key, returns that `RLMObject` rather than creating a new
+ one. This saves allocating objects and observing each of them separately when
+ the same objects are reached many times through a shared object graph, and
+ lets them be compared with `==`. Defaults to NO.
+ */
+@property (nonatomic) BOOL reusesObjectAccessors;
+
 @end
 
 RLM_ASSUME_NONNULL_END
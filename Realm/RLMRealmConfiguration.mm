@@ -18,6 +18,7 @@
 
 #import "RLMRealmConfiguration_Private.h"
 
+#import "RLMObjectBase.h"
 #import "RLMObjectSchema_Private.hpp"
 #import "RLMRealm_Private.h"
 #import "RLMSchema_Private.hpp"
@@ -31,8 +32,41 @@ static NSString *const c_RLMRealmConfigurationProperties[] = {
     @"inMemoryIdentifier",
     @"encryptionKey",
     @"readOnly",
+    @"immutable",
+    @"maximumDecryptedCacheSize",
     @"schemaVersion",
     @"migrationBlock",
+    @"migrationProgressBlock",
+    @"compactOnOpenFreeSpaceRatio",
+    @"compactOnOpenMinimumFileSize",
+    @"compactionBlock",
+    @"initialFileSize",
+    @"fileGrowthIncrement",
+    @"fileGrowthFactor",
+    @"maximumCachedObjectCount",
+    @"maximumCacheSize",
+    @"expirySweepInterval",
+    @"expirySweepBatchSize",
+    @"writeBehindBatchSize",
+    @"writeBehindDelay",
+    @"deferIndexCreation",
+    @"indexCreationBlock",
+    @"prefetchObjectClasses",
+    @"slowQueryBlock",
+    @"slowQueryThreshold",
+    @"recordsQueryWorkload",
+    @"idleReadTransactionTimeout",
+    @"autorefreshVersionLimit",
+    @"autorefreshTimeBudget",
+    @"minimumNotificationInterval",
+    @"notificationRunLoopModes",
+    @"notificationQualityOfService",
+    @"observedObjectClasses",
+    @"computeChangesInBackground",
+    @"parallelAggregateThreshold",
+    @"enumerationBatchSize",
+    @"cachedPropertyValueMinimumSize",
+    @"reusesObjectAccessors",
     @"dynamic",
     @"customSchema",
 };
@@ -120,6 +154,7 @@ NSString *RLMRealmPathForFile(NSString *fileName) {
         static NSString *defaultRealmPath = RLMRealmPathForFile(c_defaultRealmFileName);
         self.path = defaultRealmPath;
         self.schemaVersion = 0;
+        _enumerationBatchSize = RLMDefaultEnumerationBatchSize;
     }
 
     return self;
@@ -130,7 +165,16 @@ NSString *RLMRealmPathForFile(NSString *fileName) {
     configuration->_config = _config;
     configuration->_dynamic = _dynamic;
     configuration->_migrationBlock = _migrationBlock;
+    configuration->_migrationProgressBlock = _migrationProgressBlock;
     configuration->_customSchema = _customSchema;
+    configuration->_slowQueryBlock = _slowQueryBlock;
+    configuration->_prefetchObjectClasses = _prefetchObjectClasses;
+    configuration->_compactionBlock = _compactionBlock;
+    configuration->_indexCreationBlock = _indexCreationBlock;
+    configuration->_observedObjectClasses = _observedObjectClasses;
+    configuration->_enumerationBatchSize = _enumerationBatchSize;
+    configuration->_cachedPropertyValueMinimumSize = _cachedPropertyValueMinimumSize;
+    configuration->_reusesObjectAccessors = _reusesObjectAccessors;
     return configuration;
 }
 
@@ -211,6 +255,25 @@ static void RLMNSStringToStdString(std::string &out, NSString *in) {
     _config.read_only = readOnly;
 }
 
+- (BOOL)immutable {
+    return _config.immutable;
+}
+
+- (void)setImmutable:(BOOL)immutable {
+    _config.immutable = immutable;
+    if (immutable) {
+        _config.read_only = true;
+    }
+}
+
+- (NSUInteger)maximumDecryptedCacheSize {
+    return _config.decrypted_cache_max_size;
+}
+
+- (void)setMaximumDecryptedCacheSize:(NSUInteger)maximumDecryptedCacheSize {
+    _config.decrypted_cache_max_size = maximumDecryptedCacheSize;
+}
+
 - (uint64_t)schemaVersion {
     return _config.schema_version;
 }
@@ -222,6 +285,136 @@ static void RLMNSStringToStdString(std::string &out, NSString *in) {
     _config.schema_version = schemaVersion;
 }
 
+- (void)setSlowQueryBlock:(RLMSlowQueryBlock)slowQueryBlock {
+    _slowQueryBlock = [slowQueryBlock copy];
+    if (RLMSlowQueryBlock block = _slowQueryBlock) {
+        _config.slow_query_function = [=](std::string const& description, std::chrono::microseconds duration) {
+            block(@(description.c_str()), duration.count() / 1e6);
+        };
+    }
+    else {
+        _config.slow_query_function = nullptr;
+    }
+}
+
+- (NSTimeInterval)slowQueryThreshold {
+    return _config.slow_query_threshold.count() / 1e6;
+}
+
+- (void)setSlowQueryThreshold:(NSTimeInterval)slowQueryThreshold {
+    if (slowQueryThreshold < 0) {
+        @throw RLMException(@"Slow query threshold must not be negative");
+    }
+    _config.slow_query_threshold = std::chrono::microseconds(static_cast<int64_t>(slowQueryThreshold * 1e6));
+}
+
+- (BOOL)recordsQueryWorkload {
+    return _config.record_query_workload;
+}
+
+- (void)setRecordsQueryWorkload:(BOOL)recordsQueryWorkload {
+    _config.record_query_workload = recordsQueryWorkload;
+}
+
+- (NSTimeInterval)idleReadTransactionTimeout {
+    return _config.idle_read_timeout.count() / 1e3;
+}
+
+- (void)setIdleReadTransactionTimeout:(NSTimeInterval)idleReadTransactionTimeout {
+    if (idleReadTransactionTimeout < 0) {
+        @throw RLMException(@"Idle read transaction timeout must not be negative");
+    }
+    _config.idle_read_timeout = std::chrono::milliseconds(static_cast<int64_t>(idleReadTransactionTimeout * 1e3));
+}
+
+- (NSUInteger)autorefreshVersionLimit {
+    return _config.autorefresh_version_limit;
+}
+
+- (void)setAutorefreshVersionLimit:(NSUInteger)autorefreshVersionLimit {
+    _config.autorefresh_version_limit = autorefreshVersionLimit;
+}
+
+- (NSTimeInterval)autorefreshTimeBudget {
+    return _config.autorefresh_time_budget.count() / 1e3;
+}
+
+- (void)setAutorefreshTimeBudget:(NSTimeInterval)autorefreshTimeBudget {
+    if (autorefreshTimeBudget < 0) {
+        @throw RLMException(@"Autorefresh time budget must not be negative");
+    }
+    _config.autorefresh_time_budget = std::chrono::milliseconds(static_cast<int64_t>(autorefreshTimeBudget * 1e3));
+}
+
+- (NSTimeInterval)minimumNotificationInterval {
+    return _config.notification_interval.count() / 1e3;
+}
+
+- (void)setMinimumNotificationInterval:(NSTimeInterval)minimumNotificationInterval {
+    if (minimumNotificationInterval < 0) {
+        @throw RLMException(@"Minimum notification interval must not be negative");
+    }
+    _config.notification_interval = std::chrono::milliseconds(static_cast<int64_t>(minimumNotificationInterval * 1e3));
+}
+
+- (NSArray<NSString *> *)notificationRunLoopModes {
+    if (_config.notification_runloop_modes.empty()) {
+        return nil;
+    }
+    NSMutableArray *modes = [NSMutableArray arrayWithCapacity:_config.notification_runloop_modes.size()];
+    for (auto const& mode : _config.notification_runloop_modes) {
+        [modes addObject:@(mode.c_str())];
+    }
+    return modes;
+}
+
+- (void)setNotificationRunLoopModes:(NSArray<NSString *> *)notificationRunLoopModes {
+    _config.notification_runloop_modes.clear();
+    for (NSString *mode in notificationRunLoopModes) {
+        _config.notification_runloop_modes.push_back(mode.UTF8String);
+    }
+}
+
+- (NSQualityOfService)notificationQualityOfService {
+    // NSQualityOfService shares qos_class_t's values other than for the default
+    if (_config.notification_thread_qos == 0) {
+        return NSQualityOfServiceDefault;
+    }
+    return static_cast<NSQualityOfService>(_config.notification_thread_qos);
+}
+
+- (void)setNotificationQualityOfService:(NSQualityOfService)notificationQualityOfService {
+    if (notificationQualityOfService == NSQualityOfServiceDefault) {
+        _config.notification_thread_qos = 0;
+    }
+    else {
+        _config.notification_thread_qos = static_cast<unsigned int>(notificationQualityOfService);
+    }
+}
+
+- (BOOL)computeChangesInBackground {
+    return _config.compute_changes_in_background;
+}
+
+- (void)setComputeChangesInBackground:(BOOL)computeChangesInBackground {
+    _config.compute_changes_in_background = computeChangesInBackground;
+}
+
+- (NSUInteger)parallelAggregateThreshold {
+    return _config.parallel_aggregate_threshold;
+}
+
+- (void)setParallelAggregateThreshold:(NSUInteger)parallelAggregateThreshold {
+    _config.parallel_aggregate_threshold = parallelAggregateThreshold;
+}
+
+- (void)setEnumerationBatchSize:(NSUInteger)enumerationBatchSize {
+    if (enumerationBatchSize == 0) {
+        @throw RLMException(@"Enumeration batch size must be greater than zero.");
+    }
+    _enumerationBatchSize = enumerationBatchSize;
+}
+
 - (NSArray *)objectClasses {
     return [_customSchema.objectSchema valueForKeyPath:@"objectClass"];
 }
@@ -230,6 +423,178 @@ static void RLMNSStringToStdString(std::string &out, NSString *in) {
     self.customSchema = [RLMSchema schemaWithObjectClasses:objectClasses];
 }
 
+- (double)compactOnOpenFreeSpaceRatio {
+    return _config.compact_on_open_free_ratio;
+}
+
+- (void)setCompactOnOpenFreeSpaceRatio:(double)compactOnOpenFreeSpaceRatio {
+    if (compactOnOpenFreeSpaceRatio < 0 || compactOnOpenFreeSpaceRatio > 1) {
+        @throw RLMException(@"Compaction free space ratio must be between 0 and 1");
+    }
+    _config.compact_on_open_free_ratio = compactOnOpenFreeSpaceRatio;
+}
+
+- (NSUInteger)compactOnOpenMinimumFileSize {
+    return _config.compact_on_open_min_size;
+}
+
+- (void)setCompactOnOpenMinimumFileSize:(NSUInteger)compactOnOpenMinimumFileSize {
+    _config.compact_on_open_min_size = compactOnOpenMinimumFileSize;
+}
+
+- (NSUInteger)initialFileSize {
+    return _config.initial_file_size;
+}
+
+- (void)setInitialFileSize:(NSUInteger)initialFileSize {
+    _config.initial_file_size = initialFileSize;
+}
+
+- (NSUInteger)fileGrowthIncrement {
+    return _config.file_growth_increment;
+}
+
+- (void)setFileGrowthIncrement:(NSUInteger)fileGrowthIncrement {
+    _config.file_growth_increment = fileGrowthIncrement;
+}
+
+- (double)fileGrowthFactor {
+    return _config.file_growth_factor;
+}
+
+- (void)setFileGrowthFactor:(double)fileGrowthFactor {
+    if (fileGrowthFactor < 0) {
+        @throw RLMException(@"File growth factor must not be negative");
+    }
+    _config.file_growth_factor = fileGrowthFactor;
+}
+
+- (NSUInteger)maximumCachedObjectCount {
+    return _config.cache_max_objects;
+}
+
+- (void)setMaximumCachedObjectCount:(NSUInteger)maximumCachedObjectCount {
+    _config.cache_max_objects = maximumCachedObjectCount;
+}
+
+- (NSUInteger)maximumCacheSize {
+    return _config.cache_max_bytes;
+}
+
+- (void)setMaximumCacheSize:(NSUInteger)maximumCacheSize {
+    _config.cache_max_bytes = maximumCacheSize;
+}
+
+- (NSTimeInterval)expirySweepInterval {
+    return _config.expiry_sweep_interval.count() / 1e3;
+}
+
+- (void)setExpirySweepInterval:(NSTimeInterval)expirySweepInterval {
+    if (expirySweepInterval < 0) {
+        @throw RLMException(@"Expiry sweep interval must not be negative");
+    }
+    _config.expiry_sweep_interval = std::chrono::milliseconds(static_cast<int64_t>(expirySweepInterval * 1e3));
+}
+
+- (NSUInteger)expirySweepBatchSize {
+    return _config.expiry_sweep_batch_size;
+}
+
+- (void)setExpirySweepBatchSize:(NSUInteger)expirySweepBatchSize {
+    if (expirySweepBatchSize == 0) {
+        @throw RLMException(@"Expiry sweep batch size must be greater than zero");
+    }
+    _config.expiry_sweep_batch_size = expirySweepBatchSize;
+}
+
+- (NSUInteger)writeBehindBatchSize {
+    return _config.write_behind_batch_size;
+}
+
+- (void)setWriteBehindBatchSize:(NSUInteger)writeBehindBatchSize {
+    if (writeBehindBatchSize == 0) {
+        @throw RLMException(@"Write-behind batch size must be greater than zero");
+    }
+    _config.write_behind_batch_size = writeBehindBatchSize;
+}
+
+- (NSTimeInterval)writeBehindDelay {
+    return _config.write_behind_delay.count() / 1e3;
+}
+
+- (void)setWriteBehindDelay:(NSTimeInterval)writeBehindDelay {
+    if (writeBehindDelay < 0) {
+        @throw RLMException(@"Write-behind delay must not be negative");
+    }
+    _config.write_behind_delay = std::chrono::milliseconds(static_cast<int64_t>(writeBehindDelay * 1e3));
+}
+
+- (void)setCompactionBlock:(RLMCompactionBlock)compactionBlock {
+    _compactionBlock = [compactionBlock copy];
+    if (RLMCompactionBlock block = _compactionBlock) {
+        _config.compaction_function = [=](size_t bytesReclaimed) {
+            block(bytesReclaimed);
+        };
+    }
+    else {
+        _config.compaction_function = nullptr;
+    }
+}
+
+- (BOOL)deferIndexCreation {
+    return _config.defer_index_creation;
+}
+
+- (void)setDeferIndexCreation:(BOOL)deferIndexCreation {
+    _config.defer_index_creation = deferIndexCreation;
+}
+
+- (void)setIndexCreationBlock:(RLMIndexCreationBlock)indexCreationBlock {
+    _indexCreationBlock = [indexCreationBlock copy];
+    if (RLMIndexCreationBlock block = _indexCreationBlock) {
+        _config.index_creation_function = [=](std::exception_ptr error) {
+            NSError *nsError;
+            if (error) {
+                try {
+                    std::rethrow_exception(error);
+                }
+                catch (std::system_error const& ex) {
+                    nsError = RLMMakeError(ex);
+                }
+                catch (std::exception const& ex) {
+                    nsError = RLMMakeError(RLMErrorFail, ex);
+                }
+            }
+            block(nsError);
+        };
+    }
+    else {
+        _config.index_creation_function = nullptr;
+    }
+}
+
+- (void)setPrefetchObjectClasses:(NSArray *)prefetchObjectClasses {
+    _prefetchObjectClasses = [prefetchObjectClasses copy];
+    _config.prefetch_object_types.clear();
+    for (Class cls in _prefetchObjectClasses) {
+        if (!RLMIsKindOfClass(cls, RLMObjectBase.class)) {
+            @throw RLMException(@"Prefetched classes must be RLMObject subclasses, but %@ is not", cls);
+        }
+        _config.prefetch_object_types.push_back([cls className].UTF8String);
+    }
+}
+
+- (void)setObservedObjectClasses:(NSArray *)observedObjectClasses {
+    _observedObjectClasses = [observedObjectClasses copy];
+    _config.observed_object_types.clear();
+    for (Class cls in _observedObjectClasses) {
+        if (!RLMIsKindOfClass(cls, RLMObjectBase.class)) {
+            @throw RLMException(@"Observed classes must be RLMObject subclasses, but %@ is not", cls);
+        }
+        _config.observed_object_types.push_back([cls className].UTF8String);
+    }
+}
+
 - (void)setDynamic:(bool)dynamic {
     _dynamic = dynamic;
     _config.cache = !dynamic;
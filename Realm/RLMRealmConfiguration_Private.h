@@ -20,6 +20,8 @@
 
 @class RLMSchema;
 
+static const NSUInteger RLMDefaultEnumerationBatchSize = 16;
+
 @interface RLMRealmConfiguration ()
 
 @property (nonatomic, readwrite) bool cache;
@@ -26,10 +26,12 @@ namespace realm {
     class BindingContext;
 }
 
-// Add a Realm to the weak cache
-void RLMCacheRealm(std::string const& path, RLMRealm *realm);
-// Get a Realm for the given path which can be used on the current thread
-RLMRealm *RLMGetThreadLocalCachedRealmForPath(std::string const& path);
+// Add a Realm to the weak cache, for the queue it is confined to if given and
+// for the current thread otherwise
+void RLMCacheRealm(std::string const& path, RLMRealm *realm, dispatch_queue_t queue = nil);
+// Get a Realm for the given path which can be used on the current thread, or
+// which is confined to the given queue
+RLMRealm *RLMGetThreadLocalCachedRealmForPath(std::string const& path, dispatch_queue_t queue = nil);
 // Get a Realm for the given path
 RLMRealm *RLMGetAnyCachedRealmForPath(std::string const& path);
 // Clear the weak cache of Realms
@@ -39,4 +41,10 @@ void RLMClearRealmCache();
 // for all cached realms on the current thread
 void RLMInstallUncaughtExceptionHandler();
 
+// Install a handler for the system's memory pressure notifications which
+// trims the memory used by every open Realm
+void RLMInstallMemoryPressureHandler();
+
 std::unique_ptr<realm::BindingContext> RLMCreateBindingContext(RLMRealm *realm);
+// Get the RLMRealm which a binding context was created for
+RLMRealm *RLMGetRealmForBindingContext(realm::BindingContext *context);
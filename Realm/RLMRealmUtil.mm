@@ -19,64 +19,70 @@
 #import "RLMRealmUtil.hpp"
 
 #import "RLMObservation.hpp"
-#import "RLMRealm_Private.h"
+#import "RLMRealm_Private.hpp"
 #import "RLMUtil.hpp"
 
 #import <Realm/RLMConstants.h>
 #import <Realm/RLMSchema.h>
 
 #import "binding_context.hpp"
+#import "shared_realm.hpp"
+#import "sharded_cache.hpp"
 
-#import <map>
-#import <mutex>
 #import <sys/event.h>
 #import <sys/stat.h>
 #import <sys/time.h>
 #import <unistd.h>
 
 // Global realm state
-static std::mutex s_realmCacheMutex;
-static std::map<std::string, NSMapTable *> s_realmsPerPath;
-
-void RLMCacheRealm(std::string const& path, RLMRealm *realm) {
-    std::lock_guard<std::mutex> lock(s_realmCacheMutex);
-    NSMapTable *realms = s_realmsPerPath[path];
-    if (!realms) {
-        s_realmsPerPath[path] = realms = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsObjectPersonality
-                                                               valueOptions:NSPointerFunctionsWeakMemory];
+namespace {
+struct RLMRealmIsAlive {
+    bool operator()(__weak RLMRealm *const& realm) const { return realm != nil; }
+};
+realm::_impl::ShardedCache<mach_port_t, __weak RLMRealm *, RLMRealmIsAlive> s_realmCache;
+realm::_impl::ShardedCache<void *, __weak RLMRealm *, RLMRealmIsAlive> s_queueRealmCache;
+}
+
+void RLMCacheRealm(std::string const& path, RLMRealm *realm, dispatch_queue_t queue) {
+    if (queue) {
+        s_queueRealmCache.insert(path, (__bridge void *)queue, realm);
+    }
+    else {
+        s_realmCache.insert(path, pthread_mach_thread_np(pthread_self()), realm);
     }
-    [realms setObject:realm forKey:@(pthread_mach_thread_np(pthread_self()))];
 }
 
 RLMRealm *RLMGetAnyCachedRealmForPath(std::string const& path) {
-    std::lock_guard<std::mutex> lock(s_realmCacheMutex);
-    return [s_realmsPerPath[path] objectEnumerator].nextObject;
+    __weak RLMRealm *realm = nil;
+    if (!s_realmCache.get_any(path, realm)) {
+        s_queueRealmCache.get_any(path, realm);
+    }
+    return realm;
 }
 
-RLMRealm *RLMGetThreadLocalCachedRealmForPath(std::string const& path) {
-    mach_port_t threadID = pthread_mach_thread_np(pthread_self());
-    std::lock_guard<std::mutex> lock(s_realmCacheMutex);
-    return [s_realmsPerPath[path] objectForKey:@(threadID)];
+RLMRealm *RLMGetThreadLocalCachedRealmForPath(std::string const& path, dispatch_queue_t queue) {
+    __weak RLMRealm *realm = nil;
+    if (queue) {
+        s_queueRealmCache.get(path, (__bridge void *)queue, realm);
+    }
+    else {
+        s_realmCache.get(path, pthread_mach_thread_np(pthread_self()), realm);
+    }
+    return realm;
 }
 
 void RLMClearRealmCache() {
-    std::lock_guard<std::mutex> lock(s_realmCacheMutex);
-    s_realmsPerPath.clear();
+    s_realmCache.clear();
+    s_queueRealmCache.clear();
 }
 
 void RLMInstallUncaughtExceptionHandler() {
     static auto previousHandler = NSGetUncaughtExceptionHandler();
 
     NSSetUncaughtExceptionHandler([](NSException *exception) {
-        NSNumber *threadID = @(pthread_mach_thread_np(pthread_self()));
-        {
-            std::lock_guard<std::mutex> lock(s_realmCacheMutex);
-            for (auto const& realmsPerThread : s_realmsPerPath) {
-                if (RLMRealm *realm = [realmsPerThread.second objectForKey:threadID]) {
-                    if (realm.inWriteTransaction) {
-                        [realm cancelWriteTransaction];
-                    }
-                }
+        for (RLMRealm *realm : s_realmCache.values_for_thread(pthread_mach_thread_np(pthread_self()))) {
+            if (realm.inWriteTransaction) {
+                [realm cancelWriteTransaction];
             }
         }
         if (previousHandler) {
@@ -85,6 +91,24 @@ void RLMInstallUncaughtExceptionHandler() {
     });
 }
 
+void RLMInstallMemoryPressureHandler() {
+    // Warnings only drop caches, while critical pressure also releases old
+    // versions, as the memory pinned by them can be much larger
+    static dispatch_source_t source = [] {
+        auto source = dispatch_source_create(DISPATCH_SOURCE_TYPE_MEMORYPRESSURE, 0,
+                                             DISPATCH_MEMORYPRESSURE_WARN | DISPATCH_MEMORYPRESSURE_CRITICAL,
+                                             dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0));
+        dispatch_source_set_event_handler(source, ^{
+            auto level = dispatch_source_get_data(source) & DISPATCH_MEMORYPRESSURE_CRITICAL
+                       ? realm::Realm::TrimLevel::Versions
+                       : realm::Realm::TrimLevel::Caches;
+            realm::Realm::trim_memory_for_all_realms(level);
+        });
+        dispatch_resume(source);
+        return source;
+    }();
+}
+
 namespace {
 class RLMNotificationHelper : public realm::BindingContext {
 public:
@@ -99,11 +123,26 @@ public:
         }
     }
 
+    void idle_read_expired() override {
+        @autoreleasepool {
+            [_realm invalidate];
+        }
+    }
+
+    void will_trim_memory() override {
+        @autoreleasepool {
+            [_realm discardCachedResults];
+        }
+    }
+
     std::vector<ObserverState> get_observed_rows() override {
         @autoreleasepool {
             auto realm = _realm;
             [realm detachAllEnumerators];
-            return RLMGetObservedRows(realm.schema.objectSchema);
+            RLMSchema *schema = realm.schema;
+            RLMUpdateObservedRows(schema.objectSchema, _observedRows, schema != _observedRowsSchema);
+            _observedRowsSchema = schema;
+            return _observedRows;
         }
     }
 
@@ -113,16 +152,29 @@ public:
         }
     }
 
-    void did_change(std::vector<ObserverState> const& observed, std::vector<void*> const& invalidated) override {
+    void did_change(std::vector<ObserverState> const& observed, std::vector<void*> const& invalidated,
+                    VersionChange const& change) override {
         @autoreleasepool {
             RLMDidChange(observed, invalidated);
-            [_realm sendNotifications:RLMRealmDidChangeNotification];
+            auto realm = _realm;
+            // Only look up the group when it's needed, as doing so begins a
+            // read transaction if the Realm isn't in one
+            realm.lastChange = [[RLMRealmChange alloc] initWithVersionChange:change
+                                                                       group:change.modified_tables_known ? realm.group : nullptr];
+            [realm sendNotifications:RLMRealmDidChangeNotification];
         }
     }
 
+    RLMRealm *realm() const { return _realm; }
+
 private:
     // This is owned by the realm, so it needs to not retain the realm
     __weak RLMRealm *const _realm;
+
+    // The observed rows from the last advance, kept so that they only need to
+    // be rebuilt when objects start or stop being observed
+    std::vector<ObserverState> _observedRows;
+    __weak RLMSchema *_observedRowsSchema = nil;
 };
 } // anonymous namespace
 
@@ -130,3 +182,7 @@ private:
 std::unique_ptr<realm::BindingContext> RLMCreateBindingContext(RLMRealm *realm) {
     return std::unique_ptr<realm::BindingContext>(new RLMNotificationHelper(realm));
 }
+
+RLMRealm *RLMGetRealmForBindingContext(realm::BindingContext *context) {
+    return static_cast<RLMNotificationHelper *>(context)->realm();
+}
@@ -18,7 +18,7 @@
 
 #import <Realm/RLMRealm.h>
 
-@class RLMFastEnumerator;
+@class RLMFastEnumerator, RLMResults;
 
 // Disable syncing files to disk. Cannot be re-enabled. Use only for tests.
 FOUNDATION_EXTERN void RLMDisableSyncToDisk();
@@ -29,7 +29,10 @@ FOUNDATION_EXTERN NSData *RLMRealmValidatedEncryptionKey(NSData *key);
 @interface RLMRealm ()
 
 @property (nonatomic, readonly) BOOL dynamic;
+// The number of objects created at a time by fast enumeration
+@property (nonatomic, readonly) NSUInteger enumerationBatchSize;
 @property (nonatomic, readwrite) RLMSchema *schema;
+@property (nonatomic, readwrite) RLMRealmChange *lastChange;
 
 + (void)resetRealmState;
 
@@ -71,8 +74,18 @@ FOUNDATION_EXTERN NSData *RLMRealmValidatedEncryptionKey(NSData *key);
 
 - (void)registerEnumerator:(RLMFastEnumerator *)enumerator;
 - (void)unregisterEnumerator:(RLMFastEnumerator *)enumerator;
+// Must be called before anything in the Realm is modified, so that any
+// collections being enumerated are first copied
 - (void)detachAllEnumerators;
 
+// Get the RLMResults cached for the given key, or create one with `create`
+// and cache it. Sorted and filtered views of a persisted RLMArray are cached
+// so that everything showing the same view of a list shares one evaluation
+// of it. Keys must include something which identifies the list.
+- (RLMResults *)cachedResultsForKey:(id<NSCopying>)key create:(RLMResults *(^)())create;
+// Release the RLMResults cached by cachedResultsForKey:create:
+- (void)discardCachedResults;
+
 - (void)sendNotifications:(NSString *)notification;
 - (void)notify;
 - (void)verifyThread;
@@ -80,3 +93,11 @@ FOUNDATION_EXTERN NSData *RLMRealmValidatedEncryptionKey(NSData *key);
 + (NSString *)writeableTemporaryPathForFile:(NSString *)fileName;
 
 @end
+
+@interface RLMNotificationToken ()
+@property (nonatomic, strong) RLMRealm *realm;
+@property (nonatomic, copy) RLMNotificationBlock block;
+// Called by removeNotification: for tokens for notifications which aren't
+// delivered via the block
+@property (nonatomic, copy) void (^unregisterBlock)();
+@end
@@ -18,21 +18,163 @@
 
 #import "RLMRealm_Private.h"
 #import "RLMUtil.hpp"
+#import "binding_context.hpp"
 #import "shared_realm.hpp"
+#import "transact_log_handler.hpp"
 
 #import <realm/group.hpp>
 
+#import <memory>
+#import <unordered_map>
+
 namespace realm {
     class Group;
     class Realm;
     typedef std::shared_ptr<realm::Realm> SharedRealm;
 }
 
+@class RLMObjectBase, RLMObjectSchema;
+class RLMCopiedObjects;
+
+// The NSStrings and NSDatas created for large string and binary property
+// values read outside of write transactions, so that reading the same value
+// again while the Realm is at the same version returns the existing object
+// rather than copying the value out of the file again
+class RLMPropertyValueCache {
+public:
+    RLMPropertyValueCache(size_t minimum_size) : m_minimum_size(minimum_size) { }
+
+    size_t minimum_size() const { return m_minimum_size; }
+
+    template<typename Create>
+    id get(realm::Realm& realm, realm::Table const* table, size_t row, size_t col, Create&& create) {
+        if (realm.is_in_transaction()) {
+            return create();
+        }
+        auto version = realm.current_transaction_version();
+        if (version != m_version) {
+            m_values.clear();
+            m_version = version;
+        }
+
+        Key key{table, row, col};
+        auto it = m_values.find(key);
+        if (it != m_values.end()) {
+            return it->second;
+        }
+        if (m_values.size() >= max_values) {
+            m_values.clear();
+        }
+        id value = create();
+        m_values.emplace(key, value);
+        return value;
+    }
+
+private:
+    // The cache is emptied whenever it grows past this many values, to bound
+    // how many large values it can keep alive
+    static const size_t max_values = 256;
+
+    struct Key {
+        realm::Table const* table;
+        size_t row;
+        size_t col;
+
+        bool operator==(Key const& other) const {
+            return table == other.table && row == other.row && col == other.col;
+        }
+    };
+    struct KeyHash {
+        size_t operator()(Key const& key) const {
+            return std::hash<const void *>()(key.table) ^ (key.row * 31 + key.col);
+        }
+    };
+
+    size_t m_minimum_size;
+    uint_fast64_t m_version = 0;
+    std::unordered_map<Key, id, KeyHash> m_values;
+};
+
+// The accessors created for each row of a Realm opened with
+// reusesObjectAccessors, so that reading a row which already has a live
+// accessor returns that accessor rather than creating another one. Entries are
+// weak and are checked against the accessor's row when looked up. Core updates
+// the rows of live accessors from the transaction log as the Realm advances, so
+// each time the version changes the entries are re-keyed from their accessors'
+// rows. Within a write transaction the entries instead follow the rows moved by
+// deleting objects by parsing the new parts of the uncommitted transaction log.
+class RLMAccessorIdentityMap {
+public:
+    RLMObjectBase *get(realm::Realm& realm, RLMObjectSchema *objectSchema, realm::Table const* table, size_t row);
+    void add(realm::Realm& realm, realm::Table const* table, size_t row, RLMObjectBase *accessor);
+    void clear() { m_accessors.clear(); }
+
+private:
+    // Entries for accessors which have been deallocated are removed whenever
+    // the map grows to this many entries, which is then raised to twice the
+    // number of live entries
+    size_t m_prune_size = 1024;
+
+    struct Key {
+        realm::Table const* table;
+        size_t row;
+
+        bool operator==(Key const& other) const {
+            return table == other.table && row == other.row;
+        }
+    };
+    struct KeyHash {
+        size_t operator()(Key const& key) const {
+            return std::hash<const void *>()(key.table) ^ (key.row * 31);
+        }
+    };
+
+    // The version and write transaction the keys are up to date with
+    uint_fast64_t m_version = 0;
+    size_t m_write_count = 0;
+    // How much of the current write transaction's log the keys follow
+    realm::_impl::UncommittedRowIndexChanges m_log_parser;
+    std::unordered_map<Key, __weak RLMObjectBase *, KeyHash> m_accessors;
+
+    void update(realm::Realm& realm);
+    void follow_row_moves(realm::Realm& realm);
+    void move(realm::Table const* table, size_t from, size_t to);
+    void rekey();
+    void prune();
+};
+
 @interface RLMRealm () {
     @public
     realm::SharedRealm _realm;
+    // Only set if the configuration's cachedPropertyValueMinimumSize is non-zero
+    std::unique_ptr<RLMPropertyValueCache> _propertyValueCache;
+    // Only set if the configuration's reusesObjectAccessors is set
+    std::unique_ptr<RLMAccessorIdentityMap> _accessorIdentityMap;
+    // The objects copied into this Realm by the create call currently in
+    // progress, if any
+    RLMCopiedObjects *_copiedObjects;
+    // The object schema in this Realm for each RLMObject subclass which has
+    // been looked up by class, so that the class methods for creating and
+    // querying objects don't build and hash the class name on every call.
+    // Cleared whenever the schema is set.
+    std::unordered_map<Class, RLMObjectSchema *> _objectSchemaForClass;
 }
 
 // FIXME - group should not be exposed
 @property (nonatomic, readonly) realm::Group *group;
+
++ (instancetype)realmWithSharedRealm:(realm::SharedRealm)sharedRealm schema:(RLMSchema *)schema;
+@end
+
+@interface RLMRealmChange ()
+- (instancetype)initWithVersionChange:(realm::BindingContext::VersionChange const&)change
+                                group:(realm::Group *)group;
+@end
+
+@interface RLMFileSpaceUsage ()
+- (instancetype)initWithStatistics:(realm::FileStatistics const&)stats;
+@end
+
+@interface RLMIndexRecommendation ()
+- (instancetype)initWithRecommendation:(realm::QueryWorkload::IndexRecommendation const&)recommendation;
 @end
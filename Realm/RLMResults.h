@@ -22,7 +22,59 @@
 
 RLM_ASSUME_NONNULL_BEGIN
 
-@class RLMObject, RLMRealm;
+@class RLMObject, RLMRealm, RLMNotificationToken, RLMRowCursor, RLMAggregateView;
+
+/**
+ The changes to the objects in an RLMResults between two notifications from
+ `addNotificationBlock:`. An object which moved within the RLMResults is
+ reported as both a deletion and an insertion.
+ */
+@interface RLMCollectionChange : NSObject
+
+/**
+ The indexes in the previous version of the RLMResults of the objects which
+ were removed.
+ */
+@property (nonatomic, readonly) NSIndexSet *deletions;
+
+/**
+ The indexes in the new version of the RLMResults of the objects which were
+ added.
+ */
+@property (nonatomic, readonly) NSIndexSet *insertions;
+
+/**
+ The indexes in the new version of the RLMResults of the objects which were
+ modified but did not otherwise change position.
+ */
+@property (nonatomic, readonly) NSIndexSet *modifications;
+
+@end
+
+/**
+ Statistics of the values of a property over the objects in an RLMResults.
+ Obtained from `-[RLMResults statisticsForProperty:]`.
+ */
+@interface RLMPropertyStatistics : NSObject
+
+/// The number of objects.
+@property (nonatomic, readonly) NSUInteger count;
+
+/// The number of objects for which the property is `nil`.
+@property (nonatomic, readonly) NSUInteger nilCount;
+
+/// An estimate of the number of distinct non-`nil` values, which is usually
+/// within a few percent of the actual number and exact for small numbers of
+/// values. For `RLMObject` properties, the number of distinct objects linked to.
+@property (nonatomic, readonly) NSUInteger distinctCount;
+
+/// The smallest and largest non-`nil` values, or `nil` if every value is `nil`
+/// or the property is an `NSData` or `RLMObject` property. Strings are compared
+/// by their UTF-8 bytes rather than as `NSString`s would compare them.
+@property (nonatomic, readonly, nullable) id minimum;
+@property (nonatomic, readonly, nullable) id maximum;
+
+@end
 
 /**
  RLMResults is an auto-updating container type in Realm returned from object
@@ -156,6 +208,118 @@ RLM_ASSUME_NONNULL_BEGIN
  */
 - (RLMResults RLM_GENERIC_RETURN*)sortedResultsUsingDescriptors:(NSArray *)properties;
 
+/**
+ Get an `RLMResults` containing at most `limit` objects from this `RLMResults`,
+ starting at `offset`.
+
+ For sorted results only the objects needed are fully sorted, so this is much
+ faster than sorting everything when only the first few objects are needed.
+ The returned `RLMResults` remains live. Further filtering or sorting it
+ applies to just the objects within the limit.
+
+ @param limit   The maximum number of objects to include.
+ @param offset  The index of the first object to include.
+
+ @return    An RLMResults containing at most `limit` objects.
+ */
+- (RLMResults RLM_GENERIC_RETURN*)resultsWithLimit:(NSUInteger)limit offset:(NSUInteger)offset;
+
+/**
+ Get an `RLMResults` containing at most `limit` of the objects which sort after
+ the object at `index` in this sorted `RLMResults`.
+
+ Unlike `-resultsWithLimit:offset:`, the returned page is found from the values
+ of the sort properties of the object at `index` rather than from its position,
+ so it isn't shifted by objects being inserted or deleted before it, even if
+ the object at `index` is itself deleted. Calling this with the index of the
+ last object of a page gives the next page. Objects with equal values for
+ every sort property are kept in a consistent order between pages.
+
+ The start of the page is found with a binary search, and for results sorted
+ on a single indexed property only the objects in the page are read. The page
+ can be filtered further, but not sorted or limited.
+
+ Only results sorted on non-optional integer, boolean, float, double and date
+ properties can be paged.
+
+ @param index   The index of the object to start the page after.
+ @param limit   The maximum number of objects to include.
+
+ @return    An RLMResults containing the next page of objects.
+ */
+- (RLMResults RLM_GENERIC_RETURN*)resultsAfterObjectAtIndex:(NSUInteger)index limit:(NSUInteger)limit;
+
+/**
+ Get an `RLMResults` containing the same objects as this one which, when
+ enumerated, follows the given chains of links for each batch of objects
+ ahead of time.
+
+ For example, enumerating the results of
+ `[messages resultsPrefetchingKeyPaths:@[@"sender.avatar.url"]]` reads the
+ `sender` link of a whole batch of messages at once, then the `avatar` link of
+ each of those senders, visiting the linked objects in the order they are
+ stored in rather than one scattered lookup per message. The accessors for the
+ linked objects are created while doing so and kept by the objects linking to
+ them, so that `message.sender.avatar` doesn't create new ones.
+
+ Each key path is a sequence of to-one link properties, optionally ending with
+ the name of the property which will be read from the last object linked to.
+ Array properties can't be prefetched.
+
+ @param keyPaths    The key paths to prefetch, relative to the objects in the results.
+
+ @return    An RLMResults which prefetches the given key paths.
+ */
+- (RLMResults RLM_GENERIC_RETURN*)resultsPrefetchingKeyPaths:(NSArray RLM_GENERIC(NSString *) *)keyPaths;
+
+/**
+ Get an `RLMResults` containing the same objects as this one, declaring that
+ only the given properties of them are used.
+
+ Notification blocks added to the returned results only report an object as
+ modified when one of the projected properties changed, so changes to other
+ properties don't cause needless UI updates. Serializing the results to JSON
+ writes only the projected properties, and `-valueForKey:` and
+ `-dictionariesWithValuesForKeys:` only read the projected properties and
+ throw an exception for any other property.
+
+ The projection is kept by results derived from the returned results by
+ filtering, sorting or limiting them.
+
+ @param properties  The names of the properties to project.
+
+ @return    An RLMResults which only uses the given properties.
+ */
+- (RLMResults RLM_GENERIC_RETURN*)resultsProjectingProperties:(NSArray RLM_GENERIC(NSString *) *)properties;
+
+#pragma mark - Enumerating Without Allocating
+
+/**
+ Calls the block for each object in the RLMResults with a single accessor object which
+ is reused for every object, rather than creating a new object for each one as
+ fast enumeration does.
+
+ Because the accessor is changed to point at the next object after the block
+ returns, it must not be retained, stored, or otherwise used outside of the
+ block, and the RLMResults must not be modified during enumeration. Reading property
+ values inside the block is safe.
+
+ @param block   The block to call with the object, its index, and a pointer
+                which can be set to YES to stop the enumeration.
+ */
+- (void)enumerateObjectsUsingReusedAccessor:(void (^)(RLMObjectType object, NSUInteger index, BOOL *stop))block;
+
+/**
+ Returns a cursor which reads the property values of the objects in the
+ RLMResults directly, without creating an object for each one.
+
+ The RLMResults must not be modified while the cursor is in use.
+
+ @return    An `RLMRowCursor` positioned before the first object.
+ */
+- (RLMRowCursor *)rowCursor;
+
+
 
 #pragma mark - Aggregating Property Values
 
@@ -212,6 +376,232 @@ RLM_ASSUME_NONNULL_BEGIN
  */
 - (nullable NSNumber *)averageOfProperty:(NSString *)property;
 
+/**
+ Computes several aggregates over the objects in an RLMResults in a single pass.
+
+     NSArray *values = [results valuesForAggregateKeyPaths:@[@"@min.age", @"@max.age", @"@avg.age"]];
+
+ Computing several aggregates at once only reads the objects once, which is
+ faster than calling the individual aggregate methods for each value.
+
+ @warning The same property type restrictions apply as for the individual
+          aggregate methods.
+
+ @param keyPaths    An array of key paths of the form `@min.property`,
+                    `@max.property`, `@sum.property` or `@avg.property`.
+
+ @return An array containing the value of each aggregate, in the same order
+         as the key paths, with `NSNull` for aggregates which have no value.
+ */
+- (NSArray *)valuesForAggregateKeyPaths:(NSArray *)keyPaths;
+
+/**
+ Groups the objects in an RLMResults by the value of a property and computes
+ aggregates for each group, in a single pass over the objects.
+
+     NSArray *groups = [results groupBy:@"department" aggregates:@[@"@sum.salary", @"@max.age"]];
+     for (NSDictionary *group in groups) {
+         NSLog(@"%@: %@ people, %@ total", group[@"department"], group[@"@count"], group[@"@sum.salary"]);
+     }
+
+ @warning The grouped property must be an int, bool, string or date property.
+          The same property type restrictions apply to the aggregates as for
+          the individual aggregate methods.
+
+ @param property    The name of the property to group the objects by.
+ @param keyPaths    An array of key paths of the form `@min.property`,
+                    `@max.property`, `@sum.property` or `@avg.property`.
+
+ @return An array with a dictionary for each distinct value of the property,
+         in the order each value first appears in the RLMResults. Each
+         dictionary contains the value under the property's name, the number
+         of objects with that value under `@count`, and the value of each
+         aggregate under its key path, with `NSNull` for a nil property value
+         or an aggregate which has no value.
+ */
+- (NSArray *)groupBy:(NSString *)property aggregates:(NSArray *)keyPaths;
+
+/**
+ Returns the values of a numeric property for every object in an RLMResults,
+ packed into a contiguous buffer which can be passed directly to APIs such as
+ Accelerate or Metal without boxing each value in an `NSNumber`.
+
+     NSData *ages = [results valuesForNumericProperty:@"age" nullBitmap:nil];
+     const int64_t *values = ages.bytes;
+
+ Integer properties of any size are returned as `int64_t`, `float` properties
+ as `float` and `double` properties as `double`, in the order of the objects.
+
+ @param property    The name of an integer, float or double property.
+ @param nullBitmap  If non-NULL, set to a bitmap with bit `i` (least significant
+                    bit first) set if the `i`th object's value is nil. Nil values
+                    are stored as zero in the returned buffer.
+
+ @return    The values of the property.
+ */
+- (NSData *)valuesForNumericProperty:(NSString *)property nullBitmap:(NSData *__nullable *__nullable)nullBitmap;
+
+/**
+ Returns a view of the number of objects in the RLMResults, which is kept up
+ to date by examining only the objects which change.
+
+ @warning Aggregate views are not supported for RLMResults which are limited,
+          paged, have distinct values, or are backed by an RLMArray.
+
+ @return An `RLMAggregateView` whose value is the number of objects.
+ */
+- (RLMAggregateView *)countView;
+
+/**
+ Returns a view of the sum of the given property over the objects in the
+ RLMResults, which is kept up to date by examining only the objects which change.
+
+     RLMAggregateView *total = [results sumViewOfProperty:@"age"];
+
+ @warning The same restrictions apply as for `countView`.
+
+ @param property The property to sum. Only properties of type int, float and double are supported.
+
+ @return An `RLMAggregateView` whose value is the sum of the property.
+ */
+- (RLMAggregateView *)sumViewOfProperty:(NSString *)property;
+
+/**
+ Returns a view of the average of the given property over the objects in the
+ RLMResults, which is kept up to date by examining only the objects which change.
+
+ @warning The same restrictions apply as for `countView`.
+
+ @param property The property to average. Only properties of type int, float and double are supported.
+
+ @return An `RLMAggregateView` whose value is the average of the property.
+ */
+- (RLMAggregateView *)averageViewOfProperty:(NSString *)property;
+
+#pragma mark - Serializing to JSON
+
+/**
+ Returns the objects in this RLMResults as a UTF-8 encoded JSON array.
+
+ The values are read directly from the Realm file without creating an object
+ for each value, so this is much faster than building an array of
+ dictionaries to pass to `NSJSONSerialization`.
+
+ Each object is written as a JSON object keyed by property name. Dates are
+ written as seconds since 1970, `NSData` properties as base64 strings, and
+ `NaN` or infinite values and `id` properties as `null`. Object and array
+ properties are written as nested objects up to `linkDepth` levels deep, and
+ beyond that as the primary key of each linked object, or `null` if the
+ linked class has no primary key. For results created with
+ `-resultsProjectingProperties:` only the projected properties are written.
+
+ @param linkDepth   The number of levels of links to follow.
+
+ @return    The JSON data.
+ */
+- (NSData *)JSONDataWithLinkDepth:(NSUInteger)linkDepth;
+
+/**
+ Writes the objects in this RLMResults to a file descriptor as a UTF-8
+ encoded JSON array, in the format described for `-JSONDataWithLinkDepth:`.
+
+ The output is written in fixed-size chunks as it is produced, so the full
+ document is never held in memory.
+
+ @param fileDescriptor  An open file descriptor to write to.
+ @param linkDepth       The number of levels of links to follow.
+ @param error           If an error occurs, upon return contains an `NSError` object
+                        that describes the problem. If you are not interested in
+                        possible errors, pass in `NULL`.
+
+ @return    `YES` if the JSON was written successfully, `NO` otherwise.
+ */
+- (BOOL)writeJSONToFileDescriptor:(int)fileDescriptor linkDepth:(NSUInteger)linkDepth error:(NSError **)error;
+
+#pragma mark - Explaining Queries
+
+/**
+ Runs the query for this RLMResults again and describes how it was evaluated.
+
+ The description includes the conditions the predicate was converted into,
+ with each marked with whether it can use a search index (`index`), checks
+ values against a hash set (`hash set`), or has to check every object
+ (`scan`), followed by any sort order, limit and offset. This is followed by
+ the number of objects the query ran over, the number which matched, and how
+ long running the query and sorting the results took.
+
+ @warning This is intended for debugging and the format of the returned string
+          may change.
+
+ @return A description of the query's evaluation.
+ */
+- (NSString *)explain;
+
+#pragma mark - Property Statistics
+
+/**
+ Computes the number of objects, the number of `nil` values, an estimate of the
+ number of distinct values, and the smallest and largest value of the given
+ property over the objects in this RLMResults, in a single pass over them.
+
+ For the RLMResults returned by `+allObjects`, the statistics are kept by the
+ `RLMRealm` and only recomputed after it changes.
+
+ @warning This method cannot be called with `RLMArray` properties.
+
+ @param property The name of the property.
+
+ @return The statistics of the property's values.
+ */
+- (RLMPropertyStatistics *)statisticsForProperty:(NSString *)property;
+
+#pragma mark - Evaluating Queries Asynchronously
+
+/**
+ Runs the query for this RLMResults on a background thread, and then calls the
+ given block on the current thread with an RLMResults containing the same
+ objects whose query has already been run.
+
+ This can be used to avoid blocking the main thread while running queries which
+ are slow to evaluate or sort. Queries are run one at a time, in the order they
+ were started, on a single background thread shared by every Realm. The block is
+ called via the current thread's run loop, so the current thread must have a run
+ loop which is being run.
+ If the Realm has been changed before the block can be called, the query is
+ rerun against the new version before calling the block.
+
+ The block is called immediately when called within a write transaction, on
+ a read-only Realm, or on an RLMResults with a limit or offset applied.
+
+ @param block   The block to call with the evaluated results, or with an error
+                if the query could not be run.
+ */
+- (void)evaluateAsynchronously:(void (^)(RLMResults RLM_GENERIC_RETURN *__nullable results, NSError *__nullable error))block;
+
+#pragma mark - Notifications
+
+/**
+ Registers a block to be called each time the objects in this RLMResults
+ change, with which objects were inserted, deleted and modified.
+
+ The block is called when the Realm refreshes to a version in which this
+ RLMResults has changed. The change set is computed from the changes made by
+ other threads and processes; changes made by write transactions on this
+ Realm instance are reported as every object being replaced. Modifications to
+ objects linked to by the objects in the RLMResults are not reported.
+
+ If the RLMResults could not be re-evaluated the block is called with an
+ error and a nil change.
+
+ You must retain the returned token for as long as you want updates to
+ continue to be sent, and pass it to `removeNotification:` on the RLMResults'
+ Realm to stop receiving updates.
+
+ @param block   The block to call with the changes.
+ @return A token which must be held for as long as you want notifications to be delivered.
+ */
+- (RLMNotificationToken *)addNotificationBlock:(void (^)(RLMResults RLM_GENERIC_RETURN *results, RLMCollectionChange *__nullable change, NSError *__nullable error))block;
+
 /// :nodoc:
 - (id)objectAtIndexedSubscript:(NSUInteger)index;
 
@@ -18,6 +18,7 @@
 
 #import "RLMResults_Private.h"
 
+#import "RLMAggregateView_Private.hpp"
 #import "RLMArray_Private.hpp"
 #import "RLMObjectSchema_Private.hpp"
 #import "RLMObjectStore.h"
@@ -26,35 +27,166 @@
 #import "RLMProperty_Private.h"
 #import "RLMQueryUtil.hpp"
 #import "RLMRealm_Private.hpp"
+#import "RLMRowCursor_Private.hpp"
 #import "RLMSchema_Private.h"
+#import "RLMThreadSafeReference_Private.hpp"
 #import "RLMUtil.hpp"
 
+#import "json_writer.hpp"
 #import "results.hpp"
+#import "thread_safe_reference.hpp"
 
 #import <objc/runtime.h>
 #import <objc/message.h>
 #import <realm/table_view.hpp>
+#import <algorithm>
+#import <system_error>
+#import <unordered_set>
+#import <vector>
 
 using namespace realm;
 
-static const int RLMEnumerationBufferSize = 16;
+@interface RLMCollectionChange ()
+- (instancetype)initWithChanges:(CollectionChangeSet const&)changes;
+@end
+
+@interface RLMPropertyStatistics ()
+- (instancetype)initWithStatistics:(ColumnStatistics const&)stats;
+@end
+
+static NSIndexSet *RLMIndexSetFromIndexSet(IndexSet const& indexes) {
+    NSMutableIndexSet *ret = [NSMutableIndexSet new];
+    for (auto const& range : indexes) {
+        [ret addIndexesInRange:NSMakeRange(range.first, range.second - range.first)];
+    }
+    return ret;
+}
+
+@implementation RLMCollectionChange
+- (instancetype)initWithChanges:(CollectionChangeSet const&)changes {
+    self = [super init];
+    if (self) {
+        _deletions = RLMIndexSetFromIndexSet(changes.deletions);
+        _insertions = RLMIndexSetFromIndexSet(changes.insertions);
+        _modifications = RLMIndexSetFromIndexSet(changes.modifications);
+    }
+    return self;
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<RLMCollectionChange: %p> deletions: %@, insertions: %@, modifications: %@",
+            self, _deletions, _insertions, _modifications];
+}
+@end
+
+@implementation RLMPropertyStatistics
+- (instancetype)initWithStatistics:(ColumnStatistics const&)stats {
+    self = [super init];
+    if (self) {
+        _count = stats.count;
+        _nilCount = stats.null_count;
+        _distinctCount = stats.distinct_count;
+        _minimum = stats.min ? RLMMixedToObjc(*stats.min) : nil;
+        _maximum = stats.max ? RLMMixedToObjc(*stats.max) : nil;
+    }
+    return self;
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<RLMPropertyStatistics: %p> count: %lu, nil: %lu, distinct: ~%lu, minimum: %@, maximum: %@",
+            self, (unsigned long)_count, (unsigned long)_nilCount, (unsigned long)_distinctCount, _minimum, _maximum];
+}
+@end
+
+// Follow the prefetch paths from each of the given objects, creating the
+// accessors for the objects linked to and caching them on the objects which
+// link to them. Each link is read for the whole batch at once and the linked
+// rows are visited in row order, so that their data is read sequentially
+// rather than scattered over the file, and objects linked to from several
+// objects in the batch share a single accessor.
+static void RLMPrefetchLinks(RLMRealm *realm, std::vector<RLMPrefetchPath> const& paths,
+                             id const* objects, NSUInteger count) {
+    std::vector<__unsafe_unretained RLMObjectBase *> parents, children;
+    std::vector<std::pair<size_t, size_t>> links; // target row, index in parents
+    for (auto const& path : paths) {
+        parents.clear();
+        for (NSUInteger i = 0; i < count; ++i) {
+            parents.push_back(objects[i]);
+        }
+
+        for (auto const& hop : path) {
+            links.clear();
+            for (size_t i = 0; i < parents.size(); ++i) {
+                auto& row = parents[i]->_row;
+                if (row.is_attached() && !row.is_null_link(hop.column)) {
+                    links.emplace_back(row.get_link(hop.column), i);
+                }
+            }
+            std::sort(links.begin(), links.end());
+
+            children.clear();
+            RLMObjectBase *child = nil;
+            size_t childRow = realm::npos;
+            for (auto const& link : links) {
+                __unsafe_unretained RLMObjectBase *const parent = parents[link.second];
+                if (link.first != childRow) {
+                    childRow = link.first;
+                    child = RLMPrefetchedLink(parent, hop.column, childRow)
+                         ?: RLMCreateObjectAccessor(realm, hop.targetSchema, childRow);
+                    children.push_back(child);
+                }
+
+                auto& cache = parent->_prefetchedLinks;
+                auto it = std::find_if(cache.begin(), cache.end(), [&](auto const& p) { return p.first == hop.column; });
+                if (it == cache.end()) {
+                    cache.emplace_back(hop.column, child);
+                }
+                else {
+                    it->second = child;
+                }
+            }
+            std::swap(parents, children);
+        }
+    }
+}
 
 @implementation RLMFastEnumerator {
     // The buffer supplied by fast enumeration does not retain the objects given
     // to it, but because we create objects on-demand and don't want them
     // autoreleased (a table can have more rows than the device has memory for
-    // accessor objects) we need a thing to retain them.
-    id _strongBuffer[RLMEnumerationBufferSize];
+    // accessor objects) we need a thing to retain them. Because the items are
+    // returned from this buffer rather than the one supplied, batches can be
+    // larger than the count fast enumeration asks for.
+    std::vector<id> _strongBuffer;
+    // Source row indexes for the current batch, copied from the collection in
+    // a single call rather than asked for one object at a time
+    std::vector<size_t> _indexBuffer;
 
     RLMRealm *_realm;
     RLMObjectSchema *_objectSchema;
 
     // Collection being enumerated. Only one of these two will be valid: when
-    // possible we enumerate the collection directly, but when in a write
-    // transaction we instead create a frozen TableView and enumerate that
-    // instead so that mutating the collection during enumeration works.
+    // possible we enumerate the collection directly, but before the Realm is
+    // modified or advanced we are detached and create a frozen TableView to
+    // enumerate instead so that mutating the collection during enumeration
+    // works. Enumerations which don't modify anything never make the copy.
     id<RLMFastEnumerable> _collection;
     realm::TableView _tableView;
+
+    // State for nextObjectReusingAccessor:, which steps through the current
+    // batch of _indexBuffer rather than filling _strongBuffer. The count is
+    // taken when it is first called or the collection is detached.
+    NSUInteger _count;
+    NSUInteger _batchStart;
+    NSUInteger _batchIndex;
+    NSUInteger _batchCount;
+    bool _started;
+
+    // Link chains to create the accessors for ahead of time for each batch,
+    // and whether nextObjectReusingAccessor: is returning accessors created
+    // for the current batch in _strongBuffer
+    std::vector<RLMPrefetchPath> _prefetchPaths;
+    bool _batchPrefetched;
 }
 
 - (instancetype)initWithCollection:(id<RLMFastEnumerable>)collection objectSchema:(RLMObjectSchema *)objectSchema {
@@ -62,13 +194,14 @@ static const int RLMEnumerationBufferSize = 16;
     if (self) {
         _realm = collection.realm;
         _objectSchema = objectSchema;
+        _strongBuffer.resize(_realm.enumerationBatchSize);
+        _indexBuffer.resize(_realm.enumerationBatchSize);
 
-        if (_realm.inWriteTransaction) {
-            _tableView = [collection tableView];
-        }
-        else {
-            _collection = collection;
-            [_realm registerEnumerator:self];
+        _collection = collection;
+        [_realm registerEnumerator:self];
+
+        if ([collection isKindOfClass:[RLMResults class]]) {
+            _prefetchPaths = [(RLMResults *)collection prefetchPaths];
         }
     }
     return self;
@@ -81,55 +214,131 @@ static const int RLMEnumerationBufferSize = 16;
 }
 
 - (void)detach {
+    if (!_started) {
+        _started = true;
+        _count = _collection.count;
+    }
     _tableView = [_collection tableView];
     _collection = nil;
 }
 
-- (NSUInteger)countByEnumeratingWithState:(NSFastEnumerationState *)state
-                                    count:(NSUInteger)len {
-    [_realm verifyThread];
+// Copy the source row indexes of the next batch of objects into _indexBuffer
+- (NSUInteger)copyIndexesFrom:(NSUInteger)start count:(NSUInteger)count {
     if (!_tableView.is_attached() && !_collection) {
         @throw RLMException(@"Collection is no longer valid");
     }
-    // The fast enumeration buffer size is currently a hardcoded number in the
-    // compiler so this can't actually happen, but just in case it changes in
-    // the future...
-    if (len > RLMEnumerationBufferSize) {
-        len = RLMEnumerationBufferSize;
+
+    NSUInteger batchCount = std::min<NSUInteger>(_indexBuffer.size(), start < count ? count - start : 0);
+    if (_collection) {
+        batchCount = [_collection copySourceIndexes:_indexBuffer.data() from:start count:batchCount];
+    }
+    else {
+        for (NSUInteger i = 0; i < batchCount; ++i) {
+            size_t index = start + i;
+            _indexBuffer[i] = _tableView.is_row_attached(index) ? _tableView.get_source_ndx(index) : realm::npos;
+        }
+    }
+    return batchCount;
+}
+
+// Release our data once enumeration has finished, as we may be autoreleased
+// and so stick around for a while
+- (void)finish {
+    _collection = nil;
+    if (_tableView.is_attached()) {
+        _tableView = TableView();
+    }
+    else {
+        [_realm unregisterEnumerator:self];
+    }
+}
+
+- (RLMObjectBase *)nextObjectReusingAccessor:(RLMObjectBase *)accessor {
+    [_realm verifyThread];
+    if (!_started) {
+        _started = true;
+        _count = _collection.count;
+    }
+    if (_batchIndex == _batchCount) {
+        if (!_collection && !_tableView.is_attached()) {
+            // Already finished
+            return nil;
+        }
+        _batchStart += _batchCount;
+        _batchIndex = 0;
+        _batchCount = [self copyIndexesFrom:_batchStart count:_count];
+        if (_batchCount == 0) {
+            [self finish];
+            return nil;
+        }
+
+        // Following links needs the whole batch's accessors up front, which
+        // only helps if they aren't being reused
+        _batchPrefetched = !accessor && !_prefetchPaths.empty();
+        if (_batchPrefetched) {
+            [self createAccessorsForBatch:_batchCount];
+        }
     }
 
-    NSUInteger batchCount = 0, count = state->extra[1];
+    if (_batchPrefetched && !accessor) {
+        RLMObjectBase *next = _strongBuffer[_batchIndex++];
+        // Accessors from the identity map were initialized when created
+        if (!_realm->_accessorIdentityMap) {
+            RLMInitializeSwiftAccessorGenerics(next);
+        }
+        return next;
+    }
+    if (!accessor) {
+        accessor = [[_objectSchema.accessorClass alloc] initWithRealm:_realm schema:_objectSchema];
+        RLMInitializeSwiftAccessorGenerics(accessor);
+    }
+    size_t row = _indexBuffer[_batchIndex++];
+    accessor->_row = row == realm::npos ? Row() : (*_objectSchema.table)[row];
+    if (row != realm::npos) {
+        _realm->_realm->record_access(*_objectSchema.table, row);
+    }
+    return accessor;
+}
 
+// Fill _strongBuffer with accessors for the rows in _indexBuffer
+- (void)createAccessorsForBatch:(NSUInteger)batchCount {
     Class accessorClass = _objectSchema.accessorClass;
-    for (NSUInteger index = state->state; index < count && batchCount < len; ++index) {
-        RLMObject *accessor = [[accessorClass alloc] initWithRealm:_realm schema:_objectSchema];
-        if (_collection) {
-            accessor->_row = (*_objectSchema.table)[[_collection indexInSource:index]];
+    Table *table = _objectSchema.table;
+    bool reuseAccessors = _realm->_accessorIdentityMap != nullptr;
+    for (NSUInteger i = 0; i < batchCount; ++i) {
+        if (reuseAccessors && _indexBuffer[i] != realm::npos) {
+            _strongBuffer[i] = RLMCreateObjectAccessor(_realm, _objectSchema, (*table)[_indexBuffer[i]]);
+            continue;
         }
-        else if (_tableView.is_row_attached(index)) {
-            accessor->_row = (*_objectSchema.table)[_tableView.get_source_ndx(index)];
+        RLMObject *accessor = [[accessorClass alloc] initWithRealm:_realm schema:_objectSchema];
+        if (_indexBuffer[i] != realm::npos) {
+            accessor->_row = (*table)[_indexBuffer[i]];
+            _realm->_realm->record_access(*table, _indexBuffer[i]);
         }
-        _strongBuffer[batchCount] = accessor;
-        batchCount++;
+        _strongBuffer[i] = accessor;
     }
 
-    for (NSUInteger i = batchCount; i < len; ++i) {
+    for (NSUInteger i = batchCount; i < _strongBuffer.size(); ++i) {
         _strongBuffer[i] = nil;
     }
 
+    if (!_prefetchPaths.empty()) {
+        RLMPrefetchLinks(_realm, _prefetchPaths, _strongBuffer.data(), batchCount);
+    }
+}
+
+- (NSUInteger)countByEnumeratingWithState:(NSFastEnumerationState *)state
+                                    count:(NSUInteger)len {
+    [_realm verifyThread];
+    NSUInteger batchCount = [self copyIndexesFrom:state->state count:state->extra[1]];
+
+    [self createAccessorsForBatch:batchCount];
+
     if (batchCount == 0) {
-        // Release our data if we're done, as we're autoreleased and so may
-        // stick around for a while
-        _collection = nil;
-        if (_tableView.is_attached()) {
-            _tableView = TableView();
-        }
-        else {
-            [_realm unregisterEnumerator:self];
-        }
+        [self finish];
     }
 
-    state->itemsPtr = (__unsafe_unretained id *)(void *)_strongBuffer;
+    state->itemsPtr = (__unsafe_unretained id *)(void *)_strongBuffer.data();
     state->state += batchCount;
     state->mutationsPtr = state->extra+1;
 
@@ -137,12 +346,63 @@ static const int RLMEnumerationBufferSize = 16;
 }
 @end
 
+RLMFastEnumerator *RLMEnumeratorForCollection(id<RLMCollection> collection) {
+    if (![collection conformsToProtocol:@protocol(RLMFastEnumerable)]) {
+        return nil;
+    }
+    auto enumerable = static_cast<id<RLMFastEnumerable>>(collection);
+    [enumerable.realm verifyThread];
+    return [[RLMFastEnumerator alloc] initWithCollection:enumerable objectSchema:enumerable.objectSchema];
+}
+
+void RLMEnumerateWithReusedAccessor(id<RLMFastEnumerable> collection,
+                                    void (^block)(id object, NSUInteger index, BOOL *stop)) {
+    if (!block) {
+        @throw RLMException(@"The enumeration block should not be nil");
+    }
+
+    RLMRealm *realm = collection.realm;
+    [realm verifyThread];
+    RLMObjectSchema *objectSchema = collection.objectSchema;
+    RLMObjectBase *accessor = [[objectSchema.accessorClass alloc] initWithRealm:realm schema:objectSchema];
+    Table *table = objectSchema.table;
+
+    BOOL stop = NO;
+    auto visit = [&](NSUInteger index, size_t row) {
+        if (row == realm::npos) {
+            accessor->_row = Row();
+        }
+        else {
+            accessor->_row = (*table)[row];
+        }
+        RLMInitializeSwiftAccessorGenerics(accessor);
+        block(accessor, index, &stop);
+    };
+
+    // The collection can't be modified during enumeration, so unlike fast
+    // enumeration this never needs to copy it, even in write transactions
+    std::vector<size_t> indexes(realm.enumerationBatchSize);
+    for (NSUInteger start = 0; !stop; ) {
+        NSUInteger count = [collection copySourceIndexes:indexes.data() from:start count:indexes.size()];
+        if (count == 0) {
+            break;
+        }
+        @autoreleasepool {
+            for (NSUInteger i = 0; i < count && !stop; ++i) {
+                visit(start + i, indexes[i]);
+            }
+        }
+        start += count;
+    }
+}
+
 //
 // RLMResults implementation
 //
 @implementation RLMResults {
     realm::Results _results;
     RLMRealm *_realm;
+    std::vector<RLMPrefetchPath> _prefetchPaths;
 }
 
 - (instancetype)initPrivate {
@@ -188,6 +448,9 @@ static void throwError(NSString *aggregateMethod) {
                             RLMTypeToString((RLMPropertyType)e.column_type),
                             e.column_name.data());
     }
+    catch (std::logic_error const& e) {
+        @throw RLMException(e);
+    }
 }
 
 template<typename Function>
@@ -256,13 +519,9 @@ static inline void RLMResultsValidateInWriteTransaction(__unsafe_unretained RLMR
         return NSNotFound;
     }
 
-    Query query = translateErrors([&] { return _results.get_query(); });
+    Query query = _objectSchema.table->where();
     RLMUpdateQueryWithPredicate(&query, predicate, _realm.schema, _objectSchema);
-    size_t index = query.find();
-    if (index == realm::not_found) {
-        return NSNotFound;
-    }
-    return _results.index_of(index);
+    return RLMConvertNotFound(translateErrors([&] { return _results.index_of(std::move(query)); }));
 }
 
 - (id)objectAtIndex:(NSUInteger)index {
@@ -316,12 +575,34 @@ static inline void RLMResultsValidateInWriteTransaction(__unsafe_unretained RLMR
     return [super valueForKeyPath:keyPath];
 }
 
+// Throw if the key names a property which isn't projected by the Results
+static void RLMValidateProjectedKey(__unsafe_unretained RLMResults *const ar, __unsafe_unretained NSString *const key) {
+    auto const& projection = ar->_results.get_projection();
+    if (projection.empty()) {
+        return;
+    }
+    RLMProperty *prop = ar->_objectSchema[key];
+    if (prop && !std::binary_search(projection.begin(), projection.end(), prop.column)) {
+        @throw RLMException(@"Property '%@' is not projected by this RLMResults.", key);
+    }
+}
+
 - (id)valueForKey:(NSString *)key {
+    RLMValidateProjectedKey(self, key);
     return translateErrors([&] {
         return RLMCollectionValueForKey(self, key);
     });
 }
 
+- (NSArray *)dictionariesWithValuesForKeys:(NSArray *)keys {
+    for (NSString *key in keys) {
+        RLMValidateProjectedKey(self, key);
+    }
+    return translateErrors([&] {
+        return RLMCollectionDictionariesWithValuesForKeys(self, keys);
+    });
+}
+
 - (void)setValue:(id)value forKey:(NSString *)key {
     translateErrors([&] { RLMResultsValidateInWriteTransaction(self); });
     RLMCollectionSetValueForKey(self, key, value);
@@ -356,7 +637,65 @@ static inline void RLMResultsValidateInWriteTransaction(__unsafe_unretained RLMR
 }
 
 - (NSArray *)_distinctUnionOfObjectsForKeyPath:(NSString *)keyPath {
-    return [NSSet setWithArray:[self _unionOfObjectsForKeyPath:keyPath]].allObjects;
+    assertKeyPathIsNotNested(keyPath);
+    // Duplicates can't be removed from a page of Results
+    RLMProperty *prop = _results.is_paged() ? nil : _objectSchema[keyPath];
+    switch (prop ? prop.type : RLMPropertyTypeAny) {
+        case RLMPropertyTypeInt:
+        case RLMPropertyTypeBool:
+        case RLMPropertyTypeFloat:
+        case RLMPropertyTypeDouble:
+        case RLMPropertyTypeString:
+        case RLMPropertyTypeDate:
+            // Remove the duplicates in the core query so that only one
+            // value is read for each distinct value
+            return translateErrors([&] {
+                RLMResults *distinct = [RLMResults resultsWithObjectSchema:_objectSchema
+                                                                   results:_results.distinct(prop.column)];
+                return RLMCollectionValueForKey(distinct, keyPath);
+            });
+        default:
+            return [NSSet setWithArray:[self _unionOfObjectsForKeyPath:keyPath]].allObjects;
+    }
+}
+
+// Get the objects in the array property `prop` of every object in the
+// Results, in order and optionally without duplicates, by reading the target
+// rows of each LinkView rather than creating an RLMArray for each of them
+static NSArray *RLMUnionOfLinkViews(Results& results, RLMRealm *realm, RLMObjectSchema *objectSchema,
+                                    RLMProperty *prop, bool distinct) {
+    RLMObjectSchema *targetSchema = realm.schema[prop.objectClassName];
+    Table *table = objectSchema.table;
+    size_t col = prop.column;
+
+    std::vector<size_t> targets;
+    std::unordered_set<size_t> seen;
+    size_t rows[256];
+    for (size_t start = 0; ; ) {
+        size_t count = results.get_source_indexes(start, sizeof(rows) / sizeof(rows[0]), rows);
+        if (count == 0) {
+            break;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            if (rows[i] == npos) {
+                @throw RLMException(@"Object has been deleted or invalidated.");
+            }
+            LinkViewRef linkView = table->get_linklist(col, rows[i]);
+            for (size_t j = 0, size = linkView->size(); j < size; ++j) {
+                size_t target = linkView->get(j).get_index();
+                if (!distinct || seen.insert(target).second) {
+                    targets.push_back(target);
+                }
+            }
+        }
+        start += count;
+    }
+
+    NSMutableArray *objects = [NSMutableArray arrayWithCapacity:targets.size()];
+    for (size_t target : targets) {
+        [objects addObject:RLMCreateObjectAccessor(realm, targetSchema, target)];
+    }
+    return objects;
 }
 
 - (NSArray *)_unionOfArraysForKeyPath:(NSString *)keyPath {
@@ -365,6 +704,11 @@ static inline void RLMResultsValidateInWriteTransaction(__unsafe_unretained RLMR
         @throw RLMException(@"self is not a valid key-path for a KVC array collection operator as 'unionOfArrays'.");
     }
 
+    RLMProperty *prop = _objectSchema[keyPath];
+    if (prop.type == RLMPropertyTypeArray && _objectSchema.table) {
+        return translateErrors([&] { return RLMUnionOfLinkViews(_results, _realm, _objectSchema, prop, false); });
+    }
+
     return translateErrors([&] {
         NSArray *nestedResults = RLMCollectionValueForKey(self, keyPath);
         NSMutableArray *flatArray = [NSMutableArray arrayWithCapacity:nestedResults.count];
@@ -376,7 +720,12 @@ static inline void RLMResultsValidateInWriteTransaction(__unsafe_unretained RLMR
     });
 }
 
-- (NSArray *)_distinctUnionOfArraysForKeyPath:(__unused NSString *)keyPath {
+- (NSArray *)_distinctUnionOfArraysForKeyPath:(NSString *)keyPath {
+    assertKeyPathIsNotNested(keyPath);
+    RLMProperty *prop = _objectSchema[keyPath];
+    if (prop.type == RLMPropertyTypeArray && _objectSchema.table) {
+        return translateErrors([&] { return RLMUnionOfLinkViews(_results, _realm, _objectSchema, prop, true); });
+    }
     return [NSSet setWithArray:[self _unionOfArraysForKeyPath:keyPath]].allObjects;
 }
 
@@ -397,10 +746,15 @@ static inline void RLMResultsValidateInWriteTransaction(__unsafe_unretained RLMR
         if (_results.get_mode() == Results::Mode::Empty) {
             return self;
         }
-        auto query = _results.get_query();
+        auto query = _objectSchema.table->where();
         RLMUpdateQueryWithPredicate(&query, predicate, _realm.schema, _objectSchema);
-        return [RLMResults resultsWithObjectSchema:_objectSchema
-                                           results:realm::Results(_realm->_realm, std::move(query), _results.get_sort())];
+        auto results = _results.filter(std::move(query));
+        results.set_query_description(RLMPredicateDescriptionFunction(predicate, _objectSchema,
+                                                                      _results.get_query_description()));
+                                                                      _results.get_query_description()));
+        results.set_query_conditions(RLMPredicateConditionsFunction(predicate, _objectSchema,
+                                                                    _results.get_query_conditions()));
+        return [RLMResults resultsWithObjectSchema:_objectSchema results:std::move(results)];
     });
 }
 
@@ -419,6 +773,137 @@ static inline void RLMResultsValidateInWriteTransaction(__unsafe_unretained RLMR
     });
 }
 
+- (void)evaluateAsynchronously:(void (^)(RLMResults *, NSError *))block {
+    RLMObjectSchema *objectSchema = _objectSchema;
+    translateErrors([&] {
+        _results.evaluate_async([=](Results results, std::exception_ptr error) {
+            if (!error) {
+                block([RLMResults resultsWithObjectSchema:objectSchema results:std::move(results)], nil);
+                return;
+            }
+
+            try {
+                std::rethrow_exception(error);
+            }
+            catch (std::exception const& e) {
+                block(nil, RLMMakeError(RLMErrorFail, e));
+            }
+            catch (...) {
+                block(nil, [NSError errorWithDomain:RLMErrorDomain code:RLMErrorFail
+                                           userInfo:@{NSLocalizedDescriptionKey: @"Unable to evaluate query"}]);
+            }
+        });
+    });
+}
+
+- (RLMNotificationToken *)addNotificationBlock:(void (^)(RLMResults *, RLMCollectionChange *, NSError *))block {
+    if (!block) {
+        @throw RLMException(@"The notification block should not be nil");
+    }
+    if (!RLMIsInRunLoop()) {
+        @throw RLMException(@"Can only add notification blocks from within runloops.");
+    }
+
+    // The block keeps the RLMResults alive until the notification is removed
+    size_t token = translateErrors([&] {
+        return _results.add_notification_callback([=](CollectionChangeSet const& changes, std::exception_ptr error) {
+            if (!error) {
+                block(self, [[RLMCollectionChange alloc] initWithChanges:changes], nil);
+                return;
+            }
+
+            try {
+                std::rethrow_exception(error);
+            }
+            catch (std::exception const& e) {
+                block(self, nil, RLMMakeError(RLMErrorFail, e));
+            }
+            catch (...) {
+                block(self, nil, [NSError errorWithDomain:RLMErrorDomain code:RLMErrorFail
+                                                 userInfo:@{NSLocalizedDescriptionKey: @"Unable to evaluate query"}]);
+            }
+        });
+    });
+
+    RLMNotificationToken *notificationToken = [[RLMNotificationToken alloc] init];
+    notificationToken.realm = _realm;
+    Results results = _results;
+    notificationToken.unregisterBlock = ^{
+        Results(results).remove_notification_callback(token);
+    };
+    return notificationToken;
+}
+
+- (RLMResults *)resultsAfterObjectAtIndex:(NSUInteger)index limit:(NSUInteger)limit {
+    return translateErrors([&] {
+        if (_results.get_mode() == Results::Mode::Empty) {
+            return self;
+        }
+
+        return [RLMResults resultsWithObjectSchema:_objectSchema
+                                           results:_results.page_after(_results.page_anchor(index), limit)];
+    }, @"Paging");
+}
+
+- (RLMResults *)resultsWithLimit:(NSUInteger)limit offset:(NSUInteger)offset {
+    return translateErrors([&] {
+        if (_results.get_mode() == Results::Mode::Empty) {
+            return self;
+        }
+
+        return [RLMResults resultsWithObjectSchema:_objectSchema
+                                           results:_results.limit(limit, offset)];
+    });
+}
+
+- (RLMResults *)resultsPrefetchingKeyPaths:(NSArray *)keyPaths {
+    std::vector<RLMPrefetchPath> paths = _prefetchPaths;
+    for (NSString *keyPath in keyPaths) {
+        RLMPrefetchPath path;
+        RLMObjectSchema *objectSchema = _objectSchema;
+        for (NSString *name in [keyPath componentsSeparatedByString:@"."]) {
+            if (!objectSchema) {
+                @throw RLMException(@"Key path '%@' continues past a property which is not a link.", keyPath);
+            }
+            RLMProperty *prop = RLMValidatedProperty(objectSchema, name);
+            if (prop.type == RLMPropertyTypeArray) {
+                @throw RLMException(@"Key path '%@' can't be prefetched because '%@' is an array property.", keyPath, name);
+            }
+            if (prop.type != RLMPropertyTypeObject) {
+                // The key path ends with the value which will be read from
+                // the last object linked to
+                objectSchema = nil;
+                continue;
+            }
+            objectSchema = _realm.schema[prop.objectClassName];
+            path.push_back({prop.column, objectSchema});
+        }
+        if (!path.empty()) {
+            paths.push_back(std::move(path));
+        }
+    }
+
+    RLMResults *results = [RLMResults resultsWithObjectSchema:_objectSchema results:_results];
+    results->_prefetchPaths = std::move(paths);
+    return results;
+}
+
+- (RLMResults *)resultsProjectingProperties:(NSArray *)properties {
+    std::vector<size_t> columns;
+    for (NSString *name in properties) {
+        columns.push_back(RLMValidatedProperty(_objectSchema, name).column);
+    }
+    return translateErrors([&] {
+        RLMResults *results = [RLMResults resultsWithObjectSchema:_objectSchema results:_results.project(std::move(columns))];
+        results->_prefetchPaths = _prefetchPaths;
+        return results;
+    });
+}
+
+- (std::vector<RLMPrefetchPath> const&)prefetchPaths {
+    return _prefetchPaths;
+}
+
 - (id)objectAtIndexedSubscript:(NSUInteger)index {
     return [self objectAtIndex:index];
 }
@@ -432,6 +917,234 @@ static inline void RLMResultsValidateInWriteTransaction(__unsafe_unretained RLMR
     return RLMMixedToObjc(*value);
 }
 
+- (NSData *)valuesForNumericProperty:(NSString *)property nullBitmap:(NSData **)nullBitmap {
+    RLMProperty *prop = RLMValidatedProperty(_objectSchema, property);
+    auto copy = [&](auto type) {
+        using T = decltype(type);
+        return translateErrors([&] {
+            size_t count = _results.size();
+            NSMutableData *values = [NSMutableData dataWithLength:count * sizeof(T)];
+            NSMutableData *nulls = nullBitmap ? [NSMutableData dataWithLength:(count + 7) / 8] : nil;
+            _results.copy_column(prop.column, static_cast<T *>(values.mutableBytes),
+                                 static_cast<uint8_t *>(nulls.mutableBytes));
+            if (nullBitmap) {
+                *nullBitmap = nulls;
+            }
+            return values;
+        }, @"valuesForNumericProperty");
+    };
+
+    switch (prop.type) {
+        case RLMPropertyTypeInt:    return copy(int64_t());
+        case RLMPropertyTypeFloat:  return copy(float());
+        case RLMPropertyTypeDouble: return copy(double());
+        default:
+            @throw RLMException(@"valuesForNumericProperty is not supported for %@ property '%@'",
+                                RLMTypeToString(prop.type), property);
+    }
+}
+
+- (RLMAggregateView *)aggregateView:(realm::AggregateView::Operation)operation
+                         ofProperty:(NSString *)property
+                         methodName:(NSString *)methodName {
+    size_t column = property ? RLMValidatedProperty(_objectSchema, property).column : 0;
+    return translateErrors([&] {
+        return [[RLMAggregateView alloc] initWithRealm:_realm
+                                                  view:realm::AggregateView(_results, column, operation)];
+    }, methodName);
+}
+
+- (RLMAggregateView *)countView {
+    return [self aggregateView:realm::AggregateView::Operation::Count ofProperty:nil methodName:@"countView"];
+}
+
+- (RLMAggregateView *)sumViewOfProperty:(NSString *)property {
+    return [self aggregateView:realm::AggregateView::Operation::Sum ofProperty:property
+                    methodName:@"sumViewOfProperty"];
+}
+
+- (RLMAggregateView *)averageViewOfProperty:(NSString *)property {
+    return [self aggregateView:realm::AggregateView::Operation::Average ofProperty:property
+                    methodName:@"averageViewOfProperty"];
+}
+
+- (RLMRowCursor *)rowCursor {
+    return translateErrors([&] {
+        return [[RLMRowCursor alloc] initWithResults:self objectSchema:_objectSchema
+                                              cursor:realm::Results::Cursor(_results)];
+    });
+}
+
+- (NSData *)JSONDataWithLinkDepth:(NSUInteger)linkDepth {
+    NSMutableData *data = [NSMutableData data];
+    translateErrors([&] {
+        realm::JSONWriter writer(*_realm->_realm, linkDepth, [=](const char *bytes, size_t size) {
+            [data appendBytes:bytes length:size];
+        });
+        writer.write(_results);
+    });
+    return data;
+}
+
+- (BOOL)writeJSONToFileDescriptor:(int)fileDescriptor linkDepth:(NSUInteger)linkDepth error:(NSError **)error {
+    try {
+        translateErrors([&] {
+            realm::JSONWriter writer(*_realm->_realm, linkDepth, [=](const char *bytes, size_t size) {
+                while (size > 0) {
+                    ssize_t written = write(fileDescriptor, bytes, size);
+                    if (written < 0) {
+                        if (errno == EINTR) {
+                            continue;
+                        }
+                        throw std::system_error(errno, std::system_category());
+                    }
+                    bytes += written;
+                    size -= written;
+                }
+            });
+            writer.write(_results);
+        });
+        return YES;
+    }
+    catch (std::system_error const& ex) {
+        RLMSetErrorOrThrow(RLMMakeError(ex), error);
+        return NO;
+    }
+}
+
+- (RLMPropertyStatistics *)statisticsForProperty:(NSString *)property {
+    size_t column = RLMValidatedProperty(_objectSchema, property).column;
+    auto stats = translateErrors([&] { return _results.column_statistics(column); }, @"statisticsForProperty:");
+    return [[RLMPropertyStatistics alloc] initWithStatistics:stats];
+}
+
+- (NSString *)explain {
+    auto explanation = translateErrors([&] { return _results.explain(); });
+    return [NSString stringWithFormat:@"Query: %s\nObjects scanned: %zu\nMatches: %zu\nDuration: %.3fms",
+            explanation.description.c_str(), explanation.rows_scanned, explanation.matches,
+            explanation.duration.count() / 1000.0];
+}
+
+template<typename T>
+static T RLMMixedToNumber(Mixed const& value) {
+    switch (value.get_type()) {
+        case realm::type_Int:      return static_cast<T>(value.get_int());
+        case realm::type_Float:    return static_cast<T>(value.get_float());
+        case realm::type_Double:   return static_cast<T>(value.get_double());
+        case realm::type_DateTime: return static_cast<T>(value.get_datetime().get_datetime());
+        default:
+            @throw RLMException(@"Aggregate value is not a number or date");
+    }
+}
+
+- (util::Optional<Mixed>)aggregate:(RLMAggregateOperation)operation ofProperty:(NSString *)property {
+    size_t column = RLMValidatedProperty(_objectSchema, property).column;
+    switch (operation) {
+        case RLMAggregateOperationMin:
+            return translateErrors([&] { return _results.min(column); }, @"minOfProperty");
+        case RLMAggregateOperationMax:
+            return translateErrors([&] { return _results.max(column); }, @"maxOfProperty");
+        case RLMAggregateOperationSum:
+            return translateErrors([&] { return _results.sum(column); }, @"sumOfProperty");
+        case RLMAggregateOperationAverage:
+            return translateErrors([&] { return _results.average(column); }, @"averageOfProperty");
+    }
+    @throw RLMException(@"Invalid aggregate operation %ld", (long)operation);
+}
+
+- (BOOL)aggregate:(RLMAggregateOperation)operation ofProperty:(NSString *)property intValue:(int64_t *)value {
+    auto result = [self aggregate:operation ofProperty:property];
+    if (result) {
+        *value = RLMMixedToNumber<int64_t>(*result);
+    }
+    return bool(result);
+}
+
+- (BOOL)aggregate:(RLMAggregateOperation)operation ofProperty:(NSString *)property doubleValue:(double *)value {
+    auto result = [self aggregate:operation ofProperty:property];
+    if (result) {
+        *value = RLMMixedToNumber<double>(*result);
+    }
+    return bool(result);
+}
+
+- (std::vector<std::pair<size_t, Results::AggregateOperation>>)aggregateOperationsForKeyPaths:(NSArray *)keyPaths {
+    std::vector<std::pair<size_t, Results::AggregateOperation>> aggregates;
+    aggregates.reserve(keyPaths.count);
+    for (NSString *keyPath in keyPaths) {
+        NSRange separator = [keyPath rangeOfString:@"." options:NSLiteralSearch];
+        NSString *operatorName = separator.location == NSNotFound ? keyPath : [keyPath substringToIndex:separator.location];
+
+        Results::AggregateOperation op;
+        if ([operatorName isEqualToString:@"@min"]) {
+            op = Results::AggregateOperation::Min;
+        }
+        else if ([operatorName isEqualToString:@"@max"]) {
+            op = Results::AggregateOperation::Max;
+        }
+        else if ([operatorName isEqualToString:@"@sum"]) {
+            op = Results::AggregateOperation::Sum;
+        }
+        else if ([operatorName isEqualToString:@"@avg"]) {
+            op = Results::AggregateOperation::Average;
+        }
+        else {
+            @throw RLMException(@"Unsupported aggregate operator found in key path '%@'", keyPath);
+        }
+
+        if (separator.location == NSNotFound || separator.location + 1 >= keyPath.length) {
+            @throw RLMException(@"Missing key path for aggregate operator %@ in key path '%@'", operatorName, keyPath);
+        }
+        NSString *property = [keyPath substringFromIndex:separator.location + 1];
+        assertKeyPathIsNotNested(property);
+        aggregates.emplace_back(RLMValidatedProperty(_objectSchema, property).column, op);
+    }
+    return aggregates;
+}
+
+- (std::vector<util::Optional<Mixed>>)aggregatesForKeyPaths:(NSArray *)keyPaths {
+    auto aggregates = [self aggregateOperationsForKeyPaths:keyPaths];
+    return translateErrors([&] { return _results.aggregate_many(aggregates); },
+                           @"valuesForAggregateKeyPaths:");
+}
+
+- (void)valuesForAggregateKeyPaths:(NSArray *)keyPaths doubleValues:(double *)values hasValues:(BOOL *)hasValues {
+    auto results = [self aggregatesForKeyPaths:keyPaths];
+    for (size_t i = 0; i < results.size(); ++i) {
+        hasValues[i] = bool(results[i]);
+        values[i] = results[i] ? RLMMixedToNumber<double>(*results[i]) : 0;
+    }
+}
+
+- (NSArray *)valuesForAggregateKeyPaths:(NSArray *)keyPaths {
+    auto values = [self aggregatesForKeyPaths:keyPaths];
+    NSMutableArray *array = [NSMutableArray arrayWithCapacity:values.size()];
+    for (auto const& value : values) {
+        [array addObject:value ? RLMMixedToObjc(*value) : NSNull.null];
+    }
+    return array;
+}
+
+- (NSArray *)groupBy:(NSString *)property aggregates:(NSArray *)keyPaths {
+    assertKeyPathIsNotNested(property);
+    size_t column = RLMValidatedProperty(_objectSchema, property).column;
+    auto aggregates = [self aggregateOperationsForKeyPaths:keyPaths];
+    auto groups = translateErrors([&] { return _results.group_by(column, aggregates); },
+                                  @"groupBy:aggregates:");
+
+    NSMutableArray *array = [NSMutableArray arrayWithCapacity:groups.size()];
+    for (auto const& group : groups) {
+        NSMutableDictionary *values = [NSMutableDictionary dictionaryWithCapacity:keyPaths.count + 2];
+        values[property] = group.key ? RLMMixedToObjc(*group.key) : NSNull.null;
+        values[@"@count"] = @(group.count);
+        for (NSUInteger i = 0; i < keyPaths.count; ++i) {
+            values[keyPaths[i]] = group.values[i] ? RLMMixedToObjc(*group.values[i]) : NSNull.null;
+        }
+        [array addObject:values];
+    }
+    return array;
+}
+
 - (id)minOfProperty:(NSString *)property {
     return [self aggregate:property method:&Results::min methodName:@"minOfProperty"];
 }
@@ -460,6 +1173,14 @@ static inline void RLMResultsValidateInWriteTransaction(__unsafe_unretained RLMR
     });
 }
 
+- (void)deleteObjectsFromRealmInBatchesOfSize:(NSUInteger)batchSize {
+    return translateErrors([&] {
+        _results.clear(batchSize, [&](std::function<void()> const& deleteRows) {
+            RLMTrackDeletions(_realm, ^{ deleteRows(); });
+        });
+    });
+}
+
 - (NSString *)description {
     const NSUInteger maxObjects = 100;
     NSMutableString *mString = [NSMutableString stringWithFormat:@"RLMResults <0x%lx> (\n", (long)self];
@@ -496,8 +1217,29 @@ static inline void RLMResultsValidateInWriteTransaction(__unsafe_unretained RLMR
     return translateErrors([&] { return _results.get(index).get_index(); });
 }
 
+- (void)enumerateObjectsUsingReusedAccessor:(void (^)(id, NSUInteger, BOOL *))block {
+    RLMEnumerateWithReusedAccessor(self, block);
+}
+
+- (NSUInteger)copySourceIndexes:(size_t *)indexes from:(NSUInteger)index count:(NSUInteger)count {
+    return translateErrors([&] { return _results.get_source_indexes(index, count, indexes); });
+}
+
 - (realm::TableView)tableView {
     return translateErrors([&] { return _results.get_tableview(); });
 }
 
+- (RLMThreadSafeReference *)threadSafeReference {
+    try {
+        return [[RLMThreadSafeReference alloc] initWithReference:realm::ThreadSafeReference(_results)
+                                                 objectClassName:_objectSchema.className];
+    }
+    catch (realm::Results::InvalidatedException const&) {
+        @throw RLMException(@"RLMResults has been invalidated");
+    }
+    catch (std::exception const& ex) {
+        @throw RLMException(ex);
+    }
+}
+
 @end
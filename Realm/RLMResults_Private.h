@@ -20,6 +20,30 @@
 
 @class RLMObjectSchema;
 
+RLM_ASSUME_NONNULL_BEGIN
+
+typedef NS_ENUM(NSInteger, RLMAggregateOperation) {
+    RLMAggregateOperationMin,
+    RLMAggregateOperationMax,
+    RLMAggregateOperationSum,
+    RLMAggregateOperationAverage,
+};
+
 @interface RLMResults ()
 @property (nonatomic, unsafe_unretained) RLMObjectSchema *objectSchema;
+
+// Aggregates which are returned without boxing them in an NSNumber, for
+// RealmSwift. These return NO if the aggregate has no value, and otherwise
+// store it converted to the requested type, with dates as seconds since 1970.
+- (BOOL)aggregate:(RLMAggregateOperation)operation ofProperty:(NSString *)property intValue:(int64_t *)value;
+- (BOOL)aggregate:(RLMAggregateOperation)operation ofProperty:(NSString *)property doubleValue:(double *)value;
+
+// The same as valuesForAggregateKeyPaths:, but storing each value in `values`
+// as a double, and whether it has one in `hasValues`. Both must have room for
+// one entry per key path.
+- (void)valuesForAggregateKeyPaths:(NSArray RLM_GENERIC(NSString *) *)keyPaths
+                      doubleValues:(double *)values
+                         hasValues:(BOOL *)hasValues;
 @end
+
+RLM_ASSUME_NONNULL_END
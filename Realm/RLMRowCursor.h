@@ -0,0 +1,117 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#import <Foundation/Foundation.h>
+#import <Realm/RLMDefines.h>
+
+RLM_ASSUME_NONNULL_BEGIN
+
+/**
+ An RLMRowCursor steps through the objects in an `RLMResults` and reads their
+ property values directly from the Realm file, without creating an `RLMObject`
+ for each one.
+
+ Properties are identified by a column number obtained once from
+ `-columnForProperty:`, and read with the getter for the property's type:
+
+     RLMRowCursor *cursor = [people rowCursor];
+     NSUInteger age = [cursor columnForProperty:@"age"];
+     int64_t total = 0;
+     while ([cursor next]) {
+         total += [cursor intAtColumn:age];
+     }
+
+ Objects deleted after the cursor is created are skipped. Like the
+ `RLMResults` it was created from, a cursor can only be used on the thread
+ its Realm was opened on.
+ */
+@interface RLMRowCursor : NSObject
+
+/**
+ Move to the next object.
+
+ This must be called before reading the first object.
+
+ @return `YES` if there is a current object, or `NO` if every object has been visited.
+ */
+- (BOOL)next;
+
+/**
+ The index in the `RLMResults` of the current object.
+ */
+@property (nonatomic, readonly) NSUInteger index;
+
+/**
+ Returns the column number to pass to the getters to read the given property.
+
+ @param propertyName    The name of a property of the objects in the results.
+
+ @return    The column number for the property.
+ */
+- (NSUInteger)columnForProperty:(NSString *)propertyName;
+
+/** Returns whether the value of an optional property of the current object is nil. */
+- (BOOL)isNullAtColumn:(NSUInteger)column;
+
+/** Returns the value of an integer property of the current object. */
+- (int64_t)intAtColumn:(NSUInteger)column;
+
+/** Returns the value of a `BOOL` property of the current object. */
+- (BOOL)boolAtColumn:(NSUInteger)column;
+
+/** Returns the value of a `float` property of the current object. */
+- (float)floatAtColumn:(NSUInteger)column;
+
+/** Returns the value of a `double` property of the current object. */
+- (double)doubleAtColumn:(NSUInteger)column;
+
+/** Returns the value of an `NSString` property of the current object. */
+- (nullable NSString *)stringAtColumn:(NSUInteger)column;
+
+/** Returns the value of an `NSData` property of the current object. */
+- (nullable NSData *)dataAtColumn:(NSUInteger)column;
+
+/** Returns the value of an `NSDate` property of the current object, as seconds since 1970. */
+- (NSTimeInterval)dateAtColumn:(NSUInteger)column;
+
+/**
+ Returns the index of the object linked to by an object property of the current
+ object, among all objects of the linked class, or `NSNotFound` if it is nil.
+ */
+- (NSUInteger)linkAtColumn:(NSUInteger)column;
+
+/** Returns the number of objects in an array property of the current object. */
+- (NSUInteger)linkCountAtColumn:(NSUInteger)column;
+
+#pragma mark - Unavailable Methods
+
+/**
+ -[RLMRowCursor init] is not available because an RLMRowCursor must be
+ created with -[RLMResults rowCursor].
+ */
+- (instancetype)init __attribute__((unavailable("Use -[RLMResults rowCursor]")));
+
+/**
+ +[RLMRowCursor new] is not available because an RLMRowCursor must be
+ created with -[RLMResults rowCursor].
+ */
++ (instancetype)new __attribute__((unavailable("Use -[RLMResults rowCursor]")));
+
+@end
+
+RLM_ASSUME_NONNULL_END
@@ -0,0 +1,156 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#import "RLMRowCursor_Private.hpp"
+
+#import "RLMObjectSchema.h"
+#import "RLMProperty_Private.h"
+#import "RLMQueryUtil.hpp"
+#import "RLMRealm_Private.hpp"
+#import "RLMResults_Private.h"
+#import "RLMUtil.hpp"
+
+#import <realm/util/optional.hpp>
+#import <vector>
+
+@implementation RLMRowCursor {
+    RLMResults *_results;
+    RLMRealm *_realm;
+    RLMObjectSchema *_objectSchema;
+    // The type of the property stored in each column, or -1 for columns
+    // without one, so that the getters can check their column cheaply
+    std::vector<int> _columnTypes;
+    realm::util::Optional<realm::Results::Cursor> _cursor;
+    bool _hasRow;
+}
+
+- (instancetype)initWithResults:(RLMResults *)results
+                   objectSchema:(RLMObjectSchema *)objectSchema
+                         cursor:(realm::Results::Cursor)cursor {
+    self = [super init];
+    if (self) {
+        _results = results;
+        _realm = results.realm;
+        _objectSchema = objectSchema;
+        _cursor.emplace(std::move(cursor));
+        for (RLMProperty *prop in objectSchema.properties) {
+            if (prop.column >= _columnTypes.size()) {
+                _columnTypes.resize(prop.column + 1, -1);
+            }
+            _columnTypes[prop.column] = prop.type;
+        }
+    }
+    return self;
+}
+
+static void RLMValidateHasRow(__unsafe_unretained RLMRowCursor *const cursor) {
+    if (!cursor->_hasRow) {
+        @throw RLMException(@"RLMRowCursor has no current object. Call -next first.");
+    }
+}
+
+- (BOOL)next {
+    [_realm verifyThread];
+    try {
+        _hasRow = _cursor->next();
+    }
+    catch (realm::Results::InvalidatedException const&) {
+        @throw RLMException(@"RLMResults has been invalidated");
+    }
+    catch (std::exception const& ex) {
+        @throw RLMException(ex);
+    }
+    return _hasRow;
+}
+
+- (NSUInteger)index {
+    RLMValidateHasRow(self);
+    return _cursor->get_index();
+}
+
+- (NSUInteger)columnForProperty:(NSString *)propertyName {
+    return RLMValidatedProperty(_objectSchema, propertyName).column;
+}
+
+static void RLMValidateColumn(__unsafe_unretained RLMRowCursor *const cursor, NSUInteger column, RLMPropertyType type) {
+    RLMValidateHasRow(cursor);
+    if (column >= cursor->_columnTypes.size() || cursor->_columnTypes[column] != type) {
+        @throw RLMException(@"Column %zu is not a %@ property of '%@'.",
+                            (size_t)column, RLMTypeToString(type), cursor->_objectSchema.className);
+    }
+}
+
+- (BOOL)isNullAtColumn:(NSUInteger)column {
+    RLMValidateHasRow(self);
+    if (column >= _columnTypes.size() || _columnTypes[column] == -1) {
+        @throw RLMException(@"Column %zu is not a property of '%@'.", (size_t)column, _objectSchema.className);
+    }
+    switch (_columnTypes[column]) {
+        case RLMPropertyTypeObject: return _cursor->get_link(column) == realm::npos;
+        case RLMPropertyTypeArray:  return NO;
+        default:                    return _cursor->is_null(column);
+    }
+}
+
+- (int64_t)intAtColumn:(NSUInteger)column {
+    RLMValidateColumn(self, column, RLMPropertyTypeInt);
+    return _cursor->get_int(column);
+}
+
+- (BOOL)boolAtColumn:(NSUInteger)column {
+    RLMValidateColumn(self, column, RLMPropertyTypeBool);
+    return _cursor->get_bool(column);
+}
+
+- (float)floatAtColumn:(NSUInteger)column {
+    RLMValidateColumn(self, column, RLMPropertyTypeFloat);
+    return _cursor->get_float(column);
+}
+
+- (double)doubleAtColumn:(NSUInteger)column {
+    RLMValidateColumn(self, column, RLMPropertyTypeDouble);
+    return _cursor->get_double(column);
+}
+
+- (NSString *)stringAtColumn:(NSUInteger)column {
+    RLMValidateColumn(self, column, RLMPropertyTypeString);
+    return RLMStringDataToNSString(_cursor->get_string(column));
+}
+
+- (NSData *)dataAtColumn:(NSUInteger)column {
+    RLMValidateColumn(self, column, RLMPropertyTypeData);
+    return RLMBinaryDataToNSData(_cursor->get_binary(column));
+}
+
+- (NSTimeInterval)dateAtColumn:(NSUInteger)column {
+    RLMValidateColumn(self, column, RLMPropertyTypeDate);
+    return _cursor->get_datetime(column).get_datetime();
+}
+
+- (NSUInteger)linkAtColumn:(NSUInteger)column {
+    RLMValidateColumn(self, column, RLMPropertyTypeObject);
+    size_t row = _cursor->get_link(column);
+    return row == realm::npos ? NSNotFound : row;
+}
+
+- (NSUInteger)linkCountAtColumn:(NSUInteger)column {
+    RLMValidateColumn(self, column, RLMPropertyTypeArray);
+    return _cursor->get_link_count(column);
+}
+
+@end
@@ -31,23 +31,163 @@
 
 #import <realm/group.hpp>
 
+#import <mach-o/dyld.h>
+#import <mach-o/loader.h>
 #import <objc/runtime.h>
+#include <algorithm>
+#include <array>
 #include <mutex>
+#include <vector>
 
 using namespace realm;
 
 const uint64_t RLMNotVersioned = realm::ObjectStore::NotVersioned;
 
-// RLMSchema private properties
-@interface RLMSchema ()
-@property (nonatomic, readwrite) NSMutableDictionary *objectSchemaByName;
+// The object schemas of each copy of a schema are specific to the Realm it was
+// copied for, but the lookup from class name to position in the object schema
+// array never changes, so one immutable instance of it is shared by a schema
+// and all of its shallow copies rather than being rebuilt for each Realm.
+@interface RLMSchemaObjectIndexes : NSObject {
+    @public
+    NSDictionary<NSString *, NSNumber *> *_indexByName;
+}
+@end
+
+@implementation RLMSchemaObjectIndexes
+- (instancetype)initWithObjectSchema:(NSArray *)objectSchema {
+    self = [super init];
+    if (self) {
+        NSMutableDictionary *indexByName = [NSMutableDictionary dictionaryWithCapacity:objectSchema.count];
+        NSUInteger i = 0;
+        for (RLMObjectSchema *object in objectSchema) {
+            indexByName[object.className] = @(i++);
+        }
+        _indexByName = [indexByName copy];
+    }
+    return self;
+}
 @end
 
 static RLMSchema *s_sharedSchema;
 static RLMSchema *s_partialSharedSchema = [[RLMSchema alloc] init];
 static NSMutableDictionary *s_localNameToClass = [[NSMutableDictionary alloc] init];
 
-@implementation RLMSchema
+// Finding the RLMObject subclasses requires enumerating (and so realizing)
+// every class in the process, which is a significant part of launch time for
+// apps linking many frameworks. The names of the classes found are therefore
+// cached on disk, keyed by the UUIDs of all of the loaded images: any change to
+// the app, its frameworks or the OS changes at least one of them.
+static NSString *RLMLoadedImagesFingerprint() {
+    std::vector<std::array<uint8_t, 16>> uuids;
+    for (uint32_t i = 0, count = _dyld_image_count(); i < count; ++i) {
+        auto header = _dyld_get_image_header(i);
+        if (!header) {
+            return nil;
+        }
+        bool is64 = header->magic == MH_MAGIC_64;
+        auto cmd = reinterpret_cast<const load_command *>(reinterpret_cast<const char *>(header)
+                                                          + (is64 ? sizeof(mach_header_64) : sizeof(mach_header)));
+        bool found = false;
+        for (uint32_t j = 0; j < header->ncmds; ++j) {
+            if (cmd->cmd == LC_UUID) {
+                std::array<uint8_t, 16> uuid;
+                std::copy_n(reinterpret_cast<const uuid_command *>(cmd)->uuid, 16, uuid.begin());
+                uuids.push_back(uuid);
+                found = true;
+                break;
+            }
+            cmd = reinterpret_cast<const load_command *>(reinterpret_cast<const char *>(cmd) + cmd->cmdsize);
+        }
+        // Images without a UUID can change without the fingerprint changing
+        if (!found) {
+            return nil;
+        }
+    }
+
+    // The order images are loaded in isn't guaranteed to be stable
+    std::sort(uuids.begin(), uuids.end());
+    uint64_t hash = 14695981039346656037ULL;
+    for (auto const& uuid : uuids) {
+        for (uint8_t byte : uuid) {
+            hash = (hash ^ byte) * 1099511628211ULL;
+        }
+    }
+    return [NSString stringWithFormat:@"%llx-%zu", hash, uuids.size()];
+}
+
+static NSString *RLMObjectClassCachePath() {
+    NSString *caches = NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES).firstObject;
+    return [caches stringByAppendingPathComponent:@"io.realm.object-classes.plist"];
+}
+
+static NSString *const c_objectClassCacheFingerprintKey = @"fingerprint";
+static NSString *const c_objectClassCacheClassesKey = @"classes";
+
+// Returns the cached RLMObject subclasses, or nil if the cache is missing,
+// stale, or names classes which no longer exist or are no longer RLMObjects
+static NSArray *RLMCachedObjectClasses(NSString *fingerprint) {
+    if (!fingerprint) {
+        return nil;
+    }
+    NSDictionary *cache = [NSDictionary dictionaryWithContentsOfFile:RLMObjectClassCachePath()];
+    if (![cache[c_objectClassCacheFingerprintKey] isEqual:fingerprint]) {
+        return nil;
+    }
+    NSArray *names = cache[c_objectClassCacheClassesKey];
+    if (![names isKindOfClass:[NSArray class]]) {
+        return nil;
+    }
+
+    NSMutableArray *classes = [NSMutableArray arrayWithCapacity:names.count];
+    for (NSString *name in names) {
+        Class cls = [name isKindOfClass:[NSString class]] ? objc_getClass(name.UTF8String) : Nil;
+        if (!cls || !RLMIsObjectSubclass(cls) || RLMIsGeneratedClass(cls)) {
+            return nil;
+        }
+        [classes addObject:cls];
+    }
+    return classes;
+}
+
+static void RLMCacheObjectClasses(NSString *fingerprint, NSArray *classes) {
+    if (!fingerprint) {
+        return;
+    }
+    NSMutableArray *names = [NSMutableArray arrayWithCapacity:classes.count];
+    for (Class cls in classes) {
+        [names addObject:@(class_getName(cls))];
+    }
+    // Writing the cache isn't needed for this launch, so keep it off the
+    // thread which is initializing the schema
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_BACKGROUND, 0), ^{
+        [@{c_objectClassCacheFingerprintKey: fingerprint, c_objectClassCacheClassesKey: names}
+         writeToFile:RLMObjectClassCachePath() atomically:YES];
+    });
+}
+
+// All of the RLMObject subclasses which can be included in the shared schema
+static NSArray *RLMFindObjectClasses() {
+    NSString *fingerprint = RLMLoadedImagesFingerprint();
+    if (NSArray *classes = RLMCachedObjectClasses(fingerprint)) {
+        return classes;
+    }
+
+    unsigned int numClasses;
+    std::unique_ptr<__unsafe_unretained Class[], decltype(&free)> classList(objc_copyClassList(&numClasses), &free);
+    NSMutableArray *classes = [NSMutableArray array];
+    for (unsigned int i = 0; i < numClasses; ++i) {
+        Class cls = classList[i];
+        if (RLMIsObjectSubclass(cls) && !RLMIsGeneratedClass(cls)) {
+            [classes addObject:cls];
+        }
+    }
+    RLMCacheObjectClasses(fingerprint, classes);
+    return classes;
+}
+
+@implementation RLMSchema {
+    RLMSchemaObjectIndexes *_indexes;
+}
 
 + (instancetype)schemaWithObjectClasses:(NSArray *)classes {
     NSUInteger count = classes.count;
@@ -72,7 +212,7 @@ static NSMutableDictionary *s_localNameToClass = [[NSMutableDictionary alloc] in
             if (prop.type != RLMPropertyTypeObject && prop.type != RLMPropertyTypeArray) {
                 continue;
             }
-            if (!schema->_objectSchemaByName[prop.objectClassName]) {
+            if (![schema schemaForClassName:prop.objectClassName]) {
                 [errors addObject:[NSString stringWithFormat:@"- '%@.%@' links to class '%@', which is missing from the list of classes to persist", objectSchema.className, prop.name, prop.objectClassName]];
             }
         }
@@ -85,11 +225,15 @@ static NSMutableDictionary *s_localNameToClass = [[NSMutableDictionary alloc] in
 }
 
 - (RLMObjectSchema *)schemaForClassName:(NSString *)className {
-    return _objectSchemaByName[className];
+    if (!_indexes) {
+        return nil;
+    }
+    NSNumber *index = _indexes->_indexByName[className];
+    return index ? _objectSchema[index.unsignedIntegerValue] : nil;
 }
 
 - (RLMObjectSchema *)objectForKeyedSubscript:(__unsafe_unretained id<NSCopying> const)className {
-    RLMObjectSchema *schema = _objectSchemaByName[className];
+    RLMObjectSchema *schema = [self schemaForClassName:(NSString *)className];
     if (!schema) {
         @throw RLMException(@"Object type '%@' not persisted in Realm", className);
     }
@@ -97,11 +241,8 @@ static NSMutableDictionary *s_localNameToClass = [[NSMutableDictionary alloc] in
 }
 
 - (void)setObjectSchema:(NSArray *)objectSchema {
-    _objectSchema = objectSchema;
-    _objectSchemaByName = [NSMutableDictionary dictionaryWithCapacity:objectSchema.count];
-    for (RLMObjectSchema *object in objectSchema) {
-        [(NSMutableDictionary *)_objectSchemaByName setObject:object forKey:object.className];
-    }
+    _objectSchema = [objectSchema copy];
+    _indexes = [[RLMSchemaObjectIndexes alloc] initWithObjectSchema:_objectSchema];
 }
 
 + (instancetype)partialSharedSchema {
@@ -189,9 +330,11 @@ static NSMutableDictionary *s_localNameToClass = [[NSMutableDictionary alloc] in
         threadID = pthread_mach_thread_np(pthread_self());
         RLMSchema *schema = [[RLMSchema alloc] init];
 
-        unsigned int numClasses;
-        std::unique_ptr<__unsafe_unretained Class[], decltype(&free)> classes(objc_copyClassList(&numClasses), &free);
-        [self registerClasses:classes.get() count:numClasses];
+        NSArray *objectClasses = RLMFindObjectClasses();
+        NSUInteger count = objectClasses.count;
+        auto classes = std::make_unique<__unsafe_unretained Class[]>(count);
+        [objectClasses getObjects:classes.get() range:NSMakeRange(0, count)];
+        [self registerClasses:classes.get() count:count];
 
         // set class array
         schema.objectSchema = s_partialSharedSchema.objectSchema;
@@ -241,11 +384,15 @@ static NSMutableDictionary *s_localNameToClass = [[NSMutableDictionary alloc] in
 
 - (instancetype)shallowCopy {
     RLMSchema *schema = [[RLMSchema alloc] init];
-    NSMutableArray *objectSchema = [NSMutableArray arrayWithCapacity:_objectSchema.count];
+    NSUInteger count = _objectSchema.count;
+    auto objectSchema = std::make_unique<RLMObjectSchema *[]>(count);
+    NSUInteger i = 0;
     for (RLMObjectSchema *schema in _objectSchema) {
-        [objectSchema addObject:[schema shallowCopy]];
+        objectSchema[i++] = [schema shallowCopy];
     }
-    schema.objectSchema = objectSchema;
+    // the copies are in the same order, so the name lookup can be shared
+    schema->_objectSchema = [NSArray arrayWithObjects:objectSchema.get() count:count];
+    schema->_indexes = _indexes;
     return schema;
 }
 
@@ -254,7 +401,7 @@ static NSMutableDictionary *s_localNameToClass = [[NSMutableDictionary alloc] in
         return NO;
     }
     for (RLMObjectSchema *objectSchema in schema.objectSchema) {
-        if (![_objectSchemaByName[objectSchema.className] isEqualToObjectSchema:objectSchema]) {
+        if (![[self schemaForClassName:objectSchema.className] isEqualToObjectSchema:objectSchema]) {
             return NO;
         }
     }
@@ -0,0 +1,113 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#import <Foundation/Foundation.h>
+#import <Realm/RLMDefines.h>
+
+RLM_ASSUME_NONNULL_BEGIN
+
+@class RLMRealm;
+
+/**
+ An RLMSnapshot is an immutable view of a single version of the data in a
+ Realm, which can be read from any number of threads at the same time. This
+ allows fanning out work over a single consistent version of the data without
+ each thread having its own Realm which could be at a different version.
+
+     RLMSnapshot *snapshot = [realm snapshot];
+     dispatch_apply(count, queue, ^(size_t i) {
+         [snapshot readWithBlock:^(RLMRealm *realm) {
+             // read from realm
+         }];
+     });
+
+ The version of the data is kept alive, and so the file can't reuse the space
+ used by it, for as long as the snapshot exists.
+ */
+@interface RLMSnapshot : NSObject
+
+/**
+ The version of the data which this snapshot reads from.
+ */
+@property (nonatomic, readonly) uint64_t version;
+
+/**
+ Read from the snapshot.
+
+ The block is passed a read-only Realm at the snapshot's version which the
+ calling thread has exclusive use of until the block returns. Objects and
+ results obtained from it must not be used after the block returns.
+
+ This method can be called from any thread, including from several threads
+ at once.
+
+ @param block The block to call with the Realm to read from.
+ */
+- (void)readWithBlock:(RLM_NOESCAPE void (^)(RLMRealm *realm))block;
+
+/**
+ A block called periodically while a copy of a snapshot is written, with the
+ number of bytes written so far and an estimate of the total size of the copy.
+ Return `NO` to cancel the copy.
+ */
+typedef BOOL (^RLMCopyProgressBlock)(NSUInteger bytesWritten, NSUInteger totalBytes);
+
+/**
+ Write a compacted copy of the snapshot's version of the data to a new Realm
+ file, optionally encrypted with a different key than the source file.
+
+ Unlike `-[RLMRealm writeCopyToPath:error:]`, the copy is written in chunks with
+ progress reported after each, and it can be written on any thread while the
+ Realm the snapshot was taken from continues to be used. Memory use is bounded
+ by the chunk size rather than the size of the file.
+
+ If the copy is cancelled or fails, the partially written file is removed.
+
+ @param path     Path to save the Realm to. The file must not already exist.
+ @param key      64-byte encryption key to encrypt the new file with, or `nil`.
+ @param progress A block called after each chunk is written, or `nil`.
+ @param error    On input, a pointer to an error object. If an error occurs,
+                 this pointer is set to an actual error object containing the
+                 error information, with the code `RLMErrorCancelled` if the
+                 copy was cancelled. You may specify nil for this parameter if
+                 you do not want the error information.
+
+ @return YES if the copy was written successfully.
+ */
+- (BOOL)writeCopyToPath:(NSString *)path
+          encryptionKey:(nullable NSData *)key
+               progress:(nullable RLMCopyProgressBlock)progress
+                  error:(NSError **)error;
+
+#pragma mark - Unavailable Methods
+
+/**
+ -[RLMSnapshot init] is not available because an RLMSnapshot must be created
+ from a Realm with -[RLMRealm snapshot].
+ */
+- (instancetype)init __attribute__((unavailable("Use -[RLMRealm snapshot]")));
+
+/**
+ +[RLMSnapshot new] is not available because an RLMSnapshot must be created
+ from a Realm with -[RLMRealm snapshot].
+ */
++ (instancetype)new __attribute__((unavailable("Use -[RLMRealm snapshot]")));
+
+@end
+
+RLM_ASSUME_NONNULL_END
@@ -0,0 +1,106 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#import "RLMSnapshot_Private.hpp"
+
+#import "RLMRealm_Private.hpp"
+#import "RLMSchema_Private.h"
+#import "RLMUtil.hpp"
+
+#import "realm_snapshot.hpp"
+
+using realm::util::File;
+
+@implementation RLMSnapshot {
+    std::shared_ptr<realm::RealmSnapshot> _snapshot;
+    RLMSchema *_schema;
+}
+
+- (instancetype)initWithSnapshot:(std::shared_ptr<realm::RealmSnapshot>)snapshot schema:(RLMSchema *)schema {
+    self = [super init];
+    if (self) {
+        _snapshot = std::move(snapshot);
+        _schema = schema;
+    }
+    return self;
+}
+
+- (uint64_t)version {
+    return _snapshot->version();
+}
+
+- (void)readWithBlock:(RLM_NOESCAPE void (^)(RLMRealm *))block {
+    _snapshot->read([&](realm::SharedRealm const& sharedRealm) {
+        // Each object schema points at its Realm, so every read needs its own
+        // copy of the schema
+        RLMRealm *realm = [RLMRealm realmWithSharedRealm:sharedRealm schema:[_schema shallowCopy]];
+        @try {
+            block(realm);
+        }
+        @finally {
+            // The frozen Realm is lent to other threads once this returns, so
+            // make any accessors which escaped the block unusable
+            realm->_realm = nullptr;
+        }
+    });
+}
+
+- (BOOL)writeCopyToPath:(NSString *)path encryptionKey:(NSData *)key
+               progress:(RLMCopyProgressBlock)progress error:(NSError **)error {
+    key = RLMRealmValidatedEncryptionKey(key);
+
+    realm::RealmSnapshot::CopyProgressFunction progressFunction;
+    if (progress) {
+        progressFunction = [=](size_t bytesWritten, size_t totalBytes) {
+            return static_cast<bool>(progress(bytesWritten, totalBytes));
+        };
+    }
+
+    NSError *copyError;
+    try {
+        if (_snapshot->write_copy(path.UTF8String, static_cast<const char *>(key.bytes), progressFunction)) {
+            return YES;
+        }
+        copyError = [NSError errorWithDomain:RLMErrorDomain
+                                        code:RLMErrorCancelled
+                                    userInfo:@{NSLocalizedDescriptionKey: @"Writing the copy was cancelled",
+                                               @"Error Code": @(RLMErrorCancelled)}];
+    }
+    catch (File::PermissionDenied &ex) {
+        copyError = RLMMakeError(RLMErrorFilePermissionDenied, ex);
+    }
+    catch (File::Exists &ex) {
+        copyError = RLMMakeError(RLMErrorFileExists, ex);
+    }
+    catch (File::NotFound &ex) {
+        copyError = RLMMakeError(RLMErrorFileNotFound, ex);
+    }
+    catch (File::AccessError &ex) {
+        copyError = RLMMakeError(RLMErrorFileAccess, ex);
+    }
+    catch (std::exception &ex) {
+        copyError = RLMMakeError(RLMErrorFail, ex);
+    }
+
+    if (error) {
+        *error = copyError;
+    }
+    return NO;
+}
+
+@end
@@ -0,0 +1,91 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#import <Foundation/Foundation.h>
+#import <Realm/RLMDefines.h>
+
+RLM_ASSUME_NONNULL_BEGIN
+
+/**
+ An RLMThreadSafeReference refers to a persisted `RLMObject`, `RLMResults` or
+ `RLMArray` in a way which can be passed to another thread, and then resolved
+ there with `-[RLMRealm resolveThreadSafeReference:]` on that thread's Realm
+ for the same file.
+
+     RLMThreadSafeReference *ref = [RLMThreadSafeReference referenceWithThreadConfined:person];
+     dispatch_async(queue, ^{
+         Person *person = [[RLMRealm defaultRealm] resolveThreadSafeReference:ref];
+     });
+
+ Resolving a reference doesn't look the object up by its primary key or rerun
+ the query: the same object is found directly, so objects without a primary key
+ can be passed between threads too. If the resolving Realm is at an older
+ version than the one the reference was created at, it is first refreshed to
+ that version. If it is at a newer version, the object found is the same one
+ the reference was created for, wherever it now is, or `nil` if it has since
+ been deleted.
+
+ The version of the data the reference was created at is kept alive, and so the
+ file can't reuse the space used by it, until the reference is resolved or
+ deallocated. Each reference can only be resolved once.
+ */
+@interface RLMThreadSafeReference : NSObject
+
+/**
+ Create a reference to a persisted object, results or array.
+
+ This must be called on the thread of the Realm the object belongs to, and not
+ within a write transaction.
+
+ @param threadConfined An `RLMObject`, `RLMResults` or `RLMArray` which
+                       belongs to a Realm.
+
+ @return A reference which can be resolved on any thread.
+ */
++ (instancetype)referenceWithThreadConfined:(id)threadConfined;
+
+/**
+ The version of the data which the reference was created at.
+ */
+@property (nonatomic, readonly) uint64_t version;
+
+/**
+ Whether the reference has been resolved, after which it can't be resolved
+ again.
+ */
+@property (nonatomic, readonly, getter=isResolved) BOOL resolved;
+
+#pragma mark - Unavailable Methods
+
+/**
+ -[RLMThreadSafeReference init] is not available because an
+ RLMThreadSafeReference must be created with
+ +[RLMThreadSafeReference referenceWithThreadConfined:].
+ */
+- (instancetype)init __attribute__((unavailable("Use +referenceWithThreadConfined:")));
+
+/**
+ +[RLMThreadSafeReference new] is not available because an
+ RLMThreadSafeReference must be created with
+ +[RLMThreadSafeReference referenceWithThreadConfined:].
+ */
++ (instancetype)new __attribute__((unavailable("Use +referenceWithThreadConfined:")));
+
+@end
+
+RLM_ASSUME_NONNULL_END
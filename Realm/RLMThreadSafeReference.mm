@@ -0,0 +1,133 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#import "RLMThreadSafeReference_Private.hpp"
+
+#import "RLMArray_Private.hpp"
+#import "RLMObjectSchema_Private.hpp"
+#import "RLMObjectStore.h"
+#import "RLMObject_Private.hpp"
+#import "RLMRealm_Private.hpp"
+#import "RLMSchema.h"
+#import "RLMUtil.hpp"
+
+#import "thread_safe_reference.hpp"
+
+#import <realm/util/optional.hpp>
+
+@implementation RLMThreadSafeReference {
+    realm::util::Optional<realm::ThreadSafeReference> _reference;
+    NSString *_objectClassName;
+    NSString *_parentClassName;
+    NSString *_key;
+}
+
++ (instancetype)referenceWithThreadConfined:(id)threadConfined {
+    if ([threadConfined isKindOfClass:[RLMObjectBase class]]) {
+        RLMObjectBase *object = threadConfined;
+        if (!object->_realm) {
+            @throw RLMException(@"Cannot create a thread-safe reference to a standalone object.");
+        }
+        RLMVerifyAttached(object);
+        try {
+            return [[self alloc] initWithReference:realm::ThreadSafeReference(object->_realm->_realm, object->_row)
+                                   objectClassName:object->_objectSchema.className];
+        }
+        catch (std::exception const& ex) {
+            @throw RLMException(ex);
+        }
+    }
+    if ([threadConfined isKindOfClass:[RLMArrayLinkView class]] || [threadConfined isKindOfClass:[RLMResults class]]) {
+        return [threadConfined threadSafeReference];
+    }
+    if ([threadConfined isKindOfClass:[RLMArray class]]) {
+        @throw RLMException(@"Cannot create a thread-safe reference to a standalone RLMArray.");
+    }
+    @throw RLMException(@"Cannot create a thread-safe reference to an object of type '%@'.", [threadConfined class]);
+}
+
+- (instancetype)initWithReference:(realm::ThreadSafeReference&&)reference
+                  objectClassName:(NSString *)objectClassName {
+    self = [super init];
+    if (self) {
+        _reference = std::move(reference);
+        _objectClassName = objectClassName;
+    }
+    return self;
+}
+
+- (instancetype)initWithReference:(realm::ThreadSafeReference&&)reference
+                  objectClassName:(NSString *)objectClassName
+                  parentClassName:(NSString *)parentClassName
+                              key:(NSString *)key {
+    self = [self initWithReference:std::move(reference) objectClassName:objectClassName];
+    if (self) {
+        _parentClassName = parentClassName;
+        _key = key;
+    }
+    return self;
+}
+
+- (uint64_t)version {
+    return _reference->version();
+}
+
+- (BOOL)isResolved {
+    return _reference->is_resolved();
+}
+
+- (id)resolveInRealm:(RLMRealm *)realm {
+    [realm verifyThread];
+    RLMObjectSchema *objectSchema = realm.schema[_objectClassName];
+    if (!objectSchema) {
+        @throw RLMException(@"Cannot resolve a thread-safe reference to an object of type '%@' in a Realm which does not contain that type.",
+                            _objectClassName);
+    }
+
+    try {
+        switch (_reference->type()) {
+            case realm::ThreadSafeReference::Type::Row: {
+                realm::Row row = _reference->resolve_row(realm->_realm);
+                if (!row.is_attached()) {
+                    return nil;
+                }
+                return RLMCreateObjectAccessor(realm, objectSchema, row.get_index());
+            }
+            case realm::ThreadSafeReference::Type::LinkList: {
+                realm::LinkViewRef linkView = _reference->resolve_link_list(realm->_realm);
+                if (!linkView) {
+                    return nil;
+                }
+                return [RLMArrayLinkView arrayWithObjectClassName:_objectClassName
+                                                             view:std::move(linkView)
+                                                            realm:realm
+                                                              key:_key
+                                                     parentSchema:realm.schema[_parentClassName]];
+            }
+            case realm::ThreadSafeReference::Type::Results:
+                return [RLMResults resultsWithObjectSchema:objectSchema
+                                                   results:_reference->resolve_results(realm->_realm)];
+        }
+        REALM_UNREACHABLE();
+    }
+    catch (std::exception const& ex) {
+        @throw RLMException(ex);
+    }
+}
+
+@end
@@ -0,0 +1,40 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#import "RLMThreadSafeReference.h"
+
+@class RLMRealm;
+
+namespace realm {
+    class ThreadSafeReference;
+}
+
+@interface RLMThreadSafeReference ()
+// References to objects and results
+- (instancetype)initWithReference:(realm::ThreadSafeReference&&)reference
+                  objectClassName:(NSString *)objectClassName;
+// References to arrays, which also need the property they were read from
+- (instancetype)initWithReference:(realm::ThreadSafeReference&&)reference
+                  objectClassName:(NSString *)objectClassName
+                  parentClassName:(NSString *)parentClassName
+                              key:(NSString *)key;
+
+// Get the referenced object, results or array from the given Realm, or nil if
+// the object was deleted
+- (id)resolveInRealm:(RLMRealm *)realm;
+@end
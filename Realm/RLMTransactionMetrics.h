@@ -0,0 +1,136 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#import <Foundation/Foundation.h>
+#import <Realm/RLMDefines.h>
+
+RLM_ASSUME_NONNULL_BEGIN
+
+/**
+ A histogram of the durations of one kind of transaction operation.
+
+ Durations are counted in buckets whose bounds are powers of two microseconds,
+ so percentiles are accurate to within a factor of two.
+ */
+@interface RLMDurationHistogram : NSObject
+
+/// The number of durations recorded.
+@property (nonatomic, readonly) NSUInteger count;
+
+/// The sum of all of the durations recorded, in seconds.
+@property (nonatomic, readonly) NSTimeInterval totalDuration;
+
+/// The longest duration recorded, in seconds.
+@property (nonatomic, readonly) NSTimeInterval maxDuration;
+
+/**
+ The number of durations in each bucket of the histogram, as `NSNumber`s.
+
+ The first bucket counts durations less than one microsecond, and bucket `i`
+ counts durations of at least 2^(i-1) and less than 2^i microseconds. The last
+ bucket also counts everything longer.
+ */
+@property (nonatomic, readonly) NSArray *bucketCounts;
+
+/**
+ Get an upper bound for a percentile of the recorded durations.
+
+ @param percentile  The percentile, from 0 to 100.
+
+ @return The duration in seconds, or 0 if nothing has been recorded.
+ */
+- (NSTimeInterval)durationAtPercentile:(double)percentile;
+
+@end
+
+/**
+ A snapshot of the timings of the transactions performed by an `RLMRealm`, and
+ counts of the work done for it, for diagnosing slow commits and attributing
+ time spent in Realm.
+
+ @see -[RLMRealm transactionMetrics]
+ */
+@interface RLMTransactionMetrics : NSObject
+
+/// Beginning write transactions when the Realm was already up to date, which
+/// is the time spent waiting for the write lock.
+@property (nonatomic, readonly) RLMDurationHistogram *lockWait;
+
+/// Beginning write transactions which also had to advance the Realm to a
+/// version committed by another thread or process after acquiring the lock.
+@property (nonatomic, readonly) RLMDurationHistogram *lockWaitAndAdvance;
+
+/// Committing write transactions, including writing to disk.
+@property (nonatomic, readonly) RLMDurationHistogram *commit;
+
+/// Advancing the Realm to the latest version when refreshing, including
+/// processing the changes made and sending notifications.
+@property (nonatomic, readonly) RLMDurationHistogram *advance;
+
+/// From a commit made by another `RLMRealm` instance in this process to this
+/// Realm starting to handle the notification of it. Commits made by other
+/// processes are not included.
+@property (nonatomic, readonly) RLMDurationHistogram *notify;
+
+/// Delivering the change notifications when advancing the Realm, which is
+/// included in `advance`.
+@property (nonatomic, readonly) RLMDurationHistogram *didChange;
+
+/// Running the queries for `RLMResults`, both when they are first accessed and
+/// when they are rerun after the objects they depend on have changed.
+@property (nonatomic, readonly) RLMDurationHistogram *resultsEvaluation;
+
+/// The number of write transactions which were cancelled.
+@property (nonatomic, readonly) NSUInteger cancelledTransactions;
+
+/// The total size in bytes of the transaction logs written by commits.
+@property (nonatomic, readonly) unsigned long long bytesCommitted;
+
+/// The number of versions which the Realm has advanced over, whether by
+/// refreshing or by beginning write transactions.
+@property (nonatomic, readonly) NSUInteger versionsAdvanced;
+
+/// The number of those versions whose changes had to be read to update
+/// observed objects or compute change notifications.
+@property (nonatomic, readonly) NSUInteger versionsParsed;
+
+/// The total number of observed objects which were updated when advancing.
+@property (nonatomic, readonly) NSUInteger observersNotified;
+
+/// The number of `RLMObject` accessors created for objects in this Realm.
+@property (nonatomic, readonly) NSUInteger accessorsCreated;
+
+/// The number of notifications of commits which advanced the Realm or
+/// reported that changes were available.
+@property (nonatomic, readonly) NSUInteger notificationsDelivered;
+
+/// The number of notifications of commits which found nothing new, because an
+/// earlier notification or refresh had already advanced over the commit.
+@property (nonatomic, readonly) NSUInteger notificationsCoalesced;
+
+/// The number of times opening this immutable encrypted Realm decrypted the
+/// file into memory, and the number of times it reused a copy decrypted for
+/// another `RLMRealm`.
+///
+/// @see -[RLMRealmConfiguration maximumDecryptedCacheSize]
+@property (nonatomic, readonly) NSUInteger filesDecrypted;
+@property (nonatomic, readonly) NSUInteger decryptedCacheHits;
+
+@end
+
+RLM_ASSUME_NONNULL_END
@@ -0,0 +1,104 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2015 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#import "RLMTransactionMetrics_Private.hpp"
+
+static NSTimeInterval RLMToTimeInterval(std::chrono::nanoseconds duration) {
+    return duration.count() / 1e9;
+}
+
+@implementation RLMDurationHistogram {
+    realm::DurationHistogram _histogram;
+}
+
+- (instancetype)initWithHistogram:(realm::DurationHistogram const&)histogram {
+    self = [super init];
+    if (self) {
+        _histogram = histogram;
+    }
+    return self;
+}
+
+- (NSUInteger)count {
+    return static_cast<NSUInteger>(_histogram.count());
+}
+
+- (NSTimeInterval)totalDuration {
+    return RLMToTimeInterval(_histogram.total());
+}
+
+- (NSTimeInterval)maxDuration {
+    return RLMToTimeInterval(_histogram.max());
+}
+
+- (NSArray *)bucketCounts {
+    NSMutableArray *counts = [NSMutableArray arrayWithCapacity:realm::DurationHistogram::bucket_count];
+    for (size_t i = 0; i < realm::DurationHistogram::bucket_count; ++i) {
+        [counts addObject:@(_histogram.bucket(i))];
+    }
+    return counts;
+}
+
+- (NSTimeInterval)durationAtPercentile:(double)percentile {
+    return RLMToTimeInterval(_histogram.percentile(percentile));
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@: count = %lu, p50 = %gs, p99 = %gs, max = %gs>",
+            self.class, (unsigned long)self.count, [self durationAtPercentile:50],
+            [self durationAtPercentile:99], self.maxDuration];
+}
+
+@end
+
+@implementation RLMTransactionMetrics
+
+- (instancetype)initWithMetrics:(realm::TransactionMetrics const&)metrics {
+    self = [super init];
+    if (self) {
+        _lockWait = [[RLMDurationHistogram alloc] initWithHistogram:metrics.lock_wait];
+        _lockWaitAndAdvance = [[RLMDurationHistogram alloc] initWithHistogram:metrics.lock_wait_and_advance];
+        _commit = [[RLMDurationHistogram alloc] initWithHistogram:metrics.commit];
+        _advance = [[RLMDurationHistogram alloc] initWithHistogram:metrics.advance];
+        _notify = [[RLMDurationHistogram alloc] initWithHistogram:metrics.notify];
+        _didChange = [[RLMDurationHistogram alloc] initWithHistogram:metrics.did_change];
+        _resultsEvaluation = [[RLMDurationHistogram alloc] initWithHistogram:metrics.results_evaluation];
+        _cancelledTransactions = static_cast<NSUInteger>(metrics.cancelled_transactions);
+        _bytesCommitted = metrics.bytes_committed;
+        _versionsAdvanced = static_cast<NSUInteger>(metrics.versions_advanced);
+        _versionsParsed = static_cast<NSUInteger>(metrics.versions_parsed);
+        _observersNotified = static_cast<NSUInteger>(metrics.observers_notified);
+        _accessorsCreated = static_cast<NSUInteger>(metrics.accessors_created);
+        _notificationsDelivered = static_cast<NSUInteger>(metrics.notifications_delivered);
+        _notificationsCoalesced = static_cast<NSUInteger>(metrics.notifications_coalesced);
+        _filesDecrypted = static_cast<NSUInteger>(metrics.files_decrypted);
+        _decryptedCacheHits = static_cast<NSUInteger>(metrics.decrypted_cache_hits);
+    }
+    return self;
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"%@ {\n\tlockWait = %@;\n\tlockWaitAndAdvance = %@;\n\tcommit = %@;\n\tadvance = %@;\n\tnotify = %@;\n\tdidChange = %@;\n\tresultsEvaluation = %@;\n\tcancelledTransactions = %lu;\n\tbytesCommitted = %llu;\n\tversionsAdvanced = %lu;\n\tversionsParsed = %lu;\n\tobserversNotified = %lu;\n\taccessorsCreated = %lu;\n\tnotificationsDelivered = %lu;\n\tnotificationsCoalesced = %lu;\n\tfilesDecrypted = %lu;\n\tdecryptedCacheHits = %lu;\n}",
+            self.class, _lockWait, _lockWaitAndAdvance, _commit, _advance, _notify, _didChange, _resultsEvaluation,
+            (unsigned long)_cancelledTransactions, _bytesCommitted, (unsigned long)_versionsAdvanced,
+            (unsigned long)_versionsParsed, (unsigned long)_observersNotified, (unsigned long)_accessorsCreated,
+            (unsigned long)_notificationsDelivered, (unsigned long)_notificationsCoalesced,
+            (unsigned long)_filesDecrypted, (unsigned long)_decryptedCacheHits];
+}
+
+@end
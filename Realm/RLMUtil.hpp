@@ -28,8 +28,10 @@
 
 namespace realm {
     class Mixed;
+    class Table;
 }
 
+@class RLMObjectBase;
 @class RLMObjectSchema;
 @class RLMProperty;
 @protocol RLMFastEnumerable;
@@ -59,8 +61,20 @@ NSDictionary *RLMDefaultValuesForObjectSchema(RLMObjectSchema *objectSchema);
 
 NSArray *RLMCollectionValueForKey(id<RLMFastEnumerable> collection, NSString *key);
 
+// Read or write the value of an Int, Bool, Float, Double, String, Data or Date
+// property for a row directly in the table, boxed the same way as the
+// property's getter. The value written must be valid for the property.
+id RLMGetTableValue(realm::Table& table, RLMProperty *prop, size_t row);
+void RLMSetTableValue(realm::Table& table, RLMProperty *prop, size_t row, id value);
+
 void RLMCollectionSetValueForKey(id<RLMFastEnumerable> collection, NSString *key, id value);
 
+// Read the values of the given keys for an object or each object of a
+// collection into dictionaries, with nil values as NSNull, reading properties
+// which don't need an accessor object directly from the table
+NSDictionary *RLMObjectDictionaryWithValuesForKeys(RLMObjectBase *object, NSArray *keys);
+NSArray *RLMCollectionDictionariesWithValuesForKeys(id<RLMFastEnumerable> collection, NSArray *keys);
+
 BOOL RLMIsDebuggerAttached();
 
 BOOL RLMIsInRunLoop();
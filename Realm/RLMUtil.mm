@@ -32,6 +32,7 @@
 
 #include <sys/sysctl.h>
 #include <sys/types.h>
+#include <vector>
 
 #if !defined(REALM_COCOA_VERSION)
 #import "RLMVersion.h"
@@ -195,6 +196,105 @@ NSDictionary *RLMDefaultValuesForObjectSchema(__unsafe_unretained RLMObjectSchem
     return defaults;
 }
 
+id RLMGetTableValue(realm::Table& table, __unsafe_unretained RLMProperty *const prop, size_t row) {
+    size_t col = prop.column;
+    if (prop.optional && table.is_null(col, row)) {
+        return nil;
+    }
+    switch (prop.type) {
+        case RLMPropertyTypeInt: {
+            int64_t value = table.get_int(col, row);
+            switch (prop.objcType) {
+                case 'c': return @((char)value);
+                case 's': return @((short)value);
+                case 'i': return @((int)value);
+                case 'l': return @((long)value);
+                default:  return @(value);
+            }
+        }
+        case RLMPropertyTypeBool:   return @(table.get_bool(col, row));
+        case RLMPropertyTypeFloat:  return @(table.get_float(col, row));
+        case RLMPropertyTypeDouble: return @(table.get_double(col, row));
+        case RLMPropertyTypeString: return RLMStringDataToNSString(table.get_string(col, row));
+        case RLMPropertyTypeData:   return RLMBinaryDataToNSData(table.get_binary(col, row));
+        case RLMPropertyTypeDate:
+            if (table.is_null(col, row)) {
+                return nil;
+            }
+            return RLMDateTimeToNSDate(table.get_datetime(col, row));
+        default:
+            REALM_UNREACHABLE();
+    }
+}
+
+void RLMSetTableValue(realm::Table& table, __unsafe_unretained RLMProperty *const prop, size_t row,
+                      __unsafe_unretained id const value) {
+    size_t col = prop.column;
+    if (!value || value == NSNull.null) {
+        table.set_null(col, row);
+        return;
+    }
+    switch (prop.type) {
+        case RLMPropertyTypeInt:    table.set_int(col, row, [value longLongValue]); break;
+        case RLMPropertyTypeBool:   table.set_bool(col, row, [value boolValue]); break;
+        case RLMPropertyTypeFloat:  table.set_float(col, row, [value floatValue]); break;
+        case RLMPropertyTypeDouble: table.set_double(col, row, [value doubleValue]); break;
+        case RLMPropertyTypeString: table.set_string(col, row, RLMStringDataWithNSString(value)); break;
+        case RLMPropertyTypeData:   table.set_binary(col, row, RLMBinaryDataForNSData(value)); break;
+        case RLMPropertyTypeDate:   table.set_datetime(col, row, RLMDateTimeForNSDate(value)); break;
+        default:
+            REALM_UNREACHABLE();
+    }
+}
+
+// Read the value of a property for each row of a collection directly from
+// the table, boxed the same way as the property's getter would
+template<typename Func>
+static void RLMForEachColumnValue(__unsafe_unretained RLMProperty *const prop,
+                                  __unsafe_unretained id<RLMFastEnumerable> const collection,
+                                  Func&& func) {
+    realm::Table& table = *collection.objectSchema.table;
+
+    auto read = [&](size_t row) -> id {
+        if (row == realm::npos) {
+            @throw RLMException(@"Object has been deleted or invalidated.");
+        }
+        return RLMGetTableValue(table, prop, row);
+    };
+
+    size_t rows[256];
+    for (NSUInteger start = 0; ; ) {
+        NSUInteger count = [collection copySourceIndexes:rows from:start count:sizeof(rows) / sizeof(rows[0])];
+        if (count == 0) {
+            break;
+        }
+        for (NSUInteger i = 0; i < count; ++i) {
+            func(read(rows[i]));
+        }
+        start += count;
+    }
+}
+
+// Whether the values of a property can be read directly from the table
+// without going through an accessor object
+static bool RLMCanReadColumnDirectly(__unsafe_unretained RLMProperty *const prop) {
+    if (!prop || prop.swiftIvar) {
+        return false;
+    }
+    switch (prop.type) {
+        case RLMPropertyTypeInt:
+        case RLMPropertyTypeBool:
+        case RLMPropertyTypeFloat:
+        case RLMPropertyTypeDouble:
+        case RLMPropertyTypeString:
+        case RLMPropertyTypeData:
+        case RLMPropertyTypeDate:
+            return true;
+        default:
+            return false;
+    }
+}
+
 NSArray *RLMCollectionValueForKey(id<RLMFastEnumerable> collection, NSString *key) {
     size_t count = collection.count;
     if (count == 0) {
@@ -205,6 +305,14 @@ NSArray *RLMCollectionValueForKey(id<RLMFastEnumerable> collection, NSString *ke
     RLMObjectSchema *objectSchema = collection.objectSchema;
 
     NSMutableArray *results = [NSMutableArray arrayWithCapacity:count];
+    RLMProperty *prop = objectSchema[key];
+    if (RLMCanReadColumnDirectly(prop)) {
+        RLMForEachColumnValue(prop, collection, [&](__unsafe_unretained id const value) {
+            [results addObject:value ?: NSNull.null];
+        });
+        return results;
+    }
+
     if ([key isEqualToString:@"self"]) {
         for (size_t i = 0; i < count; i++) {
             size_t rowIndex = [collection indexInSource:i];
@@ -225,6 +333,84 @@ NSArray *RLMCollectionValueForKey(id<RLMFastEnumerable> collection, NSString *ke
     return results;
 }
 
+namespace {
+// Reads the values of a fixed set of keys for rows of a table into
+// dictionaries, reading each property which can be read directly from the
+// table without an accessor object and only using KVC for the others
+class RLMRowValuesReader {
+public:
+    RLMRowValuesReader(RLMRealm *realm, RLMObjectSchema *objectSchema, NSArray *keys)
+    : _realm(realm), _objectSchema(objectSchema), _table(*objectSchema.table)
+    , _count(keys.count), _keys(_count), _properties(_count), _values(_count)
+    {
+        [keys getObjects:_keys.data() range:NSMakeRange(0, _count)];
+        for (NSUInteger i = 0; i < _count; ++i) {
+            RLMProperty *prop = objectSchema[_keys[i]];
+            _properties[i] = RLMCanReadColumnDirectly(prop) ? prop : nil;
+            _needsAccessor = _needsAccessor || !_properties[i];
+        }
+    }
+
+    NSDictionary *read(size_t row) {
+        if (row == realm::npos) {
+            @throw RLMException(@"Object has been deleted or invalidated.");
+        }
+        if (_needsAccessor && !_accessor) {
+            _accessor = [[_objectSchema.accessorClass alloc] initWithRealm:_realm schema:_objectSchema];
+        }
+        if (_accessor) {
+            _accessor->_row = _table[row];
+            RLMInitializeSwiftAccessorGenerics(_accessor);
+        }
+
+        for (NSUInteger i = 0; i < _count; ++i) {
+            id value = _properties[i] ? RLMGetTableValue(_table, _properties[i], row) : [_accessor valueForKey:_keys[i]];
+            _values[i] = value ?: NSNull.null;
+        }
+        return [NSDictionary dictionaryWithObjects:_values.data() forKeys:_keys.data() count:_count];
+    }
+
+private:
+    RLMRealm *_realm;
+    RLMObjectSchema *_objectSchema;
+    realm::Table& _table;
+    NSUInteger _count;
+    std::vector<__unsafe_unretained NSString *> _keys;
+    std::vector<__unsafe_unretained RLMProperty *> _properties;
+    std::vector<id> _values;
+    bool _needsAccessor = false;
+    RLMObjectBase *_accessor;
+};
+}
+
+NSDictionary *RLMObjectDictionaryWithValuesForKeys(RLMObjectBase *object, NSArray *keys) {
+    return RLMRowValuesReader(object->_realm, object->_objectSchema, keys).read(object->_row.get_index());
+}
+
+NSArray *RLMCollectionDictionariesWithValuesForKeys(id<RLMFastEnumerable> collection, NSArray *keys) {
+    NSUInteger total = collection.count;
+    if (total == 0) {
+        return @[];
+    }
+
+    NSMutableArray *results = [NSMutableArray arrayWithCapacity:total];
+    RLMRowValuesReader reader(collection.realm, collection.objectSchema, keys);
+    size_t rows[256];
+    for (NSUInteger start = 0; ; ) {
+        NSUInteger count = [collection copySourceIndexes:rows from:start count:sizeof(rows) / sizeof(rows[0])];
+        if (count == 0) {
+            break;
+        }
+        for (NSUInteger i = 0; i < count; ++i) {
+            @autoreleasepool {
+                [results addObject:reader.read(rows[i])];
+            }
+        }
+        start += count;
+    }
+    return results;
+}
+
 void RLMCollectionSetValueForKey(id<RLMFastEnumerable> collection, NSString *key, id value) {
     realm::TableView tv = [collection tableView];
     if (tv.size() == 0) {
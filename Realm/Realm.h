@@ -18,13 +18,20 @@
 
 #import <Foundation/Foundation.h>
 
+#import <Realm/RLMAggregateView.h>
 #import <Realm/RLMArray.h>
+#import <Realm/RLMChangeFeed.h>
 #import <Realm/RLMMigration.h>
 #import <Realm/RLMObject.h>
 #import <Realm/RLMObjectSchema.h>
 #import <Realm/RLMPlatform.h>
+#import <Realm/RLMPreparedQuery.h>
 #import <Realm/RLMProperty.h>
 #import <Realm/RLMRealm.h>
 #import <Realm/RLMRealmConfiguration.h>
 #import <Realm/RLMResults.h>
+#import <Realm/RLMRowCursor.h>
 #import <Realm/RLMSchema.h>
+#import <Realm/RLMSnapshot.h>
+#import <Realm/RLMThreadSafeReference.h>
+#import <Realm/RLMTransactionMetrics.h>
@@ -448,6 +448,112 @@
     XCTAssertThrows([company.employees indexOfObject:(EmployeeObject *)company]);
 }
 
+- (void)testIndexOfObjectInLargeArray
+{
+    RLMRealm *realm = [RLMRealm defaultRealm];
+
+    [realm beginWriteTransaction];
+    CompanyObject *company = [CompanyObject createInRealm:realm withValue:@[@"name", @[]]];
+    for (int i = 0; i < 200; ++i) {
+        [company.employees addObject:[EmployeeObject createInRealm:realm withValue:@[@"name", @(i), @YES]]];
+    }
+    EmployeeObject *notInArray = [EmployeeObject createInRealm:realm withValue:@[@"other", @0, @NO]];
+    [company.employees addObject:company.employees[10]];
+    [realm commitWriteTransaction];
+
+    RLMArray *employees = company.employees;
+    for (NSUInteger i = 0; i < 200; ++i) {
+        XCTAssertEqual(i, [employees indexOfObject:employees[i]]);
+    }
+    XCTAssertEqual(10U, [employees indexOfObject:employees[200]]);
+    XCTAssertEqual((NSUInteger)NSNotFound, [employees indexOfObject:notInArray]);
+
+    // lookups after the array is modified see the new positions
+    [realm beginWriteTransaction];
+    EmployeeObject *first = employees[0];
+    [employees removeObjectAtIndex:0];
+    [employees addObject:notInArray];
+    XCTAssertEqual(200U, [employees indexOfObject:notInArray]);
+    [realm commitWriteTransaction];
+
+    XCTAssertEqual((NSUInteger)NSNotFound, [employees indexOfObject:first]);
+    XCTAssertEqual(9U, [employees indexOfObject:employees[9]]);
+    XCTAssertEqual(200U, [employees indexOfObject:notInArray]);
+}
+
+- (void)testBatchInsertionAndRemoval
+{
+    RLMRealm *realm = [RLMRealm defaultRealm];
+
+    [realm beginWriteTransaction];
+    CompanyObject *company = [CompanyObject createInRealm:realm withValue:@[@"name", @[]]];
+    EmployeeObject *persisted = [EmployeeObject createInRealm:realm withValue:@[@"persisted", @1, @YES]];
+    EmployeeObject *standalone = [[EmployeeObject alloc] initWithValue:@[@"standalone", @2, @NO]];
+
+    [company.employees addObjects:@[persisted, standalone, persisted]];
+    XCTAssertEqual(3U, company.employees.count);
+    XCTAssertEqual(realm, standalone.realm);
+    XCTAssertEqual(2U, [EmployeeObject allObjectsInRealm:realm].count);
+
+    NSMutableIndexSet *indexes = [NSMutableIndexSet indexSetWithIndex:0];
+    [indexes addIndex:4];
+    [company.employees insertObjects:@[standalone, persisted] atIndexes:indexes];
+    XCTAssertEqualObjects([company.employees valueForKey:@"name"],
+                          (@[@"standalone", @"persisted", @"standalone", @"persisted", @"persisted"]));
+
+    // invalid arguments leave the array unchanged
+    [indexes addIndex:10];
+    XCTAssertThrows([company.employees insertObjects:@[standalone, persisted, persisted] atIndexes:indexes]);
+    XCTAssertThrows([company.employees insertObjects:@[standalone, persisted] atIndexes:[NSIndexSet indexSetWithIndex:0]]);
+    XCTAssertThrows([company.employees addObjects:@[persisted, company]]);
+    XCTAssertThrows([company.employees removeObjectsAtIndexes:indexes]);
+    XCTAssertEqual(5U, company.employees.count);
+
+    [indexes removeIndex:10];
+    [company.employees removeObjectsAtIndexes:indexes];
+    XCTAssertEqualObjects([company.employees valueForKey:@"name"], (@[@"persisted", @"standalone", @"persisted"]));
+    [company.employees removeObjectsAtIndexes:[NSIndexSet indexSetWithIndexesInRange:NSMakeRange(0, 3)]];
+    XCTAssertEqual(0U, company.employees.count);
+    [realm commitWriteTransaction];
+}
+
+- (void)testSortedAndFilteredViewsAreShared
+{
+    RLMRealm *realm = [RLMRealm defaultRealm];
+
+    [realm beginWriteTransaction];
+    CompanyObject *company = [CompanyObject createInRealm:realm withValue:@[@"name", @[@[@"Joe", @40, @YES],
+                                                                                   @[@"John", @30, @NO],
+                                                                                   @[@"Jill", @25, @YES]]]];
+    CompanyObject *other = [CompanyObject createInRealm:realm withValue:@[@"other", @[@[@"Bill", @50, @YES]]]];
+    [realm commitWriteTransaction];
+
+    RLMResults *sorted = [company.employees sortedResultsUsingProperty:@"age" ascending:YES];
+    XCTAssertEqual(sorted, [company.employees sortedResultsUsingProperty:@"age" ascending:YES]);
+    XCTAssertNotEqual(sorted, [company.employees sortedResultsUsingProperty:@"age" ascending:NO]);
+    XCTAssertNotEqual(sorted, [other.employees sortedResultsUsingProperty:@"age" ascending:YES]);
+    XCTAssertEqualObjects([sorted valueForKey:@"name"], (@[@"Jill", @"John", @"Joe"]));
+
+    RLMResults *hired = [company.employees objectsWhere:@"hired = YES"];
+    XCTAssertEqual(hired, [company.employees objectsWhere:@"hired = YES"]);
+    XCTAssertEqual(2U, hired.count);
+
+    // changes to the list and to rows in it are reflected, and changes to
+    // rows which aren't in it don't affect it
+    [realm beginWriteTransaction];
+    [company.employees addObject:[EmployeeObject createInRealm:realm withValue:@[@"Jane", @20, @YES]]];
+    [realm commitWriteTransaction];
+    XCTAssertEqualObjects([sorted valueForKey:@"name"], (@[@"Jane", @"Jill", @"John", @"Joe"]));
+    XCTAssertEqual(3U, hired.count);
+
+    [realm beginWriteTransaction];
+    [company.employees[0] setHired:NO];
+    [other.employees[0] setAge:10];
+    [realm commitWriteTransaction];
+    XCTAssertEqual(2U, hired.count);
+    XCTAssertEqualObjects([sorted valueForKey:@"name"], (@[@"Jane", @"Jill", @"John", @"Joe"]));
+}
+
 - (void)testIndexOfObjectWhere
 {
     RLMRealm *realm = [RLMRealm defaultRealm];
@@ -477,6 +583,34 @@
     XCTAssertEqual((NSUInteger)NSNotFound, [company.employees indexOfObjectWhere:@"name = 'John'"]);
 }
 
+- (void)testIndexOfObjectWhereOnStandaloneArrayMatchesNSPredicate
+{
+    RLMArray *array = [[RLMArray alloc] initWithObjectClassName:EmployeeObject.className];
+    NSMutableArray *objects = [NSMutableArray new];
+    for (NSArray *values in @[@[@"Joe", @40, @YES], @[@"jöhn", @30, @NO], @[@"Jill", @25, @YES], @[@"Bob", @30, @YES]]) {
+        EmployeeObject *employee = [[EmployeeObject alloc] initWithValue:values];
+        [array addObject:employee];
+        [objects addObject:employee];
+    }
+
+    for (NSString *format in @[@"name = 'Jill'", @"name != 'Joe'", @"name ==[c] 'JILL'", @"name BEGINSWITH 'J'",
+                               @"name ENDSWITH[c] 'OB'", @"name CONTAINS[cd] 'OH'", @"name CONTAINS 'x'",
+                               @"age > 30", @"age <= 25", @"30 < age", @"age < 31 AND hired = YES",
+                               @"hired = NO OR age = 25", @"NOT (hired = YES)", @"name = 'Bob' AND TRUEPREDICATE",
+                               @"name LIKE 'J*'"]) {
+        NSPredicate *predicate = [NSPredicate predicateWithFormat:format];
+        NSUInteger expected = [objects indexOfObjectPassingTest:^BOOL(id obj, NSUInteger, BOOL *) {
+            return [predicate evaluateWithObject:obj];
+        }];
+        XCTAssertEqual(expected, [array indexOfObjectWithPredicate:predicate], @"%@", format);
+        // evaluated again with the compiled predicate
+        XCTAssertEqual(expected, [array indexOfObjectWhere:format], @"%@", format);
+    }
+
+    RLMAssertThrowsWithReasonMatching([array indexOfObjectWhere:@"nonexistent = 1"], @"Property 'nonexistent' not found");
+    RLMAssertThrowsWithReasonMatching([array indexOfObjectWhere:@"age = 'a'"], @"Expected object of type int");
+}
+
 - (void)testFastEnumeration
 {
     RLMRealm *realm = self.realmWithTestPath;
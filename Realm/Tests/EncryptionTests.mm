@@ -107,6 +107,54 @@
     XCTAssertThrows([self realmWithKey:RLMGenerateKey()]);
 }
 
+#pragma mark - Decrypted cache
+
+- (void)testImmutableFileWithDecryptedCache {
+    NSData *key = RLMGenerateKey();
+    @autoreleasepool {
+        RLMRealm *realm = [self realmWithKey:key];
+        [realm transactionWithBlock:^{
+            for (int i = 0; i < 10; ++i) {
+                [IntObject createInRealm:realm withValue:@[@(i)]];
+            }
+        }];
+    }
+
+    RLMRealmConfiguration *configuration = [self configurationWithKey:key];
+    configuration.immutable = YES;
+    configuration.maximumDecryptedCacheSize = 100 * 1024 * 1024;
+    @autoreleasepool {
+        RLMRealm *realm = [RLMRealm realmWithConfiguration:configuration error:nil];
+        XCTAssertEqual(10U, [IntObject allObjectsInRealm:realm].count);
+        XCTAssertEqual(5U, [IntObject objectsInRealm:realm where:@"intCol >= 5"].count);
+        XCTAssertEqual(1U, realm.transactionMetrics.filesDecrypted);
+        XCTAssertEqual(0U, realm.transactionMetrics.decryptedCacheHits);
+
+        // Realms on other threads read from the same decrypted copy
+        [self dispatchAsyncAndWait:^{
+            RLMRealm *realm = [RLMRealm realmWithConfiguration:configuration error:nil];
+            XCTAssertEqual(10U, [IntObject allObjectsInRealm:realm].count);
+            XCTAssertEqual(0U, realm.transactionMetrics.filesDecrypted);
+            XCTAssertEqual(1U, realm.transactionMetrics.decryptedCacheHits);
+        }];
+    }
+
+    // Files larger than the limit are read from the file as usual
+    configuration.maximumDecryptedCacheSize = 1;
+    @autoreleasepool {
+        RLMRealm *realm = [RLMRealm realmWithConfiguration:configuration error:nil];
+        XCTAssertEqual(10U, [IntObject allObjectsInRealm:realm].count);
+        XCTAssertEqual(0U, realm.transactionMetrics.filesDecrypted);
+        XCTAssertEqual(0U, realm.transactionMetrics.decryptedCacheHits);
+    }
+
+    configuration.maximumDecryptedCacheSize = 100 * 1024 * 1024;
+    configuration.encryptionKey = RLMGenerateKey();
+    @autoreleasepool {
+        XCTAssertThrows([RLMRealm realmWithConfiguration:configuration error:nil]);
+    }
+}
+
 #pragma mark - writeCopyToPath:
 
 - (void)testWriteCopyToPathWithNoKeyWritesDecrypted {
@@ -145,6 +193,29 @@
     }
 }
 
+- (void)testSnapshotWriteCopyWithNewKey {
+    NSData *key1 = RLMGenerateKey();
+    NSData *key2 = RLMGenerateKey();
+
+    @autoreleasepool {
+        RLMRealm *realm = [self realmWithKey:key1];
+        [realm transactionWithBlock:^{
+            [IntObject createInRealm:realm withValue:@[@1]];
+        }];
+        RLMSnapshot *snapshot = [realm snapshot];
+        [self dispatchAsyncAndWait:^{
+            XCTAssertTrue([snapshot writeCopyToPath:RLMTestRealmPath() encryptionKey:key2 progress:nil error:nil]);
+        }];
+    }
+
+    @autoreleasepool {
+        RLMRealmConfiguration *config = [self configurationWithKey:key2];
+        config.path = RLMTestRealmPath();
+        RLMRealm *realm = [RLMRealm realmWithConfiguration:config error:nil];
+        XCTAssertEqual(1U, [IntObject allObjectsInRealm:realm].count);
+    }
+}
+
 #pragma mark - Migrations
 
 - (void)createRealmRequiringMigrationWithKey:(NSData *)key migrationRun:(BOOL *)migrationRun {
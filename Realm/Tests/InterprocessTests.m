@@ -20,6 +20,8 @@
 
 #import "RLMConstants.h"
 
+#import <mach/mach_time.h>
+
 @interface InterprocessTest : RLMMultiProcessTestCase
 @end
 
@@ -303,4 +305,158 @@
     }
 }
 
+#if !DEBUG
+#pragma mark - Benchmarks
+
+// Nanoseconds on a clock which is shared by every process
+static double RLMBenchmarkNow() {
+    static mach_timebase_info_data_t timebase;
+    static dispatch_once_t once;
+    dispatch_once(&once, ^{ mach_timebase_info(&timebase); });
+    return (double)mach_absolute_time() * timebase.numer / timebase.denom;
+}
+
+static double RLMPercentile(NSArray *sorted, double percentile) {
+    NSUInteger index = MIN(sorted.count - 1, (NSUInteger)(percentile * (sorted.count - 1) + 0.5));
+    return [sorted[index] doubleValue];
+}
+
+// Runs `writers` processes which each make `commits` write transactions while
+// `readers` processes wait for the change notification for each of them. Each
+// commit stores the time it was made so that the readers can measure how long
+// after it they were notified. The results are printed as a single line of
+// JSON prefixed with "RLMBenchmark".
+- (void)runWriteNotifyBenchmarkWithWriters:(NSUInteger)writers readers:(NSUInteger)readers commits:(NSUInteger)commits {
+    NSDictionary *environment = NSProcessInfo.processInfo.environment;
+    RLMRealm *realm = RLMRealm.defaultRealm;
+
+    if (self.isParent) {
+        NSString *outputDirectory = [NSTemporaryDirectory() stringByAppendingPathComponent:NSUUID.UUID.UUIDString];
+        [NSFileManager.defaultManager createDirectoryAtPath:outputDirectory withIntermediateDirectories:YES attributes:nil error:nil];
+        NSString *(^outputPath)(NSString *, NSUInteger) = ^(NSString *role, NSUInteger index) {
+            return [outputDirectory stringByAppendingPathComponent:[NSString stringWithFormat:@"%@-%lu.plist", role, (unsigned long)index]];
+        };
+        void (^launch)(dispatch_queue_t, NSString *, NSUInteger) = ^(dispatch_queue_t queue, NSString *role, NSUInteger index) {
+            NSDictionary *childEnvironment = @{@"RLMBenchmarkRole": role,
+                                               @"RLMBenchmarkOutput": outputPath(role, index)};
+            dispatch_async(queue, ^{
+                XCTAssertEqual(0, [self runChildAndWaitWithEnvironment:childEnvironment]);
+            });
+        };
+
+        // The readers need to be listening for notifications before any of
+        // the writers start
+        dispatch_queue_t queue = dispatch_queue_create("benchmark", DISPATCH_QUEUE_CONCURRENT);
+        for (NSUInteger i = 0; i < readers; ++i) {
+            launch(queue, @"reader", i);
+        }
+        while ([IntObject objectsInRealm:realm where:@"intCol = 0"].count < readers) {
+            usleep(1000);
+            [realm refresh];
+        }
+        for (NSUInteger i = 0; i < writers; ++i) {
+            launch(queue, @"writer", i);
+        }
+        dispatch_barrier_sync(queue, ^{});
+
+        double start = DBL_MAX, end = 0, lockWait = 0;
+        for (NSUInteger i = 0; i < writers; ++i) {
+            NSDictionary *result = [NSDictionary dictionaryWithContentsOfFile:outputPath(@"writer", i)];
+            start = MIN(start, [result[@"start"] doubleValue]);
+            end = MAX(end, [result[@"end"] doubleValue]);
+            lockWait += [result[@"lockWait"] doubleValue];
+        }
+        NSMutableArray *latencies = [NSMutableArray array];
+        for (NSUInteger i = 0; i < readers; ++i) {
+            [latencies addObjectsFromArray:[NSArray arrayWithContentsOfFile:outputPath(@"reader", i)]];
+        }
+        [NSFileManager.defaultManager removeItemAtPath:outputDirectory error:nil];
+
+        [realm refresh];
+        XCTAssertEqual(writers * commits, [DoubleObject allObjectsInRealm:realm].count);
+        XCTAssertEqual(readers * writers * commits, latencies.count);
+        if (latencies.count == 0 || end <= start) {
+            return;
+        }
+        [latencies sortUsingSelector:@selector(compare:)];
+
+        NSUInteger totalCommits = writers * commits;
+        printf("RLMBenchmark {\"benchmark\": \"%s\", \"writers\": %lu, \"readers\": %lu, \"commits\": %lu, "
+               "\"commits_per_second\": %.1f, \"mean_lock_wait_us\": %.1f, "
+               "\"notify_latency_p50_us\": %.1f, \"notify_latency_p99_us\": %.1f}\n",
+               self.name.UTF8String, (unsigned long)writers, (unsigned long)readers, (unsigned long)totalCommits,
+               totalCommits / ((end - start) / 1e9), lockWait / totalCommits / 1e3,
+               RLMPercentile(latencies, 0.5) / 1e3, RLMPercentile(latencies, 0.99) / 1e3);
+        return;
+    }
+
+    NSString *outputPath = environment[@"RLMBenchmarkOutput"];
+    if ([environment[@"RLMBenchmarkRole"] isEqualToString:@"reader"]) {
+        NSUInteger expected = writers * commits;
+        NSMutableArray *latencies = [NSMutableArray arrayWithCapacity:expected];
+        RLMResults *timestamps = [DoubleObject allObjectsInRealm:realm];
+        __block NSUInteger seen = 0;
+        RLMNotificationToken *token = [realm addNotificationBlock:^(__unused NSString *note, __unused RLMRealm *realm) {
+            double now = RLMBenchmarkNow();
+            NSUInteger count = timestamps.count;
+            for (NSUInteger i = seen; i < count; ++i) {
+                [latencies addObject:@(now - [timestamps[i] doubleCol])];
+            }
+            seen = count;
+            if (seen >= expected) {
+                CFRunLoopStop(CFRunLoopGetCurrent());
+            }
+        }];
+        [realm transactionWithBlock:^{
+            [IntObject createInRealm:realm withValue:@[@0]];
+        }];
+        while (seen < expected) {
+            CFRunLoopRun();
+        }
+        [realm removeNotification:token];
+        [latencies writeToFile:outputPath atomically:YES];
+        return;
+    }
+
+    // Writers wait for each other to start so that they all contend for the
+    // write lock for the whole run
+    [realm transactionWithBlock:^{
+        [IntObject createInRealm:realm withValue:@[@1]];
+    }];
+    while ([IntObject objectsInRealm:realm where:@"intCol = 1"].count < writers) {
+        usleep(100);
+        [realm refresh];
+    }
+
+    double lockWait = 0;
+    double start = RLMBenchmarkNow();
+    for (NSUInteger i = 0; i < commits; ++i) {
+        double beforeBegin = RLMBenchmarkNow();
+        [realm beginWriteTransaction];
+        lockWait += RLMBenchmarkNow() - beforeBegin;
+        [DoubleObject createInRealm:realm withValue:@[@(RLMBenchmarkNow())]];
+        [realm commitWriteTransaction];
+    }
+    double end = RLMBenchmarkNow();
+    [@{@"start": @(start), @"end": @(end), @"lockWait": @(lockWait)} writeToFile:outputPath atomically:YES];
+}
+
+- (void)testWriteNotifyBenchmarkOneWriterOneReader {
+    [self runWriteNotifyBenchmarkWithWriters:1 readers:1 commits:500];
+}
+
+- (void)testWriteNotifyBenchmarkOneWriterFourReaders {
+    [self runWriteNotifyBenchmarkWithWriters:1 readers:4 commits:500];
+}
+
+- (void)testWriteNotifyBenchmarkFourWritersOneReader {
+    [self runWriteNotifyBenchmarkWithWriters:4 readers:1 commits:125];
+}
+
+- (void)testWriteNotifyBenchmarkFourWritersFourReaders {
+    [self runWriteNotifyBenchmarkWithWriters:4 readers:4 commits:125];
+}
+#endif
+
 @end
+
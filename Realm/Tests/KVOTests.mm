@@ -1612,6 +1612,43 @@ public:
     }
 }
 
+- (void)testNotificationBlockReportsAllChangedProperties {
+    KVOObject *obj = [self createObject];
+    KVOObject *observed = [self observableForObject:obj];
+
+    __block int calls = 0;
+    __block NSArray *changed;
+    __block BOOL wasDeleted = NO;
+    RLMNotificationToken *token = [observed addNotificationBlock:^(NSArray *changedProperties, BOOL deleted) {
+        ++calls;
+        changed = changedProperties;
+        wasDeleted = deleted;
+    }];
+
+    obj.boolCol = YES;
+    obj.int32Col = 10;
+    obj.stringCol = @"abc";
+    [self.realm commitWriteTransaction];
+    [self.realm beginWriteTransaction];
+    [self.secondaryRealm refresh];
+
+    XCTAssertEqual(1, calls);
+    XCTAssertFalse(wasDeleted);
+    XCTAssertEqualObjects(([NSSet setWithObjects:@"boolCol", @"int32Col", @"stringCol", nil]),
+                          [NSSet setWithArray:changed]);
+
+    [self.realm deleteObject:obj];
+    [self.realm commitWriteTransaction];
+    [self.realm beginWriteTransaction];
+    [self.secondaryRealm refresh];
+
+    XCTAssertEqual(2, calls);
+    XCTAssertTrue(wasDeleted);
+    XCTAssertNil(changed);
+
+    [self.secondaryRealm removeNotification:token];
+}
+
 - (void)testInsertNewTables {
     KVOObject *obj = [self createObject];
 
@@ -221,6 +221,22 @@ RLM_ARRAY_TYPE(MigrationObject);
     XCTAssertEqual(1U, [RLMRealm schemaVersionAtPath:config.path encryptionKey:nil error:nil]);
 }
 
+- (void)testGetSchemaVersionDoesNotCreateFiles {
+    NSFileManager *manager = [NSFileManager defaultManager];
+    NSString *path = RLMDefaultRealmPath();
+    NSString *lockPath = [path stringByAppendingString:@".lock"];
+    XCTAssertEqual(RLMNotVersioned, [RLMRealm schemaVersionAtPath:path encryptionKey:nil error:nil]);
+    XCTAssertFalse([manager fileExistsAtPath:path]);
+
+    RLMRealmConfiguration *config = [RLMRealmConfiguration defaultConfiguration];
+    config.schemaVersion = 3;
+    @autoreleasepool { [RLMRealm realmWithConfiguration:config error:nil]; }
+    [manager removeItemAtPath:lockPath error:nil];
+
+    XCTAssertEqual(3U, [RLMRealm schemaVersionAtPath:path encryptionKey:nil error:nil]);
+    XCTAssertFalse([manager fileExistsAtPath:lockPath]);
+}
+
 - (void)testSchemaVersionCannotGoDown {
     RLMRealmConfiguration *config = [RLMRealmConfiguration defaultConfiguration];
     config.schemaVersion = 10;
@@ -247,6 +263,43 @@ RLM_ARRAY_TYPE(MigrationObject);
     XCTAssertEqual(10U, [RLMRealm schemaVersionAtPath:config.path encryptionKey:nil error:nil]);
 }
 
+- (void)testSchemaFingerprintDoesNotHideExternalSchemaChanges {
+    RLMRealmConfiguration *config = [self config];
+    config.objectClasses = @[MigrationObject.class];
+    @autoreleasepool { XCTAssertNoThrow([RLMRealm realmWithConfiguration:config error:nil]); }
+    @autoreleasepool { XCTAssertNoThrow([RLMRealm realmWithConfiguration:config error:nil]); }
+
+    // modify the table directly so that the stored fingerprint is stale
+    @autoreleasepool {
+        RLMRealm *realm = [RLMRealm realmWithConfiguration:config error:nil];
+        [realm beginWriteTransaction];
+        ObjectStore::table_for_object_type(realm.group, "MigrationObject")->add_column(realm::type_Int, "extra");
+        [realm commitWriteTransaction];
+    }
+
+    XCTAssertThrows([RLMRealm realmWithConfiguration:config error:nil]);
+}
+
+- (void)testSchemaFingerprintIsKeptForEachSubsetOfTypes {
+    RLMRealmConfiguration *config1 = [self config];
+    config1.objectClasses = @[MigrationObject.class];
+    RLMRealmConfiguration *config2 = [self config];
+    config2.objectClasses = @[ThreeFieldMigrationObject.class];
+
+    @autoreleasepool { XCTAssertNoThrow([RLMRealm realmWithConfiguration:config1 error:nil]); }
+    @autoreleasepool { XCTAssertNoThrow([RLMRealm realmWithConfiguration:config2 error:nil]); }
+
+    // opening with the second subset must not have replaced the first's fingerprint
+    @autoreleasepool {
+        RLMRealm *realm = [RLMRealm realmWithConfiguration:config1 error:nil];
+        XCTAssertTrue(ObjectStore::verify_schema_fingerprint(realm.group, *realm->_realm->config().schema));
+    }
+    @autoreleasepool {
+        RLMRealm *realm = [RLMRealm realmWithConfiguration:config2 error:nil];
+        XCTAssertTrue(ObjectStore::verify_schema_fingerprint(realm.group, *realm->_realm->config().schema));
+    }
+}
+
 #pragma mark - Migration Requirements
 
 - (void)testAddingClassDoesNotRequireMigration {
@@ -633,6 +686,32 @@ RLM_ARRAY_TYPE(MigrationObject);
     XCTAssertEqual(2, mig.col3);
 }
 
+- (void)testMigrationProgressBlock {
+    [self createTestRealmWithClasses:@[MigrationObject.class] block:^(RLMRealm *realm) {
+        for (int i = 0; i < 2050; ++i) {
+            [MigrationObject createInRealm:realm withValue:@[@(i), @"a"]];
+        }
+    }];
+
+    NSMutableArray *progress = [NSMutableArray array];
+    @autoreleasepool {
+        RLMRealmConfiguration *config = self.config;
+        config.schemaVersion = 1;
+        config.migrationBlock = ^(RLMMigration *migration, uint64_t) {
+            [migration enumerateObjects:MigrationObject.className block:^(RLMObject *, RLMObject *) { }];
+            [migration transformValuesOfProperty:@"stringCol" toProperty:@"stringCol" ofClass:MigrationObject.className
+                                           block:^id(id oldValue) { return oldValue; }];
+        };
+        config.migrationProgressBlock = ^(NSString *className, NSUInteger completed, NSUInteger total) {
+            XCTAssertEqualObjects(MigrationObject.className, className);
+            XCTAssertEqual(2050U, total);
+            [progress addObject:@(completed)];
+        };
+        XCTAssertNil([RLMRealm migrateRealm:config]);
+    }
+    XCTAssertEqualObjects((@[@1024, @2048, @2050, @1024, @2048, @2050]), progress);
+}
+
 - (void)testRemoveProperty {
     // create schema with an extra column
     RLMObjectSchema *objectSchema = [RLMObjectSchema schemaForObjectClass:MigrationObject.class];
@@ -698,6 +777,54 @@ RLM_ARRAY_TYPE(MigrationObject);
     XCTAssertThrows(mig1[@"oldIntCol"], @"Deleted column should no longer be accessible.");
 }
 
+- (void)testMigratePropertyValues {
+    // create schema to migrate from with a differently named int column
+    RLMObjectSchema *objectSchema = [RLMObjectSchema schemaForObjectClass:MigrationObject.class];
+    RLMProperty *oldInt = [[RLMProperty alloc] initWithName:@"oldIntCol" type:RLMPropertyTypeInt objectClassName:nil indexed:NO optional:NO];
+    objectSchema.properties = @[oldInt, objectSchema.properties[1]];
+
+    // create realm with old schema and populate
+    [self createTestRealmWithSchema:@[objectSchema] block:^(RLMRealm *realm) {
+        [realm createObject:MigrationObject.className withValue:@[@1, @"a"]];
+        [realm createObject:MigrationObject.className withValue:@[@2, @"b"]];
+    }];
+
+    RLMRealm *realm = [self migrateTestRealmWithBlock:^(RLMMigration *migration, uint64_t) {
+        XCTAssertThrows([migration copyValuesOfProperty:@"oldIntCol" toProperty:@"stringCol" ofClass:MigrationObject.className]);
+        XCTAssertThrows([migration copyValuesOfProperty:@"intCol" toProperty:@"intCol" ofClass:MigrationObject.className]);
+        XCTAssertThrows([migration copyValuesOfProperty:@"oldIntCol" toProperty:@"intCol" ofClass:@"NoSuchClass"]);
+        XCTAssertThrows([migration setValue:@"a" forProperty:@"intCol" ofClass:MigrationObject.className]);
+        XCTAssertThrows([migration transformValuesOfProperty:@"stringCol" toProperty:@"intCol" ofClass:MigrationObject.className
+                                                       block:^id(id oldValue) { return oldValue; }]);
+
+        [migration copyValuesOfProperty:@"oldIntCol" toProperty:@"intCol" ofClass:MigrationObject.className];
+        [migration transformValuesOfProperty:@"stringCol" toProperty:@"stringCol" ofClass:MigrationObject.className
+                                       block:^id(NSString *oldValue) { return oldValue.uppercaseString; }];
+    }];
+
+    @autoreleasepool {
+        RLMResults *objects = [MigrationObject allObjectsInRealm:realm];
+        XCTAssertEqual(1, [objects[0] intCol]);
+        XCTAssertEqual(2, [objects[1] intCol]);
+        XCTAssertEqualObjects(@"A", [objects[0] stringCol]);
+        XCTAssertEqualObjects(@"B", [objects[1] stringCol]);
+        realm = nil;
+    }
+
+    // setting a value applies to every object
+    @autoreleasepool {
+        RLMRealmConfiguration *config = self.config;
+        config.schemaVersion = 2;
+        config.migrationBlock = ^(RLMMigration *migration, uint64_t) {
+            [migration setValue:@5 forProperty:@"intCol" ofClass:MigrationObject.className];
+        };
+        realm = [RLMRealm realmWithConfiguration:config error:nil];
+        for (MigrationObject *obj in [MigrationObject allObjectsInRealm:realm]) {
+            XCTAssertEqual(5, obj.intCol);
+        }
+    }
+}
+
 - (void)testChangePropertyType {
     // make string an int
     RLMObjectSchema *objectSchema = [RLMObjectSchema schemaForObjectClass:MigrationObject.class];
@@ -837,6 +964,31 @@ RLM_ARRAY_TYPE(MigrationObject);
     XCTAssertEqual(1U, [[MigrationPrimaryKeyObject allObjectsInRealm:realm] count]);
 }
 
+- (void)testMigrationWhichDoesNotWritePrimaryKeysPreservesThem {
+    [self createTestRealmWithClasses:@[MigrationPrimaryKeyObject.class, MigrationObject.class] block:^(RLMRealm *realm) {
+        [realm createObject:MigrationPrimaryKeyObject.className withValue:@[@1]];
+        [realm createObject:MigrationPrimaryKeyObject.className withValue:@[@2]];
+        [realm createObject:MigrationPrimaryKeyObject.className withValue:@[@3]];
+        [realm createObject:MigrationObject.className withValue:@[@1, @"1"]];
+    }];
+
+    RLMRealm *realm = [self migrateTestRealmWithBlock:^(RLMMigration *migration, uint64_t) {
+        [migration enumerateObjects:MigrationObject.className block:^(__unused RLMObject *oldObject, RLMObject *newObject) {
+            newObject[@"intCol"] = @2;
+        }];
+        [migration enumerateObjects:MigrationPrimaryKeyObject.className block:^(__unused RLMObject *oldObject, RLMObject *newObject) {
+            if ([newObject[@"intCol"] intValue] == 2) {
+                [migration deleteObject:newObject];
+            }
+        }];
+    }];
+
+    XCTAssertEqual(2U, [MigrationPrimaryKeyObject allObjectsInRealm:realm].count);
+    XCTAssertNotNil([MigrationPrimaryKeyObject objectInRealm:realm forPrimaryKey:@1]);
+    XCTAssertNotNil([MigrationPrimaryKeyObject objectInRealm:realm forPrimaryKey:@3]);
+    XCTAssertEqual(2, [[MigrationObject allObjectsInRealm:realm].firstObject intCol]);
+}
+
 - (void)testIncompleteMigrationIsRolledBack {
     RLMObjectSchema *objectSchema = [RLMObjectSchema schemaForObjectClass:MigrationPrimaryKeyObject.class];
     objectSchema.primaryKeyProperty = nil;
@@ -925,6 +1077,51 @@ RLM_ARRAY_TYPE(MigrationObject);
     XCTAssertEqualObjects([NSDate dateWithTimeIntervalSince1970:2], obj.date);
 }
 
+- (void)testRequiredToNullableAutoMigrationPreservesIndex {
+    RLMObjectSchema *objectSchema = [RLMObjectSchema schemaForObjectClass:IndexedStringObject.class];
+    [objectSchema.properties setValue:@NO forKey:@"optional"];
+
+    [self createTestRealmWithSchema:@[objectSchema] block:^(RLMRealm *realm) {
+        for (int i = 0; i < 100; ++i) {
+            [IndexedStringObject createInRealm:realm withValue:@[[NSString stringWithFormat:@"%d", i]]];
+        }
+    }];
+
+    RLMRealm *realm = [self migrateTestRealmWithBlock:nil];
+    RLMResults *allObjects = [IndexedStringObject allObjectsInRealm:realm];
+    XCTAssertEqual(100U, allObjects.count);
+    XCTAssertEqualObjects(@"42", [allObjects[42] stringCol]);
+    XCTAssertEqual(1U, [IndexedStringObject objectsInRealm:realm where:@"stringCol = '42'"].count);
+
+    [realm beginWriteTransaction];
+    [allObjects[0] setStringCol:nil];
+    [realm commitWriteTransaction];
+    XCTAssertEqual(1U, [IndexedStringObject objectsInRealm:realm where:@"stringCol = nil"].count);
+}
+
+- (void)testIndexAddedInMigrationIncludesMigratedValues {
+    RLMObjectSchema *objectSchema = [RLMObjectSchema schemaForObjectClass:IndexedStringObject.class];
+    [objectSchema.properties[0] setIndexed:NO];
+
+    [self createTestRealmWithSchema:@[objectSchema] block:^(RLMRealm *realm) {
+        for (int i = 0; i < 10; ++i) {
+            [IndexedStringObject createInRealm:realm withValue:@[[NSString stringWithFormat:@"%d", i]]];
+        }
+    }];
+
+    RLMRealm *realm = [self migrateTestRealmWithBlock:^(RLMMigration *migration, uint64_t) {
+        [migration enumerateObjects:IndexedStringObject.className block:^(RLMObject *oldObject, RLMObject *newObject) {
+            newObject[@"stringCol"] = [oldObject[@"stringCol"] stringByAppendingString:@"!"];
+        }];
+        [migration createObject:IndexedStringObject.className withValue:@[@"new"]];
+    }];
+
+    XCTAssertEqual(11U, [IndexedStringObject allObjectsInRealm:realm].count);
+    XCTAssertEqual(1U, [IndexedStringObject objectsInRealm:realm where:@"stringCol = '5!'"].count);
+    XCTAssertEqual(0U, [IndexedStringObject objectsInRealm:realm where:@"stringCol = '5'"].count);
+    XCTAssertEqual(1U, [IndexedStringObject objectsInRealm:realm where:@"stringCol = 'new'"].count);
+}
+
 - (void)testNullableToRequiredMigration {
     RLMObjectSchema *objectSchema = [RLMObjectSchema schemaForObjectClass:AllOptionalTypes.class];
 
@@ -622,6 +622,55 @@ RLM_ARRAY_TYPE(PrimaryEmployeeObject);
     XCTAssertEqual(row1.cBoolCol, true);
 }
 
+- (void)testChunkedDataAccess
+{
+    RLMRealm *realm = [RLMRealm defaultRealm];
+    const char bytes[8] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+    char buffer[8] = {};
+
+    [realm beginWriteTransaction];
+    DataObject *obj = [DataObject createInRealm:realm withValue:@[NSNull.null, NSNull.null]];
+    XCTAssertEqual(0U, [obj lengthOfDataProperty:@"data1"]);
+    [obj appendBytes:bytes length:4 toDataProperty:@"data1"];
+    [obj appendBytes:bytes + 4 length:4 toDataProperty:@"data1"];
+    [realm commitWriteTransaction];
+
+    XCTAssertEqual(8U, [obj lengthOfDataProperty:@"data1"]);
+    XCTAssertEqualObjects([NSData dataWithBytes:bytes length:8], obj.data1);
+    XCTAssertNil(obj.data2);
+
+    XCTAssertEqual(3U, [obj getBytes:buffer range:NSMakeRange(2, 3) ofDataProperty:@"data1"]);
+    XCTAssertEqual(0, memcmp(buffer, bytes + 2, 3));
+    XCTAssertEqual(2U, [obj getBytes:buffer range:NSMakeRange(6, 4) ofDataProperty:@"data1"]);
+    XCTAssertEqual(0, memcmp(buffer, bytes + 6, 2));
+    XCTAssertEqual(0U, [obj getBytes:buffer range:NSMakeRange(8, 4) ofDataProperty:@"data1"]);
+    RLMAssertThrowsWithReasonMatching([obj getBytes:buffer range:NSMakeRange(9, 1) ofDataProperty:@"data1"], @"out of bounds");
+
+    XCTAssertThrows([obj appendBytes:bytes length:1 toDataProperty:@"data1"]);
+
+    [realm beginWriteTransaction];
+    const char replacement[3] = { 9, 9, 9 };
+    [obj replaceBytesInRange:NSMakeRange(1, 6) withBytes:replacement length:3 ofDataProperty:@"data1"];
+    const char expected[5] = { 0, 9, 9, 9, 7 };
+    XCTAssertEqualObjects([NSData dataWithBytes:expected length:5], obj.data1);
+    [obj replaceBytesInRange:NSMakeRange(0, 5) withBytes:NULL length:0 ofDataProperty:@"data1"];
+    XCTAssertNotNil(obj.data1);
+    XCTAssertEqual(0U, obj.data1.length);
+    RLMAssertThrowsWithReasonMatching([obj replaceBytesInRange:NSMakeRange(0, 1) withBytes:bytes length:1 ofDataProperty:@"data1"], @"out of bounds");
+    RLMAssertThrowsWithReasonMatching([obj lengthOfDataProperty:@"invalid"], @"Invalid property name");
+    [realm cancelWriteTransaction];
+
+    DataObject *unmanaged = [[DataObject alloc] init];
+    [unmanaged appendBytes:bytes length:8 toDataProperty:@"data1"];
+    [unmanaged replaceBytesInRange:NSMakeRange(1, 6) withBytes:replacement length:3 ofDataProperty:@"data1"];
+    XCTAssertEqualObjects([NSData dataWithBytes:expected length:5], unmanaged.data1);
+    XCTAssertEqual(2U, [unmanaged getBytes:buffer range:NSMakeRange(3, 10) ofDataProperty:@"data1"]);
+    XCTAssertEqual(0, memcmp(buffer, expected + 3, 2));
+
+    StringObject *stringObj = [[StringObject alloc] init];
+    RLMAssertThrowsWithReasonMatching([stringObj lengthOfDataProperty:@"stringCol"], @"not a data property");
+}
+
 - (void)testObjectSubclass {
     // test className methods
     XCTAssertEqualObjects(@"StringObject", [StringObject className]);
@@ -742,6 +791,26 @@ RLM_ARRAY_TYPE(PrimaryEmployeeObject);
     [realm cancelWriteTransaction];
 }
 
+- (void)testClassMethodsUseTheObjectSchemaOfEachRealm {
+    RLMRealm *realm = [RLMRealm defaultRealm];
+    RLMRealm *otherRealm = [self realmWithTestPath];
+
+    [realm beginWriteTransaction];
+    [otherRealm beginWriteTransaction];
+    StringObject *first = [StringObject createInRealm:realm withValue:@[@"a"]];
+    StringObject *second = [StringObject createInRealm:otherRealm withValue:@[@"b"]];
+    StringObject *third = [StringObject createInRealm:realm withValue:@[@"c"]];
+    [realm commitWriteTransaction];
+    [otherRealm commitWriteTransaction];
+
+    XCTAssertEqual(first.objectSchema, realm.schema[@"StringObject"]);
+    XCTAssertEqual(second.objectSchema, otherRealm.schema[@"StringObject"]);
+    XCTAssertEqual(third.objectSchema, realm.schema[@"StringObject"]);
+    XCTAssertEqual(2U, [StringObject allObjectsInRealm:realm].count);
+    XCTAssertEqualObjects(@"b", [[StringObject allObjectsInRealm:otherRealm].firstObject stringCol]);
+    XCTAssertEqual(1U, [StringObject objectsInRealm:realm where:@"stringCol = 'c'"].count);
+}
+
 - (void)testNSNumberProperties {
     NumberObject *obj = [NumberObject new];
     obj.intObj = @20;
@@ -1387,6 +1456,40 @@ RLM_ARRAY_TYPE(PrimaryEmployeeObject);
     [realm2 commitWriteTransaction];
 }
 
+- (void)testCreateInRealmCopiesSharedObjectsOnce {
+    RLMRealm *realm1 = [RLMRealm defaultRealm];
+    RLMRealm *realm2 = [self realmWithTestPath];
+    [realm1 beginWriteTransaction];
+    [realm2 beginWriteTransaction];
+
+    DogObject *standaloneDog = [[DogObject alloc] initWithValue:@[@"Fido", @5]];
+    DogArrayObject *dogArray = [DogArrayObject createInRealm:realm2 withValue:@[@[standaloneDog, standaloneDog]]];
+    XCTAssertEqual(2U, dogArray.dogs.count);
+    XCTAssertTrue([dogArray.dogs[0] isEqualToObject:dogArray.dogs[1]]);
+    XCTAssertEqual(1U, [DogObject allObjectsInRealm:realm2].count);
+    XCTAssertNil(standaloneDog.realm);
+
+    DogObject *dog = [DogObject createInRealm:realm1 withValue:@[@"Rex", @3]];
+    dogArray = [DogArrayObject createInRealm:realm2 withValue:@[@[dog, dog, dog]]];
+    XCTAssertEqual(3U, dogArray.dogs.count);
+    XCTAssertEqual(2U, [DogObject allObjectsInRealm:realm2].count);
+
+    // each call makes its own copies
+    [DogArrayObject createInRealm:realm2 withValue:@[@[dog]]];
+    XCTAssertEqual(3U, [DogObject allObjectsInRealm:realm2].count);
+
+    CircleObject *circle = [[CircleObject alloc] initWithValue:@[@"a", [NSNull null]]];
+    circle.next = [[CircleObject alloc] initWithValue:@[@"b", circle]];
+    CircleObject *copy = [CircleObject createInRealm:realm2 withValue:circle];
+    XCTAssertEqualObjects(copy.next.data, @"b");
+    XCTAssertTrue([copy.next.next isEqualToObject:copy]);
+    XCTAssertEqual(2U, [CircleObject allObjectsInRealm:realm2].count);
+    circle.next.next = nil;
+
+    [realm1 commitWriteTransaction];
+    [realm2 commitWriteTransaction];
+}
+
 - (void)testCreateInRealmWithOtherObjects {
     RLMRealm *realm = [RLMRealm defaultRealm];
     [realm beginWriteTransaction];
@@ -1427,6 +1530,47 @@ RLM_ARRAY_TYPE(PrimaryEmployeeObject);
     [realm commitWriteTransaction];
 }
 
+- (void)testCreateInRealmWithValues {
+    RLMRealm *realm = [RLMRealm defaultRealm];
+
+    XCTAssertThrows([EmployeeObject createInRealm:realm withValues:@[@[@"Alice", @30, @YES]]]);
+
+    [realm beginWriteTransaction];
+    [EmployeeObject createInRealm:realm withValues:@[@[@"Alice", @30, @YES],
+                                                     @{@"name": @"Bob", @"age": @40, @"hired": @NO},
+                                                     @{@"age": @20, @"hired": @YES}]];
+    [EmployeeObject createInRealm:realm withValues:@[]];
+    RLMResults *employees = [EmployeeObject allObjectsInRealm:realm];
+    XCTAssertEqualObjects([employees valueForKey:@"name"], (@[@"Alice", @"Bob", NSNull.null]));
+    XCTAssertEqualObjects([employees valueForKey:@"age"], (@[@30, @40, @20]));
+
+    [CompanyObject createInRealm:realm withValues:@[@[@"Realm", @[@[@"Carol", @50, @YES]]]]];
+    XCTAssertEqual(1U, [CompanyObject allObjectsInRealm:realm].count);
+    CompanyObject *company = [CompanyObject allObjectsInRealm:realm].firstObject;
+    XCTAssertEqualObjects([company.employees.firstObject name], @"Carol");
+    XCTAssertEqual(4U, employees.count);
+
+    XCTAssertThrows([EmployeeObject createInRealm:realm withValues:@[@[@27, @YES]]]);
+    XCTAssertThrows([AggregateObject createInRealm:realm withValues:@[@{@"boolCol": @YES}]]);
+    [realm commitWriteTransaction];
+}
+
+- (void)testCreateOrUpdateInRealmWithValues {
+    RLMRealm *realm = [RLMRealm defaultRealm];
+    [realm beginWriteTransaction];
+
+    PrimaryStringObject *existing = [PrimaryStringObject createInRealm:realm withValue:@[@"a", @1]];
+    [PrimaryStringObject createOrUpdateInRealm:realm withValues:@[@[@"a", @2], @{@"stringCol": @"b", @"intCol": @3}, existing]];
+    RLMResults *objects = [PrimaryStringObject allObjectsInRealm:realm];
+    XCTAssertEqual(2U, objects.count);
+    XCTAssertEqual(2, existing.intCol);
+    XCTAssertEqual(3, [PrimaryStringObject objectInRealm:realm forPrimaryKey:@"b"].intCol);
+
+    XCTAssertThrows([StringObject createOrUpdateInRealm:realm withValues:@[@[@"string"]]]);
+
+    [realm commitWriteTransaction];
+}
+
 - (void)testObjectDescription
 {
     RLMRealm *realm = [RLMRealm defaultRealm];
@@ -1833,6 +1977,51 @@ RLM_ARRAY_TYPE(PrimaryEmployeeObject);
     XCTAssertThrows([PrimaryIntObject objectInRealm:self.nonLiteralNil forPrimaryKey:@0]);
 }
 
+- (void)testObjectForPrimaryKeyAfterRowsChange {
+    RLMRealm *realm = RLMRealm.defaultRealm;
+    [realm beginWriteTransaction];
+    for (int i = 0; i < 5; ++i) {
+        [PrimaryIntObject createInRealm:realm withValue:@[@(i)]];
+        [PrimaryStringObject createInRealm:realm withValue:@[[NSString stringWithFormat:@"%d", i], @(i)]];
+    }
+    [realm commitWriteTransaction];
+
+    XCTAssertEqual(1, [[PrimaryIntObject objectForPrimaryKey:@1] intCol]);
+    XCTAssertEqual(1, [[PrimaryStringObject objectForPrimaryKey:@"1"] intCol]);
+    XCTAssertEqual(4, [[PrimaryIntObject objectForPrimaryKey:@4] intCol]);
+    XCTAssertEqual(4, [[PrimaryStringObject objectForPrimaryKey:@"4"] intCol]);
+    XCTAssertNil([PrimaryIntObject objectForPrimaryKey:@5]);
+
+    // deleting moves the last row into the deleted one's place
+    [realm beginWriteTransaction];
+    [realm deleteObject:[PrimaryIntObject objectForPrimaryKey:@1]];
+    [realm deleteObject:[PrimaryStringObject objectForPrimaryKey:@"1"]];
+    XCTAssertNil([PrimaryIntObject objectForPrimaryKey:@1]);
+    XCTAssertNil([PrimaryStringObject objectForPrimaryKey:@"1"]);
+    XCTAssertEqual(4, [[PrimaryIntObject objectForPrimaryKey:@4] intCol]);
+    XCTAssertEqual(4, [[PrimaryStringObject objectForPrimaryKey:@"4"] intCol]);
+
+    [PrimaryIntObject createInRealm:realm withValue:@[@5]];
+    XCTAssertEqual(5, [[PrimaryIntObject objectForPrimaryKey:@5] intCol]);
+    [realm cancelWriteTransaction];
+
+    XCTAssertEqual(1, [[PrimaryIntObject objectForPrimaryKey:@1] intCol]);
+    XCTAssertNil([PrimaryIntObject objectForPrimaryKey:@5]);
+
+    // changes made on another thread
+    [self dispatchAsyncAndWait:^{
+        RLMRealm *realm = RLMRealm.defaultRealm;
+        [realm beginWriteTransaction];
+        [realm deleteObject:[PrimaryStringObject objectForPrimaryKey:@"0"]];
+        [PrimaryStringObject createInRealm:realm withValue:@[@"5", @5]];
+        [realm commitWriteTransaction];
+    }];
+    [realm refresh];
+    XCTAssertNil([PrimaryStringObject objectForPrimaryKey:@"0"]);
+    XCTAssertEqual(4, [[PrimaryStringObject objectForPrimaryKey:@"4"] intCol]);
+    XCTAssertEqual(5, [[PrimaryStringObject objectForPrimaryKey:@"5"] intCol]);
+}
+
 - (void)testBacklinks {
     StringObject *obj = [[StringObject alloc] initWithValue:@[@"string"]];
 
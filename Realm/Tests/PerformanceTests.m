@@ -30,7 +30,21 @@
 
 static RLMRealm *s_smallRealm, *s_mediumRealm, *s_largeRealm;
 
-@implementation PerformanceTests
+// The time spent measuring each test with an unencrypted Realm, by test name,
+// for reporting how much slower the encrypted variants are
+static NSMutableDictionary *s_plaintextDurations;
+
+@implementation PerformanceTests {
+    NSTimeInterval _measuredDuration;
+    CFAbsoluteTime _measureStart;
+    BOOL _measuringManually;
+}
+
+// The key to encrypt the Realms used by the tests with, or nil to use
+// unencrypted Realms
++ (NSData *)encryptionKey {
+    return nil;
+}
 
 + (void)setUp {
     [super setUp];
@@ -59,16 +73,74 @@ static RLMRealm *s_smallRealm, *s_mediumRealm, *s_largeRealm;
 }
 
 - (void)measureMetrics:(NSArray *)metrics automaticallyStartMeasuring:(BOOL)automaticallyStartMeasuring forBlock:(void (^)(void))block {
+    _measuringManually = !automaticallyStartMeasuring;
     [super measureMetrics:metrics automaticallyStartMeasuring:automaticallyStartMeasuring forBlock:^{
         @autoreleasepool {
+            CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
             block();
+            if (automaticallyStartMeasuring) {
+                _measuredDuration += CFAbsoluteTimeGetCurrent() - start;
+            }
         }
     }];
 }
 
+- (void)startMeasuring {
+    _measureStart = CFAbsoluteTimeGetCurrent();
+    [super startMeasuring];
+}
+
+- (void)stopMeasuring {
+    [super stopMeasuring];
+    if (_measuringManually) {
+        _measuredDuration += CFAbsoluteTimeGetCurrent() - _measureStart;
+    }
+}
+
+// Record the total time measured for each unencrypted test, and log how it
+// compares to that of the same test with an encrypted Realm
+- (void)invokeTest {
+    _measuredDuration = 0;
+    [super invokeTest];
+    if (_measuredDuration == 0) {
+        return;
+    }
+
+    NSString *name = NSStringFromSelector(self.invocation.selector);
+    if (!self.class.encryptionKey) {
+        if (!s_plaintextDurations) {
+            s_plaintextDurations = [NSMutableDictionary new];
+        }
+        s_plaintextDurations[name] = @(_measuredDuration);
+        return;
+    }
+    if (NSNumber *plaintext = s_plaintextDurations[name]) {
+        printf("RLMBenchmark {\"test\": \"%s\", \"encrypted_s\": %.4f, \"plaintext_s\": %.4f, \"overhead\": %.2f}\n",
+               name.UTF8String, _measuredDuration, plaintext.doubleValue, _measuredDuration / plaintext.doubleValue);
+    }
+}
+
+// measureMetrics: only reports the mean time of the whole block, which hides
+// the tail latency of the individual commits and notifications, so log the
+// percentiles of each phase of the transactions a Realm has run
+- (void)logLatenciesOfRealm:(NSString *)label metrics:(RLMTransactionMetrics *)metrics {
+    for (NSString *phase in @[@"commit", @"notify", @"advance", @"didChange"]) {
+        RLMDurationHistogram *histogram = [metrics valueForKey:phase];
+        if (histogram.count == 0) {
+            continue;
+        }
+        printf("RLMBenchmark {\"test\": \"%s\", \"realm\": \"%s\", \"phase\": \"%s\", \"count\": %lu, "
+               "\"p50_us\": %.1f, \"p90_us\": %.1f, \"p99_us\": %.1f, \"max_us\": %.1f}\n",
+               self.name.UTF8String, label.UTF8String, phase.UTF8String, (unsigned long)histogram.count,
+               [histogram durationAtPercentile:50] * 1e6, [histogram durationAtPercentile:90] * 1e6,
+               [histogram durationAtPercentile:99] * 1e6, histogram.maxDuration * 1e6);
+    }
+}
+
 + (RLMRealm *)createStringObjects:(int)factor {
     RLMRealmConfiguration *config = [RLMRealmConfiguration new];
     config.inMemoryIdentifier = @(factor).stringValue;
+    config.encryptionKey = self.encryptionKey;
 
     // If a previous run of the tests crashed there could be a lingering
     // copy of the in-memory realm
@@ -86,9 +158,20 @@ static RLMRealm *s_smallRealm, *s_mediumRealm, *s_largeRealm;
     return realm;
 }
 
+- (RLMRealm *)realmWithTestPath {
+    if (!self.class.encryptionKey) {
+        return [super realmWithTestPath];
+    }
+    RLMRealmConfiguration *config = [RLMRealmConfiguration new];
+    config.path = RLMTestRealmPath();
+    config.encryptionKey = self.class.encryptionKey;
+    return [RLMRealm realmWithConfiguration:config error:nil];
+}
+
 - (RLMRealm *)testRealm {
     RLMRealmConfiguration *config = [RLMRealmConfiguration new];
     config.inMemoryIdentifier = @"test";
+    config.encryptionKey = self.class.encryptionKey;
     return [RLMRealm realmWithConfiguration:config error:nil];
 }
 
@@ -135,9 +218,15 @@ static RLMRealm *s_smallRealm, *s_mediumRealm, *s_largeRealm;
 - (RLMRealm *)getStringObjects:(int)factor {
     RLMRealmConfiguration *config = [RLMRealmConfiguration new];
     config.inMemoryIdentifier = @(factor).stringValue;
+    config.encryptionKey = self.class.encryptionKey;
     RLMRealm *realm = [RLMRealm realmWithConfiguration:config error:nil];
     [NSFileManager.defaultManager removeItemAtPath:RLMTestRealmPath() error:nil];
-    [realm writeCopyToPath:RLMTestRealmPath() error:nil];
+    if (self.class.encryptionKey) {
+        [realm writeCopyToPath:RLMTestRealmPath() encryptionKey:self.class.encryptionKey error:nil];
+    }
+    else {
+        [realm writeCopyToPath:RLMTestRealmPath() error:nil];
+    }
     return [self realmWithTestPath];
 }
 
@@ -389,6 +478,7 @@ static RLMRealm *s_smallRealm, *s_mediumRealm, *s_largeRealm;
 
 - (void)testRealmFileCreation {
     RLMRealmConfiguration *config = [RLMRealmConfiguration new];
+    config.encryptionKey = self.class.encryptionKey;
     __block int measurement = 0;
     const int iterations = 10;
     [self measureBlock:^{
@@ -448,6 +538,7 @@ static RLMRealm *s_smallRealm, *s_mediumRealm, *s_largeRealm;
         [realm commitWriteTransaction];
 
         dispatch_semaphore_t sema = dispatch_semaphore_create(0);
+        __block RLMTransactionMetrics *readerMetrics;
         [self dispatchAsync:^{
             RLMRealm *realm = self.testRealm;
             IntObject *obj = [[IntObject allObjectsInRealm:realm] firstObject];
@@ -459,14 +550,17 @@ static RLMRealm *s_smallRealm, *s_mediumRealm, *s_largeRealm;
                         CFRunLoopStop(CFRunLoopGetCurrent());
                     }
                 }];
+                [realm resetTransactionMetrics];
                 dispatch_semaphore_signal(sema);
             });
             CFRunLoopRun();
 
             [realm removeNotification:token];
+            readerMetrics = realm.transactionMetrics;
         }];
 
         dispatch_semaphore_wait(sema, DISPATCH_TIME_FOREVER);
+        [realm resetTransactionMetrics];
         [self startMeasuring];
         while (obj.intCol < stopValue) {
             [realm transactionWithBlock:^{
@@ -476,6 +570,9 @@ static RLMRealm *s_smallRealm, *s_mediumRealm, *s_largeRealm;
 
         [self dispatchAsyncAndWait:^{}];
         [self stopMeasuring];
+
+        [self logLatenciesOfRealm:@"writer" metrics:realm.transactionMetrics];
+        [self logLatenciesOfRealm:@"reader" metrics:readerMetrics];
     }];
 }
 
@@ -490,6 +587,7 @@ static RLMRealm *s_smallRealm, *s_mediumRealm, *s_largeRealm;
         [realm commitWriteTransaction];
 
         dispatch_semaphore_t sema = dispatch_semaphore_create(0);
+        __block RLMTransactionMetrics *backgroundMetrics;
         [self dispatchAsync:^{
             RLMRealm *realm = self.testRealm;
             IntObject *obj = [[IntObject allObjectsInRealm:realm] firstObject];
@@ -507,11 +605,13 @@ static RLMRealm *s_smallRealm, *s_mediumRealm, *s_largeRealm;
                     }
                 }];
 
+                [realm resetTransactionMetrics];
                 dispatch_semaphore_signal(sema);
             });
             CFRunLoopRun();
 
             [realm removeNotification:token];
+            backgroundMetrics = realm.transactionMetrics;
         }];
 
         RLMNotificationToken *token = [realm addNotificationBlock:^(__unused NSString *note, __unused RLMRealm *realm) {
@@ -523,6 +623,7 @@ static RLMRealm *s_smallRealm, *s_mediumRealm, *s_largeRealm;
         }];
 
         dispatch_semaphore_wait(sema, DISPATCH_TIME_FOREVER);
+        [realm resetTransactionMetrics];
         [self startMeasuring];
         [realm transactionWithBlock:^{
             obj.intCol++;
@@ -535,6 +636,8 @@ static RLMRealm *s_smallRealm, *s_mediumRealm, *s_largeRealm;
         [self stopMeasuring];
 
         [realm removeNotification:token];
+        [self logLatenciesOfRealm:@"main" metrics:realm.transactionMetrics];
+        [self logLatenciesOfRealm:@"background" metrics:backgroundMetrics];
     }];
 }
 
@@ -679,4 +782,40 @@ static RLMRealm *s_smallRealm, *s_mediumRealm, *s_largeRealm;
 
 @end
 
+// The insert, enumerate, query, sort and commit/notify benchmarks, run with an
+// encrypted Realm. Runs after PerformanceTests, so that each test also logs
+// its time relative to the unencrypted run.
+@interface PerformanceTestsEncrypted : PerformanceTests
+@end
+
+@implementation PerformanceTestsEncrypted
+
++ (NSData *)encryptionKey {
+    static NSData *key;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        key = RLMGenerateKey();
+    });
+    return key;
+}
+
++ (NSArray *)testInvocations {
+    NSArray *prefixes = @[@"testInsert", @"testCountWhere", @"testEnumerate", @"testUnIndexedStringLookup",
+                          @"testIndexedStringLookup", @"testLargeINQuery", @"testSorting", @"testCommitWriteTransaction",
+                          @"testCrossThreadSyncLatency", @"testRealmCreation"];
+    NSMutableArray *invocations = [NSMutableArray array];
+    for (NSInvocation *invocation in [super testInvocations]) {
+        NSString *name = NSStringFromSelector(invocation.selector);
+        for (NSString *prefix in prefixes) {
+            if ([name hasPrefix:prefix]) {
+                [invocations addObject:invocation];
+                break;
+            }
+        }
+    }
+    return invocations;
+}
+
+@end
+
 #endif
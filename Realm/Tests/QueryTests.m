@@ -128,6 +128,54 @@
     XCTAssertEqualObjects([results[0] name], @"Tim", @"Tim should be first results");
 }
 
+- (void)testPreparedQuery
+{
+    RLMRealm *realm = [RLMRealm defaultRealm];
+
+    [realm beginWriteTransaction];
+    [PersonObject createInRealm:realm withValue:@[@"Fiel", @27]];
+    [PersonObject createInRealm:realm withValue:@[@"Ari", @33]];
+    [PersonObject createInRealm:realm withValue:@[@"Tim", @29]];
+    [realm commitWriteTransaction];
+
+    NSPredicate *predicate = [NSPredicate predicateWithFormat:@"age > $age AND (name BEGINSWITH $prefix OR NOT name IN $names)"];
+    RLMPreparedQuery *query = [RLMPreparedQuery preparedQueryWithObjectClassName:@"PersonObject"
+                                                                       predicate:predicate
+                                                                         inRealm:realm];
+    XCTAssertEqualObjects(@"PersonObject", query.objectClassName);
+
+    XCTAssertEqual(2U, [query objectsWithSubstitutionVariables:(@{@"age": @28, @"prefix": @"T", @"names": @[]})].count);
+    XCTAssertEqual(1U, [query objectsWithSubstitutionVariables:(@{@"age": @28, @"prefix": @"T", @"names": @[@"Ari"]})].count);
+    XCTAssertEqual(0U, [query objectsWithSubstitutionVariables:(@{@"age": @30, @"prefix": @"T", @"names": @[@"Ari"]})].count);
+    XCTAssertEqual(3U, [query objectsWithSubstitutionVariables:(@{@"age": @0, @"prefix": @"", @"names": @[]})].count);
+
+    // Results from a prepared query can be further filtered like any other
+    RLMResults *results = [query objectsWithSubstitutionVariables:(@{@"age": @0, @"prefix": @"", @"names": @[]})];
+    XCTAssertEqualObjects(@"Tim", [[results objectsWhere:@"age = 29"].firstObject name]);
+
+    // Substitution variables can be compared with keypaths in either order,
+    // and predicates without variables work too
+    query = [RLMPreparedQuery preparedQueryWithObjectClassName:@"PersonObject"
+                                                     predicate:[NSPredicate predicateWithFormat:@"$age < age"]
+                                                       inRealm:realm];
+    XCTAssertEqual(1U, [query objectsWithSubstitutionVariables:@{@"age": @30}].count);
+    query = [RLMPreparedQuery preparedQueryWithObjectClassName:@"PersonObject"
+                                                     predicate:[NSPredicate predicateWithFormat:@"age BETWEEN {28, 30}"]
+                                                       inRealm:realm];
+    XCTAssertEqual(1U, [query objectsWithSubstitutionVariables:nil].count);
+
+    // Invalid key paths are reported when preparing, invalid values when run
+    RLMAssertThrowsWithReasonMatching([RLMPreparedQuery preparedQueryWithObjectClassName:@"PersonObject"
+                                                                               predicate:[NSPredicate predicateWithFormat:@"foo > $age"]
+                                                                                 inRealm:realm],
+                                      @"foo.*PersonObject");
+    query = [RLMPreparedQuery preparedQueryWithObjectClassName:@"PersonObject"
+                                                     predicate:[NSPredicate predicateWithFormat:@"age > $age"]
+                                                       inRealm:realm];
+    RLMAssertThrowsWithReasonMatching([query objectsWithSubstitutionVariables:@{}], @"substitution variable '\\$age'");
+    RLMAssertThrowsWithReasonMatching([query objectsWithSubstitutionVariables:@{@"age": @"a"}], @"type int .* property 'age'");
+}
+
 -(void)testQueryBetween
 {
     RLMRealm *realm = [RLMRealm defaultRealm];
@@ -307,10 +355,46 @@
     XCTAssertThrows([arrayOfAll.array sortedResultsUsingProperty:@"invalidCol" ascending:NO]);
 
     // sort on key path
-    RLMAssertThrowsWithReasonMatching([[AllTypesObject allObjects] sortedResultsUsingProperty:@"key.path" ascending:YES], @"key paths is not supported");
+    RLMAssertThrowsWithReasonMatching([[AllTypesObject allObjects] sortedResultsUsingProperty:@"key.path" ascending:YES], @"'key' not found");
+    RLMAssertThrowsWithReasonMatching([[AllTypesObject allObjects] sortedResultsUsingProperty:@"intCol.path" ascending:YES], @"not a link to a single object");
+    RLMAssertThrowsWithReasonMatching([[AllTypesObject allObjects] sortedResultsUsingProperty:@"objectCol.invalid" ascending:YES], @"'invalid'.* 'StringObject'.* not found");
     XCTAssertThrows([arrayOfAll.array sortedResultsUsingProperty:@"key.path" ascending:NO]);
 }
 
+- (void)testSortByLinkedProperty {
+    RLMRealm *realm = [RLMRealm defaultRealm];
+    [realm beginWriteTransaction];
+    [OwnerObject createInRealm:realm withValue:@[@"a", @[@"Rex", @3]]];
+    [OwnerObject createInRealm:realm withValue:@[@"b", NSNull.null]];
+    [OwnerObject createInRealm:realm withValue:@[@"c", @[@"Fido", @5]]];
+    [OwnerObject createInRealm:realm withValue:@[@"d", @[@"fido", @1]]];
+    [realm commitWriteTransaction];
+
+    RLMResults *owners = [OwnerObject allObjectsInRealm:realm];
+    XCTAssertEqualObjects((@[@"b", @"c", @"a", @"d"]),
+                          [[owners sortedResultsUsingProperty:@"dog.dogName" ascending:YES] valueForKey:@"name"]);
+    XCTAssertEqualObjects((@[@"c", @"a", @"d", @"b"]),
+                          [[owners sortedResultsUsingProperty:@"dog.age" ascending:NO] valueForKey:@"name"]);
+
+    // Linked properties can be combined with direct ones and with a locale
+    NSArray *descriptors = @[[RLMSortDescriptor sortDescriptorWithProperty:@"dog.dogName" ascending:YES
+                                                                    locale:[NSLocale localeWithLocaleIdentifier:@"en_US"]],
+                             [RLMSortDescriptor sortDescriptorWithProperty:@"name" ascending:NO]];
+    XCTAssertEqualObjects((@[@"b", @"c", @"d", @"a"]),
+                          [[owners sortedResultsUsingDescriptors:descriptors] valueForKey:@"name"]);
+
+    // Changes to the linked objects re-sort the results
+    RLMResults *sorted = [owners sortedResultsUsingProperty:@"dog.age" ascending:YES];
+    XCTAssertEqualObjects((@[@"b", @"d", @"a", @"c"]), [sorted valueForKey:@"name"]);
+    [realm beginWriteTransaction];
+    [[owners objectsWhere:@"name = 'c'"].firstObject dog].age = 0;
+    [realm commitWriteTransaction];
+    XCTAssertEqualObjects((@[@"b", @"c", @"d", @"a"]), [sorted valueForKey:@"name"]);
+
+    XCTAssertEqualObjects(@"d", [[sorted resultsWithLimit:1 offset:2].firstObject name]);
+    RLMAssertThrowsWithReasonMatching([sorted resultsAfterObjectAtIndex:0 limit:1], @"linked objects");
+}
+
 - (void)testSortByMultipleColumns {
     RLMRealm *realm = [RLMRealm defaultRealm];
     [realm beginWriteTransaction];
@@ -493,8 +577,10 @@
     // LinkList equality is unsupport since the semantics are unclear
     XCTAssertThrows(([ArrayOfAllTypesObject objectsWhere:@"ANY array = array"]));
 
-    // subquery
-    XCTAssertThrows(([ArrayOfAllTypesObject objectsWhere:@"SUBQUERY(array, $obj, $obj.intCol = 5).@count > 1"]));
+    // subquery on anything other than an RLMArray, or with its count compared to anything other than a number
+    XCTAssertThrows(([LinkToAllTypesObject objectsWhere:@"SUBQUERY(allTypesCol, $obj, $obj.intCol = 5).@count > 1"]));
+    XCTAssertThrows(([ArrayOfAllTypesObject objectsWhere:@"SUBQUERY(array, $obj, $obj.intCol = 5).@count > 'a'"]));
+    XCTAssertThrows(([ArrayOfAllTypesObject objectsWhere:@"SUBQUERY(array, $obj, $obj.intCol = 5).@count BEGINSWITH 1"]));
 
     // block-based predicate
     NSPredicate *pred = [NSPredicate predicateWithBlock:^BOOL (__unused id obj, __unused NSDictionary *bindings) {
@@ -746,6 +832,34 @@
     RLMAssertCount(AllTypesObject, 1U, @"objectCol.stringCol BEGINSWITH[c] 'A'");
 }
 
+- (void)testStringRangeComparisons
+{
+    RLMRealm *realm = [RLMRealm defaultRealm];
+
+    [realm beginWriteTransaction];
+    for (NSString *str in @[@"a", @"ab", @"abc", @"b", @"B", @"\u00e9"]) {
+        [StringObject createInRealm:realm withValue:@[str]];
+    }
+    if (self.isNull) {
+        [StringObject createInRealm:realm withValue:@[NSNull.null]];
+    }
+    [realm commitWriteTransaction];
+
+    RLMAssertCount(StringObject, 3U, @"stringCol > 'ab'");
+    RLMAssertCount(StringObject, 4U, @"stringCol >= 'ab'");
+    RLMAssertCount(StringObject, 2U, @"stringCol < 'ab'");
+    RLMAssertCount(StringObject, 3U, @"stringCol <= 'ab'");
+    RLMAssertCount(StringObject, 2U, @"'ab' > stringCol");
+    RLMAssertCount(StringObject, 2U, @"stringCol >= 'ab' AND stringCol < 'b'");
+    RLMAssertCount(StringObject, 6U, @"stringCol >= ''");
+    RLMAssertCount(StringObject, 0U, @"stringCol < ''");
+
+    // Strings are ordered by code point, so uppercase letters come before
+    // lowercase ones and accented letters after both
+    RLMAssertCount(StringObject, 1U, @"stringCol < 'a'");
+    RLMAssertCount(StringObject, 1U, @"stringCol > 'z'");
+}
+
 - (void)testStringEndsWith
 {
     RLMRealm *realm = [RLMRealm defaultRealm];
@@ -844,7 +958,7 @@
     XCTAssertThrows([StringObject objectsWhere:@"stringCol LIKE 'abc'"]);
     XCTAssertThrows([StringObject objectsWhere:@"stringCol MATCHES 'abc'"]);
     XCTAssertThrows([StringObject objectsWhere:@"stringCol BETWEEN {'a', 'b'}"]);
-    XCTAssertThrows([StringObject objectsWhere:@"stringCol < 'abc'"]);
+    XCTAssertThrows([StringObject objectsWhere:@"stringCol <[c] 'abc'"]);
 
     XCTAssertThrows([AllTypesObject objectsWhere:@"objectCol.stringCol LIKE 'abc'"]);
     XCTAssertThrows([AllTypesObject objectsWhere:@"objectCol.stringCol MATCHES 'abc'"]);
@@ -1495,6 +1609,66 @@
     [self testClass:[AllTypesObject class] withNormalCount:1U notCount:0U where:@"objectCol.stringCol IN[c] %@", @[@"ABC"]];
 }
 
+- (void)testLargeINPredicate
+{
+    RLMRealm *realm = [RLMRealm defaultRealm];
+
+    [realm beginWriteTransaction];
+    for (int i = 0; i < 100; ++i) {
+        [IntObject createInRealm:realm withValue:@[@(i)]];
+        [StringObject createInRealm:realm withValue:@[[NSString stringWithFormat:@"%d", i]]];
+    }
+    [StringObject createInRealm:realm withValue:@[NSNull.null]];
+    [realm commitWriteTransaction];
+
+    NSMutableArray *ints = [NSMutableArray array];
+    NSMutableArray *strings = [NSMutableArray array];
+    for (int i = 0; i < 200; i += 4) {
+        [ints addObject:@(i)];
+        [strings addObject:[NSString stringWithFormat:@"%d", i]];
+    }
+
+    [self testClass:[IntObject class] withNormalCount:25U notCount:75U where:@"intCol IN %@", ints];
+    [self testClass:[StringObject class] withNormalCount:25U notCount:76U where:@"stringCol IN %@", strings];
+    XCTAssertEqual(13U, ([IntObject objectsWhere:@"intCol IN %@ AND intCol < 50", ints].count));
+
+    [strings addObject:NSNull.null];
+    [self testClass:[StringObject class] withNormalCount:26U notCount:75U where:@"stringCol IN %@", strings];
+
+    // Case-insensitive comparisons fall back to individual equality conditions
+    [realm beginWriteTransaction];
+    [StringObject createInRealm:realm withValue:@[@"abc"]];
+    [realm commitWriteTransaction];
+    [strings replaceObjectAtIndex:0 withObject:@"ABC"];
+    XCTAssertEqual(0U, ([StringObject objectsWhere:@"stringCol IN %@ AND stringCol BEGINSWITH 'a'", strings].count));
+    XCTAssertEqual(1U, ([StringObject objectsWhere:@"stringCol IN[c] %@ AND stringCol BEGINSWITH 'a'", strings].count));
+}
+
+- (void)testLargeINPredicateOnNullableInt
+{
+    RLMRealm *realm = [RLMRealm defaultRealm];
+
+    [realm beginWriteTransaction];
+    for (int i = 0; i < 20; ++i) {
+        [AllOptionalTypes createInRealm:realm withValue:@[@(i)]];
+    }
+    [AllOptionalTypes createInRealm:realm withValue:@[NSNull.null]];
+    [realm commitWriteTransaction];
+
+    // Nulls read as zero, but only match when the set contains null
+    NSMutableArray *ints = [NSMutableArray array];
+    for (int i = 0; i < 40; i += 2) {
+        [ints addObject:@(i)];
+    }
+    [self testClass:[AllOptionalTypes class] withNormalCount:10U notCount:11U where:@"intObj IN %@", ints];
+
+    [ints addObject:NSNull.null];
+    [self testClass:[AllOptionalTypes class] withNormalCount:11U notCount:10U where:@"intObj IN %@", ints];
+
+    [ints removeObjectAtIndex:0];
+    [self testClass:[AllOptionalTypes class] withNormalCount:10U notCount:11U where:@"intObj IN %@", ints];
+}
+
 - (void)testArrayIn
 {
     RLMRealm *realm = [RLMRealm defaultRealm];
@@ -1548,6 +1722,36 @@
     RLMAssertCount([co.employees, 1U, @"hired = YES"] objectsWhere:@"name = 'Joe'");
 }
 
+- (void)testSubquery {
+    RLMRealm *realm = [RLMRealm defaultRealm];
+
+    [realm beginWriteTransaction];
+    [CompanyObject createInRealm:realm
+                       withValue:@[@"first", @[@{@"name": @"John", @"age": @30, @"hired": @NO},
+                                               @{@"name": @"Joe",  @"age": @40, @"hired": @YES},
+                                               @{@"name": @"Jill",  @"age": @50, @"hired": @YES}]]];
+    [CompanyObject createInRealm:realm
+                       withValue:@[@"second", @[@{@"name": @"Bill", @"age": @35, @"hired": @YES},
+                                                @{@"name": @"Jane",  @"age": @25, @"hired": @NO}]]];
+    [CompanyObject createInRealm:realm withValue:@[@"third", @[]]];
+    [realm commitWriteTransaction];
+
+    RLMAssertCount(CompanyObject, 2U, @"SUBQUERY(employees, $e, $e.hired = YES).@count > 0");
+    RLMAssertCount(CompanyObject, 1U, @"SUBQUERY(employees, $e, $e.hired = YES AND $e.age > 35).@count > 0");
+    RLMAssertCount(CompanyObject, 1U, @"SUBQUERY(employees, $e, $e.hired = YES).@count >= 2");
+    RLMAssertCount(CompanyObject, 1U, @"SUBQUERY(employees, $e, $e.hired = YES).@count == 1");
+    RLMAssertCount(CompanyObject, 2U, @"SUBQUERY(employees, $e, $e.hired = YES).@count != 2");
+    RLMAssertCount(CompanyObject, 2U, @"SUBQUERY(employees, $e, $e.age < 40).@count <= 1");
+    RLMAssertCount(CompanyObject, 3U, @"SUBQUERY(employees, $e, $e.age < 40).@count < 3");
+    RLMAssertCount(CompanyObject, 1U, @"SUBQUERY(employees, $e, $e.name BEGINSWITH 'J').@count == 3");
+    RLMAssertCount(CompanyObject, 1U, @"1 < SUBQUERY(employees, $e, $e.hired = YES).@count");
+    RLMAssertCount(CompanyObject, 1U, @"name = 'second' AND SUBQUERY(employees, $e, $e.age < %@).@count == 2", @36);
+    RLMAssertCount(CompanyObject, 3U, @"SUBQUERY(employees, $e, $e.age > 100).@count >= 0");
+    RLMAssertCount(CompanyObject, 0U, @"SUBQUERY(employees, $e, $e.age > 100).@count > 0");
+
+    XCTAssertThrows([CompanyObject objectsWhere:@"SUBQUERY(employees, $e, $e.salary > 10).@count > 0"]);
+}
+
 - (void)testLinkViewQueryLifetime {
     RLMRealm *realm = [RLMRealm defaultRealm];
 
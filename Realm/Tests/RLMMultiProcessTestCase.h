@@ -28,6 +28,10 @@
 // returns the return code of the process
 - (int)runChildAndWait;
 
+// spawn a child process running the current test with the given variables
+// added to its environment and wait for it to complete
+- (int)runChildAndWaitWithEnvironment:(NSDictionary *)environment;
+
 - (NSTask *)childTask;
 @end
 
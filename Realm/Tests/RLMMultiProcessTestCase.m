@@ -123,11 +123,20 @@
 }
 
 - (int)runChildAndWait {
+    return [self runChildAndWaitWithEnvironment:nil];
+}
+
+- (int)runChildAndWaitWithEnvironment:(NSDictionary *)environment {
     NSPipe *outputPipe = [NSPipe pipe];
     NSFileHandle *handle = outputPipe.fileHandleForReading;
 
     NSTask *task = [self childTask];
     task.standardError = outputPipe;
+    if (environment.count) {
+        NSMutableDictionary *env = [task.environment mutableCopy];
+        [env addEntriesFromDictionary:environment];
+        task.environment = env;
+    }
     [task launch];
 
     NSFileHandle *err = [NSFileHandle fileHandleWithStandardError];
@@ -166,5 +175,9 @@
 - (int)runChildAndWait {
     return 1;
 }
+
+- (int)runChildAndWaitWithEnvironment:(__unused NSDictionary *)environment {
+    return 1;
+}
 #endif
 @end
@@ -88,6 +88,32 @@
 @property NSString *stringCol;
 @end
 
+@interface TextIndexedStringObject : RLMObject
+@property NSString *stringCol;
+@end
+
+@interface IndexedEventObject : RLMObject
+@property int sequence;
+@property NSDate *timestamp;
+@end
+
+@interface CompoundKeyObject : RLMObject
+@property int accountId;
+@property NSString *itemId;
+@property int version;
+@end
+
+@interface ExpiringObject : RLMObject
+@property NSString *name;
+@property NSDate *updatedAt;
+@end
+
+RLM_ARRAY_TYPE(ExpiringObject)
+
+@interface ExpiringArrayObject : RLMObject
+@property RLM_GENERIC_ARRAY(ExpiringObject) *array;
+@end
+
 RLM_ARRAY_TYPE(StringObject)
 RLM_ARRAY_TYPE(IntObject)
 
@@ -295,6 +321,10 @@ RLM_ARRAY_TYPE(CircleObject);
 
 @end
 
+@interface CachedAggregateArrayObject : RLMObject
+@property RLM_GENERIC_ARRAY(IntObject) *array;
+@end
+
 @interface NumberObject : RLMObject
 @property NSNumber<RLMInt> *intObj;
 @property NSNumber<RLMFloat> *floatObj;
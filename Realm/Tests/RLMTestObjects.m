@@ -57,6 +57,47 @@
 }
 @end
 
+@implementation IndexedEventObject
++ (NSArray *)indexedProperties
+{
+    return @[@"sequence", @"timestamp"];
+}
+@end
+
+@implementation TextIndexedStringObject
++ (NSArray *)textIndexedProperties
+{
+    return @[@"stringCol"];
+}
+@end
+
+@implementation CompoundKeyObject
++ (NSArray *)compoundPrimaryKey
+{
+    return @[@"accountId", @"itemId"];
+}
+
++ (NSArray *)compoundIndexes
+{
+    return @[@[@"accountId", @"version"]];
+}
+@end
+
+@implementation ExpiringObject
++ (NSString *)timeToLiveProperty
+{
+    return @"updatedAt";
+}
+
++ (NSTimeInterval)timeToLive
+{
+    return 3600;
+}
+@end
+
+@implementation ExpiringArrayObject
+@end
+
 @implementation LinkStringObject
 @end
 
@@ -174,6 +215,13 @@
 @implementation IntegerArrayPropertyObject
 @end
 
+@implementation CachedAggregateArrayObject
++ (NSArray *)cachedAggregateProperties
+{
+    return @[@"array"];
+}
+@end
+
 @implementation NumberObject
 @end
 
@@ -71,6 +71,176 @@
     XCTAssertEqual(configuration.schemaVersion, std::numeric_limits<uint64_t>::max() - 1);
 }
 
+- (void)testSlowQueryThresholdValidation {
+    RLMRealmConfiguration *configuration = [[RLMRealmConfiguration alloc] init];
+    XCTAssertEqual(0.0, configuration.slowQueryThreshold);
+    RLMAssertThrowsWithReasonMatching(configuration.slowQueryThreshold = -1, @"must not be negative");
+
+    configuration.slowQueryThreshold = 0.25;
+    XCTAssertEqualWithAccuracy(0.25, configuration.slowQueryThreshold, 1e-6);
+}
+
+- (void)testIdleReadTransactionTimeoutValidation {
+    RLMRealmConfiguration *configuration = [[RLMRealmConfiguration alloc] init];
+    XCTAssertEqual(0.0, configuration.idleReadTransactionTimeout);
+    RLMAssertThrowsWithReasonMatching(configuration.idleReadTransactionTimeout = -1, @"must not be negative");
+
+    configuration.idleReadTransactionTimeout = 30;
+    XCTAssertEqualWithAccuracy(30.0, [configuration copy].idleReadTransactionTimeout, 1e-6);
+}
+
+- (void)testAutorefreshStepValidation {
+    RLMRealmConfiguration *configuration = [[RLMRealmConfiguration alloc] init];
+    XCTAssertEqual(0U, configuration.autorefreshVersionLimit);
+    XCTAssertEqual(0.0, configuration.autorefreshTimeBudget);
+    RLMAssertThrowsWithReasonMatching(configuration.autorefreshTimeBudget = -1, @"must not be negative");
+
+    configuration.autorefreshVersionLimit = 100;
+    configuration.autorefreshTimeBudget = 0.01;
+    RLMRealmConfiguration *copy = [configuration copy];
+    XCTAssertEqual(100U, copy.autorefreshVersionLimit);
+    XCTAssertEqualWithAccuracy(0.01, copy.autorefreshTimeBudget, 1e-6);
+}
+
+- (void)testObservedObjectClassesValidation {
+    RLMRealmConfiguration *configuration = [[RLMRealmConfiguration alloc] init];
+    XCTAssertNil(configuration.observedObjectClasses);
+    RLMAssertThrowsWithReasonMatching(configuration.observedObjectClasses = @[NSObject.class], @"RLMObject subclasses");
+
+    configuration.observedObjectClasses = @[StringObject.class];
+    XCTAssertEqualObjects(@[StringObject.class], [configuration copy].observedObjectClasses);
+}
+
+- (void)testComputeChangesInBackgroundIsCopied {
+    RLMRealmConfiguration *configuration = [[RLMRealmConfiguration alloc] init];
+    XCTAssertFalse(configuration.computeChangesInBackground);
+    configuration.computeChangesInBackground = YES;
+    XCTAssertTrue([configuration copy].computeChangesInBackground);
+}
+
+- (void)testMinimumNotificationIntervalValidation {
+    RLMRealmConfiguration *configuration = [[RLMRealmConfiguration alloc] init];
+    XCTAssertEqual(0.0, configuration.minimumNotificationInterval);
+    RLMAssertThrowsWithReasonMatching(configuration.minimumNotificationInterval = -1, @"must not be negative");
+
+    configuration.minimumNotificationInterval = 0.25;
+    XCTAssertEqualWithAccuracy(0.25, [configuration copy].minimumNotificationInterval, 1e-6);
+}
+
+- (void)testNotificationRunLoopModesAndQualityOfServiceAreCopied {
+    RLMRealmConfiguration *configuration = [[RLMRealmConfiguration alloc] init];
+    XCTAssertNil(configuration.notificationRunLoopModes);
+    XCTAssertEqual(NSQualityOfServiceDefault, configuration.notificationQualityOfService);
+
+    configuration.notificationRunLoopModes = @[NSRunLoopCommonModes];
+    configuration.notificationQualityOfService = NSQualityOfServiceUserInitiated;
+    RLMRealmConfiguration *copy = [configuration copy];
+    XCTAssertEqualObjects(@[NSRunLoopCommonModes], copy.notificationRunLoopModes);
+    XCTAssertEqual(NSQualityOfServiceUserInitiated, copy.notificationQualityOfService);
+
+    configuration.notificationRunLoopModes = nil;
+    configuration.notificationQualityOfService = NSQualityOfServiceDefault;
+    XCTAssertNil(configuration.notificationRunLoopModes);
+    XCTAssertEqual(NSQualityOfServiceDefault, configuration.notificationQualityOfService);
+}
+
+- (void)testPrefetchObjectClassesValidation {
+    RLMRealmConfiguration *configuration = [[RLMRealmConfiguration alloc] init];
+    XCTAssertNil(configuration.prefetchObjectClasses);
+    RLMAssertThrowsWithReasonMatching(configuration.prefetchObjectClasses = @[NSObject.class], @"RLMObject subclasses");
+
+    configuration.prefetchObjectClasses = @[StringObject.class];
+    XCTAssertEqualObjects(@[StringObject.class], [configuration copy].prefetchObjectClasses);
+}
+
+- (void)testCompactOnOpenValidation {
+    RLMRealmConfiguration *configuration = [[RLMRealmConfiguration alloc] init];
+    XCTAssertEqual(0.0, configuration.compactOnOpenFreeSpaceRatio);
+    XCTAssertEqual(0U, configuration.compactOnOpenMinimumFileSize);
+    RLMAssertThrowsWithReasonMatching(configuration.compactOnOpenFreeSpaceRatio = -0.5, @"between 0 and 1");
+    RLMAssertThrowsWithReasonMatching(configuration.compactOnOpenFreeSpaceRatio = 1.5, @"between 0 and 1");
+
+    configuration.compactOnOpenFreeSpaceRatio = 0.5;
+    configuration.compactOnOpenMinimumFileSize = 1024;
+    configuration.compactionBlock = ^(__unused NSUInteger bytesReclaimed) {};
+    RLMRealmConfiguration *copy = [configuration copy];
+    XCTAssertEqual(0.5, copy.compactOnOpenFreeSpaceRatio);
+    XCTAssertEqual(1024U, copy.compactOnOpenMinimumFileSize);
+    XCTAssertNotNil(copy.compactionBlock);
+}
+
+- (void)testFileGrowth {
+    RLMRealmConfiguration *configuration = [[RLMRealmConfiguration alloc] init];
+    XCTAssertEqual(0U, configuration.initialFileSize);
+    XCTAssertEqual(0U, configuration.fileGrowthIncrement);
+    XCTAssertEqual(0.0, configuration.fileGrowthFactor);
+    RLMAssertThrowsWithReasonMatching(configuration.fileGrowthFactor = -1, @"must not be negative");
+
+    configuration.path = RLMTestRealmPath();
+    configuration.initialFileSize = 1024 * 1024;
+    configuration.fileGrowthIncrement = 4 * 1024 * 1024;
+    configuration.fileGrowthFactor = 0.25;
+    RLMRealmConfiguration *copy = [configuration copy];
+    XCTAssertEqual(1024U * 1024U, copy.initialFileSize);
+    XCTAssertEqual(4U * 1024U * 1024U, copy.fileGrowthIncrement);
+    XCTAssertEqual(0.25, copy.fileGrowthFactor);
+
+    @autoreleasepool {
+        RLMRealm *realm = [RLMRealm realmWithConfiguration:configuration error:nil];
+        NSDictionary *attributes = [NSFileManager.defaultManager attributesOfItemAtPath:configuration.path error:nil];
+        XCTAssertGreaterThanOrEqual(attributes.fileSize, 1024U * 1024U);
+
+        [realm transactionWithBlock:^{
+            for (int i = 0; i < 1000; ++i) {
+                [StringObject createInRealm:realm withValue:@[@"a"]];
+            }
+        }];
+        attributes = [NSFileManager.defaultManager attributesOfItemAtPath:configuration.path error:nil];
+        XCTAssertGreaterThanOrEqual(attributes.fileSize, 4U * 1024U * 1024U);
+        XCTAssertEqual(1000U, [StringObject allObjectsInRealm:realm].count);
+    }
+}
+
+- (void)testCacheLimitsAreCopied {
+    RLMRealmConfiguration *configuration = [[RLMRealmConfiguration alloc] init];
+    XCTAssertEqual(0U, configuration.maximumCachedObjectCount);
+    XCTAssertEqual(0U, configuration.maximumCacheSize);
+
+    configuration.maximumCachedObjectCount = 100;
+    configuration.maximumCacheSize = 1024 * 1024;
+    RLMRealmConfiguration *copy = [configuration copy];
+    XCTAssertEqual(100U, copy.maximumCachedObjectCount);
+    XCTAssertEqual(1024U * 1024U, copy.maximumCacheSize);
+}
+
+- (void)testExpirySweep {
+    RLMRealmConfiguration *configuration = [[RLMRealmConfiguration alloc] init];
+    XCTAssertEqual(0.0, configuration.expirySweepInterval);
+    XCTAssertEqual(1000U, configuration.expirySweepBatchSize);
+    RLMAssertThrowsWithReasonMatching(configuration.expirySweepInterval = -1, @"must not be negative");
+    RLMAssertThrowsWithReasonMatching(configuration.expirySweepBatchSize = 0, @"must be greater than zero");
+
+    configuration.expirySweepInterval = 60;
+    configuration.expirySweepBatchSize = 100;
+    RLMRealmConfiguration *copy = [configuration copy];
+    XCTAssertEqual(60.0, copy.expirySweepInterval);
+    XCTAssertEqual(100U, copy.expirySweepBatchSize);
+}
+
+- (void)testWriteBehindSettings {
+    RLMRealmConfiguration *configuration = [[RLMRealmConfiguration alloc] init];
+    XCTAssertEqual(1000U, configuration.writeBehindBatchSize);
+    XCTAssertEqual(0.0, configuration.writeBehindDelay);
+    RLMAssertThrowsWithReasonMatching(configuration.writeBehindBatchSize = 0, @"must be greater than zero");
+    RLMAssertThrowsWithReasonMatching(configuration.writeBehindDelay = -1, @"must not be negative");
+
+    configuration.writeBehindBatchSize = 50;
+    configuration.writeBehindDelay = 0.01;
+    RLMRealmConfiguration *copy = [configuration copy];
+    XCTAssertEqual(50U, copy.writeBehindBatchSize);
+    XCTAssertEqual(0.01, copy.writeBehindDelay);
+}
+
 - (void)testClassSubsetsValidateLinks {
     RLMRealmConfiguration *configuration = [[RLMRealmConfiguration alloc] init];
 
@@ -177,4 +347,37 @@
     XCTAssertTrue(migrationCalled);
 }
 
+#pragma mark - Slow Query Reporting
+
+- (void)testSlowQueryBlockIsCalledForQueriesOverThreshold {
+    RLMRealmConfiguration *configuration = [[RLMRealmConfiguration alloc] init];
+    configuration.path = RLMTestRealmPath();
+
+    NSMutableArray *descriptions = [NSMutableArray array];
+    configuration.slowQueryThreshold = 0;
+    configuration.slowQueryBlock = ^(NSString *description, NSTimeInterval duration) {
+        XCTAssertGreaterThanOrEqual(duration, 0.0);
+        [descriptions addObject:description];
+    };
+
+    @autoreleasepool {
+        RLMRealm *realm = [RLMRealm realmWithConfiguration:[configuration copy] error:nil];
+        [realm transactionWithBlock:^{
+            [IntObject createInRealm:realm withValue:@[@1]];
+        }];
+        XCTAssertEqual(1U, [IntObject objectsInRealm:realm where:@"intCol > 0"].count);
+        XCTAssertEqualObjects((@[@"intCol > 0 [scan]"]), descriptions);
+
+        // Queries faster than the threshold aren't reported
+        [descriptions removeAllObjects];
+    }
+
+    configuration.slowQueryThreshold = 60;
+    @autoreleasepool {
+        RLMRealm *realm = [RLMRealm realmWithConfiguration:configuration error:nil];
+        XCTAssertEqual(1U, [IntObject objectsInRealm:realm where:@"intCol > 0"].count);
+        XCTAssertEqual(0U, descriptions.count);
+    }
+}
+
 @end
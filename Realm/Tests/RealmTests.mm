@@ -22,6 +22,8 @@
 #import "RLMObjectSchema_Private.hpp"
 #import "RLMRealm_Dynamic.h"
 
+#import "shared_realm.hpp"
+
 extern "C" {
 #import "RLMSchema_Private.h"
 }
@@ -128,6 +130,39 @@ extern "C" {
     [NSFileManager.defaultManager setAttributes:@{NSFileImmutable: @NO} ofItemAtPath:parentDirectoryOfTestRealmPath error:nil];
 }
 
+- (void)testImmutableRealm {
+    @autoreleasepool {
+        RLMRealm *realm = self.realmWithTestPath;
+        [realm beginWriteTransaction];
+        [StringObject createInRealm:realm withValue:@[@"a"]];
+        [StringObject createInRealm:realm withValue:@[@"b"]];
+        [realm commitWriteTransaction];
+    }
+
+    NSString *lockPath = [RLMTestRealmPath() stringByAppendingString:@".lock"];
+    [[NSFileManager defaultManager] removeItemAtPath:lockPath error:nil];
+
+    RLMRealmConfiguration *configuration = [RLMRealmConfiguration defaultConfiguration];
+    configuration.path = RLMTestRealmPath();
+    configuration.immutable = YES;
+    XCTAssertTrue(configuration.readOnly);
+
+    RLMRealm *realm = [RLMRealm realmWithConfiguration:configuration error:nil];
+    XCTAssertTrue(realm.readOnly);
+    XCTAssertEqual(2U, [StringObject allObjectsInRealm:realm].count);
+    XCTAssertThrows([realm beginWriteTransaction]);
+
+    // Each thread gets its own Realm reading from the same mapping
+    dispatch_apply(4, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(__unused size_t i) {
+        @autoreleasepool {
+            RLMRealm *realm = [RLMRealm realmWithConfiguration:configuration error:nil];
+            XCTAssertEqualObjects(@"b", [[StringObject objectsInRealm:realm where:@"stringCol = 'b'"].firstObject stringCol]);
+        }
+    });
+
+    XCTAssertFalse([[NSFileManager defaultManager] fileExistsAtPath:lockPath]);
+}
+
 - (void)testReadOnlyRealmMustExist {
    RLMAssertThrowsWithCodeMatching([self readOnlyRealmWithPath:RLMTestRealmPath() error:nil], RLMErrorFileNotFound);
 }
@@ -278,6 +313,75 @@ extern "C" {
     XCTAssertEqual(obj.array.count, 0U, @"Expecting 0 objects");
 }
 
+- (void)testDeleteManyObjectsFromArray {
+    RLMRealm *realm = [self realmWithTestPath];
+    [realm beginWriteTransaction];
+    NSMutableArray *toDelete = [NSMutableArray new];
+    NSMutableArray *toKeep = [NSMutableArray new];
+    for (int i = 0; i < 100; ++i) {
+        IntObject *obj = [IntObject createInRealm:realm withValue:@[@(i)]];
+        [(i % 3 ? toKeep : toDelete) addObject:obj];
+    }
+    StringObject *str = [StringObject createInRealm:realm withValue:@[@"a"]];
+    [toDelete addObject:str];
+    // a second accessor for an object which is already being deleted
+    [toDelete addObject:[IntObject allObjectsInRealm:realm][0]];
+
+    [realm deleteObjects:[toDelete reverseObjectEnumerator].allObjects];
+    XCTAssertEqual(toKeep.count, [IntObject allObjectsInRealm:realm].count);
+    XCTAssertEqual(0U, [StringObject allObjectsInRealm:realm].count);
+    for (IntObject *obj in toDelete) {
+        XCTAssertTrue(obj.invalidated);
+    }
+    for (IntObject *obj in toKeep) {
+        XCTAssertFalse(obj.invalidated);
+        XCTAssertNotEqual(0, obj.intCol % 3);
+    }
+    XCTAssertEqualObjects([toKeep valueForKey:@"intCol"],
+                          [[[IntObject allObjectsInRealm:realm] sortedResultsUsingProperty:@"intCol" ascending:YES] valueForKey:@"intCol"]);
+    [realm cancelWriteTransaction];
+}
+
+- (void)testDeleteResultsInBatches {
+    RLMRealm *realm = [self realmWithTestPath];
+    [realm beginWriteTransaction];
+    for (int i = 0; i < 100; ++i) {
+        [IntObject createInRealm:realm withValue:@[@(i)]];
+    }
+    [realm commitWriteTransaction];
+
+    __block NSUInteger notifications = 0;
+    RLMNotificationToken *token = [realm addNotificationBlock:^(__unused NSString *note, __unused RLMRealm *realm) {
+        ++notifications;
+    }];
+
+    RLMResults *all = [IntObject allObjectsInRealm:realm];
+    [realm deleteObjects:[IntObject objectsInRealm:realm where:@"intCol >= 10"] batchSize:25];
+    XCTAssertFalse(realm.inWriteTransaction);
+    XCTAssertEqual(0U, [IntObject objectsInRealm:realm where:@"intCol >= 10"].count);
+    XCTAssertEqual(10U, all.count);
+    // each of the four batches was committed separately
+    XCTAssertEqual(4U, notifications);
+    [token stop];
+
+    // Table mode Results are still usable as they were afterwards
+    [realm deleteObjects:all batchSize:3];
+    XCTAssertEqual(0U, all.count);
+    [realm transactionWithBlock:^{
+        [IntObject createInRealm:realm withValue:@[@1]];
+    }];
+    XCTAssertEqual(1U, all.count);
+
+    // the caller's own writes are never committed by the batches
+    [realm beginWriteTransaction];
+    [IntObject createInRealm:realm withValue:@[@2]];
+    RLMAssertThrowsWithReasonMatching([realm deleteObjects:all batchSize:10], @"within a write transaction");
+    [realm cancelWriteTransaction];
+    XCTAssertEqual(1U, all.count);
+
+    XCTAssertThrows([RLMRealm.defaultRealm deleteObjects:all batchSize:10]);
+}
+
 - (void)testAddPersistedObjectToOtherRealm {
     RLMRealm *realm1 = [self realmWithTestPath];
     RLMRealm *realm2 = [RLMRealm defaultRealm];
@@ -483,6 +587,48 @@ extern "C" {
     [realm commitWriteTransaction];
 }
 
+- (void)testAddOrUpdateManyObjectsFromArray {
+    RLMRealm *realm = [self realmWithTestPath];
+    [realm beginWriteTransaction];
+    NSMutableArray *array = [NSMutableArray new];
+    for (int i = 0; i < 100; ++i) {
+        [array addObject:[[PrimaryStringObject alloc] initWithValue:@[[NSString stringWithFormat:@"%d", i], @(i)]]];
+    }
+    [realm addOrUpdateObjectsFromArray:array];
+
+    RLMResults *objects = [PrimaryStringObject allObjectsInRealm:realm];
+    XCTAssertEqual(100U, objects.count);
+    XCTAssertEqualObjects(@"42", [objects[42] stringCol]);
+    XCTAssertEqual(realm, [array[42] realm]);
+
+    // a few keys compared to the size of the table
+    PrimaryStringObject *duplicate = [[PrimaryStringObject alloc] initWithValue:@[@"new", @1]];
+    [realm addOrUpdateObjectsFromArray:@[[[PrimaryStringObject alloc] initWithValue:@[@"new", @0]],
+                                         [[PrimaryStringObject alloc] initWithValue:@[@"10", @-10]],
+                                         duplicate]];
+    XCTAssertEqual(101U, objects.count);
+    XCTAssertEqual(-10, [objects[10] intCol]);
+    XCTAssertEqualObjects(@"new", [objects[100] stringCol]);
+    XCTAssertEqual(1, [objects[100] intCol]);
+    XCTAssertTrue([duplicate isEqualToObject:objects[100]]);
+
+    // many keys compared to the size of the table, with persisted objects mixed in
+    array = [NSMutableArray new];
+    for (int i = 90; i < 110; ++i) {
+        [array addObject:[[PrimaryStringObject alloc] initWithValue:@[[NSString stringWithFormat:@"%d", i], @(-i)]]];
+    }
+    [array addObject:objects[0]];
+    [realm addOrUpdateObjectsFromArray:array];
+    XCTAssertEqual(111U, objects.count);
+    XCTAssertEqual(-99, [objects[99] intCol]);
+    XCTAssertEqualObjects(@"109", [objects[110] stringCol]);
+    XCTAssertEqual(-109, [objects[110] intCol]);
+    XCTAssertEqual(22U, [PrimaryStringObject objectsInRealm:realm where:@"intCol <= 0"].count);
+
+    XCTAssertThrows([realm addOrUpdateObjectsFromArray:@[[[StringObject alloc] initWithValue:@[@"string"]]]]);
+    [realm cancelWriteTransaction];
+}
+
 - (void)testDelete {
     RLMRealm *realm = [RLMRealm defaultRealm];
 
@@ -575,6 +721,208 @@ extern "C" {
     [realm cancelWriteTransaction];
 }
 
+- (void)testAddObjectsOfMixedTypesFromArray
+{
+    RLMRealm *realm = [self realmWithTestPath];
+
+    DogObject *dog1 = [[DogObject alloc] initWithValue:@[@"Rex", @10]];
+    DogObject *dog2 = [[DogObject alloc] initWithValue:@[@"Fido", @5]];
+    DogObject *linkedDog = [[DogObject alloc] initWithValue:@[@"Spot", @3]];
+    OwnerObject *owner = [[OwnerObject alloc] initWithValue:@[@"Tim", linkedDog]];
+    StringObject *str = [[StringObject alloc] initWithValue:@[@"a"]];
+
+    [realm beginWriteTransaction];
+    [realm addObjects:@[dog1, dog2, dog1, owner, linkedDog, str, dog2]];
+
+    RLMResults *dogs = [DogObject allObjectsInRealm:realm];
+    XCTAssertEqual(3U, dogs.count);
+    XCTAssertEqualObjects((@[@"Rex", @"Fido", @"Spot"]), [dogs valueForKey:@"dogName"]);
+    XCTAssertEqualObjects((@[@10, @5, @3]), [dogs valueForKey:@"age"]);
+    XCTAssertEqual(1U, [OwnerObject allObjectsInRealm:realm].count);
+    XCTAssertEqual(1U, [StringObject allObjectsInRealm:realm].count);
+
+    XCTAssertEqual(realm, dog1.realm);
+    XCTAssertEqual(realm, str.realm);
+    XCTAssertTrue([linkedDog isEqualToObject:owner.dog]);
+    XCTAssertTrue([dog2 isEqualToObject:dogs[1]]);
+
+    // objects before an invalid one are still added
+    DogObject *dog3 = [[DogObject alloc] initWithValue:@[@"Max", @1]];
+    XCTAssertThrows(([realm addObjects:@[dog3, @"not an object"]]));
+    XCTAssertEqual(4U, dogs.count);
+    XCTAssertEqual(realm, dog3.realm);
+    [realm cancelWriteTransaction];
+}
+
+- (void)testAddObjectsWithMissingValueLeavesAllStandalone
+{
+    RLMRealm *realm = [self realmWithTestPath];
+
+    RequiredPropertiesObject *valid = [[RequiredPropertiesObject alloc] init];
+    valid.stringCol = @"a";
+    valid.binaryCol = [NSData data];
+    RequiredPropertiesObject *missing = [[RequiredPropertiesObject alloc] init];
+    missing.binaryCol = [NSData data];
+
+    // objects added together are all checked before any of them are added
+    [realm beginWriteTransaction];
+    RLMAssertThrowsWithReasonMatching([realm addObjects:@[valid, missing]], @"No value or default value");
+    XCTAssertEqual(0U, [RequiredPropertiesObject allObjectsInRealm:realm].count);
+    XCTAssertNil(valid.realm);
+    XCTAssertNil(missing.realm);
+    XCTAssertEqualObjects(@"a", valid.stringCol);
+
+    [realm addObject:valid];
+    XCTAssertEqual(1U, [RequiredPropertiesObject allObjectsInRealm:realm].count);
+    XCTAssertEqual(realm, valid.realm);
+    [realm cancelWriteTransaction];
+}
+
+#pragma mark - Importing
+
+static NSInputStream *RLMStreamWithString(NSString *string) {
+    return [NSInputStream inputStreamWithData:[string dataUsingEncoding:NSUTF8StringEncoding]];
+}
+
+- (void)testImportJSON
+{
+    RLMRealm *realm = [self realmWithTestPath];
+    NSString *json = @"[{\"name\": \"Joe\", \"age\": 40, \"hired\": true},\n"
+                     @" {\"age\": 30, \"hired\": false, \"name\": \"Jill \\\"\\u00e9\\ud83d\\ude00\\\"\"},\n"
+                     @" {\"name\": null, \"age\": -5, \"hired\": false}]";
+    NSError *error;
+    XCTAssertTrue([realm importObjectsWithClassName:@"EmployeeObject" fromStream:RLMStreamWithString(json)
+                                             format:RLMImportFormatJSON error:&error]);
+    XCTAssertNil(error);
+
+    RLMResults *employees = [EmployeeObject allObjectsInRealm:realm];
+    XCTAssertEqual(3U, employees.count);
+    XCTAssertEqualObjects((@[@"Joe", @"Jill \"é\U0001F600\"", NSNull.null]), [employees valueForKey:@"name"]);
+    XCTAssertEqualObjects((@[@40, @30, @-5]), [employees valueForKey:@"age"]);
+    XCTAssertEqualObjects((@[@YES, @NO, @NO]), [employees valueForKey:@"hired"]);
+
+    XCTAssertTrue([realm importObjectsWithClassName:@"EmployeeObject" fromStream:RLMStreamWithString(@" [ ] ")
+                                             format:RLMImportFormatJSON error:nil]);
+    XCTAssertEqual(3U, employees.count);
+}
+
+- (void)testImportCSV
+{
+    RLMRealm *realm = [self realmWithTestPath];
+    NSString *csv = @"age,name,hired\r\n"
+                    @"40,Joe,true\r\n"
+                    @"30,\"Smith, \"\"Jill\"\"\",0\n"
+                    @"\n"
+                    @"-5,,false\n"
+                    @"7,\"\",1";
+    XCTAssertTrue([realm importObjectsWithClassName:@"EmployeeObject" fromStream:RLMStreamWithString(csv)
+                                             format:RLMImportFormatCSV error:nil]);
+
+    RLMResults *employees = [EmployeeObject allObjectsInRealm:realm];
+    XCTAssertEqual(4U, employees.count);
+    XCTAssertEqualObjects((@[@"Joe", @"Smith, \"Jill\"", NSNull.null, @""]), [employees valueForKey:@"name"]);
+    XCTAssertEqualObjects((@[@40, @30, @-5, @7]), [employees valueForKey:@"age"]);
+    XCTAssertEqualObjects((@[@YES, @NO, @NO, @YES]), [employees valueForKey:@"hired"]);
+}
+
+- (void)testImportFromFileDescriptor
+{
+    RLMRealm *realm = [self realmWithTestPath];
+    NSData *data = [@"stringCol\na\nb\n" dataUsingEncoding:NSUTF8StringEncoding];
+    int fds[2];
+    XCTAssertEqual(0, pipe(fds));
+    XCTAssertEqual((ssize_t)data.length, write(fds[1], data.bytes, data.length));
+    close(fds[1]);
+
+    XCTAssertTrue([realm importObjectsWithClassName:@"StringObject" fromFileDescriptor:fds[0]
+                                             format:RLMImportFormatCSV error:nil]);
+    close(fds[0]);
+    XCTAssertEqualObjects((@[@"a", @"b"]), [[StringObject allObjectsInRealm:realm] valueForKey:@"stringCol"]);
+}
+
+- (void)testImportErrors
+{
+    RLMRealm *realm = [self realmWithTestPath];
+    BOOL (^import)(NSString *, NSString *, RLMImportFormat) = ^(NSString *className, NSString *data, RLMImportFormat format) {
+        NSError *error;
+        BOOL success = [realm importObjectsWithClassName:className fromStream:RLMStreamWithString(data)
+                                                  format:format error:&error];
+        XCTAssertEqual(success, !error);
+        return success;
+    };
+
+    XCTAssertFalse(import(@"EmployeeObject", @"[{\"name\": \"Joe\", \"age\": \"40\", \"hired\": true}]", RLMImportFormatJSON));
+    XCTAssertFalse(import(@"EmployeeObject", @"[{\"name\": \"Joe\", \"age\": 40}]", RLMImportFormatJSON));
+    XCTAssertFalse(import(@"EmployeeObject", @"[{\"name\": \"Joe\", \"age\": 4.5, \"hired\": true}]", RLMImportFormatJSON));
+    XCTAssertFalse(import(@"EmployeeObject", @"[{\"unknown\": 1}]", RLMImportFormatJSON));
+    XCTAssertFalse(import(@"EmployeeObject", @"[{\"name\": {}, \"age\": 1, \"hired\": true}]", RLMImportFormatJSON));
+    XCTAssertFalse(import(@"EmployeeObject", @"[{\"name\": \"a\", \"age\": 1, \"hired\": true}", RLMImportFormatJSON));
+    XCTAssertFalse(import(@"EmployeeObject", @"name,age,hired\nJoe,40", RLMImportFormatCSV));
+    XCTAssertFalse(import(@"EmployeeObject", @"name,age,hired\nJoe,,true", RLMImportFormatCSV));
+    XCTAssertFalse(import(@"EmployeeObject", @"name,age,hired\n\"Joe,40,true", RLMImportFormatCSV));
+    XCTAssertFalse(import(@"OwnerObject", @"name,dog\nJoe,", RLMImportFormatCSV));
+    XCTAssertFalse(import(@"PrimaryStringObject", @"stringCol,intCol\na,1\na,2", RLMImportFormatCSV));
+    XCTAssertEqual(0U, [EmployeeObject allObjectsInRealm:realm].count);
+    XCTAssertEqual(0U, [PrimaryStringObject allObjectsInRealm:realm].count);
+
+    NSError *error;
+    XCTAssertFalse([realm importObjectsWithClassName:@"EmployeeObject"
+                                          fromStream:RLMStreamWithString(@"name,age,hired\nJoe,40,true\nJill,x,true")
+                                              format:RLMImportFormatCSV error:&error]);
+    XCTAssertEqual(RLMErrorFail, error.code);
+    XCTAssertNotEqual((NSUInteger)NSNotFound, [error.localizedDescription rangeOfString:@"line 3"].location);
+
+    [realm beginWriteTransaction];
+    XCTAssertThrows(import(@"EmployeeObject", @"[]", RLMImportFormatJSON));
+    [realm cancelWriteTransaction];
+    XCTAssertThrows(import(@"NotARealClass", @"[]", RLMImportFormatJSON));
+}
+
+- (void)testCopyObjectsFromRealm
+{
+    RLMRealm *source = [RLMRealm defaultRealm];
+    [source transactionWithBlock:^{
+        [OwnerObject createInRealm:source withValue:@[@"Tim", @[@"Fido", @5]]];
+        [OwnerObject createInRealm:source withValue:@[@"Ann", NSNull.null]];
+        [DogObject createInRealm:source withValue:@[@"Rex", @2]];
+        [PrimaryStringObject createInRealm:source withValue:@[@"a", @1]];
+    }];
+
+    RLMRealm *realm = [self realmWithTestPath];
+    [realm transactionWithBlock:^{
+        [DogObject createInRealm:realm withValue:@[@"Spot", @1]];
+    }];
+
+    NSError *error;
+    XCTAssertTrue([realm copyObjectsWithClassNames:@[@"OwnerObject", @"DogObject"] fromRealm:source error:&error]);
+    XCTAssertNil(error);
+
+    XCTAssertEqualObjects((@[@"Tim", @"Ann"]), [[OwnerObject allObjectsInRealm:realm] valueForKey:@"name"]);
+    XCTAssertEqualObjects((@[@"Spot", @"Fido", @"Rex"]), [[DogObject allObjectsInRealm:realm] valueForKey:@"dogName"]);
+    OwnerObject *owner = [OwnerObject allObjectsInRealm:realm].firstObject;
+    XCTAssertEqual(realm, owner.dog.realm);
+    XCTAssertEqualObjects(@"Fido", owner.dog.dogName);
+    XCTAssertEqual(5, owner.dog.age);
+    XCTAssertNil([[OwnerObject allObjectsInRealm:realm].lastObject dog]);
+
+    // Links to classes which aren't copied can't be remapped
+    XCTAssertFalse([realm copyObjectsWithClassNames:@[@"OwnerObject"] fromRealm:source error:&error]);
+    XCTAssertNotNil(error);
+    XCTAssertEqual(2U, [OwnerObject allObjectsInRealm:realm].count);
+
+    XCTAssertTrue([realm copyObjectsWithClassNames:@[@"PrimaryStringObject"] fromRealm:source error:nil]);
+    XCTAssertEqualObjects(@1, [PrimaryStringObject objectInRealm:realm forPrimaryKey:@"a"][@"intCol"]);
+
+    // Copying again would duplicate the primary key, and nothing is copied
+    error = nil;
+    XCTAssertFalse([realm copyObjectsWithClassNames:@[@"PrimaryStringObject", @"DogObject"] fromRealm:source error:&error]);
+    XCTAssertNotNil(error);
+    XCTAssertEqual(1U, [PrimaryStringObject allObjectsInRealm:realm].count);
+    XCTAssertEqual(3U, [DogObject allObjectsInRealm:realm].count);
+
+    XCTAssertFalse([realm copyObjectsWithClassNames:@[@"DogObject"] fromRealm:realm error:nil]);
+}
+
 #pragma mark - Transactions
 
 - (void)testRealmTransactionBlock {
@@ -582,61 +930,1007 @@ extern "C" {
     [realm transactionWithBlock:^{
         [StringObject createInRealm:realm withValue:@[@"b"]];
     }];
-    RLMResults *objects = [StringObject allObjectsInRealm:realm];
-    XCTAssertEqual(objects.count, 1U, @"Expecting 1 object");
-    XCTAssertEqualObjects([objects.firstObject stringCol], @"b", @"Expecting column to be 'b'");
+    RLMResults *objects = [StringObject allObjectsInRealm:realm];
+    XCTAssertEqual(objects.count, 1U, @"Expecting 1 object");
+    XCTAssertEqualObjects([objects.firstObject stringCol], @"b", @"Expecting column to be 'b'");
+}
+
+- (void)testGroupedTransactionBlock {
+    RLMRealm *realm = [self realmWithTestPath];
+    XCTAssertTrue([realm groupedTransactionWithBlock:^(RLMRealm *groupRealm) {
+        XCTAssertTrue(groupRealm.inWriteTransaction);
+        [IntObject createInRealm:groupRealm withValue:@[@1]];
+    } error:nil]);
+    XCTAssertFalse(realm.inWriteTransaction);
+    XCTAssertEqual(1U, [IntObject allObjectsInRealm:realm].count);
+
+    // Hold the write lock so that the background threads all queue up
+    [realm beginWriteTransaction];
+    XCTAssertThrows([realm groupedTransactionWithBlock:^(RLMRealm *) {} error:nil]);
+
+    dispatch_group_t group = dispatch_group_create();
+    for (int i = 0; i < 8; ++i) {
+        dispatch_group_async(group, dispatch_get_global_queue(0, 0), ^{
+            RLMRealm *realm = [self realmWithTestPath];
+            [realm groupedTransactionWithBlock:^(RLMRealm *groupRealm) {
+                [IntObject createInRealm:groupRealm withValue:@[@(i)]];
+            } error:nil];
+            XCTAssertEqual(1U, [IntObject objectsInRealm:realm where:@"intCol = %d", i].count);
+        });
+    }
+    [realm cancelWriteTransaction];
+    dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+
+    [realm refresh];
+    XCTAssertEqual(9U, [IntObject allObjectsInRealm:realm].count);
+}
+
+- (void)testGroupedTransactionBlockThrowing {
+    RLMRealm *realm = [self realmWithTestPath];
+    XCTAssertThrows([realm groupedTransactionWithBlock:^(RLMRealm *groupRealm) {
+        [IntObject createInRealm:groupRealm withValue:@[@1]];
+        @throw [NSException exceptionWithName:@"test" reason:@"failed" userInfo:nil];
+    } error:nil]);
+    XCTAssertFalse(realm.inWriteTransaction);
+    XCTAssertEqual(0U, [IntObject allObjectsInRealm:realm].count);
+
+    [realm beginWriteTransaction];
+    dispatch_group_t group = dispatch_group_create();
+    for (int i = 0; i < 4; ++i) {
+        dispatch_group_async(group, dispatch_get_global_queue(0, 0), ^{
+            RLMRealm *realm = [self realmWithTestPath];
+            void (^block)(RLMRealm *) = ^(RLMRealm *groupRealm) {
+                [IntObject createInRealm:groupRealm withValue:@[@(i)]];
+                if (i % 2) {
+                    @throw [NSException exceptionWithName:@"test" reason:@"failed" userInfo:nil];
+                }
+            };
+            if (i % 2) {
+                XCTAssertThrows([realm groupedTransactionWithBlock:block error:nil]);
+            }
+            else {
+                XCTAssertTrue([realm groupedTransactionWithBlock:block error:nil]);
+            }
+        });
+    }
+    [realm cancelWriteTransaction];
+    dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+
+    [realm refresh];
+    XCTAssertEqualObjects((@[@0, @2]),
+                          [[[IntObject allObjectsInRealm:realm] sortedResultsUsingProperty:@"intCol" ascending:YES] valueForKey:@"intCol"]);
+}
+
+- (void)testGroupedTransactionBlockThrowingBeforeWritingDoesNotRerunOthers {
+    RLMRealm *realm = [self realmWithTestPath];
+    __block int runs = 0;
+
+    [realm beginWriteTransaction];
+    dispatch_group_t group = dispatch_group_create();
+    for (int i = 0; i < 4; ++i) {
+        dispatch_group_async(group, dispatch_get_global_queue(0, 0), ^{
+            RLMRealm *realm = [self realmWithTestPath];
+            void (^block)(RLMRealm *) = ^(RLMRealm *groupRealm) {
+                if (i % 2) {
+                    @throw [NSException exceptionWithName:@"test" reason:@"failed" userInfo:nil];
+                }
+                @synchronized (self) {
+                    ++runs;
+                }
+                [IntObject createInRealm:groupRealm withValue:@[@(i)]];
+            };
+            if (i % 2) {
+                XCTAssertThrows([realm groupedTransactionWithBlock:block error:nil]);
+            }
+            else {
+                XCTAssertTrue([realm groupedTransactionWithBlock:block error:nil]);
+            }
+        });
+    }
+    [realm cancelWriteTransaction];
+    dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+
+    [realm refresh];
+    XCTAssertEqual(2U, [IntObject allObjectsInRealm:realm].count);
+    @synchronized (self) {
+        XCTAssertEqual(2, runs);
+    }
+}
+
+- (void)testAsyncTransactionBlock {
+    RLMRealm *realm = [self realmWithTestPath];
+
+    // Hold the write lock to show that the calling thread doesn't wait for it
+    [realm beginWriteTransaction];
+    [self dispatchAsyncAndWait:^{
+        RLMRealm *realm = [self realmWithTestPath];
+        [realm asyncTransactionWithBlock:^(RLMRealm *writerRealm) {
+            XCTAssertTrue(writerRealm.inWriteTransaction);
+            [IntObject createInRealm:writerRealm withValue:@[@1]];
+        } completion:nil];
+    }];
+    [realm cancelWriteTransaction];
+
+    XCTestExpectation *expectation = [self expectationWithDescription:@"write completed"];
+    [realm asyncTransactionWithBlock:^(RLMRealm *writerRealm) {
+        XCTAssertNotEqual(realm, writerRealm);
+        [IntObject createInRealm:writerRealm withValue:@[@2]];
+    } completion:^(NSError *error) {
+        XCTAssertNil(error);
+        XCTAssertFalse(realm.inWriteTransaction);
+        XCTAssertEqual(2U, [IntObject allObjectsInRealm:realm].count);
+        [expectation fulfill];
+    }];
+    XCTAssertEqual(0U, [IntObject allObjectsInRealm:realm].count);
+    [self waitForExpectationsWithTimeout:2.0 handler:nil];
+}
+
+- (void)testAsyncTransactionBlockReleasingLastRealmOnWriterThread {
+    dispatch_semaphore_t sema = dispatch_semaphore_create(0);
+    [self dispatchAsyncAndWait:^{
+        @autoreleasepool {
+            RLMRealm *realm = [self realmWithTestPath];
+            [realm asyncTransactionWithBlock:^(RLMRealm *writerRealm) {
+                // Wait for the calling thread to release the Realm so that
+                // the reference held by this block is the last one, and
+                // releasing it destroys the writer on its own thread
+                dispatch_semaphore_wait(sema, DISPATCH_TIME_FOREVER);
+                XCTAssertNotNil(realm);
+                [IntObject createInRealm:writerRealm withValue:@[@1]];
+            } completion:nil];
+        }
+    }];
+    dispatch_semaphore_signal(sema);
+
+    RLMRealm *realm = [self realmWithTestPath];
+    for (int i = 0; i < 200 && [IntObject allObjectsInRealm:realm].count == 0; ++i) {
+        usleep(10000);
+        [realm refresh];
+    }
+    XCTAssertEqual(1U, [IntObject allObjectsInRealm:realm].count);
+
+    // A new writer is started for later writes
+    XCTestExpectation *expectation = [self expectationWithDescription:@"write completed"];
+    [realm asyncTransactionWithBlock:^(RLMRealm *writerRealm) {
+        [IntObject createInRealm:writerRealm withValue:@[@2]];
+    } completion:^(NSError *error) {
+        XCTAssertNil(error);
+        XCTAssertEqual(2U, [IntObject allObjectsInRealm:realm].count);
+        [expectation fulfill];
+    }];
+    [self waitForExpectationsWithTimeout:2.0 handler:nil];
+}
+
+- (void)testAsyncTransactionBlockThrowing {
+    RLMRealm *realm = [self realmWithTestPath];
+    XCTestExpectation *expectation = [self expectationWithDescription:@"write completed"];
+    [realm asyncTransactionWithBlock:^(RLMRealm *writerRealm) {
+        [IntObject createInRealm:writerRealm withValue:@[@1]];
+        @throw [NSException exceptionWithName:@"test" reason:@"failed" userInfo:nil];
+    } completion:^(NSError *error) {
+        XCTAssertEqualObjects(@"failed", error.localizedDescription);
+        XCTAssertEqual(0U, [IntObject allObjectsInRealm:realm].count);
+        [expectation fulfill];
+    }];
+    [self waitForExpectationsWithTimeout:2.0 handler:nil];
+}
+
+- (void)testWriteBehind {
+    RLMRealm *realm = [self realmWithTestPath];
+
+    // Hold the write lock so that the writes from every thread pile up
+    [realm beginWriteTransaction];
+    for (int i = 0; i < 4; ++i) {
+        [self dispatchAsyncAndWait:^{
+            RLMRealm *realm = [self realmWithTestPath];
+            for (int j = 0; j < 10; ++j) {
+                [realm writeBehind:^(RLMRealm *writerRealm) {
+                    XCTAssertTrue(writerRealm.inWriteTransaction);
+                    [IntObject createInRealm:writerRealm withValue:@[@(i * 10 + j)]];
+                }];
+            }
+        }];
+    }
+    [realm writeBehind:^(RLMRealm *writerRealm) {
+        @throw [NSException exceptionWithName:@"test" reason:@"failed" userInfo:nil];
+    }];
+    [realm writeBehind:^(RLMRealm *writerRealm) {
+        [IntObject createInRealm:writerRealm withValue:@[@40]];
+    }];
+    XCTAssertEqual(0U, [IntObject allObjectsInRealm:realm].count);
+    [realm cancelWriteTransaction];
+
+    // The failed write doesn't take the others in its transaction with it
+    NSError *error;
+    XCTAssertFalse([realm flushWriteBehind:&error]);
+    XCTAssertEqualObjects(@"failed", error.localizedDescription);
+    XCTAssertEqual(41U, [IntObject allObjectsInRealm:realm].count);
+    XCTAssertEqual(40, [[[IntObject allObjectsInRealm:realm] maxOfProperty:@"intCol"] intValue]);
+
+    // Each flush only reports the errors since the previous one
+    [realm writeBehind:^(RLMRealm *writerRealm) {
+        [IntObject createInRealm:writerRealm withValue:@[@41]];
+    }];
+    XCTAssertTrue([realm flushWriteBehind:&error]);
+    XCTAssertEqual(42U, [IntObject allObjectsInRealm:realm].count);
+}
+
+- (void)testWriteBehindOnlyRerunsWritesRolledBackByAFailure {
+    // The long delay makes the writer wait for the flush, so that each group
+    // of writes below is performed as a single batch
+    RLMRealmConfiguration *config = [RLMRealmConfiguration defaultConfiguration];
+    config.path = RLMTestRealmPath();
+    config.writeBehindDelay = 60;
+    RLMRealm *realm = [RLMRealm realmWithConfiguration:config error:nil];
+    __block int beforeFailureRuns = 0, afterFailureRuns = 0;
+
+    [realm writeBehind:^(RLMRealm *writerRealm) {
+        ++beforeFailureRuns;
+        [IntObject createInRealm:writerRealm withValue:@[@1]];
+    }];
+    [realm writeBehind:^(RLMRealm *writerRealm) {
+        [IntObject createInRealm:writerRealm withValue:@[@2]];
+        @throw [NSException exceptionWithName:@"test" reason:@"failed" userInfo:nil];
+    }];
+    [realm writeBehind:^(RLMRealm *writerRealm) {
+        ++afterFailureRuns;
+        [IntObject createInRealm:writerRealm withValue:@[@3]];
+    }];
+
+    XCTAssertFalse([realm flushWriteBehind:nil]);
+    XCTAssertEqual(2, beforeFailureRuns);
+    XCTAssertEqual(1, afterFailureRuns);
+    XCTAssertEqualObjects((@[@1, @3]),
+                          [[[IntObject allObjectsInRealm:realm] sortedResultsUsingProperty:@"intCol" ascending:YES] valueForKey:@"intCol"]);
+
+    // A write which fails without making changes doesn't roll back the others
+    beforeFailureRuns = 0;
+    [realm writeBehind:^(RLMRealm *writerRealm) {
+        ++beforeFailureRuns;
+        [IntObject createInRealm:writerRealm withValue:@[@4]];
+    }];
+    [realm writeBehind:^(RLMRealm *) {
+        @throw [NSException exceptionWithName:@"test" reason:@"failed" userInfo:nil];
+    }];
+
+    XCTAssertFalse([realm flushWriteBehind:nil]);
+    XCTAssertEqual(1, beforeFailureRuns);
+    XCTAssertEqual(3U, [IntObject allObjectsInRealm:realm].count);
+}
+
+- (void)testTransactionMetrics {
+    RLMRealm *realm = [self realmWithTestPath];
+    [realm resetTransactionMetrics];
+
+    for (int i = 0; i < 3; ++i) {
+        [realm transactionWithBlock:^{
+            [IntObject createInRealm:realm withValue:@[@(i)]];
+        }];
+    }
+    [realm beginWriteTransaction];
+    [realm cancelWriteTransaction];
+
+    [self dispatchAsyncAndWait:^{
+        RLMRealm *realm = [self realmWithTestPath];
+        [realm transactionWithBlock:^{
+            [IntObject createInRealm:realm withValue:@[@3]];
+        }];
+    }];
+    [realm refresh];
+
+    RLMTransactionMetrics *metrics = realm.transactionMetrics;
+    XCTAssertEqual(4U, metrics.lockWait.count);
+    XCTAssertEqual(0U, metrics.lockWaitAndAdvance.count);
+    XCTAssertEqual(3U, metrics.commit.count);
+    XCTAssertEqual(1U, metrics.advance.count);
+    XCTAssertEqual(1U, metrics.didChange.count);
+    XCTAssertEqual(0U, metrics.notify.count);
+    XCTAssertEqual(1U, metrics.cancelledTransactions);
+    XCTAssertEqual(1U, metrics.versionsAdvanced);
+    XCTAssertGreaterThan(metrics.bytesCommitted, 0ULL);
+
+    // Querying and reading objects counts the evaluations and accessors
+    NSUInteger accessorsCreated = metrics.accessorsCreated;
+    XCTAssertEqual(3, [[IntObject objectsInRealm:realm where:@"intCol = 3"].firstObject intCol]);
+    metrics = realm.transactionMetrics;
+    XCTAssertEqual(accessorsCreated + 1, metrics.accessorsCreated);
+    XCTAssertEqual(1U, metrics.resultsEvaluation.count);
+
+    RLMDurationHistogram *commit = metrics.commit;
+    XCTAssertGreaterThan(commit.totalDuration, 0.0);
+    XCTAssertGreaterThanOrEqual(commit.totalDuration, commit.maxDuration);
+    XCTAssertGreaterThanOrEqual([commit durationAtPercentile:100], [commit durationAtPercentile:50]);
+    XCTAssertLessThanOrEqual([commit durationAtPercentile:100], commit.maxDuration);
+    XCTAssertEqualObjects(@3, [commit.bucketCounts valueForKeyPath:@"@sum.self"]);
+
+    [realm resetTransactionMetrics];
+    XCTAssertEqual(0U, realm.transactionMetrics.commit.count);
+    XCTAssertEqual(0.0, [realm.transactionMetrics.commit durationAtPercentile:50]);
+
+    // Being notified of a commit on another thread records how long that took
+    [self waitForNotification:RLMRealmDidChangeNotification realm:realm block:^{
+        [self dispatchAsyncAndWait:^{
+            RLMRealm *realm = [self realmWithTestPath];
+            [realm transactionWithBlock:^{
+                [IntObject createInRealm:realm withValue:@[@4]];
+            }];
+        }];
+    }];
+    metrics = realm.transactionMetrics;
+    XCTAssertEqual(1U, metrics.notify.count);
+    XCTAssertGreaterThan(metrics.notify.maxDuration, 0.0);
+    XCTAssertEqual(1U, metrics.advance.count);
+    XCTAssertEqual(1U, metrics.didChange.count);
+    XCTAssertLessThanOrEqual(metrics.didChange.totalDuration, metrics.advance.totalDuration);
+}
+
+- (void)testFileSpaceUsage {
+    RLMRealm *realm = [self realmWithTestPath];
+    [realm transactionWithBlock:^{
+        for (int i = 0; i < 100; ++i) {
+            [IndexedStringObject createInRealm:realm withValue:@[[NSString stringWithFormat:@"string %d", i]]];
+        }
+    }];
+
+    RLMFileSpaceUsage *usage = realm.fileSpaceUsage;
+    XCTAssertEqual(usage.fileSize, usage.freeSize + usage.usedSize);
+    XCTAssertGreaterThanOrEqual(usage.versionCount, 1ULL);
+    XCTAssertGreaterThan([usage.classSizes[@"IndexedStringObject"] unsignedLongLongValue], 0ULL);
+    XCTAssertNotNil(usage.classSizes[@"StringObject"]);
+    XCTAssertGreaterThan([usage.indexSizes[@"IndexedStringObject"][@"stringCol"] unsignedLongLongValue], 0ULL);
+    XCTAssertNil(usage.indexSizes[@"StringObject"]);
+
+    // Deleting everything leaves the table empty and the space free or pinned
+    [realm transactionWithBlock:^{
+        [realm deleteAllObjects];
+    }];
+    RLMFileSpaceUsage *after = realm.fileSpaceUsage;
+    XCTAssertLessThan([after.classSizes[@"IndexedStringObject"] unsignedLongLongValue],
+                      [usage.classSizes[@"IndexedStringObject"] unsignedLongLongValue]);
+}
+
+- (void)testIndexRecommendations {
+    RLMRealmConfiguration *configuration = [RLMRealmConfiguration defaultConfiguration];
+    configuration.path = RLMTestRealmPath();
+    configuration.recordsQueryWorkload = YES;
+    RLMRealm *realm = [RLMRealm realmWithConfiguration:configuration error:nil];
+    XCTAssertEqual(0U, realm.indexRecommendations.count);
+
+    [realm transactionWithBlock:^{
+        for (int i = 0; i < 100; ++i) {
+            [IntObject createInRealm:realm withValue:@[@(i)]];
+            [IndexedEventObject createInRealm:realm withValue:@[@(i), [NSDate dateWithTimeIntervalSince1970:i]]];
+        }
+    }];
+    for (int i = 0; i < 5; ++i) {
+        XCTAssertEqual(1U, [IntObject objectsInRealm:realm where:@"intCol = %d", i].count);
+        XCTAssertEqual(1U, [IndexedEventObject objectsInRealm:realm where:@"sequence = %d", i].count);
+    }
+
+    NSArray *recommendations = [realm indexRecommendationsWithMinimumQueryCount:5 minimumObjectsScanned:50];
+    XCTAssertEqual(2U, recommendations.count);
+    RLMIndexRecommendation *add = [recommendations filteredArrayUsingPredicate:
+                                   [NSPredicate predicateWithFormat:@"action = %d", RLMIndexRecommendationActionAdd]].firstObject;
+    XCTAssertEqualObjects(@"IntObject", add.className);
+    XCTAssertEqualObjects(@"intCol", add.propertyName);
+    XCTAssertEqual(5U, add.queryCount);
+    XCTAssertEqual(500U, add.objectsScanned);
+    RLMIndexRecommendation *remove = [recommendations filteredArrayUsingPredicate:
+                                      [NSPredicate predicateWithFormat:@"action = %d", RLMIndexRecommendationActionRemove]].firstObject;
+    XCTAssertEqualObjects(@"IndexedEventObject", remove.className);
+    XCTAssertEqualObjects(@"timestamp", remove.propertyName);
+    XCTAssertEqual(5U, remove.queryCount);
+
+    // Too few queries over too few objects for the default thresholds
+    XCTAssertEqual(0U, [realm indexRecommendationsWithMinimumQueryCount:6 minimumObjectsScanned:50].count);
+    XCTAssertEqual(0U, realm.indexRecommendations.count);
+
+    [realm resetQueryWorkload];
+    XCTAssertEqual(0U, [realm indexRecommendationsWithMinimumQueryCount:1 minimumObjectsScanned:1].count);
+
+    // Nothing is recorded unless the configuration asks for it
+    RLMRealm *unrecorded = [self inMemoryRealmWithIdentifier:@"unrecorded"];
+    XCTAssertEqual(0U, [IntObject objectsInRealm:unrecorded where:@"intCol = 1"].count);
+    XCTAssertEqual(0U, [unrecorded indexRecommendationsWithMinimumQueryCount:1 minimumObjectsScanned:1].count);
+}
+
+- (void)testInWriteTransaction {
+    RLMRealm *realm = [self realmWithTestPath];
+    XCTAssertFalse(realm.inWriteTransaction);
+    [realm beginWriteTransaction];
+    XCTAssertTrue(realm.inWriteTransaction);
+    [realm cancelWriteTransaction];
+    [realm transactionWithBlock:^{
+        XCTAssertTrue(realm.inWriteTransaction);
+        [realm cancelWriteTransaction];
+        XCTAssertFalse(realm.inWriteTransaction);
+    }];
+
+    [realm beginWriteTransaction];
+    [realm invalidate];
+    XCTAssertFalse(realm.inWriteTransaction);
+}
+
+- (void)testAutorefreshAfterBackgroundUpdate {
+    RLMRealm *realm = [self realmWithTestPath];
+
+    XCTAssertEqual(0U, [StringObject allObjectsInRealm:realm].count);
+
+    [self waitForNotification:RLMRealmDidChangeNotification realm:realm block:^{
+        RLMRealm *realm = [self realmWithTestPath];
+        [realm beginWriteTransaction];
+        [StringObject createInRealm:realm withValue:@[@"string"]];
+        [realm commitWriteTransaction];
+    }];
+
+    XCTAssertEqual(1U, [StringObject allObjectsInRealm:realm].count);
+}
+
+- (void)testBackgroundUpdateWithoutAutorefresh {
+    RLMRealm *realm = [self realmWithTestPath];
+    realm.autorefresh = NO;
+
+    XCTAssertEqual(0U, [StringObject allObjectsInRealm:realm].count);
+
+    [self waitForNotification:RLMRealmRefreshRequiredNotification realm:realm block:^{
+        RLMRealm *realm = [self realmWithTestPath];
+        [realm beginWriteTransaction];
+        [StringObject createInRealm:realm withValue:@[@"string"]];
+        [realm commitWriteTransaction];
+
+        XCTAssertEqual(1U, [StringObject allObjectsInRealm:realm].count);
+    }];
+
+    XCTAssertEqual(0U, [StringObject allObjectsInRealm:realm].count);
+
+    [realm refresh];
+    XCTAssertEqual(1U, [StringObject allObjectsInRealm:realm].count);
+}
+
+- (void)testCachedPropertyValues {
+    RLMRealmConfiguration *configuration = [RLMRealmConfiguration defaultConfiguration];
+    configuration.path = RLMTestRealmPath();
+    configuration.cachedPropertyValueMinimumSize = 10;
+    RLMRealm *realm = [RLMRealm realmWithConfiguration:configuration error:nil];
+    XCTAssertEqual(10U, realm.configuration.cachedPropertyValueMinimumSize);
+
+    [realm beginWriteTransaction];
+    StringObject *obj = [StringObject createInRealm:realm withValue:@[@"a long string value"]];
+    NSString *inWrite = obj.stringCol;
+    XCTAssertEqualObjects(@"a long string value", inWrite);
+    [realm commitWriteTransaction];
+
+    NSString *first = obj.stringCol;
+    XCTAssertEqualObjects(@"a long string value", first);
+    XCTAssertEqual(first, obj.stringCol);
+    XCTAssertEqual(first, [[StringObject allObjectsInRealm:realm].firstObject stringCol]);
+
+    // Writing advances the version, so the new value is read
+    [realm transactionWithBlock:^{
+        obj.stringCol = @"another long string";
+    }];
+    XCTAssertEqualObjects(@"another long string", obj.stringCol);
+    XCTAssertEqual(obj.stringCol, obj.stringCol);
+
+    [self dispatchAsyncAndWait:^{
+        RLMRealm *realm = [RLMRealm realmWithConfiguration:configuration error:nil];
+        [realm transactionWithBlock:^{
+            [[StringObject allObjectsInRealm:realm].firstObject setStringCol:@"from another thread"];
+        }];
+    }];
+    [realm refresh];
+    XCTAssertEqualObjects(@"from another thread", obj.stringCol);
+}
+
+- (void)testReusedObjectAccessors {
+    RLMRealmConfiguration *configuration = [RLMRealmConfiguration defaultConfiguration];
+    configuration.path = RLMTestRealmPath();
+    configuration.reusesObjectAccessors = YES;
+    RLMRealm *realm = [RLMRealm realmWithConfiguration:configuration error:nil];
+    XCTAssertTrue(realm.configuration.reusesObjectAccessors);
+
+    [realm beginWriteTransaction];
+    CompanyObject *company = [CompanyObject createInRealm:realm withValue:@[@"company", @[@[@"a", @30, @YES],
+                                                                                         @[@"b", @40, @YES],
+                                                                                         @[@"c", @50, @NO]]]];
+    [realm commitWriteTransaction];
+
+    RLMResults *employees = [EmployeeObject allObjectsInRealm:realm];
+    EmployeeObject *first = employees[0];
+    XCTAssertEqual(first, employees[0]);
+    XCTAssertEqual(first, company.employees[0]);
+    XCTAssertEqual(first, employees.firstObject);
+    for (EmployeeObject *employee in employees) {
+        XCTAssertEqual(employee, company.employees[[employees indexOfObject:employee]]);
+    }
+
+    // Deleting an object moves the last row into its place, and the accessor
+    // for that row is still found after the move
+    EmployeeObject *last = employees.lastObject;
+    [realm transactionWithBlock:^{
+        [realm deleteObject:first];
+    }];
+    XCTAssertEqual(last, employees[0]);
+    XCTAssertEqualObjects(@"c", [employees[0] name]);
+
+    // As are rows moved by other threads
+    [self dispatchAsyncAndWait:^{
+        RLMRealm *realm = [RLMRealm realmWithConfiguration:configuration error:nil];
+        [realm transactionWithBlock:^{
+            [realm deleteObject:[EmployeeObject objectsInRealm:realm where:@"name = 'c'"].firstObject];
+        }];
+    }];
+    EmployeeObject *second = [EmployeeObject objectsInRealm:realm where:@"name = 'b'"].firstObject;
+    [realm refresh];
+    XCTAssertEqual(1U, employees.count);
+    XCTAssertEqual(second, employees[0]);
+    XCTAssertTrue(last.invalidated);
+
+    // Without the option each read creates a new accessor
+    configuration.inMemoryIdentifier = @"separate accessors";
+    configuration.reusesObjectAccessors = NO;
+    realm = [RLMRealm realmWithConfiguration:configuration error:nil];
+    [realm transactionWithBlock:^{
+        [EmployeeObject createInRealm:realm withValue:@[@"a", @30, @YES]];
+    }];
+    employees = [EmployeeObject allObjectsInRealm:realm];
+    XCTAssertNotEqual(employees[0], employees[0]);
+}
+
+- (void)testReusedObjectAccessorsFollowRowsMovedWithinAWriteTransaction {
+    RLMRealmConfiguration *configuration = [RLMRealmConfiguration defaultConfiguration];
+    configuration.path = RLMTestRealmPath();
+    configuration.reusesObjectAccessors = YES;
+    RLMRealm *realm = [RLMRealm realmWithConfiguration:configuration error:nil];
+
+    [realm beginWriteTransaction];
+    for (int i = 0; i < 5; ++i) {
+        [IntObject createInRealm:realm withValue:@[@(i)]];
+    }
+    RLMResults *objects = [IntObject allObjectsInRealm:realm];
+    IntObject *third = objects[2];
+    IntObject *last = objects[4];
+
+    // Each deletion moves the last row into the deleted row's place without
+    // the version changing, and both the moved and the untouched accessors
+    // are still found by their new rows
+    [realm deleteObject:objects[0]];
+    XCTAssertEqual(last, objects[0]);
+    XCTAssertEqual(third, objects[2]);
+    [realm deleteObject:objects[1]];
+    XCTAssertEqual(last, objects[0]);
+    XCTAssertEqual(third, objects[2]);
+    XCTAssertEqual(4, [objects[0] intCol]);
+    XCTAssertEqual(3, [objects[1] intCol]);
+    XCTAssertEqual(2, [objects[2] intCol]);
+
+    // Accessors created after a move are keyed by their current row
+    IntObject *second = objects[1];
+    [realm deleteObject:last];
+    XCTAssertEqual(third, objects[0]);
+    XCTAssertEqual(second, objects[1]);
+    [realm commitWriteTransaction];
+
+    XCTAssertEqual(2U, objects.count);
+    XCTAssertEqual(third, objects[0]);
+    XCTAssertEqual(second, objects[1]);
+}
+
+- (void)testAccessorClassesAreSharedBetweenThreads {
+    RLMRealm *realm = [self realmWithTestPath];
+    __block Class backgroundClass;
+    [self dispatchAsyncAndWait:^{
+        RLMRealm *realm = [self realmWithTestPath];
+        backgroundClass = realm.schema[StringObject.className].accessorClass;
+    }];
+
+    Class accessorClass = realm.schema[StringObject.className].accessorClass;
+    XCTAssertEqual(accessorClass, backgroundClass);
+    XCTAssertTrue([NSStringFromClass(accessorClass) hasPrefix:@"RLMAccessor_"]);
+    XCTAssertEqualObjects(StringObject.className, [accessorClass className]);
+
+    [realm beginWriteTransaction];
+    StringObject *obj = [StringObject createInRealm:realm withValue:@[@"a"]];
+    [realm commitWriteTransaction];
+    XCTAssertEqual(accessorClass, obj.class);
+    XCTAssertEqualObjects(@"a", obj.stringCol);
+}
+
+- (void)testPrefetchingOnOpen {
+    @autoreleasepool {
+        RLMRealm *realm = [self realmWithTestPath];
+        [realm transactionWithBlock:^{
+            for (int i = 0; i < 1000; ++i) {
+                [StringObject createInRealm:realm withValue:@[@"string"]];
+                [IntObject createInRealm:realm withValue:@[@(i)]];
+            }
+        }];
+    }
+
+    RLMRealmConfiguration *configuration = [RLMRealmConfiguration defaultConfiguration];
+    configuration.path = RLMTestRealmPath();
+    configuration.prefetchObjectClasses = @[StringObject.class, IntObject.class, ArrayPropertyObject.class];
+    RLMRealm *realm = [RLMRealm realmWithConfiguration:configuration error:nil];
+    XCTAssertEqual(1000U, [StringObject allObjectsInRealm:realm].count);
+    XCTAssertEqual(499500, [[IntObject allObjectsInRealm:realm] sumOfProperty:@"intCol"].intValue);
+
+    // Writes made while the prefetcher is reading are unaffected by it
+    [realm transactionWithBlock:^{
+        [IntObject createInRealm:realm withValue:@[@1]];
+    }];
+    XCTAssertEqual(1001U, [IntObject allObjectsInRealm:realm].count);
+}
+
+- (void)testDeferredIndexCreation {
+    @autoreleasepool {
+        RLMObjectSchema *objectSchema = [RLMObjectSchema schemaForObjectClass:IndexedStringObject.class];
+        [objectSchema.properties[0] setIndexed:NO];
+        RLMSchema *schema = [[RLMSchema alloc] init];
+        schema.objectSchema = @[objectSchema];
+
+        RLMRealmConfiguration *configuration = [RLMRealmConfiguration defaultConfiguration];
+        configuration.path = RLMTestRealmPath();
+        configuration.customSchema = schema;
+        RLMRealm *realm = [RLMRealm realmWithConfiguration:configuration error:nil];
+        [realm transactionWithBlock:^{
+            for (int i = 0; i < 100; ++i) {
+                [IndexedStringObject createInRealm:realm withValue:@[[NSString stringWithFormat:@"%d", i]]];
+            }
+        }];
+    }
+
+    XCTestExpectation *expectation = [self expectationWithDescription:@"indexes added"];
+    RLMRealmConfiguration *configuration = [RLMRealmConfiguration defaultConfiguration];
+    configuration.path = RLMTestRealmPath();
+    configuration.deferIndexCreation = YES;
+    configuration.indexCreationBlock = ^(NSError *error) {
+        XCTAssertNil(error);
+        [expectation fulfill];
+    };
+    RLMRealm *realm = [RLMRealm realmWithConfiguration:configuration error:nil];
+
+    // Queries are correct whether or not the index has been added yet
+    XCTAssertEqual(1U, [IndexedStringObject objectsInRealm:realm where:@"stringCol = '42'"].count);
+    [self waitForExpectationsWithTimeout:2.0 handler:nil];
+
+    RLMObjectSchema *objectSchema = realm.schema[IndexedStringObject.className];
+    XCTAssertTrue(objectSchema.table->has_search_index([objectSchema[@"stringCol"] column]));
+    XCTAssertEqual(1U, [IndexedStringObject objectsInRealm:realm where:@"stringCol = '42'"].count);
+}
+
+- (void)testAutorefreshAdvancesInBoundedSteps {
+    RLMRealmConfiguration *configuration = [RLMRealmConfiguration defaultConfiguration];
+    configuration.path = RLMTestRealmPath();
+    configuration.autorefreshVersionLimit = 1;
+    RLMRealm *realm = [RLMRealm realmWithConfiguration:configuration error:nil];
+    XCTAssertEqual(0U, [StringObject allObjectsInRealm:realm].count);
+
+    [self dispatchAsyncAndWait:^{
+        RLMRealm *realm = [self realmWithTestPath];
+        for (int i = 0; i < 3; ++i) {
+            [realm transactionWithBlock:^{
+                [StringObject createInRealm:realm withValue:@[@"string"]];
+            }];
+        }
+    }];
+
+    // Each commit is delivered in its own notification rather than all at once
+    NSMutableArray *counts = [NSMutableArray array];
+    XCTestExpectation *expectation = [self expectationWithDescription:@"advanced to newest version"];
+    RLMNotificationToken *token = [realm addNotificationBlock:^(NSString *note, RLMRealm *realm) {
+        if (note == RLMRealmDidChangeNotification) {
+            [counts addObject:@([StringObject allObjectsInRealm:realm].count)];
+            if (counts.count == 3) {
+                [expectation fulfill];
+            }
+        }
+    }];
+    [self waitForExpectationsWithTimeout:2.0 handler:nil];
+    [realm removeNotification:token];
+
+    XCTAssertEqualObjects((@[@1, @2, @3]), counts);
+}
+
+- (void)testComputeChangesInBackground {
+    RLMRealmConfiguration *configuration = [RLMRealmConfiguration defaultConfiguration];
+    configuration.path = RLMTestRealmPath();
+    configuration.computeChangesInBackground = YES;
+    RLMRealm *realm = [RLMRealm realmWithConfiguration:configuration error:nil];
+    RLMResults *results = [StringObject allObjectsInRealm:realm];
+    XCTAssertEqual(0U, results.count);
+
+    for (int i = 1; i <= 3; ++i) {
+        XCTestExpectation *expectation = [self expectationWithDescription:@"commit delivered"];
+        RLMNotificationToken *token = [realm addNotificationBlock:^(NSString *note, RLMRealm *realm) {
+            if (note == RLMRealmDidChangeNotification) {
+                [expectation fulfill];
+            }
+        }];
+        [self dispatchAsync:^{
+            RLMRealm *realm = [self realmWithTestPath];
+            [realm transactionWithBlock:^{
+                [StringObject createInRealm:realm withValue:@[@"string"]];
+            }];
+        }];
+        [self waitForExpectationsWithTimeout:2.0 handler:nil];
+        [realm removeNotification:token];
+        XCTAssertEqual((NSUInteger)i, results.count);
+    }
+}
+
+- (void)testObservedObjectClassesFilterNotifications {
+    RLMRealmConfiguration *configuration = [RLMRealmConfiguration defaultConfiguration];
+    configuration.path = RLMTestRealmPath();
+    configuration.observedObjectClasses = @[StringObject.class];
+    RLMRealm *realm = [RLMRealm realmWithConfiguration:configuration error:nil];
+
+    __block NSUInteger notificationCount = 0;
+    XCTestExpectation *expectation = [self expectationWithDescription:@"observed commit delivered"];
+    RLMNotificationToken *token = [realm addNotificationBlock:^(NSString *note, RLMRealm *realm) {
+        if (note == RLMRealmDidChangeNotification) {
+            ++notificationCount;
+            [expectation fulfill];
+        }
+    }];
+
+    [self dispatchAsyncAndWait:^{
+        RLMRealm *realm = [self realmWithTestPath];
+        [realm transactionWithBlock:^{
+            [IntObject createInRealm:realm withValue:@[@1]];
+        }];
+    }];
+    // Deliver the commit which only touched an unobserved class
+    [realm refresh];
+    XCTAssertEqual(1U, [IntObject allObjectsInRealm:realm].count);
+    XCTAssertEqual(0U, notificationCount);
+
+    [self dispatchAsync:^{
+        RLMRealm *realm = [self realmWithTestPath];
+        [realm transactionWithBlock:^{
+            [StringObject createInRealm:realm withValue:@[@"string"]];
+        }];
+    }];
+    [self waitForExpectationsWithTimeout:2.0 handler:nil];
+    XCTAssertEqual(1U, notificationCount);
+    [realm removeNotification:token];
+}
+
+- (void)testLastChangeDescribesNotification {
+    RLMRealm *realm = self.realmWithTestPath;
+    realm.autorefresh = NO;
+    XCTAssertNil(realm.lastChange);
+
+    __block RLMRealmChange *change;
+    RLMNotificationToken *token = [realm addNotificationBlock:^(NSString *note, RLMRealm *realm) {
+        if (note == RLMRealmDidChangeNotification) {
+            change = realm.lastChange;
+        }
+    }];
+
+    [self dispatchAsyncAndWait:^{
+        RLMRealm *realm = [self realmWithTestPath];
+        for (int i = 0; i < 2; ++i) {
+            [realm transactionWithBlock:^{
+                [IntObject createInRealm:realm withValue:@[@(i)]];
+            }];
+        }
+    }];
+    [realm refresh];
+    XCTAssertNotNil(change);
+    XCTAssertEqual(2ULL, change.commitCount);
+    XCTAssertEqual(change.oldVersion + 2, change.newVersion);
+    XCTAssertEqualObjects([NSSet setWithObject:@"IntObject"], change.modifiedClassNames);
+
+    uint64_t version = change.newVersion;
+    [realm transactionWithBlock:^{
+        [StringObject createInRealm:realm withValue:@[@"string"]];
+    }];
+    XCTAssertEqual(1ULL, change.commitCount);
+    XCTAssertEqual(version + 1, change.newVersion);
+    XCTAssertNil(change.modifiedClassNames);
+
+    [realm removeNotification:token];
+}
+
+- (void)testMinimumNotificationIntervalCoalescesCommits {
+    RLMRealmConfiguration *configuration = [RLMRealmConfiguration defaultConfiguration];
+    configuration.path = RLMTestRealmPath();
+    configuration.minimumNotificationInterval = 0.25;
+    RLMRealm *realm = [RLMRealm realmWithConfiguration:configuration error:nil];
+
+    __block NSUInteger notificationCount = 0;
+    XCTestExpectation *expectation = [self expectationWithDescription:@"all commits delivered"];
+    RLMNotificationToken *token = [realm addNotificationBlock:^(NSString *note, RLMRealm *realm) {
+        if (note == RLMRealmDidChangeNotification) {
+            ++notificationCount;
+            if ([StringObject allObjectsInRealm:realm].count == 50) {
+                [expectation fulfill];
+            }
+        }
+    }];
+
+    [self dispatchAsync:^{
+        RLMRealm *realm = [self realmWithTestPath];
+        for (int i = 0; i < 50; ++i) {
+            [realm transactionWithBlock:^{
+                [StringObject createInRealm:realm withValue:@[@"string"]];
+            }];
+        }
+    }];
+    [self waitForExpectationsWithTimeout:2.0 handler:nil];
+    [realm removeNotification:token];
+
+    // The first commit is delivered immediately and the rest at most once per interval
+    XCTAssertLessThanOrEqual(notificationCount, 4U);
+}
+
+- (void)testNotificationsAreDeliveredInConfiguredRunLoopModes {
+    NSString *trackingMode = @"RLMTestTrackingRunLoopMode";
+    RLMRealmConfiguration *configuration = [RLMRealmConfiguration defaultConfiguration];
+    configuration.path = RLMTestRealmPath();
+    configuration.notificationRunLoopModes = @[NSDefaultRunLoopMode, trackingMode];
+    configuration.notificationQualityOfService = NSQualityOfServiceUserInteractive;
+    RLMRealm *realm = [RLMRealm realmWithConfiguration:configuration error:nil];
+
+    __block bool notified = false;
+    RLMNotificationToken *token = [realm addNotificationBlock:^(NSString *note, __unused RLMRealm *realm) {
+        if (note == RLMRealmDidChangeNotification) {
+            notified = true;
+        }
+    }];
+
+    [self dispatchAsyncAndWait:^{
+        RLMRealm *realm = [self realmWithTestPath];
+        [realm transactionWithBlock:^{
+            [StringObject createInRealm:realm withValue:@[@"string"]];
+        }];
+    }];
+
+    // Run the runloop only in the non-default mode, as it would be while a
+    // scroll view is tracking
+    NSDate *timeout = [NSDate dateWithTimeIntervalSinceNow:2.0];
+    while (!notified && [timeout timeIntervalSinceNow] > 0) {
+        [NSRunLoop.currentRunLoop runMode:trackingMode beforeDate:[NSDate dateWithTimeIntervalSinceNow:0.05]];
+    }
+    XCTAssertTrue(notified);
+    XCTAssertEqual(1U, [StringObject allObjectsInRealm:realm].count);
+    [realm removeNotification:token];
+}
+
+- (void)testCacheEvictsLeastRecentlyAccessedObjects {
+    RLMRealmConfiguration *configuration = [RLMRealmConfiguration defaultConfiguration];
+    configuration.inMemoryIdentifier = @"cache";
+    configuration.maximumCachedObjectCount = 10;
+    RLMRealm *realm = [RLMRealm realmWithConfiguration:configuration error:nil];
+
+    [realm transactionWithBlock:^{
+        for (int i = 0; i < 10; ++i) {
+            [StringObject createInRealm:realm withValue:@[@(i).stringValue]];
+        }
+    }];
+    XCTAssertEqual(10U, [StringObject allObjectsInRealm:realm].count);
+
+    [realm transactionWithBlock:^{
+        for (int i = 10; i < 20; ++i) {
+            [StringObject createInRealm:realm withValue:@[@(i).stringValue]];
+        }
+        // Read the first five again so that they're the most recently used
+        RLMResults *objects = [StringObject allObjectsInRealm:realm];
+        for (NSUInteger i = 0; i < 5; ++i) {
+            (void)objects[i];
+        }
+    }];
+
+    // The eviction is performed in the background and delivered as a change
+    NSDate *timeout = [NSDate dateWithTimeIntervalSinceNow:2.0];
+    while ([StringObject allObjectsInRealm:realm].count > 10 && [timeout timeIntervalSinceNow] > 0) {
+        [NSRunLoop.currentRunLoop runMode:NSDefaultRunLoopMode beforeDate:[NSDate dateWithTimeIntervalSinceNow:0.05]];
+    }
+
+    NSArray *remaining = [[StringObject allObjectsInRealm:realm] valueForKey:@"stringCol"];
+    XCTAssertEqual(10U, remaining.count);
+    NSArray *expected = @[@"0", @"1", @"2", @"3", @"4", @"15", @"16", @"17", @"18", @"19"];
+    XCTAssertEqualObjects([NSSet setWithArray:expected], [NSSet setWithArray:remaining]);
+}
+
+- (void)testExpiredObjectsAreSweptInBatches {
+    RLMRealmConfiguration *configuration = [RLMRealmConfiguration defaultConfiguration];
+    configuration.path = RLMTestRealmPath();
+    configuration.expirySweepInterval = 0.05;
+    configuration.expirySweepBatchSize = 2;
+    RLMRealm *realm = [RLMRealm realmWithConfiguration:configuration error:nil];
+
+    NSDate *expired = [NSDate dateWithTimeIntervalSinceNow:-7200];
+    [realm transactionWithBlock:^{
+        for (int i = 0; i < 5; ++i) {
+            [ExpiringObject createInRealm:realm withValue:@[@(i).stringValue, expired]];
+        }
+        [ExpiringObject createInRealm:realm withValue:@[@"live", [NSDate date]]];
+    }];
+    XCTAssertEqual(1U, [ExpiringObject allObjectsInRealm:realm].count);
+
+    // The expired objects are hidden immediately, and deleted by three
+    // background writes which are delivered as changes
+    RLMObjectSchema *objectSchema = realm.schema[ExpiringObject.className];
+    NSDate *timeout = [NSDate dateWithTimeIntervalSinceNow:2.0];
+    while (objectSchema.table->size() > 1 && [timeout timeIntervalSinceNow] > 0) {
+        [NSRunLoop.currentRunLoop runMode:NSDefaultRunLoopMode beforeDate:[NSDate dateWithTimeIntervalSinceNow:0.05]];
+    }
+    XCTAssertEqual(1U, objectSchema.table->size());
+    XCTAssertEqualObjects(@"live", [[ExpiringObject allObjectsInRealm:realm].firstObject name]);
 }
 
-- (void)testInWriteTransaction {
-    RLMRealm *realm = [self realmWithTestPath];
-    XCTAssertFalse(realm.inWriteTransaction);
-    [realm beginWriteTransaction];
-    XCTAssertTrue(realm.inWriteTransaction);
-    [realm cancelWriteTransaction];
+- (void)testIdleReadTransactionTimeout {
+    RLMRealmConfiguration *configuration = [RLMRealmConfiguration defaultConfiguration];
+    configuration.path = RLMTestRealmPath();
+    configuration.idleReadTransactionTimeout = 0.01;
+    RLMRealm *realm = [RLMRealm realmWithConfiguration:configuration error:nil];
+    realm.autorefresh = NO;
+
     [realm transactionWithBlock:^{
-        XCTAssertTrue(realm.inWriteTransaction);
-        [realm cancelWriteTransaction];
-        XCTAssertFalse(realm.inWriteTransaction);
+        [StringObject createInRealm:realm withValue:@[@"a"]];
     }];
+    StringObject *obj = [StringObject allObjectsInRealm:realm].firstObject;
+    [NSThread sleepForTimeInterval:0.05];
 
-    [realm beginWriteTransaction];
-    [realm invalidate];
-    XCTAssertFalse(realm.inWriteTransaction);
+    [self waitForNotification:RLMRealmRefreshRequiredNotification realm:realm block:^{
+        RLMRealm *realm = [self realmWithTestPath];
+        [realm transactionWithBlock:^{
+            [StringObject createInRealm:realm withValue:@[@"b"]];
+        }];
+    }];
+
+    XCTAssertTrue(obj.invalidated);
+    XCTAssertEqual(2U, [StringObject allObjectsInRealm:realm].count);
 }
 
-- (void)testAutorefreshAfterBackgroundUpdate {
-    RLMRealm *realm = [self realmWithTestPath];
+- (void)testReadTransactionsInUseAreNotInvalidatedAfterTimeout {
+    RLMRealmConfiguration *configuration = [RLMRealmConfiguration defaultConfiguration];
+    configuration.path = RLMTestRealmPath();
+    configuration.idleReadTransactionTimeout = 0.5;
+    RLMRealm *realm = [RLMRealm realmWithConfiguration:configuration error:nil];
+    realm.autorefresh = NO;
 
-    XCTAssertEqual(0U, [StringObject allObjectsInRealm:realm].count);
+    [realm transactionWithBlock:^{
+        [StringObject createInRealm:realm withValue:@[@"a"]];
+    }];
+    StringObject *obj = [StringObject allObjectsInRealm:realm].firstObject;
 
-    [self waitForNotification:RLMRealmDidChangeNotification realm:realm block:^{
+    // The version being read is older than the timeout, but was just read from
+    [NSThread sleepForTimeInterval:0.6];
+    XCTAssertEqualObjects(@"a", obj.stringCol);
+
+    [self waitForNotification:RLMRealmRefreshRequiredNotification realm:realm block:^{
         RLMRealm *realm = [self realmWithTestPath];
-        [realm beginWriteTransaction];
-        [StringObject createInRealm:realm withValue:@[@"string"]];
-        [realm commitWriteTransaction];
+        [realm transactionWithBlock:^{
+            [StringObject createInRealm:realm withValue:@[@"b"]];
+        }];
     }];
 
+    XCTAssertFalse(obj.invalidated);
     XCTAssertEqual(1U, [StringObject allObjectsInRealm:realm].count);
 }
 
-- (void)testBackgroundUpdateWithoutAutorefresh {
-    RLMRealm *realm = [self realmWithTestPath];
+- (void)testReadTransactionsAreNotInvalidatedBeforeTimeout {
+    RLMRealmConfiguration *configuration = [RLMRealmConfiguration defaultConfiguration];
+    configuration.path = RLMTestRealmPath();
+    configuration.idleReadTransactionTimeout = 60;
+    RLMRealm *realm = [RLMRealm realmWithConfiguration:configuration error:nil];
     realm.autorefresh = NO;
 
-    XCTAssertEqual(0U, [StringObject allObjectsInRealm:realm].count);
+    [realm transactionWithBlock:^{
+        [StringObject createInRealm:realm withValue:@[@"a"]];
+    }];
+    StringObject *obj = [StringObject allObjectsInRealm:realm].firstObject;
 
     [self waitForNotification:RLMRealmRefreshRequiredNotification realm:realm block:^{
         RLMRealm *realm = [self realmWithTestPath];
-        [realm beginWriteTransaction];
-        [StringObject createInRealm:realm withValue:@[@"string"]];
-        [realm commitWriteTransaction];
-
-        XCTAssertEqual(1U, [StringObject allObjectsInRealm:realm].count);
+        [realm transactionWithBlock:^{
+            [StringObject createInRealm:realm withValue:@[@"b"]];
+        }];
     }];
 
-    XCTAssertEqual(0U, [StringObject allObjectsInRealm:realm].count);
-
-    [realm refresh];
+    XCTAssertFalse(obj.invalidated);
     XCTAssertEqual(1U, [StringObject allObjectsInRealm:realm].count);
 }
 
@@ -1009,6 +2303,369 @@ extern "C" {
     [realm path]; // ensure ARC releases the object after the thread has finished
 }
 
+- (void)testRealmsAreCachedPerThreadWhenOpenedConcurrently {
+    RLMRealm *mainRealm = [self realmWithTestPath];
+    dispatch_apply(64, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(__unused size_t i) {
+        @autoreleasepool {
+            RLMRealm *realm = [self realmWithTestPath];
+            XCTAssertEqual(realm, [self realmWithTestPath]);
+            if (![NSThread isMainThread]) {
+                XCTAssertNotEqual(realm, mainRealm);
+            }
+        }
+    });
+    XCTAssertEqual(mainRealm, [self realmWithTestPath]);
+}
+
+- (void)testQueueConfinedRealm {
+    dispatch_queue_t queue = dispatch_queue_create("test queue", DISPATCH_QUEUE_SERIAL);
+    RLMRealmConfiguration *config = [RLMRealmConfiguration defaultConfiguration];
+    config.path = RLMTestRealmPath();
+
+    XCTAssertThrows([RLMRealm realmWithConfiguration:config queue:queue error:nil]);
+
+    __block RLMRealm *queueRealm;
+    __block RLMNotificationToken *token;
+    XCTestExpectation *notified = [self expectationWithDescription:@"queue realm notified"];
+    dispatch_sync(queue, ^{
+        queueRealm = [RLMRealm realmWithConfiguration:config queue:queue error:nil];
+        XCTAssertEqual(queueRealm, [RLMRealm realmWithConfiguration:config queue:queue error:nil]);
+        XCTAssertNotEqual(queueRealm, [RLMRealm realmWithConfiguration:config error:nil]);
+
+        token = [queueRealm addNotificationBlock:^(__unused NSString *note, RLMRealm *realm) {
+            XCTAssertEqual(1U, [StringObject allObjectsInRealm:realm].count);
+            [notified fulfill];
+        }];
+    });
+
+    // Usable from any thread while on the queue, but not from off it
+    XCTAssertThrows([queueRealm beginWriteTransaction]);
+    [self dispatchAsyncAndWait:^{
+        dispatch_sync(queue, ^{
+            XCTAssertEqual(0U, [StringObject allObjectsInRealm:queueRealm].count);
+        });
+    }];
+
+    RLMRealm *realm = [self realmWithTestPath];
+    [realm transactionWithBlock:^{
+        [StringObject createInRealm:realm withValue:@[@"a"]];
+    }];
+    [self waitForExpectationsWithTimeout:2.0 handler:nil];
+
+    dispatch_sync(queue, ^{
+        [queueRealm removeNotification:token];
+        queueRealm = nil;
+    });
+}
+
+- (void)testSnapshotReadsPinnedVersionFromManyThreads {
+    RLMRealm *realm = [self realmWithTestPath];
+    [realm transactionWithBlock:^{
+        [StringObject createInRealm:realm withValue:@[@"a"]];
+    }];
+
+    RLMSnapshot *snapshot = [realm snapshot];
+    [realm transactionWithBlock:^{
+        [StringObject createInRealm:realm withValue:@[@"b"]];
+    }];
+    XCTAssertEqual(2U, [StringObject allObjectsInRealm:realm].count);
+
+    dispatch_apply(16, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(__unused size_t i) {
+        [snapshot readWithBlock:^(RLMRealm *snapshotRealm) {
+            RLMResults *objects = [StringObject allObjectsInRealm:snapshotRealm];
+            XCTAssertEqual(1U, objects.count);
+            XCTAssertEqualObjects(@"a", [objects.firstObject stringCol]);
+            XCTAssertThrows([snapshotRealm beginWriteTransaction]);
+        }];
+    });
+
+    [realm beginWriteTransaction];
+    XCTAssertThrows([realm snapshot]);
+    [realm cancelWriteTransaction];
+}
+
+- (void)testSnapshotWriteCopyReportsProgress {
+    RLMRealm *realm = [RLMRealm defaultRealm];
+    NSString *string = [@"" stringByPaddingToLength:1024 withString:@"a" startingAtIndex:0];
+    [realm transactionWithBlock:^{
+        for (int i = 0; i < 4000; ++i) {
+            [StringObject createInRealm:realm withValue:@[string]];
+        }
+    }];
+
+    RLMSnapshot *snapshot = [realm snapshot];
+    [realm transactionWithBlock:^{
+        [StringObject createInRealm:realm withValue:@[@"b"]];
+    }];
+
+    // Cancelling removes the partially written file
+    [self dispatchAsyncAndWait:^{
+        NSError *error;
+        XCTAssertFalse([snapshot writeCopyToPath:RLMTestRealmPath() encryptionKey:nil
+                                        progress:^BOOL(NSUInteger, NSUInteger) { return NO; }
+                                           error:&error]);
+        XCTAssertEqual(RLMErrorCancelled, error.code);
+        XCTAssertFalse([[NSFileManager defaultManager] fileExistsAtPath:RLMTestRealmPath()]);
+    }];
+
+    NSMutableArray *progress = [NSMutableArray array];
+    [self dispatchAsyncAndWait:^{
+        XCTAssertTrue([snapshot writeCopyToPath:RLMTestRealmPath() encryptionKey:nil
+                                       progress:^BOOL(NSUInteger bytesWritten, NSUInteger totalBytes) {
+                                           XCTAssertLessThanOrEqual(bytesWritten, totalBytes);
+                                           [progress addObject:@(bytesWritten)];
+                                           return YES;
+                                       } error:nil]);
+    }];
+    XCTAssertGreaterThan(progress.count, 1U);
+    XCTAssertEqualObjects([progress sortedArrayUsingSelector:@selector(compare:)], progress);
+
+    // The copy has the snapshot's version rather than the Realm's
+    XCTAssertEqual(4000U, [StringObject allObjectsInRealm:[self realmWithTestPath]].count);
+
+    NSError *error;
+    XCTAssertFalse([snapshot writeCopyToPath:RLMTestRealmPath() encryptionKey:nil progress:nil error:&error]);
+    XCTAssertEqual(RLMErrorFileExists, error.code);
+}
+
+- (void)testThreadSafeReferenceResolvesOnAnotherThread {
+    RLMRealm *realm = [self realmWithTestPath];
+    __block ArrayPropertyObject *arrayObject;
+    [realm transactionWithBlock:^{
+        [StringObject createInRealm:realm withValue:@[@"b"]];
+        [StringObject createInRealm:realm withValue:@[@"a"]];
+        arrayObject = [ArrayPropertyObject createInRealm:realm withValue:@[@"name", @[@[@"c"], @[@"d"]], @[]]];
+    }];
+
+    RLMThreadSafeReference *objectRef = [RLMThreadSafeReference referenceWithThreadConfined:arrayObject];
+    RLMThreadSafeReference *resultsRef = [RLMThreadSafeReference referenceWithThreadConfined:
+                                          [[StringObject objectsInRealm:realm where:@"stringCol < 'c'"] sortedResultsUsingProperty:@"stringCol" ascending:YES]];
+    RLMThreadSafeReference *arrayRef = [RLMThreadSafeReference referenceWithThreadConfined:arrayObject.array];
+    XCTAssertEqual(realm.snapshot.version, objectRef.version);
+    XCTAssertFalse(objectRef.resolved);
+
+    [self dispatchAsyncAndWait:^{
+        RLMRealm *realm = [self realmWithTestPath];
+        ArrayPropertyObject *object = [realm resolveThreadSafeReference:objectRef];
+        XCTAssertEqualObjects(@"name", object.name);
+        XCTAssertTrue(objectRef.resolved);
+        XCTAssertThrows([realm resolveThreadSafeReference:objectRef]);
+
+        RLMResults *results = [realm resolveThreadSafeReference:resultsRef];
+        XCTAssertEqual(2U, results.count);
+        XCTAssertEqualObjects(@"a", [results[0] stringCol]);
+        XCTAssertEqualObjects(@"b", [results[1] stringCol]);
+
+        RLMArray *array = [realm resolveThreadSafeReference:arrayRef];
+        XCTAssertEqual(2U, array.count);
+        XCTAssertEqualObjects(@"d", [array[1] stringCol]);
+        [realm transactionWithBlock:^{
+            [array addObject:[[StringObject alloc] initWithValue:@[@"e"]]];
+        }];
+    }];
+    [realm refresh];
+    XCTAssertEqual(3U, arrayObject.array.count);
+
+    XCTAssertThrows([RLMThreadSafeReference referenceWithThreadConfined:[[StringObject alloc] init]]);
+    XCTAssertThrows([RLMThreadSafeReference referenceWithThreadConfined:@"string"]);
+    [realm beginWriteTransaction];
+    XCTAssertThrows([RLMThreadSafeReference referenceWithThreadConfined:arrayObject]);
+    [realm cancelWriteTransaction];
+}
+
+- (void)testThreadSafeReferenceResolvesBacklinkQuery {
+    RLMRealm *realm = [self realmWithTestPath];
+    [realm transactionWithBlock:^{
+        IndexedStringObject *a = [IndexedStringObject createInRealm:realm withValue:@[@"a"]];
+        IndexedStringObject *b = [IndexedStringObject createInRealm:realm withValue:@[@"b"]];
+        for (IndexedStringObject *target in @[a, b, a]) {
+            [LinkIndexedStringObject createInRealm:realm withValue:@[target]];
+        }
+    }];
+
+    RLMResults *results = [LinkIndexedStringObject objectsInRealm:realm where:@"objectCol.stringCol == 'a'"];
+    XCTAssertEqual(2U, results.count);
+    RLMThreadSafeReference *resultsRef = [RLMThreadSafeReference referenceWithThreadConfined:results];
+
+    [self dispatchAsyncAndWait:^{
+        RLMRealm *realm = [self realmWithTestPath];
+        RLMResults *results = [realm resolveThreadSafeReference:resultsRef];
+        XCTAssertEqual(2U, results.count);
+
+        // The query has to follow the links in this thread's tables, which
+        // have rows the original thread's don't
+        [realm transactionWithBlock:^{
+            IndexedStringObject *c = [IndexedStringObject createInRealm:realm withValue:@[@"a"]];
+            [LinkIndexedStringObject createInRealm:realm withValue:@[c]];
+        }];
+        XCTAssertEqual(3U, results.count);
+        XCTAssertEqualObjects((@[@"a", @"a", @"a"]), [results valueForKeyPath:@"objectCol.stringCol"]);
+    }];
+    [realm refresh];
+    XCTAssertEqual(3U, results.count);
+}
+
+- (void)testThreadSafeReferenceResolvesLinkListAggregateQuery {
+    RLMRealm *realm = [self realmWithTestPath];
+    [realm transactionWithBlock:^{
+        for (NSArray *values in @[@[], @[@1, @2], @[@3, @4]]) {
+            CachedAggregateArrayObject *obj = [CachedAggregateArrayObject createInRealm:realm withValue:@[@[]]];
+            for (NSNumber *value in values) {
+                [obj.array addObject:[IntObject createInRealm:realm withValue:@[value]]];
+            }
+        }
+    }];
+
+    RLMResults *results = [CachedAggregateArrayObject objectsInRealm:realm where:@"array.@sum.intCol > 2"];
+    XCTAssertEqual(2U, results.count);
+    RLMThreadSafeReference *resultsRef = [RLMThreadSafeReference referenceWithThreadConfined:results];
+
+    [self dispatchAsyncAndWait:^{
+        RLMRealm *realm = [self realmWithTestPath];
+        RLMResults *results = [realm resolveThreadSafeReference:resultsRef];
+        XCTAssertEqual(2U, results.count);
+
+        [realm transactionWithBlock:^{
+            [CachedAggregateArrayObject createInRealm:realm withValue:@[@[@[@5]]]];
+        }];
+        XCTAssertEqual(3U, results.count);
+    }];
+    [realm refresh];
+    XCTAssertEqual(3U, results.count);
+}
+
+- (void)testThreadSafeReferenceResolvesSubqueryCountQuery {
+    RLMRealm *realm = [self realmWithTestPath];
+    [realm transactionWithBlock:^{
+        [CompanyObject createInRealm:realm withValue:@[@"first", @[@[@"A", @20, @YES], @[@"B", @30, @NO]]]];
+        [CompanyObject createInRealm:realm withValue:@[@"second", @[@[@"C", @40, @NO]]]];
+    }];
+
+    RLMResults *results = [CompanyObject objectsInRealm:realm where:@"SUBQUERY(employees, $e, $e.hired = YES).@count > 0"];
+    XCTAssertEqual(1U, results.count);
+    RLMThreadSafeReference *resultsRef = [RLMThreadSafeReference referenceWithThreadConfined:results];
+
+    [self dispatchAsyncAndWait:^{
+        RLMRealm *realm = [self realmWithTestPath];
+        RLMResults *results = [realm resolveThreadSafeReference:resultsRef];
+        XCTAssertEqual(1U, results.count);
+
+        [realm transactionWithBlock:^{
+            [CompanyObject createInRealm:realm withValue:@[@"third", @[@[@"D", @50, @YES]]]];
+        }];
+        XCTAssertEqual(2U, results.count);
+        XCTAssertEqualObjects((@[@"first", @"third"]), [results valueForKey:@"name"]);
+    }];
+    [realm refresh];
+    XCTAssertEqual(2U, results.count);
+}
+
+- (void)testThreadSafeReferenceFollowsObjectToNewerVersion {
+    RLMRealm *realm = [self realmWithTestPath];
+    __block StringObject *b, *c;
+    [realm transactionWithBlock:^{
+        [StringObject createInRealm:realm withValue:@[@"a"]];
+        b = [StringObject createInRealm:realm withValue:@[@"b"]];
+        c = [StringObject createInRealm:realm withValue:@[@"c"]];
+    }];
+
+    RLMThreadSafeReference *bRef = [RLMThreadSafeReference referenceWithThreadConfined:b];
+    RLMThreadSafeReference *cRef = [RLMThreadSafeReference referenceWithThreadConfined:c];
+
+    // Deleting the first object moves the last one into its place
+    [realm transactionWithBlock:^{
+        [realm deleteObject:[StringObject allObjectsInRealm:realm].firstObject];
+        [realm deleteObject:b];
+    }];
+
+    [self dispatchAsyncAndWait:^{
+        RLMRealm *realm = [self realmWithTestPath];
+        XCTAssertNil([realm resolveThreadSafeReference:bRef]);
+        StringObject *c = [realm resolveThreadSafeReference:cRef];
+        XCTAssertEqualObjects(@"c", c.stringCol);
+    }];
+}
+
+- (void)testChangeFeed {
+    RLMRealm *realm = [self realmWithTestPath];
+    [realm transactionWithBlock:^{
+        [StringObject createInRealm:realm withValue:@[@"a"]];
+    }];
+
+    RLMChangeFeed *feed = [RLMChangeFeed changeFeedForRealm:realm];
+    XCTAssertEqual(realm.snapshot.version, feed.version);
+    XCTAssertEqual(0U, feed.nextChanges.count);
+
+    [self dispatchAsyncAndWait:^{
+        RLMRealm *realm = [self realmWithTestPath];
+        [realm transactionWithBlock:^{
+            [StringObject createInRealm:realm withValue:@[@"b"]];
+        }];
+        [realm transactionWithBlock:^{
+            [realm deleteObject:[StringObject allObjectsInRealm:realm].firstObject];
+        }];
+    }];
+
+    NSArray *changes = feed.nextChanges;
+    XCTAssertEqual(3U, changes.count);
+    RLMChangeRecord *insert = changes[0], *set = changes[1], *remove = changes[2];
+    XCTAssertEqual(RLMChangeRecordTypeInsert, insert.type);
+    XCTAssertEqualObjects(@"StringObject", insert.className);
+    XCTAssertEqual(1U, insert.index);
+    XCTAssertEqual(1U, insert.otherIndex);
+
+    XCTAssertEqual(RLMChangeRecordTypeSet, set.type);
+    XCTAssertEqual(1U, set.index);
+    XCTAssertEqualObjects(@"stringCol", set.propertyName);
+    XCTAssertEqualObjects(@"b", set.value);
+
+    XCTAssertEqual(RLMChangeRecordTypeMoveLastOver, remove.type);
+    XCTAssertEqual(0U, remove.index);
+    XCTAssertEqual(1U, remove.otherIndex);
+
+    XCTAssertEqual(0U, feed.nextChanges.count);
+    [realm beginWriteTransaction];
+    XCTAssertThrows([RLMChangeFeed changeFeedForRealm:realm]);
+    [realm cancelWriteTransaction];
+}
+
+- (void)testTrimMemory {
+    RLMRealm *realm = [self realmWithTestPath];
+    [realm transactionWithBlock:^{
+        [PrimaryStringObject createInRealm:realm withValue:@[@"a", @1]];
+    }];
+    XCTAssertNotNil([PrimaryStringObject objectInRealm:realm forPrimaryKey:@"a"]);
+    RLMResults *results = [PrimaryStringObject allObjectsInRealm:realm];
+    XCTAssertEqual(1U, results.count);
+
+    [self dispatchAsyncAndWait:^{
+        RLMRealm *realm = [self realmWithTestPath];
+        [realm transactionWithBlock:^{
+            [PrimaryStringObject createInRealm:realm withValue:@[@"b", @2]];
+        }];
+    }];
+
+    // Dropping caches leaves the Realm at its version
+    realm::Realm::trim_memory_for_all_realms(realm::Realm::TrimLevel::Caches);
+    XCTAssertEqual(1U, results.count);
+    XCTAssertNotNil([PrimaryStringObject objectInRealm:realm forPrimaryKey:@"a"]);
+
+    // Releasing old versions refreshes Realms which would autorefresh
+    realm::Realm::trim_memory_for_all_realms(realm::Realm::TrimLevel::Versions);
+    XCTAssertEqual(2U, results.count);
+    XCTAssertNotNil([PrimaryStringObject objectInRealm:realm forPrimaryKey:@"b"]);
+
+    realm.autorefresh = NO;
+    [self dispatchAsyncAndWait:^{
+        RLMRealm *realm = [self realmWithTestPath];
+        [realm transactionWithBlock:^{
+            [PrimaryStringObject createInRealm:realm withValue:@[@"c", @3]];
+        }];
+    }];
+    realm::Realm::trim_memory_for_all_realms(realm::Realm::TrimLevel::Versions);
+    XCTAssertEqual(2U, results.count);
+}
+
 - (void)testBackgroundRealmIsNotified {
     RLMRealm *realm = [self realmWithTestPath];
 
@@ -1354,6 +3011,45 @@ extern "C" {
     XCTAssertGreaterThan(fileSizeBefore, fileSizeAfter);
 }
 
+- (void)testCompactOnOpen
+{
+    NSString *uuid = [[NSUUID UUID] UUIDString];
+    @autoreleasepool {
+        RLMRealm *realm = self.realmWithTestPath;
+        [realm transactionWithBlock:^{
+            for (NSUInteger i = 0; i < 1000; ++i) {
+                [StringObject createInRealm:realm withValue:@[uuid]];
+            }
+        }];
+        [realm transactionWithBlock:^{
+            [realm deleteObjects:[StringObject allObjectsInRealm:realm]];
+            [StringObject createInRealm:realm withValue:@[@"A"]];
+        }];
+    }
+    unsigned long long fileSizeBefore = [[[NSFileManager defaultManager] attributesOfItemAtPath:RLMTestRealmPath() error:nil] fileSize];
+
+    __block NSUInteger reclaimed = 0;
+    RLMRealmConfiguration *configuration = [RLMRealmConfiguration defaultConfiguration];
+    configuration.path = RLMTestRealmPath();
+    configuration.compactOnOpenFreeSpaceRatio = 0.5;
+    configuration.compactionBlock = ^(NSUInteger bytesReclaimed) {
+        reclaimed += bytesReclaimed;
+    };
+    RLMRealm *realm = [RLMRealm realmWithConfiguration:configuration error:nil];
+    XCTAssertGreaterThan(reclaimed, 0U);
+    XCTAssertEqualObjects(@"A", [[StringObject allObjectsInRealm:realm].firstObject stringCol]);
+
+    unsigned long long fileSizeAfter = [[[NSFileManager defaultManager] attributesOfItemAtPath:RLMTestRealmPath() error:nil] fileSize];
+    XCTAssertGreaterThan(fileSizeBefore, fileSizeAfter);
+
+    // Only the first open in the process compacts
+    reclaimed = 0;
+    [self dispatchAsyncAndWait:^{
+        XCTAssertNotNil([RLMRealm realmWithConfiguration:configuration error:nil]);
+    }];
+    XCTAssertEqual(0U, reclaimed);
+}
+
 - (NSArray *)pathsFor100Realms
 {
     NSMutableArray *paths = [NSMutableArray array];
@@ -72,6 +72,70 @@
     XCTAssertNil(objects[0], @"Object should have been released");
 }
 
+- (void)testFastEnumerationWithEnumerationBatchSize
+{
+    RLMRealmConfiguration *configuration = [RLMRealmConfiguration defaultConfiguration];
+    configuration.inMemoryIdentifier = @"enumerationBatchSize";
+    configuration.enumerationBatchSize = 5;
+    RLMRealm *realm = [RLMRealm realmWithConfiguration:configuration error:nil];
+    XCTAssertEqual(5U, realm.configuration.enumerationBatchSize);
+
+    [realm beginWriteTransaction];
+    for (int i = 0; i < 18; ++i) {
+        [IntObject createInRealm:realm withValue:@[@(i)]];
+    }
+    [realm commitWriteTransaction];
+
+    __weak id objects[18];
+    int count = 0;
+    for (IntObject *io in [IntObject objectsInRealm:realm where:@"intCol < 100"]) {
+        XCTAssertEqual(count, io.intCol);
+        if (count >= 5) {
+            // Only the current batch of objects is retained
+            XCTAssertNil(objects[count - 5]);
+        }
+        objects[count++] = io;
+    }
+    XCTAssertEqual(count, 18);
+
+    XCTAssertThrows(configuration.enumerationBatchSize = 0);
+}
+
+- (void)testEnumerateObjectsUsingReusedAccessor
+{
+    RLMRealm *realm = [RLMRealm defaultRealm];
+    [realm beginWriteTransaction];
+    for (int i = 0; i < 40; ++i) {
+        [IntObject createInRealm:realm withValue:@[@(i)]];
+    }
+    [realm commitWriteTransaction];
+
+    RLMResults *results = [IntObject objectsInRealm:realm where:@"intCol >= 10"];
+    __block IntObject *first = nil;
+    __block NSUInteger count = 0;
+    [results enumerateObjectsUsingReusedAccessor:^(IntObject *obj, NSUInteger index, BOOL *stop) {
+        if (!first) {
+            first = obj;
+        }
+        XCTAssertEqual(first, obj);
+        XCTAssertEqual(obj.intCol, (int)index + 10);
+        if (++count == 25) {
+            *stop = YES;
+        }
+    }];
+    XCTAssertEqual(count, 25U);
+
+    // Works the same within a write transaction
+    [realm beginWriteTransaction];
+    count = 0;
+    [results enumerateObjectsUsingReusedAccessor:^(IntObject *obj, NSUInteger index, __unused BOOL *stop) {
+        XCTAssertEqual(obj.intCol, (int)index + 10);
+        ++count;
+    }];
+    [realm cancelWriteTransaction];
+    XCTAssertEqual(count, 30U);
+}
+
 - (void)testFirst {
     XCTAssertNil(IntObject.allObjects.firstObject);
     XCTAssertNil([IntObject objectsWhere:@"intCol > 5"].firstObject);
@@ -166,6 +230,52 @@
     XCTAssertThrows([[AggregateObject allObjectsInRealm:realm] valueForKey:@"invalid"]);
 }
 
+- (void)testDictionariesWithValuesForKeys {
+    RLMRealm *realm = self.realmWithTestPath;
+
+    [realm beginWriteTransaction];
+    EmployeeObject *alice = [EmployeeObject createInRealm:realm withValue:@{@"name": @"Alice", @"age": @30, @"hired": @YES}];
+    [EmployeeObject createInRealm:realm withValue:@{@"age": @25, @"hired": @NO}];
+    CompanyObject *company = [CompanyObject createInRealm:realm withValue:@[@"Realm", @[alice]]];
+    [realm commitWriteTransaction];
+
+    RLMResults *employees = [EmployeeObject allObjectsInRealm:realm];
+    NSArray *expected = @[@{@"name": @"Alice", @"age": @30},
+                          @{@"name": NSNull.null, @"age": @25}];
+    XCTAssertEqualObjects([employees dictionariesWithValuesForKeys:@[@"name", @"age"]], expected);
+    XCTAssertEqualObjects([[employees objectsWhere:@"age > 100"] dictionariesWithValuesForKeys:@[@"name"]], @[]);
+    XCTAssertEqualObjects([company.employees dictionariesWithValuesForKeys:@[@"name", @"hired"]],
+                          (@[@{@"name": @"Alice", @"hired": @YES}]));
+    XCTAssertEqualObjects([alice dictionaryWithValuesForKeys:@[@"name", @"age"]], expected[0]);
+    XCTAssertEqualObjects([company dictionaryWithValuesForKeys:@[@"name", @"employees"]][@"employees"][0][@"name"], @"Alice");
+
+    CompanyObject *standalone = [[CompanyObject alloc] initWithValue:@[@"Standalone", @[@[@"Bob", @40, @YES]]]];
+    XCTAssertEqualObjects([standalone.employees dictionariesWithValuesForKeys:@[@"age"]], (@[@{@"age": @40}]));
+
+    XCTAssertThrows([employees dictionariesWithValuesForKeys:@[@"invalid"]]);
+}
+
+- (void)testValueForKeyWithOptionalProperties {
+    RLMRealm *realm = self.realmWithTestPath;
+    NSDate *date = [NSDate dateWithTimeIntervalSince1970:100];
+    NSData *data = [@"a" dataUsingEncoding:NSUTF8StringEncoding];
+
+    [realm beginWriteTransaction];
+    [AllOptionalTypes createInRealm:realm withValue:@[@1, @2.5f, @3.5, @YES, @"str", data, date]];
+    [AllOptionalTypes createInRealm:realm withValue:@[NSNull.null, NSNull.null, NSNull.null, NSNull.null,
+                                                      NSNull.null, NSNull.null, NSNull.null]];
+    [realm commitWriteTransaction];
+
+    RLMResults *results = [AllOptionalTypes allObjectsInRealm:realm];
+    XCTAssertEqualObjects([results valueForKey:@"intObj"], (@[@1, NSNull.null]));
+    XCTAssertEqualObjects([results valueForKey:@"floatObj"], (@[@2.5f, NSNull.null]));
+    XCTAssertEqualObjects([results valueForKey:@"doubleObj"], (@[@3.5, NSNull.null]));
+    XCTAssertEqualObjects([results valueForKey:@"boolObj"], (@[@YES, NSNull.null]));
+    XCTAssertEqualObjects([results valueForKey:@"string"], (@[@"str", NSNull.null]));
+    XCTAssertEqualObjects([results valueForKey:@"data"], (@[data, NSNull.null]));
+    XCTAssertEqualObjects([results valueForKey:@"date"], (@[date, NSNull.null]));
+}
+
 - (void)testSetValueForKey {
     RLMRealm *realm = self.realmWithTestPath;
 
@@ -353,6 +463,226 @@
     RLMAssertThrowsWithReasonMatching([allArray maxOfProperty:@"boolCol"], @"max.*bool");
 }
 
+- (void)testParallelAggregatesMatchSerialAggregates
+{
+    RLMRealmConfiguration *configuration = [RLMRealmConfiguration defaultConfiguration];
+    configuration.parallelAggregateThreshold = 1;
+    RLMRealm *realm = [RLMRealm realmWithConfiguration:configuration error:nil];
+
+    const NSInteger count = 100000;
+    NSDate *date = [NSDate dateWithTimeIntervalSince1970:0];
+    [realm beginWriteTransaction];
+    for (NSInteger i = 0; i < count; ++i) {
+        [AggregateObject createInRealm:realm withValue:@[@(i % 1000), @0.5f, @(i), @(i % 2 == 1), date]];
+    }
+    [realm commitWriteTransaction];
+
+    RLMResults *all = [AggregateObject allObjectsInRealm:realm];
+    RLMResults *odd = [AggregateObject objectsInRealm:realm where:@"boolCol == YES"];
+    RLMResults *none = [AggregateObject objectsInRealm:realm where:@"intCol < 0"];
+
+    XCTAssertEqual(50000U, odd.count);
+    XCTAssertEqual(0U, none.count);
+
+    XCTAssertEqual(49950000, [all sumOfProperty:@"intCol"].longLongValue);
+    XCTAssertEqual(25000000, [odd sumOfProperty:@"intCol"].longLongValue);
+    XCTAssertEqual(0, [none sumOfProperty:@"intCol"].longLongValue);
+    XCTAssertEqual(50000.0, [all sumOfProperty:@"floatCol"].doubleValue);
+    XCTAssertEqual(4999950000.0, [all sumOfProperty:@"doubleCol"].doubleValue);
+
+    XCTAssertEqual(0, [all minOfProperty:@"intCol"].intValue);
+    XCTAssertEqual(1, [odd minOfProperty:@"intCol"].intValue);
+    XCTAssertEqual(999, [all maxOfProperty:@"intCol"].intValue);
+    XCTAssertEqual(99999.0, [all maxOfProperty:@"doubleCol"].doubleValue);
+    XCTAssertEqual(1.0, [odd minOfProperty:@"doubleCol"].doubleValue);
+    XCTAssertEqual(0.5f, [odd maxOfProperty:@"floatCol"].floatValue);
+    XCTAssertNil([none minOfProperty:@"intCol"]);
+    XCTAssertNil([none maxOfProperty:@"doubleCol"]);
+
+    XCTAssertEqualWithAccuracy(499.5, [all averageOfProperty:@"intCol"].doubleValue, 1e-9);
+    XCTAssertEqualWithAccuracy(500.0, [odd averageOfProperty:@"intCol"].doubleValue, 1e-9);
+    XCTAssertEqualWithAccuracy(49999.5, [all averageOfProperty:@"doubleCol"].doubleValue, 1e-9);
+    XCTAssertNil([none averageOfProperty:@"intCol"]);
+
+    // Aggregates within a write transaction see the uncommitted changes
+    [realm beginWriteTransaction];
+    [AggregateObject createInRealm:realm withValue:@[@5000, @0.5f, @0, @YES, date]];
+    XCTAssertEqual(5000, [odd maxOfProperty:@"intCol"].intValue);
+    XCTAssertEqual(50001U, odd.count);
+    [realm cancelWriteTransaction];
+    XCTAssertEqual(999, [odd maxOfProperty:@"intCol"].intValue);
+    XCTAssertEqual(50000U, odd.count);
+}
+
+- (void)testValuesForNumericProperty
+{
+    RLMRealm *realm = self.realmWithTestPath;
+    [realm beginWriteTransaction];
+    for (int i = 0; i < 10; ++i) {
+        [AggregateObject createInRealm:realm withValue:@[@(i), @(i * 0.5f), @(i * 2.0), @NO, NSDate.date]];
+    }
+    [AllOptionalTypes createInRealm:realm withValue:@[@5, NSNull.null, NSNull.null, NSNull.null,
+                                                      NSNull.null, NSNull.null, NSNull.null]];
+    [AllOptionalTypes createInRealm:realm withValue:@[NSNull.null, NSNull.null, NSNull.null, NSNull.null,
+                                                      NSNull.null, NSNull.null, NSNull.null]];
+    [realm commitWriteTransaction];
+
+    RLMResults *results = [AggregateObject objectsInRealm:realm where:@"intCol >= 4"];
+    NSData *ints = [results valuesForNumericProperty:@"intCol" nullBitmap:nil];
+    XCTAssertEqual(ints.length, 6 * sizeof(int64_t));
+    XCTAssertEqual(((const int64_t *)ints.bytes)[0], 4);
+    XCTAssertEqual(((const int64_t *)ints.bytes)[5], 9);
+
+    NSData *floats = [results valuesForNumericProperty:@"floatCol" nullBitmap:nil];
+    XCTAssertEqual(((const float *)floats.bytes)[1], 2.5f);
+    NSData *doubles = [[AggregateObject allObjectsInRealm:realm] valuesForNumericProperty:@"doubleCol" nullBitmap:nil];
+    XCTAssertEqual(doubles.length, 10 * sizeof(double));
+    XCTAssertEqual(((const double *)doubles.bytes)[9], 18.0);
+
+    NSData *nulls;
+    NSData *optionalInts = [[AllOptionalTypes allObjectsInRealm:realm] valuesForNumericProperty:@"intObj" nullBitmap:&nulls];
+    XCTAssertEqual(((const int64_t *)optionalInts.bytes)[0], 5);
+    XCTAssertEqual(((const int64_t *)optionalInts.bytes)[1], 0);
+    XCTAssertEqual(nulls.length, 1U);
+    XCTAssertEqual(((const uint8_t *)nulls.bytes)[0], 2);
+
+    XCTAssertThrows([results valuesForNumericProperty:@"dateCol" nullBitmap:nil]);
+    XCTAssertThrows([results valuesForNumericProperty:@"invalid" nullBitmap:nil]);
+}
+
+- (void)testDistinctUnionOfObjects
+{
+    RLMRealm *realm = [RLMRealm defaultRealm];
+    [realm beginWriteTransaction];
+    for (int i = 0; i < 10; ++i) {
+        [EmployeeObject createInRealm:realm withValue:@{@"name": i % 2 ? @"Joe" : @"Jill", @"age": @(i % 3), @"hired": @(i < 5)}];
+    }
+    [realm commitWriteTransaction];
+
+    RLMResults *results = [EmployeeObject allObjects];
+    XCTAssertEqualObjects([results valueForKeyPath:@"@distinctUnionOfObjects.name"], (@[@"Jill", @"Joe"]));
+    XCTAssertEqualObjects([results valueForKeyPath:@"@distinctUnionOfObjects.age"], (@[@0, @1, @2]));
+    XCTAssertEqualObjects([results valueForKeyPath:@"@distinctUnionOfObjects.hired"], (@[@YES, @NO]));
+
+    // duplicates are removed after filtering and sorting
+    RLMResults *sorted = [[EmployeeObject objectsWhere:@"age > 0"] sortedResultsUsingProperty:@"age" ascending:NO];
+    XCTAssertEqualObjects([sorted valueForKeyPath:@"@distinctUnionOfObjects.age"], (@[@2, @1]));
+    XCTAssertEqualObjects([[sorted resultsWithLimit:3 offset:0] valueForKeyPath:@"@distinctUnionOfObjects.name"], (@[@"Jill", @"Joe"]));
+    XCTAssertEqualObjects([[sorted resultsWithLimit:2 offset:0] valueForKeyPath:@"@distinctUnionOfObjects.age"], (@[@2]));
+
+    [realm beginWriteTransaction];
+    [EmployeeObject createInRealm:realm withValue:@{@"name": @"John", @"age": @5, @"hired": @YES}];
+    [realm commitWriteTransaction];
+    XCTAssertEqualObjects([sorted valueForKeyPath:@"@distinctUnionOfObjects.age"], (@[@5, @2, @1]));
+    XCTAssertEqualObjects([results valueForKeyPath:@"@distinctUnionOfObjects.name"], (@[@"Jill", @"Joe", @"John"]));
+}
+
+- (void)testUnionOfArraysSharingObjects
+{
+    RLMRealm *realm = [RLMRealm defaultRealm];
+    [realm beginWriteTransaction];
+    EmployeeObject *joe = [EmployeeObject createInRealm:realm withValue:@{@"name": @"Joe", @"age": @40, @"hired": @YES}];
+    EmployeeObject *jill = [EmployeeObject createInRealm:realm withValue:@{@"name": @"Jill", @"age": @25, @"hired": @YES}];
+    [CompanyObject createInRealm:realm withValue:@{@"name": @"A", @"employees": @[jill, joe, jill]}];
+    [CompanyObject createInRealm:realm withValue:@{@"name": @"B", @"employees": @[]}];
+    [CompanyObject createInRealm:realm withValue:@{@"name": @"C", @"employees": @[joe]}];
+    [realm commitWriteTransaction];
+
+    RLMResults *companies = [CompanyObject allObjects];
+    NSArray *employees = [companies valueForKeyPath:@"@unionOfArrays.employees"];
+    XCTAssertEqual(employees.count, 4U);
+    XCTAssertTrue([employees[0] isEqualToObject:jill]);
+    XCTAssertTrue([employees[3] isEqualToObject:joe]);
+    XCTAssertEqualObjects([employees valueForKey:@"name"], (@[@"Jill", @"Joe", @"Jill", @"Joe"]));
+
+    NSArray *distinct = [companies valueForKeyPath:@"@distinctUnionOfArrays.employees"];
+    XCTAssertEqualObjects([distinct valueForKey:@"name"], (@[@"Jill", @"Joe"]));
+    XCTAssertEqualObjects([[companies objectsWhere:@"name = 'B'"] valueForKeyPath:@"@unionOfArrays.employees"], @[]);
+}
+
+- (void)testValuesForAggregateKeyPaths
+{
+    RLMRealm *realm = [RLMRealm defaultRealm];
+    RLMResults *noArray = [AggregateObject objectsWhere:@"boolCol == NO"];
+    RLMResults *allArray = [AggregateObject allObjects];
+    NSArray *keyPaths = @[@"@min.intCol", @"@max.doubleCol", @"@sum.floatCol", @"@avg.intCol", @"@min.dateCol"];
+
+    XCTAssertEqualObjects((@[NSNull.null, NSNull.null, @0, NSNull.null, NSNull.null]),
+                          [allArray valuesForAggregateKeyPaths:keyPaths]);
+
+    NSDate *dateMinInput = [NSDate dateWithTimeIntervalSince1970:(int64_t)[[NSDate date] timeIntervalSince1970]];
+    NSDate *dateMaxInput = [dateMinInput dateByAddingTimeInterval:1000];
+
+    [realm beginWriteTransaction];
+    [AggregateObject createInRealm:realm withValue:@[@0, @1.2f, @0.0, @YES, dateMinInput]];
+    [AggregateObject createInRealm:realm withValue:@[@1, @0.0f, @2.5, @NO, dateMaxInput]];
+    [AggregateObject createInRealm:realm withValue:@[@3, @1.2f, @0.0, @YES, dateMinInput]];
+    [AggregateObject createInRealm:realm withValue:@[@2, @0.0f, @2.5, @NO, dateMaxInput]];
+    [realm commitWriteTransaction];
+
+    for (RLMResults *results in @[noArray, allArray, [allArray sortedResultsUsingProperty:@"intCol" ascending:NO]]) {
+        NSArray *values = [results valuesForAggregateKeyPaths:keyPaths];
+        XCTAssertEqualObjects([results minOfProperty:@"intCol"], values[0]);
+        XCTAssertEqualObjects([results maxOfProperty:@"doubleCol"], values[1]);
+        XCTAssertEqualWithAccuracy([[results sumOfProperty:@"floatCol"] doubleValue], [values[2] doubleValue], 0.001);
+        XCTAssertEqualWithAccuracy([[results averageOfProperty:@"intCol"] doubleValue], [values[3] doubleValue], 0.001);
+        XCTAssertEqualObjects([results minOfProperty:@"dateCol"], values[4]);
+    }
+
+    RLMAssertThrowsWithReasonMatching([allArray valuesForAggregateKeyPaths:@[@"@count.intCol"]], @"Unsupported aggregate operator");
+    RLMAssertThrowsWithReasonMatching([allArray valuesForAggregateKeyPaths:@[@"@min"]], @"Missing key path");
+    RLMAssertThrowsWithReasonMatching([allArray valuesForAggregateKeyPaths:@[@"@min.foo"]], @"foo.*AggregateObject");
+    RLMAssertThrowsWithReasonMatching([allArray valuesForAggregateKeyPaths:@[@"@sum.dateCol"]], @"not supported for date");
+    RLMAssertThrowsWithReasonMatching([allArray valuesForAggregateKeyPaths:@[@"@max.boolCol"]], @"not supported for bool");
+}
+
+- (void)testGroupBy
+{
+    RLMRealm *realm = [RLMRealm defaultRealm];
+    RLMResults *allArray = [AggregateObject allObjects];
+    XCTAssertEqualObjects([allArray groupBy:@"boolCol" aggregates:@[@"@sum.intCol"]], @[]);
+
+    NSDate *dateMinInput = [NSDate dateWithTimeIntervalSince1970:(int64_t)[[NSDate date] timeIntervalSince1970]];
+    NSDate *dateMaxInput = [dateMinInput dateByAddingTimeInterval:1000];
+
+    [realm beginWriteTransaction];
+    [AggregateObject createInRealm:realm withValue:@[@0, @1.2f, @0.0, @YES, dateMinInput]];
+    [AggregateObject createInRealm:realm withValue:@[@1, @0.0f, @2.5, @NO, dateMaxInput]];
+    [AggregateObject createInRealm:realm withValue:@[@3, @1.2f, @0.0, @YES, dateMinInput]];
+    [AggregateObject createInRealm:realm withValue:@[@5, @0.0f, @2.5, @NO, dateMaxInput]];
+    [realm commitWriteTransaction];
+
+    NSArray *groups = [allArray groupBy:@"boolCol" aggregates:@[@"@sum.intCol", @"@max.doubleCol", @"@min.dateCol"]];
+    XCTAssertEqualObjects(groups, (@[@{@"boolCol": @YES, @"@count": @2, @"@sum.intCol": @3, @"@max.doubleCol": @0.0, @"@min.dateCol": dateMinInput},
+                                     @{@"boolCol": @NO, @"@count": @2, @"@sum.intCol": @6, @"@max.doubleCol": @2.5, @"@min.dateCol": dateMaxInput}]));
+
+    // groups are in the order their first object appears after filtering and sorting
+    groups = [[AggregateObject objectsWhere:@"intCol > 0"] groupBy:@"dateCol" aggregates:@[@"@avg.intCol"]];
+    XCTAssertEqualObjects(groups, (@[@{@"dateCol": dateMaxInput, @"@count": @2, @"@avg.intCol": @3.0},
+                                     @{@"dateCol": dateMinInput, @"@count": @1, @"@avg.intCol": @3.0}]));
+    groups = [[allArray sortedResultsUsingProperty:@"intCol" ascending:NO] groupBy:@"intCol" aggregates:@[]];
+    XCTAssertEqualObjects([groups valueForKey:@"intCol"], (@[@5, @3, @1, @0]));
+
+    // groups of an indexed property, including nil
+    [realm beginWriteTransaction];
+    [IndexedStringObject createInRealm:realm withValue:@[@"b"]];
+    [IndexedStringObject createInRealm:realm withValue:@[@"a"]];
+    [IndexedStringObject createInRealm:realm withValue:@[NSNull.null]];
+    [IndexedStringObject createInRealm:realm withValue:@[@"b"]];
+    [realm commitWriteTransaction];
+    groups = [[IndexedStringObject allObjects] groupBy:@"stringCol" aggregates:@[]];
+    XCTAssertEqualObjects(groups, (@[@{@"stringCol": @"b", @"@count": @2},
+                                     @{@"stringCol": @"a", @"@count": @1},
+                                     @{@"stringCol": NSNull.null, @"@count": @1}]));
+    groups = [[IndexedStringObject objectsWhere:@"stringCol != 'b'"] groupBy:@"stringCol" aggregates:@[]];
+    XCTAssertEqualObjects(groups, (@[@{@"stringCol": @"a", @"@count": @1},
+                                     @{@"stringCol": NSNull.null, @"@count": @1}]));
+
+    RLMAssertThrowsWithReasonMatching([allArray groupBy:@"doubleCol" aggregates:@[]], @"not supported for double");
+    RLMAssertThrowsWithReasonMatching([allArray groupBy:@"foo" aggregates:@[]], @"foo.*AggregateObject");
+    RLMAssertThrowsWithReasonMatching([allArray groupBy:@"intCol" aggregates:@[@"@sum.dateCol"]], @"not supported for date");
+}
+
 - (void)testValueForCollectionOperationKeyPath
 {
     RLMRealm *realm = [RLMRealm defaultRealm];
@@ -386,7 +716,7 @@
 
     // collection
     XCTAssertEqualObjects([allCompanies valueForKeyPath:@"@unionOfObjects.name"], (@[@"InspiringNames LLC", @"ABC AG", @"ABC AG"]));
-    XCTAssertEqualObjects([allCompanies valueForKeyPath:@"@distinctUnionOfObjects.name"], (@[@"ABC AG", @"InspiringNames LLC"]));
+    XCTAssertEqualObjects([allCompanies valueForKeyPath:@"@distinctUnionOfObjects.name"], (@[@"InspiringNames LLC", @"ABC AG"]));
     XCTAssertEqualObjects([allCompanies valueForKeyPath:@"employees.@unionOfArrays.name"], (@[@"Joe", @"John", @"Jill", @"A", @"B", @"C", @"A"]));
     XCTAssertEqualObjects([NSSet setWithArray:[allCompanies valueForKeyPath:@"employees.@distinctUnionOfArrays.name"]], ([NSSet setWithArray:@[@"Joe", @"John", @"Jill", @"A", @"B", @"C"]]));
 
@@ -589,165 +919,1686 @@
     XCTAssertEqual(30, [(EmployeeObject *)filtered[1] age]);
 }
 
-- (void)testLiveUpdateFirst {
+- (void)testQueryUpdatedAfterChangesOnBackgroundThread {
     RLMRealm *realm = self.realmWithTestPath;
+    realm.autorefresh = NO;
     [realm beginWriteTransaction];
-    [IntObject createInRealm:realm withValue:@[@0]];
-
-    RLMResults *objects = [IntObject objectsInRealm:realm where:@"intCol = 0"];
-    XCTAssertNotNil([objects firstObject]);
-    [objects.firstObject setIntCol:1];
-    XCTAssertNil([objects firstObject]);
+    for (int i = 0; i < 10; ++i) {
+        [IntObject createInRealm:realm withValue:@[@(i)]];
+    }
+    [realm commitWriteTransaction];
 
-    [realm cancelWriteTransaction];
+    RLMResults *results = [IntObject objectsInRealm:realm where:@"intCol >= 5"];
+    RLMResults *sorted = [results sortedResultsUsingProperty:@"intCol" ascending:NO];
+    XCTAssertEqual(5U, results.count);
+    XCTAssertEqual(9, [sorted.firstObject intCol]);
+
+    void (^writeInBackground)(void (^)(RLMRealm *)) = ^(void (^block)(RLMRealm *)) {
+        [self dispatchAsyncAndWait:^{
+            RLMRealm *realm = self.realmWithTestPath;
+            [realm beginWriteTransaction];
+            block(realm);
+            [realm commitWriteTransaction];
+        }];
+        [realm refresh];
+    };
+
+    // Modifying a row which doesn't match and still doesn't
+    writeInBackground(^(RLMRealm *realm) {
+        [[IntObject allObjectsInRealm:realm][0] setIntCol:1];
+    });
+    XCTAssertEqual(5U, results.count);
+    XCTAssertEqual(5U, sorted.count);
+
+    // Inserting a row which doesn't match
+    writeInBackground(^(RLMRealm *realm) {
+        [IntObject createInRealm:realm withValue:@[@0]];
+    });
+    XCTAssertEqual(5U, results.count);
+    XCTAssertEqual(5U, sorted.count);
+
+    // Inserting a row which does match
+    writeInBackground(^(RLMRealm *realm) {
+        [IntObject createInRealm:realm withValue:@[@20]];
+    });
+    XCTAssertEqual(6U, results.count);
+    XCTAssertEqual(20, [results.lastObject intCol]);
+    XCTAssertEqual(20, [sorted.firstObject intCol]);
+
+    // Modifying a matching row so that it no longer matches
+    writeInBackground(^(RLMRealm *realm) {
+        [[IntObject allObjectsInRealm:realm][5] setIntCol:0];
+    });
+    XCTAssertEqual(5U, results.count);
+    XCTAssertEqual(6, [results.firstObject intCol]);
+    XCTAssertEqual(6, [sorted.lastObject intCol]);
+
+    // Modifying the sort property of a matching row
+    writeInBackground(^(RLMRealm *realm) {
+        [[IntObject allObjectsInRealm:realm][6] setIntCol:30];
+    });
+    XCTAssertEqual(5U, results.count);
+    XCTAssertEqual(30, [sorted.firstObject intCol]);
+    XCTAssertEqual(7, [sorted.lastObject intCol]);
+
+    // Deleting a matching row
+    writeInBackground(^(RLMRealm *realm) {
+        [realm deleteObject:[IntObject objectsInRealm:realm where:@"intCol = 30"].firstObject];
+    });
+    XCTAssertEqual(4U, results.count);
+    XCTAssertEqual(4U, sorted.count);
+    XCTAssertEqual(20, [sorted.firstObject intCol]);
+    XCTAssertEqual(0U, [results objectsWhere:@"intCol = 30"].count);
 }
 
-- (void)testLiveUpdateLast {
+- (void)testQueryUpdatedAfterCancelledWrite {
     RLMRealm *realm = self.realmWithTestPath;
     [realm beginWriteTransaction];
-    [IntObject createInRealm:realm withValue:@[@0]];
+    for (int i = 0; i < 10; ++i) {
+        [IntObject createInRealm:realm withValue:@[@(i)]];
+    }
+    [realm commitWriteTransaction];
 
-    RLMResults *objects = [IntObject objectsInRealm:realm where:@"intCol = 0"];
-    XCTAssertNotNil([objects lastObject]);
-    [objects.lastObject setIntCol:1];
-    XCTAssertNil([objects lastObject]);
+    RLMResults *results = [IntObject objectsInRealm:realm where:@"intCol >= 5"];
+    XCTAssertEqual(5U, results.count);
 
+    [realm beginWriteTransaction];
+    [realm deleteObjects:[IntObject objectsInRealm:realm where:@"intCol = 5"]];
     [realm cancelWriteTransaction];
-}
 
-static vm_size_t get_resident_size() {
-    struct task_basic_info info;
-    mach_msg_type_number_t size = sizeof(info);
-    task_info(mach_task_self(), TASK_BASIC_INFO, (task_info_t)&info, &size);
-    return info.resident_size;
+    XCTAssertEqual(5U, results.count);
+    XCTAssertEqual(5, [results.firstObject intCol]);
 }
 
-- (void)testQueryMemoryUsage {
-    RLMRealm *realm = [self realmWithTestPath];
-
+- (void)testQueryReadInCancelledWriteIsRerun {
+    RLMRealm *realm = self.realmWithTestPath;
     [realm beginWriteTransaction];
-    StringObject *obj = [[StringObject alloc] init];
-    obj.stringCol = @"a";
-    [realm addObject:obj];
+    for (int i = 0; i < 10; ++i) {
+        [IntObject createInRealm:realm withValue:@[@(i)]];
+    }
     [realm commitWriteTransaction];
 
-    NSPredicate *pred = [NSPredicate predicateWithFormat:@"stringCol = 'a'"];
+    RLMResults *results = [IntObject objectsInRealm:realm where:@"intCol >= 5"];
+    RLMResults *sorted = [results sortedResultsUsingProperty:@"intCol" ascending:NO];
 
-    // Check for memory leaks when creating queries by comparing the memory usage
-    // before and after creating a very large number of queries. Anything less
-    // than doubling is allowed as there's going to be some natural fluctuation,
-    // and failing to clean up 10k queries resulted in far more than doubling.
-    vm_size_t size = get_resident_size();
-    for (int i = 0; i < 10000; ++i) {
-        @autoreleasepool {
-            RLMResults *matches = [StringObject objectsInRealm:realm withPredicate:pred];
-            XCTAssertEqualObjects([matches[0] stringCol], @"a");
-        }
+    [realm beginWriteTransaction];
+    for (int i = 10; i < 15; ++i) {
+        [IntObject createInRealm:realm withValue:@[@(i)]];
     }
-    XCTAssert(get_resident_size() < size * 2);
+    XCTAssertEqual(10U, results.count);
+    XCTAssertEqual(14, [sorted[0] intCol]);
+    XCTAssertEqual(14, [results[9] intCol]);
+    [realm cancelWriteTransaction];
+
+    XCTAssertEqual(5U, results.count);
+    XCTAssertEqual(5U, sorted.count);
+    XCTAssertEqual(9, [sorted[0] intCol]);
+    XCTAssertEqual(9, [results[4] intCol]);
+    RLMAssertThrowsWithReasonMatching(results[5], @"out of bounds");
 }
 
-- (void)testDeleteAllObjects
-{
+- (void)testCachedCountAndFirstResetByCancelledWrite {
     RLMRealm *realm = self.realmWithTestPath;
-
     [realm beginWriteTransaction];
-    [StringObject createInRealm:realm withValue:@[@"name1"]];
-    [StringObject createInRealm:realm withValue:@[@"name2"]];
+    IntObject *five = [IntObject createInRealm:realm withValue:@[@5]];
     [realm commitWriteTransaction];
 
-    RLMResults *results = [StringObject objectsInRealm:realm where:@"stringCol = 'name1'"];
-    RLMAssertThrowsWithReasonMatching([realm deleteObjects:results], @"write transaction");
-    [realm beginWriteTransaction];
-    [realm deleteObjects:results];
-    [realm commitWriteTransaction];
-    XCTAssertEqual(0U, results.count);
-    XCTAssertEqual(1U, [StringObject allObjectsInRealm:realm].count);
+    RLMResults *results = [IntObject objectsInRealm:realm where:@"intCol < 10"];
 
-    results = [StringObject allObjectsInRealm:realm];
-    RLMAssertThrowsWithReasonMatching([realm deleteObjects:results], @"write transaction");
     [realm beginWriteTransaction];
-    [realm deleteObjects:results];
-    [realm commitWriteTransaction];
-    XCTAssertEqual(0U, results.count);
-    XCTAssertEqual(0U, [StringObject allObjectsInRealm:realm].count);
+    IntObject *one = [IntObject createInRealm:realm withValue:@[@1]];
+    [five setIntCol:20];
+    XCTAssertEqual(1U, results.count);
+    XCTAssertEqual(1, [results.firstObject intCol]);
+    XCTAssertEqual(0U, [results indexOfObject:one]);
+    [realm cancelWriteTransaction];
+
+    XCTAssertEqual(1U, results.count);
+    XCTAssertEqual(5, [results.firstObject intCol]);
+    XCTAssertEqual(0U, [results indexOfObject:five]);
 }
 
-- (void)testEnumerateAndDeleteTableResults {
+- (void)testCachedCountAndFirstUpdatedAfterChanges {
     RLMRealm *realm = self.realmWithTestPath;
-    const int count = 40;
-
+    realm.autorefresh = NO;
     [realm beginWriteTransaction];
-    for (int i = 0; i < count; ++i) {
+    for (int i = 0; i < 10; ++i) {
         [IntObject createInRealm:realm withValue:@[@(i)]];
     }
+    [realm commitWriteTransaction];
 
-    int enumeratedCount = 0;
-    for (IntObject *io in [IntObject allObjectsInRealm:realm]) {
-        ++enumeratedCount;
-        [realm deleteObject:io];
-    }
-
-    XCTAssertEqual(0U, [IntObject allObjectsInRealm:realm].count);
-    XCTAssertEqual(count, enumeratedCount);
-
+    RLMResults *results = [IntObject objectsInRealm:realm where:@"intCol >= 5"];
+    XCTAssertEqual(5U, results.count);
+    XCTAssertEqual(5, [results.firstObject intCol]);
+
+    void (^writeInBackground)(void (^)(RLMRealm *)) = ^(void (^block)(RLMRealm *)) {
+        [self dispatchAsyncAndWait:^{
+            RLMRealm *realm = self.realmWithTestPath;
+            [realm beginWriteTransaction];
+            block(realm);
+            [realm commitWriteTransaction];
+        }];
+        [realm refresh];
+    };
+
+    // Changes to other tables leave the cached values in place
+    writeInBackground(^(RLMRealm *realm) {
+        [StringObject createInRealm:realm withValue:@[@"a"]];
+    });
+    XCTAssertEqual(5U, results.count);
+    XCTAssertEqual(5, [results.firstObject intCol]);
+
+    writeInBackground(^(RLMRealm *realm) {
+        [IntObject createInRealm:realm withValue:@[@20]];
+    });
+    XCTAssertEqual(6U, results.count);
+
+    writeInBackground(^(RLMRealm *realm) {
+        [[IntObject allObjectsInRealm:realm][5] setIntCol:0];
+    });
+    XCTAssertEqual(5U, results.count);
+    XCTAssertEqual(6, [results.firstObject intCol]);
+
+    // Local writes, including ones which are cancelled
+    [realm beginWriteTransaction];
+    [[IntObject allObjectsInRealm:realm][6] setIntCol:0];
+    XCTAssertEqual(4U, results.count);
+    XCTAssertEqual(7, [results.firstObject intCol]);
     [realm cancelWriteTransaction];
-}
-
-- (void)testEnumerateAndMutateQueryCondition {
-    RLMRealm *realm = self.realmWithTestPath;
-    const int count = 40;
+    XCTAssertEqual(5U, results.count);
+    XCTAssertEqual(6, [results.firstObject intCol]);
 
     [realm beginWriteTransaction];
-    for (int i = 0; i < count; ++i) {
-        [IntObject createInRealm:realm withValue:@[@(0)]];
-    }
-
-    int enumeratedCount = 0;
-    for (IntObject *io in [IntObject objectsInRealm:realm where:@"intCol = 0"]) {
-        ++enumeratedCount;
-        io.intCol = enumeratedCount;
-    }
-
-    XCTAssertEqual(0U, [IntObject objectsInRealm:realm where:@"intCol = 0"].count);
-    XCTAssertEqual(count, enumeratedCount);
-
-    [realm cancelWriteTransaction];
+    [realm deleteObjects:[IntObject allObjectsInRealm:realm]];
+    [realm commitWriteTransaction];
+    XCTAssertEqual(0U, results.count);
+    XCTAssertNil(results.firstObject);
 }
 
-- (void)testManualRefreshDuringEnumeration {
+- (void)testSortOnIndexedProperty {
     RLMRealm *realm = self.realmWithTestPath;
-    const int count = 40;
-
+    realm.autorefresh = NO;
     [realm beginWriteTransaction];
-    for (int i = 0; i < count; ++i) {
-        [IntObject createInRealm:realm withValue:@[@(0)]];
+    for (NSString *str in @[@"d", @"b", @"e", @"a", @"c", @"b"]) {
+        [IndexedStringObject createInRealm:realm withValue:@[str]];
     }
     [realm commitWriteTransaction];
 
-    realm.autorefresh = NO;
+    NSArray *(^values)(RLMResults *) = ^(RLMResults *results) {
+        return [results valueForKey:@"stringCol"];
+    };
+
+    RLMResults *ascending = [[IndexedStringObject allObjectsInRealm:realm] sortedResultsUsingProperty:@"stringCol" ascending:YES];
+    RLMResults *descending = [[IndexedStringObject allObjectsInRealm:realm] sortedResultsUsingProperty:@"stringCol" ascending:NO];
+    RLMResults *filtered = [[IndexedStringObject objectsInRealm:realm where:@"stringCol != 'c'"]
+                            sortedResultsUsingProperty:@"stringCol" ascending:YES];
+    RLMResults *limited = [descending resultsWithLimit:2 offset:1];
+
+    XCTAssertEqualObjects((@[@"a", @"b", @"b", @"c", @"d", @"e"]), values(ascending));
+    XCTAssertEqualObjects((@[@"e", @"d", @"c", @"b", @"b", @"a"]), values(descending));
+    XCTAssertEqualObjects((@[@"a", @"b", @"b", @"d", @"e"]), values(filtered));
+    XCTAssertEqualObjects((@[@"d", @"c"]), values(limited));
+
+    // Results sharing the sorted rows see changes made to the table
     [self dispatchAsyncAndWait:^{
         RLMRealm *realm = self.realmWithTestPath;
         [realm beginWriteTransaction];
-        // FIXME: this is roundabout because `table.clear()` does not update
-        // table views correctly
-        [realm deleteObjects:[IntObject objectsInRealm:realm where:@"intCol = 0"]];
+        [IndexedStringObject createInRealm:realm withValue:@[@"f"]];
+        [IndexedStringObject createInRealm:realm withValue:@[@"0"]];
+        [realm deleteObjects:[IndexedStringObject objectsInRealm:realm where:@"stringCol = 'd'"]];
         [realm commitWriteTransaction];
     }];
+    [realm refresh];
 
-    int enumeratedCount = 0;
-    for (IntObject *io in [IntObject allObjectsInRealm:realm]) {
-        [realm refresh];
-        XCTAssertTrue(io.invalidated);
-        ++enumeratedCount;
-    }
+    XCTAssertEqualObjects((@[@"0", @"a", @"b", @"b", @"c", @"e", @"f"]), values(ascending));
+    XCTAssertEqualObjects((@[@"f", @"e", @"c", @"b", @"b", @"a", @"0"]), values(descending));
+    XCTAssertEqualObjects((@[@"0", @"a", @"b", @"b", @"e", @"f"]), values(filtered));
+    XCTAssertEqualObjects((@[@"e", @"c"]), values(limited));
 
-    XCTAssertEqual(enumeratedCount, count);
+    // Local changes to the sort column
+    [realm beginWriteTransaction];
+    [[IndexedStringObject objectsInRealm:realm where:@"stringCol = '0'"].firstObject setStringCol:@"g"];
+    XCTAssertEqualObjects((@[@"a", @"b", @"b", @"c", @"e", @"f", @"g"]), values(ascending));
+    XCTAssertEqualObjects((@[@"f", @"e"]), values(limited));
+    [realm cancelWriteTransaction];
 }
 
-- (void)testCallInvalidateDuringEnumeration {
+- (void)testSortOnIndexedPropertyAsQueryBecomesLessSelective {
     RLMRealm *realm = self.realmWithTestPath;
-    const int count = 40;
+    realm.autorefresh = NO;
+    [realm beginWriteTransaction];
+    for (int i = 0; i < 20; ++i) {
+        [IndexedStringObject createInRealm:realm withValue:@[[NSString stringWithFormat:@"b%02d", 19 - i]]];
+    }
+    [IndexedStringObject createInRealm:realm withValue:@[@"a1"]];
+    [realm commitWriteTransaction];
+
+    NSArray *(^values)(RLMResults *) = ^(RLMResults *results) {
+        return [results valueForKey:@"stringCol"];
+    };
+
+    // Few rows match at first, so the matches are sorted directly, and then
+    // most of them do, so later versions filter the shared sorted rows
+    RLMResults *results = [[IndexedStringObject objectsInRealm:realm where:@"stringCol BEGINSWITH 'a'"]
+                           sortedResultsUsingProperty:@"stringCol" ascending:YES];
+    RLMResults *limited = [results resultsWithLimit:2 offset:1];
+    XCTAssertEqualObjects((@[@"a1"]), values(results));
+    XCTAssertEqualObjects((@[]), values(limited));
+
+    for (int i = 0; i < 3; ++i) {
+        [self dispatchAsyncAndWait:^{
+            RLMRealm *realm = self.realmWithTestPath;
+            [realm beginWriteTransaction];
+            if (i < 2) {
+                // Rename half of the remaining 'b' rows each time
+                RLMResults *all = [IndexedStringObject allObjectsInRealm:realm];
+                for (NSUInteger j = i * 10; j < (i + 1) * 10; ++j) {
+                    IndexedStringObject *obj = all[j];
+                    obj.stringCol = [@"a" stringByAppendingString:[obj.stringCol substringFromIndex:1]];
+                }
+            }
+            else {
+                [realm deleteObjects:[IndexedStringObject objectsInRealm:realm where:@"stringCol != 'a1'"]];
+            }
+            [realm commitWriteTransaction];
+        }];
+        [realm refresh];
+
+        NSArray *expected = [[[IndexedStringObject objectsInRealm:realm where:@"stringCol BEGINSWITH 'a'"]
+                              valueForKey:@"stringCol"] sortedArrayUsingSelector:@selector(compare:)];
+        XCTAssertEqualObjects(expected, values(results));
+        NSRange window = NSMakeRange(1, MIN(2U, expected.count > 1 ? expected.count - 1 : 0));
+        XCTAssertEqualObjects([expected subarrayWithRange:window], values(limited));
+    }
+}
+
+- (void)testExplain {
+    RLMRealm *realm = self.realmWithTestPath;
+    [realm beginWriteTransaction];
+    for (int i = 0; i < 10; ++i) {
+        [IntObject createInRealm:realm withValue:@[@(i)]];
+        [IndexedStringObject createInRealm:realm withValue:@[i % 2 ? @"a" : @"b"]];
+    }
+    [realm commitWriteTransaction];
+
+    void (^assertContains)(NSString *, NSString *) = ^(NSString *explanation, NSString *expected) {
+        XCTAssertNotEqual((NSUInteger)NSNotFound, [explanation rangeOfString:expected].location, @"%@", explanation);
+    };
+
+    RLMResults *results = [[IntObject objectsInRealm:realm where:@"intCol > 5"] sortedResultsUsingProperty:@"intCol" ascending:NO];
+    NSString *explanation = [results explain];
+    assertContains(explanation, @"intCol > 5 [scan] SORT(intCol DESC)");
+    assertContains(explanation, @"Objects scanned: 10\n");
+    assertContains(explanation, @"Matches: 4\n");
+    XCTAssertEqual(9, [results.firstObject intCol]);
+
+    explanation = [[[results objectsWhere:@"intCol < 8"] resultsWithLimit:1 offset:1] explain];
+    assertContains(explanation, @"intCol > 5 [scan] AND intCol < 8 [scan] SORT(intCol DESC) LIMIT(1) OFFSET(1)");
+
+    explanation = [[IndexedStringObject objectsInRealm:realm where:@"stringCol = 'a' OR stringCol BEGINSWITH 'b'"] explain];
+    assertContains(explanation, @"stringCol == \"a\" [index] OR stringCol BEGINSWITH \"b\" [ordered index]");
+    assertContains(explanation, @"Matches: 10\n");
+
+    // The conditions of an AND group are checked cheapest and most selective first
+    explanation = [[IndexedStringObject objectsInRealm:realm where:@"stringCol CONTAINS 'b' AND stringCol = 'b'"] explain];
+    assertContains(explanation, @"(stringCol == \"b\" [index] AND stringCol CONTAINS \"b\" [scan])");
+    assertContains(explanation, @"Matches: 5\n");
+
+    explanation = [[IntObject allObjectsInRealm:realm] explain];
+    assertContains(explanation, @"Query: TRUEPREDICATE\n");
+}
+
+- (void)testEvaluateAsynchronously {
+    RLMRealm *realm = self.realmWithTestPath;
+    [realm transactionWithBlock:^{
+        for (int i = 0; i < 10; ++i) {
+            [IntObject createInRealm:realm withValue:@[@(i)]];
+        }
+    }];
+
+    RLMResults *results = [[IntObject objectsInRealm:realm where:@"intCol >= 5"]
+                           sortedResultsUsingProperty:@"intCol" ascending:NO];
+    XCTestExpectation *expectation = [self expectationWithDescription:@"results evaluated"];
+    [results evaluateAsynchronously:^(RLMResults *evaluated, NSError *error) {
+        XCTAssertNil(error);
+        XCTAssertEqual(5U, evaluated.count);
+        XCTAssertEqual(9, [evaluated.firstObject intCol]);
+        XCTAssertEqual(5, [evaluated.lastObject intCol]);
+        [expectation fulfill];
+    }];
+    [self waitForExpectationsWithTimeout:2.0 handler:nil];
+}
+
+- (void)testEvaluateAsynchronouslyManyQueriesAtOnce {
+    RLMRealm *realm = self.realmWithTestPath;
+    [realm transactionWithBlock:^{
+        for (int i = 0; i < 10; ++i) {
+            [IntObject createInRealm:realm withValue:@[@(i)]];
+        }
+    }];
+
+    // Every query is run by the shared worker and delivered
+    for (int i = 0; i < 50; ++i) {
+        RLMResults *results = [IntObject objectsInRealm:realm where:@"intCol >= %d", i % 10];
+        XCTestExpectation *expectation = [self expectationWithDescription:@"results evaluated"];
+        [results evaluateAsynchronously:^(RLMResults *evaluated, NSError *error) {
+            XCTAssertNil(error);
+            XCTAssertEqual((NSUInteger)(10 - i % 10), evaluated.count);
+            [expectation fulfill];
+        }];
+    }
+    [self waitForExpectationsWithTimeout:5.0 handler:nil];
+
+    // Pinned versions are released once the queries have run, so later
+    // writes don't have to keep the versions the queries ran on
+    for (int i = 0; i < 10; ++i) {
+        [realm transactionWithBlock:^{
+            [IntObject createInRealm:realm withValue:@[@(i)]];
+        }];
+    }
+    XCTAssertLessThanOrEqual([realm fileSpaceUsage].versionCount, 2ULL);
+}
+
+- (void)testEvaluateAsynchronouslyInWriteTransactionCallsBlockImmediately {
+    RLMRealm *realm = self.realmWithTestPath;
+    [realm beginWriteTransaction];
+    [IntObject createInRealm:realm withValue:@[@1]];
+
+    __block bool called = false;
+    [[IntObject objectsInRealm:realm where:@"intCol = 1"] evaluateAsynchronously:^(RLMResults *evaluated, NSError *error) {
+        XCTAssertNil(error);
+        XCTAssertEqual(1U, evaluated.count);
+        called = true;
+    }];
+    XCTAssertTrue(called);
+    [realm cancelWriteTransaction];
+}
+
+- (void)testNotificationBlockReportsChangedIndexes {
+    RLMRealm *realm = self.realmWithTestPath;
+    realm.autorefresh = NO;
+    [realm transactionWithBlock:^{
+        for (int i = 0; i < 10; ++i) {
+            [IntObject createInRealm:realm withValue:@[@(i)]];
+        }
+    }];
+
+    __block RLMCollectionChange *change;
+    __block int calls = 0;
+    RLMResults *results = [IntObject objectsInRealm:realm where:@"intCol >= 5"];
+    RLMNotificationToken *token = [results addNotificationBlock:^(RLMResults *r, RLMCollectionChange *c, NSError *error) {
+        XCTAssertNil(error);
+        XCTAssertEqual(results, r);
+        change = c;
+        ++calls;
+    }];
+
+    void (^writeInBackground)(void (^)(RLMRealm *)) = ^(void (^block)(RLMRealm *)) {
+        [self dispatchAsyncAndWait:^{
+            RLMRealm *realm = self.realmWithTestPath;
+            [realm beginWriteTransaction];
+            block(realm);
+            [realm commitWriteTransaction];
+        }];
+        [realm refresh];
+    };
+
+    // Changing a row which isn't in the results
+    writeInBackground(^(RLMRealm *realm) {
+        [[IntObject allObjectsInRealm:realm][0] setIntCol:1];
+    });
+    XCTAssertEqual(0, calls);
+
+    writeInBackground(^(RLMRealm *realm) {
+        [[IntObject allObjectsInRealm:realm][6] setIntCol:16];
+    });
+    XCTAssertEqual(1, calls);
+    XCTAssertEqual(0U, change.deletions.count);
+    XCTAssertEqual(0U, change.insertions.count);
+    XCTAssertEqualObjects([NSIndexSet indexSetWithIndex:1], change.modifications);
+
+    writeInBackground(^(RLMRealm *realm) {
+        [IntObject createInRealm:realm withValue:@[@20]];
+    });
+    XCTAssertEqual(2, calls);
+    XCTAssertEqual(0U, change.deletions.count);
+    XCTAssertEqualObjects([NSIndexSet indexSetWithIndex:5], change.insertions);
+    XCTAssertEqual(0U, change.modifications.count);
+
+    // Deleting the first object moves the last row of the table into its
+    // place, which moves it to the start of the unsorted results
+    writeInBackground(^(RLMRealm *realm) {
+        [realm deleteObject:[IntObject objectsInRealm:realm where:@"intCol = 5"].firstObject];
+    });
+    XCTAssertEqual(3, calls);
+    NSMutableIndexSet *deletions = [NSMutableIndexSet indexSetWithIndex:0];
+    [deletions addIndex:5];
+    XCTAssertEqualObjects(deletions, change.deletions);
+    XCTAssertEqualObjects([NSIndexSet indexSetWithIndex:0], change.insertions);
+    XCTAssertEqual(20, [results.firstObject intCol]);
+
+    [realm removeNotification:token];
+    writeInBackground(^(RLMRealm *realm) {
+        [IntObject createInRealm:realm withValue:@[@30]];
+    });
+    XCTAssertEqual(3, calls);
+}
+
+- (void)testNotificationBlockIsCalledForWritesOnTheSameRealm {
+    RLMRealm *realm = self.realmWithTestPath;
+    realm.autorefresh = NO;
+    [realm transactionWithBlock:^{
+        for (int i = 0; i < 10; ++i) {
+            [IntObject createInRealm:realm withValue:@[@(i)]];
+        }
+    }];
+
+    __block RLMCollectionChange *change;
+    __block int calls = 0;
+    RLMResults *results = [IntObject objectsInRealm:realm where:@"intCol >= 5"];
+    RLMNotificationToken *token = [results addNotificationBlock:^(RLMResults *r, RLMCollectionChange *c, NSError *error) {
+        XCTAssertNil(error);
+        XCTAssertEqual(results, r);
+        change = c;
+        ++calls;
+    }];
+
+    // Local writes are reported as every object being replaced, without
+    // waiting for another thread to commit
+    [realm transactionWithBlock:^{
+        [IntObject createInRealm:realm withValue:@[@20]];
+    }];
+    XCTAssertEqual(1, calls);
+    XCTAssertEqualObjects([NSIndexSet indexSetWithIndexesInRange:NSMakeRange(0, 5)], change.deletions);
+    XCTAssertEqualObjects([NSIndexSet indexSetWithIndexesInRange:NSMakeRange(0, 6)], change.insertions);
+    XCTAssertEqual(6U, results.count);
+
+    // Cancelled writes don't change anything
+    [realm beginWriteTransaction];
+    [IntObject createInRealm:realm withValue:@[@30]];
+    [realm cancelWriteTransaction];
+    XCTAssertEqual(1, calls);
+
+    // Changes from other threads which are followed by a local write are
+    // delivered when the local write is committed
+    [self dispatchAsyncAndWait:^{
+        RLMRealm *realm = self.realmWithTestPath;
+        [realm transactionWithBlock:^{
+            [IntObject createInRealm:realm withValue:@[@40]];
+        }];
+    }];
+    [realm transactionWithBlock:^{
+        [IntObject createInRealm:realm withValue:@[@50]];
+    }];
+    XCTAssertEqual(2, calls);
+    XCTAssertEqual(8U, results.count);
+    XCTAssertEqualObjects([NSIndexSet indexSetWithIndexesInRange:NSMakeRange(0, 8)], change.insertions);
+
+    [realm removeNotification:token];
+}
+
+- (void)testNotificationBlockReportsModificationsAtIndexesAfterDeletions {
+    RLMRealm *realm = self.realmWithTestPath;
+    realm.autorefresh = NO;
+    [realm transactionWithBlock:^{
+        for (int i = 0; i < 10; ++i) {
+            [IntObject createInRealm:realm withValue:@[@(i)]];
+        }
+    }];
+
+    __block RLMCollectionChange *change;
+    __block int calls = 0;
+    RLMResults *results = [[IntObject allObjectsInRealm:realm] sortedResultsUsingProperty:@"intCol" ascending:YES];
+    RLMNotificationToken *token = [results addNotificationBlock:^(RLMResults *r, RLMCollectionChange *c, NSError *error) {
+        XCTAssertNil(error);
+        change = c;
+        ++calls;
+    }];
+
+    // Modifying an object and then deleting it moves the last object into
+    // its row, which isn't reported as modified
+    [self dispatchAsyncAndWait:^{
+        RLMRealm *realm = self.realmWithTestPath;
+        [realm transactionWithBlock:^{
+            IntObject *object = [IntObject objectsInRealm:realm where:@"intCol = 5"].firstObject;
+            object.intCol = 50;
+            [realm deleteObject:object];
+        }];
+    }];
+    [realm refresh];
+    XCTAssertEqual(1, calls);
+    XCTAssertEqualObjects([NSIndexSet indexSetWithIndex:5], change.deletions);
+    XCTAssertEqual(0U, change.insertions.count);
+    XCTAssertEqual(0U, change.modifications.count);
+
+    // The last object is reported as modified at its new row when it's
+    // modified before deleting the object whose row it moves into
+    [self dispatchAsyncAndWait:^{
+        RLMRealm *realm = self.realmWithTestPath;
+        [realm transactionWithBlock:^{
+            RLMResults *objects = [IntObject allObjectsInRealm:realm];
+            [objects.lastObject setIntCol:9];
+            [realm deleteObject:[IntObject objectsInRealm:realm where:@"intCol = 0"].firstObject];
+        }];
+    }];
+    [realm refresh];
+    XCTAssertEqual(2, calls);
+    XCTAssertEqualObjects([NSIndexSet indexSetWithIndex:0], change.deletions);
+    XCTAssertEqual(0U, change.insertions.count);
+    XCTAssertEqualObjects([NSIndexSet indexSetWithIndex:6], change.modifications);
+
+    [realm removeNotification:token];
+}
+
+- (void)testProjectedResults {
+    RLMRealm *realm = self.realmWithTestPath;
+    realm.autorefresh = NO;
+    [realm transactionWithBlock:^{
+        [EmployeeObject createInRealm:realm withValue:@{@"name": @"Joe", @"age": @40, @"hired": @YES}];
+        [EmployeeObject createInRealm:realm withValue:@{@"name": @"Jill", @"age": @30, @"hired": @NO}];
+    }];
+
+    RLMResults *results = [[EmployeeObject allObjectsInRealm:realm] resultsProjectingProperties:@[@"name", @"age"]];
+    XCTAssertEqual(2U, results.count);
+    XCTAssertEqualObjects((@[@"Joe", @"Jill"]), [results valueForKey:@"name"]);
+    XCTAssertEqualObjects((@[@{@"name": @"Joe", @"age": @40}, @{@"name": @"Jill", @"age": @30}]),
+                          [results dictionariesWithValuesForKeys:@[@"name", @"age"]]);
+    RLMAssertThrowsWithReasonMatching([results valueForKey:@"hired"], @"not projected");
+    RLMAssertThrowsWithReasonMatching([results dictionariesWithValuesForKeys:@[@"name", @"hired"]], @"not projected");
+    RLMAssertThrowsWithReasonMatching([results resultsProjectingProperties:@[@"invalid"]], @"invalid");
+
+    NSArray *json = [NSJSONSerialization JSONObjectWithData:[results JSONDataWithLinkDepth:0] options:0 error:nil];
+    XCTAssertEqualObjects((@[@{@"name": @"Joe", @"age": @40}, @{@"name": @"Jill", @"age": @30}]), json);
+
+    // The projection is kept by derived results
+    RLMResults *sorted = [[results objectsWhere:@"age > 0"] sortedResultsUsingProperty:@"age" ascending:YES];
+    XCTAssertEqualObjects((@[@"Jill", @"Joe"]), [sorted valueForKey:@"name"]);
+    RLMAssertThrowsWithReasonMatching([sorted valueForKey:@"hired"], @"not projected");
+
+    __block RLMCollectionChange *change;
+    __block int calls = 0;
+    RLMNotificationToken *token = [results addNotificationBlock:^(RLMResults *r, RLMCollectionChange *c, NSError *error) {
+        XCTAssertEqual(results, r);
+        XCTAssertNil(error);
+        change = c;
+        ++calls;
+    }];
+
+    void (^writeInBackground)(void (^)(RLMRealm *)) = ^(void (^block)(RLMRealm *)) {
+        [self dispatchAsyncAndWait:^{
+            RLMRealm *realm = self.realmWithTestPath;
+            [realm beginWriteTransaction];
+            block(realm);
+            [realm commitWriteTransaction];
+        }];
+        [realm refresh];
+    };
+
+    // Changing a property which isn't projected isn't reported
+    writeInBackground(^(RLMRealm *realm) {
+        [[EmployeeObject allObjectsInRealm:realm][0] setHired:NO];
+    });
+    XCTAssertEqual(0, calls);
+
+    writeInBackground(^(RLMRealm *realm) {
+        [[EmployeeObject allObjectsInRealm:realm][1] setAge:31];
+    });
+    XCTAssertEqual(1, calls);
+    XCTAssertEqualObjects([NSIndexSet indexSetWithIndex:1], change.modifications);
+
+    [realm removeNotification:token];
+}
+
+- (void)testResultsWithLimit {
+    RLMRealm *realm = self.realmWithTestPath;
+    [realm beginWriteTransaction];
+    for (int i = 0; i < 100; ++i) {
+        [IntObject createInRealm:realm withValue:@[@((i * 37) % 100)]];
+    }
+    [realm commitWriteTransaction];
+
+    RLMResults *all = [IntObject allObjectsInRealm:realm];
+    RLMResults *limited = [all resultsWithLimit:10 offset:0];
+    XCTAssertEqual(10U, limited.count);
+    XCTAssertEqual(0, [limited.firstObject intCol]);
+    XCTAssertEqual(33, [limited.lastObject intCol]);
+    XCTAssertEqual(0U, [[all resultsWithLimit:10 offset:200] count]);
+
+    RLMResults *sorted = [[all sortedResultsUsingProperty:@"intCol" ascending:NO] resultsWithLimit:5 offset:3];
+    XCTAssertEqual(5U, sorted.count);
+    XCTAssertEqual(96, [sorted.firstObject intCol]);
+    XCTAssertEqual(92, [sorted.lastObject intCol]);
+    XCTAssertEqual(1U, [sorted indexOfObjectWhere:@"intCol = 95"]);
+    XCTAssertEqual((NSUInteger)NSNotFound, [sorted indexOfObjectWhere:@"intCol = 99"]);
+    XCTAssertEqualObjects(@(96 + 95 + 94 + 93 + 92), [sorted sumOfProperty:@"intCol"]);
+    XCTAssertEqualObjects(@92, [sorted minOfProperty:@"intCol"]);
+
+    // Filtering and sorting apply to the objects in the window
+    RLMResults *filtered = [[sorted objectsWhere:@"intCol < 95"] sortedResultsUsingProperty:@"intCol" ascending:YES];
+    XCTAssertEqualObjects((@[@92, @93, @94]), [filtered valueForKey:@"intCol"]);
+    XCTAssertEqual(0U, [sorted objectsWhere:@"intCol < 50"].count);
+    XCTAssertEqualObjects((@[@92, @93]), [[[sorted sortedResultsUsingProperty:@"intCol" ascending:YES]
+                                           resultsWithLimit:2 offset:0] valueForKey:@"intCol"]);
+
+    // Stays live as objects are added
+    [realm beginWriteTransaction];
+    [IntObject createInRealm:realm withValue:@[@100]];
+    [realm commitWriteTransaction];
+    XCTAssertEqual(97, [sorted.firstObject intCol]);
+    XCTAssertEqual(93, [sorted.lastObject intCol]);
+    XCTAssertEqualObjects((@[@93, @94]), [filtered valueForKey:@"intCol"]);
+}
+
+- (void)testResultsPrefetchingKeyPaths {
+    RLMRealm *realm = self.realmWithTestPath;
+    [realm beginWriteTransaction];
+    for (int i = 0; i < 50; ++i) {
+        [OwnerObject createInRealm:realm withValue:@[[NSString stringWithFormat:@"%d", i],
+                                                      i % 5 ? @[[NSString stringWithFormat:@"dog %d", i], @(i)] : NSNull.null]];
+    }
+    [realm commitWriteTransaction];
+
+    RLMResults *owners = [[OwnerObject allObjectsInRealm:realm] resultsPrefetchingKeyPaths:@[@"dog.dogName"]];
+    XCTAssertEqual(50U, owners.count);
+    int i = 0;
+    for (OwnerObject *owner in owners) {
+        if (i % 5) {
+            DogObject *dog = owner.dog;
+            XCTAssertEqual(dog, owner.dog);
+            XCTAssertEqualObjects(([NSString stringWithFormat:@"dog %d", i]), dog.dogName);
+        }
+        else {
+            XCTAssertNil(owner.dog);
+        }
+        ++i;
+    }
+    XCTAssertEqual(50, i);
+
+    // Changing the link after prefetching isn't hidden by the prefetched accessor
+    OwnerObject *owner;
+    for (OwnerObject *o in owners) {
+        if (o.dog) {
+            owner = o;
+            break;
+        }
+    }
+    [realm beginWriteTransaction];
+    owner.dog = [DogObject createInRealm:realm withValue:@[@"new dog", @1]];
+    [realm commitWriteTransaction];
+    XCTAssertEqualObjects(@"new dog", owner.dog.dogName);
+
+    XCTAssertThrows([owners resultsPrefetchingKeyPaths:@[@"cat"]]);
+    XCTAssertThrows([owners resultsPrefetchingKeyPaths:@[@"name.dog"]]);
+}
+
+- (void)testResultsAfterObjectAtIndex {
+    RLMRealm *realm = self.realmWithTestPath;
+    [realm beginWriteTransaction];
+    for (int i = 0; i < 10; ++i) {
+        [IntObject createInRealm:realm withValue:@[@(i)]];
+    }
+    [realm commitWriteTransaction];
+
+    RLMResults *sorted = [[IntObject allObjectsInRealm:realm] sortedResultsUsingProperty:@"intCol" ascending:YES];
+    RLMResults *page = [sorted resultsAfterObjectAtIndex:2 limit:3];
+    RLMResults *limited = [sorted resultsWithLimit:3 offset:3];
+    XCTAssertEqualObjects((@[@3, @4, @5]), [page valueForKey:@"intCol"]);
+    XCTAssertEqualObjects((@[@3, @4, @5]), [limited valueForKey:@"intCol"]);
+
+    // Deleting objects before the page, including the one it starts after,
+    // shifts an offset but not a page
+    [realm beginWriteTransaction];
+    [realm deleteObjects:[IntObject objectsInRealm:realm where:@"intCol <= 2"]];
+    [realm commitWriteTransaction];
+    XCTAssertEqualObjects((@[@3, @4, @5]), [page valueForKey:@"intCol"]);
+    XCTAssertEqualObjects((@[@6, @7, @8]), [limited valueForKey:@"intCol"]);
+
+    XCTAssertEqualObjects((@[@6, @7, @8]), [[page resultsAfterObjectAtIndex:2 limit:3] valueForKey:@"intCol"]);
+    XCTAssertEqualObjects((@[@5, @6, @7]), [[page objectsWhere:@"intCol > 4"] valueForKey:@"intCol"]);
+    XCTAssertThrows([page sortedResultsUsingProperty:@"intCol" ascending:NO]);
+    XCTAssertThrows([page resultsWithLimit:1 offset:0]);
+    XCTAssertThrows([sorted resultsAfterObjectAtIndex:10 limit:3]);
+    XCTAssertThrows([[IntObject allObjectsInRealm:realm] resultsAfterObjectAtIndex:0 limit:3]);
+
+    [realm beginWriteTransaction];
+    [StringObject createInRealm:realm withValue:@[@"a"]];
+    [realm commitWriteTransaction];
+    RLMResults *strings = [[StringObject allObjectsInRealm:realm] sortedResultsUsingProperty:@"stringCol" ascending:YES];
+    XCTAssertThrows([strings resultsAfterObjectAtIndex:0 limit:1]);
+}
+
+- (void)testTextIndexedContains {
+    RLMRealm *realm = self.realmWithTestPath;
+    [realm beginWriteTransaction];
+    for (NSString *str in @[@"The quick brown fox", @"jumps over the lazy dog", @"Foxes and hounds", @"nothing here"]) {
+        [TextIndexedStringObject createInRealm:realm withValue:@[str]];
+    }
+    [TextIndexedStringObject createInRealm:realm withValue:@[NSNull.null]];
+    [realm commitWriteTransaction];
+
+    NSArray *(^matches)(NSString *) = ^(NSString *predicate) {
+        return [[TextIndexedStringObject objectsInRealm:realm where:predicate] valueForKey:@"stringCol"];
+    };
+
+    XCTAssertEqualObjects((@[@"The quick brown fox"]), matches(@"stringCol CONTAINS 'fox'"));
+    XCTAssertEqualObjects((@[@"The quick brown fox", @"Foxes and hounds"]), matches(@"stringCol CONTAINS[c] 'FOX'"));
+    XCTAssertEqualObjects((@[@"jumps over the lazy dog"]), matches(@"stringCol CONTAINS 'ump'"));
+    XCTAssertEqualObjects((@[@"jumps over the lazy dog"]), matches(@"stringCol CONTAINS 'lazy dog'"));
+    XCTAssertEqualObjects(@[], matches(@"stringCol CONTAINS 'cat'"));
+
+    RLMResults *results = [TextIndexedStringObject objectsInRealm:realm where:@"stringCol CONTAINS[c] 'fox'"];
+    XCTAssertNotEqual((NSUInteger)NSNotFound, [[results explain] rangeOfString:@"stringCol CONTAINS[c] \"fox\" [text index]"].location);
+
+    // The index is updated for changes made on other threads
+    [self dispatchAsyncAndWait:^{
+        RLMRealm *realm = self.realmWithTestPath;
+        [realm beginWriteTransaction];
+        [[TextIndexedStringObject objectsInRealm:realm where:@"stringCol = 'nothing here'"].firstObject setStringCol:@"a fox here"];
+        [realm deleteObjects:[TextIndexedStringObject objectsInRealm:realm where:@"stringCol BEGINSWITH 'The'"]];
+        [TextIndexedStringObject createInRealm:realm withValue:@[@"outfoxed"]];
+        [realm commitWriteTransaction];
+    }];
+    [realm refresh];
+    XCTAssertEqualObjects((@[@"Foxes and hounds", @"a fox here", @"outfoxed"]), [[results valueForKey:@"stringCol"] sortedArrayUsingSelector:@selector(compare:)]);
+
+    // Local changes aren't in the index, so queries in write transactions check every row
+    [realm beginWriteTransaction];
+    [TextIndexedStringObject createInRealm:realm withValue:@[@"firefox"]];
+    XCTAssertEqual(4U, results.count);
+    XCTAssertEqualObjects((@[@"a fox here", @"outfoxed", @"firefox"]), matches(@"stringCol CONTAINS 'fox'"));
+    [realm commitWriteTransaction];
+    XCTAssertEqual(4U, [TextIndexedStringObject objectsInRealm:realm where:@"stringCol CONTAINS[c] 'fox'"].count);
+}
+
+- (void)testExpiredObjectsAreExcluded {
+    RLMRealm *realm = self.realmWithTestPath;
+    NSDate *now = [NSDate date];
+    NSDate *expired = [now dateByAddingTimeInterval:-7200];
+    [realm beginWriteTransaction];
+    [ExpiringObject createInRealm:realm withValue:@[@"a", now]];
+    [ExpiringObject createInRealm:realm withValue:@[@"b", expired]];
+    [ExpiringObject createInRealm:realm withValue:@[@"c", now]];
+    [ExpiringObject createInRealm:realm withValue:@[@"ab", expired]];
+    [realm commitWriteTransaction];
+
+    NSArray *(^names)(RLMResults *) = ^(RLMResults *results) {
+        return [[results valueForKey:@"name"] sortedArrayUsingSelector:@selector(compare:)];
+    };
+    XCTAssertEqual(2U, [ExpiringObject allObjectsInRealm:realm].count);
+    XCTAssertEqualObjects((@[@"a", @"c"]), names([ExpiringObject allObjectsInRealm:realm]));
+    XCTAssertEqualObjects(@[@"a"], names([ExpiringObject objectsInRealm:realm where:@"name BEGINSWITH 'a'"]));
+    XCTAssertEqualObjects(@[@"c"], names([ExpiringObject objectsInRealm:realm where:@"name = 'b' OR name = 'c'"]));
+    XCTAssertEqualObjects((@[@"c", @"a"]), [[[ExpiringObject allObjectsInRealm:realm] sortedResultsUsingProperty:@"name" ascending:NO] valueForKey:@"name"]);
+}
+
+- (void)testExpiredObjectsAreExcludedFromArrays {
+    RLMRealm *realm = self.realmWithTestPath;
+    NSDate *now = [NSDate date];
+    [realm beginWriteTransaction];
+    ExpiringArrayObject *obj = [ExpiringArrayObject createInRealm:realm withValue:@[@[@[@"a", now],
+                                                                                     @[@"b", [now dateByAddingTimeInterval:-7200]],
+                                                                                     @[@"c", now]]]];
+    [realm commitWriteTransaction];
+
+    XCTAssertEqual(3U, obj.array.count);
+    RLMResults *results = [obj.array objectsWhere:@"name != 'c'"];
+    XCTAssertEqual(1U, results.count);
+    XCTAssertEqualObjects(@[@"a"], [results valueForKey:@"name"]);
+    XCTAssertEqualObjects((@[@"c", @"a"]), [[obj.array sortedResultsUsingProperty:@"name" ascending:NO] valueForKey:@"name"]);
+}
+
+- (void)testObjectsWhichExpireAfterQueryingAreExcluded {
+    RLMRealm *realm = self.realmWithTestPath;
+    NSDate *now = [NSDate date];
+    [realm beginWriteTransaction];
+    [ExpiringObject createInRealm:realm withValue:@[@"a", now]];
+    [ExpiringObject createInRealm:realm withValue:@[@"b", [now dateByAddingTimeInterval:-3600 + 1]]];
+    [realm commitWriteTransaction];
+
+    RLMResults *all = [ExpiringObject allObjectsInRealm:realm];
+    RLMResults *sorted = [all sortedResultsUsingProperty:@"name" ascending:YES];
+    XCTAssertEqual(2U, all.count);
+    XCTAssertEqualObjects((@[@"a", @"b"]), [sorted valueForKey:@"name"]);
+
+    // Nothing has changed in the Realm, but time has passed
+    [NSThread sleepForTimeInterval:2.5];
+    XCTAssertEqual(1U, all.count);
+    XCTAssertEqualObjects(@[@"a"], [sorted valueForKey:@"name"]);
+}
+
+- (void)testCompoundIndexes {
+    RLMRealm *realm = self.realmWithTestPath;
+    [realm beginWriteTransaction];
+    [CompoundKeyObject createInRealm:realm withValue:@[@1, @"a", @1]];
+    [CompoundKeyObject createInRealm:realm withValue:@[@1, @"b", @2]];
+    [CompoundKeyObject createInRealm:realm withValue:@[@2, @"a", @3]];
+    [CompoundKeyObject createInRealm:realm withValue:@[@1, @"c", @5]];
+
+    // The compound primary key is unique, and can be used to update objects
+    XCTAssertThrows([CompoundKeyObject createInRealm:realm withValue:@[@1, @"a", @9]]);
+    CompoundKeyObject *updated = [CompoundKeyObject createOrUpdateInRealm:realm withValue:@[@1, @"a", @7]];
+    XCTAssertEqual(7, updated.version);
+    XCTAssertThrows(updated.accountId = 3);
+    XCTAssertThrows(updated[@"itemId"] = @"d");
+    [realm commitWriteTransaction];
+    XCTAssertEqual(4U, [CompoundKeyObject allObjectsInRealm:realm].count);
+
+    NSArray *(^versions)(NSString *) = ^(NSString *predicate) {
+        RLMResults *results = [CompoundKeyObject objectsInRealm:realm where:predicate];
+        return [[results valueForKey:@"version"] sortedArrayUsingSelector:@selector(compare:)];
+    };
+
+    XCTAssertEqualObjects(@[@2], versions(@"accountId == 1 AND itemId == 'b'"));
+    XCTAssertEqualObjects(@[], versions(@"accountId == 2 AND itemId == 'b'"));
+    XCTAssertEqualObjects((@[@2, @5]), versions(@"accountId == 1 AND version >= 2 AND version < 7"));
+    XCTAssertEqualObjects((@[@5, @7]), versions(@"version > 2 AND accountId == 1"));
+    XCTAssertEqualObjects((@[@5]), versions(@"accountId == 1 AND itemId != 'a' AND version > 2"));
+
+    NSString *explanation = [[CompoundKeyObject objectsInRealm:realm where:@"accountId == 1 AND version > 2"] explain];
+    XCTAssertNotEqual((NSUInteger)NSNotFound, [explanation rangeOfString:@"(accountId == 1 [compound index] AND version > 2 [compound index])"].location, @"%@", explanation);
+
+    // The indexes are updated for changes made on other threads
+    RLMResults *results = [CompoundKeyObject objectsInRealm:realm where:@"accountId == 1 AND version > 1"];
+    XCTAssertEqual(3U, results.count);
+    [self dispatchAsyncAndWait:^{
+        RLMRealm *realm = self.realmWithTestPath;
+        [realm beginWriteTransaction];
+        [realm deleteObjects:[CompoundKeyObject objectsInRealm:realm where:@"itemId == 'b'"]];
+        [CompoundKeyObject createInRealm:realm withValue:@[@1, @"d", @4]];
+        [[CompoundKeyObject objectsInRealm:realm where:@"accountId == 2"].firstObject setVersion:6];
+        [realm commitWriteTransaction];
+    }];
+    [realm refresh];
+    XCTAssertEqualObjects((@[@4, @5, @7]), [[results valueForKey:@"version"] sortedArrayUsingSelector:@selector(compare:)]);
+    XCTAssertEqualObjects(@[@6], versions(@"accountId == 2 AND version == 6"));
+
+    // Queries in write transactions see local changes
+    [realm beginWriteTransaction];
+    [CompoundKeyObject createInRealm:realm withValue:@[@1, @"e", @8]];
+    XCTAssertEqualObjects((@[@4, @5, @7, @8]), versions(@"accountId == 1 AND version > 1"));
+    XCTAssertEqual(4U, results.count);
+    [realm cancelWriteTransaction];
+}
+
+- (void)testOrderedIndexOnStringRanges {
+    RLMRealm *realm = self.realmWithTestPath;
+    [realm beginWriteTransaction];
+    for (NSString *str in @[@"apple", @"apricot", @"banana", @"ap", @"b", @"\u00e9clair"]) {
+        [IndexedStringObject createInRealm:realm withValue:@[str]];
+    }
+    [realm commitWriteTransaction];
+
+    NSArray *(^matches)(NSString *) = ^(NSString *predicate) {
+        RLMResults *results = [IndexedStringObject objectsInRealm:realm where:predicate];
+        return [[results valueForKey:@"stringCol"] sortedArrayUsingSelector:@selector(compare:)];
+    };
+
+    XCTAssertEqualObjects((@[@"ap", @"apple", @"apricot"]), matches(@"stringCol BEGINSWITH 'ap'"));
+    XCTAssertEqualObjects((@[@"apple"]), matches(@"stringCol BEGINSWITH 'app'"));
+    XCTAssertEqualObjects(@[], matches(@"stringCol BEGINSWITH 'c'"));
+    XCTAssertEqualObjects((@[@"\u00e9clair"]), matches(@"stringCol BEGINSWITH '\u00e9'"));
+    XCTAssertEqualObjects((@[@"apricot", @"b"]), matches(@"stringCol > 'apple' AND stringCol <= 'b'"));
+    XCTAssertEqualObjects((@[@"banana", @"\u00e9clair"]), matches(@"stringCol > 'b'"));
+
+    RLMResults *results = [IndexedStringObject objectsInRealm:realm where:@"stringCol BEGINSWITH 'ap'"];
+    XCTAssertNotEqual((NSUInteger)NSNotFound, [[results explain] rangeOfString:@"stringCol BEGINSWITH \"ap\" [ordered index]"].location);
+
+    // The index is updated for changes made on other threads
+    XCTAssertEqual(3U, results.count);
+    [self dispatchAsyncAndWait:^{
+        RLMRealm *realm = self.realmWithTestPath;
+        [realm beginWriteTransaction];
+        [[IndexedStringObject objectsInRealm:realm where:@"stringCol == 'banana'"].firstObject setStringCol:@"apex"];
+        [realm deleteObjects:[IndexedStringObject objectsInRealm:realm where:@"stringCol == 'apple'"]];
+        [IndexedStringObject createInRealm:realm withValue:@[@"apt"]];
+        [realm commitWriteTransaction];
+    }];
+    [realm refresh];
+    XCTAssertEqualObjects((@[@"ap", @"apex", @"apricot", @"apt"]), [[results valueForKey:@"stringCol"] sortedArrayUsingSelector:@selector(compare:)]);
+
+    // Local changes aren't in the index, so queries in write transactions check every row
+    [realm beginWriteTransaction];
+    [IndexedStringObject createInRealm:realm withValue:@[@"apothecary"]];
+    XCTAssertEqual(5U, results.count);
+    XCTAssertEqualObjects((@[@"b"]), matches(@"stringCol > 'apt' AND stringCol < 'c'"));
+    [realm cancelWriteTransaction];
+}
+
+- (void)testOrderedIndexOnNumericRanges {
+    RLMRealm *realm = self.realmWithTestPath;
+    [realm beginWriteTransaction];
+    for (int i = 0; i < 10; ++i) {
+        [IndexedEventObject createInRealm:realm withValue:@[@((i * 7) % 10), [NSDate dateWithTimeIntervalSince1970:i * 100]]];
+    }
+    [realm commitWriteTransaction];
+
+    NSArray *(^sequences)(NSString *, NSArray *) = ^(NSString *predicate, NSArray *args) {
+        RLMResults *results = [IndexedEventObject objectsInRealm:realm
+                                                   withPredicate:[NSPredicate predicateWithFormat:predicate argumentArray:args]];
+        return [[results valueForKey:@"sequence"] sortedArrayUsingSelector:@selector(compare:)];
+    };
+    NSDate *(^date)(NSTimeInterval) = ^(NSTimeInterval seconds) {
+        return [NSDate dateWithTimeIntervalSince1970:seconds];
+    };
+
+    XCTAssertEqualObjects((@[@7, @8, @9]), sequences(@"sequence > 6", @[]));
+    XCTAssertEqualObjects((@[@0, @1, @2]), sequences(@"sequence <= 2", @[]));
+    XCTAssertEqualObjects((@[@0, @1, @2]), sequences(@"3 > sequence", @[]));
+    XCTAssertEqualObjects((@[@3, @4, @5]), sequences(@"sequence BETWEEN {3, 5}", @[]));
+    XCTAssertEqualObjects(@[], sequences(@"sequence BETWEEN {5, 3}", @[]));
+    XCTAssertEqualObjects((@[@1, @4, @8]), sequences(@"timestamp >= %@ AND timestamp < %@", @[date(200), date(500)]));
+    XCTAssertEqualObjects((@[@1, @4, @8]), sequences(@"timestamp BETWEEN %@", @[@[date(150), date(499.5)]]));
+
+    RLMResults *results = [IndexedEventObject objectsInRealm:realm where:@"sequence BETWEEN {3, 5}"];
+    XCTAssertNotEqual((NSUInteger)NSNotFound, [[results explain] rangeOfString:@"[ordered index]"].location);
+
+    // The index is updated for changes made on other threads
+    [self dispatchAsyncAndWait:^{
+        RLMRealm *realm = self.realmWithTestPath;
+        [realm beginWriteTransaction];
+        [realm deleteObjects:[IndexedEventObject objectsInRealm:realm where:@"sequence == 4"]];
+        [[IndexedEventObject objectsInRealm:realm where:@"sequence == 9"].firstObject setSequence:3];
+        [IndexedEventObject createInRealm:realm withValue:@[@5, date(1000)]];
+        [realm commitWriteTransaction];
+    }];
+    [realm refresh];
+    XCTAssertEqualObjects((@[@3, @3, @5, @5]), [[results valueForKey:@"sequence"] sortedArrayUsingSelector:@selector(compare:)]);
+
+    // Queries in write transactions see local changes
+    [realm beginWriteTransaction];
+    [IndexedEventObject createInRealm:realm withValue:@[@4, date(1100)]];
+    XCTAssertEqual(5U, results.count);
+    XCTAssertEqualObjects((@[@4, @5]), sequences(@"timestamp > %@", @[date(900)]));
+    [realm cancelWriteTransaction];
+}
+
+- (void)testOrderedIndexRejectsNonIntegralBoundsLikeUnindexedProperties {
+    RLMRealm *realm = self.realmWithTestPath;
+    [realm transactionWithBlock:^{
+        [IndexedEventObject createInRealm:realm withValue:@[@5, NSDate.date]];
+        [IntObject createInRealm:realm withValue:@[@5]];
+    }];
+
+    void (^assertThrows)(void) = ^{
+        RLMAssertThrowsWithReasonMatching([IndexedEventObject objectsInRealm:realm where:@"sequence < 5.5"], @"Expected object of type int");
+        RLMAssertThrowsWithReasonMatching(([IndexedEventObject objectsInRealm:realm where:@"sequence >= %@", @5.5]), @"Expected object of type int");
+        RLMAssertThrowsWithReasonMatching([IndexedEventObject objectsInRealm:realm where:@"5.5 > sequence"], @"Expected object of type int");
+        RLMAssertThrowsWithReasonMatching([IndexedEventObject objectsInRealm:realm where:@"sequence BETWEEN {4.5, 5}"], @"type int for BETWEEN");
+        RLMAssertThrowsWithReasonMatching([IntObject objectsInRealm:realm where:@"intCol < 5.5"], @"Expected object of type int");
+        RLMAssertThrowsWithReasonMatching([IntObject objectsInRealm:realm where:@"intCol BETWEEN {4.5, 5}"], @"type int for BETWEEN");
+    };
+    assertThrows();
+
+    // The same queries are rejected in write transactions, where the index
+    // isn't used
+    [realm beginWriteTransaction];
+    assertThrows();
+    [realm cancelWriteTransaction];
+
+    XCTAssertEqual(1U, [IndexedEventObject objectsInRealm:realm where:@"sequence >= 5"].count);
+    XCTAssertEqual(0U, [IndexedEventObject objectsInRealm:realm where:@"sequence < 5"].count);
+}
+
+- (void)testLinkedIndexedPropertyQueriesUseBacklinks {
+    RLMRealm *realm = self.realmWithTestPath;
+    [realm beginWriteTransaction];
+    IndexedStringObject *a = [IndexedStringObject createInRealm:realm withValue:@[@"a"]];
+    IndexedStringObject *b = [IndexedStringObject createInRealm:realm withValue:@[@"b"]];
+    [IndexedStringObject createInRealm:realm withValue:@[@"c"]];
+    for (id target in @[a, b, a, NSNull.null]) {
+        [LinkIndexedStringObject createInRealm:realm withValue:@[target]];
+    }
+    [realm commitWriteTransaction];
+
+    RLMResults *results = [LinkIndexedStringObject objectsInRealm:realm where:@"objectCol.stringCol == 'a'"];
+    XCTAssertEqual(2U, results.count);
+    XCTAssertEqual(0U, [LinkIndexedStringObject objectsInRealm:realm where:@"objectCol.stringCol == 'c'"].count);
+    XCTAssertEqual(1U, [LinkIndexedStringObject objectsInRealm:realm where:@"'b' == objectCol.stringCol"].count);
+    XCTAssertNotEqual((NSUInteger)NSNotFound, [[results explain] rangeOfString:@"objectCol.stringCol == \"a\" [backlinks]"].location);
+
+    // The matches are found again for changes made on other threads
+    [self dispatchAsyncAndWait:^{
+        RLMRealm *realm = self.realmWithTestPath;
+        [realm beginWriteTransaction];
+        [[IndexedStringObject objectsInRealm:realm where:@"stringCol == 'b'"].firstObject setStringCol:@"a"];
+        [realm deleteObject:[LinkIndexedStringObject allObjectsInRealm:realm].firstObject];
+        [realm commitWriteTransaction];
+    }];
+    [realm refresh];
+    XCTAssertEqual(2U, results.count);
+    XCTAssertEqualObjects((@[@"a", @"a"]), [results valueForKeyPath:@"objectCol.stringCol"]);
+
+    // Queries in write transactions see local changes
+    [realm beginWriteTransaction];
+    [[LinkIndexedStringObject objectsInRealm:realm where:@"objectCol == nil"].firstObject setObjectCol:a];
+    XCTAssertEqual(3U, results.count);
+    [realm cancelWriteTransaction];
+}
+
+- (void)testCachedLinkListAggregates {
+    RLMRealm *realm = self.realmWithTestPath;
+    [realm beginWriteTransaction];
+    for (NSArray *values in @[@[], @[@1], @[@2, @3], @[@4, @5, @6]]) {
+        CachedAggregateArrayObject *obj = [CachedAggregateArrayObject createInRealm:realm withValue:@[@[]]];
+        for (NSNumber *value in values) {
+            [obj.array addObject:[IntObject createInRealm:realm withValue:@[value]]];
+        }
+    }
+    [realm commitWriteTransaction];
+
+    NSUInteger (^count)(NSString *) = ^(NSString *predicate) {
+        return [CachedAggregateArrayObject objectsInRealm:realm where:predicate].count;
+    };
+
+    XCTAssertEqual(2U, count(@"array.@count >= 2"));
+    XCTAssertEqual(1U, count(@"array.@count == 0"));
+    XCTAssertEqual(3U, count(@"1 <= array.@count"));
+    XCTAssertEqual(2U, count(@"array.@sum.intCol > 1"));
+    XCTAssertEqual(1U, count(@"array.@sum.intCol == 15"));
+
+    RLMResults *results = [CachedAggregateArrayObject objectsInRealm:realm where:@"array.@sum.intCol > 4"];
+    XCTAssertNotEqual((NSUInteger)NSNotFound, [[results explain] rangeOfString:@"[cached aggregates]"].location);
+    XCTAssertEqual(2U, results.count);
+
+    // The aggregates are updated for changes made on other threads, both to
+    // the arrays and to the values of the objects in them
+    [self dispatchAsyncAndWait:^{
+        RLMRealm *realm = self.realmWithTestPath;
+        [realm beginWriteTransaction];
+        [[IntObject objectsInRealm:realm where:@"intCol == 1"].firstObject setIntCol:10];
+        [[IntObject objectsInRealm:realm where:@"intCol == 3"].firstObject setIntCol:0];
+        CachedAggregateArrayObject *empty = [CachedAggregateArrayObject objectsInRealm:realm where:@"array.@count == 0"].firstObject;
+        [empty.array addObject:[IntObject createInRealm:realm withValue:@[@7]]];
+        [realm deleteObjects:[IntObject objectsInRealm:realm where:@"intCol == 6"]];
+        [realm commitWriteTransaction];
+    }];
+    [realm refresh];
+    XCTAssertEqual(3U, results.count);
+    XCTAssertEqual(1U, count(@"array.@sum.intCol == 7"));
+    XCTAssertEqual(1U, count(@"array.@sum.intCol == 9"));
+    XCTAssertEqual(0U, count(@"array.@count == 0"));
+    XCTAssertEqual(1U, count(@"array.@count == 2 AND array.@sum.intCol == 2"));
+
+    // Queries in write transactions see local changes
+    [realm beginWriteTransaction];
+    [[IntObject objectsInRealm:realm where:@"intCol == 2"].firstObject setIntCol:20];
+    XCTAssertEqual(4U, results.count);
+    [realm cancelWriteTransaction];
+}
+
+
+    RLMRealm *realm = self.realmWithTestPath;
+    realm.autorefresh = NO;
+    [realm transactionWithBlock:^{
+        for (int i = 0; i < 10; ++i) {
+            [AggregateObject createInRealm:realm withValue:@[@(i), @(i * 0.5f), @(i * 1.5), @(i % 2 == 0), NSDate.date]];
+        }
+    }];
+
+    RLMResults *results = [AggregateObject objectsInRealm:realm where:@"intCol >= 5"];
+    RLMAggregateView *count = [results countView];
+    RLMAggregateView *sum = [results sumViewOfProperty:@"intCol"];
+    RLMAggregateView *average = [results averageViewOfProperty:@"doubleCol"];
+    XCTAssertEqualObjects(@5, count.value);
+    XCTAssertEqualObjects(@35, sum.value);
+    XCTAssertEqualObjects(@10.5, average.value);
+    XCTAssertNil([[AggregateObject objectsInRealm:realm where:@"intCol > 100"] averageViewOfProperty:@"intCol"].value);
+
+    XCTAssertThrows([results sumViewOfProperty:@"dateCol"]);
+    XCTAssertThrows([results sumViewOfProperty:@"missing"]);
+    XCTAssertThrows([[results resultsWithLimit:2 offset:0] countView]);
+
+    __block NSNumber *notifiedSum;
+    __block int calls = 0;
+    RLMNotificationToken *token = [sum addNotificationBlock:^(NSNumber *value) {
+        notifiedSum = value;
+        ++calls;
+    }];
+
+    void (^writeInBackground)(void (^)(RLMRealm *)) = ^(void (^block)(RLMRealm *)) {
+        [self dispatchAsyncAndWait:^{
+            RLMRealm *realm = self.realmWithTestPath;
+            [realm beginWriteTransaction];
+            block(realm);
+            [realm commitWriteTransaction];
+        }];
+        [realm refresh];
+    };
+
+    // Changing objects which don't match, or matching objects without
+    // changing the sum, doesn't call the block
+    writeInBackground(^(RLMRealm *realm) {
+        [[AggregateObject objectsInRealm:realm where:@"intCol == 0"].firstObject setIntCol:1];
+        [[AggregateObject objectsInRealm:realm where:@"intCol == 6"].firstObject setDoubleCol:2];
+    });
+    XCTAssertEqual(0, calls);
+    XCTAssertEqualObjects(@9.1, average.value);
+
+    writeInBackground(^(RLMRealm *realm) {
+        [AggregateObject createInRealm:realm withValue:@[@20, @0, @0, @NO, NSDate.date]];
+        [[AggregateObject objectsInRealm:realm where:@"intCol == 2"].firstObject setIntCol:12];
+    });
+    XCTAssertEqual(1, calls);
+    XCTAssertEqualObjects(@67, notifiedSum);
+    XCTAssertEqualObjects(@7, count.value);
+
+    writeInBackground(^(RLMRealm *realm) {
+        [realm deleteObjects:[AggregateObject objectsInRealm:realm where:@"intCol == 5 OR intCol == 3"]];
+    });
+    XCTAssertEqual(2, calls);
+    XCTAssertEqualObjects(@62, notifiedSum);
+    XCTAssertEqualObjects(@6, count.value);
+    XCTAssertEqualObjects([results sumOfProperty:@"intCol"], sum.value);
+    XCTAssertEqualObjects([results averageOfProperty:@"doubleCol"], average.value);
+
+    // Local writes are seen as they're made
+    [realm beginWriteTransaction];
+    [AggregateObject createInRealm:realm withValue:@[@100, @0, @0, @NO, NSDate.date]];
+    XCTAssertEqualObjects(@162, sum.value);
+    [realm cancelWriteTransaction];
+    XCTAssertEqualObjects(@62, sum.value);
+
+    [realm removeNotification:token];
+    writeInBackground(^(RLMRealm *realm) {
+        [realm deleteObjects:[AggregateObject allObjectsInRealm:realm]];
+    });
+    XCTAssertEqual(2, calls);
+    XCTAssertEqualObjects(@0, sum.value);
+    XCTAssertEqualObjects(@0, count.value);
+    XCTAssertNil(average.value);
+}
+
+- (void)testSortWithLocale {
+    RLMRealm *realm = self.realmWithTestPath;
+    realm.autorefresh = NO;
+    [realm transactionWithBlock:^{
+        for (NSString *value in @[@"b", @"A", @"\u00e9", @"a", @"C", @"e"]) {
+            [StringObject createInRealm:realm withValue:@[value]];
+        }
+    }];
+
+    NSLocale *locale = [NSLocale localeWithLocaleIdentifier:@"en_US"];
+    RLMSortDescriptor *descriptor = [RLMSortDescriptor sortDescriptorWithProperty:@"stringCol" ascending:YES locale:locale];
+    RLMResults *results = [[StringObject allObjectsInRealm:realm] sortedResultsUsingDescriptors:@[descriptor]];
+    XCTAssertEqualObjects((@[@"A", @"a", @"b", @"C", @"e", @"\u00e9"]), [results valueForKey:@"stringCol"]);
+    XCTAssertNotEqual((NSUInteger)NSNotFound, [[results explain] rangeOfString:@"stringCol ASC COLLATE folded:en_US"].location);
+
+    RLMResults *reversed = [[StringObject allObjectsInRealm:realm] sortedResultsUsingDescriptors:@[descriptor.reversedSortDescriptor]];
+    XCTAssertEqualObjects((@[@"\u00e9", @"e", @"C", @"b", @"a", @"A"]), [reversed valueForKey:@"stringCol"]);
+
+    // Objects modified on other threads are sorted by their new values
+    [self dispatchAsyncAndWait:^{
+        RLMRealm *realm = self.realmWithTestPath;
+        [realm beginWriteTransaction];
+        [[StringObject objectsInRealm:realm where:@"stringCol = 'b'"].firstObject setStringCol:@"Z"];
+        [realm deleteObjects:[StringObject objectsInRealm:realm where:@"stringCol = 'A'"]];
+        [StringObject createInRealm:realm withValue:@[@"d"]];
+        [realm commitWriteTransaction];
+    }];
+    [realm refresh];
+    XCTAssertEqualObjects((@[@"a", @"C", @"d", @"e", @"\u00e9", @"Z"]), [results valueForKey:@"stringCol"]);
+
+    // As are objects modified in a write transaction
+    [realm beginWriteTransaction];
+    [[StringObject objectsInRealm:realm where:@"stringCol = 'a'"].firstObject setStringCol:@"f"];
+    XCTAssertEqualObjects((@[@"C", @"d", @"e", @"\u00e9", @"f", @"Z"]), [results valueForKey:@"stringCol"]);
+    [realm cancelWriteTransaction];
+
+    RLMSortDescriptor *intDescriptor = [RLMSortDescriptor sortDescriptorWithProperty:@"intCol" ascending:YES locale:locale];
+    XCTAssertThrows([[IntObject allObjectsInRealm:realm] sortedResultsUsingDescriptors:@[intDescriptor]]);
+}
+
+- (void)testSortedResultsUpdatedAfterChanges {
+    RLMRealm *realm = self.realmWithTestPath;
+    realm.autorefresh = NO;
+    [realm transactionWithBlock:^{
+        for (int i = 0; i < 200; ++i) {
+            [IntObject createInRealm:realm withValue:@[@(i * 37 % 50)]];
+        }
+    }];
+
+    RLMResults *all = [[IntObject allObjectsInRealm:realm] sortedResultsUsingProperty:@"intCol" ascending:YES];
+    RLMResults *filtered = [[IntObject objectsInRealm:realm where:@"intCol > 10"] sortedResultsUsingProperty:@"intCol" ascending:NO];
+    XCTAssertEqual(0, [all[0] intCol]);
+    XCTAssertEqual(49, [filtered[0] intCol]);
+
+    void (^writeInBackground)(void (^)(RLMRealm *)) = ^(void (^block)(RLMRealm *)) {
+        [self dispatchAsyncAndWait:^{
+            RLMRealm *realm = self.realmWithTestPath;
+            [realm beginWriteTransaction];
+            block(realm);
+            [realm commitWriteTransaction];
+        }];
+        [realm refresh];
+    };
+    void (^verify)(void) = ^{
+        RLMResults *expectedAll = [[IntObject allObjectsInRealm:realm] sortedResultsUsingProperty:@"intCol" ascending:YES];
+        RLMResults *expectedFiltered = [[IntObject objectsInRealm:realm where:@"intCol > 10"] sortedResultsUsingProperty:@"intCol" ascending:NO];
+        XCTAssertEqual(expectedAll.count, all.count);
+        XCTAssertEqual(expectedFiltered.count, filtered.count);
+        for (NSUInteger i = 0; i < all.count; ++i) {
+            XCTAssertTrue([all[i] isEqualToObject:expectedAll[i]]);
+        }
+        for (NSUInteger i = 0; i < filtered.count; ++i) {
+            XCTAssertTrue([filtered[i] isEqualToObject:expectedFiltered[i]]);
+        }
+    };
+
+    writeInBackground(^(RLMRealm *realm) {
+        [IntObject createInRealm:realm withValue:@[@5]];
+        [IntObject createInRealm:realm withValue:@[@25]];
+        [IntObject createInRealm:realm withValue:@[@60]];
+    });
+    verify();
+    XCTAssertEqual(60, [filtered[0] intCol]);
+
+    writeInBackground(^(RLMRealm *realm) {
+        RLMResults *objects = [IntObject allObjectsInRealm:realm];
+        [objects[3] setIntCol:11];
+        [objects[150] setIntCol:2];
+    });
+    verify();
+
+    // Deleting objects moves the last objects into their places, which
+    // changes how they're ordered relative to objects with equal values
+    writeInBackground(^(RLMRealm *realm) {
+        RLMResults *objects = [IntObject allObjectsInRealm:realm];
+        [realm deleteObject:objects[10]];
+        [realm deleteObject:objects[0]];
+    });
+    verify();
+
+    // Rows modified before deleting earlier rows in the same commit are
+    // found at the indexes they were moved to
+    writeInBackground(^(RLMRealm *realm) {
+        RLMResults *objects = [IntObject allObjectsInRealm:realm];
+        [objects[objects.count - 1] setIntCol:-1];
+        [objects[objects.count - 2] setIntCol:100];
+        [objects[20] setIntCol:12];
+        [realm deleteObject:objects[5]];
+        [realm deleteObject:objects[20]];
+    });
+    verify();
+    XCTAssertEqual(-1, [all[0] intCol]);
+    XCTAssertEqual(100, [filtered[0] intCol]);
+
+    // As are rows modified by an earlier commit than the deletions
+    [self dispatchAsyncAndWait:^{
+        RLMRealm *realm = self.realmWithTestPath;
+        RLMResults *objects = [IntObject allObjectsInRealm:realm];
+        [realm transactionWithBlock:^{
+            [objects[objects.count - 1] setIntCol:-2];
+            [objects[30] setIntCol:101];
+        }];
+        [realm transactionWithBlock:^{
+            [realm deleteObject:objects[7]];
+            [realm deleteObject:objects[30]];
+        }];
+    }];
+    [realm refresh];
+    verify();
+    XCTAssertEqual(-2, [all[0] intCol]);
+}
+
+- (void)testIndexOfObjectInUnsortedQueryAfterChanges {
+    RLMRealm *realm = self.realmWithTestPath;
+    realm.autorefresh = NO;
+    [realm transactionWithBlock:^{
+        for (int i = 0; i < 10; ++i) {
+            [IntObject createInRealm:realm withValue:@[@(i)]];
+        }
+    }];
+
+    RLMResults *all = [IntObject allObjectsInRealm:realm];
+    RLMResults *results = [IntObject objectsInRealm:realm where:@"intCol >= 5"];
+    XCTAssertEqual(0U, [results indexOfObject:all[5]]);
+    XCTAssertEqual(4U, [results indexOfObject:all[9]]);
+    XCTAssertEqual((NSUInteger)NSNotFound, [results indexOfObject:all[4]]);
+
+    [self dispatchAsyncAndWait:^{
+        RLMRealm *realm = self.realmWithTestPath;
+        [realm beginWriteTransaction];
+        [[IntObject allObjectsInRealm:realm][4] setIntCol:5];
+        [[IntObject allObjectsInRealm:realm][6] setIntCol:2];
+        [realm commitWriteTransaction];
+    }];
+    [realm refresh];
+    XCTAssertEqual((NSUInteger)NSNotFound, [results indexOfObject:all[6]]);
+    XCTAssertEqual(0U, [results indexOfObject:all[4]]);
+    XCTAssertEqual(4U, [results indexOfObject:all[9]]);
+
+    [realm beginWriteTransaction];
+    [all[0] setIntCol:7];
+    XCTAssertEqual(0U, [results indexOfObject:all[0]]);
+    XCTAssertEqual(5U, [results indexOfObject:all[9]]);
+    [realm cancelWriteTransaction];
+    XCTAssertEqual(4U, [results indexOfObject:all[9]]);
+}
+
+- (void)testRowCursor {
+    RLMRealm *realm = self.realmWithTestPath;
+    [realm beginWriteTransaction];
+    for (int i = 0; i < 300; ++i) {
+        [OwnerObject createInRealm:realm withValue:@[[NSString stringWithFormat:@"%d", i],
+                                                      i % 2 ? @[@"dog", @(i)] : NSNull.null]];
+    }
+    [realm commitWriteTransaction];
+
+    RLMResults *dogs = [DogObject objectsInRealm:realm where:@"age > 100"];
+    RLMRowCursor *cursor = [dogs rowCursor];
+    XCTAssertThrows(cursor.index);
+    NSUInteger age = [cursor columnForProperty:@"age"];
+    NSUInteger name = [cursor columnForProperty:@"dogName"];
+    XCTAssertThrows([cursor columnForProperty:@"invalid"]);
+
+    NSUInteger count = 0;
+    int64_t total = 0;
+    while ([cursor next]) {
+        XCTAssertEqual(count, cursor.index);
+        XCTAssertEqualObjects(@"dog", [cursor stringAtColumn:name]);
+        total += [cursor intAtColumn:age];
+        ++count;
+    }
+    XCTAssertEqual(dogs.count, count);
+    XCTAssertEqualObjects([dogs sumOfProperty:@"age"], @(total));
+    XCTAssertFalse([cursor next]);
+
+    cursor = [[OwnerObject allObjectsInRealm:realm] rowCursor];
+    NSUInteger dog = [cursor columnForProperty:@"dog"];
+    XCTAssertTrue([cursor next]);
+    XCTAssertEqual(NSNotFound, [cursor linkAtColumn:dog]);
+    XCTAssertTrue([cursor isNullAtColumn:dog]);
+    XCTAssertThrows([cursor intAtColumn:dog]);
+    XCTAssertTrue([cursor next]);
+    XCTAssertEqual(0U, [cursor linkAtColumn:dog]);
+    XCTAssertFalse([cursor isNullAtColumn:dog]);
+}
+
+- (void)testJSONData {
+    RLMRealm *realm = self.realmWithTestPath;
+    [realm beginWriteTransaction];
+    [OwnerObject createInRealm:realm withValue:@[@"a \"quoted\"\n name", @[@"Fido", @5]]];
+    [OwnerObject createInRealm:realm withValue:@[@"no dog", NSNull.null]];
+    [realm commitWriteTransaction];
+
+    RLMResults *owners = [OwnerObject allObjectsInRealm:realm];
+    NSArray *json = [NSJSONSerialization JSONObjectWithData:[owners JSONDataWithLinkDepth:1] options:0 error:nil];
+    XCTAssertEqualObjects((@[@{@"name": @"a \"quoted\"\n name", @"dog": @{@"dogName": @"Fido", @"age": @5}},
+                             @{@"name": @"no dog", @"dog": NSNull.null}]), json);
+
+    // DogObject has no primary key, so links past the depth limit are null
+    json = [NSJSONSerialization JSONObjectWithData:[owners JSONDataWithLinkDepth:0] options:0 error:nil];
+    XCTAssertEqualObjects(NSNull.null, json[0][@"dog"]);
+
+    json = [NSJSONSerialization JSONObjectWithData:[[owners objectsWhere:@"name = 'x'"] JSONDataWithLinkDepth:1]
+                                           options:0 error:nil];
+    XCTAssertEqualObjects(@[], json);
+
+    NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:@"results.json"];
+    [NSFileManager.defaultManager createFileAtPath:path contents:nil attributes:nil];
+    NSFileHandle *file = [NSFileHandle fileHandleForWritingAtPath:path];
+    NSError *error;
+    XCTAssertTrue([owners writeJSONToFileDescriptor:file.fileDescriptor linkDepth:1 error:&error]);
+    XCTAssertNil(error);
+    [file closeFile];
+    XCTAssertEqualObjects([owners JSONDataWithLinkDepth:1], [NSData dataWithContentsOfFile:path]);
+    [NSFileManager.defaultManager removeItemAtPath:path error:nil];
+
+    XCTAssertFalse([owners writeJSONToFileDescriptor:-1 linkDepth:1 error:&error]);
+    XCTAssertNotNil(error);
+}
+
+- (void)testStatisticsForProperty {
+    RLMRealm *realm = self.realmWithTestPath;
+    id null = NSNull.null;
+    [realm beginWriteTransaction];
+    [AllOptionalTypes createInRealm:realm withValue:@[@3, null, null, @YES, @"b", null, null]];
+    [AllOptionalTypes createInRealm:realm withValue:@[@1, null, null, @NO, @"a", null, null]];
+    [AllOptionalTypes createInRealm:realm withValue:@[@3, null, null, null, null, null, null]];
+    [AllOptionalTypes createInRealm:realm withValue:@[null, null, null, null, null, null, null]];
+    [realm commitWriteTransaction];
+
+    RLMResults *all = [AllOptionalTypes allObjectsInRealm:realm];
+    RLMPropertyStatistics *ints = [all statisticsForProperty:@"intObj"];
+    XCTAssertEqual(4U, ints.count);
+    XCTAssertEqual(1U, ints.nilCount);
+    XCTAssertEqual(2U, ints.distinctCount);
+    XCTAssertEqualObjects(@1, ints.minimum);
+    XCTAssertEqualObjects(@3, ints.maximum);
+
+    RLMPropertyStatistics *strings = [all statisticsForProperty:@"string"];
+    XCTAssertEqual(2U, strings.nilCount);
+    XCTAssertEqual(2U, strings.distinctCount);
+    XCTAssertEqualObjects(@"a", strings.minimum);
+    XCTAssertEqualObjects(@"b", strings.maximum);
+
+    RLMPropertyStatistics *floats = [all statisticsForProperty:@"floatObj"];
+    XCTAssertEqual(4U, floats.nilCount);
+    XCTAssertEqual(0U, floats.distinctCount);
+    XCTAssertNil(floats.minimum);
+    XCTAssertNil(floats.maximum);
+
+    RLMPropertyStatistics *filtered = [[all objectsWhere:@"intObj = 3"] statisticsForProperty:@"boolObj"];
+    XCTAssertEqual(2U, filtered.count);
+    XCTAssertEqual(1U, filtered.nilCount);
+    XCTAssertEqual(1U, filtered.distinctCount);
+    XCTAssertEqualObjects(@YES, filtered.minimum);
+    XCTAssertEqualObjects(@YES, filtered.maximum);
+
+    // The statistics kept by the Realm are recomputed after it changes
+    XCTAssertEqual(4U, [realm statisticsForProperty:@"intObj" ofClass:@"AllOptionalTypes"].count);
+    [realm transactionWithBlock:^{
+        [AllOptionalTypes createInRealm:realm withValue:@[@7, null, null, null, null, null, null]];
+    }];
+    RLMPropertyStatistics *after = [realm statisticsForProperty:@"intObj" ofClass:@"AllOptionalTypes"];
+    XCTAssertEqual(5U, after.count);
+    XCTAssertEqual(3U, after.distinctCount);
+    XCTAssertEqualObjects(@7, after.maximum);
+
+    RLMAssertThrowsWithReasonMatching([[CompanyObject allObjectsInRealm:realm] statisticsForProperty:@"employees"],
+                                      @"statisticsForProperty: is not supported");
+    RLMAssertThrowsWithReasonMatching([all statisticsForProperty:@"invalid"], @"invalid");
+}
+
+- (void)testResultsWithLimitSortedWithDuplicateValues {
+    RLMRealm *realm = self.realmWithTestPath;
+    [realm beginWriteTransaction];
+    for (int i = 0; i < 100; ++i) {
+        int value = i % 10;
+        [AllTypesObject createInRealm:realm withValue:@[@(value % 2 == 0), @(value), @(value), @(value), @"",
+                                                         [NSData data], [NSDate dateWithTimeIntervalSince1970:value],
+                                                         @NO, @(value), @0, NSNull.null]];
+    }
+    [realm commitWriteTransaction];
+
+    RLMResults *all = [AllTypesObject allObjectsInRealm:realm];
+    for (NSString *property in @[@"intCol", @"floatCol", @"doubleCol", @"dateCol", @"boolCol"]) {
+        RLMResults *sorted = [all sortedResultsUsingProperty:property ascending:YES];
+        RLMResults *limited = [sorted resultsWithLimit:15 offset:0];
+        XCTAssertEqual(15U, limited.count);
+        for (NSUInteger i = 0; i < limited.count; ++i) {
+            XCTAssertEqualObjects(sorted[i][property], limited[i][property]);
+        }
+    }
+}
+
+- (void)testResultsWithLimitSortedWithNaN {
+    RLMRealm *realm = self.realmWithTestPath;
+    [realm beginWriteTransaction];
+    for (int i = 0; i < 20; ++i) {
+        [DoubleObject createInRealm:realm withValue:@[i % 5 == 0 ? @(NAN) : @(i)]];
+    }
+    [realm commitWriteTransaction];
+
+    // A value with no order can't be used to bound the rows which need to
+    // be sorted, which would otherwise exclude every row
+    for (NSNumber *ascending in @[@YES, @NO]) {
+        RLMResults *sorted = [[DoubleObject allObjectsInRealm:realm] sortedResultsUsingProperty:@"doubleCol"
+                                                                                      ascending:ascending.boolValue];
+        XCTAssertEqual(5U, [sorted resultsWithLimit:5 offset:2].count);
+        XCTAssertEqual(18U, [sorted resultsWithLimit:50 offset:2].count);
+    }
+}
+
+- (void)testLiveUpdateFirst {
+    RLMRealm *realm = self.realmWithTestPath;
+    [realm beginWriteTransaction];
+    [IntObject createInRealm:realm withValue:@[@0]];
+
+    RLMResults *objects = [IntObject objectsInRealm:realm where:@"intCol = 0"];
+    XCTAssertNotNil([objects firstObject]);
+    [objects.firstObject setIntCol:1];
+    XCTAssertNil([objects firstObject]);
+
+    [realm cancelWriteTransaction];
+}
+
+- (void)testLiveUpdateLast {
+    RLMRealm *realm = self.realmWithTestPath;
+    [realm beginWriteTransaction];
+    [IntObject createInRealm:realm withValue:@[@0]];
+
+    RLMResults *objects = [IntObject objectsInRealm:realm where:@"intCol = 0"];
+    XCTAssertNotNil([objects lastObject]);
+    [objects.lastObject setIntCol:1];
+    XCTAssertNil([objects lastObject]);
+
+    [realm cancelWriteTransaction];
+}
+
+static vm_size_t get_resident_size() {
+    struct task_basic_info info;
+    mach_msg_type_number_t size = sizeof(info);
+    task_info(mach_task_self(), TASK_BASIC_INFO, (task_info_t)&info, &size);
+    return info.resident_size;
+}
+
+- (void)testQueryMemoryUsage {
+    RLMRealm *realm = [self realmWithTestPath];
+
+    [realm beginWriteTransaction];
+    StringObject *obj = [[StringObject alloc] init];
+    obj.stringCol = @"a";
+    [realm addObject:obj];
+    [realm commitWriteTransaction];
+
+    NSPredicate *pred = [NSPredicate predicateWithFormat:@"stringCol = 'a'"];
+
+    // Check for memory leaks when creating queries by comparing the memory usage
+    // before and after creating a very large number of queries. Anything less
+    // than doubling is allowed as there's going to be some natural fluctuation,
+    // and failing to clean up 10k queries resulted in far more than doubling.
+    vm_size_t size = get_resident_size();
+    for (int i = 0; i < 10000; ++i) {
+        @autoreleasepool {
+            RLMResults *matches = [StringObject objectsInRealm:realm withPredicate:pred];
+            XCTAssertEqualObjects([matches[0] stringCol], @"a");
+        }
+    }
+    XCTAssert(get_resident_size() < size * 2);
+}
+
+- (void)testDeleteAllObjects
+{
+    RLMRealm *realm = self.realmWithTestPath;
+
+    [realm beginWriteTransaction];
+    [StringObject createInRealm:realm withValue:@[@"name1"]];
+    [StringObject createInRealm:realm withValue:@[@"name2"]];
+    [realm commitWriteTransaction];
+
+    RLMResults *results = [StringObject objectsInRealm:realm where:@"stringCol = 'name1'"];
+    RLMAssertThrowsWithReasonMatching([realm deleteObjects:results], @"write transaction");
+    [realm beginWriteTransaction];
+    [realm deleteObjects:results];
+    [realm commitWriteTransaction];
+    XCTAssertEqual(0U, results.count);
+    XCTAssertEqual(1U, [StringObject allObjectsInRealm:realm].count);
+
+    results = [StringObject allObjectsInRealm:realm];
+    RLMAssertThrowsWithReasonMatching([realm deleteObjects:results], @"write transaction");
+    [realm beginWriteTransaction];
+    [realm deleteObjects:results];
+    [realm commitWriteTransaction];
+    XCTAssertEqual(0U, results.count);
+    XCTAssertEqual(0U, [StringObject allObjectsInRealm:realm].count);
+}
+
+- (void)testEnumerateAndDeleteTableResults {
+    RLMRealm *realm = self.realmWithTestPath;
+    const int count = 40;
+
+    [realm beginWriteTransaction];
+    for (int i = 0; i < count; ++i) {
+        [IntObject createInRealm:realm withValue:@[@(i)]];
+    }
+
+    int enumeratedCount = 0;
+    for (IntObject *io in [IntObject allObjectsInRealm:realm]) {
+        ++enumeratedCount;
+        [realm deleteObject:io];
+    }
+
+    XCTAssertEqual(0U, [IntObject allObjectsInRealm:realm].count);
+    XCTAssertEqual(count, enumeratedCount);
+
+    [realm cancelWriteTransaction];
+}
+
+- (void)testEnumerateAndMutateQueryCondition {
+    RLMRealm *realm = self.realmWithTestPath;
+    const int count = 40;
+
+    [realm beginWriteTransaction];
+    for (int i = 0; i < count; ++i) {
+        [IntObject createInRealm:realm withValue:@[@(0)]];
+    }
+
+    int enumeratedCount = 0;
+    for (IntObject *io in [IntObject objectsInRealm:realm where:@"intCol = 0"]) {
+        ++enumeratedCount;
+        io.intCol = enumeratedCount;
+    }
+
+    XCTAssertEqual(0U, [IntObject objectsInRealm:realm where:@"intCol = 0"].count);
+    XCTAssertEqual(count, enumeratedCount);
+
+    [realm cancelWriteTransaction];
+}
+
+- (void)testManualRefreshDuringEnumeration {
+    RLMRealm *realm = self.realmWithTestPath;
+    const int count = 40;
+
+    [realm beginWriteTransaction];
+    for (int i = 0; i < count; ++i) {
+        [IntObject createInRealm:realm withValue:@[@(0)]];
+    }
+    [realm commitWriteTransaction];
+
+    realm.autorefresh = NO;
+    [self dispatchAsyncAndWait:^{
+        RLMRealm *realm = self.realmWithTestPath;
+        [realm beginWriteTransaction];
+        // FIXME: this is roundabout because `table.clear()` does not update
+        // table views correctly
+        [realm deleteObjects:[IntObject objectsInRealm:realm where:@"intCol = 0"]];
+        [realm commitWriteTransaction];
+    }];
+
+    int enumeratedCount = 0;
+    for (IntObject *io in [IntObject allObjectsInRealm:realm]) {
+        [realm refresh];
+        XCTAssertTrue(io.invalidated);
+        ++enumeratedCount;
+    }
+
+    XCTAssertEqual(enumeratedCount, count);
+}
+
+- (void)testCallInvalidateDuringEnumeration {
+    RLMRealm *realm = self.realmWithTestPath;
+    const int count = 40;
 
     [realm beginWriteTransaction];
     for (int i = 0; i < count; ++i) {
@@ -803,6 +2654,35 @@ static vm_size_t get_resident_size() {
     XCTAssertEqual(40U, [IntObject objectsInRealm:realm where:@"intCol = 1"].count);
 }
 
+- (void)testMutateDuringNestedEnumerations {
+    RLMRealm *realm = self.realmWithTestPath;
+    const int count = 20;
+
+    [realm beginWriteTransaction];
+    for (int i = 0; i < count; ++i) {
+        [IntObject createInRealm:realm withValue:@[@(0)]];
+    }
+    [realm commitWriteTransaction];
+
+    // the inner enumerations finish and unregister before the ones still in
+    // progress are detached by the write
+    int enumeratedCount = 0;
+    for (IntObject *outer in [IntObject objectsInRealm:realm where:@"intCol = 0"]) {
+        for (__unused IntObject *inner in [IntObject allObjectsInRealm:realm]) {
+        }
+        for (__unused IntObject *inner in [IntObject objectsInRealm:realm where:@"intCol = 0"]) {
+            break;
+        }
+        [realm beginWriteTransaction];
+        outer.intCol = 1;
+        [realm commitWriteTransaction];
+        ++enumeratedCount;
+    }
+
+    XCTAssertEqual(count, enumeratedCount);
+    XCTAssertEqual((NSUInteger)count, [IntObject objectsInRealm:realm where:@"intCol = 1"].count);
+}
+
 - (void)testAllMethodsCheckThread {
     RLMRealm *realm = [RLMRealm defaultRealm];
     [realm transactionWithBlock:^{
@@ -149,12 +149,44 @@ RLM_ARRAY_TYPE(SchemaTestClassSecondChild)
     XCTAssertNil([schema schemaForClassName:@"RLMDynamicObject"]);
 }
 
+- (void)testSharedSchemaObjectClassesAreCached {
+    XCTAssertNotNil([RLMSchema.sharedSchema schemaForClassName:@"StringObject"]);
+
+    // The cache is written in the background by whichever launch built it
+    NSString *caches = NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES).firstObject;
+    NSString *path = [caches stringByAppendingPathComponent:@"io.realm.object-classes.plist"];
+    NSDictionary *cache;
+    for (int i = 0; i < 100 && !cache; ++i) {
+        cache = [NSDictionary dictionaryWithContentsOfFile:path];
+        if (!cache) {
+            usleep(10000);
+        }
+    }
+    XCTAssertNotNil(cache[@"fingerprint"]);
+    XCTAssertTrue([cache[@"classes"] containsObject:@"StringObject"]);
+    XCTAssertFalse([cache[@"classes"] containsObject:@"RLMObject"]);
+}
+
 - (void)testSchemaWithObjectClasses {
     RLMSchema *schema = [RLMSchema schemaWithObjectClasses:@[RLMDynamicObject.class, StringObject.class]];
     XCTAssertEqualObjects((@[@"RLMDynamicObject", @"StringObject"]), [schema.objectSchema valueForKey:@"className"]);
     XCTAssertNil([RLMSchema.sharedSchema schemaForClassName:@"RLMDynamicObject"]);
 }
 
+- (void)testShallowCopyLooksUpItsOwnObjectSchemas {
+    RLMSchema *schema = [RLMSchema schemaWithObjectClasses:@[StringObject.class, IntObject.class]];
+    RLMSchema *copy = [schema shallowCopy];
+    for (RLMObjectSchema *objectSchema in schema.objectSchema) {
+        RLMObjectSchema *copied = [copy schemaForClassName:objectSchema.className];
+        XCTAssertNotEqual(copied, objectSchema);
+        XCTAssertEqual(copied, copy[objectSchema.className]);
+        XCTAssertEqualObjects(copied.className, objectSchema.className);
+        XCTAssertEqual(copied.properties, objectSchema.properties);
+    }
+    XCTAssertNil([copy schemaForClassName:@"AllTypesObject"]);
+    XCTAssertNil([[RLMSchema new] schemaForClassName:@"StringObject"]);
+}
+
 - (void)testInheritanceInitialization
 {
     Class testClasses[] = {
@@ -323,6 +355,32 @@ RLM_ARRAY_TYPE(SchemaTestClassSecondChild)
     XCTAssertThrows(RLMSchema.sharedSchema[@"RLMObject"]);
 }
 
+- (void)testPropertyLookupByName {
+    RLMObjectSchema *objectSchema = [RLMObjectSchema schemaForObjectClass:AllTypesObject.class];
+    for (RLMProperty *prop in objectSchema.properties) {
+        XCTAssertEqual(objectSchema[prop.name], prop);
+        XCTAssertEqual(objectSchema[[prop.name mutableCopy]], prop);
+    }
+    XCTAssertNil(objectSchema[@""]);
+    XCTAssertNil(objectSchema[@"invalid"]);
+    XCTAssertNil(objectSchema[@"boolCox"]);
+
+    // Names which differ only in characters not used by the perfect hash fall
+    // back to looking the property up in the dictionary
+    NSMutableArray *properties = [NSMutableArray array];
+    for (int i = 0; i < 100; ++i) {
+        NSString *name = [NSString stringWithFormat:@"a%02db%02dc", i % 10, i / 10];
+        [properties addObject:[[RLMProperty alloc] initWithName:name type:RLMPropertyTypeInt objectClassName:nil indexed:NO optional:NO]];
+    }
+    objectSchema = [[RLMObjectSchema alloc] initWithClassName:@"Lookup" objectClass:RLMObject.class properties:properties];
+    for (RLMProperty *prop in properties) {
+        XCTAssertEqual(objectSchema[prop.name], prop);
+    }
+    XCTAssertNil(objectSchema[@"a00b00d"]);
+    XCTAssertEqual([objectSchema.shallowCopy objectForKeyedSubscript:@"a12b34c"], objectSchema[@"a12b34c"]);
+    XCTAssertEqualObjects([[objectSchema copy] objectForKeyedSubscript:@"a12b34c"].name, @"a12b34c");
+}
+
 - (void)testDescription {
     NSArray *expectedTypes = @[@"AllTypesObject",
                                @"StringObject",
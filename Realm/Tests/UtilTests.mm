@@ -22,6 +22,10 @@
 #import "RLMUtil.hpp"
 #import "RLMVersion.h"
 
+#import "index_set.hpp"
+
+#import <set>
+
 @interface UtilTests : RLMTestCase
 
 @end
@@ -30,6 +34,16 @@ static BOOL RLMEqualExceptions(NSException *actual, NSException *expected) { \
     return [actual.name isEqualToString:expected.name] && [actual.reason isEqualToString:expected.reason] && [actual.userInfo isEqual:expected.userInfo];
 }
 
+static std::set<size_t> RLMIndexesInSet(realm::IndexSet const& set) {
+    std::set<size_t> indexes;
+    for (auto const& range : set) {
+        for (size_t i = range.first; i < range.second; ++i) {
+            indexes.insert(i);
+        }
+    }
+    return indexes;
+}
+
 @implementation UtilTests
 
 - (void)testRLMExceptionWithReasonAndUserInfo {
@@ -80,4 +94,90 @@ static BOOL RLMEqualExceptions(NSException *actual, NSException *expected) { \
     XCTAssertEqualObjects(error, outError);
 }
 
+- (void)testIndexSetSwitchesToBitmapWithManyNearbyRanges {
+    realm::IndexSet set;
+    for (size_t i = 0; i < 31; ++i) {
+        set.add(i * 2);
+    }
+    XCTAssertFalse(set.is_bitmap());
+
+    set.add(62);
+    XCTAssertTrue(set.is_bitmap());
+    XCTAssertEqual(32U, set.size());
+    XCTAssertEqual(32U, set.count());
+    XCTAssertTrue(set.contains(62));
+    XCTAssertFalse(set.contains(63));
+
+    // Many ranges which are far apart are smaller than a bitmap
+    realm::IndexSet sparse;
+    for (size_t i = 0; i < 100; ++i) {
+        sparse.add(i * 1000);
+    }
+    XCTAssertFalse(sparse.is_bitmap());
+}
+
+- (void)testIndexSetSwitchesBackToRangesWhenFewRangesAreLeft {
+    realm::IndexSet set;
+    for (size_t i = 0; i < 64; ++i) {
+        set.add(i * 2);
+    }
+    XCTAssertTrue(set.is_bitmap());
+
+    // Still enough ranges to stay a bitmap, so it doesn't switch back as soon
+    // as it drops below the threshold for switching to a bitmap
+    set.remove_range(0, 60);
+    XCTAssertTrue(set.is_bitmap());
+    XCTAssertEqual(34U, set.size());
+
+    set.remove_range(60, 100);
+    XCTAssertFalse(set.is_bitmap());
+    XCTAssertEqual(14U, set.size());
+    XCTAssertTrue((std::set<size_t>{100, 102, 104, 106, 108, 110, 112, 114, 116, 118, 120, 122, 124, 126})
+                  == RLMIndexesInSet(set));
+
+    set.remove_range(0, 128);
+    XCTAssertFalse(set.is_bitmap());
+    XCTAssertTrue(set.empty());
+}
+
+- (void)testIndexSetSwitchesBackToRangesWhenShiftedOrErased {
+    // Shifting most of the ranges a long way makes the bitmap mostly empty
+    realm::IndexSet shifted;
+    for (size_t i = 0; i < 40; ++i) {
+        shifted.add(i * 2);
+    }
+    XCTAssertTrue(shifted.is_bitmap());
+    shifted.shift_for_insert_at(1, 100000);
+    XCTAssertFalse(shifted.is_bitmap());
+    XCTAssertEqual(40U, shifted.size());
+    XCTAssertTrue(shifted.contains(0));
+    XCTAssertTrue(shifted.contains(100002));
+    XCTAssertTrue(shifted.contains(100078));
+
+    // Erasing the gaps between ranges merges them
+    realm::IndexSet erased;
+    for (size_t i = 0; i < 40; ++i) {
+        erased.add(i * 2);
+    }
+    XCTAssertTrue(erased.is_bitmap());
+    for (size_t i = 0; i < 39; ++i) {
+        erased.erase_at(i + 1);
+    }
+    XCTAssertFalse(erased.is_bitmap());
+    XCTAssertEqual(1U, erased.size());
+    XCTAssertEqual(40U, erased.count());
+
+    // Intersecting two bitmaps can leave few ranges
+    realm::IndexSet a, b;
+    for (size_t i = 0; i < 40; ++i) {
+        a.add(i * 2);
+        b.add(i * 2 + (i < 35));
+    }
+    XCTAssertTrue(a.is_bitmap());
+    XCTAssertTrue(b.is_bitmap());
+    a.intersect(b);
+    XCTAssertFalse(a.is_bitmap());
+    XCTAssertTrue((std::set<size_t>{70, 72, 74, 76, 78}) == RLMIndexesInSet(a));
+}
+
 @end
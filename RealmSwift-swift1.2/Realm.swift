@@ -81,6 +81,26 @@ public final class Realm {
         }
     }
 
+    /**
+    Obtains a Realm instance with the given configuration which is confined to a serial dispatch queue rather
+    than to the current thread. It can be used from any block running on the queue, and is notified of changes
+    by dispatching to the queue. This must be called from a block running on `queue`.
+
+    :param: configuration The configuration to use when creating the Realm instance.
+    :param: queue         The serial queue to confine the Realm to.
+    :param: error         If an error occurs, upon return contains an `NSError` object
+                          that describes the problem. If you are not interested in
+                          possible errors, omit the argument, or pass in `nil`.
+    */
+    public convenience init?(configuration: Configuration, queue: dispatch_queue_t, error: NSErrorPointer = nil)  {
+        if let rlmRealm = RLMRealm(configuration: configuration.rlmConfiguration, queue: queue, error: error) {
+            self.init(rlmRealm)
+        } else {
+            self.init(RLMRealm())
+            return nil
+        }
+    }
+
     /**
     Obtains a Realm instance with the default `Realm.Configuration`.
     */
@@ -123,6 +143,29 @@ public final class Realm {
         return rlmRealm.transactionWithBlock(block, error: error)
     }
 
+    /**
+    Performs actions contained within the given block inside a write transaction
+    on a background thread, without blocking the calling thread.
+
+    Asynchronous writes to a Realm file are performed one at a time, in the order
+    they were requested, on a thread dedicated to writing to that file. The block
+    is passed the `Realm` for that thread, which it must use for all of its reads
+    and writes.
+
+    Once the transaction has been committed or has failed, this `Realm` is
+    refreshed and the completion block is called on the current thread, which
+    must be running its run loop.
+
+    :param: block      The block to be executed inside a write transaction on
+                       the writer thread.
+    :param: completion The block to call on the current thread once the
+                       transaction has finished, with an `NSError` if it could
+                       not be committed.
+    */
+    public func writeAsync(block: (Realm -> Void), completion: (NSError? -> Void)? = nil) {
+        rlmRealm.asyncTransactionWithBlock({ block(Realm($0)) }, completion: completion)
+    }
+
     /**
     Begins a write transaction in a `Realm`.
 
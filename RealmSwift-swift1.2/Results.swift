@@ -233,6 +233,24 @@ public final class Results<T: Object>: ResultsBase {
         return Results<T>(rlmResults.sortedResultsUsingDescriptors(map(sortDescriptors) { $0.rlmSortDescriptorValue }))
     }
 
+    // MARK: Limiting
+
+    /**
+    Returns `Results` containing at most `count` objects, starting at `offset`.
+
+    When sorted, only the objects needed are fully sorted, so this is much faster
+    than sorting everything when only the first few objects are needed. Filtering
+    or sorting the returned `Results` applies to just the objects within the limit.
+
+    :param: count  The maximum number of objects to include.
+    :param: offset The index of the first object to include.
+
+    :returns: `Results` containing at most `count` objects.
+    */
+    public func limit(count: Int, offset: Int = 0) -> Results<T> {
+        return Results<T>(rlmResults.resultsWithLimit(UInt(count), offset: UInt(offset)))
+    }
+
     // MARK: Aggregate Operations
 
     /**
@@ -62,6 +62,8 @@ public enum Error: ErrorType {
             return RLMError.IncompatibleLockFile
         case .FileFormatUpgradeRequired:
             return RLMError.FileFormatUpgradeRequired
+        case .Cancelled:
+            return RLMError.Cancelled
         }
     }
 
@@ -90,6 +92,9 @@ public enum Error: ErrorType {
     /// Returned by RLMRealm if a file format upgrade is required to open the file,
     /// but upgrades were explicilty disabled.
     case FileFormatUpgradeRequired
+
+    /// Error thrown when writing a copy of a snapshot was cancelled by its progress block.
+    case Cancelled
 }
 
 // MARK: Equatable
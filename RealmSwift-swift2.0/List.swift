@@ -267,6 +267,41 @@ public final class List<T: Object>: ListBase {
         return filter(NSPredicate(value: true)).average(property)
     }
 
+    /**
+    Computes several aggregates over the objects in the List in a single pass, which is faster
+    than calling the individual aggregate functions for each value.
+
+    - warning: The same property type restrictions apply as for the individual aggregate functions.
+
+    - parameter keyPaths: Key paths of the form `@min.property`, `@max.property`, `@sum.property` or
+                          `@avg.property`.
+
+    - returns: The value of each aggregate in the same order as the key paths, or `nil` for aggregates which have
+               no value. Dates are given as seconds since 1970.
+    */
+    public func valuesForAggregateKeyPaths(keyPaths: [String]) -> [Double?] {
+        return filter(NSPredicate(value: true)).valuesForAggregateKeyPaths(keyPaths)
+    }
+
+    /**
+    Groups the objects in the List by the value of a property and computes aggregates for each group, in a
+    single pass over the objects.
+
+    - warning: The grouped property must be an `Int`, `Bool`, `String` or `NSDate` property. The same property
+               type restrictions apply to the aggregates as for the individual aggregate functions.
+
+    - parameter property: The name of the property to group the objects by.
+    - parameter keyPaths: Key paths of the form `@min.property`, `@max.property`, `@sum.property` or
+                          `@avg.property`.
+
+    - returns: A dictionary for each distinct value of the property, in the order each value first appears in the
+               List, containing the value under the property's name, the number of objects under `@count`, and
+               the value of each aggregate under its key path, with `NSNull` for `nil` values.
+    */
+    public func groupBy(property: String, aggregates keyPaths: [String]) -> [[String: AnyObject]] {
+        return filter(NSPredicate(value: true)).groupBy(property, aggregates: keyPaths)
+    }
+
     // MARK: Mutation
 
     /**
@@ -289,9 +324,7 @@ public final class List<T: Object>: ListBase {
     - parameter objects: A sequence of objects.
     */
     public func appendContentsOf<S: SequenceType where S.Generator.Element == T>(objects: S) {
-        for obj in objects {
-            _rlmArray.addObject(unsafeBitCast(obj, RLMObject.self))
-        }
+        _rlmArray.addObjects(objects.map { unsafeBitCast($0, RLMObject.self) })
     }
 
     /**
@@ -398,6 +431,18 @@ extension List: RealmCollectionType, RangeReplaceableCollectionType {
         return RLMGenerator(collection: _rlmArray)
     }
 
+    /**
+    Returns a generator which points a single object at each element in turn
+    rather than creating a new object for each one. Lists which are not in a
+    Realm return their own objects.
+
+    - warning: The object returned by each call to `next()` is the same one,
+               so it must not be stored or used after the next call.
+    */
+    public func generateReusingObject() -> RLMGenerator<T> {
+        return RLMGenerator(collection: _rlmArray, reuseAccessor: true)
+    }
+
     // MARK: RangeReplaceableCollection Support
 
     /**
@@ -408,12 +453,9 @@ extension List: RealmCollectionType, RangeReplaceableCollectionType {
     */
     public func replaceRange<C: CollectionType where C.Generator.Element == T>(subRange: Range<Int>,
                                                                                with newElements: C) {
-        for _ in subRange {
-            removeAtIndex(subRange.startIndex)
-        }
-        for x in newElements.reverse() {
-            insert(x, atIndex: subRange.startIndex)
-        }
+        throwForNegativeIndex(subRange.startIndex, parameterName: "subRange.startIndex")
+        _rlmArray.replaceObjectsInRange(NSRange(location: subRange.startIndex, length: subRange.count),
+                                        withObjects: newElements.map { unsafeBitCast($0, RLMObject.self) })
     }
 
     /// The position of the first element in a non-empty collection.
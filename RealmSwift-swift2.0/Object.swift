@@ -141,6 +141,34 @@ public class Object: RLMObjectBase {
     */
     public class func primaryKey() -> String? { return nil }
 
+    /**
+    Override to designate two or more properties which together are the primary key for an `Object`
+    subclass, as an alternative to `primaryKey()`. Only properties of type String and Int can be part of
+    a compound primary key. Adding an object with the same values for these properties as an existing
+    object throws an exception unless it is added with `update: true`, and the properties can't be
+    changed after an object is added. A compound index is created automatically for the properties.
+
+    - returns: Names of the properties which make up the primary key, or `nil` if the model has no compound primary key.
+    */
+    public class func compoundPrimaryKey() -> [String]? { return nil }
+
+    /**
+    Override to designate an NSDate property which objects of an `Object` subclass expire relative to,
+    along with `timeToLive()`. Once an object's date is more than `timeToLive()` seconds in the past it is
+    no longer included in `Results`, and Realms opened with an `expirySweepInterval` delete it in the background.
+
+    - returns: Name of the date property objects expire relative to, or `nil` if objects don't expire.
+    */
+    public class func timeToLiveProperty() -> String? { return nil }
+
+    /**
+    Override along with `timeToLiveProperty()` to give the number of seconds after the date in that property
+    at which objects expire. Must be at least one second.
+
+    - returns: The time to live of objects of this class.
+    */
+    public class func timeToLive() -> NSTimeInterval { return 0 }
+
     /**
     Override to return an array of property names to ignore. These properties will not be persisted
     and are treated as transient.
@@ -157,6 +185,33 @@ public class Object: RLMObjectBase {
     */
     public class func indexedProperties() -> [String] { return [] }
 
+    /**
+    Return an array of property names for properties which should have a full-text index, which
+    speeds up `CONTAINS` queries for a single word. Only supported for string properties.
+
+    - returns: `Array` of property names to text index.
+    */
+    public class func textIndexedProperties() -> [String] { return [] }
+
+    /**
+    Return an array of property names for List properties whose `@count`, and `@sum` of each numeric
+    property of the objects in them, should be cached for each object, which speeds up queries comparing
+    them with a constant value.
+
+    - returns: `Array` of property names.
+    */
+    public class func cachedAggregateProperties() -> [String] { return [] }
+
+    /**
+    Return an array of compound indexes, each of which is an array of the names of two or more String or
+    Int properties. Queries which compare the leading properties of a compound index with constant values
+    using `==`, optionally along with comparing the next property with `<`, `<=`, `>` or `>=` if it is an Int
+    property, use the index rather than checking every object.
+
+    - returns: `Array` of arrays of property names.
+    */
+    public class func compoundIndexes() -> [[String]] { return [] }
+
 
     // MARK: Inverse Relationships
 
@@ -331,6 +386,48 @@ public class ObjectUtil: NSObject {
         return nil
     }
 
+    @objc private class func textIndexedPropertiesForClass(type: AnyClass) -> NSArray? {
+        if let type = type as? Object.Type {
+            return type.textIndexedProperties() as NSArray?
+        }
+        return nil
+    }
+
+    @objc private class func cachedAggregatePropertiesForClass(type: AnyClass) -> NSArray? {
+        if let type = type as? Object.Type {
+            return type.cachedAggregateProperties() as NSArray?
+        }
+        return nil
+    }
+
+    @objc private class func compoundIndexesForClass(type: AnyClass) -> NSArray? {
+        if let type = type as? Object.Type {
+            return type.compoundIndexes() as NSArray?
+        }
+        return nil
+    }
+
+    @objc private class func compoundPrimaryKeyForClass(type: AnyClass) -> NSArray? {
+        if let type = type as? Object.Type {
+            return type.compoundPrimaryKey() as NSArray?
+        }
+        return nil
+    }
+
+    @objc private class func timeToLivePropertyForClass(type: AnyClass) -> String? {
+        if let type = type as? Object.Type {
+            return type.timeToLiveProperty()
+        }
+        return nil
+    }
+
+    @objc private class func timeToLiveForClass(type: AnyClass) -> NSTimeInterval {
+        if let type = type as? Object.Type {
+            return type.timeToLive()
+        }
+        return 0
+    }
+
     // Get the names of all properties in the object which are of type List<>.
     @objc private class func getGenericListPropertyNames(object: AnyObject) -> NSArray {
         return Mirror(reflecting: object).children.filter { (prop: Mirror.Child) in
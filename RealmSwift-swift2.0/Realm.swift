@@ -76,6 +76,22 @@ public final class Realm {
         self.init(rlmRealm)
     }
 
+    /**
+    Obtains a Realm instance with the given configuration which is confined to a serial dispatch queue rather
+    than to the current thread. It can be used from any block running on the queue, and is notified of changes
+    by dispatching to the queue. This must be called from a block running on `queue`.
+
+    - parameter configuration: The configuration to use when creating the Realm instance.
+    - parameter queue:         The serial queue to confine the Realm to.
+
+    - throws: An NSError if the Realm could not be initialized.
+    */
+    public convenience init(configuration: Configuration = Configuration.defaultConfiguration,
+                            queue: dispatch_queue_t) throws {
+        let rlmRealm = try RLMRealm(configuration: configuration.rlmConfiguration, queue: queue)
+        self.init(rlmRealm)
+    }
+
     /**
     Obtains a Realm instance persisted at the specified file path.
 
@@ -111,6 +127,29 @@ public final class Realm {
         try rlmRealm.transactionWithBlock(block)
     }
 
+    /**
+    Performs actions contained within the given block inside a write transaction
+    on a background thread, without blocking the calling thread.
+
+    Asynchronous writes to a Realm file are performed one at a time, in the order
+    they were requested, on a thread dedicated to writing to that file. The block
+    is passed the `Realm` for that thread, which it must use for all of its reads
+    and writes.
+
+    Once the transaction has been committed or has failed, this `Realm` is
+    refreshed and the completion block is called on the current thread, which
+    must be running its run loop.
+
+    - parameter block:      The block to be executed inside a write transaction
+                            on the writer thread.
+    - parameter completion: The block to call on the current thread once the
+                            transaction has finished, with an `NSError` if it
+                            could not be committed.
+    */
+    public func writeAsync(block: (Realm -> Void), completion: (NSError? -> Void)? = nil) {
+        rlmRealm.asyncTransactionWithBlock({ block(Realm($0)) }, completion: completion)
+    }
+
     /**
     Begins a write transaction in a `Realm`.
 
@@ -211,7 +250,7 @@ public final class Realm {
     - parameter update: If true will try to update existing objects with the same primary key.
     */
     public func add(object: Object, update: Bool = false) {
-        if update && object.objectSchema.primaryKeyProperty == nil {
+        if update && !object.objectSchema.rlmObjectSchema.hasPrimaryKey {
             throwRealmException("'\(object.objectSchema.className)' does not have a primary key and can not be updated")
         }
         RLMAddObjectToRealm(object, rlmRealm, update)
@@ -258,7 +297,7 @@ public final class Realm {
     */
     public func create<T: Object>(type: T.Type, value: AnyObject = [:], update: Bool = false) -> T {
         let className = (type as Object.Type).className()
-        if update && schema[className]?.primaryKeyProperty == nil {
+        if update && schema[className]?.rlmObjectSchema.hasPrimaryKey != true {
             throwRealmException("'\(className)' does not have a primary key and can not be updated")
         }
         return unsafeBitCast(RLMCreateObjectInRealmWithValue(rlmRealm, className, value, update), T.self)
@@ -293,7 +332,7 @@ public final class Realm {
     :nodoc:
     */
     public func dynamicCreate(className: String, value: AnyObject = [:], update: Bool = false) -> DynamicObject {
-        if update && schema[className]?.primaryKeyProperty == nil {
+        if update && schema[className]?.rlmObjectSchema.hasPrimaryKey != true {
             throwRealmException("'\(className)' does not have a primary key and can not be updated")
         }
         return unsafeBitCast(RLMCreateObjectInRealmWithValue(rlmRealm, className, value, update), DynamicObject.self)
@@ -24,10 +24,18 @@ Encapsulates iteration state and interface for iteration over a
 `RealmCollectionType`.
 */
 public final class RLMGenerator<T: Object>: GeneratorType {
-    private let generatorBase: NSFastGenerator
-
-    internal init(collection: RLMCollection) {
-        generatorBase = NSFastGenerator(collection)
+    // Collections in a Realm are stepped through directly, creating each
+    // accessor from a batch of row indexes, while standalone Lists are
+    // enumerated with NSFastEnumeration
+    private let enumerator: RLMFastEnumerator?
+    private let generatorBase: NSFastGenerator?
+    private let reusesAccessor: Bool
+    private var accessor: T?
+
+    internal init(collection: RLMCollection, reuseAccessor: Bool = false) {
+        enumerator = RLMEnumeratorForCollection(collection)
+        generatorBase = enumerator == nil ? NSFastGenerator(collection) : nil
+        reusesAccessor = reuseAccessor
     }
 
     // swiftlint:disable valid_docs
@@ -35,7 +43,15 @@ public final class RLMGenerator<T: Object>: GeneratorType {
     /// Advance to the next element and return it, or `nil` if no next element
     /// exists.
     public func next() -> T? {
-        let accessor = generatorBase.next() as! T?
+        if let enumerator = enumerator {
+            let next = enumerator.nextObjectReusingAccessor(accessor) as! T?
+            if reusesAccessor {
+                accessor = next
+            }
+            return next
+        }
+
+        let accessor = generatorBase!.next() as! T?
         if let accessor = accessor {
             RLMInitializeSwiftAccessorGenerics(accessor)
         }
@@ -18,6 +18,7 @@
 
 import Foundation
 import Realm
+import Realm.Private
 
 // MARK: MinMaxType
 
@@ -237,6 +238,57 @@ public final class Results<T: Object>: ResultsBase {
         return Results<T>(rlmResults.sortedResultsUsingDescriptors(sortDescriptors.map { $0.rlmSortDescriptorValue }))
     }
 
+    // MARK: Limiting
+
+    /**
+    Returns `Results` containing at most `count` objects, starting at `offset`.
+
+    When sorted, only the objects needed are fully sorted, so this is much faster
+    than sorting everything when only the first few objects are needed. Filtering
+    or sorting the returned `Results` applies to just the objects within the limit.
+
+    - parameter count:  The maximum number of objects to include.
+    - parameter offset: The index of the first object to include.
+
+    - returns: `Results` containing at most `count` objects.
+    */
+    public func limit(count: Int, offset: Int = 0) -> Results<T> {
+        return Results<T>(rlmResults.resultsWithLimit(UInt(count), offset: UInt(offset)))
+    }
+
+    // MARK: Prefetching
+
+    /**
+    Returns `Results` containing the same objects which, when iterated over,
+    follows the given chains of links for each batch of objects ahead of time,
+    visiting the linked objects in the order they are stored in and keeping
+    their accessors so that following the links again doesn't create new ones.
+
+    - parameter keyPaths: Key paths made of to-one link properties, optionally
+                          ending with the property which will be read.
+
+    - returns: `Results` which prefetch the given key paths.
+    */
+    public func prefetching(keyPaths: [String]) -> Results<T> {
+        return Results<T>(rlmResults.resultsPrefetchingKeyPaths(keyPaths))
+    }
+
+    // MARK: Projection
+
+    /**
+    Returns `Results` containing the same objects which only use the given
+    properties. Notification blocks are only called for modifications to the
+    projected properties, and only those properties are serialized or read
+    with `valueForKey(_:)`.
+
+    - parameter properties: The names of the properties to project.
+
+    - returns: `Results` which project the given properties.
+    */
+    public func projecting(properties: [String]) -> Results<T> {
+        return Results<T>(rlmResults.resultsProjectingProperties(properties))
+    }
+
     // MARK: Aggregate Operations
 
     /**
@@ -249,7 +301,7 @@ public final class Results<T: Object>: ResultsBase {
     - returns: The minimum value for the property amongst objects in the Results, or `nil` if the Results is empty.
     */
     public func min<U: MinMaxType>(property: String) -> U? {
-        return rlmResults.minOfProperty(property) as! U?
+        return aggregate(.Min, property) { self.rlmResults.minOfProperty(property) }
     }
 
     /**
@@ -262,7 +314,7 @@ public final class Results<T: Object>: ResultsBase {
     - returns: The maximum value for the property amongst objects in the Results, or `nil` if the Results is empty.
     */
     public func max<U: MinMaxType>(property: String) -> U? {
-        return rlmResults.maxOfProperty(property) as! U?
+        return aggregate(.Max, property) { self.rlmResults.maxOfProperty(property) }
     }
 
     /**
@@ -275,7 +327,7 @@ public final class Results<T: Object>: ResultsBase {
     - returns: The sum of the given property over all objects in the Results.
     */
     public func sum<U: AddableType>(property: String) -> U {
-        return rlmResults.sumOfProperty(property) as AnyObject as! U
+        return aggregate(.Sum, property) { self.rlmResults.sumOfProperty(property) }!
     }
 
     /**
@@ -288,7 +340,65 @@ public final class Results<T: Object>: ResultsBase {
     - returns: The average of the given property over all objects in the Results, or `nil` if the Results is empty.
     */
     public func average<U: AddableType>(property: String) -> U? {
-        return rlmResults.averageOfProperty(property) as! U?
+        return aggregate(.Average, property) { self.rlmResults.averageOfProperty(property) }
+    }
+
+    /**
+    Computes several aggregates over the objects in the Results in a single pass, which is faster
+    than calling the individual aggregate functions for each value.
+
+    - warning: The same property type restrictions apply as for the individual aggregate functions.
+
+    - parameter keyPaths: Key paths of the form `@min.property`, `@max.property`, `@sum.property` or
+                          `@avg.property`.
+
+    - returns: The value of each aggregate in the same order as the key paths, or `nil` for aggregates which have
+               no value. Dates are given as seconds since 1970.
+    */
+    public func valuesForAggregateKeyPaths(keyPaths: [String]) -> [Double?] {
+        var values = [Double](count: keyPaths.count, repeatedValue: 0)
+        var hasValues = [ObjCBool](count: keyPaths.count, repeatedValue: false)
+        rlmResults.valuesForAggregateKeyPaths(keyPaths, doubleValues: &values, hasValues: &hasValues)
+        return (0..<keyPaths.count).map { hasValues[$0] ? values[$0] : nil }
+    }
+
+    /**
+    Groups the objects in the Results by the value of a property and computes aggregates for each group, in a
+    single pass over the objects.
+
+    - warning: The grouped property must be an `Int`, `Bool`, `String` or `NSDate` property. The same property
+               type restrictions apply to the aggregates as for the individual aggregate functions.
+
+    - parameter property: The name of the property to group the objects by.
+    - parameter keyPaths: Key paths of the form `@min.property`, `@max.property`, `@sum.property` or
+                          `@avg.property`.
+
+    - returns: A dictionary for each distinct value of the property, in the order each value first appears in the
+               Results, containing the value under the property's name, the number of objects under `@count`, and
+               the value of each aggregate under its key path, with `NSNull` for `nil` values.
+    */
+    public func groupBy(property: String, aggregates keyPaths: [String]) -> [[String: AnyObject]] {
+        return rlmResults.groupBy(property, aggregates: keyPaths) as! [[String: AnyObject]]
+    }
+
+    // Get an aggregate without boxing it in an NSNumber for the types which
+    // can be, falling back to the boxed Objective-C method for the others
+    private func aggregate<U>(operation: RLMAggregateOperation, _ property: String, boxed: () -> AnyObject?) -> U? {
+        var int: Int64 = 0
+        var double: Double = 0
+        switch U.self {
+        case is Int.Type:
+            return rlmResults.aggregate(operation, ofProperty: property, intValue: &int) ? Int(int) as? U : nil
+        case is Double.Type:
+            return rlmResults.aggregate(operation, ofProperty: property, doubleValue: &double) ? double as? U : nil
+        case is Float.Type:
+            return rlmResults.aggregate(operation, ofProperty: property, doubleValue: &double) ? Float(double) as? U : nil
+        case is NSDate.Type:
+            return rlmResults.aggregate(operation, ofProperty: property, doubleValue: &double)
+                ? NSDate(timeIntervalSince1970: double) as? U : nil
+        default:
+            return boxed() as! U?
+        }
     }
 }
 
@@ -300,6 +410,17 @@ extension Results: RealmCollectionType {
         return RLMGenerator(collection: rlmResults)
     }
 
+    /**
+    Returns a generator which points a single object at each element in turn
+    rather than creating a new object for each one.
+
+    - warning: The object returned by each call to `next()` is the same one,
+               so it must not be stored or used after the next call.
+    */
+    public func generateReusingObject() -> RLMGenerator<T> {
+        return RLMGenerator(collection: rlmResults, reuseAccessor: true)
+    }
+
     // MARK: Collection Support
 
     /// The position of the first element in a non-empty collection.
@@ -35,9 +35,13 @@ public struct SortDescriptor {
     /// Whether this descriptor sorts in ascending or descending order.
     public let ascending: Bool
 
+    /// The locale used to compare the values of a string property, or `nil` to
+    /// compare them with the default ordering.
+    public let locale: NSLocale?
+
     /// Converts the receiver to an `RLMSortDescriptor`
     internal var rlmSortDescriptorValue: RLMSortDescriptor {
-        return RLMSortDescriptor(property: property, ascending: ascending)
+        return RLMSortDescriptor(property: property, ascending: ascending, locale: locale)
     }
 
     // MARK: Initializers
@@ -45,19 +49,24 @@ public struct SortDescriptor {
     /**
     Creates a `SortDescriptor` with the given property and ascending values.
 
+    With a locale, the values of a string property are ordered ignoring case,
+    diacritics and width as defined by the locale.
+
     - parameter property:  The name of the property which this sort descriptor orders results by.
     - parameter ascending: Whether this descriptor sorts in ascending or descending order.
+    - parameter locale:    The locale to compare string values with.
     */
-    public init(property: String, ascending: Bool = true) {
+    public init(property: String, ascending: Bool = true, locale: NSLocale? = nil) {
         self.property = property
         self.ascending = ascending
+        self.locale = locale
     }
 
     // MARK: Functions
 
     /// Returns a copy of the `SortDescriptor` with the sort order reversed.
     public func reversed() -> SortDescriptor {
-        return SortDescriptor(property: property, ascending: !ascending)
+        return SortDescriptor(property: property, ascending: !ascending, locale: locale)
     }
 }
 
@@ -80,7 +89,8 @@ extension SortDescriptor: Equatable {}
 /// Returns whether the two sort descriptors are equal.
 public func == (lhs: SortDescriptor, rhs: SortDescriptor) -> Bool {
     return lhs.property == rhs.property &&
-        lhs.ascending == lhs.ascending
+        lhs.ascending == lhs.ascending &&
+        lhs.locale?.localeIdentifier == rhs.locale?.localeIdentifier
 }
 
 // swiftlint:enable valid_docs
@@ -226,6 +226,20 @@ class ListTests: TestCase {
         XCTAssertEqual(str2, array[1])
         XCTAssertEqual(str2, array[2])
 
+        array.replaceRange(1..<2, with: [str1, str1, str2])
+        XCTAssertEqual(Int(5), array.count)
+        XCTAssertEqual(str2, array[0])
+        XCTAssertEqual(str1, array[1])
+        XCTAssertEqual(str1, array[2])
+        XCTAssertEqual(str2, array[3])
+        XCTAssertEqual(str2, array[4])
+
+        array.replaceRange(1..<4, with: [str1])
+        XCTAssertEqual(Int(3), array.count)
+        XCTAssertEqual(str2, array[0])
+        XCTAssertEqual(str1, array[1])
+        XCTAssertEqual(str2, array[2])
+
         array.replaceRange(0..<3, with: [])
         XCTAssertEqual(Int(0), array.count)
 
@@ -333,6 +333,55 @@ class ResultsTests: RealmCollectionTypeTests {
         realmWithTestPath().add(array)
         array["array"] = collectionBase()
     }
+
+    func testLimit() {
+        let results = collectionBase()
+        XCTAssertEqual(1, results.limit(1).count)
+        XCTAssertEqual(0, results.limit(1, offset: 2).count)
+        XCTAssertEqual("2", results.sorted("stringCol", ascending: false).limit(1)[0].stringCol)
+        XCTAssertEqual("2", results.sorted("stringCol").limit(5, offset: 1)[0].stringCol)
+    }
+
+    func testGenerateReusingObject() {
+        let generator = collectionBase().generateReusingObject()
+        let first = generator.next()!
+        XCTAssertEqual("1", first.stringCol)
+        let second = generator.next()!
+        XCTAssertTrue(first === second)
+        XCTAssertEqual("2", second.stringCol)
+        XCTAssertNil(generator.next())
+        XCTAssertNil(generator.next())
+    }
+
+    func testValuesForAggregateKeyPaths() {
+        makeAggregateableObjects()
+        let results = realmWithTestPath().objects(SwiftAggregateObject)
+        let values = results.valuesForAggregateKeyPaths(["@min.intCol", "@max.doubleCol", "@sum.intCol", "@max.dateCol"])
+        XCTAssertEqual(1, values[0])
+        XCTAssertEqual(2.22, values[1])
+        XCTAssertEqual(6, values[2])
+        XCTAssertEqual(2, values[3])
+
+        let empty = results.filter("intCol < 0").valuesForAggregateKeyPaths(["@min.intCol", "@sum.intCol"])
+        XCTAssertNil(empty[0])
+        XCTAssertEqual(0, empty[1])
+
+        assertThrows(results.valuesForAggregateKeyPaths(["@min.noSuchCol"]), named: "Invalid property name")
+    }
+
+    func testGroupBy() {
+        makeAggregateableObjects()
+        let results = realmWithTestPath().objects(SwiftAggregateObject)
+        let groups = results.groupBy("boolCol", aggregates: ["@sum.intCol"])
+        XCTAssertEqual(groups.count, 2)
+        for group in groups {
+            let matching = results.filter("boolCol == %@", group["boolCol"]!)
+            XCTAssertEqual(group["@count"] as? Int, matching.count)
+            XCTAssertEqual(group["@sum.intCol"] as? Int, matching.sum("intCol") as Int)
+        }
+
+        assertThrows(results.groupBy("doubleCol", aggregates: []))
+    }
 }
 
 class ResultsFromTableTests: ResultsTests {
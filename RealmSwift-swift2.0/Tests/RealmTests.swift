@@ -193,6 +193,20 @@ class RealmTests: TestCase {
         XCTAssertEqual(try! Realm().objects(SwiftStringObject).count, 1)
     }
 
+    func testWriteAsync() {
+        let realm = try! Realm()
+        let expectation = expectationWithDescription("write completed")
+        realm.writeAsync({ writerRealm in
+            writerRealm.create(SwiftStringObject.self, value: ["1"])
+        }, completion: { error in
+            XCTAssertNil(error)
+            XCTAssertEqual(realm.objects(SwiftStringObject).count, 1)
+            expectation.fulfill()
+        })
+        XCTAssertEqual(realm.objects(SwiftStringObject).count, 0)
+        waitForExpectationsWithTimeout(2, handler: nil)
+    }
+
     func testDynamicWrite() {
         try! Realm().write {
             self.assertThrows(try! Realm().beginWrite())
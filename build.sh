@@ -59,6 +59,8 @@ command:
   test-tvos-devices:    tests ObjC & Swift tvOS frameworks on all attached tvOS devices
   test-osx:             tests OS X framework
   test-osx-swift:       tests RealmSwift OS X framework
+  benchmark-object-store [options]: builds and runs the C++ ObjectStore benchmarks
+                        (options: --filter substring, --samples count, --min-time ms, --json, --dir path)
   verify:               verifies docs, osx, osx-swift, ios-static, ios-dynamic, ios-swift, ios-device in both Debug and Release configurations, swiftlint
   docs:                 builds docs in docs/output
   examples:             builds all examples
@@ -602,6 +604,30 @@ case "$COMMAND" in
         exit 0
         ;;
 
+    ######################################
+    # Benchmarks
+    ######################################
+    "benchmark-object-store")
+        sh build.sh download-core
+        if [ "$CONFIGURATION" = "Debug" ]; then
+            flags="-O0 -g"
+            library="realm-dbg"
+        else
+            flags="-O3 -DNDEBUG"
+            library="realm"
+        fi
+        mkdir -p build/benchmarks
+        xcrun clang++ -std=c++14 -stdlib=libc++ $flags -DREALM_HAVE_CONFIG \
+            -Icore/include -IRealm/ObjectStore -IRealm/ObjectStore/impl -IRealm/ObjectStore/impl/apple \
+            Realm/ObjectStore/*.cpp Realm/ObjectStore/impl/*.cpp Realm/ObjectStore/impl/apple/*.cpp \
+            Realm/ObjectStore/benchmarks/*.cpp \
+            -Lcore -l$library -framework CoreFoundation \
+            -o build/benchmarks/object-store-benchmarks
+        shift
+        build/benchmarks/object-store-benchmarks "$@"
+        exit 0
+        ;;
+
     ######################################
     # Full verification
     ######################################